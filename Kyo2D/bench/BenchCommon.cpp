@@ -0,0 +1,165 @@
+#include "BenchCommon.h"
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+
+namespace Bench
+{
+	Engine::Engine(Backend backend, std::uint16_t width, std::uint16_t height, std::uint32_t threads)
+	{
+		if (backend == Backend::Software)
+			K2D_InitSoftware(threads);
+		else
+			K2D_InitNull();
+
+		// Without a window every present still finishes a frame, which offscreen targets don't
+		m_Target = K2D_CreateRenderTarget(nullptr, width, height, false);
+		K2D_SetRenderTarget(m_Target);
+	}
+
+	Engine::~Engine()
+	{
+		K2D_Terminate();
+	}
+
+	TempDirectory::TempDirectory()
+	{
+		char path[] = "/tmp/kyo2d-bench-XXXXXX";
+		if (mkdtemp(path))
+		{
+			m_NarrowPath = path;
+			m_Path.assign(m_NarrowPath.begin(), m_NarrowPath.end());
+		}
+	}
+
+	TempDirectory::~TempDirectory()
+	{
+		if (m_NarrowPath.empty())
+			return;
+
+		if (DIR *dir = opendir(m_NarrowPath.c_str()))
+		{
+			while (dirent *entry = readdir(dir))
+			{
+				std::string name = entry->d_name;
+				if (name != "." && name != "..")
+					unlink((m_NarrowPath + "/" + name).c_str());
+			}
+			closedir(dir);
+		}
+		rmdir(m_NarrowPath.c_str());
+	}
+
+	std::wstring FontPath()
+	{
+		const char* path = std::getenv("KYO2D_BENCH_FONT");
+#ifdef KYO2D_TEST_FONT
+		if (!path || !*path)
+			path = KYO2D_TEST_FONT;
+#endif
+		if (!path)
+			return std::wstring();
+
+		// Font paths are expected to be ASCII
+		std::string narrow(path);
+		return std::wstring(narrow.begin(), narrow.end());
+	}
+
+	std::wstring CjkFontPath()
+	{
+		const char* path = std::getenv("KYO2D_BENCH_CJK_FONT");
+		if (!path || !*path)
+			return FontPath();
+
+		std::string narrow(path);
+		return std::wstring(narrow.begin(), narrow.end());
+	}
+
+	bool ReadFont(std::vector<std::uint8_t>& out_data)
+	{
+		std::wstring wide = FontPath();
+		if (wide.empty())
+			return false;
+
+		std::string path(wide.begin(), wide.end());
+		FILE* file = std::fopen(path.c_str(), "rb");
+		if (!file)
+			return false;
+
+		std::fseek(file, 0, SEEK_END);
+		long size = std::ftell(file);
+		std::fseek(file, 0, SEEK_SET);
+		out_data.resize(size > 0 ? static_cast<size_t>(size) : 0);
+		bool ok = size > 0 && std::fread(out_data.data(), 1, out_data.size(), file) == out_data.size();
+		std::fclose(file);
+		return ok;
+	}
+
+	size_t HeapBytes()
+	{
+#ifdef __GLIBC__
+		// Large blocks are mapped separately and not part of uordblks
+		struct mallinfo2 info = mallinfo2();
+		return info.uordblks + info.hblkhd;
+#else
+		return 0;
+#endif
+	}
+
+	std::vector<std::uint32_t> CreateTextures(std::uint32_t count, std::uint32_t size)
+	{
+		std::vector<std::uint32_t> ids;
+		std::vector<std::uint32_t> pixels(size * size);
+		for (std::uint32_t t = 0; t < count; ++t)
+		{
+			for (std::uint32_t y = 0; y < size; ++y)
+			{
+				for (std::uint32_t x = 0; x < size; ++x)
+					pixels[y * size + x] = 0xFF000000u | ((t * 0x9E3779B1u) ^ ((x * 7) << 8) ^ (y * 13));
+			}
+			ids.push_back(K2D_CreateTextureFromPixels(size, size, K2D_PIXEL_RGBA8, size * 4, pixels.data()));
+		}
+		return ids;
+	}
+
+	std::string MakeText(size_t length, std::uint32_t seed)
+	{
+		std::string text;
+		text.reserve(length);
+		std::uint32_t state = seed * 2654435761u + 1;
+		while (text.size() < length)
+		{
+			state = state * 1664525u + 1013904223u;
+			size_t word = 2 + (state >> 28) % 9;
+			for (size_t i = 0; i < word && text.size() < length; ++i)
+			{
+				state = state * 1664525u + 1013904223u;
+				text.push_back(static_cast<char>('a' + (state >> 24) % 26));
+			}
+			if (text.size() < length)
+				text.push_back(' ');
+		}
+		return text;
+	}
+
+	std::u16string MakeCjkText(size_t length, std::uint32_t seed)
+	{
+		std::u16string text;
+		text.reserve(length);
+		std::uint32_t state = seed * 2654435761u + 1;
+		while (text.size() < length)
+		{
+			state = state * 1664525u + 1013904223u;
+			if ((state >> 28) == 0)
+				text.push_back(u' ');
+			else
+				text.push_back(static_cast<char16_t>(0x4E00 + (state >> 8) % (0xA000 - 0x4E00)));
+		}
+		return text;
+	}
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <Kyo2D.h>
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace Bench
+{
+	/// Backend a benchmark renders with.
+	enum class Backend
+	{
+		Null,		// measures the engine without any rendering
+		Software	// includes the rasterization of the frame
+	};
+
+	/// Initializes the engine on the calling thread and makes a headless window target current
+	/// for the lifetime of the object.
+	class Engine
+	{
+	public:
+
+		/// Initializes the engine.
+		/// @param backend The backend to render with.
+		/// @param width Width of the render target.
+		/// @param height Height of the render target.
+		/// @param threads Worker threads of the software backend, 0 uses one per hardware thread.
+		Engine(Backend backend, std::uint16_t width = 1280, std::uint16_t height = 720, std::uint32_t threads = 0);
+		/// Destructor. Terminates the engine.
+		~Engine();
+
+		Engine(const Engine&) = delete;
+		Engine& operator=(const Engine&) = delete;
+
+		/// Gets the render target.
+		inline std::uint32_t GetTarget() const { return m_Target; }
+
+	private:
+
+		std::uint32_t m_Target;
+	};
+
+	/// Creates an empty temporary directory and deletes it with its files on destruction.
+	class TempDirectory
+	{
+	public:
+
+		/// Creates the directory.
+		TempDirectory();
+		/// Destructor. Deletes the files in the directory and the directory.
+		~TempDirectory();
+
+		TempDirectory(const TempDirectory&) = delete;
+		TempDirectory& operator=(const TempDirectory&) = delete;
+
+		/// Gets the path of the directory, empty if it couldn't be created.
+		inline const std::wstring &GetPath() const { return m_Path; }
+
+	private:
+
+		std::string m_NarrowPath;
+		std::wstring m_Path;
+	};
+
+	/// Gets the font the text benchmarks use, from the KYO2D_BENCH_FONT environment variable or the
+	/// font found when the build was configured.
+	/// @return The file name, empty if no font is available.
+	std::wstring FontPath();
+
+	/// Gets the font the CJK text benchmarks use, from the KYO2D_BENCH_CJK_FONT environment
+	/// variable. Falls back to FontPath(), which still measures the lookups of missing glyphs.
+	/// @return The file name, empty if no font is available.
+	std::wstring CjkFontPath();
+
+	/// Reads the benchmark font into memory.
+	/// @return false if no font is available.
+	bool ReadFont(std::vector<std::uint8_t>& out_data);
+
+	/// Gets the number of bytes currently allocated on the heap.
+	/// @return The number of bytes, 0 if the C library can't report it.
+	size_t HeapBytes();
+
+	/// Creates textures with distinct RGBA patterns.
+	/// @param count Number of textures.
+	/// @param size Width and height of the textures.
+	/// @return The texture ids.
+	std::vector<std::uint32_t> CreateTextures(std::uint32_t count, std::uint32_t size);
+
+	/// Generates printable ASCII text made of words separated by spaces.
+	/// @param length Length of the text in characters.
+	/// @param seed Seed of the word generator, the same seed gives the same text.
+	std::string MakeText(size_t length, std::uint32_t seed = 1);
+
+	/// Generates text of CJK ideographs from U+4E00 to U+9FFF with a space every few characters.
+	/// @param length Length of the text in characters.
+	/// @param seed Seed of the generator, the same seed gives the same text.
+	std::u16string MakeCjkText(size_t length, std::uint32_t seed = 1);
+}
@@ -0,0 +1,28 @@
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <vector>
+
+
+int main(int argc, char **argv)
+{
+	// Results are written as JSON unless another format is asked for
+	static char jsonFormat[] = "--benchmark_format=json";
+	std::vector<char*> args(argv, argv + argc);
+	bool hasFormat = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strncmp(argv[i], "--benchmark_format", 18) == 0)
+			hasFormat = true;
+	}
+	if (!hasFormat)
+		args.insert(args.begin() + 1, jsonFormat);
+	args.push_back(nullptr);
+
+	int count = static_cast<int>(args.size()) - 1;
+	benchmark::Initialize(&count, args.data());
+	if (benchmark::ReportUnrecognizedArguments(count, args.data()))
+		return 1;
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,38 @@
+#include "BenchCommon.h"
+
+
+namespace
+{
+	/// Renders frames on every benchmark thread, each thread with its own context like an
+	/// application with one render thread per window. Contexts share nothing, so the frames per
+	/// second should scale with the thread count up to the number of cores.
+	void BM_ContextScaling(benchmark::State& state, Bench::Backend backend)
+	{
+		std::uint32_t context = K2D_CreateContext();
+		K2D_MakeContextCurrent(context);
+		{
+			Bench::Engine engine(backend, 640, 360, 1);
+			std::vector<std::uint32_t> textures = Bench::CreateTextures(8, 32);
+
+			for (auto _ : state)
+			{
+				K2D_ClearRenderTarget(0.0f, 0.0f, 0.0f);
+				for (std::uint32_t i = 0; i < 500; ++i)
+				{
+					float x = static_cast<float>((i * 37) % 608);
+					float y = static_cast<float>((i * 91) % 328);
+					K2D_DrawSpriteAt(textures[i % textures.size()], x, y, 0.0f, 0.0f, 0xFFFFFFFF, 0);
+				}
+				K2D_FillRect(10.0f, 10.0f, 200.0f, 100.0f, 0x80FF8040);
+				K2D_PresentRenderTarget();
+			}
+		}
+		K2D_DestroyContext(context);
+
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK_CAPTURE(BM_ContextScaling, null, Bench::Backend::Null)
+		->ThreadRange(1, 8)->UseRealTime()->Unit(benchmark::kMicrosecond);
+	BENCHMARK_CAPTURE(BM_ContextScaling, software, Bench::Backend::Software)
+		->ThreadRange(1, 8)->UseRealTime()->Unit(benchmark::kMicrosecond);
+}
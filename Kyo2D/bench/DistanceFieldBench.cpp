@@ -0,0 +1,43 @@
+#include "BenchCommon.h"
+#include "DistanceField.h"
+#include "Software/WorkerPool.h"
+#include <cmath>
+
+using Kyo2D::DistanceField;
+
+
+namespace
+{
+	/// Generates the distance field of a filled disc of N x N pixels with T threads, 1 thread
+	/// runs without a worker pool.
+	void BM_DistanceField(benchmark::State& state)
+	{
+		const std::int32_t size = static_cast<std::int32_t>(state.range(0));
+		const std::uint32_t threads = static_cast<std::uint32_t>(state.range(1));
+
+		std::vector<std::uint8_t> coverage(static_cast<size_t>(size) * size);
+		const float radius = size * 0.4f;
+		for (std::int32_t y = 0; y < size; ++y)
+		{
+			for (std::int32_t x = 0; x < size; ++x)
+			{
+				const float d = std::hypot(x + 0.5f - size * 0.5f, y + 0.5f - size * 0.5f);
+				coverage[y * size + x] = static_cast<std::uint8_t>(std::max(0.0f, std::min(1.0f, radius - d + 0.5f)) * 255.0f);
+			}
+		}
+
+		Kyo2D::WorkerPool workers;
+		if (threads > 1)
+			workers.Initialize(threads);
+
+		std::vector<std::uint8_t> field(coverage.size());
+		for (auto _ : state)
+		{
+			DistanceField::Generate(coverage.data(), size, size, 8.0f, threads > 1 ? &workers : nullptr, field.data());
+			benchmark::DoNotOptimize(field.data());
+		}
+
+		state.SetItemsProcessed(state.iterations() * size * size);
+	}
+	BENCHMARK(BM_DistanceField)->ArgsProduct({ { 64, 256, 1024 }, { 1, 2, 4 } })->UseRealTime()->Unit(benchmark::kMicrosecond);
+}
@@ -0,0 +1,174 @@
+#include "BenchCommon.h"
+
+
+// A log window holding 1M lines: appending a message and scrolling, with a text document which
+// only lays out new and visible lines, against laying out every line again and against drawing
+// the visible lines with the immediate api.
+
+namespace
+{
+	const std::uint32_t DocumentLines = 1000000;
+	const float ViewHeight = 720.0f;
+	const float LineHeight = 16.0f;
+
+	/// The lines of the log, generated once and shared by the benchmarks.
+	const std::vector<std::string> &LogLines()
+	{
+		static std::vector<std::string> lines;
+		if (lines.empty())
+		{
+			lines.reserve(DocumentLines);
+			for (std::uint32_t i = 0; i < DocumentLines; ++i)
+				lines.push_back(Bench::MakeText(20 + i % 60, i + 1));
+		}
+		return lines;
+	}
+
+	/// Appends the lines of the log to a document in batches of 10k lines.
+	void AppendLog(std::uint32_t document, std::uint32_t count)
+	{
+		const std::vector<std::string> &lines = LogLines();
+		std::string batch;
+		for (std::uint32_t i = 0; i < count; ++i)
+		{
+			batch += lines[i];
+			batch += '\n';
+			if (i % 10000 == 9999 || i + 1 == count)
+			{
+				K2D_AppendTextDocumentUtf8(document, batch.data(), static_cast<std::uint32_t>(batch.size()));
+				batch.clear();
+			}
+		}
+	}
+
+	/// Creates the font of the log window.
+	std::uint32_t CreateLogFont(benchmark::State& state)
+	{
+		std::uint32_t font = K2D_CreateFont(Bench::FontPath().c_str(), 12.0f, 0.0f);
+		if (!font)
+			state.SkipWithError("no font available, set KYO2D_BENCH_FONT");
+		return font;
+	}
+
+	/// Appends one message to a document of 1M lines and draws the bottom of it.
+	void BM_DocumentAppend(benchmark::State& state)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+		std::uint32_t font = CreateLogFont(state);
+		if (!font)
+			return;
+
+		std::uint32_t document = K2D_CreateTextDocument(font, nullptr);
+		AppendLog(document, DocumentLines);
+
+		const std::string message = Bench::MakeText(60, 7) + "\n";
+		for (auto _ : state)
+		{
+			K2D_AppendTextDocumentUtf8(document, message.data(), static_cast<std::uint32_t>(message.size()));
+			double height = 0.0;
+			K2D_GetTextDocumentSize(document, &height, nullptr);
+			K2D_DrawTextDocument(document, 0.0f, 0.0f, height - ViewHeight, ViewHeight, 0xFFFFFFFF);
+			K2D_PresentRenderTarget();
+		}
+
+		std::uint32_t lines = 0;
+		K2D_GetTextDocumentSize(document, nullptr, &lines);
+		state.counters["lines"] = lines;
+	}
+	BENCHMARK(BM_DocumentAppend)->Unit(benchmark::kMicrosecond);
+
+	/// Full relayout: the document is rebuilt from all 1M lines for the appended message.
+	void BM_DocumentAppendFullRelayout(benchmark::State& state)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+		std::uint32_t font = CreateLogFont(state);
+		if (!font)
+			return;
+
+		LogLines();
+		std::uint32_t document = K2D_CreateTextDocument(font, nullptr);
+		for (auto _ : state)
+		{
+			K2D_ClearTextDocument(document);
+			AppendLog(document, DocumentLines);
+			double height = 0.0;
+			K2D_GetTextDocumentSize(document, &height, nullptr);
+			K2D_DrawTextDocument(document, 0.0f, 0.0f, height - ViewHeight, ViewHeight, 0xFFFFFFFF);
+			K2D_PresentRenderTarget();
+		}
+	}
+	BENCHMARK(BM_DocumentAppendFullRelayout)->Unit(benchmark::kMillisecond)->Iterations(3);
+
+	/// Jumps to a new position in a document of 1M lines every frame, so the visible lines are
+	/// always laid out anew.
+	void BM_DocumentScroll(benchmark::State& state)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+		std::uint32_t font = CreateLogFont(state);
+		if (!font)
+			return;
+
+		std::uint32_t document = K2D_CreateTextDocument(font, nullptr);
+		AppendLog(document, DocumentLines);
+		double height = 0.0;
+		K2D_GetTextDocumentSize(document, &height, nullptr);
+
+		std::uint32_t frame = 0;
+		for (auto _ : state)
+		{
+			double scroll = (frame++ * 7919.0 * ViewHeight);
+			scroll -= static_cast<std::uint64_t>(scroll / (height - ViewHeight)) * (height - ViewHeight);
+			K2D_DrawTextDocument(document, 0.0f, 0.0f, scroll, ViewHeight, 0xFFFFFFFF);
+			K2D_PresentRenderTarget();
+		}
+	}
+	BENCHMARK(BM_DocumentScroll)->Unit(benchmark::kMicrosecond);
+
+	/// Smooth scrolling by a few pixels per frame, most visible lines stay laid out.
+	void BM_DocumentScrollSmooth(benchmark::State& state)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+		std::uint32_t font = CreateLogFont(state);
+		if (!font)
+			return;
+
+		std::uint32_t document = K2D_CreateTextDocument(font, nullptr);
+		AppendLog(document, DocumentLines);
+		double height = 0.0;
+		K2D_GetTextDocumentSize(document, &height, nullptr);
+
+		double scroll = height / 2.0;
+		for (auto _ : state)
+		{
+			scroll += 3.0;
+			K2D_DrawTextDocument(document, 0.0f, 0.0f, scroll, ViewHeight, 0xFFFFFFFF);
+			K2D_PresentRenderTarget();
+		}
+	}
+	BENCHMARK(BM_DocumentScrollSmooth)->Unit(benchmark::kMicrosecond);
+
+	/// The previous approach: the application culls the lines and draws each visible one with
+	/// the immediate api, which lays it out unless the layout cache still holds it.
+	void BM_DocumentScrollImmediate(benchmark::State& state)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+		std::uint32_t font = CreateLogFont(state);
+		if (!font)
+			return;
+
+		const std::vector<std::string> &lines = LogLines();
+		const std::uint32_t visible = static_cast<std::uint32_t>(ViewHeight / LineHeight) + 1;
+		std::uint32_t frame = 0;
+		for (auto _ : state)
+		{
+			std::uint32_t first = (frame++ * 7919u * visible) % (DocumentLines - visible);
+			for (std::uint32_t i = 0; i < visible; ++i)
+			{
+				const std::string &line = lines[first + i];
+				K2D_DrawTextUtf8(font, line.data(), static_cast<std::uint32_t>(line.size()), 0.0f, i * LineHeight, 0xFFFFFFFF);
+			}
+			K2D_PresentRenderTarget();
+		}
+	}
+	BENCHMARK(BM_DocumentScrollImmediate)->Unit(benchmark::kMicrosecond);
+}
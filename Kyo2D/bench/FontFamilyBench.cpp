@@ -0,0 +1,85 @@
+#include "BenchCommon.h"
+
+
+// Memory and time of creating one font file at 6 sizes and 2 outline widths, as separate fonts
+// and as views of a font family sharing the file, face and glyph tables.
+
+namespace
+{
+	const float Sizes[] = { 10.0f, 12.0f, 14.0f, 16.0f, 20.0f, 24.0f };
+	const float Outlines[] = { 0.0f, 1.5f };
+	const std::uint32_t FontCount = 12;
+
+	/// Creates the 12 fonts, draws a line with each and destroys them again.
+	/// @param family The family to create the fonts from, 0 to create separate fonts.
+	/// @param out_heap Receives the heap bytes held by the fonts.
+	/// @return false if a font couldn't be created.
+	bool CreateFonts(std::uint32_t family, size_t &out_heap)
+	{
+		const std::wstring path = Bench::FontPath();
+		const std::string text = Bench::MakeText(40);
+		std::vector<std::uint32_t> fonts;
+
+		size_t before = Bench::HeapBytes();
+		for (float outline : Outlines)
+		{
+			for (float size : Sizes)
+			{
+				std::uint32_t font = family ? K2D_CreateFontFromFamily(family, size, outline) : K2D_CreateFont(path.c_str(), size, outline);
+				if (!font)
+					return false;
+				K2D_DrawTextUtf8(font, text.data(), static_cast<std::uint32_t>(text.size()), 0.0f, 0.0f, 0xFFFFFFFF);
+				fonts.push_back(font);
+			}
+		}
+		K2D_PresentRenderTarget();
+		out_heap = Bench::HeapBytes() - before;
+
+		for (std::uint32_t font : fonts)
+			K2D_DestroyFont(font);
+		return true;
+	}
+
+	void BM_FontSizesSeparate(benchmark::State& state)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+
+		size_t heap = 0;
+		for (auto _ : state)
+		{
+			if (!CreateFonts(0, heap))
+			{
+				state.SkipWithError("no font available, set KYO2D_BENCH_FONT");
+				return;
+			}
+		}
+
+		state.counters["heap_bytes"] = static_cast<double>(heap);
+		state.counters["heap_bytes_per_font"] = static_cast<double>(heap) / FontCount;
+	}
+	BENCHMARK(BM_FontSizesSeparate)->Unit(benchmark::kMillisecond);
+
+	void BM_FontSizesFamily(benchmark::State& state)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+
+		size_t heap = 0, familyHeap = 0;
+		for (auto _ : state)
+		{
+			size_t before = Bench::HeapBytes();
+			std::uint32_t family = K2D_CreateFontFamily(Bench::FontPath().c_str());
+			familyHeap = Bench::HeapBytes() - before;
+			if (!family || !CreateFonts(family, heap))
+			{
+				state.SkipWithError("no font available, set KYO2D_BENCH_FONT");
+				return;
+			}
+			K2D_DestroyFontFamily(family);
+		}
+
+		state.counters["heap_bytes"] = static_cast<double>(heap + familyHeap);
+		state.counters["heap_bytes_family"] = static_cast<double>(familyHeap);
+		state.counters["heap_bytes_per_font"] = static_cast<double>(heap) / FontCount;
+	}
+	BENCHMARK(BM_FontSizesFamily)->Unit(benchmark::kMillisecond);
+}
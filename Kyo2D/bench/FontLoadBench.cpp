@@ -0,0 +1,75 @@
+#include "BenchCommon.h"
+
+
+// Time and heap memory of creating a font which hasn't drawn anything yet. Glyph metrics are
+// loaded on first use, so neither should grow with the number of glyphs in the font.
+
+namespace
+{
+	void BM_CreateFont(benchmark::State& state, bool cjk)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+		const std::wstring path = cjk ? Bench::CjkFontPath() : Bench::FontPath();
+
+		size_t heap = 0;
+		for (auto _ : state)
+		{
+			size_t before = Bench::HeapBytes();
+			std::uint32_t font = K2D_CreateFont(path.c_str(), 16.0f, 0.0f);
+			if (!font)
+			{
+				state.SkipWithError("no font available, set KYO2D_BENCH_FONT");
+				return;
+			}
+
+			state.PauseTiming();
+			heap = Bench::HeapBytes() - before;
+			K2D_DestroyFont(font);
+			state.ResumeTiming();
+		}
+
+		state.counters["heap_bytes"] = static_cast<double>(heap);
+	}
+	BENCHMARK_CAPTURE(BM_CreateFont, latin, false)->Unit(benchmark::kMicrosecond);
+	BENCHMARK_CAPTURE(BM_CreateFont, cjk, true)->Unit(benchmark::kMicrosecond);
+
+	/// Creating the font and drawing its first line, which loads the metrics of the pages used.
+	void BM_CreateFontFirstText(benchmark::State& state, bool cjk)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+		const std::wstring path = cjk ? Bench::CjkFontPath() : Bench::FontPath();
+		std::u16string text;
+		if (cjk)
+		{
+			text = Bench::MakeCjkText(40);
+		}
+		else
+		{
+			std::string ascii = Bench::MakeText(40);
+			text.assign(ascii.begin(), ascii.end());
+		}
+
+		size_t heap = 0;
+		for (auto _ : state)
+		{
+			size_t before = Bench::HeapBytes();
+			std::uint32_t font = K2D_CreateFont(path.c_str(), 16.0f, 0.0f);
+			if (!font)
+			{
+				state.SkipWithError("no font available, set KYO2D_BENCH_FONT");
+				return;
+			}
+			K2D_DrawTextUtf16(font, text.data(), static_cast<std::uint32_t>(text.size()), 0.0f, 0.0f, 0xFFFFFFFF);
+			K2D_PresentRenderTarget();
+
+			state.PauseTiming();
+			heap = Bench::HeapBytes() - before;
+			K2D_DestroyFont(font);
+			state.ResumeTiming();
+		}
+
+		state.counters["heap_bytes"] = static_cast<double>(heap);
+	}
+	BENCHMARK_CAPTURE(BM_CreateFontFirstText, latin, false)->Unit(benchmark::kMicrosecond);
+	BENCHMARK_CAPTURE(BM_CreateFontFirstText, cjk, true)->Unit(benchmark::kMicrosecond);
+}
@@ -0,0 +1,112 @@
+#include "BenchCommon.h"
+
+
+// Startup of a font which draws the Latin range once: without a glyph cache, with an empty one
+// (the first run, which rasterizes everything and writes the cache) and with the cache of an
+// earlier run.
+
+namespace
+{
+	/// Text with every character from U+0020 to U+024F.
+	const std::u16string &LatinText()
+	{
+		static std::u16string text;
+		if (text.empty())
+		{
+			for (char16_t c = 0x20; c < 0x250; ++c)
+			{
+				if (c < 0x7F || c >= 0xA0)
+					text.push_back(c);
+			}
+		}
+		return text;
+	}
+
+	/// Creates a font, draws the text and destroys the font again.
+	/// @return The number of glyphs the font rasterized, or -1 if there's no font.
+	int StartFont(bool save)
+	{
+		std::uint32_t font = K2D_CreateFont(Bench::FontPath().c_str(), 16.0f, 0.0f);
+		if (!font)
+			return -1;
+
+		const std::u16string &text = LatinText();
+		K2D_DrawTextUtf16(font, text.data(), static_cast<std::uint32_t>(text.size()), 0.0f, 0.0f, 0xFFFFFFFF);
+		K2D_PresentRenderTarget();
+		if (save)
+			K2D_SaveGlyphCaches();
+		K2D_DestroyFont(font);
+		return static_cast<int>(K2D_GetFrameStats().GlyphsRasterized);
+	}
+
+	void BM_FontStartupNoCache(benchmark::State& state)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+		K2D_SetGlyphCacheDirectory(nullptr);
+
+		int rasterized = 0;
+		for (auto _ : state)
+		{
+			rasterized = StartFont(false);
+			if (rasterized < 0)
+			{
+				state.SkipWithError("no font available, set KYO2D_BENCH_FONT");
+				return;
+			}
+		}
+		state.counters["glyphs_rasterized"] = rasterized;
+	}
+	BENCHMARK(BM_FontStartupNoCache)->Unit(benchmark::kMillisecond);
+
+	/// The first run: nothing cached, the glyphs are rasterized and saved.
+	void BM_FontStartupColdCache(benchmark::State& state)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+
+		int rasterized = 0;
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			{
+				Bench::TempDirectory directory;
+				K2D_SetGlyphCacheDirectory(directory.GetPath().c_str());
+				state.ResumeTiming();
+
+				rasterized = StartFont(true);
+
+				state.PauseTiming();
+			}
+			state.ResumeTiming();
+
+			if (rasterized < 0)
+			{
+				state.SkipWithError("no font available, set KYO2D_BENCH_FONT");
+				return;
+			}
+		}
+		K2D_SetGlyphCacheDirectory(nullptr);
+		state.counters["glyphs_rasterized"] = rasterized;
+	}
+	BENCHMARK(BM_FontStartupColdCache)->Unit(benchmark::kMillisecond);
+
+	/// Later runs: every glyph and metric comes from the cache file.
+	void BM_FontStartupWarmCache(benchmark::State& state)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+		Bench::TempDirectory directory;
+		K2D_SetGlyphCacheDirectory(directory.GetPath().c_str());
+		if (StartFont(true) < 0)
+		{
+			state.SkipWithError("no font available, set KYO2D_BENCH_FONT");
+			return;
+		}
+
+		int rasterized = 0;
+		for (auto _ : state)
+			rasterized = StartFont(false);
+
+		K2D_SetGlyphCacheDirectory(nullptr);
+		state.counters["glyphs_rasterized"] = rasterized;
+	}
+	BENCHMARK(BM_FontStartupWarmCache)->Unit(benchmark::kMillisecond);
+}
@@ -0,0 +1,59 @@
+#include "BenchCommon.h"
+
+
+// Rasterization throughput of new glyphs against the number of glyph worker threads. Every
+// iteration draws the text with a new font, so each of its glyphs is rasterized once.
+
+namespace
+{
+	/// Draws the text with a new font of the given file and counts the rasterized glyphs.
+	void RasterizeText(benchmark::State& state, const std::wstring& fontPath, const std::u16string& text)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+		K2D_SetGlyphWorkerThreads(static_cast<std::uint32_t>(state.range(0)));
+
+		std::int64_t rasterized = 0;
+		for (auto _ : state)
+		{
+			state.PauseTiming();
+			std::uint32_t font = K2D_CreateFont(fontPath.c_str(), 16.0f, 0.0f);
+			if (!font)
+			{
+				state.SkipWithError("no font available, set KYO2D_BENCH_FONT");
+				return;
+			}
+			state.ResumeTiming();
+
+			K2D_DrawTextUtf16(font, text.data(), static_cast<std::uint32_t>(text.size()), 0.0f, 0.0f, 0xFFFFFFFF);
+			K2D_PresentRenderTarget();
+
+			state.PauseTiming();
+			rasterized += K2D_GetFrameStats().GlyphsRasterized;
+			K2D_DestroyFont(font);
+			state.ResumeTiming();
+		}
+
+		state.counters["glyphs_per_second"] = benchmark::Counter(static_cast<double>(rasterized), benchmark::Counter::kIsRate);
+		state.counters["glyphs"] = static_cast<double>(rasterized) / state.iterations();
+	}
+
+	/// Latin, Greek and Cyrillic.
+	void BM_RasterizeGlyphsLatin(benchmark::State& state)
+	{
+		std::u16string text;
+		for (char16_t c = 0x21; c < 0x530; ++c)
+		{
+			if (c < 0x7F || c >= 0xA1)
+				text.push_back(c);
+		}
+		RasterizeText(state, Bench::FontPath(), text);
+	}
+	BENCHMARK(BM_RasterizeGlyphsLatin)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+	/// A long CJK message, set KYO2D_BENCH_CJK_FONT to rasterize actual ideographs.
+	void BM_RasterizeGlyphsCjk(benchmark::State& state)
+	{
+		RasterizeText(state, Bench::CjkFontPath(), Bench::MakeCjkText(2000));
+	}
+	BENCHMARK(BM_RasterizeGlyphsCjk)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+}
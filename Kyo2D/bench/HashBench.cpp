@@ -0,0 +1,34 @@
+#include "BenchCommon.h"
+#include "Hash.h"
+
+
+namespace
+{
+	/// Hashes N bytes, the sizes of draw call parameters, glyph images and font files.
+	void BM_Hash(benchmark::State& state)
+	{
+		std::vector<std::uint8_t> data(static_cast<size_t>(state.range(0)), 0x5A);
+		for (auto _ : state)
+			benchmark::DoNotOptimize(Kyo2D::Hash(data.data(), data.size()));
+		state.SetBytesProcessed(state.iterations() * state.range(0));
+	}
+	BENCHMARK(BM_Hash)->Arg(16)->Arg(256)->Arg(64 << 10)->Arg(4 << 20);
+
+	/// The byte at a time FNV-1a hash used before, for comparison.
+	void BM_HashFnv1a(benchmark::State& state)
+	{
+		std::vector<std::uint8_t> data(static_cast<size_t>(state.range(0)), 0x5A);
+		for (auto _ : state)
+		{
+			std::uint64_t hash = 14695981039346656037ULL;
+			for (std::uint8_t byte : data)
+			{
+				hash ^= byte;
+				hash *= 1099511628211ULL;
+			}
+			benchmark::DoNotOptimize(hash);
+		}
+		state.SetBytesProcessed(state.iterations() * state.range(0));
+	}
+	BENCHMARK(BM_HashFnv1a)->Arg(16)->Arg(256)->Arg(64 << 10)->Arg(4 << 20);
+}
@@ -0,0 +1,62 @@
+#include "BenchCommon.h"
+
+
+// Glyph lookup cost of text layout over a Latin and a CJK corpus. The layouts are created once
+// before timing, so the timed runs only look up glyphs which are already rasterized.
+
+namespace
+{
+	/// Lays out N lines of 100 characters per iteration.
+	void LayoutLines(benchmark::State& state, const std::wstring& fontPath, const std::vector<std::wstring>& lines)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+		std::uint32_t font = K2D_CreateFont(fontPath.c_str(), 16.0f, 0.0f);
+		if (!font)
+		{
+			state.SkipWithError("no font available, set KYO2D_BENCH_FONT");
+			return;
+		}
+
+		for (const std::wstring& line : lines)
+			K2D_DestroyTextLayout(K2D_CreateTextLayout(font, line.c_str(), nullptr));
+
+		size_t characters = 0;
+		for (auto _ : state)
+		{
+			for (const std::wstring& line : lines)
+			{
+				std::uint32_t layout = K2D_CreateTextLayout(font, line.c_str(), nullptr);
+				benchmark::DoNotOptimize(layout);
+				K2D_DestroyTextLayout(layout);
+				characters += line.size();
+			}
+		}
+
+		state.SetItemsProcessed(static_cast<std::int64_t>(characters));
+	}
+
+	void BM_LayoutLatin(benchmark::State& state)
+	{
+		std::vector<std::wstring> lines;
+		for (int i = 0; i < state.range(0); ++i)
+		{
+			std::string text = Bench::MakeText(100, i + 1);
+			lines.emplace_back(text.begin(), text.end());
+		}
+		LayoutLines(state, Bench::FontPath(), lines);
+	}
+	BENCHMARK(BM_LayoutLatin)->Arg(100)->Unit(benchmark::kMicrosecond);
+
+	void BM_LayoutCjk(benchmark::State& state)
+	{
+		// Ideographs are in the basic multilingual plane, so each is one wchar_t on every platform
+		std::vector<std::wstring> lines;
+		for (int i = 0; i < state.range(0); ++i)
+		{
+			std::u16string text = Bench::MakeCjkText(100, i + 1);
+			lines.emplace_back(text.begin(), text.end());
+		}
+		LayoutLines(state, Bench::CjkFontPath(), lines);
+	}
+	BENCHMARK(BM_LayoutCjk)->Arg(100)->Unit(benchmark::kMicrosecond);
+}
@@ -0,0 +1,87 @@
+#include "BenchCommon.h"
+
+
+// Text measurement for UI layout passes. Measuring only reads glyph metrics, so the atlas must
+// stay empty however many strings are measured.
+
+namespace
+{
+	/// Labels of 8 to 40 characters, stored back to back as K2D_MeasureTexts expects them.
+	struct Labels
+	{
+		std::u16string Text;
+		std::vector<std::uint32_t> Lengths;
+	};
+
+	Labels MakeLabels(std::uint32_t count, bool cjk)
+	{
+		Labels labels;
+		for (std::uint32_t i = 0; i < count; ++i)
+		{
+			const size_t length = 8 + (i * 7919) % 33;
+			if (cjk)
+			{
+				labels.Text += Bench::MakeCjkText(length, i + 1);
+			}
+			else
+			{
+				std::string ascii = Bench::MakeText(length, i + 1);
+				labels.Text.append(ascii.begin(), ascii.end());
+			}
+			labels.Lengths.push_back(static_cast<std::uint32_t>(length));
+		}
+		return labels;
+	}
+
+	/// Measures N labels with one call per iteration.
+	void BM_MeasureTexts(benchmark::State& state, bool cjk)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+		std::uint32_t font = K2D_CreateFont((cjk ? Bench::CjkFontPath() : Bench::FontPath()).c_str(), 14.0f, 0.0f);
+		if (!font)
+		{
+			state.SkipWithError("no font available, set KYO2D_BENCH_FONT");
+			return;
+		}
+
+		const std::uint32_t count = static_cast<std::uint32_t>(state.range(0));
+		Labels labels = MakeLabels(count, cjk);
+		std::vector<K2D_TextMetrics> metrics(count);
+
+		for (auto _ : state)
+		{
+			K2D_MeasureTexts(font, labels.Text.data(), labels.Lengths.data(), count, 0.0f, metrics.data());
+			benchmark::DoNotOptimize(metrics.data());
+		}
+
+		state.counters["atlas_glyphs"] = K2D_GetGlyphAtlasStats().Glyphs;
+		state.SetItemsProcessed(state.iterations() * count);
+	}
+	BENCHMARK_CAPTURE(BM_MeasureTexts, latin, false)->Arg(10000)->Unit(benchmark::kMicrosecond);
+	BENCHMARK_CAPTURE(BM_MeasureTexts, cjk, true)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+	/// Wraps a paragraph of N characters into lines of 300 pixels.
+	void BM_WrapText(benchmark::State& state)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+		std::uint32_t font = K2D_CreateFont(Bench::FontPath().c_str(), 14.0f, 0.0f);
+		if (!font)
+		{
+			state.SkipWithError("no font available, set KYO2D_BENCH_FONT");
+			return;
+		}
+
+		std::string ascii = Bench::MakeText(static_cast<size_t>(state.range(0)));
+		std::u16string text(ascii.begin(), ascii.end());
+		std::vector<std::uint32_t> lineEnds(text.size());
+
+		std::uint32_t lines = 0;
+		for (auto _ : state)
+			lines = K2D_WrapText(font, text.data(), static_cast<std::uint32_t>(text.size()), 300.0f, 0.0f, lineEnds.data(), static_cast<std::uint32_t>(lineEnds.size()));
+
+		state.counters["lines"] = lines;
+		state.counters["atlas_glyphs"] = K2D_GetGlyphAtlasStats().Glyphs;
+		state.SetItemsProcessed(state.iterations() * text.size());
+	}
+	BENCHMARK(BM_WrapText)->Arg(10000)->Unit(benchmark::kMicrosecond);
+}
@@ -0,0 +1,76 @@
+#include "BenchCommon.h"
+
+
+// Fill rate and sprite throughput of the software backend at 1080p, with one worker thread and
+// with one per hardware thread.
+
+namespace
+{
+	const std::uint16_t Width = 1920;
+	const std::uint16_t Height = 1080;
+
+	/// Covers the frame N times with translucent rectangles, so every pixel is blended N times.
+	void BM_SoftwareFillRate(benchmark::State& state)
+	{
+		Bench::Engine engine(Bench::Backend::Software, Width, Height, static_cast<std::uint32_t>(state.range(1)));
+		const int layers = static_cast<int>(state.range(0));
+
+		for (auto _ : state)
+		{
+			K2D_ClearRenderTarget(0.0f, 0.0f, 0.0f);
+			for (int i = 0; i < layers; ++i)
+				K2D_FillRect(0.0f, 0.0f, Width, Height, 0x40804080u + i);
+			K2D_PresentRenderTarget();
+		}
+
+		state.counters["pixels_per_second"] = benchmark::Counter(static_cast<double>(state.iterations()) * layers * Width * Height,
+			benchmark::Counter::kIsRate);
+	}
+	BENCHMARK(BM_SoftwareFillRate)->ArgsProduct({ { 1, 8 }, { 1, 0 } })->Unit(benchmark::kMillisecond);
+
+	/// Draws N 32x32 sprites over 16 textures per frame, blended and with a colorkey.
+	void BM_SoftwareSprites(benchmark::State& state)
+	{
+		Bench::Engine engine(Bench::Backend::Software, Width, Height, static_cast<std::uint32_t>(state.range(1)));
+		const std::uint32_t sprites = static_cast<std::uint32_t>(state.range(0));
+		std::vector<std::uint32_t> textures = Bench::CreateTextures(16, 32);
+
+		for (auto _ : state)
+		{
+			K2D_ClearRenderTarget(0.0f, 0.0f, 0.0f);
+			for (std::uint32_t i = 0; i < sprites; ++i)
+			{
+				float x = static_cast<float>((i * 37) % (Width - 32));
+				float y = static_cast<float>((i * 91) % (Height - 32));
+				K2D_DrawSpriteAt(textures[i % textures.size()], x, y, 0.0f, 0.0f, 0xFFFFFFC0, 0xFF000000);
+			}
+			K2D_PresentRenderTarget();
+		}
+
+		state.SetItemsProcessed(state.iterations() * sprites);
+	}
+	BENCHMARK(BM_SoftwareSprites)->ArgsProduct({ { 1000, 5000 }, { 1, 0 } })->Unit(benchmark::kMillisecond);
+
+	/// Draws N rotated and scaled sprites per frame, which take the bilinear sampling path.
+	void BM_SoftwareSpritesTransformed(benchmark::State& state)
+	{
+		Bench::Engine engine(Bench::Backend::Software, Width, Height, static_cast<std::uint32_t>(state.range(1)));
+		const std::uint32_t sprites = static_cast<std::uint32_t>(state.range(0));
+		std::vector<std::uint32_t> textures = Bench::CreateTextures(16, 32);
+
+		for (auto _ : state)
+		{
+			K2D_ClearRenderTarget(0.0f, 0.0f, 0.0f);
+			for (std::uint32_t i = 0; i < sprites; ++i)
+			{
+				float x = static_cast<float>((i * 37) % (Width - 48));
+				float y = static_cast<float>((i * 91) % (Height - 48));
+				K2D_DrawSpriteScaled(textures[i % textures.size()], x, y, 48.0f, 48.0f, 0.0f, (i % 360) * 0.0174533f, 0xFFFFFFFF, 0);
+			}
+			K2D_PresentRenderTarget();
+		}
+
+		state.SetItemsProcessed(state.iterations() * sprites);
+	}
+	BENCHMARK(BM_SoftwareSpritesTransformed)->ArgsProduct({ { 1000, 5000 }, { 1, 0 } })->Unit(benchmark::kMillisecond);
+}
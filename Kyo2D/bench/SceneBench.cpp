@@ -0,0 +1,108 @@
+#include "BenchCommon.h"
+
+
+// Reproducible scenes which cover the common workloads of the engine. Every frame draws the same
+// content, so the results of different builds can be compared directly.
+
+namespace
+{
+	/// Draws N sprites spread over M textures per frame.
+	void BM_SpriteFrame(benchmark::State& state, Bench::Backend backend)
+	{
+		Bench::Engine engine(backend);
+		const std::uint32_t sprites = static_cast<std::uint32_t>(state.range(0));
+		std::vector<std::uint32_t> textures = Bench::CreateTextures(static_cast<std::uint32_t>(state.range(1)), 32);
+
+		for (auto _ : state)
+		{
+			K2D_ClearRenderTarget(0.0f, 0.0f, 0.0f);
+			for (std::uint32_t i = 0; i < sprites; ++i)
+			{
+				float x = static_cast<float>((i * 37) % 1248);
+				float y = static_cast<float>((i * 91) % 688);
+				K2D_DrawSpriteAt(textures[i % textures.size()], x, y, 0.0f, 0.0f, 0xFFFFFFFF, 0);
+			}
+			K2D_PresentRenderTarget();
+		}
+
+		K2D_FrameStats stats = K2D_GetFrameStats();
+		state.counters["draw_calls"] = stats.DrawCalls;
+		state.counters["texture_binds"] = stats.TextureBinds;
+		state.SetItemsProcessed(state.iterations() * sprites);
+	}
+	BENCHMARK_CAPTURE(BM_SpriteFrame, null, Bench::Backend::Null)
+		->ArgsProduct({ { 1000, 10000 }, { 1, 16, 256 } })->Unit(benchmark::kMicrosecond);
+	BENCHMARK_CAPTURE(BM_SpriteFrame, software, Bench::Backend::Software)
+		->ArgsProduct({ { 1000, 10000 }, { 1, 16, 256 } })->Unit(benchmark::kMicrosecond);
+
+	/// Draws a screen full of text per frame, N lines of 100 characters.
+	void BM_TextFrame(benchmark::State& state, Bench::Backend backend)
+	{
+		Bench::Engine engine(backend);
+		std::uint32_t font = K2D_CreateFont(Bench::FontPath().c_str(), 12.0f, 0.0f);
+		if (!font)
+		{
+			state.SkipWithError("no font available, set KYO2D_BENCH_FONT");
+			return;
+		}
+
+		const int lines = static_cast<int>(state.range(0));
+		std::vector<std::string> text;
+		for (int i = 0; i < lines; ++i)
+			text.push_back(Bench::MakeText(100, i + 1));
+
+		for (auto _ : state)
+		{
+			K2D_ClearRenderTarget(0.0f, 0.0f, 0.0f);
+			for (int i = 0; i < lines; ++i)
+				K2D_DrawTextUtf8(font, text[i].data(), static_cast<std::uint32_t>(text[i].size()), 4.0f, 4.0f + i * 14.0f, 0xFFFFFFFF);
+			K2D_PresentRenderTarget();
+		}
+
+		state.counters["glyphs_drawn"] = K2D_GetFrameStats().GlyphsDrawn;
+		state.SetItemsProcessed(state.iterations() * lines * 100);
+	}
+	BENCHMARK_CAPTURE(BM_TextFrame, null, Bench::Backend::Null)->Arg(50)->Unit(benchmark::kMicrosecond);
+	BENCHMARK_CAPTURE(BM_TextFrame, software, Bench::Backend::Software)->Arg(50)->Unit(benchmark::kMicrosecond);
+
+	/// Loads a font and draws its printable ASCII range once, the time until text first shows.
+	void BM_FontColdStart(benchmark::State& state)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+		std::wstring path = Bench::FontPath();
+		std::string ascii;
+		for (char c = ' '; c < 127; ++c)
+			ascii.push_back(c);
+
+		for (auto _ : state)
+		{
+			std::uint32_t font = K2D_CreateFont(path.c_str(), 16.0f, 0.0f);
+			if (!font)
+			{
+				state.SkipWithError("no font available, set KYO2D_BENCH_FONT");
+				return;
+			}
+			K2D_DrawTextUtf8(font, ascii.data(), static_cast<std::uint32_t>(ascii.size()), 0.0f, 0.0f, 0xFFFFFFFF);
+			K2D_PresentRenderTarget();
+			K2D_DestroyFont(font);
+		}
+	}
+	BENCHMARK(BM_FontColdStart)->Unit(benchmark::kMillisecond);
+
+	/// Creates and destroys M textures of 256x256 pixels.
+	void BM_TextureBulkLoad(benchmark::State& state)
+	{
+		Bench::Engine engine(Bench::Backend::Software);
+		const std::uint32_t count = static_cast<std::uint32_t>(state.range(0));
+
+		for (auto _ : state)
+		{
+			std::vector<std::uint32_t> textures = Bench::CreateTextures(count, 256);
+			for (std::uint32_t id : textures)
+				K2D_DestroyTexture(id);
+		}
+
+		state.SetBytesProcessed(state.iterations() * count * 256 * 256 * 4);
+	}
+	BENCHMARK(BM_TextureBulkLoad)->Arg(16)->Arg(256)->Unit(benchmark::kMillisecond);
+}
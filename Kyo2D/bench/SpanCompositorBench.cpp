@@ -0,0 +1,91 @@
+#include "BenchCommon.h"
+#include "SpanCompositor.h"
+#include <algorithm>
+
+using Kyo2D::SpanCompositor;
+
+
+namespace
+{
+	const std::int32_t ImageSize = 256;
+
+	/// Covers a 256x256 image with spans of the given width and varying coverage.
+	SpanCompositor::Spans MakeSpans(int width)
+	{
+		SpanCompositor::Spans spans;
+		for (int y = 0; y < ImageSize; ++y)
+		{
+			for (int x = 0; x < ImageSize; x += width)
+				spans.push_back(SpanCompositor::Span(x, y, std::min(width, ImageSize - x), (x * 3 + y * 5) & 0xFF));
+		}
+		return spans;
+	}
+
+	/// Blends white spans with SpanCompositor::BlendWhite.
+	void BM_BlendWhite(benchmark::State& state)
+	{
+		SpanCompositor::Spans spans = MakeSpans(static_cast<int>(state.range(0)));
+		SpanCompositor::Target target = { ImageSize, 0, ImageSize - 1 };
+		std::vector<std::uint32_t> image(ImageSize * ImageSize, 0x80402010);
+
+		for (auto _ : state)
+		{
+			SpanCompositor::BlendWhite(target, spans, image.data());
+			benchmark::DoNotOptimize(image.data());
+			benchmark::ClobberMemory();
+		}
+
+		state.SetItemsProcessed(state.iterations() * ImageSize * ImageSize);
+	}
+	BENCHMARK(BM_BlendWhite)->Arg(2)->Arg(8)->Arg(32)->Arg(256)->Unit(benchmark::kMicrosecond);
+
+	/// Blends the same spans one pixel at a time with the scalar path.
+	void BM_BlendWhiteScalar(benchmark::State& state)
+	{
+		SpanCompositor::Spans spans = MakeSpans(static_cast<int>(state.range(0)));
+		std::vector<std::uint32_t> image(ImageSize * ImageSize, 0x80402010);
+
+		for (auto _ : state)
+		{
+			for (const SpanCompositor::Span &span : spans)
+			{
+				std::uint32_t *row = image.data() + static_cast<size_t>(ImageSize - 1 - span.y) * ImageSize + span.x;
+				for (int x = 0; x < span.width; ++x)
+					row[x] = SpanCompositor::BlendWhitePixel(row[x], static_cast<std::uint32_t>(span.coverage));
+			}
+			benchmark::DoNotOptimize(image.data());
+			benchmark::ClobberMemory();
+		}
+
+		state.SetItemsProcessed(state.iterations() * ImageSize * ImageSize);
+	}
+	BENCHMARK(BM_BlendWhiteScalar)->Arg(2)->Arg(8)->Arg(32)->Arg(256)->Unit(benchmark::kMicrosecond);
+
+	/// Blends the same spans with the float arithmetic glyphs were composited with before.
+	void BM_BlendWhiteFloat(benchmark::State& state)
+	{
+		SpanCompositor::Spans spans = MakeSpans(static_cast<int>(state.range(0)));
+		std::vector<std::uint32_t> image(ImageSize * ImageSize, 0x80402010);
+
+		for (auto _ : state)
+		{
+			for (const SpanCompositor::Span &span : spans)
+			{
+				std::uint8_t *row = reinterpret_cast<std::uint8_t*>(image.data() + static_cast<size_t>(ImageSize - 1 - span.y) * ImageSize + span.x);
+				for (int x = 0; x < span.width; ++x)
+				{
+					std::uint8_t *dst = row + x * 4;
+					dst[0] = static_cast<std::uint8_t>((int)(dst[0] + ((255 - dst[0]) * span.coverage) / 255.0f));
+					dst[1] = static_cast<std::uint8_t>((int)(dst[1] + ((255 - dst[1]) * span.coverage) / 255.0f));
+					dst[2] = static_cast<std::uint8_t>((int)(dst[2] + ((255 - dst[2]) * span.coverage) / 255.0f));
+					dst[3] = static_cast<std::uint8_t>(std::min(255, dst[3] + span.coverage));
+				}
+			}
+			benchmark::DoNotOptimize(image.data());
+			benchmark::ClobberMemory();
+		}
+
+		state.SetItemsProcessed(state.iterations() * ImageSize * ImageSize);
+	}
+	BENCHMARK(BM_BlendWhiteFloat)->Arg(2)->Arg(8)->Arg(32)->Arg(256)->Unit(benchmark::kMicrosecond);
+}
@@ -0,0 +1,105 @@
+#include "BenchCommon.h"
+
+
+// CPU cost of drawing text through the glyph quad stream, on the null backend so that only the
+// engine side is measured. Throughput is reported in glyphs per millisecond.
+
+namespace
+{
+	const int Lines = 50;
+	const int LineLength = 100;
+
+	/// Sets the glyph counters from the glyphs drawn in the last frame, spaces don't count.
+	/// The rate is divided by 1000, so the console shows glyphs per millisecond as ".../s".
+	void SetGlyphCounters(benchmark::State& state)
+	{
+		const double glyphs = K2D_GetFrameStats().GlyphsDrawn;
+		state.counters["glyphs_per_ms"] = benchmark::Counter(glyphs * state.iterations() / 1000.0, benchmark::Counter::kIsRate);
+		state.counters["glyphs_drawn"] = glyphs;
+	}
+
+	/// The same lines every frame, which are drawn from the layout cache after the first frame.
+	void BM_DrawTextStatic(benchmark::State& state)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+		std::uint32_t font = K2D_CreateFont(Bench::FontPath().c_str(), 12.0f, 0.0f);
+		if (!font)
+		{
+			state.SkipWithError("no font available, set KYO2D_BENCH_FONT");
+			return;
+		}
+
+		std::vector<std::string> text;
+		for (int i = 0; i < Lines; ++i)
+			text.push_back(Bench::MakeText(LineLength, i + 1));
+
+		for (auto _ : state)
+		{
+			for (int i = 0; i < Lines; ++i)
+				K2D_DrawTextUtf8(font, text[i].data(), LineLength, 4.0f, 4.0f + i * 14.0f, 0xFFFFFFFF);
+			K2D_PresentRenderTarget();
+		}
+
+		SetGlyphCounters(state);
+	}
+	BENCHMARK(BM_DrawTextStatic)->Unit(benchmark::kMicrosecond);
+
+	/// New lines every frame, each of them is laid out before its quads are written.
+	void BM_DrawTextChanging(benchmark::State& state)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+		std::uint32_t font = K2D_CreateFont(Bench::FontPath().c_str(), 12.0f, 0.0f);
+		if (!font)
+		{
+			state.SkipWithError("no font available, set KYO2D_BENCH_FONT");
+			return;
+		}
+
+		// A line comes back after more frames than the layout cache keeps it
+		const int frames = 64;
+		std::vector<std::string> text;
+		for (int i = 0; i < Lines * frames; ++i)
+			text.push_back(Bench::MakeText(LineLength, i + 1));
+
+		int frame = 0;
+		for (auto _ : state)
+		{
+			const std::string *lines = &text[(frame++ % frames) * Lines];
+			for (int i = 0; i < Lines; ++i)
+				K2D_DrawTextUtf8(font, lines[i].data(), LineLength, 4.0f, 4.0f + i * 14.0f, 0xFFFFFFFF);
+			K2D_PresentRenderTarget();
+		}
+
+		SetGlyphCounters(state);
+	}
+	BENCHMARK(BM_DrawTextChanging)->Unit(benchmark::kMicrosecond);
+
+	/// Lines laid out once by the application with K2D_CreateTextLayout.
+	void BM_DrawTextLayouts(benchmark::State& state)
+	{
+		Bench::Engine engine(Bench::Backend::Null);
+		std::uint32_t font = K2D_CreateFont(Bench::FontPath().c_str(), 12.0f, 0.0f);
+		if (!font)
+		{
+			state.SkipWithError("no font available, set KYO2D_BENCH_FONT");
+			return;
+		}
+
+		std::vector<std::uint32_t> layouts;
+		for (int i = 0; i < Lines; ++i)
+		{
+			std::string text = Bench::MakeText(LineLength, i + 1);
+			layouts.push_back(K2D_CreateTextLayout(font, std::wstring(text.begin(), text.end()).c_str(), nullptr));
+		}
+
+		for (auto _ : state)
+		{
+			for (int i = 0; i < Lines; ++i)
+				K2D_DrawTextLayout(layouts[i], 4.0f, 4.0f + i * 14.0f, 0xFFFFFFFF);
+			K2D_PresentRenderTarget();
+		}
+
+		SetGlyphCounters(state);
+	}
+	BENCHMARK(BM_DrawTextLayouts)->Unit(benchmark::kMicrosecond);
+}
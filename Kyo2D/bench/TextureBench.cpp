@@ -0,0 +1,104 @@
+#include "BenchCommon.h"
+#include <algorithm>
+
+
+// Creation and partial updates of texture pages. Glyph pages used to be encoded as TGA and decoded
+// by DevIL, they are now created from raw pixels (A8 for plain glyphs) and updated a glyph at a time.
+
+namespace
+{
+	/// Fills a page with a pattern.
+	std::vector<std::uint8_t> MakePixels(std::uint32_t size, std::uint32_t bytesPerPixel)
+	{
+		std::vector<std::uint8_t> pixels(size * size * bytesPerPixel);
+		for (size_t i = 0; i < pixels.size(); ++i)
+			pixels[i] = static_cast<std::uint8_t>((i * 31) ^ (i >> 9));
+		return pixels;
+	}
+
+	/// Creates and destroys a page in the given format.
+	void BM_PageFromPixels(benchmark::State& state, Bench::Backend backend, std::uint32_t format, std::uint32_t bytesPerPixel)
+	{
+		Bench::Engine engine(backend);
+		const std::uint32_t size = static_cast<std::uint32_t>(state.range(0));
+		std::vector<std::uint8_t> pixels = MakePixels(size, bytesPerPixel);
+
+		for (auto _ : state)
+		{
+			std::uint32_t texture = K2D_CreateTextureFromPixels(size, size, format, size * bytesPerPixel, pixels.data());
+			if (!texture)
+			{
+				state.SkipWithError("texture creation failed");
+				return;
+			}
+			K2D_DestroyTexture(texture);
+		}
+
+		state.SetBytesProcessed(state.iterations() * pixels.size());
+	}
+	BENCHMARK_CAPTURE(BM_PageFromPixels, null_a8, Bench::Backend::Null, K2D_PIXEL_A8, 1)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond);
+	BENCHMARK_CAPTURE(BM_PageFromPixels, null_r8, Bench::Backend::Null, K2D_PIXEL_R8, 1)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond);
+	BENCHMARK_CAPTURE(BM_PageFromPixels, null_rgba8, Bench::Backend::Null, K2D_PIXEL_RGBA8, 4)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond);
+	BENCHMARK_CAPTURE(BM_PageFromPixels, software_a8, Bench::Backend::Software, K2D_PIXEL_A8, 1)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond);
+	BENCHMARK_CAPTURE(BM_PageFromPixels, software_r8, Bench::Backend::Software, K2D_PIXEL_R8, 1)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond);
+	BENCHMARK_CAPTURE(BM_PageFromPixels, software_rgba8, Bench::Backend::Software, K2D_PIXEL_RGBA8, 4)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond);
+	BENCHMARK_CAPTURE(BM_PageFromPixels, software_bgra8, Bench::Backend::Software, K2D_PIXEL_BGRA8, 4)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond);
+
+	/// Writes 32x32 glyphs into a 1024x1024 RGBA page, one region update per glyph.
+	void BM_PageRegionUpdate(benchmark::State& state, Bench::Backend backend)
+	{
+		Bench::Engine engine(backend);
+		std::vector<std::uint8_t> page = MakePixels(1024, 4);
+		std::vector<std::uint8_t> glyph = MakePixels(32, 4);
+		std::uint32_t texture = K2D_CreateTextureFromPixels(1024, 1024, K2D_PIXEL_RGBA8, 1024 * 4, page.data());
+
+		std::uint32_t slot = 0;
+		for (auto _ : state)
+		{
+			std::uint32_t x = (slot % 32) * 32;
+			std::uint32_t y = (slot / 32 % 32) * 32;
+			K2D_UpdateTextureRegion(texture, x, y, 32, 32, glyph.data());
+			++slot;
+		}
+
+		K2D_DestroyTexture(texture);
+		state.SetItemsProcessed(state.iterations());
+	}
+	BENCHMARK_CAPTURE(BM_PageRegionUpdate, null, Bench::Backend::Null);
+	BENCHMARK_CAPTURE(BM_PageRegionUpdate, software, Bench::Backend::Software);
+
+#ifndef K2D_NO_IMAGE_LOADER
+	/// The previous path: the page is encoded as an uncompressed TGA and decoded again.
+	void BM_PageFromTga(benchmark::State& state, Bench::Backend backend)
+	{
+		Bench::Engine engine(backend);
+		const std::uint32_t size = static_cast<std::uint32_t>(state.range(0));
+		std::vector<std::uint8_t> pixels = MakePixels(size, 4);
+
+		for (auto _ : state)
+		{
+			std::vector<std::uint8_t> file(18 + pixels.size(), 0);
+			file[2] = 2;
+			file[12] = static_cast<std::uint8_t>(size);
+			file[13] = static_cast<std::uint8_t>(size >> 8);
+			file[14] = static_cast<std::uint8_t>(size);
+			file[15] = static_cast<std::uint8_t>(size >> 8);
+			file[16] = 32;
+			file[17] = 0x28;
+			std::copy(pixels.begin(), pixels.end(), file.begin() + 18);
+
+			std::uint32_t texture = K2D_CreateTextureFromMemory(reinterpret_cast<const char*>(file.data()), static_cast<std::uint32_t>(file.size()));
+			if (!texture)
+			{
+				state.SkipWithError("texture creation failed");
+				return;
+			}
+			K2D_DestroyTexture(texture);
+		}
+
+		state.SetBytesProcessed(state.iterations() * pixels.size());
+	}
+	BENCHMARK_CAPTURE(BM_PageFromTga, null, Bench::Backend::Null)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond);
+	BENCHMARK_CAPTURE(BM_PageFromTga, software, Bench::Backend::Software)->Arg(256)->Arg(1024)->Unit(benchmark::kMicrosecond);
+#endif
+}
@@ -0,0 +1,141 @@
+#include "BenchCommon.h"
+#include "TextView.h"
+
+
+// UTF-8 decoding of TextReader, which finds ASCII runs a word or 16 bytes at a time and decodes
+// 2 and 3 byte sequences inline, against a decoder which looks at every byte.
+
+namespace
+{
+	/// Kind of text decoded.
+	enum class Corpus
+	{
+		Ascii,	// generated words
+		Latin,	// words with an accented letter (2 bytes) every few characters
+		Cjk		// ideographs (3 bytes) and spaces
+	};
+
+	/// Appends a codepoint as UTF-8.
+	void AppendUtf8(std::string &text, std::uint32_t c)
+	{
+		if (c < 0x80)
+		{
+			text.push_back(static_cast<char>(c));
+		}
+		else if (c < 0x800)
+		{
+			text.push_back(static_cast<char>(0xC0 | (c >> 6)));
+			text.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+		}
+		else
+		{
+			text.push_back(static_cast<char>(0xE0 | (c >> 12)));
+			text.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+			text.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+		}
+	}
+
+	/// Generates about 64 KB of UTF-8 text.
+	std::string MakeCorpus(Corpus corpus)
+	{
+		const size_t size = 64 << 10;
+		std::string text;
+		if (corpus == Corpus::Ascii)
+			return Bench::MakeText(size);
+
+		if (corpus == Corpus::Latin)
+		{
+			std::string ascii = Bench::MakeText(size);
+			for (size_t i = 0; i < ascii.size() && text.size() < size; ++i)
+				AppendUtf8(text, i % 7 == 3 ? 0xE0 + (ascii[i] % 32) : static_cast<std::uint32_t>(ascii[i]));
+			return text;
+		}
+
+		for (char16_t c : Bench::MakeCjkText(size / 3))
+			AppendUtf8(text, c);
+		return text;
+	}
+
+	/// Decodes one codepoint a byte at a time, with the validation of TextReader.
+	std::uint32_t DecodeScalar(const std::uint8_t *bytes, size_t available, size_t &out_length)
+	{
+		const std::uint32_t lead = bytes[0];
+		out_length = 1;
+		if (lead < 0x80)
+			return lead;
+
+		size_t length;
+		std::uint32_t codepoint, minimum;
+		if (lead < 0xC2)
+			return Kyo2D::TextReader::ReplacementCharacter;
+		else if (lead < 0xE0)
+			length = 2, codepoint = lead & 0x1F, minimum = 0x80;
+		else if (lead < 0xF0)
+			length = 3, codepoint = lead & 0x0F, minimum = 0x800;
+		else if (lead < 0xF5)
+			length = 4, codepoint = lead & 0x07, minimum = 0x10000;
+		else
+			return Kyo2D::TextReader::ReplacementCharacter;
+
+		for (size_t i = 1; i < length; ++i)
+		{
+			if (i >= available || (bytes[i] & 0xC0) != 0x80)
+			{
+				out_length = i;
+				return Kyo2D::TextReader::ReplacementCharacter;
+			}
+			codepoint = (codepoint << 6) | (bytes[i] & 0x3F);
+		}
+
+		out_length = length;
+		if (codepoint < minimum || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+			return Kyo2D::TextReader::ReplacementCharacter;
+		return codepoint;
+	}
+
+	void BM_Utf8Decode(benchmark::State& state, Corpus corpus)
+	{
+		const std::string text = MakeCorpus(corpus);
+		for (auto _ : state)
+		{
+			Kyo2D::TextReader reader(Kyo2D::TextView(text.data(), text.size()));
+			std::uint32_t sum = 0, codepoint;
+			while (reader.Next(codepoint))
+				sum += codepoint;
+			benchmark::DoNotOptimize(sum);
+		}
+		state.SetBytesProcessed(state.iterations() * text.size());
+	}
+	BENCHMARK_CAPTURE(BM_Utf8Decode, ascii, Corpus::Ascii);
+	BENCHMARK_CAPTURE(BM_Utf8Decode, latin, Corpus::Latin);
+	BENCHMARK_CAPTURE(BM_Utf8Decode, cjk, Corpus::Cjk);
+
+	void BM_Utf8DecodeScalar(benchmark::State& state, Corpus corpus)
+	{
+		const std::string text = MakeCorpus(corpus);
+		const std::uint8_t *bytes = reinterpret_cast<const std::uint8_t*>(text.data());
+		for (auto _ : state)
+		{
+			std::uint32_t sum = 0;
+			size_t length;
+			for (size_t i = 0; i < text.size(); i += length)
+				sum += DecodeScalar(bytes + i, text.size() - i, length);
+			benchmark::DoNotOptimize(sum);
+		}
+		state.SetBytesProcessed(state.iterations() * text.size());
+	}
+	BENCHMARK_CAPTURE(BM_Utf8DecodeScalar, ascii, Corpus::Ascii);
+	BENCHMARK_CAPTURE(BM_Utf8DecodeScalar, latin, Corpus::Latin);
+	BENCHMARK_CAPTURE(BM_Utf8DecodeScalar, cjk, Corpus::Cjk);
+
+	/// The ASCII scan on its own.
+	void BM_CountAscii(benchmark::State& state)
+	{
+		const std::string text = MakeCorpus(Corpus::Ascii);
+		const std::uint8_t *bytes = reinterpret_cast<const std::uint8_t*>(text.data());
+		for (auto _ : state)
+			benchmark::DoNotOptimize(Kyo2D::TextReader::CountAscii(bytes, text.size()));
+		state.SetBytesProcessed(state.iterations() * text.size());
+	}
+	BENCHMARK(BM_CountAscii);
+}
@@ -0,0 +1,15 @@
+Texture2D Texture;
+SamplerState ss;
+
+float4 main(float4 position : SV_POSITION, 
+			float4 color : COLOR, 
+			float2 texcoord : TEXCOORD0, 
+			float4 colorkey : TEXCOORD1
+			) : SV_TARGET
+{
+	// Alpha-only textures store the coverage in their single (red) channel,
+	// the color comes from the vertex color alone.
+	float Coverage = Texture.Sample(ss, texcoord.xy).r;
+
+	return float4(color.rgb, color.a * Coverage);
+}
@@ -0,0 +1,18 @@
+Texture2D Texture;
+SamplerState ss;
+
+float4 main(float4 position : SV_POSITION, 
+			float4 color : COLOR, 
+			float2 texcoord : TEXCOORD0, 
+			float4 colorkey : TEXCOORD1
+			) : SV_TARGET
+{
+	// Distance fields are stored in the red channel, 0.5 lies on the glyph edge.
+	// The colorkey carries the threshold (r) and the width of the smooth edge (g),
+	// so outlines and shadows are drawn from the same field with other thresholds.
+	float Distance = Texture.Sample(ss, texcoord.xy).r;
+	float Smoothing = max(colorkey.g, 1.0 / 512.0);
+	float Coverage = smoothstep(colorkey.r - Smoothing, colorkey.r + Smoothing, Distance);
+
+	return float4(color.rgb, color.a * Coverage);
+}
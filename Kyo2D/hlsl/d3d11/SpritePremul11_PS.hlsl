@@ -0,0 +1,15 @@
+Texture2D Texture;
+SamplerState ss;
+
+float4 main(float4 position : SV_POSITION, 
+			float4 color : COLOR, 
+			float2 texcoord : TEXCOORD0, 
+			float4 colorkey : TEXCOORD1
+			) : SV_TARGET
+{
+	float4 Center = Texture.Sample(ss, texcoord.xy);
+
+	// Texture is premultiplied and has its colorkey baked into alpha,
+	// so only the vertex color needs to be premultiplied here.
+	return float4(color.rgb * color.a, color.a) * Center;
+}
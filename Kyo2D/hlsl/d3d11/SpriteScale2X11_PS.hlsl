@@ -32,7 +32,7 @@ float4 main(float4 position : SV_POSITION,
 	}
 
 	bool Match1 = (Up.r == Left.r && Up.g == Left.g && Up.b == Left.b && Up.a == Left.a);
-	bool Match2 = (Up.r != Right.r || Up.g != Right.g || Up.b != Right.g || Up.a != Right.a);
+	bool Match2 = (Up.r != Right.r || Up.g != Right.g || Up.b != Right.b || Up.a != Right.a);
 	bool Match3 = (Left.r != Bottom.r || Left.g != Bottom.g || Left.b != Bottom.b || Left.a != Bottom.a);
 	if (Match1 && Match2 && Match3)
 	{
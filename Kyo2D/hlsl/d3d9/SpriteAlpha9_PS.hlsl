@@ -0,0 +1,14 @@
+sampler state;
+
+float4 main(float4 position : POSITION, 
+			float4 color : COLOR0, 
+			float2 texcoord : TEXCOORD0,
+			float4 colorkey : TEXCOORD1
+			) : COLOR0
+{
+	// Alpha-only textures (D3DFMT_A8) store the coverage in alpha,
+	// the color comes from the vertex color alone.
+	float Coverage = tex2D(state, texcoord.xy).a;
+
+	return float4(color.rgb, color.a * Coverage);
+}
@@ -0,0 +1,16 @@
+sampler state;
+
+float4 main(float4 position : POSITION, 
+			float4 color : COLOR0, 
+			float2 texcoord : TEXCOORD0,
+			float4 colorkey : TEXCOORD1
+			) : COLOR0
+{
+	// Distance fields (D3DFMT_A8) are stored in alpha, 0.5 lies on the glyph edge.
+	// The colorkey carries the threshold (r) and the width of the smooth edge (g).
+	float Distance = tex2D(state, texcoord.xy).a;
+	float Smoothing = max(colorkey.g, 1.0 / 512.0);
+	float Coverage = smoothstep(colorkey.r - Smoothing, colorkey.r + Smoothing, Distance);
+
+	return float4(color.rgb, color.a * Coverage);
+}
@@ -0,0 +1,14 @@
+sampler state;
+
+float4 main(float4 position : POSITION, 
+			float4 color : COLOR0, 
+			float2 texcoord : TEXCOORD0,
+			float4 colorkey : TEXCOORD1
+			) : COLOR0
+{
+	float4 Center = tex2D(state, texcoord.xy);
+
+	// Texture is premultiplied and has its colorkey baked into alpha,
+	// so only the vertex color needs to be premultiplied here.
+	return float4(color.rgb * color.a, color.a) * Center;
+}
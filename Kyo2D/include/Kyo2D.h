@@ -1,6 +1,7 @@
 
 #pragma once
 
+#ifdef _WIN32
 // Windows specific headers
 #include <Windows.h>
 
@@ -9,6 +10,11 @@
 #include <d3d9.h>
 #include <DirectXMath.h>
 #include <comptr.h>
+#else
+// Window handle placeholder so the api can be declared without Windows.h. Only the software
+// backend with a null handle (headless rendering) is available on other platforms.
+typedef void *HWND;
+#endif
 
 // STL headers
 #include <memory>
@@ -20,17 +26,25 @@
 
 
 // API Definition
+#ifdef _WIN32
+#	define K2D_EXPORT __declspec(dllexport)
+#	define K2D_IMPORT __declspec(dllimport)
+#else
+#	define K2D_EXPORT __attribute__((visibility("default")))
+#	define K2D_IMPORT
+#endif
+
 #ifdef KYO2D_EXPORTS
 #	ifdef __cplusplus
-#		define K2D_API extern "C" __declspec(dllexport)
+#		define K2D_API extern "C" K2D_EXPORT
 #	else
-#		define K2D_API __declspec(dllexport)
+#		define K2D_API K2D_EXPORT
 #	endif
 #else
 #	ifdef __cplusplus
-#		define K2D_API extern "C" __declspec(dllimport)
+#		define K2D_API extern "C" K2D_IMPORT
 #	else
-#		define K2D_API  __declspec(dllimport)
+#		define K2D_API  K2D_IMPORT
 #	endif
 #endif
 
@@ -43,7 +57,7 @@ struct K2D_Point
 /// Vertex structure used for rendering 2D geometry using the helper functions (DrawPoint, DrawLine etc.)
 struct Vertex2D
 {
-	FLOAT X, Y, Z;		// position
+	float X, Y, Z;		// position
 	std::int32_t Color;	// color
 };
 
@@ -51,6 +65,125 @@ struct Vertex2D
 typedef void(*DecodeTexPtr)();
 
 
+/// Load flags for K2D_CreateTextureEx and K2D_CreateTextureFromMemoryEx.
+enum K2D_TextureFlags
+{
+	/// Converts the texture to premultiplied alpha once at load time. Sprites using such a texture
+	/// are drawn without the per-pixel colorkey test, so the colorkey argument of the draw calls is ignored.
+	K2D_TEXTURE_PREMULTIPLIED	= 0x01,
+	/// Makes every pixel matching the given colorkey fully transparent at load time.
+	/// Implies K2D_TEXTURE_PREMULTIPLIED.
+	K2D_TEXTURE_BAKE_COLORKEY	= 0x02
+};
+
+/// Pixel formats for K2D_CreateTextureFromPixels.
+enum K2D_PixelFormat
+{
+	/// One byte per pixel, stored in the red channel. Green and blue are 0, alpha is opaque.
+	K2D_PIXEL_R8				= 0,
+	/// Four bytes per pixel in the order red, green, blue, alpha (0xAABBGGRR as integer).
+	K2D_PIXEL_RGBA8				= 1,
+	/// Four bytes per pixel in the order blue, green, red, alpha (0xAARRGGBB as integer).
+	K2D_PIXEL_BGRA8				= 2,
+	/// One byte per pixel used as alpha, the color is white. Stored with one byte per pixel,
+	/// sprites drawn from such a texture take their color from the RGBA argument alone.
+	K2D_PIXEL_A8				= 3
+};
+
+/// Damage tracking statistics returned by K2D_GetDamageStats.
+struct K2D_DamageStats
+{
+	std::uint32_t DirtyRects;			// number of rectangles redrawn in the last frame
+	std::uint64_t PixelsRedrawn;		// pixels redrawn in the last frame
+	std::uint64_t PixelsFullFrame;		// pixels of the last frame
+	std::uint64_t TotalPixelsRedrawn;	// pixels redrawn since damage tracking was enabled
+	std::uint64_t TotalPixelsFullFrame;	// pixels of all frames since damage tracking was enabled
+};
+
+/// Texture memory statistics returned by K2D_GetTextureMemoryStats.
+struct K2D_TextureMemoryStats
+{
+	std::uint64_t Budget;			// configured budget in bytes, 0 if unlimited
+	std::uint64_t Usage;			// video memory used by resident textures in bytes
+	std::uint32_t ResidentTextures;	// number of textures currently in video memory
+	std::uint32_t EvictedTextures;	// number of textures currently evicted
+	std::uint64_t Evictions;		// total number of evictions
+	std::uint64_t Restores;			// total number of restores
+};
+
+/// Statistics of the last presented frame returned by K2D_GetFrameStats.
+struct K2D_FrameStats
+{
+	std::uint32_t DrawCalls;		// draw calls issued to the backend
+	std::uint32_t Vertices;			// vertices submitted with the draw calls
+	std::uint32_t BufferMaps;		// vertex buffer maps (locks with Direct3D 9)
+	std::uint32_t TextureBinds;		// texture binds
+	std::uint32_t StageChanges;		// render state switches between sprites and 2D helpers
+	std::uint32_t GlyphsRasterized;	// glyphs rasterized by fonts
+	std::uint32_t GlyphsDrawn;		// glyph quads drawn, see the "DrawGlyphs" profiler zone for their time
+	std::uint32_t TexturesCreated;	// textures created
+	std::uint64_t BytesUploaded;	// pixel bytes uploaded to textures
+	float FrameTime;				// time between the last two presents in milliseconds
+	bool SlowFrame;					// frame time exceeded the threshold set with K2D_SetSlowFrameThreshold
+};
+
+/// Glyph atlas statistics returned by K2D_GetGlyphAtlasStats.
+struct K2D_GlyphAtlasStats
+{
+	std::uint32_t Pages;			// number of atlas textures
+	std::uint32_t PageSize;			// edge length of an atlas texture in pixels
+	std::uint32_t Glyphs;			// number of glyphs stored in the atlas
+	float Occupancy;				// fraction of the atlas area allocated to glyphs (0 - 1)
+	std::uint64_t BytesUploaded;	// pixel bytes uploaded for glyphs, divide by Glyphs for the cost per glyph
+	std::uint64_t Memory;			// texture memory of all atlas pages in bytes
+	std::uint64_t Budget;			// budget for Memory set with K2D_SetGlyphAtlasBudget, 0 if unlimited
+	std::uint64_t GlyphsEvicted;	// glyphs evicted from the atlas to stay within the budget
+	std::uint32_t Compactions;		// number of times the atlas has been compacted
+};
+
+/// Appearance of text drawn with K2D_DrawTextEx. Zero the structure and set the members needed.
+struct K2D_TextStyle
+{
+	std::uint32_t RGBA;				// text color
+	float Scale;					// size relative to the size the font was created with, 0 means 1
+	float OutlineWidth;				// outline width in pixels on screen (distance field fonts only)
+	std::uint32_t OutlineRGBA;		// outline color, no outline if the alpha is 0
+	float ShadowOffsetX;			// horizontal offset of the shadow in pixels
+	float ShadowOffsetY;			// vertical offset of the shadow in pixels
+	float ShadowSoftness;			// width of the blurred shadow edge in pixels (distance field fonts only)
+	std::uint32_t ShadowRGBA;		// shadow color, no shadow if the alpha is 0
+};
+
+/// Options of text layouts created with K2D_CreateTextLayout. Zero the structure and set the members needed.
+struct K2D_TextLayoutOptions
+{
+	float Scale;					// size relative to the size the font was created with, 0 means 1
+};
+
+/// Options of text documents created with K2D_CreateTextDocument. Zero the structure and set the members needed.
+struct K2D_TextDocumentOptions
+{
+	float Scale;					// size relative to the size the font was created with, 0 means 1
+	float WrapWidth;				// lines are wrapped at this width in pixels, 0 disables wrapping
+	float ParagraphSpacing;			// additional space in pixels below each paragraph
+};
+
+/// Size of a text measured with K2D_MeasureTexts.
+struct K2D_TextMetrics
+{
+	float Width;					// width of the text in pixels, up to the right edge of its last glyph image
+	float Advance;					// advance of the text in pixels, the position of a following text
+	float Height;					// height of the text line in pixels
+};
+
+/// Called by K2D_ReplayCapture after each replayed frame.
+/// @param Frame Index of the frame, starting at 0.
+/// @param Milliseconds Time the engine took to execute the calls of the frame.
+/// @param Stats Statistics of the frame.
+/// @param User The user pointer passed to K2D_ReplayCapture.
+typedef void(*K2D_ReplayFrameCallback)(std::uint32_t Frame, float Milliseconds, const K2D_FrameStats *Stats, void *User);
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // GLOBAL ENGINE METHODS
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -58,6 +191,14 @@ typedef void(*DecodeTexPtr)();
 /// Initializes the Kyo2D engine.
 K2D_API void K2D_Init(bool useD3D11);
 
+/// Initializes the Kyo2D engine with the multi-threaded software rasterizer instead of Direct3D.
+/// @param WorkerThreads Number of threads rasterizing a frame, 0 uses one per hardware thread.
+K2D_API void K2D_InitSoftware(std::uint32_t WorkerThreads);
+
+/// Initializes the Kyo2D engine with the null backend, which keeps track of all objects but
+/// doesn't render anything. Useful to measure the cost of the engine itself, e.g. with K2D_ReplayCapture.
+K2D_API void K2D_InitNull();
+
 /// Terminates the Kyo2D engine, destroying all objects which are still initialized.
 K2D_API void K2D_Terminate();
 
@@ -66,6 +207,30 @@ K2D_API bool K2D_Direct3D11Supported();
 
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// CONTEXT MANAGEMENT
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Creates a new engine context. A context owns its device, render targets, textures and fonts and
+/// shares nothing with other contexts, so different threads can render with different contexts at
+/// the same time. All other methods work on the context which is current on the calling thread.
+/// The new context has to be initialized with K2D_Init or K2D_InitSoftware after making it current.
+/// @returns The context handle, never 0.
+K2D_API std::uint32_t K2D_CreateContext();
+
+/// Terminates and destroys a context. It must not be current on any other thread.
+K2D_API bool K2D_DestroyContext(std::uint32_t Context);
+
+/// Makes a context current on the calling thread. Context 0 is the default context, which is
+/// current on every thread that didn't select another one. A context may only be current on
+/// one thread at a time.
+K2D_API bool K2D_MakeContextCurrent(std::uint32_t Context);
+
+/// Gets the context which is current on the calling thread.
+K2D_API std::uint32_t K2D_GetCurrentContext();
+
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // RENDER TARGET MANAGEMENT
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -73,6 +238,29 @@ K2D_API bool K2D_Direct3D11Supported();
 /// Creates a new render target.
 K2D_API std::uint32_t K2D_CreateRenderTarget(HWND Handle, std::uint16_t Width, std::uint16_t Height, bool Fullscreen);
 
+/// Creates a new offscreen render target which renders into a texture instead of a window.
+/// Use it to cache rarely changing layers (like HUD panels): render the layer into the target only
+/// while it is dirty and draw its texture (see K2D_GetRenderTargetTexture) as a single sprite every frame.
+/// Offscreen targets start dirty. Presenting an offscreen target marks it clean instead of swapping
+/// buffers. Their contents are opaque: clear them with a colorkey color and pass the same colorkey
+/// when drawing the texture to get transparent areas. Offscreen targets can't be resized.
+K2D_API std::uint32_t K2D_CreateOffscreenTarget(std::uint16_t Width, std::uint16_t Height);
+
+/// Gets the texture id of an offscreen render target, usable with all sprite drawing methods.
+/// Returns 0 for window render targets. The texture is destroyed together with the render target.
+K2D_API std::uint32_t K2D_GetRenderTargetTexture(std::uint32_t RenderTarget);
+
+/// Marks the contents of an offscreen render target as outdated, so it will be redrawn.
+K2D_API bool K2D_InvalidateRenderTarget(std::uint32_t RenderTarget);
+
+/// Determines if an offscreen render target needs to be redrawn.
+K2D_API bool K2D_IsRenderTargetDirty(std::uint32_t RenderTarget);
+
+/// Copies the contents of a render target into Buffer as 0xAABBGGRR pixels, row by row.
+/// Only supported by the software renderer, where a window handle of nullptr creates a headless render target.
+/// @param BufferSize Size of Buffer in pixels, at least width * height of the render target.
+K2D_API bool K2D_ReadRenderTargetPixels(std::uint32_t RenderTarget, std::uint32_t *Buffer, std::uint32_t BufferSize);
+
 /// Destroys the given render target
 K2D_API bool K2D_DestroyRenderTarget(std::uint32_t RenderTarget);
 
@@ -85,12 +273,71 @@ K2D_API bool K2D_ClearRenderTarget(float r, float g, float b);
 /// Activates a specific render target.
 K2D_API bool K2D_SetVSyncEnabled(bool Enable);
 
-/// Presents the active render target.
+/// Presents the active render target. For offscreen render targets, this marks them clean.
 K2D_API bool K2D_PresentRenderTarget();
 
 /// Resizes the active render target.
 K2D_API bool K2D_ResizeRenderTarget(std::uint16_t Width, std::uint16_t Height);
 
+/// Enables or disables damage tracking for window render targets (disabled by default).
+/// While enabled, draw calls are deferred until the render target is presented. The engine compares
+/// them with the draw calls of the previous frame and only clears and redraws the areas which changed.
+/// If supported by the backend, only these areas are presented as well. The application still issues
+/// all draw calls of a frame, including K2D_ClearRenderTarget, like it would without damage tracking.
+/// Draw calls to offscreen render targets are never deferred.
+K2D_API void K2D_SetDamageTrackingEnabled(bool Enable);
+
+/// Forces the next frame to be redrawn completely, e.g. after the window has been covered.
+K2D_API void K2D_InvalidateDamage();
+
+/// Gets the damage tracking statistics.
+K2D_API K2D_DamageStats K2D_GetDamageStats();
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// PROFILING
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Gets the statistics of the last frame. A frame ends when a window render target is presented.
+K2D_API K2D_FrameStats K2D_GetFrameStats();
+
+/// Sets the number of frames the profiler keeps timed zones of (0 by default, which disables recording).
+/// Zones are placed around texture binding and loading, glyph rasterization and presenting. They are
+/// compiled out completely if the engine is built with KYO2D_DISABLE_PROFILER.
+K2D_API void K2D_SetProfilerHistory(std::uint32_t Frames);
+
+/// Sets the frame time in milliseconds above which a frame is marked as slow (0 disables the check).
+/// Slow frames are flagged in the frame statistics and in the trace, together with the zones which took the most time.
+K2D_API void K2D_SetSlowFrameThreshold(float Milliseconds);
+
+/// Writes the recorded frames to a Chrome trace json file (open with chrome://tracing).
+K2D_API bool K2D_WriteProfilerTrace(const wchar_t *Filename);
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// CAPTURE
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Starts recording every call that changes the state of the current context to a binary capture
+/// file, including the bytes of all textures and fonts created meanwhile. Objects created before
+/// the capture started are unknown to it, so start capturing right after initializing the engine.
+/// A running capture of the context is finished first.
+K2D_API bool K2D_BeginCapture(const wchar_t *Filename);
+
+/// Finishes the capture of the current context.
+K2D_API void K2D_EndCapture();
+
+/// Executes the calls of a capture file on the current context as fast as possible. The context
+/// has to be initialized, the backend doesn't need to match the one the capture was recorded with.
+/// @param Window Window used for the captured window render targets. Pass nullptr for headless
+/// replays with the software or null backend.
+/// @param Callback Called after each frame with its timing and statistics, may be nullptr.
+/// @param User Passed to the callback.
+/// @returns The number of frames replayed.
+K2D_API std::uint32_t K2D_ReplayCapture(const wchar_t *Filename, HWND Window, K2D_ReplayFrameCallback Callback, void *User);
+
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -103,12 +350,44 @@ K2D_API std::uint32_t K2D_CreateTexture(const wchar_t *Filename);
 /// Creates a new texture from memory.
 K2D_API std::uint32_t K2D_CreateTextureFromMemory(const char *data, std::uint32_t size);
 
+/// Creates a new texture from a given file using the given load flags (see K2D_TextureFlags).
+/// Use this for textures with a fixed colorkey: the colorkey is baked into the alpha channel, so
+/// sprites with different colorkeys share the same render state. Textures whose colorkey changes
+/// at runtime should keep using K2D_CreateTexture.
+/// @param Colorkey The colorkey to bake (0xAABBGGRR), only used with K2D_TEXTURE_BAKE_COLORKEY.
+K2D_API std::uint32_t K2D_CreateTextureEx(const wchar_t *Filename, std::uint32_t Flags, std::uint32_t Colorkey);
+
+/// Creates a new texture from memory using the given load flags (see K2D_CreateTextureEx).
+K2D_API std::uint32_t K2D_CreateTextureFromMemoryEx(const char *data, std::uint32_t size, std::uint32_t Flags, std::uint32_t Colorkey);
+
+/// Creates a new texture from raw pixels. The pixels are uploaded directly, without the
+/// encode/decode round-trip of K2D_CreateTextureFromMemory. Such textures can't be evicted.
+/// @param Format The format of Data (see K2D_PixelFormat).
+/// @param Stride Bytes between the starts of two rows, 0 for tightly packed rows.
+/// @return The new texture id or 0 if an error occurred.
+K2D_API std::uint32_t K2D_CreateTextureFromPixels(std::uint32_t Width, std::uint32_t Height, std::uint32_t Format, std::uint32_t Stride, const void *Data);
+
+/// Replaces the pixels of a region of a texture. Only the region is uploaded.
+/// @param Data Tightly packed pixels in the format the texture was created with, RGBA8 for
+/// textures not created by K2D_CreateTextureFromPixels.
+/// @return false if the texture doesn't exist or the region exceeds it.
+K2D_API bool K2D_UpdateTextureRegion(std::uint32_t TextureId, std::uint32_t X, std::uint32_t Y, std::uint32_t Width, std::uint32_t Height, const void *Data);
+
 /// Destroys a texture.
 K2D_API bool K2D_DestroyTexture(std::uint32_t TextureId);
 
 /// Returns a textures size. If the texture is invalid, the returned size will be 0.
 K2D_API K2D_Point K2D_GetTextureSize(std::uint32_t TextureId);
 
+/// Sets the video memory budget for textures in bytes (0 = unlimited, the default).
+/// If the budget is exceeded, the least recently used textures are evicted and reloaded from their
+/// source file or a cpu copy of their data as soon as they are drawn again. Textures drawn in the
+/// current frame are never evicted, so the budget may be exceeded temporarily.
+K2D_API void K2D_SetTextureBudget(std::uint64_t Bytes);
+
+/// Gets the current texture budget and memory usage.
+K2D_API K2D_TextureMemoryStats K2D_GetTextureMemoryStats();
+
 /// Registers a new texture decoder for a specific extension.
 K2D_API std::uint32_t K2D_RegisterTextureDecoder(const wchar_t *extension, DecodeTexPtr decoder);
 
@@ -164,6 +443,72 @@ K2D_API std::uint32_t K2D_CreateFont(const wchar_t* Filename, float PointSize, f
 /// @return The new font id or 0 if an error occurred.
 K2D_API std::uint32_t K2D_CreateFontFromMemory(const std::uint8_t* Buffer, std::uint32_t BufferSize, float PointSize, float Outline);
 
+/// Creates a distance field font from a ttf file. Each glyph is rendered once at the reference
+/// size into a signed distance field, which K2D_DrawTextEx draws sharp at any scale, with
+/// outline and soft shadow, from the same atlas pages.
+/// @param Filename The name of the font file.
+/// @param ReferenceSize The font size in points the distance fields are rendered at.
+/// @return The new font id or 0 if an error occurred.
+K2D_API std::uint32_t K2D_CreateFontSDF(const wchar_t* Filename, float ReferenceSize);
+
+/// Creates a distance field font from the file contents of a ttf file, see K2D_CreateFontSDF.
+/// @param Buffer The buffer which contains the file contents of a ttf file.
+/// @param BufferSize Size of the buffer.
+/// @param ReferenceSize The font size in points the distance fields are rendered at.
+/// @return The new font id or 0 if an error occurred.
+K2D_API std::uint32_t K2D_CreateFontSDFFromMemory(const std::uint8_t* Buffer, std::uint32_t BufferSize, float ReferenceSize);
+
+/// Loads a font family from a ttf file. A family holds the file contents and the glyph table
+/// once for all fonts created from it, so a font of another size or outline width costs only
+/// the metrics and images of its glyphs.
+/// @param Filename The name of the font file.
+/// @return The new font family id or 0 if an error occurred.
+K2D_API std::uint32_t K2D_CreateFontFamily(const wchar_t* Filename);
+
+/// Loads a font family from the file contents of a ttf file, see K2D_CreateFontFamily.
+/// @param Buffer The buffer which contains the file contents of a ttf file.
+/// @param BufferSize Size of the buffer.
+/// @return The new font family id or 0 if an error occurred.
+K2D_API std::uint32_t K2D_CreateFontFamilyFromMemory(const std::uint8_t* Buffer, std::uint32_t BufferSize);
+
+/// Creates a font from a font family, see K2D_CreateFont.
+/// @param FamilyId The id of the font family.
+/// @param PointSize The font size in points.
+/// @param Outline The outline width in pixels.
+/// @return The new font id or 0 if an error occurred.
+K2D_API std::uint32_t K2D_CreateFontFromFamily(std::uint32_t FamilyId, float PointSize, float Outline);
+
+/// Creates a distance field font from a font family, see K2D_CreateFontSDF.
+/// @param FamilyId The id of the font family.
+/// @param ReferenceSize The font size in points the distance fields are rendered at.
+/// @return The new font id or 0 if an error occurred.
+K2D_API std::uint32_t K2D_CreateFontSDFFromFamily(std::uint32_t FamilyId, float ReferenceSize);
+
+/// Destroys a font family. Fonts created from it stay valid and release the family with the last of them.
+/// @param FamilyId The id of the font family to destroy.
+/// @return false if the family couldn't be found.
+K2D_API bool K2D_DestroyFontFamily(std::uint32_t FamilyId);
+
+/// Sets the directory glyph images and metrics are cached in between runs. Fonts created afterwards read the
+/// glyphs they need from the cache of an earlier run instead of rasterizing them. The glyphs they rasterize
+/// are only written to the cache by K2D_SaveGlyphCaches. The cache of a font is kept in one file per font
+/// file contents, size and outline width. Damaged or outdated files are ignored and replaced.
+/// @param Directory An existing directory, nullptr or an empty string to stop caching glyphs.
+K2D_API void K2D_SetGlyphCacheDirectory(const wchar_t* Directory);
+
+/// Sets the number of threads new glyphs are rasterized on, including the calling thread. Glyphs are
+/// packed into the atlas in the same order for any number of threads.
+/// @param Threads The number of threads, 1 rasterizes on the calling thread only, 0 (the default)
+///		uses one thread per hardware thread.
+K2D_API void K2D_SetGlyphWorkerThreads(std::uint32_t Threads);
+
+/// Writes the glyphs rasterized and measured by the fonts of the current context to their glyph cache
+/// files. Call it at a point where file I/O doesn't hurt, e.g. after loading a level or before exiting.
+/// Fonts destroyed before are not saved. Each font holds at most 4 MB of new glyph images until it is saved,
+/// glyphs rasterized past that are rasterized again in the next run.
+/// @return false if a file couldn't be written.
+K2D_API bool K2D_SaveGlyphCaches();
+
 /// Destroys a created font.
 /// @param FontId The id of the font to destroy.
 /// @return false if the font couldn't be destroyed.
@@ -178,6 +523,156 @@ K2D_API bool K2D_DestroyFont(std::uint32_t FontId);
 /// @return false if the font couldn't be found or an error occurred.
 K2D_API bool K2D_DrawText(std::uint32_t FontId, const wchar_t* Text, float X, float Y, std::uint32_t RGBA);
 
+/// Draws UTF-8 text at the given location using the given font. The text is decoded in place,
+/// so strings of managed code can be passed as they are. Malformed sequences are drawn as U+FFFD.
+/// @param FontId The id of the font to use.
+/// @param Text The text to display, doesn't have to be null-terminated.
+/// @param Length The length of the text in bytes.
+/// @param X The x coordinate.
+/// @param Y The y coordinate.
+/// @param RGBA The text color.
+/// @return false if the font couldn't be found or an error occurred.
+K2D_API bool K2D_DrawTextUtf8(std::uint32_t FontId, const char* Text, std::uint32_t Length, float X, float Y, std::uint32_t RGBA);
+
+/// Draws UTF-16 text at the given location using the given font, see K2D_DrawTextUtf8. Surrogate
+/// pairs are combined, unpaired surrogates are drawn as U+FFFD.
+/// @param FontId The id of the font to use.
+/// @param Text The text to display, doesn't have to be null-terminated.
+/// @param Length The length of the text in 16-bit code units.
+/// @param X The x coordinate.
+/// @param Y The y coordinate.
+/// @param RGBA The text color.
+/// @return false if the font couldn't be found or an error occurred.
+K2D_API bool K2D_DrawTextUtf16(std::uint32_t FontId, const char16_t* Text, std::uint32_t Length, float X, float Y, std::uint32_t RGBA);
+
+/// Draws a string at the given location with the given style. Distance field fonts draw the
+/// outline and a soft shadow from their fields, other fonts draw the shadow as an offset copy.
+/// @param FontId The id of the font to use.
+/// @param Text The text to display.
+/// @param X The x coordinate.
+/// @param Y The y coordinate.
+/// @param Style The appearance of the text.
+/// @return false if the font couldn't be found or the parameters are invalid.
+K2D_API bool K2D_DrawTextEx(std::uint32_t FontId, const wchar_t* Text, float X, float Y, const K2D_TextStyle* Style);
+
+/// Lays out a string once for drawing it many times. The glyphs of the text are looked up and
+/// rasterized now, drawing the layout only submits the prepared glyph quads. Texts which are
+/// drawn every frame with K2D_DrawText are cached as layouts automatically.
+/// @param FontId The id of the font to use. The layout keeps the font alive.
+/// @param Text The text of the layout.
+/// @param Options Layout options, nullptr for the defaults.
+/// @return The new layout id or 0 if an error occurred.
+K2D_API std::uint32_t K2D_CreateTextLayout(std::uint32_t FontId, const wchar_t* Text, const K2D_TextLayoutOptions* Options);
+
+/// Destroys a text layout.
+/// @param LayoutId The id of the layout to destroy.
+/// @return false if the layout couldn't be found.
+K2D_API bool K2D_DestroyTextLayout(std::uint32_t LayoutId);
+
+/// Draws a text layout at the given location.
+/// @param LayoutId The id of the layout to draw.
+/// @param X The x coordinate.
+/// @param Y The y coordinate.
+/// @param RGBA The text color.
+/// @return false if the layout couldn't be found.
+K2D_API bool K2D_DrawTextLayout(std::uint32_t LayoutId, float X, float Y, std::uint32_t RGBA);
+
+/// Gets the size of a text layout.
+/// @param LayoutId The id of the layout.
+/// @param Width Receives the advance of the text in pixels, may be nullptr.
+/// @param Height Receives the height of the text line in pixels, may be nullptr.
+/// @return false if the layout couldn't be found.
+K2D_API bool K2D_GetTextLayoutSize(std::uint32_t LayoutId, float* Width, float* Height);
+
+/// Creates a document for long texts like logs or chat histories. The text is broken into lines
+/// once when it is appended, drawing a document only lays out the lines inside the drawn range
+/// and keeps them until they scroll out of it.
+/// @param FontId The id of the font to use. The document keeps the font alive.
+/// @param Options The options of the document, may be nullptr.
+/// @return The new document id or 0 if the font couldn't be found.
+K2D_API std::uint32_t K2D_CreateTextDocument(std::uint32_t FontId, const K2D_TextDocumentOptions* Options);
+
+/// Destroys a text document.
+/// @param DocumentId The id of the document.
+/// @return false if the document couldn't be found.
+K2D_API bool K2D_DestroyTextDocument(std::uint32_t DocumentId);
+
+/// Appends UTF-8 text to a document. Newlines end paragraphs, text after the last newline is
+/// continued by the next append. Only the continued paragraph and the new ones are broken into lines.
+/// @param DocumentId The id of the document.
+/// @param Text The text to append, doesn't have to be null-terminated.
+/// @param Length The length of the text in bytes.
+/// @return false if the document couldn't be found.
+K2D_API bool K2D_AppendTextDocumentUtf8(std::uint32_t DocumentId, const char* Text, std::uint32_t Length);
+
+/// Appends UTF-16 text to a document, see K2D_AppendTextDocumentUtf8.
+/// @param DocumentId The id of the document.
+/// @param Text The text to append, doesn't have to be null-terminated.
+/// @param Length The length of the text in 16-bit code units.
+/// @return false if the document couldn't be found.
+K2D_API bool K2D_AppendTextDocumentUtf16(std::uint32_t DocumentId, const char16_t* Text, std::uint32_t Length);
+
+/// Removes all text of a document.
+/// @param DocumentId The id of the document.
+/// @return false if the document couldn't be found.
+K2D_API bool K2D_ClearTextDocument(std::uint32_t DocumentId);
+
+/// Draws the lines of a document inside a vertical range.
+/// @param DocumentId The id of the document.
+/// @param X The x coordinate of the left edge of the document.
+/// @param Y The y coordinate the top of the range is drawn at.
+/// @param ScrollY The top of the range in the document in pixels.
+/// @param ViewHeight The height of the range in pixels.
+/// @param RGBA The text color.
+/// @return false if the document couldn't be found.
+K2D_API bool K2D_DrawTextDocument(std::uint32_t DocumentId, float X, float Y, double ScrollY, float ViewHeight, std::uint32_t RGBA);
+
+/// Gets the size of a text document.
+/// @param DocumentId The id of the document.
+/// @param Height Receives the height of the document in pixels, may be nullptr.
+/// @param Lines Receives the number of lines after wrapping, may be nullptr.
+/// @return false if the document couldn't be found.
+K2D_API bool K2D_GetTextDocumentSize(std::uint32_t DocumentId, double* Height, std::uint32_t* Lines);
+
+/// Measures many UTF-16 texts with one call. Only the advances and bounding boxes of the glyphs
+/// are read, no glyph is rasterized, so measuring doesn't touch the glyph atlas.
+/// @param FontId The id of the font to use.
+/// @param Texts The texts, stored back to back.
+/// @param Lengths The length of each text in 16-bit code units.
+/// @param Count The number of texts.
+/// @param Scale Size relative to the size the font was created with, 0 means 1.
+/// @param Metrics Receives the size of each text.
+/// @return false if the font couldn't be found or the parameters are invalid.
+K2D_API bool K2D_MeasureTexts(std::uint32_t FontId, const char16_t* Texts, const std::uint32_t* Lengths, std::uint32_t Count, float Scale, K2D_TextMetrics* Metrics);
+
+/// Breaks a UTF-16 text into lines no wider than a maximum width, in one pass over the glyph
+/// metrics like K2D_MeasureTexts. Lines end after newlines and wrap after spaces, which don't
+/// count towards the width of their line. Words wider than a line are broken between characters.
+/// @param FontId The id of the font to use.
+/// @param Text The text, doesn't have to be null-terminated.
+/// @param Length The length of the text in 16-bit code units.
+/// @param MaxWidth The maximum width of a line in pixels.
+/// @param Scale Size relative to the size the font was created with, 0 means 1.
+/// @param LineEnds Receives the end of each line, the index of the code unit following the line.
+///		Each line starts at the end of the previous one, the last ends at Length.
+/// @param MaxLines The number of line ends LineEnds can hold.
+/// @return The number of lines, which may be more than MaxLines. 0 if the font couldn't be found.
+K2D_API std::uint32_t K2D_WrapText(std::uint32_t FontId, const char16_t* Text, std::uint32_t Length, float MaxWidth, float Scale, std::uint32_t* LineEnds, std::uint32_t MaxLines);
+
+/// Gets the statistics of the glyph atlas. The glyphs of all fonts of the current context
+/// are packed into one shared set of atlas textures, glyphs are added when first drawn.
+/// Glyphs of fonts without outline are stored in alpha-only pages with one byte per pixel,
+/// distance field fonts have pages of their own.
+K2D_API K2D_GlyphAtlasStats K2D_GetGlyphAtlasStats();
+
+/// Sets the budget for the texture memory of the glyph atlas, 64 MB by default. Every glyph
+/// remembers the frame it was drawn in last. When a frame is presented with the atlas over
+/// budget, the least recently drawn glyphs are evicted and the rest are packed into fewer pages.
+/// Glyphs drawn in the presented frame are never evicted, so the budget may be exceeded by
+/// frames which draw more glyphs than it holds. Evicted glyphs are rasterized again when drawn.
+/// @param Bytes The budget in bytes, 0 disables the budget.
+K2D_API void K2D_SetGlyphAtlasBudget(std::uint64_t Bytes);
+
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // 2D DRAWING OPERATION HELPERS
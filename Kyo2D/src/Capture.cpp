@@ -0,0 +1,723 @@
+#include "Capture.h"
+#include "EngineContext.h"
+#include "Hash.h"
+#include "File.h"
+#include "Texture.h"
+#include <chrono>
+#include <set>
+
+namespace
+{
+	/// Identifies capture files.
+	const char CaptureMagic[4] = { 'K', '2', 'D', 'C' };
+	/// Format version, increased whenever a record changes.
+	const std::uint32_t CaptureVersion = 2;
+	/// Blob reference of assets which couldn't be read.
+	const std::uint32_t InvalidBlob = 0xFFFFFFFF;
+
+	/// Gets the new id of a captured object, 0 if it doesn't exist.
+	std::uint32_t MapId(const std::map<std::uint32_t, std::uint32_t> &ids, std::uint32_t id)
+	{
+		auto it = ids.find(id);
+		return it != ids.end() ? it->second : 0;
+	}
+}
+
+namespace Kyo2D
+{
+	//=============================================================================
+	// CaptureWriter
+	//=============================================================================
+
+	CaptureWriter::CaptureWriter()
+	{
+	}
+
+	CaptureWriter::~CaptureWriter()
+	{
+	}
+
+	bool CaptureWriter::Open(const std::wstring &filename)
+	{
+#ifdef _WIN32
+		m_Stream.open(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+#else
+		m_Stream.open(narrowFilename(filename).c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+#endif
+		if (!m_Stream.is_open())
+			return false;
+
+		m_Stream.write(CaptureMagic, sizeof(CaptureMagic));
+		m_Stream.write(reinterpret_cast<const char*>(&CaptureVersion), sizeof(CaptureVersion));
+		return m_Stream.good();
+	}
+
+	void CaptureWriter::Write(CaptureOp op, const std::vector<std::uint8_t> &payload)
+	{
+		std::uint8_t type = op;
+		std::uint32_t size = static_cast<std::uint32_t>(payload.size());
+		m_Stream.write(reinterpret_cast<const char*>(&type), sizeof(type));
+		m_Stream.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		if (size)
+			m_Stream.write(reinterpret_cast<const char*>(payload.data()), size);
+	}
+
+	std::uint32_t CaptureWriter::AddBlob(const void *data, size_t size)
+	{
+		// Assets are usually created more than once (e.g. after a level change), store them only once
+		std::pair<std::uint64_t, size_t> key(Hash(data, size), size);
+		auto it = m_BlobIndices.find(key);
+		if (it != m_BlobIndices.end())
+			return it->second;
+
+		std::uint8_t type = capture_op::Blob;
+		std::uint32_t blobSize = static_cast<std::uint32_t>(size);
+		m_Stream.write(reinterpret_cast<const char*>(&type), sizeof(type));
+		m_Stream.write(reinterpret_cast<const char*>(&blobSize), sizeof(blobSize));
+		m_Stream.write(reinterpret_cast<const char*>(data), blobSize);
+
+		std::uint32_t index = static_cast<std::uint32_t>(m_BlobIndices.size());
+		m_BlobIndices[key] = index;
+		return index;
+	}
+
+	//=============================================================================
+	// CaptureReader
+	//=============================================================================
+
+	CaptureReader::CaptureReader()
+		: m_Offset(0), m_Remaining(0)
+	{
+	}
+
+	CaptureReader::~CaptureReader()
+	{
+	}
+
+	bool CaptureReader::Open(const std::wstring &filename)
+	{
+#ifdef _WIN32
+		m_Stream.open(filename.c_str(), std::ios::in | std::ios::binary);
+#else
+		m_Stream.open(narrowFilename(filename).c_str(), std::ios::in | std::ios::binary);
+#endif
+		if (!m_Stream.is_open())
+			return false;
+
+		m_Stream.seekg(0, std::ios::end);
+		std::streamoff length = m_Stream.tellg();
+		m_Stream.seekg(0, std::ios::beg);
+
+		char magic[sizeof(CaptureMagic)];
+		std::uint32_t version = 0;
+		m_Stream.read(magic, sizeof(magic));
+		m_Stream.read(reinterpret_cast<char*>(&version), sizeof(version));
+		m_Remaining = length > static_cast<std::streamoff>(sizeof(magic) + sizeof(version)) ? static_cast<std::uint64_t>(length) - sizeof(magic) - sizeof(version) : 0;
+		return m_Stream.good() && std::memcmp(magic, CaptureMagic, sizeof(magic)) == 0 && version == CaptureVersion;
+	}
+
+	bool CaptureReader::Next(CaptureOp &op)
+	{
+		for (;;)
+		{
+			std::uint8_t type = 0;
+			std::uint32_t size = 0;
+			m_Stream.read(reinterpret_cast<char*>(&type), sizeof(type));
+			m_Stream.read(reinterpret_cast<char*>(&size), sizeof(size));
+			if (!m_Stream || m_Remaining < sizeof(type) + sizeof(size))
+				return false;
+			m_Remaining -= sizeof(type) + sizeof(size);
+
+			// A corrupt size must not allocate more than the file could hold
+			if (size > m_Remaining)
+				return false;
+			m_Remaining -= size;
+
+			m_Record.resize(size);
+			if (size && !m_Stream.read(reinterpret_cast<char*>(m_Record.data()), size))
+				return false;
+
+			// Blobs are kept until the end of the replay, calls refer to them by index
+			if (type == capture_op::Blob)
+			{
+				m_Blobs.push_back(std::move(m_Record));
+				m_Record.clear();
+				continue;
+			}
+
+			op = static_cast<CaptureOp>(type);
+			m_Offset = 0;
+			return true;
+		}
+	}
+
+	std::wstring CaptureReader::ReadString()
+	{
+		// Strings are stored as UTF-16, which matches wchar_t on Windows
+		std::uint32_t length = Read<std::uint32_t>();
+		if (length > (m_Record.size() - m_Offset) / sizeof(std::uint16_t))
+			length = static_cast<std::uint32_t>((m_Record.size() - m_Offset) / sizeof(std::uint16_t));
+
+		std::wstring text;
+		text.reserve(length);
+
+		for (std::uint32_t i = 0; i < length; ++i)
+		{
+			std::uint32_t c = Read<std::uint16_t>();
+			if (sizeof(wchar_t) > 2 && c >= 0xD800 && c <= 0xDFFF)
+			{
+				// Surrogates aren't valid code points on their own, only a high one followed by
+				// a low one is combined. Anything else is replaced and the next unit is kept.
+				std::uint16_t low = 0;
+				if (c <= 0xDBFF && i + 1 < length)
+					std::memcpy(&low, &m_Record[m_Offset], sizeof(low));
+
+				if (low >= 0xDC00 && low <= 0xDFFF)
+				{
+					m_Offset += sizeof(low);
+					++i;
+					c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+				}
+				else
+					c = 0xFFFD;
+			}
+			text += static_cast<wchar_t>(c);
+		}
+
+		return text;
+	}
+
+	std::vector<std::uint8_t> CaptureReader::ReadBytes()
+	{
+		std::uint32_t size = Read<std::uint32_t>();
+		if (size > m_Record.size() - m_Offset)
+			size = static_cast<std::uint32_t>(m_Record.size() - m_Offset);
+
+		std::vector<std::uint8_t> bytes(m_Record.begin() + m_Offset, m_Record.begin() + m_Offset + size);
+		m_Offset += size;
+		return bytes;
+	}
+
+	const std::vector<std::uint8_t> *CaptureReader::ReadBlob()
+	{
+		std::uint32_t index = Read<std::uint32_t>();
+		return index < m_Blobs.size() ? &m_Blobs[index] : nullptr;
+	}
+
+	//=============================================================================
+	// CaptureCall
+	//=============================================================================
+
+	CaptureCall::CaptureCall(CaptureOp op)
+		: m_Op(op)
+		, m_Active(g_Context->Capture && g_Context->CaptureDepth == 0)
+	{
+		g_Context->CaptureDepth++;
+	}
+
+	CaptureCall::~CaptureCall()
+	{
+		g_Context->CaptureDepth--;
+
+		if (m_Active && g_Context->Capture)
+			g_Context->Capture->Write(m_Op, m_Payload);
+	}
+
+	CaptureCall& CaptureCall::String(const wchar_t *text)
+	{
+		if (!m_Active)
+			return *this;
+
+		std::vector<std::uint16_t> units;
+		for (; text && *text; ++text)
+		{
+			std::uint32_t c = static_cast<std::uint32_t>(*text);
+			if (c >= 0x10000)
+			{
+				c -= 0x10000;
+				units.push_back(static_cast<std::uint16_t>(0xD800 + (c >> 10)));
+				units.push_back(static_cast<std::uint16_t>(0xDC00 + (c & 0x3FF)));
+			}
+			else
+			{
+				units.push_back(static_cast<std::uint16_t>(c));
+			}
+		}
+
+		*this << static_cast<std::uint32_t>(units.size());
+		for (std::uint16_t unit : units)
+			*this << unit;
+		return *this;
+	}
+
+	CaptureCall& CaptureCall::Bytes(const void *data, size_t size)
+	{
+		if (!m_Active)
+			return *this;
+
+		if (!data)
+			size = 0;
+
+		*this << static_cast<std::uint32_t>(size);
+		const std::uint8_t *bytes = static_cast<const std::uint8_t*>(data);
+		m_Payload.insert(m_Payload.end(), bytes, bytes + size);
+		return *this;
+	}
+
+	CaptureCall& CaptureCall::Blob(const void *data, size_t size)
+	{
+		if (!m_Active)
+			return *this;
+
+		if (!data || !size)
+			return *this << InvalidBlob;
+
+		return *this << g_Context->Capture->AddBlob(data, size);
+	}
+
+	CaptureCall& CaptureCall::File(const wchar_t *filename)
+	{
+		if (!m_Active)
+			return *this;
+
+		// Replays must not depend on the files of the captured machine
+		FileData data;
+		if (!filename || !readFileContents(filename, data) || data.empty())
+			return *this << InvalidBlob;
+
+		return Blob(data.data(), data.size());
+	}
+
+	//=============================================================================
+	// Replay
+	//=============================================================================
+
+	std::uint32_t ReplayCapture(const std::wstring &filename, HWND window, K2D_ReplayFrameCallback callback, void *user)
+	{
+		CaptureReader reader;
+		if (!reader.Open(filename))
+			return 0;
+
+		std::map<std::uint32_t, std::uint32_t> renderTargets;
+		std::map<std::uint32_t, std::uint32_t> textures;
+		std::map<std::uint32_t, std::uint32_t> fonts;
+		std::map<std::uint32_t, std::uint32_t> fontFamilies;
+		std::map<std::uint32_t, std::uint32_t> textLayouts;
+		std::map<std::uint32_t, std::uint32_t> textDocuments;
+		std::set<std::uint32_t> windowTargets;
+		std::uint32_t activeTarget = 0;
+		std::uint32_t frames = 0;
+
+		auto frameStart = std::chrono::steady_clock::now();
+
+		CaptureOp op;
+		while (reader.Next(op))
+		{
+			switch (op)
+			{
+				case capture_op::CreateRenderTarget:
+				{
+					std::uint16_t width = reader.Read<std::uint16_t>();
+					std::uint16_t height = reader.Read<std::uint16_t>();
+					reader.Read<bool>(); // Fullscreen, replays always run windowed
+					std::uint32_t id = reader.Read<std::uint32_t>();
+					if (id)
+					{
+						renderTargets[id] = K2D_CreateRenderTarget(window, width, height, false);
+						windowTargets.insert(id);
+					}
+					break;
+				}
+				case capture_op::CreateOffscreenTarget:
+				{
+					std::uint16_t width = reader.Read<std::uint16_t>();
+					std::uint16_t height = reader.Read<std::uint16_t>();
+					std::uint32_t id = reader.Read<std::uint32_t>();
+					if (id)
+						renderTargets[id] = K2D_CreateOffscreenTarget(width, height);
+					break;
+				}
+				case capture_op::GetRenderTargetTexture:
+				{
+					std::uint32_t renderTarget = reader.Read<std::uint32_t>();
+					std::uint32_t id = reader.Read<std::uint32_t>();
+					if (id)
+						textures[id] = K2D_GetRenderTargetTexture(MapId(renderTargets, renderTarget));
+					break;
+				}
+				case capture_op::InvalidateRenderTarget:
+					K2D_InvalidateRenderTarget(MapId(renderTargets, reader.Read<std::uint32_t>()));
+					break;
+				case capture_op::DestroyRenderTarget:
+				{
+					std::uint32_t renderTarget = reader.Read<std::uint32_t>();
+					K2D_DestroyRenderTarget(MapId(renderTargets, renderTarget));
+					renderTargets.erase(renderTarget);
+					windowTargets.erase(renderTarget);
+					break;
+				}
+				case capture_op::SetRenderTarget:
+					activeTarget = reader.Read<std::uint32_t>();
+					K2D_SetRenderTarget(MapId(renderTargets, activeTarget));
+					break;
+				case capture_op::ClearRenderTarget:
+				{
+					float r = reader.Read<float>();
+					float g = reader.Read<float>();
+					float b = reader.Read<float>();
+					K2D_ClearRenderTarget(r, g, b);
+					break;
+				}
+				case capture_op::SetVSyncEnabled:
+					// Replays run as fast as possible
+					break;
+				case capture_op::PresentRenderTarget:
+				{
+					K2D_PresentRenderTarget();
+					if (!windowTargets.count(activeTarget))
+						break;
+
+					// The time spent in the callback doesn't count for the next frame
+					float elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+					if (callback)
+					{
+						K2D_FrameStats stats = K2D_GetFrameStats();
+						callback(frames, elapsed, &stats, user);
+					}
+					frames++;
+					frameStart = std::chrono::steady_clock::now();
+					break;
+				}
+				case capture_op::ResizeRenderTarget:
+				{
+					std::uint16_t width = reader.Read<std::uint16_t>();
+					std::uint16_t height = reader.Read<std::uint16_t>();
+					K2D_ResizeRenderTarget(width, height);
+					break;
+				}
+				case capture_op::SetDamageTracking:
+					K2D_SetDamageTrackingEnabled(reader.Read<bool>());
+					break;
+				case capture_op::InvalidateDamage:
+					K2D_InvalidateDamage();
+					break;
+				case capture_op::CreateTexture:
+				{
+					const std::vector<std::uint8_t> *blob = reader.ReadBlob();
+					std::uint32_t flags = reader.Read<std::uint32_t>();
+					std::uint32_t colorkey = reader.Read<std::uint32_t>();
+					std::uint32_t id = reader.Read<std::uint32_t>();
+					if (id && blob)
+						textures[id] = K2D_CreateTextureFromMemoryEx(reinterpret_cast<const char*>(blob->data()), static_cast<std::uint32_t>(blob->size()), flags, colorkey);
+					break;
+				}
+				case capture_op::CreateTextureFromPixels:
+				{
+					// Pixels are captured in A8 or RGBA8, whatever format they were passed in
+					std::uint32_t width = reader.Read<std::uint32_t>();
+					std::uint32_t height = reader.Read<std::uint32_t>();
+					std::uint32_t format = reader.Read<std::uint32_t>();
+					const std::vector<std::uint8_t> *blob = reader.ReadBlob();
+					std::uint32_t id = reader.Read<std::uint32_t>();
+					if (id && blob && blob->size() == static_cast<size_t>(width) * height * Texture::GetPixelSize(format))
+						textures[id] = K2D_CreateTextureFromPixels(width, height, format, 0, blob->data());
+					break;
+				}
+				case capture_op::UpdateTextureRegion:
+				{
+					std::uint32_t texture = MapId(textures, reader.Read<std::uint32_t>());
+					std::uint32_t x = reader.Read<std::uint32_t>(), y = reader.Read<std::uint32_t>();
+					std::uint32_t width = reader.Read<std::uint32_t>(), height = reader.Read<std::uint32_t>();
+					std::uint32_t format = reader.Read<std::uint32_t>();
+					const std::vector<std::uint8_t> *blob = reader.ReadBlob();
+					if (blob && blob->size() == static_cast<size_t>(width) * height * Texture::GetPixelSize(format))
+						K2D_UpdateTextureRegion(texture, x, y, width, height, blob->data());
+					break;
+				}
+				case capture_op::DestroyTexture:
+				{
+					std::uint32_t texture = reader.Read<std::uint32_t>();
+					K2D_DestroyTexture(MapId(textures, texture));
+					textures.erase(texture);
+					break;
+				}
+				case capture_op::SetTextureBudget:
+					K2D_SetTextureBudget(reader.Read<std::uint64_t>());
+					break;
+				case capture_op::SetScale2XEnabled:
+					K2D_SetScale2XEnabled(reader.Read<bool>());
+					break;
+				case capture_op::DrawSpriteAt:
+				{
+					std::uint32_t texture = MapId(textures, reader.Read<std::uint32_t>());
+					float x = reader.Read<float>(), y = reader.Read<float>();
+					float z = reader.Read<float>(), rotation = reader.Read<float>();
+					std::uint32_t color = reader.Read<std::uint32_t>(), colorkey = reader.Read<std::uint32_t>();
+					K2D_DrawSpriteAt(texture, x, y, z, rotation, color, colorkey);
+					break;
+				}
+				case capture_op::DrawSubspriteAt:
+				{
+					std::uint32_t texture = MapId(textures, reader.Read<std::uint32_t>());
+					float x = reader.Read<float>(), y = reader.Read<float>();
+					float srcX = reader.Read<float>(), srcY = reader.Read<float>(), srcW = reader.Read<float>(), srcH = reader.Read<float>();
+					float z = reader.Read<float>(), rotation = reader.Read<float>();
+					std::uint32_t color = reader.Read<std::uint32_t>(), colorkey = reader.Read<std::uint32_t>();
+					K2D_DrawSubspriteAt(texture, x, y, srcX, srcY, srcW, srcH, z, rotation, color, colorkey);
+					break;
+				}
+				case capture_op::DrawSpriteScaled:
+				{
+					std::uint32_t texture = MapId(textures, reader.Read<std::uint32_t>());
+					float x = reader.Read<float>(), y = reader.Read<float>(), w = reader.Read<float>(), h = reader.Read<float>();
+					float z = reader.Read<float>(), rotation = reader.Read<float>();
+					std::uint32_t color = reader.Read<std::uint32_t>(), colorkey = reader.Read<std::uint32_t>();
+					K2D_DrawSpriteScaled(texture, x, y, w, h, z, rotation, color, colorkey);
+					break;
+				}
+				case capture_op::DrawSubspriteScaled:
+				{
+					std::uint32_t texture = MapId(textures, reader.Read<std::uint32_t>());
+					float x = reader.Read<float>(), y = reader.Read<float>(), w = reader.Read<float>(), h = reader.Read<float>();
+					float srcX = reader.Read<float>(), srcY = reader.Read<float>(), srcW = reader.Read<float>(), srcH = reader.Read<float>();
+					float z = reader.Read<float>(), rotation = reader.Read<float>();
+					std::uint32_t color = reader.Read<std::uint32_t>(), colorkey = reader.Read<std::uint32_t>();
+					K2D_DrawSubspriteScaled(texture, x, y, w, h, srcX, srcY, srcW, srcH, z, rotation, color, colorkey);
+					break;
+				}
+				case capture_op::DrawSpriteTiled:
+				{
+					std::uint32_t texture = MapId(textures, reader.Read<std::uint32_t>());
+					float x = reader.Read<float>(), y = reader.Read<float>(), w = reader.Read<float>(), h = reader.Read<float>();
+					float tX = reader.Read<float>(), tY = reader.Read<float>();
+					float z = reader.Read<float>(), rotation = reader.Read<float>();
+					std::uint32_t color = reader.Read<std::uint32_t>(), colorkey = reader.Read<std::uint32_t>();
+					K2D_DrawSpriteTiled(texture, x, y, w, h, tX, tY, z, rotation, color, colorkey);
+					break;
+				}
+				case capture_op::CreateFont:
+				{
+					const std::vector<std::uint8_t> *blob = reader.ReadBlob();
+					float pointSize = reader.Read<float>();
+					float outline = reader.Read<float>();
+					std::uint32_t id = reader.Read<std::uint32_t>();
+					if (id && blob)
+						fonts[id] = K2D_CreateFontFromMemory(blob->data(), static_cast<std::uint32_t>(blob->size()), pointSize, outline);
+					break;
+				}
+				case capture_op::DestroyFont:
+				{
+					std::uint32_t font = reader.Read<std::uint32_t>();
+					K2D_DestroyFont(MapId(fonts, font));
+					fonts.erase(font);
+					break;
+				}
+				case capture_op::DrawText:
+				{
+					std::uint32_t font = MapId(fonts, reader.Read<std::uint32_t>());
+					std::wstring text = reader.ReadString();
+					float x = reader.Read<float>(), y = reader.Read<float>();
+					std::uint32_t color = reader.Read<std::uint32_t>();
+					K2D_DrawText(font, text.c_str(), x, y, color);
+					break;
+				}
+				case capture_op::CreateFontSDF:
+				{
+					const std::vector<std::uint8_t> *blob = reader.ReadBlob();
+					float referenceSize = reader.Read<float>();
+					std::uint32_t id = reader.Read<std::uint32_t>();
+					if (id && blob)
+						fonts[id] = K2D_CreateFontSDFFromMemory(blob->data(), static_cast<std::uint32_t>(blob->size()), referenceSize);
+					break;
+				}
+				case capture_op::CreateFontFamily:
+				{
+					const std::vector<std::uint8_t> *blob = reader.ReadBlob();
+					std::uint32_t id = reader.Read<std::uint32_t>();
+					if (id && blob)
+						fontFamilies[id] = K2D_CreateFontFamilyFromMemory(blob->data(), static_cast<std::uint32_t>(blob->size()));
+					break;
+				}
+				case capture_op::CreateFontFromFamily:
+				{
+					std::uint32_t family = MapId(fontFamilies, reader.Read<std::uint32_t>());
+					float pointSize = reader.Read<float>();
+					float outline = reader.Read<float>();
+					std::uint32_t id = reader.Read<std::uint32_t>();
+					if (id)
+						fonts[id] = K2D_CreateFontFromFamily(family, pointSize, outline);
+					break;
+				}
+				case capture_op::CreateFontSDFFromFamily:
+				{
+					std::uint32_t family = MapId(fontFamilies, reader.Read<std::uint32_t>());
+					float referenceSize = reader.Read<float>();
+					std::uint32_t id = reader.Read<std::uint32_t>();
+					if (id)
+						fonts[id] = K2D_CreateFontSDFFromFamily(family, referenceSize);
+					break;
+				}
+				case capture_op::DestroyFontFamily:
+				{
+					std::uint32_t family = reader.Read<std::uint32_t>();
+					K2D_DestroyFontFamily(MapId(fontFamilies, family));
+					fontFamilies.erase(family);
+					break;
+				}
+				case capture_op::DrawTextEx:
+				{
+					std::uint32_t font = MapId(fonts, reader.Read<std::uint32_t>());
+					std::wstring text = reader.ReadString();
+					float x = reader.Read<float>(), y = reader.Read<float>();
+					bool hasStyle = reader.Read<bool>();
+					K2D_TextStyle style = {};
+					if (hasStyle)
+					{
+						style.RGBA = reader.Read<std::uint32_t>();
+						style.Scale = reader.Read<float>();
+						style.OutlineWidth = reader.Read<float>();
+						style.OutlineRGBA = reader.Read<std::uint32_t>();
+						style.ShadowOffsetX = reader.Read<float>();
+						style.ShadowOffsetY = reader.Read<float>();
+						style.ShadowSoftness = reader.Read<float>();
+						style.ShadowRGBA = reader.Read<std::uint32_t>();
+					}
+					K2D_DrawTextEx(font, text.c_str(), x, y, hasStyle ? &style : nullptr);
+					break;
+				}
+				case capture_op::CreateTextLayout:
+				{
+					std::uint32_t font = MapId(fonts, reader.Read<std::uint32_t>());
+					std::wstring text = reader.ReadString();
+					K2D_TextLayoutOptions options = {};
+					options.Scale = reader.Read<float>();
+					std::uint32_t id = reader.Read<std::uint32_t>();
+					if (id)
+						textLayouts[id] = K2D_CreateTextLayout(font, text.c_str(), &options);
+					break;
+				}
+				case capture_op::DestroyTextLayout:
+				{
+					std::uint32_t layout = reader.Read<std::uint32_t>();
+					K2D_DestroyTextLayout(MapId(textLayouts, layout));
+					textLayouts.erase(layout);
+					break;
+				}
+				case capture_op::DrawTextLayout:
+				{
+					std::uint32_t layout = MapId(textLayouts, reader.Read<std::uint32_t>());
+					float x = reader.Read<float>(), y = reader.Read<float>();
+					K2D_DrawTextLayout(layout, x, y, reader.Read<std::uint32_t>());
+					break;
+				}
+				case capture_op::DrawTextUtf8:
+				{
+					std::uint32_t font = MapId(fonts, reader.Read<std::uint32_t>());
+					std::vector<std::uint8_t> text = reader.ReadBytes();
+					float x = reader.Read<float>(), y = reader.Read<float>();
+					std::uint32_t color = reader.Read<std::uint32_t>();
+					K2D_DrawTextUtf8(font, reinterpret_cast<const char*>(text.data()), static_cast<std::uint32_t>(text.size()), x, y, color);
+					break;
+				}
+				case capture_op::DrawTextUtf16:
+				{
+					std::uint32_t font = MapId(fonts, reader.Read<std::uint32_t>());
+					std::vector<std::uint8_t> bytes = reader.ReadBytes();
+					float x = reader.Read<float>(), y = reader.Read<float>();
+					std::uint32_t color = reader.Read<std::uint32_t>();
+
+					// Copied to aligned code units
+					std::vector<char16_t> text(bytes.size() / sizeof(char16_t));
+					if (!text.empty())
+						std::memcpy(text.data(), bytes.data(), text.size() * sizeof(char16_t));
+					K2D_DrawTextUtf16(font, text.data(), static_cast<std::uint32_t>(text.size()), x, y, color);
+					break;
+				}
+				case capture_op::CreateTextDocument:
+				{
+					std::uint32_t font = MapId(fonts, reader.Read<std::uint32_t>());
+					bool hasOptions = reader.Read<bool>();
+					K2D_TextDocumentOptions options = {};
+					if (hasOptions)
+					{
+						options.Scale = reader.Read<float>();
+						options.WrapWidth = reader.Read<float>();
+						options.ParagraphSpacing = reader.Read<float>();
+					}
+					std::uint32_t id = reader.Read<std::uint32_t>();
+					if (id)
+						textDocuments[id] = K2D_CreateTextDocument(font, hasOptions ? &options : nullptr);
+					break;
+				}
+				case capture_op::DestroyTextDocument:
+				{
+					std::uint32_t document = reader.Read<std::uint32_t>();
+					K2D_DestroyTextDocument(MapId(textDocuments, document));
+					textDocuments.erase(document);
+					break;
+				}
+				case capture_op::AppendTextDocumentUtf8:
+				{
+					std::uint32_t document = MapId(textDocuments, reader.Read<std::uint32_t>());
+					std::vector<std::uint8_t> text = reader.ReadBytes();
+					K2D_AppendTextDocumentUtf8(document, reinterpret_cast<const char*>(text.data()), static_cast<std::uint32_t>(text.size()));
+					break;
+				}
+				case capture_op::AppendTextDocumentUtf16:
+				{
+					std::uint32_t document = MapId(textDocuments, reader.Read<std::uint32_t>());
+					std::vector<std::uint8_t> bytes = reader.ReadBytes();
+
+					// Copied to aligned code units
+					std::vector<char16_t> text(bytes.size() / sizeof(char16_t));
+					if (!text.empty())
+						std::memcpy(text.data(), bytes.data(), text.size() * sizeof(char16_t));
+					K2D_AppendTextDocumentUtf16(document, text.data(), static_cast<std::uint32_t>(text.size()));
+					break;
+				}
+				case capture_op::ClearTextDocument:
+				{
+					K2D_ClearTextDocument(MapId(textDocuments, reader.Read<std::uint32_t>()));
+					break;
+				}
+				case capture_op::DrawTextDocument:
+				{
+					std::uint32_t document = MapId(textDocuments, reader.Read<std::uint32_t>());
+					float x = reader.Read<float>(), y = reader.Read<float>();
+					double scrollY = reader.Read<double>();
+					float viewHeight = reader.Read<float>();
+					K2D_DrawTextDocument(document, x, y, scrollY, viewHeight, reader.Read<std::uint32_t>());
+					break;
+				}
+				case capture_op::SetGlyphAtlasBudget:
+					K2D_SetGlyphAtlasBudget(reader.Read<std::uint64_t>());
+					break;
+				case capture_op::DrawPoint:
+				{
+					float x = reader.Read<float>(), y = reader.Read<float>();
+					K2D_DrawPoint(x, y, reader.Read<std::uint32_t>());
+					break;
+				}
+				case capture_op::DrawRect:
+				case capture_op::FillRect:
+				case capture_op::DrawLine:
+				{
+					float a = reader.Read<float>(), b = reader.Read<float>(), c = reader.Read<float>(), d = reader.Read<float>();
+					std::uint32_t color = reader.Read<std::uint32_t>();
+					if (op == capture_op::DrawRect)
+						K2D_DrawRect(a, b, c, d, color);
+					else if (op == capture_op::FillRect)
+						K2D_FillRect(a, b, c, d, color);
+					else
+						K2D_DrawLine(a, b, c, d, color);
+					break;
+				}
+				default:
+					// Unknown records are skipped, their payload has been read already
+					break;
+			}
+		}
+
+		return frames;
+	}
+}
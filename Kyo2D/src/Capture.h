@@ -0,0 +1,206 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <type_traits>
+#include "Kyo2D.h"
+
+namespace Kyo2D
+{
+	/// Capture record types. Each api call that changes the state of a context has its own record.
+	namespace capture_op
+	{
+		enum Type : std::uint8_t
+		{
+			Blob					= 0,
+			CreateRenderTarget		= 1,
+			CreateOffscreenTarget	= 2,
+			GetRenderTargetTexture	= 3,
+			InvalidateRenderTarget	= 4,
+			DestroyRenderTarget		= 5,
+			SetRenderTarget			= 6,
+			ClearRenderTarget		= 7,
+			SetVSyncEnabled			= 8,
+			PresentRenderTarget		= 9,
+			ResizeRenderTarget		= 10,
+			SetDamageTracking		= 11,
+			InvalidateDamage		= 12,
+			CreateTexture			= 13,
+			DestroyTexture			= 14,
+			SetTextureBudget		= 15,
+			SetScale2XEnabled		= 16,
+			DrawSpriteAt			= 17,
+			DrawSubspriteAt			= 18,
+			DrawSpriteScaled		= 19,
+			DrawSubspriteScaled		= 20,
+			DrawSpriteTiled			= 21,
+			CreateFont				= 22,
+			DestroyFont				= 23,
+			DrawText				= 24,
+			DrawPoint				= 25,
+			DrawRect				= 26,
+			FillRect				= 27,
+			DrawLine				= 28,
+			CreateTextureFromPixels	= 29,
+			UpdateTextureRegion		= 30,
+			CreateFontSDF			= 31,
+			DrawTextEx				= 32,
+			CreateTextLayout		= 33,
+			DestroyTextLayout		= 34,
+			DrawTextLayout			= 35,
+			DrawTextUtf8			= 36,
+			DrawTextUtf16			= 37,
+			CreateTextDocument		= 38,
+			DestroyTextDocument		= 39,
+			AppendTextDocumentUtf8	= 40,
+			AppendTextDocumentUtf16	= 41,
+			ClearTextDocument		= 42,
+			DrawTextDocument		= 43,
+			SetGlyphAtlasBudget		= 44,
+			CreateFontFamily		= 45,
+			CreateFontFromFamily	= 46,
+			CreateFontSDFFromFamily	= 47,
+			DestroyFontFamily		= 48
+		};
+	}
+
+	// Shortcut typedef
+	typedef capture_op::Type CaptureOp;
+
+	/// Writes a capture stream. The stream starts with a header, followed by records consisting of
+	/// the record type, the payload size and the payload. Asset bytes are stored in blob records,
+	/// which are referenced by their index. Identical assets are only stored once.
+	class CaptureWriter
+	{
+	public:
+
+		/// Default constructor.
+		CaptureWriter();
+		/// Destructor, closes the stream.
+		~CaptureWriter();
+
+		/// Creates the capture file and writes the header.
+		bool Open(const std::wstring &filename);
+		/// Writes a record.
+		void Write(CaptureOp op, const std::vector<std::uint8_t> &payload);
+		/// Stores a blob unless an identical one has already been stored.
+		/// @returns The index of the blob.
+		std::uint32_t AddBlob(const void *data, size_t size);
+
+	private:
+
+		std::ofstream m_Stream;
+		/// Maps hash and size of the stored blobs to their indices.
+		std::map<std::pair<std::uint64_t, size_t>, std::uint32_t> m_BlobIndices;
+	};
+
+	/// Reads a capture stream written by CaptureWriter. Blob records are consumed internally.
+	class CaptureReader
+	{
+	public:
+
+		/// Default constructor.
+		CaptureReader();
+		/// Destructor.
+		~CaptureReader();
+
+		/// Opens a capture file and validates its header.
+		bool Open(const std::wstring &filename);
+		/// Reads the next call record.
+		/// @returns false at the end of the stream or if it is truncated.
+		bool Next(CaptureOp &op);
+
+		/// Reads a value from the payload of the current record. Missing values read as zero.
+		template<class T> T Read()
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be read");
+
+			T value;
+			std::memset(&value, 0, sizeof(value));
+			if (m_Offset + sizeof(T) <= m_Record.size())
+			{
+				std::memcpy(&value, &m_Record[m_Offset], sizeof(T));
+				m_Offset += sizeof(T);
+			}
+			return value;
+		}
+		/// Reads a string from the payload of the current record.
+		std::wstring ReadString();
+		/// Reads bytes appended with CaptureCall::Bytes from the payload of the current record.
+		std::vector<std::uint8_t> ReadBytes();
+		/// Reads a blob reference from the payload of the current record.
+		/// @returns The referenced blob, or nullptr if the reference is invalid.
+		const std::vector<std::uint8_t> *ReadBlob();
+
+	private:
+
+		std::ifstream m_Stream;
+		std::vector<std::uint8_t> m_Record;
+		size_t m_Offset;
+		/// Bytes left in the stream, record sizes are checked against it before allocating.
+		std::uint64_t m_Remaining;
+		std::vector<std::vector<std::uint8_t>> m_Blobs;
+	};
+
+	/// Records one api call to the capture of the current context. Calls made by the engine while
+	/// executing another call (e.g. fonts drawing their glyph sprites) are not recorded, since
+	/// replaying the outer call repeats them. The record is written when the object is destroyed.
+	class CaptureCall
+	{
+	public:
+
+		/// Starts recording a call if the current context is capturing.
+		explicit CaptureCall(CaptureOp op);
+		/// Writes the record.
+		~CaptureCall();
+
+		CaptureCall(const CaptureCall&) = delete;
+		CaptureCall& operator=(const CaptureCall&) = delete;
+
+		/// Determines if this call is recorded.
+		inline bool IsActive() const { return m_Active; }
+
+		/// Appends an argument.
+		template<class T> CaptureCall& operator<<(const T &value)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be captured");
+
+			if (m_Active)
+			{
+				const std::uint8_t *bytes = reinterpret_cast<const std::uint8_t*>(&value);
+				m_Payload.insert(m_Payload.end(), bytes, bytes + sizeof(T));
+			}
+			return *this;
+		}
+		/// Appends a string argument.
+		CaptureCall& String(const wchar_t *text);
+		/// Appends bytes which aren't worth keeping as blob, e.g. a text, preceded by their size.
+		CaptureCall& Bytes(const void *data, size_t size);
+		/// Appends asset bytes as blob reference.
+		CaptureCall& Blob(const void *data, size_t size);
+		/// Appends the contents of a file as blob reference.
+		CaptureCall& File(const wchar_t *filename);
+		/// Appends the result of the call and passes it through.
+		template<class T> T Result(T value)
+		{
+			*this << value;
+			return value;
+		}
+
+	private:
+
+		CaptureOp m_Op;
+		bool m_Active;
+		std::vector<std::uint8_t> m_Payload;
+	};
+
+	/// Executes the calls of a capture file on the current context. Objects are created anew and
+	/// the ids of the capture are mapped to the new ones.
+	/// @returns The number of frames replayed.
+	std::uint32_t ReplayCapture(const std::wstring &filename, HWND window, K2D_ReplayFrameCallback callback, void *user);
+}
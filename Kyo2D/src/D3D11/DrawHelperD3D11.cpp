@@ -18,7 +18,7 @@ namespace Kyo2D
 	bool DrawHelperD3D11::Initialize()
 	{
 		// Load vertex shader
-		HRESULT hr = g_D3DDevice11->CreateVertexShader(g_draw2D11MainVS, sizeof(g_draw2D11MainVS), nullptr, m_VertShader2D.GetAddressOf());
+		HRESULT hr = g_Context->D3DDevice11->CreateVertexShader(g_draw2D11MainVS, sizeof(g_draw2D11MainVS), nullptr, m_VertShader2D.GetAddressOf());
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Could not create vertex shader!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
@@ -32,7 +32,7 @@ namespace Kyo2D
 			{ "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
 		};
 
-		hr = g_D3DDevice11->CreateInputLayout(ied, 2, g_draw2D11MainVS, sizeof(g_draw2D11MainVS), m_2DInputLayout.GetAddressOf());
+		hr = g_Context->D3DDevice11->CreateInputLayout(ied, 2, g_draw2D11MainVS, sizeof(g_draw2D11MainVS), m_2DInputLayout.GetAddressOf());
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Could not create input layout!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
@@ -40,7 +40,7 @@ namespace Kyo2D
 		}
 
 		// Load pixel shader
-		hr = g_D3DDevice11->CreatePixelShader(g_draw2D11MainPS, sizeof(g_draw2D11MainPS), nullptr, m_PixShader2D.GetAddressOf());
+		hr = g_Context->D3DDevice11->CreatePixelShader(g_draw2D11MainPS, sizeof(g_draw2D11MainPS), nullptr, m_PixShader2D.GetAddressOf());
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Could not create pixel shader!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
@@ -53,7 +53,7 @@ namespace Kyo2D
 		cbd.Usage = D3D11_USAGE_DEFAULT;
 		cbd.ByteWidth = 64;
 		cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-		hr = g_D3DDevice11->CreateBuffer(&cbd, nullptr, m_2DCBuffer.GetAddressOf());
+		hr = g_Context->D3DDevice11->CreateBuffer(&cbd, nullptr, m_2DCBuffer.GetAddressOf());
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Could not create constant buffer!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
@@ -71,7 +71,7 @@ namespace Kyo2D
 		blendDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ZERO;
 		blendDesc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
 		blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
-		hr = g_D3DDevice11->CreateBlendState(&blendDesc, m_2DBlendState.GetAddressOf());
+		hr = g_Context->D3DDevice11->CreateBlendState(&blendDesc, m_2DBlendState.GetAddressOf());
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Could not create blend state!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
@@ -85,33 +85,48 @@ namespace Kyo2D
 		bd.ByteWidth = sizeof(Vertex2D) * 5;           // size is the Vertex2D struct * 5
 		bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;       // use as a vertex buffer
 		bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;    // allow CPU to write in buffer
-		hr = g_D3DDevice11->CreateBuffer(&bd, nullptr, m_2DGeomBuffer.GetAddressOf());       // create the buffer
+		hr = g_Context->D3DDevice11->CreateBuffer(&bd, nullptr, m_2DGeomBuffer.GetAddressOf());       // create the buffer
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Could not create vertex buffer!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
 			return false;
 		}
 
+		// Create rasterizer state, the scissor rect is managed by the render target
+		D3D11_RASTERIZER_DESC rasterDesc;
+		ZeroMemory(&rasterDesc, sizeof(rasterDesc));
+		rasterDesc.CullMode = D3D11_CULL_NONE;
+		rasterDesc.FillMode = D3D11_FILL_SOLID;
+		rasterDesc.ScissorEnable = TRUE;
+		hr = g_Context->D3DDevice11->CreateRasterizerState(&rasterDesc, m_2DRasterState.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create rasterizer state!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
+
 		return true;
 	}
 
 	void DrawHelperD3D11::Prepare()
 	{
+		g_Context->D3DDeviceContext11->RSSetState(m_2DRasterState.Get());
+
 		// Setup shader objects
-		g_D3DDeviceContext11->VSSetShader(m_VertShader2D.Get(), 0, 0);
-		g_D3DDeviceContext11->PSSetShader(m_PixShader2D.Get(), 0, 0);
+		g_Context->D3DDeviceContext11->VSSetShader(m_VertShader2D.Get(), 0, 0);
+		g_Context->D3DDeviceContext11->PSSetShader(m_PixShader2D.Get(), 0, 0);
 
 		// Setup blend desc
-		g_D3DDeviceContext11->OMSetBlendState(m_2DBlendState.Get(), 0, 0xFFFFFFFF);
+		g_Context->D3DDeviceContext11->OMSetBlendState(m_2DBlendState.Get(), 0, 0xFFFFFFFF);
 
 		// Set constant buffer
 		ID3D11Buffer *buffers[] = {
 			m_2DCBuffer.Get()
 		};
-		g_D3DDeviceContext11->VSSetConstantBuffers(0, 1, buffers);
+		g_Context->D3DDeviceContext11->VSSetConstantBuffers(0, 1, buffers);
 
 		// Set input layout
-		g_D3DDeviceContext11->IASetInputLayout(m_2DInputLayout.Get());
+		g_Context->D3DDeviceContext11->IASetInputLayout(m_2DInputLayout.Get());
 	}
 
 	void DrawHelperD3D11::DrawPoint(float X, float Y, std::int32_t Color)
@@ -122,13 +137,14 @@ namespace Kyo2D
 		// Update vertex buffer
 		D3D11_MAPPED_SUBRESOURCE ms;
 		{
-			HRESULT hr = g_D3DDeviceContext11->Map(m_2DGeomBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &ms);   // map the buffer
+			g_Context->Stats.BufferMaps++;
+			HRESULT hr = g_Context->D3DDeviceContext11->Map(m_2DGeomBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &ms);   // map the buffer
 			if (FAILED(hr))
 			{
 				return;
 			}
 			memcpy(ms.pData, &Vertex, sizeof(Vertex));															// copy the data
-			g_D3DDeviceContext11->Unmap(m_2DGeomBuffer.Get(), 0);												// unmap the buffer
+			g_Context->D3DDeviceContext11->Unmap(m_2DGeomBuffer.Get(), 0);												// unmap the buffer
 		}
 
 		// Draw command
@@ -147,13 +163,14 @@ namespace Kyo2D
 		// Update vertex buffer
 		D3D11_MAPPED_SUBRESOURCE ms;
 		{
-			HRESULT hr = g_D3DDeviceContext11->Map(m_2DGeomBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &ms);   // map the buffer
+			g_Context->Stats.BufferMaps++;
+			HRESULT hr = g_Context->D3DDeviceContext11->Map(m_2DGeomBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &ms);   // map the buffer
 			if (FAILED(hr))
 			{
 				return;
 			}
 			memcpy(ms.pData, Vertices, sizeof(Vertices));														// copy the data
-			g_D3DDeviceContext11->Unmap(m_2DGeomBuffer.Get(), 0);												// unmap the buffer
+			g_Context->D3DDeviceContext11->Unmap(m_2DGeomBuffer.Get(), 0);												// unmap the buffer
 		}
 
 		// Draw command
@@ -175,13 +192,14 @@ namespace Kyo2D
 		// Update vertex buffer
 		D3D11_MAPPED_SUBRESOURCE ms;
 		{
-			HRESULT hr = g_D3DDeviceContext11->Map(m_2DGeomBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &ms);   // map the buffer
+			g_Context->Stats.BufferMaps++;
+			HRESULT hr = g_Context->D3DDeviceContext11->Map(m_2DGeomBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &ms);   // map the buffer
 			if (FAILED(hr))
 			{
 				return;
 			}
 			memcpy(ms.pData, Vertices, sizeof(Vertices));														// copy the data
-			g_D3DDeviceContext11->Unmap(m_2DGeomBuffer.Get(), 0);												// unmap the buffer
+			g_Context->D3DDeviceContext11->Unmap(m_2DGeomBuffer.Get(), 0);												// unmap the buffer
 		}
 
 		// Draw command
@@ -206,37 +224,41 @@ namespace Kyo2D
 		// Update vertex buffer
 		D3D11_MAPPED_SUBRESOURCE ms;
 		{
-			HRESULT hr = g_D3DDeviceContext11->Map(m_2DGeomBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &ms);   // map the buffer
+			g_Context->Stats.BufferMaps++;
+			HRESULT hr = g_Context->D3DDeviceContext11->Map(m_2DGeomBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &ms);   // map the buffer
 			if (FAILED(hr))
 			{
 				return;
 			}
 			memcpy(ms.pData, Vertices, sizeof(Vertices));														// copy the data
-			g_D3DDeviceContext11->Unmap(m_2DGeomBuffer.Get(), 0);												// unmap the buffer
+			g_Context->D3DDeviceContext11->Unmap(m_2DGeomBuffer.Get(), 0);												// unmap the buffer
 		}
 
 		// Draw command
 		Dispatch(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP, 4);
 	}
 
-	void DrawHelperD3D11::UpdateViewMatrix(const XMMATRIX & ViewMatrix)
+	void DrawHelperD3D11::UpdateViewMatrix(const Matrix4 & ViewMatrix)
 	{
-		g_D3DDeviceContext11->UpdateSubresource(m_2DCBuffer.Get(), 0, 0, &ViewMatrix, 0, 0);
+		g_Context->D3DDeviceContext11->UpdateSubresource(m_2DCBuffer.Get(), 0, 0, &ViewMatrix, 0, 0);
 	}
 
 	void DrawHelperD3D11::Dispatch(D3D11_PRIMITIVE_TOPOLOGY Topology, UINT Count)
 	{
-		if (!g_D3DDeviceContext11)
+		if (!g_Context->D3DDeviceContext11)
 			return;
 
 		// Render point
 		UINT stride = 0;
 		UINT offset = 0;
 		stride = sizeof(Vertex2D);
-		g_D3DDeviceContext11->IASetVertexBuffers(0, 1, m_2DGeomBuffer.GetAddressOf(), &stride, &offset);
+		g_Context->D3DDeviceContext11->IASetVertexBuffers(0, 1, m_2DGeomBuffer.GetAddressOf(), &stride, &offset);
 
 		// Draw the actual geometry
-		g_D3DDeviceContext11->IASetPrimitiveTopology(Topology);
-		g_D3DDeviceContext11->Draw(Count, 0);
+		g_Context->D3DDeviceContext11->IASetPrimitiveTopology(Topology);
+		g_Context->D3DDeviceContext11->Draw(Count, 0);
+
+		g_Context->Stats.DrawCalls++;
+		g_Context->Stats.Vertices += Count;
 	}
 }
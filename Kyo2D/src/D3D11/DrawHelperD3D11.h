@@ -5,11 +5,9 @@
 #include <Windows.h>
 #include <comptr.h>
 #include <d3d11.h>
+#include "../EngineContext.h"
 using namespace Microsoft::WRL;
 
-extern ComPtr<ID3D11Device> g_D3DDevice11;
-extern ComPtr<ID3D11DeviceContext> g_D3DDeviceContext11;
-
 namespace Kyo2D
 {
 	class DrawHelperD3D11 : public DrawHelper
@@ -34,7 +32,7 @@ namespace Kyo2D
 		/// @copydoc DrawHelper::FillRect()
 		virtual void FillRect(float X, float Y, float W, float H, std::int32_t Color = -1) override;
 		/// @copydoc DrawHelper::UpdateViewMatrix()
-		virtual void UpdateViewMatrix(const XMMATRIX &ViewMatrix) override;
+		virtual void UpdateViewMatrix(const Matrix4 &ViewMatrix) override;
 
 	private:
 
@@ -49,5 +47,6 @@ namespace Kyo2D
 		ComPtr<ID3D11Buffer> m_2DCBuffer;
 		ComPtr<ID3D11InputLayout> m_2DInputLayout;
 		ComPtr<ID3D11BlendState> m_2DBlendState;
+		ComPtr<ID3D11RasterizerState> m_2DRasterState;
 	};
 }
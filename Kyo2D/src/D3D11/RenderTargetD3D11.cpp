@@ -3,12 +3,15 @@
 
 namespace Kyo2D
 {
+	const UINT RenderTargetD3D11::FlipBufferCount;
+
 	RenderTargetD3D11::RenderTargetD3D11()
 		: m_Handle(nullptr)
 		, m_Width(0)
 		, m_Height(0)
 		, m_Fullscreen(false)
 		, m_VSync(false)
+		, m_PresentedAll(true)
 	{
 	}
 
@@ -34,7 +37,7 @@ namespace Kyo2D
 
 		// Create the swap chain and the render target
 		ComPtr<IDXGIDevice> dxgiDevice;
-		HRESULT hr = g_D3DDevice11.As(&dxgiDevice);
+		HRESULT hr = g_Context->D3DDevice11.As(&dxgiDevice);
 		if (FAILED(hr))
 		{
 			MessageBox(hwnd, L"Could not get DXGI device!", L"Error", MB_ICONERROR | MB_OK);
@@ -57,42 +60,64 @@ namespace Kyo2D
 			return false;
 		}
 
-		DXGI_SWAP_CHAIN_DESC sd;
-		memset(&sd, 0, sizeof(sd));
-		sd.BufferCount = 1;
-		sd.BufferDesc.Width = width;
-		sd.BufferDesc.Height = height;
-		sd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-		sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-		sd.OutputWindow = hwnd;
-		sd.BufferDesc.RefreshRate.Numerator = 60;
-		sd.BufferDesc.RefreshRate.Denominator = 1;
-		sd.SampleDesc.Count = 1;
-		sd.Windowed = !fullscreen;
-		hr = dxgiFactory->CreateSwapChain(g_D3DDevice11.Get(), &sd, m_SwapChain.GetAddressOf());
-		if (FAILED(hr))
+		// Prefer a flip model swap chain (DXGI 1.2), which can present single rectangles
+		ComPtr<IDXGIFactory2> dxgiFactory2;
+		if (SUCCEEDED(dxgiFactory.As(&dxgiFactory2)))
 		{
-			MessageBox(hwnd, L"Could not create swap chain!", L"Error", MB_ICONERROR | MB_OK);
-			return false;
+			DXGI_SWAP_CHAIN_DESC1 sd1;
+			memset(&sd1, 0, sizeof(sd1));
+			sd1.Width = width;
+			sd1.Height = height;
+			sd1.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+			sd1.SampleDesc.Count = 1;
+			sd1.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+			sd1.BufferCount = FlipBufferCount;
+			sd1.Scaling = DXGI_SCALING_STRETCH;
+			sd1.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;	// the buffers keep their contents
+
+			DXGI_SWAP_CHAIN_FULLSCREEN_DESC fsd;
+			memset(&fsd, 0, sizeof(fsd));
+			fsd.RefreshRate.Numerator = 60;
+			fsd.RefreshRate.Denominator = 1;
+			fsd.Windowed = !fullscreen;
+
+			hr = dxgiFactory2->CreateSwapChainForHwnd(g_Context->D3DDevice11.Get(), hwnd, &sd1, &fsd, nullptr, m_SwapChain1.GetAddressOf());
+			if (FAILED(hr) || FAILED(m_SwapChain1.As(&m_SwapChain)))
+				m_SwapChain1.Reset();
 		}
 
-		hr = dxgiFactory->MakeWindowAssociation(hwnd, DXGI_MWA_NO_ALT_ENTER);
-		if (FAILED(hr))
+		// Windows 7 doesn't support the flip model, even with DXGI 1.2
+		if (!m_SwapChain1)
 		{
-			MessageBox(hwnd, L"Could not disable Alt+Enter!", L"Error", MB_ICONERROR | MB_OK);
-			return false;
+			DXGI_SWAP_CHAIN_DESC sd;
+			memset(&sd, 0, sizeof(sd));
+			sd.BufferCount = 1;
+			sd.BufferDesc.Width = width;
+			sd.BufferDesc.Height = height;
+			sd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+			sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+			sd.OutputWindow = hwnd;
+			sd.BufferDesc.RefreshRate.Numerator = 60;
+			sd.BufferDesc.RefreshRate.Denominator = 1;
+			sd.SampleDesc.Count = 1;
+			sd.Windowed = !fullscreen;
+			sd.SwapEffect = DXGI_SWAP_EFFECT_SEQUENTIAL;	// keep the back buffer, required for partial redraws
+			hr = dxgiFactory->CreateSwapChain(g_Context->D3DDevice11.Get(), &sd, m_SwapChain.ReleaseAndGetAddressOf());
+			if (FAILED(hr))
+			{
+				MessageBox(hwnd, L"Could not create swap chain!", L"Error", MB_ICONERROR | MB_OK);
+				return false;
+			}
 		}
 
-		ComPtr<ID3D11Texture2D> backBuffer;
-		hr = m_SwapChain->GetBuffer(0, IID_PPV_ARGS(backBuffer.GetAddressOf()));
+		hr = dxgiFactory->MakeWindowAssociation(hwnd, DXGI_MWA_NO_ALT_ENTER);
 		if (FAILED(hr))
 		{
-			MessageBox(hwnd, L"Could not get backbuffer!", L"Error", MB_ICONERROR | MB_OK);
+			MessageBox(hwnd, L"Could not disable Alt+Enter!", L"Error", MB_ICONERROR | MB_OK);
 			return false;
 		}
 
-		hr = g_D3DDevice11->CreateRenderTargetView(backBuffer.Get(), nullptr, m_RenderTargetView.GetAddressOf());
-		if (FAILED(hr))
+		if (!CreateWindowViews())
 		{
 			MessageBox(hwnd, L"Could not create render target view!", L"Error", MB_ICONERROR | MB_OK);
 			return false;
@@ -109,13 +134,13 @@ namespace Kyo2D
 		texd.BindFlags = D3D11_BIND_DEPTH_STENCIL;
 
 		ComPtr<ID3D11Texture2D> depthBuffer;
-		g_D3DDevice11->CreateTexture2D(&texd, nullptr, depthBuffer.GetAddressOf());
+		g_Context->D3DDevice11->CreateTexture2D(&texd, nullptr, depthBuffer.GetAddressOf());
 
 		D3D11_DEPTH_STENCIL_VIEW_DESC dsvd;
 		ZeroMemory(&dsvd, sizeof(dsvd));
 		dsvd.Format = DXGI_FORMAT_D32_FLOAT;
 		dsvd.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DMS;
-		g_D3DDevice11->CreateDepthStencilView(depthBuffer.Get(), &dsvd, m_DepthTargetView.GetAddressOf());
+		g_Context->D3DDevice11->CreateDepthStencilView(depthBuffer.Get(), &dsvd, m_DepthTargetView.GetAddressOf());
 
 		// Set depth stencil state
 		D3D11_DEPTH_STENCIL_DESC dsd;
@@ -123,11 +148,39 @@ namespace Kyo2D
 		dsd.DepthEnable = TRUE;
 		dsd.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
 		dsd.DepthFunc = D3D11_COMPARISON_LESS_EQUAL;
-		g_D3DDevice11->CreateDepthStencilState(&dsd, m_DepthStencilState.GetAddressOf());
-		g_D3DDeviceContext11->OMSetDepthStencilState(m_DepthStencilState.Get(), 0);
+		g_Context->D3DDevice11->CreateDepthStencilState(&dsd, m_DepthStencilState.GetAddressOf());
+		g_Context->D3DDeviceContext11->OMSetDepthStencilState(m_DepthStencilState.Get(), 0);
+
+		// Create view matrix
+		m_ViewMatrix = Matrix4::OrthographicOffCenterRH(0.0f, m_Width, m_Height, 0.0f, 0.0f, 1000.0f);
+
+		return true;
+	}
+
+	bool RenderTargetD3D11::InitializeOffscreen(std::uint16_t width, std::uint16_t height)
+	{
+		m_Width = width;
+		m_Height = height;
+
+		// Create the texture we render into
+		m_Texture = std::make_shared<TextureD3D11>();
+		if (!m_Texture->InitializeRenderTarget(width, height))
+		{
+			MessageBox(nullptr, L"Could not create offscreen texture!", L"Error", MB_ICONERROR | MB_OK);
+			return false;
+		}
+
+		HRESULT hr = g_Context->D3DDevice11->CreateRenderTargetView(m_Texture->GetResource(), nullptr, m_RenderTargetView.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create render target view!", L"Error", MB_ICONERROR | MB_OK);
+			return false;
+		}
+
+		// Offscreen targets don't use a depth buffer, sprites are composed in draw order.
 
 		// Create view matrix
-		m_ViewMatrix = XMMatrixOrthographicOffCenterRH(0.0f, m_Width, m_Height, 0.0f, 0.0f, 1000.0f);
+		m_ViewMatrix = Matrix4::OrthographicOffCenterRH(0.0f, m_Width, m_Height, 0.0f, 0.0f, 1000.0f);
 
 		return true;
 	}
@@ -139,8 +192,16 @@ namespace Kyo2D
 			return;
 		}
 
+		// Our own texture might still be bound as shader resource from drawing it,
+		// which isn't allowed while rendering into it.
+		if (m_Texture)
+		{
+			ID3D11ShaderResourceView *nullView = nullptr;
+			g_Context->D3DDeviceContext11->PSSetShaderResources(0, 1, &nullView);
+		}
+
 		// Set active render target
-		g_D3DDeviceContext11->OMSetRenderTargets(1, m_RenderTargetView.GetAddressOf(), m_DepthTargetView.Get());
+		g_Context->D3DDeviceContext11->OMSetRenderTargets(1, m_RenderTargetView.GetAddressOf(), m_DepthTargetView.Get());
 
 		// Setup viewport
 		D3D11_VIEWPORT vp;
@@ -149,7 +210,10 @@ namespace Kyo2D
 		vp.Height = static_cast<float>(m_Height);
 		vp.MinDepth = 0.0f;
 		vp.MaxDepth = 1.0f;
-		g_D3DDeviceContext11->RSSetViewports(1, &vp);
+		g_Context->D3DDeviceContext11->RSSetViewports(1, &vp);
+
+		// The drawers enable the scissor test, so cover the whole target by default
+		SetScissorRect(nullptr);
 	}
 
 	void RenderTargetD3D11::Clear(float R, float G, float B)
@@ -160,10 +224,11 @@ namespace Kyo2D
 		}
 
 		const FLOAT ClearColor[4] = { R, G, B, 1.0f };
-		g_D3DDeviceContext11->ClearRenderTargetView(m_RenderTargetView.Get(), ClearColor);
+		g_Context->D3DDeviceContext11->ClearRenderTargetView(m_RenderTargetView.Get(), ClearColor);
 
 		// clear the depth buffer
-		g_D3DDeviceContext11->ClearDepthStencilView(m_DepthTargetView.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
+		if (m_DepthTargetView)
+			g_Context->D3DDeviceContext11->ClearDepthStencilView(m_DepthTargetView.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
 	}
 
 	void RenderTargetD3D11::Present()
@@ -173,9 +238,176 @@ namespace Kyo2D
 			return;
 		}
 
+		if (m_SwapChain1)
+		{
+			// The back buffer to present holds an older frame, bring all of it up to date
+			g_Context->D3DDeviceContext11->CopyResource(m_BackBuffer.Get(), m_Canvas.Get());
+			m_PresentedRects.clear();
+			m_PresentedAll = true;
+
+			DXGI_PRESENT_PARAMETERS parameters;
+			memset(&parameters, 0, sizeof(parameters));
+			m_SwapChain1->Present1(m_VSync ? 1 : 0, 0, &parameters);
+			return;
+		}
+
 		m_SwapChain->Present(m_VSync ? 1 : 0, 0);
 	}
 
+	void RenderTargetD3D11::SetScissorRect(const DamageRect *rect)
+	{
+		D3D11_RECT scissor;
+		if (rect)
+		{
+			scissor.left = rect->Left;
+			scissor.top = rect->Top;
+			scissor.right = rect->Right;
+			scissor.bottom = rect->Bottom;
+		}
+		else
+		{
+			scissor.left = 0;
+			scissor.top = 0;
+			scissor.right = m_Width;
+			scissor.bottom = m_Height;
+		}
+
+		g_Context->D3DDeviceContext11->RSSetScissorRects(1, &scissor);
+	}
+
+	bool RenderTargetD3D11::ClearRect(const DamageRect &rect, float R, float G, float B)
+	{
+		if (!m_RenderTargetView)
+		{
+			return false;
+		}
+
+		// Clearing rectangles requires Direct3D 11.1
+		ComPtr<ID3D11DeviceContext1> context1;
+		if (FAILED(g_Context->D3DDeviceContext11.As(&context1)))
+		{
+			return false;
+		}
+
+		D3D11_RECT clearRect;
+		clearRect.left = rect.Left;
+		clearRect.top = rect.Top;
+		clearRect.right = rect.Right;
+		clearRect.bottom = rect.Bottom;
+
+		const FLOAT ClearColor[4] = { R, G, B, 1.0f };
+		context1->ClearView(m_RenderTargetView.Get(), ClearColor, &clearRect, 1);
+
+		// Depth is only meaningful within a frame, so it's fine to clear all of it
+		if (m_DepthTargetView)
+			g_Context->D3DDeviceContext11->ClearDepthStencilView(m_DepthTargetView.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
+
+		return true;
+	}
+
+	void RenderTargetD3D11::PresentRects(const DamageRect *rects, size_t count)
+	{
+		// The sequential swap chain keeps its back buffer, but can only present all of it
+		if (!m_SwapChain1)
+		{
+			Present();
+			return;
+		}
+
+		// The back buffers take turns, so the one to present holds the frame before the last one.
+		// Update it where the last and this frame changed.
+		if (m_PresentedAll)
+		{
+			g_Context->D3DDeviceContext11->CopyResource(m_BackBuffer.Get(), m_Canvas.Get());
+		}
+		else
+		{
+			for (const DamageRect &rect : m_PresentedRects)
+				CopyCanvas(rect);
+			for (size_t i = 0; i < count; ++i)
+				CopyCanvas(rects[i]);
+		}
+
+		m_DirtyRects.clear();
+		for (size_t i = 0; i < count; ++i)
+		{
+			RECT dirty = { rects[i].Left, rects[i].Top, rects[i].Right, rects[i].Bottom };
+			m_DirtyRects.push_back(dirty);
+		}
+
+		// Without dirty rectangles the whole frame would be presented. Nothing changed, but
+		// presenting a single pixel still paces the frames like any other present.
+		if (m_DirtyRects.empty())
+		{
+			RECT pixel = { 0, 0, 1, 1 };
+			m_DirtyRects.push_back(pixel);
+		}
+
+		DXGI_PRESENT_PARAMETERS parameters;
+		memset(&parameters, 0, sizeof(parameters));
+		parameters.DirtyRectsCount = static_cast<UINT>(m_DirtyRects.size());
+		parameters.pDirtyRects = m_DirtyRects.data();
+		m_SwapChain1->Present1(m_VSync ? 1 : 0, 0, &parameters);
+
+		m_PresentedRects.assign(rects, rects + count);
+		m_PresentedAll = false;
+	}
+
+	bool RenderTargetD3D11::CreateWindowViews()
+	{
+		HRESULT hr = m_SwapChain->GetBuffer(0, IID_PPV_ARGS(m_BackBuffer.ReleaseAndGetAddressOf()));
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		// The sequential swap chain is rendered into directly
+		if (!m_SwapChain1)
+		{
+			hr = g_Context->D3DDevice11->CreateRenderTargetView(m_BackBuffer.Get(), nullptr, m_RenderTargetView.ReleaseAndGetAddressOf());
+			return SUCCEEDED(hr);
+		}
+
+		D3D11_TEXTURE2D_DESC texd;
+		ZeroMemory(&texd, sizeof(texd));
+		texd.Width = m_Width;
+		texd.Height = m_Height;
+		texd.ArraySize = 1;
+		texd.MipLevels = 1;
+		texd.SampleDesc.Count = 1;
+		texd.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		texd.BindFlags = D3D11_BIND_RENDER_TARGET;
+
+		hr = g_Context->D3DDevice11->CreateTexture2D(&texd, nullptr, m_Canvas.ReleaseAndGetAddressOf());
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		hr = g_Context->D3DDevice11->CreateRenderTargetView(m_Canvas.Get(), nullptr, m_RenderTargetView.ReleaseAndGetAddressOf());
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		// The back buffers don't hold anything the canvas does
+		m_PresentedRects.clear();
+		m_PresentedAll = true;
+		return true;
+	}
+
+	void RenderTargetD3D11::CopyCanvas(const DamageRect &rect)
+	{
+		D3D11_BOX box;
+		box.left = rect.Left;
+		box.top = rect.Top;
+		box.front = 0;
+		box.right = rect.Right;
+		box.bottom = rect.Bottom;
+		box.back = 1;
+		g_Context->D3DDeviceContext11->CopySubresourceRegion(m_BackBuffer.Get(), 0, rect.Left, rect.Top, 0, m_Canvas.Get(), 0, &box);
+	}
+
 	void RenderTargetD3D11::SetFullscreenState(bool Fullscreen)
 	{
 		if (m_SwapChain)
@@ -215,12 +447,14 @@ namespace Kyo2D
 			m_SwapChain->SetFullscreenState(FALSE, nullptr);
 		}
 
-		// First, we need to destroy the old render target view
+		// First, we need to destroy the old render target view and our references to the buffers
 		m_DepthTargetView.Reset();
 		m_RenderTargetView.Reset();
+		m_BackBuffer.Reset();
+		m_Canvas.Reset();
 
-		// Next, we need to resize the swap chains back buffer
-		HRESULT hr = m_SwapChain->ResizeBuffers(1, m_Width, m_Height, DXGI_FORMAT_R8G8B8A8_UNORM, 0);
+		// Next, we need to resize the swap chains back buffers, 0 keeps their number
+		HRESULT hr = m_SwapChain->ResizeBuffers(0, m_Width, m_Height, DXGI_FORMAT_R8G8B8A8_UNORM, 0);
 		if (FAILED(hr))
 		{
 			// Error!
@@ -228,15 +462,7 @@ namespace Kyo2D
 		}
 
 		// Now recreate the render target view
-		ComPtr<ID3D11Texture2D> backBuffer;
-		hr = m_SwapChain->GetBuffer(0, IID_PPV_ARGS(backBuffer.GetAddressOf()));
-		if (FAILED(hr))
-		{
-			return false;
-		}
-
-		hr = g_D3DDevice11->CreateRenderTargetView(backBuffer.Get(), nullptr, m_RenderTargetView.GetAddressOf());
-		if (FAILED(hr))
+		if (!CreateWindowViews())
 		{
 			return false;
 		}
@@ -252,19 +478,19 @@ namespace Kyo2D
 		texd.BindFlags = D3D11_BIND_DEPTH_STENCIL;
 
 		ComPtr<ID3D11Texture2D> depthBuffer;
-		g_D3DDevice11->CreateTexture2D(&texd, nullptr, depthBuffer.GetAddressOf());
+		g_Context->D3DDevice11->CreateTexture2D(&texd, nullptr, depthBuffer.GetAddressOf());
 
 		D3D11_DEPTH_STENCIL_VIEW_DESC dsvd;
 		ZeroMemory(&dsvd, sizeof(dsvd));
 		dsvd.Format = DXGI_FORMAT_D32_FLOAT;
 		dsvd.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DMS;
-		g_D3DDevice11->CreateDepthStencilView(depthBuffer.Get(), &dsvd, m_DepthTargetView.GetAddressOf());
+		g_Context->D3DDevice11->CreateDepthStencilView(depthBuffer.Get(), &dsvd, m_DepthTargetView.GetAddressOf());
 
 		// Set depth stencil state
-		g_D3DDeviceContext11->OMSetDepthStencilState(m_DepthStencilState.Get(), 0);
+		g_Context->D3DDeviceContext11->OMSetDepthStencilState(m_DepthStencilState.Get(), 0);
 
 		// Create view matrix
-		m_ViewMatrix = XMMatrixOrthographicOffCenterRH(0.0f, m_Width, m_Height, 0.0f, 0.0f, 1000.0f);
+		m_ViewMatrix = Matrix4::OrthographicOffCenterRH(0.0f, m_Width, m_Height, 0.0f, 0.0f, 1000.0f);
 
 		// Re-enable full screen
 		if (m_Fullscreen)
@@ -2,20 +2,26 @@
 #pragma once
 
 #include "../RenderTarget.h"
+#include "TextureD3D11.h"
 #include <Windows.h>
 #include <comptr.h>
 #include <d3d11.h>
+#include <d3d11_1.h>
+#include <dxgi1_2.h>
 #include <DirectXMath.h>
 #include <memory>
+#include <vector>
+#include "../EngineContext.h"
 using namespace Microsoft::WRL;
 using namespace DirectX;
 
-extern ComPtr<ID3D11Device> g_D3DDevice11;
-extern ComPtr<ID3D11DeviceContext> g_D3DDeviceContext11;
-
 namespace Kyo2D
 {
 	/// Direct3D11 implementation of a render target.
+	/// Window targets use a flip model swap chain if DXGI 1.2 is available, which can present single
+	/// rectangles. Its back buffers take turns, so frames are rendered into a canvas texture which
+	/// is copied into the back buffer when presenting. Where the flip model isn't available, a
+	/// sequential swap chain is used, which keeps its only back buffer but always presents all of it.
 	class RenderTargetD3D11 : public RenderTarget
 	{
 	public:
@@ -27,6 +33,8 @@ namespace Kyo2D
 
 		/// @copydoc RenderTarget::Initialize(HWND, std::uint16_t, std::uint16_t, bool)
 		virtual bool Initialize(HWND hwnd, std::uint16_t width, std::uint16_t height, bool fullscreen) override;
+		/// @copydoc RenderTarget::InitializeOffscreen(std::uint16_t, std::uint16_t)
+		virtual bool InitializeOffscreen(std::uint16_t width, std::uint16_t height) override;
 		/// @copydoc RenderTarget::Set()
 		virtual void Set() override;
 		/// @copydoc RenderTarget::Clear(float, float, float)
@@ -39,9 +47,15 @@ namespace Kyo2D
 		virtual void SetVSyncEnabled(bool Enable) override;
 		/// @copydoc RenderTarget::Resize(std::uint16_t, std::uint16_t)
 		virtual bool Resize(std::uint16_t Width, std::uint16_t Height) override;
+		/// @copydoc RenderTarget::SetScissorRect(const DamageRect *)
+		virtual void SetScissorRect(const DamageRect *rect) override;
+		/// @copydoc RenderTarget::ClearRect(const DamageRect &, float, float, float)
+		virtual bool ClearRect(const DamageRect &rect, float R, float G, float B) override;
+		/// @copydoc RenderTarget::PresentRects(const DamageRect *, size_t)
+		virtual void PresentRects(const DamageRect *rects, size_t count) override;
 
 		/// Determines if the render target has successfully been initialized.
-		virtual bool IsInitialized() const override { return m_SwapChain && m_RenderTargetView; }
+		virtual bool IsInitialized() const override { return (m_SwapChain || m_Texture) && m_RenderTargetView; }
 		/// Gets the render targets window handle.
 		virtual HWND GetHandle() const override { return m_Handle; }
 		/// Gets the render targets width in pixels.
@@ -53,18 +67,42 @@ namespace Kyo2D
 		/// Determines if the vertical sync option is enabled.
 		virtual bool IsVSyncEnabled() const override { return m_VSync; }
 		/// Gets this render targets view matrix.
-		virtual const XMMATRIX &GetViewMatrix() const override { return m_ViewMatrix; }
+		virtual const Matrix4 &GetViewMatrix() const override { return m_ViewMatrix; }
+		/// @copydoc RenderTarget::GetTexture()
+		virtual std::shared_ptr<Texture> GetTexture() const override { return m_Texture; }
 
 	private:
 
+		/// Creates the render target view of a window target, on the canvas for flip model swap chains.
+		bool CreateWindowViews();
+		/// Copies a rectangle of the canvas into the back buffer.
+		void CopyCanvas(const DamageRect &rect);
+
+	private:
+
+		/// Number of buffers of flip model swap chains. With two, the back buffer holds the frame
+		/// before the last presented one.
+		static const UINT FlipBufferCount = 2;
+
 		HWND m_Handle;
 		std::uint16_t m_Width, m_Height;
 		bool m_Fullscreen;
 		bool m_VSync;
 		ComPtr<IDXGISwapChain> m_SwapChain;
+		/// The swap chain if it uses the flip model, nullptr for the sequential fallback.
+		ComPtr<IDXGISwapChain1> m_SwapChain1;
+		ComPtr<ID3D11Texture2D> m_BackBuffer;
+		/// Flip model: the texture frames are rendered into.
+		ComPtr<ID3D11Texture2D> m_Canvas;
+		/// Flip model: the rectangles changed by the last present, which the back buffer lacks.
+		std::vector<DamageRect> m_PresentedRects;
+		/// Flip model: the last present changed the whole frame.
+		bool m_PresentedAll;
+		std::vector<RECT> m_DirtyRects;
 		ComPtr<ID3D11RenderTargetView> m_RenderTargetView;
 		ComPtr<ID3D11DepthStencilView> m_DepthTargetView;
 		ComPtr<ID3D11DepthStencilState> m_DepthStencilState;
-		XMMATRIX m_ViewMatrix;
+		Matrix4 m_ViewMatrix;
+		std::shared_ptr<TextureD3D11> m_Texture;
 	};
 }
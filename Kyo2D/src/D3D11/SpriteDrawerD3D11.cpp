@@ -4,12 +4,19 @@
 #include "shaders/d3d11/Sprite11_PS.h"
 #include "shaders/d3d11/SpriteScale2X11_PS.h"
 #include "shaders/d3d11/SpriteScale2X11_VS.h"
+#include "shaders/d3d11/SpritePremul11_PS.h"
+#include "shaders/d3d11/SpriteScale2XPremul11_PS.h"
+#include "shaders/d3d11/SpriteAlpha11_PS.h"
+#include "shaders/d3d11/SpriteDistanceField11_PS.h"
 #include <algorithm>
 
 namespace Kyo2D
 {
 	SpriteDrawerD3D11::SpriteDrawerD3D11()
 		: m_Scale2XEnabled(true)
+		, m_PremultipliedAlpha(false)
+		, m_AlphaTexture(false)
+		, m_DistanceField(false)
 	{
 	}
 
@@ -25,6 +32,15 @@ namespace Kyo2D
 		if (!CreateScale2XShaders())
 			return false;
 
+		if (!CreatePremultipliedShaders())
+			return false;
+
+		if (!CreateAlphaShaders())
+			return false;
+
+		if (!CreateDistanceFieldShaders())
+			return false;
+
 		if (!CreateSampler())
 			return false;
 
@@ -42,57 +58,93 @@ namespace Kyo2D
 
 	bool SpriteDrawerD3D11::Prepare()
 	{
-		g_D3DDeviceContext11->RSSetState(m_RasterState.Get());
+		g_Context->D3DDeviceContext11->RSSetState(m_RasterState.Get());
 
 		// Prepare the sprite renderer
-		if (!m_Scale2XEnabled)
+		if (m_DistanceField)
+		{
+			// Distance fields are filtered linearly, edges come out smooth at any scale
+			g_Context->D3DDeviceContext11->VSSetShader(m_VertShaderSprite.Get(), 0, 0);
+			g_Context->D3DDeviceContext11->PSSetShader(m_PixShaderSpriteDistanceField.Get(), 0, 0);
+
+			g_Context->D3DDeviceContext11->PSSetSamplers(0, 1, m_LinearSampler.GetAddressOf());
+
+			g_Context->D3DDeviceContext11->OMSetBlendState(m_BlendState.Get(), 0, 0xFFFFFFFF);
+
+			ID3D11Buffer *buffers[] = {
+				m_ViewBuffer.Get(),
+				m_PerObjCBuffer.Get()
+			};
+			g_Context->D3DDeviceContext11->VSSetConstantBuffers(0, 2, buffers);
+
+			g_Context->D3DDeviceContext11->IASetInputLayout(m_SpriteInputLayout.Get());
+		}
+		else if (m_AlphaTexture)
+		{
+			// Alpha-only textures use the plain sprite vertex shader and straight alpha blending
+			g_Context->D3DDeviceContext11->VSSetShader(m_VertShaderSprite.Get(), 0, 0);
+			g_Context->D3DDeviceContext11->PSSetShader(m_PixShaderSpriteAlpha.Get(), 0, 0);
+
+			g_Context->D3DDeviceContext11->PSSetSamplers(0, 1, m_SpriteSampler.GetAddressOf());
+
+			g_Context->D3DDeviceContext11->OMSetBlendState(m_BlendState.Get(), 0, 0xFFFFFFFF);
+
+			ID3D11Buffer *buffers[] = {
+				m_ViewBuffer.Get(),
+				m_PerObjCBuffer.Get()
+			};
+			g_Context->D3DDeviceContext11->VSSetConstantBuffers(0, 2, buffers);
+
+			g_Context->D3DDeviceContext11->IASetInputLayout(m_SpriteInputLayout.Get());
+		}
+		else if (!m_Scale2XEnabled)
 		{
 			// Setup shader objects
-			g_D3DDeviceContext11->VSSetShader(m_VertShaderSprite.Get(), 0, 0);
-			g_D3DDeviceContext11->PSSetShader(m_PixShaderSprite.Get(), 0, 0);
+			g_Context->D3DDeviceContext11->VSSetShader(m_VertShaderSprite.Get(), 0, 0);
+			g_Context->D3DDeviceContext11->PSSetShader(m_PremultipliedAlpha ? m_PixShaderSpritePremul.Get() : m_PixShaderSprite.Get(), 0, 0);
 
-			g_D3DDeviceContext11->PSSetSamplers(0, 1, m_SpriteSampler.GetAddressOf());
+			g_Context->D3DDeviceContext11->PSSetSamplers(0, 1, m_SpriteSampler.GetAddressOf());
 
 			// Setup blend desc
-			g_D3DDeviceContext11->OMSetBlendState(m_BlendState.Get(), 0, 0xFFFFFFFF);
+			g_Context->D3DDeviceContext11->OMSetBlendState(m_PremultipliedAlpha ? m_BlendStatePremul.Get() : m_BlendState.Get(), 0, 0xFFFFFFFF);
 
 			ID3D11Buffer *buffers[] = {
 				m_ViewBuffer.Get(),
 				m_PerObjCBuffer.Get()
 			};
-			g_D3DDeviceContext11->VSSetConstantBuffers(0, 2, buffers);
+			g_Context->D3DDeviceContext11->VSSetConstantBuffers(0, 2, buffers);
 
 			// Set input layout
-			g_D3DDeviceContext11->IASetInputLayout(m_SpriteInputLayout.Get());
+			g_Context->D3DDeviceContext11->IASetInputLayout(m_SpriteInputLayout.Get());
 		}
 		else
 		{
 			// Setup shader objects
-			g_D3DDeviceContext11->VSSetShader(m_VertShaderSpriteScale2X.Get(), 0, 0);
-			g_D3DDeviceContext11->PSSetShader(m_PixShaderSpriteScale2X.Get(), 0, 0);
+			g_Context->D3DDeviceContext11->VSSetShader(m_VertShaderSpriteScale2X.Get(), 0, 0);
+			g_Context->D3DDeviceContext11->PSSetShader(m_PremultipliedAlpha ? m_PixShaderSpriteScale2XPremul.Get() : m_PixShaderSpriteScale2X.Get(), 0, 0);
 
 			// Set texture sampler
-			g_D3DDeviceContext11->PSSetSamplers(0, 1, m_SpriteSampler.GetAddressOf());
+			g_Context->D3DDeviceContext11->PSSetSamplers(0, 1, m_SpriteSampler.GetAddressOf());
 
 			// Setup blend desc
-			g_D3DDeviceContext11->OMSetBlendState(m_BlendState.Get(), 0, 0xFFFFFFFF);
+			g_Context->D3DDeviceContext11->OMSetBlendState(m_PremultipliedAlpha ? m_BlendStatePremul.Get() : m_BlendState.Get(), 0, 0xFFFFFFFF);
 
 			ID3D11Buffer *buffers[] = {
 				m_ViewBuffer.Get(),
 				m_PerObjCBuffer.Get()
 			};
-			g_D3DDeviceContext11->VSSetConstantBuffers(0, 2, buffers);
+			g_Context->D3DDeviceContext11->VSSetConstantBuffers(0, 2, buffers);
 
 			// Set input layout
-			g_D3DDeviceContext11->IASetInputLayout(m_SpriteScale2XInputLayout.Get());
+			g_Context->D3DDeviceContext11->IASetInputLayout(m_SpriteScale2XInputLayout.Get());
 		}
 
 		return true;
 	}
 
-	void SpriteDrawerD3D11::SetViewMatrix(const XMMATRIX & ViewMatrix)
+	void SpriteDrawerD3D11::SetViewMatrix(const Matrix4 & ViewMatrix)
 	{
-		g_D3DDeviceContext11->UpdateSubresource(m_ViewBuffer.Get(), 0, nullptr, &ViewMatrix, 0, 0);
+		g_Context->D3DDeviceContext11->UpdateSubresource(m_ViewBuffer.Get(), 0, nullptr, &ViewMatrix, 0, 0);
 	}
 
 	void SpriteDrawerD3D11::SetScale2XEnabled(bool Enable)
@@ -100,6 +152,21 @@ namespace Kyo2D
 		m_Scale2XEnabled = Enable;
 	}
 
+	void SpriteDrawerD3D11::SetPremultipliedAlpha(bool Enable)
+	{
+		m_PremultipliedAlpha = Enable;
+	}
+
+	void SpriteDrawerD3D11::SetAlphaTexture(bool Enable)
+	{
+		m_AlphaTexture = Enable;
+	}
+
+	void SpriteDrawerD3D11::SetDistanceField(bool Enable)
+	{
+		m_DistanceField = Enable;
+	}
+
 	void SpriteDrawerD3D11::DrawSpriteAt(std::int32_t texW, std::int32_t texH, float X, float Y, float Z, float Rotation, std::uint32_t color, std::uint32_t colorkey)
 	{
 		// Generate vertices
@@ -118,13 +185,14 @@ namespace Kyo2D
 		// Update vertex buffer
 		D3D11_MAPPED_SUBRESOURCE ms;
 		{
-			HRESULT hr = g_D3DDeviceContext11->Map(m_SpriteGeomBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &ms);   // map the buffer
+			g_Context->Stats.BufferMaps++;
+			HRESULT hr = g_Context->D3DDeviceContext11->Map(m_SpriteGeomBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &ms);   // map the buffer
 			if (FAILED(hr))
 			{
 				return;
 			}
 			memcpy(ms.pData, Vertices, sizeof(Vertices));														// copy the data
-			g_D3DDeviceContext11->Unmap(m_SpriteGeomBuffer.Get(), 0);												// unmap the buffer
+			g_Context->D3DDeviceContext11->Unmap(m_SpriteGeomBuffer.Get(), 0);												// unmap the buffer
 		}
 
 		// Apply size
@@ -162,13 +230,14 @@ namespace Kyo2D
 		// Update vertex buffer
 		D3D11_MAPPED_SUBRESOURCE ms;
 		{
-			HRESULT hr = g_D3DDeviceContext11->Map(m_SpriteGeomBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &ms);   // map the buffer
+			g_Context->Stats.BufferMaps++;
+			HRESULT hr = g_Context->D3DDeviceContext11->Map(m_SpriteGeomBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &ms);   // map the buffer
 			if (FAILED(hr))
 			{
 				return;
 			}
 			memcpy(ms.pData, Vertices, sizeof(Vertices));														// copy the data
-			g_D3DDeviceContext11->Unmap(m_SpriteGeomBuffer.Get(), 0);												// unmap the buffer
+			g_Context->D3DDeviceContext11->Unmap(m_SpriteGeomBuffer.Get(), 0);												// unmap the buffer
 		}
 
 		m_PerObjectBuffer.TargetWidth = srcW;
@@ -200,13 +269,14 @@ namespace Kyo2D
 		// Update vertex buffer
 		D3D11_MAPPED_SUBRESOURCE ms;
 		{
-			HRESULT hr = g_D3DDeviceContext11->Map(m_SpriteGeomBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &ms);   // map the buffer
+			g_Context->Stats.BufferMaps++;
+			HRESULT hr = g_Context->D3DDeviceContext11->Map(m_SpriteGeomBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &ms);   // map the buffer
 			if (FAILED(hr))
 			{
 				return;
 			}
 			memcpy(ms.pData, Vertices, sizeof(Vertices));														// copy the data
-			g_D3DDeviceContext11->Unmap(m_SpriteGeomBuffer.Get(), 0);												// unmap the buffer
+			g_Context->D3DDeviceContext11->Unmap(m_SpriteGeomBuffer.Get(), 0);												// unmap the buffer
 		}
 
 		m_PerObjectBuffer.TargetWidth = W;
@@ -243,13 +313,14 @@ namespace Kyo2D
 		// Update vertex buffer
 		D3D11_MAPPED_SUBRESOURCE ms;
 		{
-			HRESULT hr = g_D3DDeviceContext11->Map(m_SpriteGeomBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &ms);   // map the buffer
+			g_Context->Stats.BufferMaps++;
+			HRESULT hr = g_Context->D3DDeviceContext11->Map(m_SpriteGeomBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &ms);   // map the buffer
 			if (FAILED(hr))
 			{
 				return;
 			}
 			memcpy(ms.pData, Vertices, sizeof(Vertices));														// copy the data
-			g_D3DDeviceContext11->Unmap(m_SpriteGeomBuffer.Get(), 0);												// unmap the buffer
+			g_Context->D3DDeviceContext11->Unmap(m_SpriteGeomBuffer.Get(), 0);												// unmap the buffer
 		}
 
 		m_PerObjectBuffer.TargetWidth = W;
@@ -281,13 +352,14 @@ namespace Kyo2D
 		// Update vertex buffer
 		D3D11_MAPPED_SUBRESOURCE ms;
 		{
-			HRESULT hr = g_D3DDeviceContext11->Map(m_SpriteGeomBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &ms);   // map the buffer
+			g_Context->Stats.BufferMaps++;
+			HRESULT hr = g_Context->D3DDeviceContext11->Map(m_SpriteGeomBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &ms);   // map the buffer
 			if (FAILED(hr))
 			{
 				return;
 			}
 			memcpy(ms.pData, Vertices, sizeof(Vertices));														// copy the data
-			g_D3DDeviceContext11->Unmap(m_SpriteGeomBuffer.Get(), 0);												// unmap the buffer
+			g_Context->D3DDeviceContext11->Unmap(m_SpriteGeomBuffer.Get(), 0);												// unmap the buffer
 		}
 
 		m_PerObjectBuffer.TargetWidth = W;
@@ -304,7 +376,7 @@ namespace Kyo2D
 	bool SpriteDrawerD3D11::CreateSpriteShaders()
 	{
 		// Load sprite vertex shader
-		HRESULT hr = g_D3DDevice11->CreateVertexShader(g_sprite11MainVS, sizeof(g_sprite11MainVS), nullptr, m_VertShaderSprite.GetAddressOf());
+		HRESULT hr = g_Context->D3DDevice11->CreateVertexShader(g_sprite11MainVS, sizeof(g_sprite11MainVS), nullptr, m_VertShaderSprite.GetAddressOf());
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Could not create sprite vertex shader!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
@@ -320,7 +392,7 @@ namespace Kyo2D
 			{ "TEXCOORD", 1, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
 		};
 
-		hr = g_D3DDevice11->CreateInputLayout(iedSprite, 4, g_sprite11MainVS, sizeof(g_sprite11MainVS), m_SpriteInputLayout.GetAddressOf());
+		hr = g_Context->D3DDevice11->CreateInputLayout(iedSprite, 4, g_sprite11MainVS, sizeof(g_sprite11MainVS), m_SpriteInputLayout.GetAddressOf());
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Could not create sprite input layout!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
@@ -328,7 +400,7 @@ namespace Kyo2D
 		}
 
 		// Load pixel shader
-		hr = g_D3DDevice11->CreatePixelShader(g_sprite11MainPS, sizeof(g_sprite11MainPS), nullptr, m_PixShaderSprite.GetAddressOf());
+		hr = g_Context->D3DDevice11->CreatePixelShader(g_sprite11MainPS, sizeof(g_sprite11MainPS), nullptr, m_PixShaderSprite.GetAddressOf());
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Could not create sprite pixel shader!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
@@ -341,7 +413,7 @@ namespace Kyo2D
 	bool SpriteDrawerD3D11::CreateScale2XShaders()
 	{
 		// Load sprite vertex shader
-		HRESULT hr = g_D3DDevice11->CreateVertexShader(g_spriteScale2X11MainVS, sizeof(g_spriteScale2X11MainVS), nullptr, m_VertShaderSpriteScale2X.GetAddressOf());
+		HRESULT hr = g_Context->D3DDevice11->CreateVertexShader(g_spriteScale2X11MainVS, sizeof(g_spriteScale2X11MainVS), nullptr, m_VertShaderSpriteScale2X.GetAddressOf());
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Could not create scale2x vertex shader!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
@@ -357,7 +429,7 @@ namespace Kyo2D
 			{ "TEXCOORD", 1, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
 		};
 
-		hr = g_D3DDevice11->CreateInputLayout(iedSprite, 4, g_spriteScale2X11MainVS, sizeof(g_spriteScale2X11MainVS), m_SpriteScale2XInputLayout.GetAddressOf());
+		hr = g_Context->D3DDevice11->CreateInputLayout(iedSprite, 4, g_spriteScale2X11MainVS, sizeof(g_spriteScale2X11MainVS), m_SpriteScale2XInputLayout.GetAddressOf());
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Could not create scale2x input layout!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
@@ -365,7 +437,7 @@ namespace Kyo2D
 		}
 
 		// Load pixel shader
-		hr = g_D3DDevice11->CreatePixelShader(g_spriteScale2X11MainPS, sizeof(g_spriteScale2X11MainPS), nullptr, m_PixShaderSpriteScale2X.GetAddressOf());
+		hr = g_Context->D3DDevice11->CreatePixelShader(g_spriteScale2X11MainPS, sizeof(g_spriteScale2X11MainPS), nullptr, m_PixShaderSpriteScale2X.GetAddressOf());
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Could not create scale2x pixel shader!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
@@ -375,6 +447,52 @@ namespace Kyo2D
 		return true;
 	}
 
+	bool SpriteDrawerD3D11::CreatePremultipliedShaders()
+	{
+		// Both variants share the vertex shaders and input layouts of their colorkey counterparts
+		HRESULT hr = g_Context->D3DDevice11->CreatePixelShader(g_spritePremul11MainPS, sizeof(g_spritePremul11MainPS), nullptr, m_PixShaderSpritePremul.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create premultiplied sprite pixel shader!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
+
+		hr = g_Context->D3DDevice11->CreatePixelShader(g_spriteScale2XPremul11MainPS, sizeof(g_spriteScale2XPremul11MainPS), nullptr, m_PixShaderSpriteScale2XPremul.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create premultiplied scale2x pixel shader!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool SpriteDrawerD3D11::CreateAlphaShaders()
+	{
+		// Shares the vertex shader and input layout of the plain sprite pipeline
+		HRESULT hr = g_Context->D3DDevice11->CreatePixelShader(g_spriteAlpha11MainPS, sizeof(g_spriteAlpha11MainPS), nullptr, m_PixShaderSpriteAlpha.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create alpha sprite pixel shader!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool SpriteDrawerD3D11::CreateDistanceFieldShaders()
+	{
+		// Shares the vertex shader and input layout of the plain sprite pipeline
+		HRESULT hr = g_Context->D3DDevice11->CreatePixelShader(g_spriteDistanceField11MainPS, sizeof(g_spriteDistanceField11MainPS), nullptr, m_PixShaderSpriteDistanceField.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create distance field sprite pixel shader!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
+
+		return true;
+	}
+
 	bool SpriteDrawerD3D11::CreateSampler()
 	{
 		// Create sprite sampler
@@ -388,13 +506,22 @@ namespace Kyo2D
 		sd.MinLOD = 0.0f;
 		sd.MaxLOD = 0.0f;
 		sd.MipLODBias = 0.0f;
-		HRESULT hr = g_D3DDevice11->CreateSamplerState(&sd, m_SpriteSampler.GetAddressOf());
+		HRESULT hr = g_Context->D3DDevice11->CreateSamplerState(&sd, m_SpriteSampler.GetAddressOf());
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Could not create sprite sampler!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
 			return false;
 		}
 
+		// Distance fields are sampled with filtering, the same otherwise
+		sd.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+		hr = g_Context->D3DDevice11->CreateSamplerState(&sd, m_LinearSampler.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create linear sprite sampler!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
+
 		return true;
 	}
 
@@ -411,13 +538,22 @@ namespace Kyo2D
 		blendDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ZERO;
 		blendDesc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
 		blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
-		HRESULT hr = g_D3DDevice11->CreateBlendState(&blendDesc, m_BlendState.GetAddressOf());
+		HRESULT hr = g_Context->D3DDevice11->CreateBlendState(&blendDesc, m_BlendState.GetAddressOf());
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Could not create blend state!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
 			return false;
 		}
 
+		// Premultiplied textures already contain color * alpha
+		blendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
+		hr = g_Context->D3DDevice11->CreateBlendState(&blendDesc, m_BlendStatePremul.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create premultiplied blend state!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
+
 		return true;
 	}
 
@@ -440,7 +576,7 @@ namespace Kyo2D
 		cbd.Usage = D3D11_USAGE_DEFAULT;
 		cbd.ByteWidth = 64 + 16;
 		cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-		hr = g_D3DDevice11->CreateBuffer(&cbd, &initData, m_PerObjCBuffer.GetAddressOf());
+		hr = g_Context->D3DDevice11->CreateBuffer(&cbd, &initData, m_PerObjCBuffer.GetAddressOf());
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Could not create per-object constant buffer!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
@@ -452,7 +588,7 @@ namespace Kyo2D
 		cbd.Usage = D3D11_USAGE_DEFAULT;
 		cbd.ByteWidth = 64;
 		cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-		hr = g_D3DDevice11->CreateBuffer(&cbd, nullptr, m_ViewBuffer.GetAddressOf());
+		hr = g_Context->D3DDevice11->CreateBuffer(&cbd, nullptr, m_ViewBuffer.GetAddressOf());
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Could not create constant buffer!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
@@ -466,7 +602,7 @@ namespace Kyo2D
 		bd.ByteWidth = sizeof(SpriteVertex2D) * 4;     // size is the SpriteVertex2D struct * 4
 		bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;       // use as a vertex buffer
 		bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;    // allow CPU to write in buffer
-		hr = g_D3DDevice11->CreateBuffer(&bd, nullptr, m_SpriteGeomBuffer.GetAddressOf());       // create the buffer
+		hr = g_Context->D3DDevice11->CreateBuffer(&bd, nullptr, m_SpriteGeomBuffer.GetAddressOf());       // create the buffer
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Could not create sprite vertex buffer!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
@@ -483,7 +619,8 @@ namespace Kyo2D
 		ZeroMemory(&rasterDesc, sizeof(rasterDesc));
 		rasterDesc.CullMode = D3D11_CULL_NONE;
 		rasterDesc.FillMode = D3D11_FILL_SOLID;
-		HRESULT hr = g_D3DDevice11->CreateRasterizerState(&rasterDesc, m_RasterState.GetAddressOf());
+		rasterDesc.ScissorEnable = TRUE;	// the scissor rect is managed by the render target
+		HRESULT hr = g_Context->D3DDevice11->CreateRasterizerState(&rasterDesc, m_RasterState.GetAddressOf());
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Could not create rasterizer state!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
@@ -495,24 +632,27 @@ namespace Kyo2D
 
 	void SpriteDrawerD3D11::UpdateTransform(float x, float y, float Rotation)
 	{
-		if (!g_D3DDeviceContext11)
+		if (!g_Context->D3DDeviceContext11)
 			return;
 
 		m_PerObjectBuffer.Transform =
 			XMMatrixRotationZ(Rotation) *
 			XMMatrixTranslation(x, y, 0.0f);
 
-		g_D3DDeviceContext11->UpdateSubresource(m_PerObjCBuffer.Get(), 0, nullptr, &m_PerObjectBuffer, 0, 0);
+		g_Context->D3DDeviceContext11->UpdateSubresource(m_PerObjCBuffer.Get(), 0, nullptr, &m_PerObjectBuffer, 0, 0);
 	}
 
 	void SpriteDrawerD3D11::Dispatch()
 	{
 		UINT stride = sizeof(SpriteVertex2D);
 		UINT offset = 0;
-		g_D3DDeviceContext11->IASetVertexBuffers(0, 1, m_SpriteGeomBuffer.GetAddressOf(), &stride, &offset);
+		g_Context->D3DDeviceContext11->IASetVertexBuffers(0, 1, m_SpriteGeomBuffer.GetAddressOf(), &stride, &offset);
 
 		// Draw the actual geometry
-		g_D3DDeviceContext11->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
-		g_D3DDeviceContext11->Draw(4, 0);
+		g_Context->D3DDeviceContext11->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+		g_Context->D3DDeviceContext11->Draw(4, 0);
+
+		g_Context->Stats.DrawCalls++;
+		g_Context->Stats.Vertices += 4;
 	}
 }
@@ -3,14 +3,13 @@
 
 #include "../SpriteDrawer.h"
 #include <d3d11.h>
+#include <DirectXMath.h>
 #include <comptr.h>
 #include "../Texture.h"
+#include "../EngineContext.h"
 using namespace Microsoft::WRL;
 using namespace DirectX;
 
-extern ComPtr<ID3D11Device> g_D3DDevice11;
-extern ComPtr<ID3D11DeviceContext> g_D3DDeviceContext11;
-
 namespace Kyo2D
 {
 	/// Base class for sprite rendering.
@@ -27,15 +26,27 @@ namespace Kyo2D
 		virtual bool Initialize() override;
 		/// @copydoc SpriteDrawer::Prepare()
 		virtual bool Prepare() override;
-		/// @copydoc SpriteDrawer::SetViewMatrix(const XMMATRIX &)
-		virtual void SetViewMatrix(const XMMATRIX &ViewMatrix) override;
+		/// @copydoc SpriteDrawer::SetViewMatrix(const Matrix4 &)
+		virtual void SetViewMatrix(const Matrix4 &ViewMatrix) override;
 		/// @copydoc SpriteDrawer::SetScale2XEnabled(bool)
 		virtual void SetScale2XEnabled(bool Enable) override;
+		/// @copydoc SpriteDrawer::SetPremultipliedAlpha(bool)
+		virtual void SetPremultipliedAlpha(bool Enable) override;
+		/// @copydoc SpriteDrawer::SetAlphaTexture(bool)
+		virtual void SetAlphaTexture(bool Enable) override;
+		/// @copydoc SpriteDrawer::SetDistanceField(bool)
+		virtual void SetDistanceField(bool Enable) override;
 
 	public:
 
 		/// @copydoc SpriteDrawer::IsScale2XEnabled()
 		virtual bool IsScale2XEnabled() const override { return m_Scale2XEnabled; }
+		/// @copydoc SpriteDrawer::IsPremultipliedAlpha()
+		virtual bool IsPremultipliedAlpha() const override { return m_PremultipliedAlpha; }
+		/// @copydoc SpriteDrawer::IsAlphaTexture()
+		virtual bool IsAlphaTexture() const override { return m_AlphaTexture; }
+		/// @copydoc SpriteDrawer::IsDistanceField()
+		virtual bool IsDistanceField() const override { return m_DistanceField; }
 
 	public:
 
@@ -56,6 +67,12 @@ namespace Kyo2D
 		bool CreateSpriteShaders();
 		/// 
 		bool CreateScale2XShaders();
+		/// Creates the pixel shaders used for premultiplied textures.
+		bool CreatePremultipliedShaders();
+		/// Creates the pixel shader used for alpha-only textures.
+		bool CreateAlphaShaders();
+		/// Creates the pixel shader used for distance field textures.
+		bool CreateDistanceFieldShaders();
 		/// 
 		bool CreateSampler();
 		/// 
@@ -106,16 +123,25 @@ namespace Kyo2D
 		ComPtr<ID3D11PixelShader> m_PixShaderSprite;
 		ComPtr<ID3D11VertexShader> m_VertShaderSpriteScale2X;
 		ComPtr<ID3D11PixelShader> m_PixShaderSpriteScale2X;
+		ComPtr<ID3D11PixelShader> m_PixShaderSpritePremul;
+		ComPtr<ID3D11PixelShader> m_PixShaderSpriteScale2XPremul;
+		ComPtr<ID3D11PixelShader> m_PixShaderSpriteAlpha;
+		ComPtr<ID3D11PixelShader> m_PixShaderSpriteDistanceField;
 		ComPtr<ID3D11Buffer> m_SpriteGeomBuffer;
 		ComPtr<ID3D11Buffer> m_PerObjCBuffer;
 		ComPtr<ID3D11Buffer> m_ViewBuffer;
 		ComPtr<ID3D11InputLayout> m_SpriteInputLayout;
 		ComPtr<ID3D11InputLayout> m_SpriteScale2XInputLayout;
 		ComPtr<ID3D11SamplerState> m_SpriteSampler;
+		ComPtr<ID3D11SamplerState> m_LinearSampler;
 		ComPtr<ID3D11BlendState> m_BlendState;
+		ComPtr<ID3D11BlendState> m_BlendStatePremul;
 		ComPtr<ID3D11RasterizerState> m_RasterState;
 		cbPerObject m_PerObjectBuffer;
 		XMMATRIX m_ViewMatrix;
 		bool m_Scale2XEnabled;
+		bool m_PremultipliedAlpha;
+		bool m_AlphaTexture;
+		bool m_DistanceField;
 	};
 }
@@ -1,9 +1,17 @@
-
 #include "TextDrawerD3D11.h"
+#include "shaders/d3d11/Sprite11_VS.h"
+#include "shaders/d3d11/Sprite11_PS.h"
+#include "shaders/d3d11/SpriteAlpha11_PS.h"
+#include "shaders/d3d11/SpriteDistanceField11_PS.h"
+#include <algorithm>
+#include <vector>
 
 namespace Kyo2D
 {
 	TextDrawerD3D11::TextDrawerD3D11()
+		: m_BufferedGlyphs(0)
+		, m_AlphaTexture(false)
+		, m_DistanceField(false)
 	{
 	}
 
@@ -11,5 +19,295 @@ namespace Kyo2D
 	{
 	}
 
+	bool TextDrawerD3D11::Initialize()
+	{
+		if (!CreateShaders())
+			return false;
+
+		if (!CreateStates())
+			return false;
+
+		if (!CreateBuffers())
+			return false;
+
+		return true;
+	}
+
+	bool TextDrawerD3D11::Prepare()
+	{
+		g_Context->D3DDeviceContext11->RSSetState(m_RasterState.Get());
+
+		g_Context->D3DDeviceContext11->VSSetShader(m_VertShader.Get(), 0, 0);
+		if (m_DistanceField)
+			g_Context->D3DDeviceContext11->PSSetShader(m_PixShaderDistanceField.Get(), 0, 0);
+		else if (m_AlphaTexture)
+			g_Context->D3DDeviceContext11->PSSetShader(m_PixShaderAlpha.Get(), 0, 0);
+		else
+			g_Context->D3DDeviceContext11->PSSetShader(m_PixShader.Get(), 0, 0);
+
+		// Distance fields are filtered linearly, glyph bitmaps are drawn 1:1
+		g_Context->D3DDeviceContext11->PSSetSamplers(0, 1, m_DistanceField ? m_LinearSampler.GetAddressOf() : m_PointSampler.GetAddressOf());
+
+		g_Context->D3DDeviceContext11->OMSetBlendState(m_BlendState.Get(), 0, 0xFFFFFFFF);
+
+		ID3D11Buffer *buffers[] = {
+			m_ViewBuffer.Get(),
+			m_PerObjCBuffer.Get()
+		};
+		g_Context->D3DDeviceContext11->VSSetConstantBuffers(0, 2, buffers);
+
+		g_Context->D3DDeviceContext11->IASetInputLayout(m_InputLayout.Get());
+		return true;
+	}
+
+	void TextDrawerD3D11::SetViewMatrix(const Matrix4 & ViewMatrix)
+	{
+		g_Context->D3DDeviceContext11->UpdateSubresource(m_ViewBuffer.Get(), 0, nullptr, &ViewMatrix, 0, 0);
+	}
+
+	void TextDrawerD3D11::SetAlphaTexture(bool Enable)
+	{
+		m_AlphaTexture = Enable;
+	}
+
+	void TextDrawerD3D11::SetDistanceField(bool Enable)
+	{
+		m_DistanceField = Enable;
+	}
+
+	void TextDrawerD3D11::DrawGlyphs(std::int32_t texW, std::int32_t texH, const GlyphQuad *quads, size_t count, std::uint32_t color, std::uint32_t colorkey)
+	{
+		const float invW = 1.0f / static_cast<float>(texW);
+		const float invH = 1.0f / static_cast<float>(texH);
+
+		UINT stride = sizeof(GlyphVertex);
+		UINT offset = 0;
+		g_Context->D3DDeviceContext11->IASetVertexBuffers(0, 1, m_VertexBuffer.GetAddressOf(), &stride, &offset);
+		g_Context->D3DDeviceContext11->IASetIndexBuffer(m_IndexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
+		g_Context->D3DDeviceContext11->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+		while (count > 0)
+		{
+			// Append to the glyphs of previous runs, the gpu may still read them. A full buffer is discarded.
+			if (m_BufferedGlyphs == MaxGlyphsPerBatch)
+				m_BufferedGlyphs = 0;
+
+			const std::uint32_t first = m_BufferedGlyphs;
+			const std::uint32_t batch = static_cast<std::uint32_t>(std::min<size_t>(count, MaxGlyphsPerBatch - first));
+
+			D3D11_MAPPED_SUBRESOURCE ms;
+			g_Context->Stats.BufferMaps++;
+			HRESULT hr = g_Context->D3DDeviceContext11->Map(m_VertexBuffer.Get(), 0, first == 0 ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &ms);
+			if (FAILED(hr))
+			{
+				return;
+			}
+
+			// 0--1
+			// | /|
+			// |/ |
+			// 2--3
+			GlyphVertex *vertices = static_cast<GlyphVertex*>(ms.pData) + first * 4;
+			for (std::uint32_t i = 0; i < batch; ++i)
+			{
+				const GlyphQuad &quad = quads[i];
+				const float u0 = quad.SrcX * invW, v0 = quad.SrcY * invH;
+				const float u1 = (quad.SrcX + quad.SrcW) * invW, v1 = (quad.SrcY + quad.SrcH) * invH;
+				const float x1 = quad.X + quad.W, y1 = quad.Y + quad.H;
+
+				vertices[0] = { quad.X, quad.Y, 0.0f, color, u0, v0, colorkey };
+				vertices[1] = { x1, quad.Y, 0.0f, color, u1, v0, colorkey };
+				vertices[2] = { quad.X, y1, 0.0f, color, u0, v1, colorkey };
+				vertices[3] = { x1, y1, 0.0f, color, u1, v1, colorkey };
+				vertices += 4;
+			}
+
+			g_Context->D3DDeviceContext11->Unmap(m_VertexBuffer.Get(), 0);
+			g_Context->D3DDeviceContext11->DrawIndexed(batch * 6, 0, first * 4);
+
+			g_Context->Stats.DrawCalls++;
+			g_Context->Stats.Vertices += batch * 4;
+
+			m_BufferedGlyphs += batch;
+			quads += batch;
+			count -= batch;
+		}
+	}
+
+	bool TextDrawerD3D11::CreateShaders()
+	{
+		// The sprite shaders draw the glyphs, positions are already in pixels
+		HRESULT hr = g_Context->D3DDevice11->CreateVertexShader(g_sprite11MainVS, sizeof(g_sprite11MainVS), nullptr, m_VertShader.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create text vertex shader!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
+
+		D3D11_INPUT_ELEMENT_DESC ied[] =
+		{
+			{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+			{ "TEXCOORD", 1, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		};
+
+		hr = g_Context->D3DDevice11->CreateInputLayout(ied, 4, g_sprite11MainVS, sizeof(g_sprite11MainVS), m_InputLayout.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create text input layout!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
+
+		hr = g_Context->D3DDevice11->CreatePixelShader(g_sprite11MainPS, sizeof(g_sprite11MainPS), nullptr, m_PixShader.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create text pixel shader!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
+
+		hr = g_Context->D3DDevice11->CreatePixelShader(g_spriteAlpha11MainPS, sizeof(g_spriteAlpha11MainPS), nullptr, m_PixShaderAlpha.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create alpha text pixel shader!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
+
+		hr = g_Context->D3DDevice11->CreatePixelShader(g_spriteDistanceField11MainPS, sizeof(g_spriteDistanceField11MainPS), nullptr, m_PixShaderDistanceField.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create distance field text pixel shader!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool TextDrawerD3D11::CreateStates()
+	{
+		D3D11_SAMPLER_DESC sd;
+		ZeroMemory(&sd, sizeof(sd));
+		sd.Filter = D3D11_FILTER_MIN_MAG_MIP_POINT;
+		sd.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+		sd.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+		sd.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+		HRESULT hr = g_Context->D3DDevice11->CreateSamplerState(&sd, m_PointSampler.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create text sampler!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
+
+		sd.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+		hr = g_Context->D3DDevice11->CreateSamplerState(&sd, m_LinearSampler.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create linear text sampler!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
+
+		// Straight alpha blending like the sprite pipeline
+		D3D11_BLEND_DESC blendDesc;
+		ZeroMemory(&blendDesc, sizeof(blendDesc));
+		blendDesc.RenderTarget[0].BlendEnable = true;
+		blendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
+		blendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+		blendDesc.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
+		blendDesc.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+		blendDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ZERO;
+		blendDesc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
+		blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+		hr = g_Context->D3DDevice11->CreateBlendState(&blendDesc, m_BlendState.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create text blend state!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
+
+		D3D11_RASTERIZER_DESC rasterDesc;
+		ZeroMemory(&rasterDesc, sizeof(rasterDesc));
+		rasterDesc.CullMode = D3D11_CULL_NONE;
+		rasterDesc.FillMode = D3D11_FILL_SOLID;
+		rasterDesc.ScissorEnable = TRUE;	// the scissor rect is managed by the render target
+		hr = g_Context->D3DDevice11->CreateRasterizerState(&rasterDesc, m_RasterState.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create text rasterizer state!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool TextDrawerD3D11::CreateBuffers()
+	{
+		// Glyph vertex stream
+		D3D11_BUFFER_DESC bd;
+		ZeroMemory(&bd, sizeof(bd));
+		bd.Usage = D3D11_USAGE_DYNAMIC;
+		bd.ByteWidth = sizeof(GlyphVertex) * 4 * MaxGlyphsPerBatch;
+		bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		HRESULT hr = g_Context->D3DDevice11->CreateBuffer(&bd, nullptr, m_VertexBuffer.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create text vertex buffer!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
 
+		// Two triangles per glyph, the same for every batch
+		std::vector<std::uint16_t> indices(6 * MaxGlyphsPerBatch);
+		for (std::uint32_t i = 0; i < MaxGlyphsPerBatch; ++i)
+		{
+			const std::uint16_t v = static_cast<std::uint16_t>(i * 4);
+			std::uint16_t *quad = &indices[i * 6];
+			quad[0] = v;		quad[1] = v + 1;	quad[2] = v + 2;
+			quad[3] = v + 2;	quad[4] = v + 1;	quad[5] = v + 3;
+		}
+
+		D3D11_SUBRESOURCE_DATA initData;
+		ZeroMemory(&initData, sizeof(initData));
+		initData.pSysMem = indices.data();
+
+		ZeroMemory(&bd, sizeof(bd));
+		bd.Usage = D3D11_USAGE_IMMUTABLE;
+		bd.ByteWidth = static_cast<UINT>(indices.size() * sizeof(std::uint16_t));
+		bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+		hr = g_Context->D3DDevice11->CreateBuffer(&bd, &initData, m_IndexBuffer.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create text index buffer!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
+
+		// The world matrix is the identity for every glyph
+		cbPerObject perObject = {};
+		perObject.Transform = Matrix4::Identity();
+		initData.pSysMem = &perObject;
+
+		D3D11_BUFFER_DESC cbd;
+		ZeroMemory(&cbd, sizeof(cbd));
+		cbd.Usage = D3D11_USAGE_IMMUTABLE;
+		cbd.ByteWidth = sizeof(cbPerObject);
+		cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		hr = g_Context->D3DDevice11->CreateBuffer(&cbd, &initData, m_PerObjCBuffer.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create text per-object constant buffer!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
+
+		ZeroMemory(&cbd, sizeof(cbd));
+		cbd.Usage = D3D11_USAGE_DEFAULT;
+		cbd.ByteWidth = 64;
+		cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		hr = g_Context->D3DDevice11->CreateBuffer(&cbd, nullptr, m_ViewBuffer.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not create text constant buffer!", L"Error", MB_ICONERROR | MB_OK | MB_TASKMODAL);
+			return false;
+		}
+
+		return true;
+	}
 }
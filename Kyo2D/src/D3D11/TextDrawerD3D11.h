@@ -1,11 +1,15 @@
-
 #pragma once
 
 #include "../TextDrawer.h"
+#include <d3d11.h>
+#include <comptr.h>
+#include "../EngineContext.h"
+using namespace Microsoft::WRL;
 
 namespace Kyo2D
 {
-	/// Base class for text rendering.
+	/// Text rendering with Direct3D 11. Glyphs are appended to a dynamic vertex buffer and drawn
+	/// as indexed quads. The sprite shaders are reused with an identity world matrix.
 	class TextDrawerD3D11 : public TextDrawer
 	{
 	public:
@@ -15,6 +19,74 @@ namespace Kyo2D
 		/// Destructor.
 		virtual ~TextDrawerD3D11();
 
+		/// @copydoc TextDrawer::Initialize()
+		virtual bool Initialize() override;
+		/// @copydoc TextDrawer::Prepare()
+		virtual bool Prepare() override;
+		/// @copydoc TextDrawer::SetViewMatrix(const Matrix4 &)
+		virtual void SetViewMatrix(const Matrix4 &ViewMatrix) override;
+		/// @copydoc TextDrawer::SetAlphaTexture(bool)
+		virtual void SetAlphaTexture(bool Enable) override;
+		/// @copydoc TextDrawer::SetDistanceField(bool)
+		virtual void SetDistanceField(bool Enable) override;
+
+	public:
+
+		/// @copydoc TextDrawer::DrawGlyphs()
+		virtual void DrawGlyphs(std::int32_t texW, std::int32_t texH, const GlyphQuad *quads, size_t count, std::uint32_t color, std::uint32_t colorkey) override;
+
+	public:
+
+		/// @copydoc TextDrawer::IsAlphaTexture()
+		virtual bool IsAlphaTexture() const override { return m_AlphaTexture; }
+		/// @copydoc TextDrawer::IsDistanceField()
+		virtual bool IsDistanceField() const override { return m_DistanceField; }
+
+	private:
+
+		/// Creates the shaders and the input layout.
+		bool CreateShaders();
+		/// Creates the samplers, blend state and rasterizer state.
+		bool CreateStates();
+		/// Creates the vertex, index and constant buffers.
+		bool CreateBuffers();
+
+	private:
+
+		/// Layout of the per-object constant buffer of the sprite vertex shader.
+		struct cbPerObject
+		{
+			Matrix4 Transform;
+			FLOAT TargetWidth, TargetHeight, RawWidth, RawHeight;
+		};
+
+		/// Vertex structure of the sprite shaders.
+		struct GlyphVertex
+		{
+			FLOAT X, Y, Z;			// position
+			std::uint32_t Color;	// color
+			FLOAT U, V;				// texture coordinates
+			std::uint32_t ColorKey;	// color key
+		};
+
+	private:
 
+		ComPtr<ID3D11VertexShader> m_VertShader;
+		ComPtr<ID3D11PixelShader> m_PixShader;
+		ComPtr<ID3D11PixelShader> m_PixShaderAlpha;
+		ComPtr<ID3D11PixelShader> m_PixShaderDistanceField;
+		ComPtr<ID3D11InputLayout> m_InputLayout;
+		ComPtr<ID3D11Buffer> m_VertexBuffer;
+		ComPtr<ID3D11Buffer> m_IndexBuffer;
+		ComPtr<ID3D11Buffer> m_ViewBuffer;
+		ComPtr<ID3D11Buffer> m_PerObjCBuffer;
+		ComPtr<ID3D11SamplerState> m_PointSampler;
+		ComPtr<ID3D11SamplerState> m_LinearSampler;
+		ComPtr<ID3D11BlendState> m_BlendState;
+		ComPtr<ID3D11RasterizerState> m_RasterState;
+		/// Number of glyphs written to the vertex buffer since it was last discarded.
+		std::uint32_t m_BufferedGlyphs;
+		bool m_AlphaTexture;
+		bool m_DistanceField;
 	};
 }
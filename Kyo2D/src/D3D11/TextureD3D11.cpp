@@ -45,6 +45,156 @@ namespace Kyo2D
 		return InitializeImpl(idImage);
 	}
 
+	bool TextureD3D11::InitializeRenderTarget(std::int32_t width, std::int32_t height)
+	{
+		ReleaseResources();
+
+		m_Width = width;
+		m_Height = height;
+
+		// Setup texture description
+		D3D11_TEXTURE2D_DESC td;
+		ZeroMemory(&td, sizeof(td));
+		td.Width = m_Width;
+		td.Height = m_Height;
+		td.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		td.Usage = D3D11_USAGE_DEFAULT;
+		td.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+		td.CPUAccessFlags = 0;
+		td.MipLevels = 1;
+		td.ArraySize = 1;
+		td.SampleDesc.Count = 1;
+		td.SampleDesc.Quality = 0;
+
+		// Create texture without initial data
+		HRESULT hr = g_Context->D3DDevice11->CreateTexture2D(&td, nullptr, m_Texture.GetAddressOf());
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		// Create shader resource view
+		D3D11_SHADER_RESOURCE_VIEW_DESC svd;
+		ZeroMemory(&svd, sizeof(svd));
+		svd.Format = td.Format;
+		svd.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+		svd.Texture2D.MipLevels = -1;
+		hr = g_Context->D3DDevice11->CreateShaderResourceView(m_Texture.Get(), &svd, m_ShaderResView.GetAddressOf());
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	bool TextureD3D11::InitializePixels(std::int32_t width, std::int32_t height, const std::uint32_t *pixels)
+	{
+		SetAlphaOnly(false);
+		return CreateTexture(DXGI_FORMAT_R8G8B8A8_UNORM, 4, width, height, pixels);
+	}
+
+	bool TextureD3D11::UpdateRegion(std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const std::uint32_t *pixels)
+	{
+		if (IsAlphaOnly())
+		{
+			return false;
+		}
+
+		return UpdateTexture(4, x, y, width, height, pixels);
+	}
+
+	bool TextureD3D11::InitializeAlpha(std::int32_t width, std::int32_t height, const std::uint8_t *alpha)
+	{
+		// There's no alpha-only format in D3D11 that can be sampled on all feature levels,
+		// the alpha is kept in the red channel and the alpha sprite shader reads it from there.
+		SetAlphaOnly(true);
+		return CreateTexture(DXGI_FORMAT_R8_UNORM, 1, width, height, alpha);
+	}
+
+	bool TextureD3D11::UpdateAlphaRegion(std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const std::uint8_t *alpha)
+	{
+		if (!IsAlphaOnly())
+		{
+			return false;
+		}
+
+		return UpdateTexture(1, x, y, width, height, alpha);
+	}
+
+	bool TextureD3D11::CreateTexture(DXGI_FORMAT format, UINT pixelSize, std::int32_t width, std::int32_t height, const void *data)
+	{
+		ReleaseResources();
+
+		m_Width = width;
+		m_Height = height;
+
+		// Setup texture description
+		D3D11_TEXTURE2D_DESC td;
+		ZeroMemory(&td, sizeof(td));
+		td.Width = m_Width;
+		td.Height = m_Height;
+		td.Format = format;
+		td.Usage = D3D11_USAGE_DEFAULT;
+		td.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		td.CPUAccessFlags = 0;
+		td.MipLevels = 1;
+		td.ArraySize = 1;
+		td.SampleDesc.Count = 1;
+		td.SampleDesc.Quality = 0;
+
+		// Upload the data with the creation, start with zeros (transparent) if there is none
+		std::vector<std::uint8_t> transparent;
+		if (!data)
+		{
+			transparent.resize(static_cast<size_t>(m_Width) * static_cast<size_t>(m_Height) * pixelSize, 0);
+			data = transparent.data();
+		}
+
+		D3D11_SUBRESOURCE_DATA initialData;
+		memset(&initialData, 0, sizeof(D3D11_SUBRESOURCE_DATA));
+		initialData.pSysMem = data;
+		initialData.SysMemPitch = pixelSize * m_Width;
+
+		HRESULT hr = g_Context->D3DDevice11->CreateTexture2D(&td, &initialData, m_Texture.GetAddressOf());
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		// Create shader resource view
+		D3D11_SHADER_RESOURCE_VIEW_DESC svd;
+		ZeroMemory(&svd, sizeof(svd));
+		svd.Format = td.Format;
+		svd.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+		svd.Texture2D.MipLevels = -1;
+		hr = g_Context->D3DDevice11->CreateShaderResourceView(m_Texture.Get(), &svd, m_ShaderResView.GetAddressOf());
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	bool TextureD3D11::UpdateTexture(UINT pixelSize, std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const void *data)
+	{
+		if (!m_Texture || !data || !IsValidRegion(x, y, width, height))
+		{
+			return false;
+		}
+
+		D3D11_BOX box;
+		box.left = x;
+		box.top = y;
+		box.front = 0;
+		box.right = x + width;
+		box.bottom = y + height;
+		box.back = 1;
+		g_Context->D3DDeviceContext11->UpdateSubresource(m_Texture.Get(), 0, &box, data, pixelSize * width, 0);
+		return true;
+	}
+
 	bool TextureD3D11::Set()
 	{
 		if (!m_ShaderResView)
@@ -52,10 +202,16 @@ namespace Kyo2D
 			return false;
 		}
 
-		g_D3DDeviceContext11->PSSetShaderResources(0, 1, m_ShaderResView.GetAddressOf());
+		g_Context->D3DDeviceContext11->PSSetShaderResources(0, 1, m_ShaderResView.GetAddressOf());
 		return true;
 	}
 
+	void TextureD3D11::ReleaseResources()
+	{
+		m_ShaderResView.Reset();
+		m_Texture.Reset();
+	}
+
 	bool TextureD3D11::InitializeImpl(ILuint &idImage)
 	{
 		// Save image informations
@@ -66,6 +222,9 @@ namespace Kyo2D
 		ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE);
 		unsigned char * pData = ilGetData();
 
+		// Premultiply alpha and bake the colorkey if requested
+		ApplyLoadOptions(pData, m_Width, m_Height);
+
 		// Setup texture description
 		D3D11_TEXTURE2D_DESC td;
 		ZeroMemory(&td, sizeof(td));
@@ -88,7 +247,7 @@ namespace Kyo2D
 		data.SysMemPitch = 4 * m_Width;
 
 		// Create texture
-		HRESULT hr = g_D3DDevice11->CreateTexture2D(&td, &data, m_Texture.GetAddressOf());
+		HRESULT hr = g_Context->D3DDevice11->CreateTexture2D(&td, &data, m_Texture.GetAddressOf());
 		if (FAILED(hr))
 		{
 			// Could not load texture
@@ -105,7 +264,7 @@ namespace Kyo2D
 		svd.Format = td.Format;
 		svd.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
 		svd.Texture2D.MipLevels = -1;
-		hr = g_D3DDevice11->CreateShaderResourceView(m_Texture.Get(), &svd, m_ShaderResView.GetAddressOf());
+		hr = g_Context->D3DDevice11->CreateShaderResourceView(m_Texture.Get(), &svd, m_ShaderResView.GetAddressOf());
 		if (FAILED(hr))
 		{
 			return false;
@@ -7,11 +7,9 @@
 #include <comptr.h>
 #include "../Texture.h"
 #include "IL/il.h"
+#include "../EngineContext.h"
 using namespace Microsoft::WRL;
 
-extern ComPtr<ID3D11Device> g_D3DDevice11;
-extern ComPtr<ID3D11DeviceContext> g_D3DDeviceContext11;
-
 namespace Kyo2D
 {
 	class TextureD3D11 : public Texture
@@ -27,6 +25,16 @@ namespace Kyo2D
 		virtual bool Initialize(const void *data, size_t dataSize) override;
 		/// @copydoc Texture::Initialize(const std::wstring &)
 		virtual bool Initialize(const std::wstring &filename) override;
+		/// @copydoc Texture::InitializeRenderTarget(std::int32_t, std::int32_t)
+		virtual bool InitializeRenderTarget(std::int32_t width, std::int32_t height) override;
+		/// @copydoc Texture::InitializePixels(std::int32_t, std::int32_t, const std::uint32_t *)
+		virtual bool InitializePixels(std::int32_t width, std::int32_t height, const std::uint32_t *pixels) override;
+		/// @copydoc Texture::UpdateRegion(std::int32_t, std::int32_t, std::int32_t, std::int32_t, const std::uint32_t *)
+		virtual bool UpdateRegion(std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const std::uint32_t *pixels) override;
+		/// @copydoc Texture::InitializeAlpha(std::int32_t, std::int32_t, const std::uint8_t *)
+		virtual bool InitializeAlpha(std::int32_t width, std::int32_t height, const std::uint8_t *alpha) override;
+		/// @copydoc Texture::UpdateAlphaRegion(std::int32_t, std::int32_t, std::int32_t, std::int32_t, const std::uint8_t *)
+		virtual bool UpdateAlphaRegion(std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const std::uint8_t *alpha) override;
 		/// @copydoc Texture::Set()
 		virtual bool Set() override;
 
@@ -34,10 +42,24 @@ namespace Kyo2D
 		virtual std::int32_t GetWidth() const override { return m_Width; }
 		/// @copydoc Texture::GetHeight()
 		virtual std::int32_t GetHeight() const override { return m_Height; }
+		/// @copydoc Texture::IsResident()
+		virtual bool IsResident() const override { return m_ShaderResView.Get() != nullptr; }
+
+		/// Gets the underlying texture resource.
+		inline ID3D11Texture2D *GetResource() const { return m_Texture.Get(); }
+
+	protected:
+
+		/// @copydoc Texture::ReleaseResources()
+		virtual void ReleaseResources() override;
 
 	private:
 
 		bool InitializeImpl(ILuint &idImage);
+		/// Creates a shader resource texture of the given format from tightly packed data (nullptr for zeros).
+		bool CreateTexture(DXGI_FORMAT format, UINT pixelSize, std::int32_t width, std::int32_t height, const void *data);
+		/// Uploads tightly packed data to a region of the texture.
+		bool UpdateTexture(UINT pixelSize, std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const void *data);
 
 	private:
 
@@ -18,21 +18,21 @@ namespace Kyo2D
 	bool DrawHelperD3D9::Initialize()
 	{
 		// Create the vertex shader
-		HRESULT hr = g_D3DDevice9->CreateVertexShader((const DWORD*)g_draw2D9MainVS, m_VertShader2D.GetAddressOf());
+		HRESULT hr = g_Context->D3DDevice9->CreateVertexShader((const DWORD*)g_draw2D9MainVS, m_VertShader2D.GetAddressOf());
 		if (FAILED(hr))
 		{
 			return false;
 		}
 
 		// Create the pixel shader
-		hr = g_D3DDevice9->CreatePixelShader((const DWORD*)g_draw2D9MainPS, m_PixShader2D.GetAddressOf());
+		hr = g_Context->D3DDevice9->CreatePixelShader((const DWORD*)g_draw2D9MainPS, m_PixShader2D.GetAddressOf());
 		if (FAILED(hr))
 		{
 			return false;
 		}
 
 		// Create vertex buffer
-		hr = g_D3DDevice9->CreateVertexBuffer(
+		hr = g_Context->D3DDevice9->CreateVertexBuffer(
 			sizeof(Vertex2D) * 5, 
 			D3DUSAGE_WRITEONLY, 
 			D3DFVF_XYZ | D3DFVF_DIFFUSE, 
@@ -51,7 +51,7 @@ namespace Kyo2D
 			{ 0, 12, D3DDECLTYPE_D3DCOLOR, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_COLOR,    0 },
 			D3DDECL_END()
 		};
-		g_D3DDevice9->CreateVertexDeclaration(declaration, m_VertexDecl.GetAddressOf());
+		g_Context->D3DDevice9->CreateVertexDeclaration(declaration, m_VertexDecl.GetAddressOf());
 
 		// Initialize view matrix
 		m_ViewMatrix = XMMatrixIdentity();
@@ -61,21 +61,24 @@ namespace Kyo2D
 	void DrawHelperD3D9::Prepare()
 	{
 		// Setup shaders
-		g_D3DDevice9->SetVertexShader(m_VertShader2D.Get());
-		g_D3DDevice9->SetPixelShader(m_PixShader2D.Get());
+		g_Context->D3DDevice9->SetVertexShader(m_VertShader2D.Get());
+		g_Context->D3DDevice9->SetPixelShader(m_PixShader2D.Get());
+
+		// The sprite drawer may have switched to premultiplied blending
+		g_Context->D3DDevice9->SetRenderState(D3DRS_SRCBLEND, D3DBLEND_SRCALPHA);
 
 		XMFLOAT4X4 d3dmatrix;
 		XMStoreFloat4x4(&d3dmatrix, m_ViewMatrix);
-		HRESULT hr = g_D3DDevice9->SetTransform(D3DTS_WORLD, (D3DMATRIX*)&d3dmatrix);
+		HRESULT hr = g_Context->D3DDevice9->SetTransform(D3DTS_WORLD, (D3DMATRIX*)&d3dmatrix);
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"SetTransform failed", L"Error", MB_ICONERROR | MB_OK);
 			return;
 		}
 
-		g_D3DDevice9->SetVertexDeclaration(m_VertexDecl.Get());
-		g_D3DDevice9->SetVertexShaderConstantF(0, (const float*)&m_ViewMatrix.r[0], 4);
-		hr = g_D3DDevice9->SetFVF(D3DFVF_XYZ | D3DFVF_DIFFUSE);
+		g_Context->D3DDevice9->SetVertexDeclaration(m_VertexDecl.Get());
+		g_Context->D3DDevice9->SetVertexShaderConstantF(0, (const float*)&m_ViewMatrix.r[0], 4);
+		hr = g_Context->D3DDevice9->SetFVF(D3DFVF_XYZ | D3DFVF_DIFFUSE);
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"SetFVF failed", L"Error", MB_ICONERROR | MB_OK);
@@ -83,7 +86,7 @@ namespace Kyo2D
 		}
 
 		// Setup vertex buffer
-		hr = g_D3DDevice9->SetStreamSource(0, m_2DGeomBuffer.Get(), 0, sizeof(Vertex2D));
+		hr = g_Context->D3DDevice9->SetStreamSource(0, m_2DGeomBuffer.Get(), 0, sizeof(Vertex2D));
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"SetStreamSource failed", L"Error", MB_ICONERROR | MB_OK);
@@ -106,6 +109,7 @@ namespace Kyo2D
 	void DrawHelperD3D9::DrawPoint(float X, float Y, std::int32_t Color)
 	{
 		Vertex2D *Vertices;
+		g_Context->Stats.BufferMaps++;
 		HRESULT hr = m_2DGeomBuffer->Lock(0, 0, (void**)&Vertices, D3DLOCK_DISCARD);
 		if (FAILED(hr))
 		{
@@ -128,6 +132,7 @@ namespace Kyo2D
 	void DrawHelperD3D9::DrawLine(float X1, float Y1, float X2, float Y2, std::int32_t Color)
 	{
 		Vertex2D *Vertices;
+		g_Context->Stats.BufferMaps++;
 		HRESULT hr = m_2DGeomBuffer->Lock(0, 0, (void**)&Vertices, D3DLOCK_DISCARD);
 		if (FAILED(hr))
 		{
@@ -152,6 +157,7 @@ namespace Kyo2D
 	void DrawHelperD3D9::DrawRect(float X, float Y, float W, float H, std::int32_t Color)
 	{
 		Vertex2D *Vertices;
+		g_Context->Stats.BufferMaps++;
 		HRESULT hr = m_2DGeomBuffer->Lock(0, 0, (void**)&Vertices, D3DLOCK_DISCARD);
 		if (FAILED(hr))
 		{
@@ -179,6 +185,7 @@ namespace Kyo2D
 	void DrawHelperD3D9::FillRect(float X, float Y, float W, float H, std::int32_t Color)
 	{
 		Vertex2D *Vertices;
+		g_Context->Stats.BufferMaps++;
 		HRESULT hr = m_2DGeomBuffer->Lock(0, 0, (void**)&Vertices, D3DLOCK_DISCARD);
 		if (FAILED(hr))
 		{
@@ -202,17 +209,26 @@ namespace Kyo2D
 		Dispatch(D3DPT_TRIANGLESTRIP, 2);
 	}
 
-	void DrawHelperD3D9::UpdateViewMatrix(const XMMATRIX & ViewMatrix)
+	void DrawHelperD3D9::UpdateViewMatrix(const Matrix4 & ViewMatrix)
 	{
-		m_ViewMatrix = ViewMatrix;
+		m_ViewMatrix = XMLoadFloat4x4(reinterpret_cast<const XMFLOAT4X4*>(ViewMatrix.m));
 	}
 
 	void DrawHelperD3D9::Dispatch(D3DPRIMITIVETYPE Topology, UINT Count)
 	{
-		HRESULT hr = g_D3DDevice9->DrawPrimitive(Topology, 0, Count);
+		HRESULT hr = g_Context->D3DDevice9->DrawPrimitive(Topology, 0, Count);
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"DrawPrimitive failed", L"Error", MB_ICONERROR | MB_OK);
 		}
+
+		// Count is the number of primitives here
+		g_Context->Stats.DrawCalls++;
+		switch (Topology)
+		{
+			case D3DPT_LINESTRIP: g_Context->Stats.Vertices += Count + 1; break;
+			case D3DPT_TRIANGLESTRIP: g_Context->Stats.Vertices += Count + 2; break;
+			default: g_Context->Stats.Vertices += Count; break;
+		}
 	}
 }
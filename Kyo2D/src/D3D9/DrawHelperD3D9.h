@@ -5,10 +5,10 @@
 #include <Windows.h>
 #include <comptr.h>
 #include <d3d9.h>
+#include <DirectXMath.h>
+#include "../EngineContext.h"
 using namespace Microsoft::WRL;
-
-extern ComPtr<IDirect3D9> g_D3D9;
-extern ComPtr<IDirect3DDevice9> g_D3DDevice9;
+using namespace DirectX;
 
 namespace Kyo2D
 {
@@ -34,7 +34,7 @@ namespace Kyo2D
 		/// @copydoc DrawHelper::FillRect()
 		virtual void FillRect(float X, float Y, float W, float H, std::int32_t Color = -1) override;
 		/// @copydoc DrawHelper::UpdateViewMatrix()
-		virtual void UpdateViewMatrix(const XMMATRIX &ViewMatrix) override;
+		virtual void UpdateViewMatrix(const Matrix4 &ViewMatrix) override;
 
 	private:
 
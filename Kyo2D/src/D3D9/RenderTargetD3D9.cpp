@@ -1,5 +1,7 @@
 
 #include "RenderTargetD3D9.h"
+#include <vector>
+#include <algorithm>
 
 namespace Kyo2D
 {
@@ -37,21 +39,48 @@ namespace Kyo2D
 		}
 
 		// Create view matrix
-		m_ViewMatrix = XMMatrixOrthographicOffCenterLH(0.0f, m_Width, m_Height, 0.0f, 0.0f, 1.0f);
+		m_ViewMatrix = Matrix4::OrthographicOffCenterLH(0.0f, m_Width, m_Height, 0.0f, 0.0f, 1.0f);
+
+		return true;
+	}
+
+	bool RenderTargetD3D9::InitializeOffscreen(std::uint16_t width, std::uint16_t height)
+	{
+		m_Width = width;
+		m_Height = height;
+
+		// Create the texture we render into
+		m_Texture = std::make_shared<TextureD3D9>();
+		if (!m_Texture->InitializeRenderTarget(width, height))
+		{
+			MessageBox(nullptr, L"Could not create offscreen texture!", L"Error", MB_ICONERROR | MB_OK);
+			return false;
+		}
+
+		// Render into the top level surface of the texture
+		HRESULT hr = m_Texture->GetResource()->GetSurfaceLevel(0, m_BackBuffer.GetAddressOf());
+		if (FAILED(hr))
+		{
+			MessageBox(nullptr, L"Could not get offscreen surface!", L"Error", MB_ICONERROR | MB_OK);
+			return false;
+		}
+
+		// Create view matrix
+		m_ViewMatrix = Matrix4::OrthographicOffCenterLH(0.0f, m_Width, m_Height, 0.0f, 0.0f, 1.0f);
 
 		return true;
 	}
 
 	void RenderTargetD3D9::Set()
 	{
-		if (!m_SwapChain)
+		if (!m_BackBuffer)
 		{
-			MessageBox(nullptr, L"Swap chain not initialized", L"Error", MB_ICONERROR | MB_OK);
+			MessageBox(nullptr, L"Render target not initialized", L"Error", MB_ICONERROR | MB_OK);
 			return;
 		}
 
 		// Set active render target
-		HRESULT hr = g_D3DDevice9->SetRenderTarget(0, m_BackBuffer.Get());
+		HRESULT hr = g_Context->D3DDevice9->SetRenderTarget(0, m_BackBuffer.Get());
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Coult not set render target", L"Error", MB_ICONERROR | MB_OK);
@@ -64,7 +93,7 @@ namespace Kyo2D
 		vp.Height = m_Height;
 		vp.MinZ = -1.0f;
 		vp.MaxZ = 1.0f;
-		hr = g_D3DDevice9->SetViewport(&vp);
+		hr = g_Context->D3DDevice9->SetViewport(&vp);
 		if (FAILED(hr))
 		{
 			MessageBox(nullptr, L"Coult not set viewport", L"Error", MB_ICONERROR | MB_OK);
@@ -73,56 +102,113 @@ namespace Kyo2D
 
 	void RenderTargetD3D9::Clear(float R, float G, float B)
 	{
-		if (!m_SwapChain)
+		if (!m_BackBuffer)
 		{
 			return;
 		}
 
-		if (m_PendingUpdate)
-		{
-			m_PendingUpdate = false;
-			if (!RecreateSwapChain())
-			{
-				MessageBox(m_Handle, L"Could not re-create swap chain!", L"Error", MB_ICONERROR | MB_OK);
-				return;
-			}
-
-			Set();
-		}
+		BeginFrame();
 
 		const D3DCOLOR ClearColor = D3DCOLOR_XRGB(
 			static_cast<DWORD>(R * 255.0f), 
 			static_cast<DWORD>(G * 255.0f), 
 			static_cast<DWORD>(B * 255.0f));
-		HRESULT hr = g_D3DDevice9->Clear(0, nullptr, D3DCLEAR_TARGET, ClearColor, 1.0f, 0);
+		HRESULT hr = g_Context->D3DDevice9->Clear(0, nullptr, D3DCLEAR_TARGET, ClearColor, 1.0f, 0);
 		if (FAILED(hr))
 		{
 			MessageBox(m_Handle, L"Clear failed", L"Error", MB_ICONERROR | MB_OK);
 		}
-		hr = g_D3DDevice9->BeginScene();
-		if (FAILED(hr))
+	}
+
+	void RenderTargetD3D9::Present()
+	{
+		PresentRegion(nullptr);
+	}
+
+	void RenderTargetD3D9::SetScissorRect(const DamageRect *rect)
+	{
+		if (rect)
+		{
+			RECT scissor;
+			scissor.left = rect->Left;
+			scissor.top = rect->Top;
+			scissor.right = rect->Right;
+			scissor.bottom = rect->Bottom;
+			g_Context->D3DDevice9->SetScissorRect(&scissor);
+			g_Context->D3DDevice9->SetRenderState(D3DRS_SCISSORTESTENABLE, TRUE);
+		}
+		else
 		{
-			MessageBox(m_Handle, L"BeginScene failed", L"Error", MB_ICONERROR | MB_OK);
+			g_Context->D3DDevice9->SetRenderState(D3DRS_SCISSORTESTENABLE, FALSE);
 		}
 	}
 
-	void RenderTargetD3D9::Present()
+	bool RenderTargetD3D9::ClearRect(const DamageRect &rect, float R, float G, float B)
 	{
-		if (!m_SwapChain)
+		if (!m_BackBuffer)
 		{
-			return;
+			return false;
 		}
 
-		HRESULT hr = g_D3DDevice9->EndScene();
-		if (FAILED(hr))
+		// A recreated swap chain lost the old back buffer contents
+		if (!BeginFrame())
 		{
-			MessageBox(m_Handle, L"EndScene failed", L"Error", MB_ICONERROR | MB_OK);
+			return false;
 		}
-		hr = m_SwapChain->Present(nullptr, nullptr, nullptr, nullptr, 0);
-		if (FAILED(hr))
+
+		D3DRECT clearRect;
+		clearRect.x1 = rect.Left;
+		clearRect.y1 = rect.Top;
+		clearRect.x2 = rect.Right;
+		clearRect.y2 = rect.Bottom;
+
+		const D3DCOLOR ClearColor = D3DCOLOR_XRGB(
+			static_cast<DWORD>(R * 255.0f), 
+			static_cast<DWORD>(G * 255.0f), 
+			static_cast<DWORD>(B * 255.0f));
+		HRESULT hr = g_Context->D3DDevice9->Clear(1, &clearRect, D3DCLEAR_TARGET, ClearColor, 1.0f, 0);
+		return SUCCEEDED(hr);
+	}
+
+	void RenderTargetD3D9::PresentRects(const DamageRect *rects, size_t count)
+	{
+		if (!rects || count == 0)
 		{
-			MessageBox(m_Handle, L"Present failed", L"Error", MB_ICONERROR | MB_OK);
+			PresentRegion(nullptr);
+			return;
+		}
+
+		// Build the dirty region, the copy swap effect only presents these rectangles
+		std::vector<std::uint8_t> buffer(sizeof(RGNDATAHEADER) + count * sizeof(RECT));
+		RGNDATA *region = reinterpret_cast<RGNDATA*>(buffer.data());
+		region->rdh.dwSize = sizeof(RGNDATAHEADER);
+		region->rdh.iType = RDH_RECTANGLES;
+		region->rdh.nCount = static_cast<DWORD>(count);
+		region->rdh.nRgnSize = static_cast<DWORD>(count * sizeof(RECT));
+
+		RECT *regionRects = reinterpret_cast<RECT*>(region->Buffer);
+		RECT &bounds = region->rdh.rcBound;
+		for (size_t i = 0; i < count; ++i)
+		{
+			regionRects[i].left = rects[i].Left;
+			regionRects[i].top = rects[i].Top;
+			regionRects[i].right = rects[i].Right;
+			regionRects[i].bottom = rects[i].Bottom;
+
+			if (i == 0)
+			{
+				bounds = regionRects[i];
+			}
+			else
+			{
+				bounds.left = std::min<LONG>(bounds.left, regionRects[i].left);
+				bounds.top = std::min<LONG>(bounds.top, regionRects[i].top);
+				bounds.right = std::max<LONG>(bounds.right, regionRects[i].right);
+				bounds.bottom = std::max<LONG>(bounds.bottom, regionRects[i].bottom);
+			}
 		}
+
+		PresentRegion(region);
 	}
 
 	void RenderTargetD3D9::SetFullscreenState(bool Fullscreen)
@@ -162,11 +248,65 @@ namespace Kyo2D
 		m_PendingUpdate = true;
 
 		// Create view matrix
-		m_ViewMatrix = XMMatrixOrthographicOffCenterLH(0.0f, m_Width, m_Height, 0.0f, -1.0f, 1.0f);
+		m_ViewMatrix = Matrix4::OrthographicOffCenterLH(0.0f, m_Width, m_Height, 0.0f, -1.0f, 1.0f);
 
 		// Everything done!
 		return true;
 	}
+
+	bool RenderTargetD3D9::BeginFrame()
+	{
+		bool preserved = true;
+		if (m_SwapChain && m_PendingUpdate)
+		{
+			m_PendingUpdate = false;
+			preserved = false;
+			if (!RecreateSwapChain())
+			{
+				MessageBox(m_Handle, L"Could not re-create swap chain!", L"Error", MB_ICONERROR | MB_OK);
+				return false;
+			}
+
+			Set();
+		}
+
+		if (!g_Context->D3D9SceneActive)
+		{
+			HRESULT hr = g_Context->D3DDevice9->BeginScene();
+			if (FAILED(hr))
+			{
+				MessageBox(m_Handle, L"BeginScene failed", L"Error", MB_ICONERROR | MB_OK);
+			}
+			g_Context->D3D9SceneActive = SUCCEEDED(hr);
+		}
+
+		return preserved;
+	}
+
+	void RenderTargetD3D9::PresentRegion(const RGNDATA *region)
+	{
+		if (!m_SwapChain)
+		{
+			return;
+		}
+
+		HRESULT hr = D3D_OK;
+		if (g_Context->D3D9SceneActive)
+		{
+			g_Context->D3D9SceneActive = false;
+			hr = g_Context->D3DDevice9->EndScene();
+			if (FAILED(hr))
+			{
+				MessageBox(m_Handle, L"EndScene failed", L"Error", MB_ICONERROR | MB_OK);
+			}
+		}
+		hr = m_SwapChain->Present(nullptr, nullptr, nullptr, region, 0);
+		if (FAILED(hr))
+		{
+			MessageBox(m_Handle, L"Present failed", L"Error", MB_ICONERROR | MB_OK);
+		}
+	}
+
 	bool RenderTargetD3D9::RecreateSwapChain()
 	{
 		m_BackBuffer.Reset();
@@ -183,7 +323,7 @@ namespace Kyo2D
 		d3dpp.BackBufferFormat = D3DFMT_X8R8G8B8;
 		d3dpp.PresentationInterval = (m_VSync ? D3DPRESENT_INTERVAL_ONE : D3DPRESENT_INTERVAL_IMMEDIATE);
 
-		HRESULT hr = g_D3DDevice9->CreateAdditionalSwapChain(&d3dpp, m_SwapChain.GetAddressOf());
+		HRESULT hr = g_Context->D3DDevice9->CreateAdditionalSwapChain(&d3dpp, m_SwapChain.GetAddressOf());
 		if (FAILED(hr))
 		{
 			return false;
@@ -2,17 +2,16 @@
 #pragma once
 
 #include "../RenderTarget.h"
+#include "TextureD3D9.h"
 #include <Windows.h>
 #include <comptr.h>
 #include <d3d9.h>
 #include <DirectXMath.h>
 #include <memory>
+#include "../EngineContext.h"
 using namespace Microsoft::WRL;
 using namespace DirectX;
 
-extern ComPtr<IDirect3D9> g_D3D9;
-extern ComPtr<IDirect3DDevice9> g_D3DDevice9;
-
 namespace Kyo2D
 {
 	/// Direct3D9 implementation of a render target.
@@ -27,6 +26,8 @@ namespace Kyo2D
 
 		/// @copydoc RenderTarget::Initialize(HWND, std::uint16_t, std::uint16_t, bool)
 		virtual bool Initialize(HWND hwnd, std::uint16_t width, std::uint16_t height, bool fullscreen) override;
+		/// @copydoc RenderTarget::InitializeOffscreen(std::uint16_t, std::uint16_t)
+		virtual bool InitializeOffscreen(std::uint16_t width, std::uint16_t height) override;
 		/// @copydoc RenderTarget::Set()
 		virtual void Set() override;
 		/// @copydoc RenderTarget::Clear(float, float, float)
@@ -39,9 +40,15 @@ namespace Kyo2D
 		virtual void SetVSyncEnabled(bool Enable) override;
 		/// @copydoc RenderTarget::Resize(std::uint16_t, std::uint16_t)
 		virtual bool Resize(std::uint16_t Width, std::uint16_t Height) override;
+		/// @copydoc RenderTarget::SetScissorRect(const DamageRect *)
+		virtual void SetScissorRect(const DamageRect *rect) override;
+		/// @copydoc RenderTarget::ClearRect(const DamageRect &, float, float, float)
+		virtual bool ClearRect(const DamageRect &rect, float R, float G, float B) override;
+		/// @copydoc RenderTarget::PresentRects(const DamageRect *, size_t)
+		virtual void PresentRects(const DamageRect *rects, size_t count) override;
 
 		/// Determines if the render target has successfully been initialized.
-		virtual bool IsInitialized() const override { return m_SwapChain; }
+		virtual bool IsInitialized() const override { return m_BackBuffer; }
 		/// Gets the render targets window handle.
 		virtual HWND GetHandle() const override { return m_Handle; }
 		/// Gets the render targets width in pixels.
@@ -53,11 +60,17 @@ namespace Kyo2D
 		/// Determines if the vertical sync option is enabled.
 		virtual bool IsVSyncEnabled() const override { return m_VSync; }
 		/// Gets this render targets view matrix.
-		virtual const XMMATRIX &GetViewMatrix() const override { return m_ViewMatrix; }
+		virtual const Matrix4 &GetViewMatrix() const override { return m_ViewMatrix; }
+		/// @copydoc RenderTarget::GetTexture()
+		virtual std::shared_ptr<Texture> GetTexture() const override { return m_Texture; }
 
 	private:
 
 		bool RecreateSwapChain();
+		/// Recreates the swap chain if needed and begins the scene.
+		bool BeginFrame();
+		/// Ends the scene and presents the given region of the back buffer (nullptr for all of it).
+		void PresentRegion(const RGNDATA *region);
 
 	private:
 
@@ -67,7 +80,8 @@ namespace Kyo2D
 		bool m_VSync;
 		ComPtr<IDirect3DSwapChain9> m_SwapChain;
 		ComPtr<IDirect3DSurface9> m_BackBuffer;
-		XMMATRIX m_ViewMatrix;
+		Matrix4 m_ViewMatrix;
 		bool m_PendingUpdate;
+		std::shared_ptr<TextureD3D9> m_Texture;
 	};
 }
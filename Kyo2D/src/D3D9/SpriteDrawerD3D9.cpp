@@ -3,11 +3,17 @@
 #include "Kyo2D.h"
 #include "shaders/d3d9/Sprite9_VS.h"
 #include "shaders/d3d9/Sprite9_PS.h"
+#include "shaders/d3d9/SpritePremul9_PS.h"
+#include "shaders/d3d9/SpriteAlpha9_PS.h"
+#include "shaders/d3d9/SpriteDistanceField9_PS.h"
 #include <algorithm>
 
 namespace Kyo2D
 {
 	SpriteDrawerD3D9::SpriteDrawerD3D9()
+		: m_PremultipliedAlpha(false)
+		, m_AlphaTexture(false)
+		, m_DistanceField(false)
 	{
 	}
 
@@ -18,21 +24,42 @@ namespace Kyo2D
 	bool SpriteDrawerD3D9::Initialize()
 	{
 		// Create the vertex shader
-		HRESULT hr = g_D3DDevice9->CreateVertexShader((const DWORD*)g_sprite9MainVS, m_VertShader.GetAddressOf());
+		HRESULT hr = g_Context->D3DDevice9->CreateVertexShader((const DWORD*)g_sprite9MainVS, m_VertShader.GetAddressOf());
 		if (FAILED(hr))
 		{
 			return false;
 		}
 
 		// Create the pixel shader
-		hr = g_D3DDevice9->CreatePixelShader((const DWORD*)g_sprite9MainPS, m_PixShader.GetAddressOf());
+		hr = g_Context->D3DDevice9->CreatePixelShader((const DWORD*)g_sprite9MainPS, m_PixShader.GetAddressOf());
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		// Create the pixel shader for premultiplied textures
+		hr = g_Context->D3DDevice9->CreatePixelShader((const DWORD*)g_spritePremul9MainPS, m_PixShaderPremul.GetAddressOf());
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		// Create the pixel shader for alpha-only textures
+		hr = g_Context->D3DDevice9->CreatePixelShader((const DWORD*)g_spriteAlpha9MainPS, m_PixShaderAlpha.GetAddressOf());
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		// Create the pixel shader for distance field textures
+		hr = g_Context->D3DDevice9->CreatePixelShader((const DWORD*)g_spriteDistanceField9MainPS, m_PixShaderDistanceField.GetAddressOf());
 		if (FAILED(hr))
 		{
 			return false;
 		}
 
 		// Create vertex buffer
-		hr = g_D3DDevice9->CreateVertexBuffer(
+		hr = g_Context->D3DDevice9->CreateVertexBuffer(
 			sizeof(SpriteVertex2D) * 4,
 			D3DUSAGE_WRITEONLY,
 			D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX0 | D3DFVF_TEX1,
@@ -53,7 +80,7 @@ namespace Kyo2D
 			{ 0, 24, D3DDECLTYPE_FLOAT4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD,    1 },
 			D3DDECL_END()
 		};
-		hr = g_D3DDevice9->CreateVertexDeclaration(declaration, m_VertexDecl.GetAddressOf());
+		hr = g_Context->D3DDevice9->CreateVertexDeclaration(declaration, m_VertexDecl.GetAddressOf());
 		if (FAILED(hr))
 		{
 			return false;
@@ -68,25 +95,45 @@ namespace Kyo2D
 	bool SpriteDrawerD3D9::Prepare()
 	{
 		// Setup shaders
-		g_D3DDevice9->SetVertexShader(m_VertShader.Get());
-		g_D3DDevice9->SetPixelShader(m_PixShader.Get());
+		g_Context->D3DDevice9->SetVertexShader(m_VertShader.Get());
+		if (m_DistanceField)
+		{
+			g_Context->D3DDevice9->SetPixelShader(m_PixShaderDistanceField.Get());
+		}
+		else if (m_AlphaTexture)
+		{
+			g_Context->D3DDevice9->SetPixelShader(m_PixShaderAlpha.Get());
+		}
+		else
+		{
+			g_Context->D3DDevice9->SetPixelShader(m_PremultipliedAlpha ? m_PixShaderPremul.Get() : m_PixShader.Get());
+		}
+
+		// Distance fields need filtering, everything else keeps its pixels sharp
+		const D3DTEXTUREFILTERTYPE filter = m_DistanceField ? D3DTEXF_LINEAR : D3DTEXF_POINT;
+		g_Context->D3DDevice9->SetSamplerState(0, D3DSAMP_MINFILTER, filter);
+		g_Context->D3DDevice9->SetSamplerState(0, D3DSAMP_MAGFILTER, filter);
+
+		// Premultiplied textures already contain color * alpha
+		const bool premultiplied = m_PremultipliedAlpha && !m_AlphaTexture && !m_DistanceField;
+		g_Context->D3DDevice9->SetRenderState(D3DRS_SRCBLEND, premultiplied ? D3DBLEND_ONE : D3DBLEND_SRCALPHA);
 
 		XMFLOAT4X4 d3dmatrix;
 		XMStoreFloat4x4(&d3dmatrix, m_Matrices[0]);
-		HRESULT hr = g_D3DDevice9->SetTransform(D3DTS_PROJECTION, (D3DMATRIX*)&d3dmatrix);
+		HRESULT hr = g_Context->D3DDevice9->SetTransform(D3DTS_PROJECTION, (D3DMATRIX*)&d3dmatrix);
 		if (FAILED(hr))
 		{
 			return false;
 		}
 
-		hr = g_D3DDevice9->SetFVF(D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX0 | D3DFVF_TEX1);
+		hr = g_Context->D3DDevice9->SetFVF(D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX0 | D3DFVF_TEX1);
 		if (FAILED(hr))
 		{
 			return false;
 		}
 
 		// Setup vertex buffer
-		hr = g_D3DDevice9->SetStreamSource(0, m_GeomBuffer.Get(), 0, sizeof(SpriteVertex2D));
+		hr = g_Context->D3DDevice9->SetStreamSource(0, m_GeomBuffer.Get(), 0, sizeof(SpriteVertex2D));
 		if (FAILED(hr))
 		{
 			return false;
@@ -95,9 +142,9 @@ namespace Kyo2D
 		return true;
 	}
 
-	void SpriteDrawerD3D9::SetViewMatrix(const XMMATRIX & ViewMatrix)
+	void SpriteDrawerD3D9::SetViewMatrix(const Matrix4 & ViewMatrix)
 	{
-		m_Matrices[0] = ViewMatrix;
+		m_Matrices[0] = XMLoadFloat4x4(reinterpret_cast<const XMFLOAT4X4*>(ViewMatrix.m));
 	}
 
 	void SpriteDrawerD3D9::SetScale2XEnabled(bool Enable)
@@ -105,6 +152,21 @@ namespace Kyo2D
 		// TODO
 	}
 
+	void SpriteDrawerD3D9::SetPremultipliedAlpha(bool Enable)
+	{
+		m_PremultipliedAlpha = Enable;
+	}
+
+	void SpriteDrawerD3D9::SetAlphaTexture(bool Enable)
+	{
+		m_AlphaTexture = Enable;
+	}
+
+	void SpriteDrawerD3D9::SetDistanceField(bool Enable)
+	{
+		m_DistanceField = Enable;
+	}
+
 	template<typename T>
 	inline T Color32Reverse(T x)
 	{
@@ -129,6 +191,7 @@ namespace Kyo2D
 	void SpriteDrawerD3D9::DrawSpriteAt(std::int32_t texW, std::int32_t texH, float X, float Y, float Z, float Rotation, std::uint32_t color, std::uint32_t colorkey)
 	{
 		SpriteVertex2D *Vertices;
+		g_Context->Stats.BufferMaps++;
 		HRESULT hr = m_GeomBuffer->Lock(0, 0, (void**)&Vertices, D3DLOCK_DISCARD);
 		if (FAILED(hr))
 		{
@@ -153,7 +216,9 @@ namespace Kyo2D
 		// Apply rotation
 		UpdateTransform(X + texW * 0.5f, Y + texH * 0.5f, Rotation);
 
-		g_D3DDevice9->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2);
+		g_Context->Stats.DrawCalls++;
+		g_Context->Stats.Vertices += 4;
+		g_Context->D3DDevice9->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2);
 	}
 
 	void SpriteDrawerD3D9::DrawSubspriteAt(std::int32_t texW, std::int32_t texH, float X, float Y, float Z, float srcX, float srcY, float srcW, float srcH, float Rotation, std::uint32_t color, std::uint32_t colorkey)
@@ -164,6 +229,7 @@ namespace Kyo2D
 		float dstV = srcV + (srcH / (float)texH);
 
 		SpriteVertex2D *Vertices;
+		g_Context->Stats.BufferMaps++;
 		HRESULT hr = m_GeomBuffer->Lock(0, 0, (void**)&Vertices, D3DLOCK_DISCARD);
 		if (FAILED(hr))
 		{
@@ -188,12 +254,15 @@ namespace Kyo2D
 		// Apply rotation
 		UpdateTransform(X + srcW * 0.5f, Y + srcH * 0.5f, Rotation);
 
-		g_D3DDevice9->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2);
+		g_Context->Stats.DrawCalls++;
+		g_Context->Stats.Vertices += 4;
+		g_Context->D3DDevice9->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2);
 	}
 
 	void SpriteDrawerD3D9::DrawSpriteScaled(std::int32_t texW, std::int32_t texH, float X, float Y, float Z, float W, float H, float Rotation, std::uint32_t color, std::uint32_t colorkey)
 	{
 		SpriteVertex2D *Vertices;
+		g_Context->Stats.BufferMaps++;
 		HRESULT hr = m_GeomBuffer->Lock(0, 0, (void**)&Vertices, D3DLOCK_DISCARD);
 		if (FAILED(hr))
 		{
@@ -218,7 +287,9 @@ namespace Kyo2D
 		// Apply rotation
 		UpdateTransform(X + std::max<float>(W * 0.5f, W * -0.5f), Y + std::max<float>(H * 0.5f, H * -0.5f), Rotation);
 
-		g_D3DDevice9->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2);
+		g_Context->Stats.DrawCalls++;
+		g_Context->Stats.Vertices += 4;
+		g_Context->D3DDevice9->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2);
 	}
 
 	void SpriteDrawerD3D9::DrawSubspriteScaled(std::int32_t texW, std::int32_t texH, float X, float Y, float Z, float W, float H, float srcX, float srcY, float srcW, float srcH, float Rotation, std::uint32_t color, std::uint32_t colorkey)
@@ -229,6 +300,7 @@ namespace Kyo2D
 		float dstV = srcV + (srcH / (float)texH);
 
 		SpriteVertex2D *Vertices;
+		g_Context->Stats.BufferMaps++;
 		HRESULT hr = m_GeomBuffer->Lock(0, 0, (void**)&Vertices, D3DLOCK_DISCARD);
 		if (FAILED(hr))
 		{
@@ -253,12 +325,15 @@ namespace Kyo2D
 		// Apply rotation
 		UpdateTransform(X + std::max<float>(W * 0.5f, W * -0.5f), Y + std::max<float>(H * 0.5f, H * -0.5f), Rotation);
 
-		g_D3DDevice9->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2);
+		g_Context->Stats.DrawCalls++;
+		g_Context->Stats.Vertices += 4;
+		g_Context->D3DDevice9->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2);
 	}
 
 	void SpriteDrawerD3D9::DrawSpriteTiled(std::int32_t texW, std::int32_t texH, float X, float Y, float Z, float W, float H, float tX, float tY, float Rotation, std::uint32_t color, std::uint32_t colorkey)
 	{
 		SpriteVertex2D *Vertices;
+		g_Context->Stats.BufferMaps++;
 		HRESULT hr = m_GeomBuffer->Lock(0, 0, (void**)&Vertices, D3DLOCK_DISCARD);
 		if (FAILED(hr))
 		{
@@ -283,7 +358,9 @@ namespace Kyo2D
 		// Apply rotation
 		UpdateTransform(X + W * 0.5f, Y + H * 0.5f, Rotation);
 
-		g_D3DDevice9->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2);
+		g_Context->Stats.DrawCalls++;
+		g_Context->Stats.Vertices += 4;
+		g_Context->D3DDevice9->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2);
 	}
 
 	void SpriteDrawerD3D9::UpdateTransform(float x, float y, float Rotation)
@@ -292,7 +369,7 @@ namespace Kyo2D
 			XMMatrixRotationZ(Rotation) *
 			XMMatrixTranslation(x, y, 0.0f);
 
-		g_D3DDevice9->SetVertexDeclaration(m_VertexDecl.Get());
-		g_D3DDevice9->SetVertexShaderConstantF(0, (const float*)&m_Matrices[0].r[0], 8);
+		g_Context->D3DDevice9->SetVertexDeclaration(m_VertexDecl.Get());
+		g_Context->D3DDevice9->SetVertexShaderConstantF(0, (const float*)&m_Matrices[0].r[0], 8);
 	}
 }
@@ -5,10 +5,10 @@
 #include <Windows.h>
 #include <comptr.h>
 #include <d3d9.h>
+#include <DirectXMath.h>
+#include "../EngineContext.h"
 using namespace Microsoft::WRL;
-
-extern ComPtr<IDirect3D9> g_D3D9;
-extern ComPtr<IDirect3DDevice9> g_D3DDevice9;
+using namespace DirectX;
 
 namespace Kyo2D
 {
@@ -26,15 +26,27 @@ namespace Kyo2D
 		virtual bool Initialize() override;
 		/// @copydoc SpriteDrawer::Prepare()
 		virtual bool Prepare() override;
-		/// @copydoc SpriteDrawer::SetViewMatrix(const XMMATRIX &)
-		virtual void SetViewMatrix(const XMMATRIX &ViewMatrix) override;
+		/// @copydoc SpriteDrawer::SetViewMatrix(const Matrix4 &)
+		virtual void SetViewMatrix(const Matrix4 &ViewMatrix) override;
 		/// @copydoc SpriteDrawer::SetScale2XEnabled(bool)
 		virtual void SetScale2XEnabled(bool Enable) override;
+		/// @copydoc SpriteDrawer::SetPremultipliedAlpha(bool)
+		virtual void SetPremultipliedAlpha(bool Enable) override;
+		/// @copydoc SpriteDrawer::SetAlphaTexture(bool)
+		virtual void SetAlphaTexture(bool Enable) override;
+		/// @copydoc SpriteDrawer::SetDistanceField(bool)
+		virtual void SetDistanceField(bool Enable) override;
 		
 	public:
 
 		/// @copydoc SpriteDrawer::IsScale2XEnabled()
 		virtual bool IsScale2XEnabled() const override { return false; }
+		/// @copydoc SpriteDrawer::IsPremultipliedAlpha()
+		virtual bool IsPremultipliedAlpha() const override { return m_PremultipliedAlpha; }
+		/// @copydoc SpriteDrawer::IsAlphaTexture()
+		virtual bool IsAlphaTexture() const override { return m_AlphaTexture; }
+		/// @copydoc SpriteDrawer::IsDistanceField()
+		virtual bool IsDistanceField() const override { return m_DistanceField; }
 
 	public:
 
@@ -72,8 +84,14 @@ namespace Kyo2D
 
 		ComPtr<IDirect3DVertexShader9> m_VertShader;
 		ComPtr<IDirect3DPixelShader9> m_PixShader;
+		ComPtr<IDirect3DPixelShader9> m_PixShaderPremul;
+		ComPtr<IDirect3DPixelShader9> m_PixShaderAlpha;
+		ComPtr<IDirect3DPixelShader9> m_PixShaderDistanceField;
 		ComPtr<IDirect3DVertexBuffer9> m_GeomBuffer;
 		ComPtr<IDirect3DVertexDeclaration9> m_VertexDecl;
 		XMMATRIX m_Matrices[2];
+		bool m_PremultipliedAlpha;
+		bool m_AlphaTexture;
+		bool m_DistanceField;
 	};
 }
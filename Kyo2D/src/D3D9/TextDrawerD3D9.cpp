@@ -1,13 +1,163 @@
-
 #include "TextDrawerD3D9.h"
+#include "shaders/d3d9/Sprite9_VS.h"
+#include "shaders/d3d9/Sprite9_PS.h"
+#include "shaders/d3d9/SpriteAlpha9_PS.h"
+#include "shaders/d3d9/SpriteDistanceField9_PS.h"
+#include <algorithm>
 
 namespace Kyo2D
 {
 	TextDrawerD3D9::TextDrawerD3D9()
+		: m_AlphaTexture(false)
+		, m_DistanceField(false)
 	{
 	}
 
 	TextDrawerD3D9::~TextDrawerD3D9()
 	{
 	}
+
+	bool TextDrawerD3D9::Initialize()
+	{
+		// The sprite shaders draw the glyphs, positions are already in pixels
+		HRESULT hr = g_Context->D3DDevice9->CreateVertexShader((const DWORD*)g_sprite9MainVS, m_VertShader.GetAddressOf());
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		hr = g_Context->D3DDevice9->CreatePixelShader((const DWORD*)g_sprite9MainPS, m_PixShader.GetAddressOf());
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		hr = g_Context->D3DDevice9->CreatePixelShader((const DWORD*)g_spriteAlpha9MainPS, m_PixShaderAlpha.GetAddressOf());
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		hr = g_Context->D3DDevice9->CreatePixelShader((const DWORD*)g_spriteDistanceField9MainPS, m_PixShaderDistanceField.GetAddressOf());
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		D3DVERTEXELEMENT9 declaration[] =
+		{
+			{ 0, 0,  D3DDECLTYPE_FLOAT3,   D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_POSITION, 0 },
+			{ 0, 12, D3DDECLTYPE_D3DCOLOR, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_COLOR,    0 },
+			{ 0, 16, D3DDECLTYPE_FLOAT2, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD,    0 },
+			{ 0, 24, D3DDECLTYPE_FLOAT4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD,    1 },
+			D3DDECL_END()
+		};
+		hr = g_Context->D3DDevice9->CreateVertexDeclaration(declaration, m_VertexDecl.GetAddressOf());
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		// Two triangles per glyph, the same for every batch
+		m_Indices.resize(6 * MaxGlyphsPerBatch);
+		for (std::uint32_t i = 0; i < MaxGlyphsPerBatch; ++i)
+		{
+			const std::uint16_t v = static_cast<std::uint16_t>(i * 4);
+			std::uint16_t *quad = &m_Indices[i * 6];
+			quad[0] = v;		quad[1] = v + 1;	quad[2] = v + 2;
+			quad[3] = v + 2;	quad[4] = v + 1;	quad[5] = v + 3;
+		}
+		m_Vertices.resize(4 * MaxGlyphsPerBatch);
+
+		m_Matrices[0] = Matrix4::Identity();
+		m_Matrices[1] = Matrix4::Identity();
+		return true;
+	}
+
+	bool TextDrawerD3D9::Prepare()
+	{
+		g_Context->D3DDevice9->SetVertexShader(m_VertShader.Get());
+		if (m_DistanceField)
+			g_Context->D3DDevice9->SetPixelShader(m_PixShaderDistanceField.Get());
+		else if (m_AlphaTexture)
+			g_Context->D3DDevice9->SetPixelShader(m_PixShaderAlpha.Get());
+		else
+			g_Context->D3DDevice9->SetPixelShader(m_PixShader.Get());
+
+		// Distance fields need filtering, glyph bitmaps are drawn 1:1
+		const D3DTEXTUREFILTERTYPE filter = m_DistanceField ? D3DTEXF_LINEAR : D3DTEXF_POINT;
+		g_Context->D3DDevice9->SetSamplerState(0, D3DSAMP_MINFILTER, filter);
+		g_Context->D3DDevice9->SetSamplerState(0, D3DSAMP_MAGFILTER, filter);
+		g_Context->D3DDevice9->SetRenderState(D3DRS_SRCBLEND, D3DBLEND_SRCALPHA);
+
+		g_Context->D3DDevice9->SetVertexDeclaration(m_VertexDecl.Get());
+		HRESULT hr = g_Context->D3DDevice9->SetVertexShaderConstantF(0, &m_Matrices[0].m[0][0], 8);
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	void TextDrawerD3D9::SetViewMatrix(const Matrix4 & ViewMatrix)
+	{
+		m_Matrices[0] = ViewMatrix;
+	}
+
+	void TextDrawerD3D9::SetAlphaTexture(bool Enable)
+	{
+		m_AlphaTexture = Enable;
+	}
+
+	void TextDrawerD3D9::SetDistanceField(bool Enable)
+	{
+		m_DistanceField = Enable;
+	}
+
+	void TextDrawerD3D9::DrawGlyphs(std::int32_t texW, std::int32_t texH, const GlyphQuad *quads, size_t count, std::uint32_t color, std::uint32_t colorkey)
+	{
+		const float invW = 1.0f / static_cast<float>(texW);
+		const float invH = 1.0f / static_cast<float>(texH);
+
+		// 0xAABBGGRR to D3DCOLOR, the colorkey goes to the shaders as floats
+		const std::uint32_t reversed = (color & 0xFF00FF00) | ((color & 0x000000FF) << 16) | ((color & 0x00FF0000) >> 16);
+		const float r = (colorkey & 0xFF) / 255.0f;
+		const float g = ((colorkey >> 8) & 0xFF) / 255.0f;
+		const float b = ((colorkey >> 16) & 0xFF) / 255.0f;
+		const float a = (colorkey >> 24) / 255.0f;
+
+		while (count > 0)
+		{
+			const std::uint32_t batch = static_cast<std::uint32_t>(std::min<size_t>(count, MaxGlyphsPerBatch));
+
+			// 0--1
+			// | /|
+			// |/ |
+			// 2--3
+			GlyphVertex *vertices = m_Vertices.data();
+			for (std::uint32_t i = 0; i < batch; ++i)
+			{
+				const GlyphQuad &quad = quads[i];
+				const float u0 = quad.SrcX * invW, v0 = quad.SrcY * invH;
+				const float u1 = (quad.SrcX + quad.SrcW) * invW, v1 = (quad.SrcY + quad.SrcH) * invH;
+				const float x1 = quad.X + quad.W, y1 = quad.Y + quad.H;
+
+				vertices[0] = { quad.X, quad.Y, 0.0f, reversed, u0, v0, r, g, b, a };
+				vertices[1] = { x1, quad.Y, 0.0f, reversed, u1, v0, r, g, b, a };
+				vertices[2] = { quad.X, y1, 0.0f, reversed, u0, v1, r, g, b, a };
+				vertices[3] = { x1, y1, 0.0f, reversed, u1, v1, r, g, b, a };
+				vertices += 4;
+			}
+
+			g_Context->D3DDevice9->DrawIndexedPrimitiveUP(D3DPT_TRIANGLELIST, 0, batch * 4, batch * 2,
+				m_Indices.data(), D3DFMT_INDEX16, m_Vertices.data(), sizeof(GlyphVertex));
+
+			g_Context->Stats.DrawCalls++;
+			g_Context->Stats.Vertices += batch * 4;
+
+			quads += batch;
+			count -= batch;
+		}
+	}
 }
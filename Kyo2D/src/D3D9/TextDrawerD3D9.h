@@ -1,11 +1,18 @@
-
 #pragma once
 
 #include "../TextDrawer.h"
+#include <Windows.h>
+#include <comptr.h>
+#include <d3d9.h>
+#include <vector>
+#include "../EngineContext.h"
+using namespace Microsoft::WRL;
 
 namespace Kyo2D
 {
-	/// Base class for text rendering.
+	/// Text rendering with Direct3D 9. Glyphs are written to a vertex array in system memory and
+	/// drawn as indexed quads with DrawIndexedPrimitiveUP. The sprite shaders are reused with an
+	/// identity world matrix.
 	class TextDrawerD3D9 : public TextDrawer
 	{
 	public:
@@ -15,6 +22,52 @@ namespace Kyo2D
 		/// Destructor.
 		virtual ~TextDrawerD3D9();
 
+		/// @copydoc TextDrawer::Initialize()
+		virtual bool Initialize() override;
+		/// @copydoc TextDrawer::Prepare()
+		virtual bool Prepare() override;
+		/// @copydoc TextDrawer::SetViewMatrix(const Matrix4 &)
+		virtual void SetViewMatrix(const Matrix4 &ViewMatrix) override;
+		/// @copydoc TextDrawer::SetAlphaTexture(bool)
+		virtual void SetAlphaTexture(bool Enable) override;
+		/// @copydoc TextDrawer::SetDistanceField(bool)
+		virtual void SetDistanceField(bool Enable) override;
+
+	public:
+
+		/// @copydoc TextDrawer::DrawGlyphs()
+		virtual void DrawGlyphs(std::int32_t texW, std::int32_t texH, const GlyphQuad *quads, size_t count, std::uint32_t color, std::uint32_t colorkey) override;
+
+	public:
+
+		/// @copydoc TextDrawer::IsAlphaTexture()
+		virtual bool IsAlphaTexture() const override { return m_AlphaTexture; }
+		/// @copydoc TextDrawer::IsDistanceField()
+		virtual bool IsDistanceField() const override { return m_DistanceField; }
+
+	private:
+
+		/// Vertex structure of the sprite shaders.
+		struct GlyphVertex
+		{
+			FLOAT X, Y, Z;			// position
+			std::uint32_t Color;	// color
+			FLOAT U, V;				// texture coordinates
+			FLOAT A, R, G, B;		// color key
+		};
+
+	private:
 
+		ComPtr<IDirect3DVertexShader9> m_VertShader;
+		ComPtr<IDirect3DPixelShader9> m_PixShader;
+		ComPtr<IDirect3DPixelShader9> m_PixShaderAlpha;
+		ComPtr<IDirect3DPixelShader9> m_PixShaderDistanceField;
+		ComPtr<IDirect3DVertexDeclaration9> m_VertexDecl;
+		/// View matrix and the identity world matrix, uploaded together.
+		Matrix4 m_Matrices[2];
+		std::vector<GlyphVertex> m_Vertices;
+		std::vector<std::uint16_t> m_Indices;
+		bool m_AlphaTexture;
+		bool m_DistanceField;
 	};
 }
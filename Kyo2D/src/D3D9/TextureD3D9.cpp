@@ -45,6 +45,176 @@ namespace Kyo2D
 		return InitializeImpl(idImage);
 	}
 
+	bool TextureD3D9::InitializeRenderTarget(std::int32_t width, std::int32_t height)
+	{
+		ReleaseResources();
+
+		m_Width = width;
+		m_Height = height;
+
+		// Render targets have to live in the default pool
+		HRESULT hr = g_Context->D3DDevice9->CreateTexture(
+			m_Width,
+			m_Height,
+			1,
+			D3DUSAGE_RENDERTARGET,
+			D3DFMT_A8R8G8B8,
+			D3DPOOL_DEFAULT,
+			m_Texture.GetAddressOf(),
+			nullptr);
+
+		return SUCCEEDED(hr);
+	}
+
+	bool TextureD3D9::InitializePixels(std::int32_t width, std::int32_t height, const std::uint32_t *pixels)
+	{
+		ReleaseResources();
+		SetAlphaOnly(false);
+
+		m_Width = width;
+		m_Height = height;
+
+		// The managed pool keeps a system memory copy, so the texture can be locked for updates
+		HRESULT hr = g_Context->D3DDevice9->CreateTexture(
+			m_Width,
+			m_Height,
+			1,
+			0,
+			D3DFMT_A8R8G8B8,
+			D3DPOOL_MANAGED,
+			m_Texture.GetAddressOf(),
+			nullptr);
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		if (pixels)
+		{
+			return UpdateRegion(0, 0, m_Width, m_Height, pixels);
+		}
+
+		// Start with transparent pixels
+		D3DLOCKED_RECT Rect;
+		hr = m_Texture->LockRect(0, &Rect, nullptr, 0);
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		for (std::int32_t row = 0; row < m_Height; ++row)
+		{
+			memset(static_cast<unsigned char*>(Rect.pBits) + row * Rect.Pitch, 0, m_Width * 4);
+		}
+
+		hr = m_Texture->UnlockRect(0);
+		return SUCCEEDED(hr);
+	}
+
+	bool TextureD3D9::UpdateRegion(std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const std::uint32_t *pixels)
+	{
+		if (!m_Texture || !pixels || IsAlphaOnly() || !IsValidRegion(x, y, width, height))
+		{
+			return false;
+		}
+
+		// Only lock the updated region, so only this part is uploaded
+		RECT region = { x, y, x + width, y + height };
+		D3DLOCKED_RECT Rect;
+		HRESULT hr = m_Texture->LockRect(0, &Rect, &region, 0);
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		const std::uint32_t *img = pixels;
+		for (std::int32_t row = 0; row < height; ++row)
+		{
+			unsigned char *ptr = static_cast<unsigned char*>(Rect.pBits) + row * Rect.Pitch;
+			for (std::int32_t column = 0; column < width; ++column)
+			{
+				*(ptr++) = (*img & 0x00FF0000) >> 16;		// B
+				*(ptr++) = (*img & 0x0000FF00) >> 8;		// G
+				*(ptr++) = (*img & 0x000000FF);				// R
+				*(ptr++) = (*img & 0xFF000000) >> 24;		// A
+				img++;
+			}
+		}
+
+		hr = m_Texture->UnlockRect(0);
+		return SUCCEEDED(hr);
+	}
+
+	bool TextureD3D9::InitializeAlpha(std::int32_t width, std::int32_t height, const std::uint8_t *alpha)
+	{
+		ReleaseResources();
+		SetAlphaOnly(true);
+
+		m_Width = width;
+		m_Height = height;
+
+		// Fails on devices without A8 textures, callers fall back to color textures then
+		HRESULT hr = g_Context->D3DDevice9->CreateTexture(
+			m_Width,
+			m_Height,
+			1,
+			0,
+			D3DFMT_A8,
+			D3DPOOL_MANAGED,
+			m_Texture.GetAddressOf(),
+			nullptr);
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		if (alpha)
+		{
+			return UpdateAlphaRegion(0, 0, m_Width, m_Height, alpha);
+		}
+
+		// Start with transparent pixels
+		D3DLOCKED_RECT Rect;
+		hr = m_Texture->LockRect(0, &Rect, nullptr, 0);
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		for (std::int32_t row = 0; row < m_Height; ++row)
+		{
+			memset(static_cast<unsigned char*>(Rect.pBits) + row * Rect.Pitch, 0, m_Width);
+		}
+
+		hr = m_Texture->UnlockRect(0);
+		return SUCCEEDED(hr);
+	}
+
+	bool TextureD3D9::UpdateAlphaRegion(std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const std::uint8_t *alpha)
+	{
+		if (!m_Texture || !alpha || !IsAlphaOnly() || !IsValidRegion(x, y, width, height))
+		{
+			return false;
+		}
+
+		// Only lock the updated region, so only this part is uploaded
+		RECT region = { x, y, x + width, y + height };
+		D3DLOCKED_RECT Rect;
+		HRESULT hr = m_Texture->LockRect(0, &Rect, &region, 0);
+		if (FAILED(hr))
+		{
+			return false;
+		}
+
+		for (std::int32_t row = 0; row < height; ++row)
+		{
+			memcpy(static_cast<unsigned char*>(Rect.pBits) + row * Rect.Pitch, alpha + row * width, width);
+		}
+
+		hr = m_Texture->UnlockRect(0);
+		return SUCCEEDED(hr);
+	}
+
 	bool TextureD3D9::Set()
 	{
 		if (!m_Texture.Get())
@@ -52,7 +222,7 @@ namespace Kyo2D
 			return false;
 		}
 
-		HRESULT hr = g_D3DDevice9->SetTexture(0, m_Texture.Get());
+		HRESULT hr = g_Context->D3DDevice9->SetTexture(0, m_Texture.Get());
 		if (FAILED(hr))
 		{
 			return false;
@@ -61,6 +231,11 @@ namespace Kyo2D
 		return true;
 	}
 
+	void TextureD3D9::ReleaseResources()
+	{
+		m_Texture.Reset();
+	}
+
 	bool TextureD3D9::InitializeImpl(ILuint &idImage)
 	{
 		// Save image informations
@@ -71,7 +246,10 @@ namespace Kyo2D
 		ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE);
 		unsigned char * pData = ilGetData();
 
-		HRESULT hr = g_D3DDevice9->CreateTexture(
+		// Premultiply alpha and bake the colorkey if requested
+		ApplyLoadOptions(pData, m_Width, m_Height);
+
+		HRESULT hr = g_Context->D3DDevice9->CreateTexture(
 			m_Width,
 			m_Height,
 			1,
@@ -7,11 +7,9 @@
 #include <comptr.h>
 #include "../Texture.h"
 #include "IL/il.h"
+#include "../EngineContext.h"
 using namespace Microsoft::WRL;
 
-extern ComPtr<IDirect3D9> g_D3D9;
-extern ComPtr<IDirect3DDevice9> g_D3DDevice9;
-
 namespace Kyo2D
 {
 	/// Direct3D9 implementation of a texture.
@@ -28,6 +26,16 @@ namespace Kyo2D
 		virtual bool Initialize(const void *data, size_t dataSize) override;
 		/// @copydoc Texture::Initialize(const std::wstring &)
 		virtual bool Initialize(const std::wstring &filename) override;
+		/// @copydoc Texture::InitializeRenderTarget(std::int32_t, std::int32_t)
+		virtual bool InitializeRenderTarget(std::int32_t width, std::int32_t height) override;
+		/// @copydoc Texture::InitializePixels(std::int32_t, std::int32_t, const std::uint32_t *)
+		virtual bool InitializePixels(std::int32_t width, std::int32_t height, const std::uint32_t *pixels) override;
+		/// @copydoc Texture::UpdateRegion(std::int32_t, std::int32_t, std::int32_t, std::int32_t, const std::uint32_t *)
+		virtual bool UpdateRegion(std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const std::uint32_t *pixels) override;
+		/// @copydoc Texture::InitializeAlpha(std::int32_t, std::int32_t, const std::uint8_t *)
+		virtual bool InitializeAlpha(std::int32_t width, std::int32_t height, const std::uint8_t *alpha) override;
+		/// @copydoc Texture::UpdateAlphaRegion(std::int32_t, std::int32_t, std::int32_t, std::int32_t, const std::uint8_t *)
+		virtual bool UpdateAlphaRegion(std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const std::uint8_t *alpha) override;
 		/// @copydoc Texture::Set()
 		virtual bool Set() override;
 
@@ -35,6 +43,16 @@ namespace Kyo2D
 		virtual std::int32_t GetWidth() const override { return m_Width; }
 		/// @copydoc Texture::GetHeight()
 		virtual std::int32_t GetHeight() const override { return m_Height; }
+		/// @copydoc Texture::IsResident()
+		virtual bool IsResident() const override { return m_Texture.Get() != nullptr; }
+
+		/// Gets the underlying texture resource.
+		inline IDirect3DTexture9 *GetResource() const { return m_Texture.Get(); }
+
+	protected:
+
+		/// @copydoc Texture::ReleaseResources()
+		virtual void ReleaseResources() override;
 
 	private:
 
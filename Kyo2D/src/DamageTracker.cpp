@@ -0,0 +1,224 @@
+#include "DamageTracker.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Kyo2D
+{
+	DamageRect DamageRect::Union(const DamageRect &other) const
+	{
+		if (IsEmpty())
+			return other;
+		if (other.IsEmpty())
+			return *this;
+
+		DamageRect result;
+		result.Left = std::min(Left, other.Left);
+		result.Top = std::min(Top, other.Top);
+		result.Right = std::max(Right, other.Right);
+		result.Bottom = std::max(Bottom, other.Bottom);
+		return result;
+	}
+
+	DamageRect DamageRect::Clip(const DamageRect &other) const
+	{
+		DamageRect result;
+		result.Left = std::max(Left, other.Left);
+		result.Top = std::max(Top, other.Top);
+		result.Right = std::min(Right, other.Right);
+		result.Bottom = std::min(Bottom, other.Bottom);
+		return result;
+	}
+
+	DamageTracker::DamageTracker()
+		: m_MaxRects(8)
+		, m_FullFrameThreshold(0.75f)
+		, m_FullDamage(true)
+	{
+		m_Frame.Left = m_Frame.Top = m_Frame.Right = m_Frame.Bottom = 0;
+		Reset();
+	}
+
+	DamageTracker::~DamageTracker()
+	{
+	}
+
+	void DamageTracker::SetMaxRects(std::uint32_t maxRects)
+	{
+		m_MaxRects = std::max<std::uint32_t>(maxRects, 1);
+	}
+
+	void DamageTracker::SetFullFrameThreshold(float fraction)
+	{
+		m_FullFrameThreshold = std::max(0.0f, std::min(1.0f, fraction));
+	}
+
+	void DamageTracker::BeginFrame()
+	{
+		m_Current.clear();
+	}
+
+	void DamageTracker::Record(const DamageRect &bounds, std::uint64_t hash)
+	{
+		Entry entry;
+		entry.Bounds = bounds;
+		entry.Hash = hash;
+		m_Current.push_back(entry);
+	}
+
+	const std::vector<DamageRect> &DamageTracker::EndFrame(std::int32_t width, std::int32_t height)
+	{
+		m_Dirty.clear();
+
+		DamageRect frame = { 0, 0, width, height };
+		if (frame.Right != m_Frame.Right || frame.Bottom != m_Frame.Bottom)
+			m_FullDamage = true;
+		m_Frame = frame;
+
+		if (m_FullDamage)
+		{
+			if (!frame.IsEmpty())
+				m_Dirty.push_back(frame);
+		}
+		else
+		{
+			auto same = [](const Entry &a, const Entry &b)
+			{
+				return a.Hash == b.Hash &&
+					a.Bounds.Left == b.Bounds.Left && a.Bounds.Top == b.Bounds.Top &&
+					a.Bounds.Right == b.Bounds.Right && a.Bounds.Bottom == b.Bounds.Bottom;
+			};
+
+			// Skip the common prefix and suffix of both frames
+			size_t prefix = 0;
+			size_t maxCommon = std::min(m_Previous.size(), m_Current.size());
+			while (prefix < maxCommon && same(m_Previous[prefix], m_Current[prefix]))
+				++prefix;
+
+			size_t suffix = 0;
+			while (suffix < maxCommon - prefix &&
+				same(m_Previous[m_Previous.size() - 1 - suffix], m_Current[m_Current.size() - 1 - suffix]))
+				++suffix;
+
+			// Everything in between changed
+			for (size_t i = prefix; i < m_Previous.size() - suffix; ++i)
+				AddDamage(m_Previous[i].Bounds.Clip(frame));
+			for (size_t i = prefix; i < m_Current.size() - suffix; ++i)
+				AddDamage(m_Current[i].Bounds.Clip(frame));
+
+			// Most of the frame changed: Redraw it at once
+			std::uint64_t damaged = 0;
+			for (auto &rect : m_Dirty)
+				damaged += rect.GetArea();
+			if (m_FullFrameThreshold < 1.0f && damaged > frame.GetArea() * m_FullFrameThreshold)
+			{
+				m_Dirty.clear();
+				m_Dirty.push_back(frame);
+			}
+		}
+
+		m_FullDamage = false;
+		m_Previous.swap(m_Current);
+		m_Current.clear();
+
+		// Update statistics
+		m_Stats.DirtyRects = static_cast<std::uint32_t>(m_Dirty.size());
+		m_Stats.PixelsRedrawn = 0;
+		for (auto &rect : m_Dirty)
+			m_Stats.PixelsRedrawn += rect.GetArea();
+		m_Stats.PixelsFullFrame = frame.GetArea();
+		m_Stats.TotalPixelsRedrawn += m_Stats.PixelsRedrawn;
+		m_Stats.TotalPixelsFullFrame += m_Stats.PixelsFullFrame;
+
+		return m_Dirty;
+	}
+
+	void DamageTracker::Invalidate()
+	{
+		m_FullDamage = true;
+	}
+
+	void DamageTracker::Reset()
+	{
+		m_Previous.clear();
+		m_Current.clear();
+		m_Dirty.clear();
+		m_FullDamage = true;
+		m_Stats.DirtyRects = 0;
+		m_Stats.PixelsRedrawn = 0;
+		m_Stats.PixelsFullFrame = 0;
+		m_Stats.TotalPixelsRedrawn = 0;
+		m_Stats.TotalPixelsFullFrame = 0;
+	}
+
+	DamageRect DamageTracker::BoundsOf(float centerX, float centerY, float halfW, float halfH, float rotation)
+	{
+		float c = std::fabs(std::cos(rotation));
+		float s = std::fabs(std::sin(rotation));
+		float w = std::fabs(halfW);
+		float h = std::fabs(halfH);
+		float extX = w * c + h * s;
+		float extY = w * s + h * c;
+
+		// Clamp to a sane range before converting, coordinates may be far off screen
+		const float limit = static_cast<float>(std::numeric_limits<std::int32_t>::max() / 2);
+		auto toInt = [limit](float v) { return static_cast<std::int32_t>(std::max(-limit, std::min(limit, v))); };
+
+		DamageRect rect;
+		rect.Left = toInt(std::floor(centerX - extX)) - 1;
+		rect.Top = toInt(std::floor(centerY - extY)) - 1;
+		rect.Right = toInt(std::ceil(centerX + extX)) + 1;
+		rect.Bottom = toInt(std::ceil(centerY + extY)) + 1;
+		return rect;
+	}
+
+	void DamageTracker::AddDamage(DamageRect rect)
+	{
+		if (rect.IsEmpty())
+			return;
+
+		// Merge with every rectangle it touches. A merged rectangle may touch others again.
+		bool merged = true;
+		while (merged)
+		{
+			merged = false;
+			for (size_t i = 0; i < m_Dirty.size(); ++i)
+			{
+				if (m_Dirty[i].Touches(rect))
+				{
+					rect = rect.Union(m_Dirty[i]);
+					m_Dirty[i] = m_Dirty.back();
+					m_Dirty.pop_back();
+					merged = true;
+					break;
+				}
+			}
+		}
+
+		m_Dirty.push_back(rect);
+		if (m_Dirty.size() <= m_MaxRects)
+			return;
+
+		// Too many rectangles: Merge the pair which adds the least area
+		size_t bestA = 0, bestB = 1;
+		std::uint64_t bestCost = std::numeric_limits<std::uint64_t>::max();
+		for (size_t a = 0; a < m_Dirty.size(); ++a)
+		{
+			for (size_t b = a + 1; b < m_Dirty.size(); ++b)
+			{
+				std::uint64_t cost = m_Dirty[a].Union(m_Dirty[b]).GetArea() - m_Dirty[a].GetArea() - m_Dirty[b].GetArea();
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestA = a;
+					bestB = b;
+				}
+			}
+		}
+
+		DamageRect combined = m_Dirty[bestA].Union(m_Dirty[bestB]);
+		m_Dirty.erase(m_Dirty.begin() + bestB);
+		m_Dirty.erase(m_Dirty.begin() + bestA);
+		AddDamage(combined);
+	}
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Kyo2D
+{
+	/// An integer pixel rectangle. Right and Bottom are exclusive.
+	struct DamageRect
+	{
+		std::int32_t Left, Top, Right, Bottom;
+
+		/// Determines if the rectangle doesn't cover any pixel.
+		inline bool IsEmpty() const { return Right <= Left || Bottom <= Top; }
+		/// Gets the number of pixels covered by the rectangle.
+		inline std::uint64_t GetArea() const { return IsEmpty() ? 0 : static_cast<std::uint64_t>(Right - Left) * static_cast<std::uint64_t>(Bottom - Top); }
+		/// Determines if both rectangles overlap or touch each other.
+		inline bool Touches(const DamageRect &other) const { return Left <= other.Right && other.Left <= Right && Top <= other.Bottom && other.Top <= Bottom; }
+		/// Determines if both rectangles share at least one pixel.
+		inline bool Intersects(const DamageRect &other) const { return Left < other.Right && other.Left < Right && Top < other.Bottom && other.Top < Bottom; }
+		/// Gets the smallest rectangle containing both rectangles.
+		DamageRect Union(const DamageRect &other) const;
+		/// Gets the part of this rectangle inside the given one.
+		DamageRect Clip(const DamageRect &other) const;
+	};
+
+	/// Computes which parts of a frame changed since the previous frame.
+	/// Every draw call of a frame is recorded with its screen bounds and a hash of all its
+	/// parameters. At the end of a frame, the recorded calls are compared with the ones of the
+	/// previous frame: the common prefix and suffix of both call lists are unchanged, the bounds
+	/// of all calls in between (from both frames) are damaged. Pixels outside the damaged area are
+	/// covered by the same calls in the same order as before, so they don't need to be redrawn.
+	/// The damaged area is merged into a small number of non-overlapping rectangles, or into the
+	/// whole frame when most of it changed.
+	class DamageTracker
+	{
+	public:
+
+		/// Damage statistics.
+		struct Stats
+		{
+			/// Number of dirty rectangles of the last frame.
+			std::uint32_t DirtyRects;
+			/// Pixels redrawn in the last frame.
+			std::uint64_t PixelsRedrawn;
+			/// Pixels of the last frame.
+			std::uint64_t PixelsFullFrame;
+			/// Pixels redrawn since the tracker has been reset.
+			std::uint64_t TotalPixelsRedrawn;
+			/// Pixels of all frames since the tracker has been reset.
+			std::uint64_t TotalPixelsFullFrame;
+		};
+
+	public:
+
+		/// Default constructor.
+		DamageTracker();
+		/// Destructor.
+		~DamageTracker();
+
+		/// Sets the maximum number of dirty rectangles per frame. If the damage consists of more
+		/// rectangles, the ones which are cheapest to combine are merged.
+		void SetMaxRects(std::uint32_t maxRects);
+		/// Sets the part of the frame above which the whole frame is redrawn instead of single
+		/// rectangles, redrawing each rectangle replays the calls touching it once more.
+		/// @param fraction Damaged area relative to the frame area, 1 never falls back.
+		void SetFullFrameThreshold(float fraction);
+		/// Starts recording a new frame.
+		void BeginFrame();
+		/// Records a draw call of the current frame.
+		/// @param bounds The screen area the call may touch.
+		/// @param hash Hash of everything that affects the output of the call.
+		void Record(const DamageRect &bounds, std::uint64_t hash);
+		/// Finishes the current frame and computes its dirty rectangles.
+		/// @param width The frame width in pixels. A size change damages the whole frame.
+		/// @param height The frame height in pixels.
+		/// @returns The dirty rectangles, clipped to the frame.
+		const std::vector<DamageRect> &EndFrame(std::int32_t width, std::int32_t height);
+		/// Damages the whole next frame.
+		void Invalidate();
+		/// Forgets the previous frame and resets the statistics.
+		void Reset();
+
+		/// Gets the dirty rectangles computed by the last EndFrame call.
+		inline const std::vector<DamageRect> &GetDirtyRects() const { return m_Dirty; }
+		/// Gets the damage statistics.
+		inline const Stats &GetStats() const { return m_Stats; }
+
+	public:
+
+		/// Computes the bounds of a rotated rectangle, padded by one pixel for filtering and rounding.
+		/// @param centerX Center of the rectangle.
+		/// @param centerY Center of the rectangle.
+		/// @param halfW Half of the rectangle width.
+		/// @param halfH Half of the rectangle height.
+		/// @param rotation Rotation around the center in radians.
+		static DamageRect BoundsOf(float centerX, float centerY, float halfW, float halfH, float rotation);
+
+	private:
+
+		/// Adds a rectangle to the damaged area, merging it with the rectangles it touches.
+		void AddDamage(DamageRect rect);
+
+	private:
+
+		struct Entry
+		{
+			DamageRect Bounds;
+			std::uint64_t Hash;
+		};
+
+		std::vector<Entry> m_Previous;
+		std::vector<Entry> m_Current;
+		std::vector<DamageRect> m_Dirty;
+		DamageRect m_Frame;
+		std::uint32_t m_MaxRects;
+		float m_FullFrameThreshold;
+		bool m_FullDamage;
+		Stats m_Stats;
+	};
+}
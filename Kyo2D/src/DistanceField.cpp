@@ -0,0 +1,160 @@
+#include "DistanceField.h"
+#include "Software/WorkerPool.h"
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	/// Squared distance of pixels which have no edge pixel in range yet.
+	const float Infinity = 1e20f;
+	/// Minimum number of lines a pass job processes, smaller jobs aren't worth a thread.
+	const std::int32_t LinesPerJob = 16;
+
+	/// Scratch buffers of the one dimensional transform.
+	struct Scratch
+	{
+		explicit Scratch(std::int32_t length)
+			: F(length), Z(length + 1), V(length)
+		{
+		}
+
+		std::vector<float> F;
+		std::vector<float> Z;
+		std::vector<std::int32_t> V;
+	};
+
+	/// One dimensional squared distance transform of a line of the grid (Felzenszwalb and Huttenlocher).
+	/// Computes the lower envelope of the parabolas rooted at each sample, then samples it.
+	void Transform(float *grid, std::int32_t offset, std::int32_t stride, std::int32_t length, Scratch &scratch)
+	{
+		float *f = scratch.F.data();
+		float *z = scratch.Z.data();
+		std::int32_t *v = scratch.V.data();
+
+		v[0] = 0;
+		z[0] = -Infinity;
+		z[1] = Infinity;
+		f[0] = grid[offset];
+
+		std::int32_t k = 0;
+		for (std::int32_t q = 1; q < length; ++q)
+		{
+			f[q] = grid[offset + q * stride];
+
+			// Remove the parabolas hidden by the new one
+			float s = 0.0f;
+			do
+			{
+				const std::int32_t r = v[k];
+				s = (f[q] - f[r] + static_cast<float>(q * q - r * r)) / static_cast<float>(2 * (q - r));
+			} while (s <= z[k] && --k > -1);
+
+			++k;
+			v[k] = q;
+			z[k] = s;
+			z[k + 1] = Infinity;
+		}
+
+		k = 0;
+		for (std::int32_t q = 0; q < length; ++q)
+		{
+			while (z[k + 1] < static_cast<float>(q))
+				++k;
+
+			const std::int32_t r = v[k];
+			grid[offset + q * stride] = f[r] + static_cast<float>((q - r) * (q - r));
+		}
+	}
+
+	/// Runs the jobs on the worker pool, or one after another if there is none.
+	void RunJobs(Kyo2D::WorkerPool *workers, std::int32_t jobs, const std::function<void(std::uint32_t)> &job)
+	{
+		if (workers)
+		{
+			workers->Run(static_cast<std::uint32_t>(jobs), job);
+			return;
+		}
+
+		for (std::int32_t i = 0; i < jobs; ++i)
+			job(static_cast<std::uint32_t>(i));
+	}
+
+	/// Transforms all columns, then all rows of the grid, splitting the lines into jobs.
+	void Transform2D(float *grid, std::int32_t width, std::int32_t height, Kyo2D::WorkerPool *workers)
+	{
+		// Columns
+		std::int32_t jobs = std::max<std::int32_t>(1, width / LinesPerJob);
+		RunJobs(workers, jobs, [&](std::uint32_t job)
+		{
+			Scratch scratch(height);
+			const std::int32_t first = static_cast<std::int32_t>(job) * width / jobs;
+			const std::int32_t last = static_cast<std::int32_t>(job + 1) * width / jobs;
+			for (std::int32_t x = first; x < last; ++x)
+			{
+				Transform(grid, x, width, height, scratch);
+			}
+		});
+
+		// Rows
+		jobs = std::max<std::int32_t>(1, height / LinesPerJob);
+		RunJobs(workers, jobs, [&](std::uint32_t job)
+		{
+			Scratch scratch(width);
+			const std::int32_t first = static_cast<std::int32_t>(job) * height / jobs;
+			const std::int32_t last = static_cast<std::int32_t>(job + 1) * height / jobs;
+			for (std::int32_t y = first; y < last; ++y)
+			{
+				Transform(grid, y * width, 1, width, scratch);
+			}
+		});
+	}
+}
+
+namespace Kyo2D
+{
+	void DistanceField::Generate(const std::uint8_t *coverage, std::int32_t width, std::int32_t height, float spread, WorkerPool *workers, std::uint8_t *out)
+	{
+		if (width <= 0 || height <= 0)
+			return;
+
+		// Squared distances to the nearest inside and outside pixel. A partially covered pixel is
+		// treated as an edge whose distance to the pixel center follows from the coverage, which
+		// keeps the anti-aliasing of the rasterizer.
+		const size_t count = static_cast<size_t>(width) * static_cast<size_t>(height);
+		std::vector<float> toInside(count), toOutside(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const float a = coverage[i] / 255.0f;
+			if (coverage[i] == 255)
+			{
+				toInside[i] = 0.0f;
+				toOutside[i] = Infinity;
+			}
+			else if (coverage[i] == 0)
+			{
+				toInside[i] = Infinity;
+				toOutside[i] = 0.0f;
+			}
+			else
+			{
+				const float d = 0.5f - a;
+				toInside[i] = d > 0.0f ? d * d : 0.0f;
+				toOutside[i] = d < 0.0f ? d * d : 0.0f;
+			}
+		}
+
+		Transform2D(toInside.data(), width, height, workers);
+		Transform2D(toOutside.data(), width, height, workers);
+
+		// Signed distance, positive inside
+		const float scale = 0.5f / spread;
+		for (size_t i = 0; i < count; ++i)
+		{
+			const float distance = std::sqrt(toOutside[i]) - std::sqrt(toInside[i]);
+			const float value = std::min(1.0f, std::max(0.0f, 0.5f + distance * scale));
+			out[i] = static_cast<std::uint8_t>(value * 255.0f + 0.5f);
+		}
+	}
+}
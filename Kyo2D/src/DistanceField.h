@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Kyo2D
+{
+	class WorkerPool;
+
+	/// Converts coverage images (e.g. rasterized glyphs) into signed distance fields. A distance
+	/// field stores the distance of each pixel to the nearest edge of the shape, so the shape can be
+	/// reconstructed at any scale by thresholding the bilinear filtered field, and outlines and
+	/// soft shadows are just different thresholds. Values are 0.5 (128) on the edge, larger inside
+	/// and smaller outside; the value range covers spread pixels in both directions.
+	class DistanceField
+	{
+	public:
+
+		/// Generates the distance field of a coverage image. Uses an exact euclidean distance
+		/// transform which treats partially covered pixels as edges at sub-pixel positions.
+		/// The separable passes of the transform are split across the given worker pool.
+		/// Callers which already run on a worker of the pool have to pass nullptr.
+		/// @param coverage width * height coverage values, 255 is inside. The shape should be padded
+		///		with spread empty pixels on each side, so the field isn't cut off.
+		/// @param width Width of the image in pixels.
+		/// @param height Height of the image in pixels.
+		/// @param spread Distance in pixels at which the field reaches 0 or 255.
+		/// @param workers The pool which executes the passes, nullptr runs them on the calling thread.
+		/// @param out Receives width * height distance values.
+		static void Generate(const std::uint8_t *coverage, std::int32_t width, std::int32_t height, float spread, WorkerPool *workers, std::uint8_t *out);
+	};
+}
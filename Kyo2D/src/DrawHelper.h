@@ -2,8 +2,7 @@
 #pragma once
 
 #include <cstdint>
-#include "DirectXMath.h"
-using namespace DirectX;
+#include "Matrix.h"
 
 namespace Kyo2D
 {
@@ -30,6 +29,6 @@ namespace Kyo2D
 		/// 
 		virtual void FillRect(float X, float Y, float W, float H, std::int32_t Color = -1) = 0;
 
-		virtual void UpdateViewMatrix(const XMMATRIX &ViewMatrix) = 0;
+		virtual void UpdateViewMatrix(const Matrix4 &ViewMatrix) = 0;
 	};
 }
@@ -0,0 +1,234 @@
+
+#pragma once
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <d3d11.h>
+#include <d3d9.h>
+#include <comptr.h>
+#endif
+#include <map>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include "TextureResidency.h"
+#include "DamageTracker.h"
+#include "Profiler.h"
+#include "Capture.h"
+#include "GlyphAtlas.h"
+#include "TextLayout.h"
+#include "TextDocument.h"
+#include "TextDrawer.h"
+#include "Software/SoftwareDevice.h"
+
+namespace Kyo2D
+{
+	class RenderTarget;
+	class Font;
+	class FontFamily;
+	class DrawHelper;
+	class SpriteDrawer;
+	class TextDrawer;
+
+	/// Render stage enumeration: Used to reduce d3d11 state changes to a minimum.
+	namespace render_stage
+	{
+		enum Type
+		{
+			None						= 0,
+			Drawer2D					= 1,
+			Sprite						= 2,
+			SpriteScale2X				= 3,
+			SpritePremultiplied			= 4,
+			SpriteScale2XPremultiplied	= 5,
+			SpriteAlpha					= 6,
+			SpriteDistanceField			= 7,
+			Text						= 8,
+			TextAlpha					= 9,
+			TextDistanceField			= 10
+		};
+	}
+
+	// Shortcut typedef
+	typedef render_stage::Type RenderStage;
+
+	/// Draw call enumeration: Draw calls are deferred to the present call while damage tracking is enabled.
+	namespace draw_call
+	{
+		enum Type
+		{
+			SpriteAt			= 0,
+			SubspriteAt			= 1,
+			SpriteScaled		= 2,
+			SubspriteScaled		= 3,
+			SpriteTiled			= 4,
+			Point				= 5,
+			Line				= 6,
+			Rect				= 7,
+			FillRect			= 8,
+			Glyphs				= 9
+		};
+	}
+
+	// Shortcut typedef
+	typedef draw_call::Type DrawCallType;
+
+	/// Parameters of a single draw call.
+	struct DrawCall
+	{
+		DrawCallType Type;
+		std::uint32_t TextureId;
+		float X, Y, W, H;				// W and H are the second point of lines
+		float SrcX, SrcY, SrcW, SrcH;	// SrcX and SrcY are the tile counts of tiled sprites
+		float Z, Rotation;
+		std::uint32_t Color, Colorkey;
+		bool Scale2X;
+		std::uint32_t FirstGlyph, GlyphCount;	// range of a glyph run in EngineContext::DeferredGlyphs
+	};
+
+	/// Contains the complete state of one engine instance: the device of the selected backend and
+	/// every object created through the api. Contexts don't share anything, so different threads
+	/// can render with different contexts at the same time. The api always works on the context
+	/// which is current on the calling thread (see g_Context).
+	struct EngineContext
+	{
+		EngineContext()
+			: Id(0)
+			, UseD3D11(false)
+			, UseSoftware(false)
+			, UseNull(false)
+			, ImageLoader(false)
+#ifdef _WIN32
+			, D3D9Wnd(nullptr)
+			, D3D9SceneActive(false)
+#endif
+			, NextRenderTarget(1)
+			, NextTexture(1)
+			, NextFont(1)
+			, NextFontFamily(1)
+			, GlyphWorkerThreads(0)
+			, GlyphWorkersStarted(false)
+			, NextTextLayout(1)
+			, NextTextDocument(1)
+			, Stage(render_stage::None)
+			, DamageTracking(false)
+			, Stats()
+			, LastFrameStats()
+			, LastFrameTime(0.0f)
+			, CaptureDepth(0)
+		{
+			DamageClearColor[0] = DamageClearColor[1] = DamageClearColor[2] = 0.0f;
+		}
+
+		EngineContext(const EngineContext&) = delete;
+		EngineContext& operator=(const EngineContext&) = delete;
+
+		/// Handle of this context, 0 for the default context.
+		std::uint32_t Id;
+
+		// Switch
+		bool UseD3D11;
+		bool UseSoftware;
+		bool UseNull;
+		/// Whether this context holds a reference on the image loader library.
+		bool ImageLoader;
+
+#ifdef _WIN32
+		// D3D11 device
+		Microsoft::WRL::ComPtr<ID3D11Device> D3DDevice11;
+		Microsoft::WRL::ComPtr<ID3D11DeviceContext> D3DDeviceContext11;
+
+		// D3D9 device
+		Microsoft::WRL::ComPtr<IDirect3D9> D3D9;
+		Microsoft::WRL::ComPtr<IDirect3DDevice9> D3DDevice9;
+		HWND D3D9Wnd;
+		/// Set while a scene of the D3D9 device is active. Offscreen targets are rendered inside
+		/// the same scene as the window target, so BeginScene is only called once per frame.
+		bool D3D9SceneActive;
+#endif
+
+		// Software device
+		SoftwareDevice Software;
+
+		// Render target management
+		std::uint32_t NextRenderTarget;
+		std::map<std::uint32_t, std::shared_ptr<RenderTarget>> RenderTargets;
+		std::weak_ptr<RenderTarget> ActiveRenderTarget;
+		std::map<std::uint32_t, std::uint32_t> OffscreenTextures;
+
+		// Texture management
+		std::uint32_t NextTexture;
+		std::map<std::uint32_t, std::shared_ptr<Texture>> Textures;
+		TextureResidency Residency;
+
+		// Font management
+		std::uint32_t NextFont;
+		std::map<std::uint32_t, std::shared_ptr<Font>> Fonts;
+		std::uint32_t NextFontFamily;
+		std::map<std::uint32_t, std::shared_ptr<FontFamily>> FontFamilies;
+		GlyphAtlas Glyphs;
+		/// Threads rasterizing glyphs and generating distance fields, started by the first font.
+		WorkerPool GlyphWorkers;
+		/// Threads the glyph workers are started with, 0 uses one per hardware thread.
+		std::uint32_t GlyphWorkerThreads;
+		bool GlyphWorkersStarted;
+		/// Directory of the glyph caches of fonts created from now on, empty if glyphs aren't cached.
+		std::wstring GlyphCacheDirectory;
+
+		// Text layout management
+		std::uint32_t NextTextLayout;
+		std::map<std::uint32_t, std::shared_ptr<TextLayout>> TextLayouts;
+		/// Layouts of the texts drawn with K2D_DrawText.
+		TextLayoutCache LayoutCache;
+
+		// Text document management
+		std::uint32_t NextTextDocument;
+		std::map<std::uint32_t, std::shared_ptr<TextDocument>> TextDocuments;
+
+		// Render stage
+		std::shared_ptr<Kyo2D::DrawHelper> DrawHelper;
+		std::shared_ptr<Kyo2D::SpriteDrawer> SpriteDrawer;
+		std::shared_ptr<Kyo2D::TextDrawer> TextDrawer;
+		RenderStage Stage;
+
+		// Damage tracking
+		bool DamageTracking;
+		DamageTracker Damage;
+		std::vector<DrawCall> DeferredDraws;
+		/// Glyph quads of the deferred glyph runs, in screen coordinates.
+		std::vector<GlyphQuad> DeferredGlyphs;
+		/// Scratch buffers of SubmitGlyphs: the run of the current page and the glyphs already drawn.
+		std::vector<GlyphQuad> GlyphRun;
+		std::vector<bool> GlyphRunDone;
+		std::weak_ptr<RenderTarget> DamageTarget;
+		float DamageClearColor[3];
+
+		// Frame statistics and profiling
+		FrameStats Stats;
+		FrameStats LastFrameStats;
+		float LastFrameTime;
+		Kyo2D::Profiler Profiler;
+
+		// Api capture
+		std::unique_ptr<CaptureWriter> Capture;
+		/// Number of api calls being recorded, calls made while another one runs are not recorded.
+		std::uint32_t CaptureDepth;
+	};
+
+	/// Creates an uninitialized texture instance for the backend of the current context and applies the load flags.
+	/// @param flags Combination of K2D_TextureFlags.
+	/// @param colorkey The colorkey to bake if K2D_TEXTURE_BAKE_COLORKEY is set.
+	std::shared_ptr<Texture> CreateTextureInstance(std::uint32_t flags, std::uint32_t colorkey);
+	/// Adds an initialized texture to the current context.
+	/// @returns The new texture id.
+	std::uint32_t RegisterTexture(std::shared_ptr<Texture> texture);
+	/// Draws glyph quads with the text drawer, one run per atlas page, or defers them to the present
+	/// call while damage tracking is enabled. The quads are moved by the given position.
+	/// @param colorkey Holds threshold and smoothing for distance field pages.
+	void SubmitGlyphs(const GlyphQuad *quads, size_t count, float x, float y, std::uint32_t color, std::uint32_t colorkey);
+}
+
+/// The engine context current on the calling thread. Points to the default context unless the
+/// thread selected another one with K2D_MakeContextCurrent.
+extern thread_local Kyo2D::EngineContext *g_Context;
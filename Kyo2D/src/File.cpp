@@ -1,11 +1,24 @@
 #include "File.h"
 #include <fstream>
+#include <cstdio>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 //=============================================================================
 bool readFileContents(const std::wstring& filename, FileData& out_data)
 {
 	// Load the file stream
+#ifdef _WIN32
 	std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+#else
+	std::ifstream stream(narrowFilename(filename).c_str(), std::ios::in | std::ios::binary | std::ios::ate);
+#endif
 	if (!stream.is_open())
 	{
 		return false;
@@ -27,4 +40,172 @@ bool readFileContents(const std::wstring& filename, FileData& out_data)
 	// Close stream again
 	stream.close();
 	return true;
-}
\ No newline at end of file
+}
+
+//=============================================================================
+std::string narrowFilename(const std::wstring& filename)
+{
+	std::string result;
+	result.reserve(filename.size());
+
+	for (size_t i = 0; i < filename.size(); ++i)
+	{
+		std::uint32_t c = static_cast<std::uint32_t>(filename[i]);
+
+		// Combine UTF-16 surrogate pairs where wchar_t is 16 bits wide
+		if (c >= 0xD800 && c <= 0xDBFF && i + 1 < filename.size())
+		{
+			std::uint32_t low = static_cast<std::uint32_t>(filename[i + 1]);
+			if (low >= 0xDC00 && low <= 0xDFFF)
+			{
+				c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+				++i;
+			}
+		}
+
+		if (c < 0x80)
+		{
+			result += static_cast<char>(c);
+		}
+		else if (c < 0x800)
+		{
+			result += static_cast<char>(0xC0 | (c >> 6));
+			result += static_cast<char>(0x80 | (c & 0x3F));
+		}
+		else if (c < 0x10000)
+		{
+			result += static_cast<char>(0xE0 | (c >> 12));
+			result += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+			result += static_cast<char>(0x80 | (c & 0x3F));
+		}
+		else
+		{
+			result += static_cast<char>(0xF0 | (c >> 18));
+			result += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+			result += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+			result += static_cast<char>(0x80 | (c & 0x3F));
+		}
+	}
+
+	return result;
+}
+
+//=============================================================================
+MappedFile::MappedFile()
+	: m_Data(nullptr)
+	, m_Size(0)
+#ifdef _WIN32
+	, m_File(INVALID_HANDLE_VALUE)
+	, m_Mapping(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::wstring& filename)
+{
+	Close();
+
+#ifdef _WIN32
+	m_File = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_File == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_File, &size) || size.QuadPart <= 0 || static_cast<unsigned long long>(size.QuadPart) > SIZE_MAX)
+	{
+		Close();
+		return false;
+	}
+
+	m_Mapping = CreateFileMappingW(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_Mapping)
+	{
+		Close();
+		return false;
+	}
+
+	m_Data = static_cast<const std::uint8_t*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+	m_Size = static_cast<size_t>(size.QuadPart);
+#else
+	const int file = open(narrowFilename(filename).c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+
+	// The mapping stays valid after the descriptor is closed
+	struct stat info;
+	if (fstat(file, &info) == 0 && info.st_size > 0)
+	{
+		void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		if (data != MAP_FAILED)
+		{
+			m_Data = static_cast<const std::uint8_t*>(data);
+			m_Size = static_cast<size_t>(info.st_size);
+		}
+	}
+	close(file);
+#endif
+
+	if (!m_Data)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (m_Data)
+		UnmapViewOfFile(m_Data);
+	if (m_Mapping)
+		CloseHandle(m_Mapping);
+	if (m_File != INVALID_HANDLE_VALUE)
+		CloseHandle(m_File);
+	m_Mapping = nullptr;
+	m_File = INVALID_HANDLE_VALUE;
+#else
+	if (m_Data)
+		munmap(const_cast<std::uint8_t*>(m_Data), m_Size);
+#endif
+
+	m_Data = nullptr;
+	m_Size = 0;
+}
+
+//=============================================================================
+bool writeFileAtomic(const std::wstring& filename, const void* data, size_t size)
+{
+	const std::wstring temporary = filename + L".tmp";
+	bool written = false;
+	{
+#ifdef _WIN32
+		std::ofstream stream(temporary.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+#else
+		std::ofstream stream(narrowFilename(temporary).c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+#endif
+		if (!stream.is_open())
+			return false;
+
+		stream.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+		stream.close();
+		written = !stream.fail();
+	}
+
+#ifdef _WIN32
+	if (written && MoveFileExW(temporary.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING))
+		return true;
+	DeleteFileW(temporary.c_str());
+#else
+	if (written && std::rename(narrowFilename(temporary).c_str(), narrowFilename(filename).c_str()) == 0)
+		return true;
+	std::remove(narrowFilename(temporary).c_str());
+#endif
+	return false;
+}
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
 
 
 /// Contains file data
@@ -13,3 +14,49 @@ typedef std::vector<std::uint8_t> FileData;
 /// @param out_data Reference to the struct which will hold the file data.
 /// @return false if there was an error loading the file.
 bool readFileContents(const std::wstring& filename, FileData& out_data);
+
+/// Converts a file name to the narrow UTF-8 form expected by the file apis of
+/// non-Windows platforms.
+/// @param filename The file name.
+/// @return The UTF-8 encoded file name.
+std::string narrowFilename(const std::wstring& filename);
+
+/// Read-only view of the contents of a file mapped into memory. The operating system pages the
+/// contents in when they are accessed, so opening a large file costs almost nothing.
+class MappedFile
+{
+public:
+
+	/// Default constructor. No file is mapped.
+	MappedFile();
+	/// Destructor. Unmaps the file.
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/// Maps a file, unmapping the previous one.
+	/// @return false if the file doesn't exist, is empty or couldn't be mapped.
+	bool Open(const std::wstring& filename);
+	/// Unmaps the file.
+	void Close();
+
+	/// Gets the contents of the file, nullptr if no file is mapped.
+	inline const std::uint8_t* GetData() const { return m_Data; }
+	/// Gets the size of the file in bytes.
+	inline size_t GetSize() const { return m_Size; }
+
+private:
+
+	const std::uint8_t* m_Data;
+	size_t m_Size;
+#ifdef _WIN32
+	void* m_File;
+	void* m_Mapping;
+#endif
+};
+
+/// Writes data to a file. The data goes to a temporary file first, which then replaces the
+/// file, so readers never see a partially written file.
+/// @return false if the file couldn't be written or replaced.
+bool writeFileAtomic(const std::wstring& filename, const void* data, size_t size);
@@ -1,82 +1,108 @@
 #include "Font.h"
-#include FT_STROKER_H
+#include FT_ADVANCES_H
+#include FT_SIZES_H
 #define NOMINMAX
 #include "Kyo2D.h"
-#include <atomic>
+#include "EngineContext.h"
+#include "DistanceField.h"
 #include <algorithm>
+#include <cmath>
 
 //=============================================================================
 // Constants
 
-/// Amount of pixels to put between two glyphs
-static constexpr std::uint32_t INTER_GLYPH_PAD_SPACE = 4;
+/// Offset applied to every glyph image. Glyph images used to be stored with one empty column
+/// and four empty rows in front of them, text stays at the position it had back then.
+static constexpr float GLYPH_OFFSET_X = 1.0f;
+static constexpr float GLYPH_OFFSET_Y = 4.0f;
 /// A multiplication coefficient to convert FT_Pos values into normal floats
 static constexpr float FT_POS_COEF = (1.0f / 64.0f);
 /// Number of glyphs per page. Must be a power of two.
 static constexpr std::uint32_t GLYPHS_PER_PAGE = 256;
-/// Amount of bits in a uint32.
-static constexpr std::uint32_t BITS_PER_UINT = sizeof(std::uint32_t) * 8;
-
-
-//=============================================================================
-// Globals
+/// Load flags for reading the advances. The same hinting as for the glyph images, since the
+/// hinter may widen or narrow a glyph.
+static constexpr FT_Int32 ADVANCE_LOAD_FLAGS = FT_LOAD_DEFAULT | FT_LOAD_FORCE_AUTOHINT;
+/// Load flags for rendering the glyph images. Measuring a glyph loads it the same way, which gives
+/// the hinted bounding box of its image.
+static constexpr FT_Int32 RENDER_LOAD_FLAGS = FT_LOAD_NO_BITMAP | FT_LOAD_FORCE_AUTOHINT;
+/// Texture id of glyphs which have not been rasterized yet.
+static constexpr std::uint32_t NOT_RASTERIZED = 0xFFFFFFFF;
+/// Extent of glyphs which have not been measured yet.
+static constexpr float NOT_MEASURED = -1.0e30f;
+/// Minimum number of new glyphs per thread before rasterizing is split across the glyph workers.
+static constexpr std::uint32_t MIN_GLYPHS_PER_JOB = 4;
+/// Version of the glyph images in the glyph cache. Must be increased whenever renderGlyph renders
+/// different images, so the caches of earlier versions aren't used.
+static constexpr std::uint32_t RASTERIZER_VERSION = 1;
+/// Distance in pixels of the reference size covered by a distance field on each side of an edge.
+/// Limits the outline width and shadow softness at the reference size.
+static constexpr std::int32_t DISTANCE_FIELD_SPREAD = 8;
+
+/// Packs threshold and smoothing of a distance field into a colorkey, see SpriteDrawer::SetDistanceField.
+static std::uint32_t DistanceFieldParams(float threshold, float smoothing)
+{
+	const std::uint32_t t = static_cast<std::uint32_t>(std::min(1.0f, std::max(0.0f, threshold)) * 255.0f + 0.5f);
+	const std::uint32_t s = static_cast<std::uint32_t>(std::min(1.0f, std::max(1.0f / 255.0f, smoothing)) * 255.0f + 0.5f);
+	return t | (s << 8);
+}
 
-/// FreeType library handle.
-static FT_Library s_freeTypeLib;
-/// Usage counter of free type library handle.
-static std::atomic<std::int32_t> s_freeTypeUsageCount = 0;
+/// Rounds a value to whole pixels.
+#define PixelAligned(x)	( (float)(int)(( x ) + (( x ) > 0.0f ? 0.5f : -0.5f)) )
 
 
 namespace Kyo2D
 {
+	const std::uint32_t Font::InvalidGlyph;
+
 	Font::Font()
-		: m_pointSize(0.0f)
+		: m_size(nullptr)
+		, m_pointSize(0.0f)
+		, m_charSize(0)
+		, m_charResolution(0)
 		, m_ascender(0)
 		, m_descender(0)
 		, m_height(0)
-		, m_maxCodepoint(0)
 		, m_outlineWidth(0.0f)
+		, m_distanceField(false)
+		, m_imagePadding(0.0f)
+		, m_atlasGeneration(0)
 	{
-		// Initializes the free type library if not already done and also increase
-		// the reference counter.
-		if (!s_freeTypeUsageCount++)
-			FT_Init_FreeType(&s_freeTypeLib);
 	}
 
 	Font::~Font()
 	{
-		// Unload font face now before we eventually dispose the freetype library
-		m_fontFace.reset();
-
-		// Release freetype library handle if all using fonts are deleted
-		if (!--s_freeTypeUsageCount)
-			FT_Done_FreeType(s_freeTypeLib);
+		// The contexts and the size use the face of the family, which may outlive the font
+		m_rasterContexts.clear();
+		if (m_size)
+			FT_Done_Size(m_size);
 	}
 
-	bool Font::Initialize(const void * data, size_t dataSize, float pointSize, float outline)
+	bool Font::Initialize(const void * data, size_t dataSize, float pointSize, float outline, bool distanceField)
 	{
-		// We need to keep the memory as long as we want to be able to rasterize
-		// font glyphs, so we will copy the memory from the source area
-		m_fileData.resize(dataSize, 0);
-		memcpy(&m_fileData[0], data, dataSize);
+		// A family of its own, which keeps a copy of the memory as long as glyphs are rasterized
+		auto family = std::make_shared<FontFamily>();
+		if (!family->Initialize(data, dataSize))
+			return false;
 
-		// Apply point size
-		m_pointSize = pointSize;
-		m_outlineWidth = outline;
+		return Initialize(std::move(family), pointSize, outline, distanceField);
+	}
 
-		// Negative outline size is not supported!
-		if (m_outlineWidth < 0.0f) m_outlineWidth = 0.0f;
+	bool Font::Initialize(const std::wstring & filename, float pointSize, float outline, bool distanceField)
+	{
+		auto family = std::make_shared<FontFamily>();
+		if (!family->Initialize(filename))
+			return false;
 
-		// Now initialize the font
-		return initializeInternal();
+		return Initialize(std::move(family), pointSize, outline, distanceField);
 	}
 
-	bool Font::Initialize(const std::wstring & filename, float pointSize, float outline)
+	bool Font::Initialize(std::shared_ptr<FontFamily> family, float pointSize, float outline, bool distanceField)
 	{
-		// Read file contents
-		if (!readFileContents(filename, m_fileData))
+		if (!family || !family->GetFace() || m_family)
 			return false;
 
+		m_family = std::move(family);
+
 		// Apply point size
 		m_pointSize = pointSize;
 		m_outlineWidth = outline;
@@ -84,40 +110,43 @@ namespace Kyo2D
 		// Negative outline size is not supported!
 		if (m_outlineWidth < 0.0f) m_outlineWidth = 0.0f;
 
+		// Distance field fonts draw their outline from the field
+		m_distanceField = distanceField;
+		if (m_distanceField) m_outlineWidth = 0.0f;
+
 		// Now initialize the font
-		return initializeInternal();
+		return initializeSize();
 	}
 
-	bool Font::initializeInternal()
+	bool Font::initializeSize()
 	{
-		// Save error code
-		FT_Error error;
-
-		// Initialize memory face
-		FT_Face tmpFace = nullptr;
-		if ((error = FT_New_Memory_Face(s_freeTypeLib, m_fileData.data(), static_cast<FT_Long>(m_fileData.size()), 0, &tmpFace)) != 0)
-			return false;
+		m_imagePadding = m_distanceField ? static_cast<float>(DISTANCE_FIELD_SPREAD) : 0.0f;
+		m_rasterContexts.clear();
 
-		// Initialize smart pointer to automatically free the font if needed
-		m_fontFace.reset(tmpFace);
-
-		// Check that the default unicode character map is available
-		if (!m_fontFace->charmap)
+		// The size is a view of the shared face with its own scale and hinting state
+		FT_Face face = m_family->GetFace();
+		if (FT_New_Size(face, &m_size))
+		{
+			m_size = nullptr;
 			return false;
+		}
+		activateSize();
 
 		// Initialize the character size
 		const std::int32_t dpi = 96;
 		const float pointSize64 = m_pointSize * 64.0f;
-		if (FT_Set_Char_Size(m_fontFace.get(), FT_F26Dot6(pointSize64), FT_F26Dot6(pointSize64), dpi, dpi))
+		m_charSize = FT_F26Dot6(pointSize64);
+		m_charResolution = dpi;
+		if (FT_Set_Char_Size(face, m_charSize, m_charSize, m_charResolution, m_charResolution))
 		{
 			// For bitmap fonts we can render only at specific point sizes.
 			// Try to find nearest point size and use it, if that is possible
 			const float pointSize72 = (m_pointSize * 72.0f) / dpi;
 			float bestDelta = 99999.0f;
 			float bestSize = 0.0f;
-			for (int i = 0; i < m_fontFace->num_fixed_sizes; ++i)
+			for (int i = 0; i < face->num_fixed_sizes; ++i)
 			{
-				float size = m_fontFace->available_sizes[i].size * FT_POS_COEF;
+				float size = face->available_sizes[i].size * FT_POS_COEF;
 				float delta = ::fabs(size - pointSize72);
 				if (delta < bestDelta)
 				{
@@ -127,143 +156,179 @@ namespace Kyo2D
 			}
 
 			// Check if we found a valid size and try to apply it
+			m_charSize = FT_F26Dot6(bestSize * 64.0f);
+			m_charResolution = 0;
 			if ((bestSize <= 0.0f) ||
-				FT_Set_Char_Size(m_fontFace.get(), 0, FT_F26Dot6(bestSize * 64.0f), 0, 0))
+				FT_Set_Char_Size(face, 0, m_charSize, m_charResolution, m_charResolution))
 				return false;
 		}
 
 		// We have the font size set up, get some informations
-		if (m_fontFace->face_flags & FT_FACE_FLAG_SCALABLE)
+		if (face->face_flags & FT_FACE_FLAG_SCALABLE)
 		{
-			const float yScale = m_fontFace->size->metrics.y_scale * FT_POS_COEF * (1.0f / 65536.0f);
-			m_ascender = m_fontFace->ascender * yScale;
-			m_descender = m_fontFace->descender * yScale;
-			m_height = m_fontFace->height * yScale;
+			const float yScale = face->size->metrics.y_scale * FT_POS_COEF * (1.0f / 65536.0f);
+			m_ascender = face->ascender * yScale;
+			m_descender = face->descender * yScale;
+			m_height = face->height * yScale;
 		}
 		else
 		{
-			m_ascender = m_fontFace->size->metrics.ascender * FT_POS_COEF;
-			m_descender = m_fontFace->size->metrics.descender * FT_POS_COEF;
-			m_height = m_fontFace->size->metrics.height * FT_POS_COEF;
+			m_ascender = face->size->metrics.ascender * FT_POS_COEF;
+			m_descender = face->size->metrics.descender * FT_POS_COEF;
+			m_height = face->size->metrics.height * FT_POS_COEF;
 		}
 
-		// Create an empty FontGlyph structure for every glyph of the font
-		FT_UInt glyphIndex;
-		FT_ULong codepoint = FT_Get_First_Char(m_fontFace.get(), &glyphIndex);
-		FT_ULong maxCodepoint = codepoint;
-		while (glyphIndex)
+		// The glyph table is shared, the metrics and images of this size are loaded when a
+		// glyph is used for the first time
+		const std::uint32_t count = m_family->GetGlyphCount();
+		m_glyphAdvances.assign(count, 0.0f);
+		m_glyphExtents.assign(count, NOT_MEASURED);
+		m_glyphAreas.assign(count, RectF());
+		m_glyphOffsets.assign(count, Vector2());
+		m_glyphTextures.assign(count, NOT_RASTERIZED);
+		m_glyphHandles.assign(count, GlyphAtlas::Handle());
+		m_glyphAdvancesLoaded.assign((count + GLYPHS_PER_PAGE - 1) / GLYPHS_PER_PAGE, false);
+
+		m_atlasGeneration = g_Context->Glyphs.GetGeneration();
+
+		// Glyph images of earlier runs with the same font file, size and outline
+		m_glyphCache.reset();
+		if (!g_Context->GlyphCacheDirectory.empty())
 		{
-			if (maxCodepoint < codepoint)
-				maxCodepoint = codepoint;
-
-			// Load-up required glyph metrics
-			if (FT_Load_Char(m_fontFace.get(), codepoint, FT_LOAD_DEFAULT | FT_LOAD_FORCE_AUTOHINT))
-				continue; // Glyph error
-
-						  // Create a new empty FontGlyph with given character code
-			const float advance = m_fontFace->glyph->metrics.horiAdvance * FT_POS_COEF;
-			m_glyphMap[codepoint] = FontGlyph(advance);
-
-			// Proceed to next glyph
-			codepoint = FT_Get_Next_Char(m_fontFace.get(), codepoint, &glyphIndex);
+			GlyphCache::Key key = {};
+			key.FontHash = m_family->GetContentHash();
+			key.PointSize = m_pointSize;
+			key.Outline = m_outlineWidth;
+			key.Flags = m_distanceField ? 1 : 0;
+			key.RasterizerVersion = RASTERIZER_VERSION;
+
+			m_glyphCache.reset(new GlyphCache());
+			if (m_glyphCache->Open(g_Context->GlyphCacheDirectory, key))
+				loadCachedMetrics();
 		}
 
-		// Update the amount of code points
-		setMaxCodepoint(maxCodepoint);
 		return true;
 	}
 
-	std::uint32_t Font::getTextureSize(GlyphMap::const_iterator start, GlyphMap::const_iterator end) const
+	FT_Face Font::activateSize() const
 	{
-		/// A texture may only grow up to a 4k texture
-		const std::uint32_t maxTexsize = 4096;
+		FT_Face face = m_family->GetFace();
+		if (face->size != m_size)
+			FT_Activate_Size(m_size);
+		return face;
+	}
 
-		// Start with 32x32 pixel texture
-		std::uint32_t texSize = 32;
-		std::uint32_t glyphCount = 0;
+	void Font::loadAdvances(std::uint32_t glyph)
+	{
+		const std::uint32_t chunk = glyph / GLYPHS_PER_PAGE;
+		if (m_glyphAdvancesLoaded[chunk])
+			return;
 
-		while (texSize < maxTexsize)
+		K2D_PROFILE_SCOPE(g_Context->Profiler, "Font::loadAdvances");
+		m_glyphAdvancesLoaded[chunk] = true;
+
+		// Glyph indices often grow along with the codepoints, each run of consecutive indices
+		// is fetched with one call. FreeType reads the advances from the metrics tables without
+		// loading the glyphs where the load flags allow it.
+		const std::uint32_t first = chunk * GLYPHS_PER_PAGE;
+		const std::uint32_t last = std::min<std::uint32_t>(first + GLYPHS_PER_PAGE, m_family->GetGlyphCount());
+		const FontFamily &family = *m_family;
+		FT_Face face = activateSize();
+		FT_Fixed advances[GLYPHS_PER_PAGE];
+		for (std::uint32_t start = first; start < last; )
 		{
-			std::uint32_t x = INTER_GLYPH_PAD_SPACE, y = INTER_GLYPH_PAD_SPACE;
-			std::uint32_t yb = INTER_GLYPH_PAD_SPACE;
+			std::uint32_t end = start + 1;
+			while (end < last && family.GetGlyphIndex(end) == family.GetGlyphIndex(end - 1) + 1)
+				++end;
 
-			bool isTooSmall = false;
-			for (GlyphMap::const_iterator c = start; c != end; ++c)
-			{
-				// Skip glpyhs that are already rendered
-				if (c->second.getImage())
-					continue;	// Already rendered
+			if (FT_Get_Advances(face, family.GetGlyphIndex(start), end - start, ADVANCE_LOAD_FLAGS, advances))
+				std::fill(advances, advances + (end - start), 0);
 
-								// Load glyph metrics
-				if (FT_Load_Char(m_fontFace.get(), c->first, FT_LOAD_DEFAULT | FT_LOAD_FORCE_AUTOHINT))
-					continue;	// Could not load glyph metrics, skip it!
+			for (std::uint32_t i = start; i < end; ++i)
+				m_glyphAdvances[i] = advances[i - start] * (1.0f / 65536.0f);
 
-				// Calculate the glyph size in pixels
-				const std::uint32_t glyphW = static_cast<std::uint32_t>(::ceil(m_fontFace->glyph->metrics.width * FT_POS_COEF)) + INTER_GLYPH_PAD_SPACE;
-				const std::uint32_t glyphH = static_cast<std::uint32_t>(::ceil(m_fontFace->glyph->metrics.height * FT_POS_COEF)) + INTER_GLYPH_PAD_SPACE;
+			start = end;
+		}
+	}
 
-				// Adjust the offset
-				x += glyphW;
-				if (x > texSize)
-				{
-					x = INTER_GLYPH_PAD_SPACE;
-					y = yb;
-				}
+	void Font::loadExtent(std::uint32_t glyph)
+	{
+		if (m_glyphExtents[glyph] != NOT_MEASURED)
+			return;
 
-				std::uint32_t yy = y + glyphH;
-				if (yy > texSize)
-					isTooSmall = true;
+		// Loading the hinted outline is enough for its bounding box. The image of a glyph covers
+		// the pixels touched by the box, widened by the outline on both sides.
+		float extent = 0.0f;
+		FT_Face face = activateSize();
+		if (FT_Load_Glyph(face, m_family->GetGlyphIndex(glyph), RENDER_LOAD_FLAGS) == 0 && face->glyph->outline.n_points > 0)
+		{
+			FT_BBox box;
+			FT_Outline_Get_CBox(&face->glyph->outline, &box);
+			const float left = std::floor(box.xMin * FT_POS_COEF - m_outlineWidth);
+			const float right = std::ceil(box.xMax * FT_POS_COEF + m_outlineWidth);
+			extent = PixelAligned(face->glyph->metrics.horiBearingX * FT_POS_COEF) + GLYPH_OFFSET_X + (right - left);
+		}
 
-				if (yy > yb)
-					yb = yy;
+		m_glyphExtents[glyph] = extent;
+	}
 
-				++glyphCount;
-			}
+	void Font::loadCachedMetrics()
+	{
+		// The advances of all glyphs followed by their extents, the advances of chunks which
+		// weren't loaded are marked like unmeasured extents
+		const std::uint32_t count = m_family->GetGlyphCount();
+		const float *metrics;
+		if (m_glyphCache->GetMetrics(metrics) != 2 * count)
+			return;
 
-			// The texture size is enough for holding our glyphs
-			if (!isTooSmall)
-				break;
+		for (std::uint32_t chunk = 0; chunk < m_glyphAdvancesLoaded.size(); ++chunk)
+		{
+			const std::uint32_t first = chunk * GLYPHS_PER_PAGE;
+			const std::uint32_t last = std::min<std::uint32_t>(first + GLYPHS_PER_PAGE, count);
+			if (metrics[first] == NOT_MEASURED)
+				continue;
 
-			// Double the texture size because it's too small
-			texSize *= 2;
+			std::copy(metrics + first, metrics + last, m_glyphAdvances.begin() + first);
+			m_glyphAdvancesLoaded[chunk] = true;
 		}
 
-		return glyphCount ? texSize : 0;
+		std::copy(metrics + count, metrics + 2 * count, m_glyphExtents.begin());
 	}
 
-	void Font::setMaxCodepoint(std::uint32_t codepoint)
+	bool Font::saveGlyphCache()
 	{
-		m_maxCodepoint = codepoint;
+		if (!m_glyphCache)
+			return true;
 
-		// Resize the glyph page map
-		const std::uint32_t pageCount = (codepoint + GLYPHS_PER_PAGE) / GLYPHS_PER_PAGE;
-		const std::uint32_t size = (pageCount + BITS_PER_UINT - 1) / BITS_PER_UINT;
-		m_glyphPageLoaded.resize(size, 0);
+		cacheMetrics();
+		return m_glyphCache->Save();
 	}
 
-#pragma pack(push, 1)
-	struct TGAHeader
+	void Font::cacheMetrics()
 	{
-		std::uint8_t	IDLength;
-		std::uint8_t	ColorMapType;
-		std::uint8_t	DataTypeCode;
-		std::uint16_t	wColorMapOrigin;
-		std::uint16_t	wColorMapLength;
-		std::uint8_t	ColorMapDepth;
-		std::uint16_t	wOriginX;
-		std::uint16_t	wOriginY;
-		std::uint16_t	wWidth;
-		std::uint16_t	wHeight;
-		std::uint8_t	BitDepth;
-		std::uint8_t	ImageDescriptor;
-	};
-#pragma pack(pop)
+		const std::uint32_t count = m_family->GetGlyphCount();
+		std::vector<float> metrics(2 * static_cast<size_t>(count), NOT_MEASURED);
+		for (std::uint32_t chunk = 0; chunk < m_glyphAdvancesLoaded.size(); ++chunk)
+		{
+			const std::uint32_t first = chunk * GLYPHS_PER_PAGE;
+			const std::uint32_t last = std::min<std::uint32_t>(first + GLYPHS_PER_PAGE, count);
+			if (m_glyphAdvancesLoaded[chunk])
+				std::copy(m_glyphAdvances.begin() + first, m_glyphAdvances.begin() + last, metrics.begin() + first);
+		}
+
+		std::copy(m_glyphExtents.begin(), m_glyphExtents.end(), metrics.begin() + count);
+		m_glyphCache->SetMetrics(std::move(metrics));
+	}
 
 	void Font::rasterCallback(const int y, const int count, const FT_Span * const spans, void * const user)
 	{
+		// The buffer of the raster context keeps its capacity, so it grows only for the first glyphs
 		Spans *sptr = (Spans *)user;
+		const size_t first = sptr->size();
+		sptr->resize(first + count);
+		Span *out = sptr->data() + first;
 		for (int i = 0; i < count; ++i)
-			sptr->push_back(Span(spans[i].x, y, spans[i].len, spans[i].coverage));
+			out[i] = Span(spans[i].x, y, spans[i].len, spans[i].coverage);
 	}
 
 	void Font::renderSpans(FT_Library &library, FT_Outline * const outline, Font::Spans *spans)
@@ -277,338 +342,602 @@ namespace Kyo2D
 		FT_Outline_Render(library, outline, &params);
 	}
 
-	void Font::rasterize(std::uint32_t startCodepoint, std::uint32_t endCodepoint)
+	Font::RasterContext::RasterContext()
+		: Library(nullptr)
+		, Face(nullptr)
+		, Stroker(nullptr)
+		, Owned(false)
 	{
-		GlyphMap::const_iterator start = m_glyphMap.lower_bound(startCodepoint);
-		if (start == m_glyphMap.end())
-			return;
+	}
+
+	Font::RasterContext::~RasterContext()
+	{
+		// The stroker belongs to the library
+		if (Stroker)
+			FT_Stroker_Done(Stroker);
+
+		if (Owned)
+		{
+			if (Face)
+				FT_Done_Face(Face);
+			if (Library)
+				FT_Done_FreeType(Library);
+		}
+	}
 
-		GlyphMap::const_iterator origStart = start;
-		GlyphMap::const_iterator end = m_glyphMap.upper_bound(endCodepoint);
-		while (true)
-		{
-			// Create a new imageset for glyphs, so calculate how much texture size we will need
-			std::uint32_t texSize = getTextureSize(start, end);
-			if (!texSize)
-				break;	// If all glyphs were already rendered, do nothing
-
-			// Create the imageset
-			m_imageSets.emplace_back(FontImageset());
-			FontImageset* imageSet = &m_imageSets.back();
-
-			// Create a memory buffer where the glyphs will be rendered and initialize it to 0
-			std::vector<std::uint32_t> mem;
-			mem.resize(texSize * texSize, 0);
-
-			// Go ahead, line by line, top-left to bottom-right
-			std::uint32_t x = INTER_GLYPH_PAD_SPACE, y = INTER_GLYPH_PAD_SPACE;
-			std::uint32_t yb = INTER_GLYPH_PAD_SPACE;
-
-			// Set to true when we finish rendering all glyphs we were asked to
-			bool finished = false;
-			// Set to false when we reach m_glyphMap.end() and we start going backward
-			bool forward = true;
-
-			// To converve texture space we will render more glyphs than asked, but never
-			// less than asked. First we render all glyphs from start to end.
-			// After that, we render glyphs until we reach m_glyphMap.end(), and if there
-			// is still free texture space we will go backward from start, until we hit 
-			// m_glyphMap.begin()
-			while (start != m_glyphMap.end())
+	bool Font::createRasterContexts(std::uint32_t count)
+	{
+		// The first context rasterizes with the face of the font
+		if (m_rasterContexts.empty())
+		{
+			std::unique_ptr<RasterContext> context(new RasterContext());
+			context->Library = m_family->GetLibrary();
+			context->Face = m_family->GetFace();
+			m_rasterContexts.push_back(std::move(context));
+		}
+
+		// The others get a library and a face of their own over the shared file data
+		while (m_rasterContexts.size() < count)
+		{
+			std::unique_ptr<RasterContext> context(new RasterContext());
+			context->Owned = true;
+			if (FT_Init_FreeType(&context->Library) ||
+				FT_New_Memory_Face(context->Library, m_family->GetFileData().data(), static_cast<FT_Long>(m_family->GetFileData().size()), 0, &context->Face) ||
+				FT_Set_Char_Size(context->Face, 0, m_charSize, m_charResolution, m_charResolution))
+				return false;
+
+			m_rasterContexts.push_back(std::move(context));
+		}
+
+		return true;
+	}
+
+	bool Font::renderGlyph(RasterContext &context, std::uint32_t glyph, WorkerPool *workers, GlyphImage &out_image) const
+	{
+		out_image.Width = 0;
+		out_image.Height = 0;
+
+		// The face of the family is shared with the other sizes
+		if (!context.Owned)
+			activateSize();
+
+		if (FT_Load_Glyph(context.Face, m_family->GetGlyphIndex(glyph), RENDER_LOAD_FLAGS))
+			return false;
+
+		out_image.BearingX = context.Face->glyph->metrics.horiBearingX * FT_POS_COEF;
+		out_image.BearingY = context.Face->glyph->metrics.horiBearingY * FT_POS_COEF;
+
+		// Render normal glyph spans
+		Spans &spans = context.GlyphSpans;
+		spans.clear();
+		renderSpans(context.Library, &context.Face->glyph->outline, &spans);
+		if (spans.empty())
+			return false;
+
+		// Next we need the spans for the outline.
+		Spans &outlineSpans = context.OutlineSpans;
+		outlineSpans.clear();
+		if (m_outlineWidth > 0.0f)
+		{
+			// The stroker is kept for the following glyphs
+			if (!context.Stroker)
 			{
-				// Check if we finished rendering all the required glyphs
-				finished |= (start == end);
+				FT_Stroker_New(context.Library, &context.Stroker);
+				FT_Stroker_Set(context.Stroker, (int)(m_outlineWidth * 64.0f), FT_STROKER_LINECAP_ROUND, FT_STROKER_LINEJOIN_ROUND, 0);
+			}
 
-				// Check if glyph already rendered
-				if (!start->second.getImage())
+			FT_Glyph ftGlyph;
+			if (FT_Get_Glyph(context.Face->glyph, &ftGlyph) == 0)
+			{
+				FT_Glyph_StrokeBorder(&ftGlyph, context.Stroker, 0, 1);
+				// Again, this needs to be an outline to work.
+				if (ftGlyph->format == FT_GLYPH_FORMAT_OUTLINE)
 				{
-					// Render the glyph
-					if (FT_Load_Char(m_fontFace.get(), start->first, FT_LOAD_NO_BITMAP | FT_LOAD_FORCE_AUTOHINT/* | FT_LOAD_TARGET_NORMAL*/))
-					{
-						// Error while rendering the glyph - use an empty image for this glyph!
-						RectF area;
-						Vector2 offset;
-						FontImage& image = imageSet->defineImage(area, offset);
-						((FontGlyph&)start->second).setImage(&image);
-					}
-					else
-					{
-						// Render normal glyph spans
-						Spans spans;
-						renderSpans(s_freeTypeLib, &m_fontFace->glyph->outline, &spans);
-
-						// Next we need the spans for the outline.
-						Spans outlineSpans;
-						if (m_outlineWidth > 0.0f)
-						{
-							FT_Stroker stroker;
-							FT_Stroker_New(s_freeTypeLib, &stroker);
-							FT_Stroker_Set(stroker, (int)(m_outlineWidth * 64.0f), FT_STROKER_LINECAP_ROUND, FT_STROKER_LINEJOIN_ROUND, 0);
-
-							FT_Glyph glyph;
-							if (FT_Get_Glyph(m_fontFace->glyph, &glyph) == 0)
-							{
-								FT_Glyph_StrokeBorder(&glyph, stroker, 0, 1);
-								// Again, this needs to be an outline to work.
-								if (glyph->format == FT_GLYPH_FORMAT_OUTLINE)
-								{
-									// Render the outline spans to the span list
-									FT_Outline *o =
-										&reinterpret_cast<FT_OutlineGlyph>(glyph)->outline;
-									renderSpans(s_freeTypeLib, o, &outlineSpans);
-								}
-
-								// Clean up afterwards.
-								FT_Stroker_Done(stroker);
-								FT_Done_Glyph(glyph);
-							}
-						}
-
-						// Now we need to put it all together.
-						if (spans.empty())
-						{
-							// Error while rendering the glyph - use an empty image for this glyph!
-							RectF area;
-							Vector2 offset;
-							FontImage& image = imageSet->defineImage(area, offset);
-							((FontGlyph&)start->second).setImage(&image);
-						}
-						else
-						{
-							// Calculate glyph bounds
-							int minX = spans.front().x;
-							int maxX = minX;
-							int minY = spans.front().y;
-							int maxY = minY;
-							for (const auto& span : spans)
-							{
-								if (span.x < minX) minX = span.x;
-								if (span.y < minY) minY = span.y;
-								if (span.y > maxY) maxY = span.y;
-								if (span.x + span.width > maxX) maxX = span.x + span.width;
-							}
-							for (const auto& span : outlineSpans)
-							{
-								if (span.x < minX) minX = span.x;
-								if (span.y < minY) minY = span.y;
-								if (span.y > maxY) maxY = span.y;
-								if (span.x + span.width > maxX) maxX = span.x + span.width;
-							}
-
-							// Shortcut for glyph size
-							const std::int32_t glyphW = (int)(maxX - minX) + INTER_GLYPH_PAD_SPACE;
-							const std::int32_t glyphH = (int)(maxY - minY) + INTER_GLYPH_PAD_SPACE;
-
-							// Check if glyph right margin does not exceed texture size
-							std::uint32_t xNext = x + glyphW;
-							if (xNext > texSize)
-							{
-								x = INTER_GLYPH_PAD_SPACE;
-								xNext = x + glyphW;
-								y = yb;
-							}
-
-							// Check if glyph bottom margin does not exceed texture size
-							std::uint32_t yBot = y + glyphH;
-							if (yBot > texSize)
-								break;
-
-							if (m_outlineWidth > 0.0f)
-							{
-								// Loop over the outline spans and just draw them into the image.
-								for (Spans::iterator s = outlineSpans.begin(); s != outlineSpans.end(); ++s)
-								{
-									const int bufferX = (int)x + (s->x - minX) + s->width;
-									const int bufferY = (int)((int)y + (int)glyphH - (s->y - minY));
-									if (bufferX < static_cast<std::int32_t>(texSize) && bufferY >= 0 && bufferX - s->width >= 0 && bufferY < static_cast<std::int32_t>(texSize))
-									{
-										std::uint32_t* buffer = mem.data() + bufferY * static_cast<std::int32_t>(texSize) + bufferX;
-										for (int w = 0; w < s->width; ++w)
-										{
-											*buffer-- = Pixel32(0, 0, 0, s->coverage).integer;
-										}
-									}
-								}
-
-								// Then loop over the regular glyph spans and blend them into the image.
-								for (Spans::iterator s = spans.begin(); s != spans.end(); ++s)
-								{
-									const int bufferX = (int)x + (s->x - minX) + s->width;
-									const int bufferY = (int)((int)y + (int)glyphH - (s->y - minY));
-									if (bufferX < static_cast<std::int32_t>(texSize) && bufferY >= 0 && bufferX - s->width >= 0 && bufferY < static_cast<std::int32_t>(texSize))
-									{
-										std::uint32_t* buffer = mem.data() + bufferY * static_cast<std::int32_t>(texSize) + bufferX;
-
-										for (int w = 0; w < s->width; ++w)
-										{
-											Pixel32 &dst = (Pixel32&)*buffer--;
-											Pixel32 src = Pixel32(255, 255, 255, s->coverage);
-											dst.r = (int)(dst.r + ((src.r - dst.r) * src.a) / 255.0f);
-											dst.g = (int)(dst.g + ((src.g - dst.g) * src.a) / 255.0f);
-											dst.b = (int)(dst.b + ((src.b - dst.b) * src.a) / 255.0f);
-											dst.a = std::min(255, dst.a + src.a);
-										}
-									}
-								}
-							}
-							else
-							{
-								// No outline, just render the spans
-								for (Spans::iterator s = spans.begin(); s != spans.end(); ++s)
-								{
-									const int bufferX = (int)x + (s->x - minX) + s->width;
-									const int bufferY = (int)((int)y + (int)glyphH - (s->y - minY));
-									if (bufferX < static_cast<std::int32_t>(texSize) && bufferY >= 0 && bufferX - s->width >= 0 && bufferY < static_cast<std::int32_t>(texSize))
-									{
-										std::uint32_t* buffer = mem.data() + bufferY * static_cast<std::int32_t>(texSize) + bufferX;
-										for (int w = 0; w < s->width; ++w)
-										{
-											*buffer-- = Pixel32(255, 255, 255, s->coverage).integer;
-										}
-									}
-								}
-							}
-
-							RectF area(
-								static_cast<float>(x),
-								static_cast<float>(y),
-								static_cast<float>(glyphW - minX),
-								static_cast<float>(glyphH - minY + INTER_GLYPH_PAD_SPACE));
-							Vector2 offset(
-								m_fontFace->glyph->metrics.horiBearingX * FT_POS_COEF,
-								-m_fontFace->glyph->metrics.horiBearingY * FT_POS_COEF + m_descender);
-							
-							FontImage& image = imageSet->defineImage(area, offset);
-							((FontGlyph&)start->second).setImage(&image);
-
-							// Advance to next position
-							x = xNext;
-							if (yBot > yb)
-							{
-								yb = yBot;
-							}
-						}
-					}
+					// Render the outline spans to the span list
+					FT_Outline *o =
+						&reinterpret_cast<FT_OutlineGlyph>(ftGlyph)->outline;
+					renderSpans(context.Library, o, &outlineSpans);
 				}
 
-				// Go to next glyph if we are going forward
-				if (forward)
-				{
-					if (++start == m_glyphMap.end())
-					{
-						finished = true;
-						forward = false;
-						start = origStart;
-					}
-				}
+				FT_Done_Glyph(ftGlyph);
+			}
+		}
 
-				// Go to previous glyph if we are going backward
-				if (!forward)
-				{
-					if ((start == m_glyphMap.begin()) || (--start == m_glyphMap.end()))
-						break;
-				}
+		// Calculate glyph bounds
+		int minX = spans.front().x;
+		int maxX = minX;
+		int minY = spans.front().y;
+		int maxY = minY;
+		for (const auto& span : spans)
+		{
+			if (span.x < minX) minX = span.x;
+			if (span.y < minY) minY = span.y;
+			if (span.y > maxY) maxY = span.y;
+			if (span.x + span.width > maxX) maxX = span.x + span.width;
+		}
+		for (const auto& span : outlineSpans)
+		{
+			if (span.x < minX) minX = span.x;
+			if (span.y < minY) minY = span.y;
+			if (span.y > maxY) maxY = span.y;
+			if (span.x + span.width > maxX) maxX = span.x + span.width;
+		}
+
+		// The image is cropped to the bounds, span rows run bottom to top
+		const std::int32_t glyphW = maxX - minX;
+		const std::int32_t glyphH = maxY - minY + 1;
+		if (m_distanceField)
+		{
+			// The coverage gets an empty border, so the field can fade out around the glyph
+			const std::int32_t pad = DISTANCE_FIELD_SPREAD;
+			const std::int32_t fieldW = glyphW + 2 * pad;
+			const std::int32_t fieldH = glyphH + 2 * pad;
+			std::vector<std::uint8_t> coverage(static_cast<size_t>(fieldW) * static_cast<size_t>(fieldH), 0);
+			const SpanCompositor::Target field = { fieldW, minX - pad, maxY + pad };
+			SpanCompositor::FillCoverage(field, spans, coverage.data());
+
+			out_image.Alpha.resize(coverage.size());
+			DistanceField::Generate(coverage.data(), fieldW, fieldH, static_cast<float>(DISTANCE_FIELD_SPREAD), workers, out_image.Alpha.data());
+			out_image.Width = fieldW;
+			out_image.Height = fieldH;
+			return true;
+		}
+
+		out_image.Width = glyphW;
+		out_image.Height = glyphH;
+		const SpanCompositor::Target target = { glyphW, minX, maxY };
+		if (m_outlineWidth <= 0.0f)
+		{
+			// Without outline the glyph is white, so the coverage alone is enough
+			out_image.Alpha.assign(static_cast<size_t>(glyphW) * static_cast<size_t>(glyphH), 0);
+			SpanCompositor::FillCoverage(target, spans, out_image.Alpha.data());
+			return true;
+		}
+
+		// A black outline with the white glyph blended over it
+		out_image.Pixels.assign(static_cast<size_t>(glyphW) * static_cast<size_t>(glyphH), 0);
+		SpanCompositor::FillColor(target, outlineSpans, 0, out_image.Pixels.data());
+		SpanCompositor::BlendWhite(target, spans, out_image.Pixels.data());
+		return true;
+	}
+
+	void Font::storeGlyph(std::uint32_t glyph, const GlyphImage &image)
+	{
+		// Glyphs that fail to render get no image
+		m_glyphTextures[glyph] = 0;
+		if (image.Width <= 0 || image.Height <= 0)
+			return;
+
+		// Store the image in the shared atlas
+		GlyphAtlas::Region region;
+		const bool stored = m_distanceField ?
+			g_Context->Glyphs.InsertDistanceField(image.Width, image.Height, image.Alpha.data(), region) :
+			image.Pixels.empty() ?
+				g_Context->Glyphs.Insert(image.Width, image.Height, image.Alpha.data(), region) :
+				g_Context->Glyphs.Insert(image.Width, image.Height, image.Pixels.data(), region);
+		if (!stored)
+			return;
+
+		m_glyphAreas[glyph] = RectF(
+			static_cast<float>(region.X),
+			static_cast<float>(region.Y),
+			static_cast<float>(image.Width),
+			static_cast<float>(image.Height));
+		m_glyphOffsets[glyph] = Vector2(
+			PixelAligned(image.BearingX) + GLYPH_OFFSET_X - m_imagePadding,
+			PixelAligned(-image.BearingY + m_descender) + GLYPH_OFFSET_Y - m_imagePadding);
+		m_glyphTextures[glyph] = region.TextureId;
+		m_glyphHandles[glyph] = region.Glyph;
+	}
+
+	bool Font::loadCachedGlyph(std::uint32_t glyph, GlyphImage &out_image) const
+	{
+		GlyphCache::Glyph cached;
+		if (!m_glyphCache || !m_glyphCache->Find(glyph, cached))
+			return false;
+
+		out_image.Width = 0;
+		out_image.Height = 0;
+		out_image.BearingX = cached.BearingX;
+		out_image.BearingY = cached.BearingY;
+
+		const size_t pixels = static_cast<size_t>(cached.Width) * static_cast<size_t>(cached.Height);
+		switch (cached.Format)
+		{
+		case GlyphCache::image_format::Alpha:
+		{
+			const std::uint8_t *alpha = static_cast<const std::uint8_t*>(cached.Data);
+			out_image.Alpha.assign(alpha, alpha + pixels);
+			break;
+		}
+		case GlyphCache::image_format::Pixels:
+		{
+			const std::uint32_t *colors = static_cast<const std::uint32_t*>(cached.Data);
+			out_image.Pixels.assign(colors, colors + pixels);
+			break;
+		}
+		default:
+			// The glyph has no image
+			return true;
+		}
+
+		out_image.Width = cached.Width;
+		out_image.Height = cached.Height;
+		return true;
+	}
+
+	void Font::cacheGlyph(std::uint32_t glyph, const GlyphImage &image)
+	{
+		if (!m_glyphCache)
+			return;
+
+		GlyphCache::Glyph cached = {};
+		if (image.Width > 0 && image.Height > 0)
+		{
+			cached.Width = image.Width;
+			cached.Height = image.Height;
+			cached.BearingX = image.BearingX;
+			cached.BearingY = image.BearingY;
+			if (image.Pixels.empty())
+			{
+				cached.Format = GlyphCache::image_format::Alpha;
+				cached.Data = image.Alpha.data();
 			}
+			else
+			{
+				cached.Format = GlyphCache::image_format::Pixels;
+				cached.Data = image.Pixels.data();
+			}
+		}
+
+		m_glyphCache->Add(glyph, cached);
+	}
+
+	void Font::rasterize(std::uint32_t glyph)
+	{
+		K2D_PROFILE_SCOPE(g_Context->Profiler, "Font::rasterize");
 
-			// Holds the texture data
-			std::vector<std::uint8_t> textureData;
-			textureData.resize(sizeof(TGAHeader) + mem.size() * sizeof(std::uint32_t), 0);
+		GlyphImage image = GlyphImage();
+		if (!loadCachedGlyph(glyph, image) && createRasterContexts(1))
+		{
+			renderGlyph(*m_rasterContexts.front(), glyph, &g_Context->GlyphWorkers, image);
+			cacheGlyph(glyph, image);
+			g_Context->Stats.GlyphsRasterized++;
+		}
 
-			// Create texture file in memory
-			TGAHeader Header;
-			Header.IDLength = 0;
-			Header.ColorMapType = 0;
-			Header.DataTypeCode = 2;
-			Header.wColorMapOrigin = 0;
-			Header.wColorMapLength = 0;
-			Header.ColorMapDepth = 0;
-			Header.wOriginX = 0;
-			Header.wOriginY = 0;
-			Header.wWidth = texSize;
-			Header.wHeight = texSize;
-			Header.BitDepth = 32;
-			Header.ImageDescriptor = 32;
-			memcpy(&textureData[0], &Header, sizeof(Header));
+		storeGlyph(glyph, image);
+	}
 
-			// Copy the image data
-			memcpy(&textureData[sizeof(Header)], &mem[0], mem.size() * sizeof(std::uint32_t));
+	void Font::rasterizeParallel(const std::vector<std::uint32_t> &glyphs)
+	{
+		K2D_PROFILE_SCOPE(g_Context->Profiler, "Font::rasterizeParallel");
+
+		// Cached glyphs are only read, the others are rendered
+		const std::uint32_t count = static_cast<std::uint32_t>(glyphs.size());
+		std::vector<GlyphImage> images(count);
+		std::vector<std::uint32_t> missing;
+		missing.reserve(count);
+		for (std::uint32_t i = 0; i < count; ++i)
+		{
+			if (!loadCachedGlyph(glyphs[i], images[i]))
+				missing.push_back(i);
+		}
 
-			// Create imageset texture
-			std::uint32_t textureId = K2D_CreateTextureFromMemory(reinterpret_cast<const char*>(&textureData[0]), (std::uint32_t)textureData.size());
-			imageSet->setTexture(textureId);
+		WorkerPool &workers = g_Context->GlyphWorkers;
+		const std::uint32_t missingCount = static_cast<std::uint32_t>(missing.size());
+		const std::uint32_t jobs = std::min<std::uint32_t>(workers.GetThreadCount(), missingCount / MIN_GLYPHS_PER_JOB);
+		if (jobs <= 1 || !createRasterContexts(jobs))
+		{
+			if (missingCount && !createRasterContexts(1))
+				missing.clear();
 
-			// Check if finished
-			if (finished)
-				break;
+			for (std::uint32_t i : missing)
+				renderGlyph(*m_rasterContexts.front(), glyphs[i], &workers, images[i]);
 		}
+		else
+		{
+			// Job j renders every jobs-th missing glyph with context j. The context of the engine
+			// is thread local, so the workers get everything they need from here.
+			Profiler *profiler = &g_Context->Profiler;
+			workers.Run(jobs, [&](std::uint32_t job)
+			{
+				K2D_PROFILE_SCOPE(*profiler, "Font::renderGlyphs");
+
+				RasterContext &context = *m_rasterContexts[job];
+				for (std::uint32_t k = job; k < missingCount; k += jobs)
+					renderGlyph(context, glyphs[missing[k]], nullptr, images[missing[k]]);
+			});
+		}
+
+		for (std::uint32_t i : missing)
+		{
+			cacheGlyph(glyphs[i], images[i]);
+			g_Context->Stats.GlyphsRasterized++;
+		}
+
+		// The atlas is packed in the order of the glyphs, the same order a single thread uses
+		for (std::uint32_t i = 0; i < count; ++i)
+			storeGlyph(glyphs[i], images[i]);
 	}
 
-	void Font::drawSpansToBuffer(std::uint32_t * buffer, std::uint32_t textureSize, const Font::Spans& spans) const
+	void Font::syncAtlasGeneration()
 	{
+		const std::uint32_t generation = g_Context->Glyphs.GetGeneration();
+		if (m_atlasGeneration == generation)
+			return;
 
+		// Images may have moved to other pages, evicted ones are rasterized again when needed
+		const GlyphAtlas &atlas = g_Context->Glyphs;
+		for (size_t glyph = 0; glyph < m_glyphTextures.size(); ++glyph)
+		{
+			if (m_glyphTextures[glyph] == 0 || m_glyphTextures[glyph] == NOT_RASTERIZED)
+				continue;
+
+			GlyphAtlas::Region region;
+			if (atlas.Find(m_glyphHandles[glyph], region))
+			{
+				m_glyphAreas[glyph].X = static_cast<float>(region.X);
+				m_glyphAreas[glyph].Y = static_cast<float>(region.Y);
+				m_glyphTextures[glyph] = region.TextureId;
+			}
+			else
+			{
+				m_glyphTextures[glyph] = NOT_RASTERIZED;
+			}
+		}
+		m_atlasGeneration = generation;
 	}
 
-	float Font::getTextWidth(const std::wstring & text, float scale)
+	float Font::getTextWidth(const TextView & text, float scale, float * out_advance)
 	{
 		float curWidth = 0.0f, advWidth = 0.0f, width = 0.0f;
 
 		// Iterate through all characters of the string
-		for (size_t c = 0; c < text.length(); ++c)
+		TextReader reader(text);
+		std::uint32_t codepoint;
+		while (reader.Next(codepoint))
 		{
-			// Get the glyph data
-			const FontGlyph* glyph = getGlyphData(text[c]);
-			if (glyph)
+			// Get the glyph metrics
+			const std::uint32_t glyph = measureGlyph(codepoint);
+			if (glyph != InvalidGlyph)
 			{
 				// Adjust the width
-				width = glyph->getRenderedAdvance(scale);
+				width = getGlyphExtent(glyph, scale);
 				if (advWidth + width > curWidth)
 					curWidth = advWidth + width;
 
-				advWidth += glyph->getAdvance(scale);
+				advWidth += getGlyphAdvance(glyph, scale);
 			}
 		}
 
+		if (out_advance)
+			*out_advance = advWidth;
+
 		return std::max(advWidth, curWidth);
 	}
 
-	const FontGlyph * Font::getGlyphData(std::uint32_t codepoint)
+	size_t Font::wrapText(const TextView & text, float maxWidth, float scale, std::uint32_t * out_lineEnds, size_t maxLines)
+	{
+		size_t lines = 0;
+		auto endLine = [&](size_t end)
+		{
+			if (lines < maxLines)
+				out_lineEnds[lines] = static_cast<std::uint32_t>(end);
+			++lines;
+		};
+
+		// Pen position in the current line, and the position after its last space. Spaces hang
+		// over the end of a line, so they never cause a break themselves.
+		float penX = 0.0f;
+		size_t breakPos = 0;
+		float breakPenX = 0.0f;
+		bool hasBreak = false;
+
+		TextReader reader(text);
+		std::uint32_t codepoint;
+		size_t position = 0;
+		while (reader.Next(codepoint))
+		{
+			const size_t start = position;
+			position = reader.GetPosition();
+
+			if (codepoint == '\n')
+			{
+				endLine(position);
+				penX = 0.0f;
+				hasBreak = false;
+				continue;
+			}
+
+			const std::uint32_t glyph = measureGlyph(codepoint);
+			if (glyph == InvalidGlyph)
+				continue;
+
+			const float advance = getGlyphAdvance(glyph, scale);
+			if (codepoint == ' ' || codepoint == '\t' || codepoint == 0x3000)
+			{
+				penX += advance;
+				breakPos = position;
+				breakPenX = penX;
+				hasBreak = true;
+				continue;
+			}
+
+			// Wrap at the last space, words which don't fit a line on their own are broken
+			// before the character which doesn't fit anymore
+			const float extent = getGlyphExtent(glyph, scale);
+			if (hasBreak && penX + extent > maxWidth)
+			{
+				endLine(breakPos);
+				penX -= breakPenX;
+				hasBreak = false;
+			}
+			if (penX > 0.0f && penX + extent > maxWidth)
+			{
+				endLine(start);
+				penX = 0.0f;
+			}
+
+			penX += advance;
+		}
+
+		endLine(position);
+		return lines;
+	}
+
+	std::uint32_t Font::measureGlyph(std::uint32_t codepoint)
+	{
+		if (codepoint > m_family->GetMaxCodepoint())
+			return InvalidGlyph;
+
+		const std::uint32_t glyph = findGlyph(codepoint);
+		if (glyph == InvalidGlyph)
+			return InvalidGlyph;
+
+		loadAdvances(glyph);
+		loadExtent(glyph);
+		return glyph;
+	}
+
+	std::uint32_t Font::getGlyph(std::uint32_t codepoint)
 	{
-		if (codepoint > m_maxCodepoint)
-			return nullptr;
+		if (codepoint > m_family->GetMaxCodepoint())
+			return InvalidGlyph;
+
+		syncAtlasGeneration();
+
+		// Find the glyph data and rasterize it if this didn't happen yet
+		const std::uint32_t glyph = findGlyph(codepoint);
+		if (glyph == InvalidGlyph)
+			return InvalidGlyph;
+
+		loadAdvances(glyph);
+		if (m_glyphTextures[glyph] == NOT_RASTERIZED)
+			rasterize(glyph);
+
+		return glyph;
+	}
 
-		// First see if the glyph data is already rasterized
-		const std::uint32_t page = codepoint / GLYPHS_PER_PAGE;
-		const std::uint32_t mask = 1 << (page & (BITS_PER_UINT - 1));
-		if (!(m_glyphPageLoaded[page / BITS_PER_UINT] & mask))
+	void Font::prepareGlyphs(const TextView & text)
+	{
+		syncAtlasGeneration();
+
+		// Collect the glyphs without image in order of appearance. They are marked as done right
+		// away, so repeated characters are only collected once.
+		std::vector<std::uint32_t> pending;
+		TextReader reader(text);
+		std::uint32_t codepoint;
+		while (reader.Next(codepoint))
 		{
-			// Not yet rasterized, so do it now and remember that we did it
-			m_glyphPageLoaded[page / BITS_PER_UINT] |= mask;
-			rasterize(
-				codepoint & ~(GLYPHS_PER_PAGE - 1),
-				codepoint | (GLYPHS_PER_PAGE - 1));
+			if (codepoint > m_family->GetMaxCodepoint())
+				continue;
+
+			const std::uint32_t glyph = findGlyph(codepoint);
+			if (glyph != InvalidGlyph && m_glyphTextures[glyph] == NOT_RASTERIZED)
+			{
+				m_glyphTextures[glyph] = 0;
+				pending.push_back(glyph);
+			}
 		}
 
-		// Fint the glyph data
-		auto it = m_glyphMap.find(codepoint);
-		return (it != m_glyphMap.end()) ? &it->second : nullptr;
+		if (!pending.empty())
+			rasterizeParallel(pending);
+	}
+
+	void Font::drawText(const TextView & text, const Vector2 & position, float scale)
+	{
+		K2D_TextStyle style = {};
+		style.RGBA = 0xffffffff;
+		style.Scale = scale;
+		drawText(text, position, style);
 	}
 
-	void Font::drawText(const std::wstring & text, const Vector2 & position, float scale)
+	void Font::drawText(const TextView & text, const Vector2 & position, const K2D_TextStyle & style)
 	{
-		const float baseY = position.Y + getBaseline(scale);
-		Vector2 glyphPos(position);
+		const float scale = style.Scale > 0.0f ? style.Scale : 1.0f;
+		prepareGlyphs(text);
+		layoutGlyphs(text, scale, m_drawQuads);
 
-		for (size_t c = 0; c < text.length(); ++c)
+		const bool hasShadow = (style.ShadowRGBA >> 24) != 0 &&
+			(style.ShadowOffsetX != 0.0f || style.ShadowOffsetY != 0.0f || style.ShadowSoftness > 0.0f);
+		const bool hasOutline = m_distanceField && (style.OutlineRGBA >> 24) != 0 && style.OutlineWidth > 0.0f;
+
+		// Bitmap glyphs are drawn as they are, the shadow is an offset copy
+		if (!m_distanceField)
+		{
+			if (hasShadow)
+				drawGlyphs(m_drawQuads, Vector2(position.X + style.ShadowOffsetX, position.Y + style.ShadowOffsetY), style.ShadowRGBA, 0);
+
+			drawGlyphs(m_drawQuads, position, style.RGBA, 0);
+			return;
+		}
+
+		// Distance field values per pixel on screen. The edges are smoothed over about one pixel.
+		const float unitsPerPixel = 0.5f / (DISTANCE_FIELD_SPREAD * scale);
+		const float antialiasing = unitsPerPixel * 0.5f;
+
+		// The outline grows the glyph outwards, the shadow is cast by the outlined glyph
+		const float outerThreshold = hasOutline ? 0.5f - style.OutlineWidth * unitsPerPixel : 0.5f;
+
+		if (hasShadow)
 		{
-			const FontGlyph* glyph = nullptr;
-			if ((glyph = getGlyphData(text[c])))
+			const float softness = std::max(antialiasing, style.ShadowSoftness * unitsPerPixel * 0.5f);
+			drawGlyphs(m_drawQuads, Vector2(position.X + style.ShadowOffsetX, position.Y + style.ShadowOffsetY),
+				style.ShadowRGBA, DistanceFieldParams(outerThreshold, softness));
+		}
+
+		if (hasOutline)
+			drawGlyphs(m_drawQuads, position, style.OutlineRGBA, DistanceFieldParams(outerThreshold, antialiasing));
+
+		drawGlyphs(m_drawQuads, position, style.RGBA, getFillColorkey(scale));
+	}
+
+	float Font::layoutGlyphs(const TextView & text, float scale, std::vector<GlyphQuad> & out_quads)
+	{
+		out_quads.clear();
+
+		const float baseY = getBaseline(scale);
+		float penX = 0.0f;
+
+		TextReader reader(text);
+		std::uint32_t codepoint;
+		while (reader.Next(codepoint))
+		{
+			const std::uint32_t glyph = getGlyph(codepoint);
+			if (glyph == InvalidGlyph)
+				continue;
+
+			// Glyphs without image (e.g. spaces) only advance the cursor
+			const std::uint32_t textureId = m_glyphTextures[glyph];
+			if (textureId != 0)
 			{
-				const FontImage* const image = glyph->getImage();
-				glyphPos.Y = baseY - (image->getOffsetY() - image->getOffsetY() * scale);
+				const RectF &area = m_glyphAreas[glyph];
+				const Vector2 &offset = m_glyphOffsets[glyph];
 
-				image->draw(glyphPos, glyph->getImage()->getSize());
-				glyphPos.X += glyph->getAdvance(scale);
+				GlyphQuad quad = { textureId,
+					penX + offset.X * scale, baseY + offset.Y * scale, area.Width * scale, area.Height * scale,
+					area.X, area.Y, area.Width, area.Height, m_glyphHandles[glyph].Entry };
+				out_quads.push_back(quad);
 			}
+
+			penX += getGlyphAdvance(glyph, scale);
 		}
+
+		return penX;
+	}
+
+	std::uint32_t Font::getFillColorkey(float scale) const
+	{
+		if (!m_distanceField)
+			return 0;
+
+		const float unitsPerPixel = 0.5f / (DISTANCE_FIELD_SPREAD * scale);
+		return DistanceFieldParams(0.5f, unitsPerPixel * 0.5f);
+	}
+
+	void Font::drawGlyphs(const std::vector<GlyphQuad> & quads, const Vector2 & position, std::uint32_t color, std::uint32_t colorkey)
+	{
+		if (!quads.empty())
+			SubmitGlyphs(quads.data(), quads.size(), position.X, position.Y, color, colorkey);
 	}
 }
@@ -2,20 +2,33 @@
 #pragma once
 
 #include <memory>
-#include <map>
+#include <vector>
 #include "File.h"
-#include "FontGlyph.h"
-#include "FontImageset.h"
+#include "RectF.h"
+#include "GlyphAtlas.h"
+#include "TextDrawer.h"
+#include "TextView.h"
+#include "SpanCompositor.h"
+#include "FontFamily.h"
+#include "GlyphCache.h"
 #include <ft2build.h>
 #include FT_FREETYPE_H
+#include FT_STROKER_H
+
+struct K2D_TextStyle;
 
 namespace Kyo2D
 {
+	class WorkerPool;
+
 	/// Base class for a texture.
 	class Font : public std::enable_shared_from_this<Font>
 	{
-		/// Contains infos about font glyphs
-		typedef std::map<std::uint32_t, FontGlyph> GlyphMap;
+	public:
+
+		/// Glyph index returned for codepoints the font has no glyph for.
+		static const std::uint32_t InvalidGlyph = 0xFFFFFFFF;
+
 
 	public:
 
@@ -25,61 +38,102 @@ namespace Kyo2D
 		virtual ~Font();
 
 		/// Initializes this font by loading it from memory.
-		virtual bool Initialize(const void *data, size_t dataSize, float pointSize, float outline = 0.0f);
+		/// @param distanceField If true, glyphs are stored as distance fields rendered at pointSize,
+		///		which are drawn sharp at any scale and get their outline while drawing. The outline
+		///		parameter is ignored then.
+		virtual bool Initialize(const void *data, size_t dataSize, float pointSize, float outline = 0.0f, bool distanceField = false);
 		/// Initializes this font by loading it from a file.
-		virtual bool Initialize(const std::wstring &filename, float pointSize, float outline = 0.0f);
+		virtual bool Initialize(const std::wstring &filename, float pointSize, float outline = 0.0f, bool distanceField = false);
+		/// Initializes this font as a size of a font family, sharing the file and the glyph table
+		/// with the other fonts of the family.
+		/// @param family The loaded family. The font keeps it alive.
+		virtual bool Initialize(std::shared_ptr<FontFamily> family, float pointSize, float outline = 0.0f, bool distanceField = false);
+		/// Gets the family the font is a size of.
+		inline const std::shared_ptr<FontFamily> &getFamily() const { return m_family; }
 
 	private:
 
-		/// A horizontal pixel span generated by the FreeType renderer.
-		struct Span
+		typedef SpanCompositor::Span Span;
+		typedef SpanCompositor::Spans Spans;
+
+		/// FreeType objects used to rasterize glyphs on one thread. FreeType objects must not be used
+		/// by two threads at once, so every worker of a parallel rasterization has a library and a
+		/// face of its own over the file data of the family. The first context uses the face of the family.
+		struct RasterContext
 		{
-			Span() { }
-			Span(int _x, int _y, int _width, int _coverage)
-				: x(_x), y(_y), width(_width), coverage(_coverage) { }
+			RasterContext();
+			~RasterContext();
 
-			int x, y, width, coverage;
-		};
+			RasterContext(const RasterContext&) = delete;
+			RasterContext& operator=(const RasterContext&) = delete;
 
-		typedef std::vector<Span> Spans;
+			FT_Library Library;
+			FT_Face Face;
+			/// Outline stroker, created for the first outlined glyph and kept for the following ones.
+			FT_Stroker Stroker;
+			/// Span buffers, reused for every glyph.
+			Spans GlyphSpans;
+			Spans OutlineSpans;
+			/// Determines if Library and Face are released with the context.
+			bool Owned;
+		};
 
-		union Pixel32
+		/// Image of a glyph rendered by renderGlyph, waiting to be stored in the atlas.
+		struct GlyphImage
 		{
-			Pixel32()
-				: integer(0)
-			{
-			}
-			Pixel32(std::uint8_t bi, std::uint8_t gi, std::uint8_t ri, std::uint8_t ai = 255)
-			{
-				b = bi;
-				g = gi;
-				r = ri;
-				a = ai;
-			}
-
-			std::uint32_t integer;
-			struct
-			{
-				std::uint8_t b, g, r, a;
-			};
+			/// Size of the image, 0 if the glyph has no image.
+			std::int32_t Width, Height;
+			/// Horizontal and vertical bearing of the glyph in pixels.
+			float BearingX, BearingY;
+			/// Coverage or distance field of alpha-only images.
+			std::vector<std::uint8_t> Alpha;
+			/// Pixels of outlined glyphs.
+			std::vector<std::uint32_t> Pixels;
 		};
 
 	private:
 
-		/// Initializes the font after m_fileData has been filled.
-		bool initializeInternal();
-		/// Calculates the required texture size to contain all glyphs from start to end.
-		/// @param start The first glyph to contain.
-		/// @param end The last glyph to contain.
-		/// @return Texture size in pixels for one edge (these textures are squared)
-		std::uint32_t getTextureSize(GlyphMap::const_iterator start, GlyphMap::const_iterator end) const;
-		/// Sets the maximal glyph index. This reserves the respective number 
-		/// of bits in the m_glyphPageLoaded array.
-		void setMaxCodepoint(std::uint32_t codepoint);
-		/// Prepares a certain range of glyphs to be ready for displaying.
-		void rasterize(std::uint32_t startCodepoint, std::uint32_t endCodepoint);
-		/// Draws the currently rasterized glyph to the given buffer.
-		void drawSpansToBuffer(std::uint32_t* buffer, std::uint32_t textureSize, const Spans& spans) const;
+		/// Creates the size of the font in the face of the family and the glyph tables.
+		bool initializeSize();
+		/// Makes the size of this font the active size of the face of the family.
+		/// @return The face of the family.
+		FT_Face activateSize() const;
+		/// Loads the advances of the chunk of glyphs containing the given glyph, unless this
+		/// already happened. Advances are loaded in chunks of 256 glyphs when first used.
+		void loadAdvances(std::uint32_t glyph);
+		/// Measures the extent of a glyph from its bounding box, unless this already happened.
+		void loadExtent(std::uint32_t glyph);
+		/// Takes the advances and extents measured by an earlier run from the glyph cache.
+		void loadCachedMetrics();
+		/// Hands the advances and extents measured so far to the glyph cache.
+		void cacheMetrics();
+		/// Looks up the glyph index of a codepoint without rasterizing anything.
+		/// @return The glyph index, or InvalidGlyph.
+		inline std::uint32_t findGlyph(std::uint32_t codepoint) const { return m_family->FindGlyph(codepoint); }
+		/// Renders the image of a glyph and adds it to the glyph atlas of the context.
+		/// @param glyph Index of the glyph.
+		void rasterize(std::uint32_t glyph);
+		/// Renders the images of several glyphs on the glyph workers, then adds them to the glyph
+		/// atlas in the given order. Few glyphs are rasterized on the calling thread.
+		void rasterizeParallel(const std::vector<std::uint32_t> &glyphs);
+		/// Creates the rasterization contexts up to the given count.
+		/// @return false if a FreeType object couldn't be created.
+		bool createRasterContexts(std::uint32_t count);
+		/// Renders the image of a glyph. Doesn't touch the engine context, so it can run on any
+		/// thread as long as no other thread uses the same rasterization context.
+		/// @param workers Pool for generating distance fields, nullptr when running on a worker.
+		/// @return false if the glyph has no image.
+		bool renderGlyph(RasterContext &context, std::uint32_t glyph, WorkerPool *workers, GlyphImage &out_image) const;
+		/// Adds the image of a glyph to the glyph atlas and remembers where it was stored.
+		void storeGlyph(std::uint32_t glyph, const GlyphImage &image);
+		/// Reads the image of a glyph from the glyph cache.
+		/// @return false if the font has no glyph cache or the glyph isn't cached.
+		bool loadCachedGlyph(std::uint32_t glyph, GlyphImage &out_image) const;
+		/// Adds a rendered glyph image to the glyph cache, if the font has one.
+		void cacheGlyph(std::uint32_t glyph, const GlyphImage &image);
+		/// Looks up the glyph images again if the glyph atlas has been cleared or compacted since,
+		/// forgetting the images which have been evicted.
+		void syncAtlasGeneration();
 
 	private:
 
@@ -88,18 +142,66 @@ namespace Kyo2D
 
 	public:
 
-		/// Calculates the width of a given text in pixels.
+		/// Calculates the width of a given text in pixels. Only the metrics of the glyphs are read,
+		/// nothing is rasterized.
 		/// @param text The text whose width will be calculated.
 		/// @param scale Scaling parameter which is multiplied with the actual width value.
+		/// @param out_advance Receives the advance of the text, the position of a following text.
 		/// @return Width of the given text in pixels.
-		float getTextWidth(const std::wstring& text, float scale = 1.0f);
-		/// Returns a pointer to the glyph data structure for the given codepoint, or nullptr
-		/// if the codepoint does not have a glyph defined.
-		/// @param codepoint The codepoint to return the glyph data structure for.
-		/// @param nullptr if the codepoint isn't available in the font.
-		const FontGlyph* getGlyphData(std::uint32_t codepoint);
+		float getTextWidth(const TextView& text, float scale = 1.0f, float* out_advance = nullptr);
+		/// Breaks a text into lines no wider than maxWidth in one pass over the glyph metrics.
+		/// Lines end after newlines and wrap after spaces, which don't count towards the width of
+		/// the line they end. Words wider than a line are broken between characters.
+		/// @param out_lineEnds Receives the end of each line, the index of the code unit following it.
+		/// @param maxLines Number of line ends out_lineEnds can hold.
+		/// @return The number of lines, which may be more than maxLines.
+		size_t wrapText(const TextView& text, float maxWidth, float scale, std::uint32_t* out_lineEnds, size_t maxLines);
+		/// Returns the index of the glyph for the given codepoint with its advance and extent loaded.
+		/// The glyph isn't rasterized.
+		/// @return The glyph index, or InvalidGlyph if the codepoint isn't available in the font.
+		std::uint32_t measureGlyph(std::uint32_t codepoint);
+		/// Returns the index of the glyph for the given codepoint. The glyph is rasterized
+		/// and its advance is loaded if this didn't happen yet.
+		/// @param codepoint The codepoint to return the glyph for.
+		/// @return The glyph index, or InvalidGlyph if the codepoint isn't available in the font.
+		std::uint32_t getGlyph(std::uint32_t codepoint);
+		/// Gets the horizontal advance value of a glyph.
+		/// @param glyph A glyph index returned by getGlyph.
+		/// @param scale Scaling parameter which is multiplied with the actual advance value.
+		inline float getGlyphAdvance(std::uint32_t glyph, float scale = 1.0f) const { return m_glyphAdvances[glyph] * scale; }
+		/// Gets the right edge of the image of a glyph, measured from its bounding box.
+		/// @param glyph A glyph index returned by measureGlyph.
+		/// @param scale Scaling parameter which is multiplied with the actual extent value.
+		inline float getGlyphExtent(std::uint32_t glyph, float scale = 1.0f) const { return m_glyphExtents[glyph] * scale; }
+		/// Gets the rendered advance value of a glyph (right edge of its image).
+		/// @param glyph A glyph index returned by getGlyph.
+		/// @param scale Scaling parameter which is multiplied with the actual advance value.
+		inline float getGlyphRenderedAdvance(std::uint32_t glyph, float scale = 1.0f) const { return (m_glyphAreas[glyph].Width + m_glyphOffsets[glyph].X - m_imagePadding) * scale; }
+		/// Rasterizes the glyphs of a text which have no image yet. Many new glyphs, e.g. the first
+		/// text in a CJK script, are rasterized in parallel on the glyph workers of the context.
+		void prepareGlyphs(const TextView& text);
+		/// Places the glyph images of a text. The glyphs have to be prepared with prepareGlyphs.
+		/// @param scale Scaling parameter which is multiplied with the glyph sizes and advances.
+		/// @param out_quads Receives one quad per glyph with image, the vector is cleared first.
+		/// @return The advance of the text, the position of a following text.
+		float layoutGlyphs(const TextView& text, float scale, std::vector<GlyphQuad>& out_quads);
+		/// Gets the colorkey the glyphs are drawn with in their fill color. Holds the threshold and
+		/// smoothing for distance fields (see SpriteDrawer::SetDistanceField), 0 for other fonts.
+		std::uint32_t getFillColorkey(float scale) const;
+		/// Draws glyph quads in one color with the text drawer of the context.
+		/// @param colorkey Holds threshold and smoothing for distance fields.
+		static void drawGlyphs(const std::vector<GlyphQuad>& quads, const Vector2& position, std::uint32_t color, std::uint32_t colorkey);
 		/// Draws text at the given position using this font.
-		void drawText(const std::wstring& text, const Vector2& position, float scale = 1.0f);
+		void drawText(const TextView& text, const Vector2& position, float scale = 1.0f);
+		/// Draws text at the given position with color, scale, outline and shadow of a style.
+		/// Outlines are only drawn by distance field fonts, other fonts have theirs in the glyphs.
+		void drawText(const TextView& text, const Vector2& position, const K2D_TextStyle& style);
+		/// Determines if the glyphs of this font are stored as distance fields.
+		inline bool isDistanceField() const { return m_distanceField; }
+		/// Writes the glyphs rasterized and measured since the font was created or last saved to its
+		/// glyph cache file. Fonts never write the file on their own, not even when destroyed.
+		/// @return false if the font has a glyph cache and the file couldn't be written.
+		bool saveGlyphCache();
 
 	public:
 
@@ -118,28 +220,15 @@ namespace Kyo2D
 
 	private:
 
-		/// Custom deleter for a smart pointer of type FT_FaceRec_* alias FT_Face
-		struct FT_FaceRec_Deleter
-		{
-			/// Execution operator performs the delete process
-			virtual void operator()(FT_FaceRec_* x)
-			{
-				FT_Done_Face(x);
-			}
-		};
-
-		/// Font pointer typedef with auto delete mechanics
-		typedef std::unique_ptr<FT_FaceRec_, FT_FaceRec_Deleter> FT_FacePtr;
-
-	private:
-
-		/// The file data has to keep alive while working with FT_Face or else it
-		/// the application will crash.
-		FileData m_fileData;
-		/// The font face.
-		FT_FacePtr m_fontFace;
+		/// The file, face and glyph table shared with the other sizes of the family.
+		std::shared_ptr<FontFamily> m_family;
+		/// Size of the face for this font, created with FT_New_Size.
+		FT_Size m_size;
 		/// Size of this font in points
 		float m_pointSize;
+		/// Character size and resolution passed to FT_Set_Char_Size, repeated for the faces of the workers.
+		FT_F26Dot6 m_charSize;
+		FT_UInt m_charResolution;
 		/// The maximum amount of pixels above the baseline
 		float m_ascender;
 		/// The maximum amount of pixels below the baseline
@@ -148,14 +237,31 @@ namespace Kyo2D
 		float m_height;
 		/// The outline width (set to 0.0 if no outline should be used).
 		float m_outlineWidth;
-		/// Map of font glyphs.
-		GlyphMap m_glyphMap;
-		/// Maximal glyph index.
-		std::uint32_t m_maxCodepoint;
-		/// This array holds information about loaded glyph pages. A glyph page
-		/// is a set of 256 codepoints, starting at 256-multiples.
-		std::vector<uint32_t> m_glyphPageLoaded;
-		/// Contains all loaded font imagesets.
-		std::list<FontImageset> m_imageSets;
+		/// Glyphs are stored as distance fields.
+		bool m_distanceField;
+		/// Empty border around each glyph image, distance fields need room to fade out.
+		float m_imagePadding;
+		/// Horizontal advance of each glyph, valid once the chunk of the glyph has been loaded.
+		std::vector<float> m_glyphAdvances;
+		/// Right edge of the image of each glyph relative to the pen, valid once the glyph has been measured.
+		std::vector<float> m_glyphExtents;
+		/// Determines for each chunk of 256 glyphs whether its advances have been loaded.
+		std::vector<bool> m_glyphAdvancesLoaded;
+		/// Source texture area of each glyph image.
+		std::vector<RectF> m_glyphAreas;
+		/// Render offset of each glyph image.
+		std::vector<Vector2> m_glyphOffsets;
+		/// Id of the atlas texture holding the image of each glyph, 0 if the glyph has no image.
+		std::vector<std::uint32_t> m_glyphTextures;
+		/// Handle of the atlas entry of each glyph image.
+		std::vector<GlyphAtlas::Handle> m_glyphHandles;
+		/// Generation of the glyph atlas the images were inserted into.
+		std::uint32_t m_atlasGeneration;
+		/// Rasterization contexts, one per thread of the last parallel rasterization.
+		std::vector<std::unique_ptr<RasterContext>> m_rasterContexts;
+		/// Quads of the text drawn last, reused by every drawText call.
+		std::vector<GlyphQuad> m_drawQuads;
+		/// Glyph images rasterized by earlier runs, nullptr if glyphs aren't cached.
+		std::unique_ptr<GlyphCache> m_glyphCache;
 	};
 }
@@ -0,0 +1,103 @@
+#include "FontFamily.h"
+#include "Hash.h"
+#include <cstring>
+
+namespace Kyo2D
+{
+	const std::uint32_t FontFamily::InvalidGlyph;
+	const std::uint32_t FontFamily::GlyphsPerPage;
+
+	FontFamily::FontFamily()
+		: m_Library(nullptr)
+		, m_Face(nullptr)
+		, m_MaxCodepoint(0)
+		, m_ContentHash(0)
+	{
+		// FreeType libraries must not be used by multiple threads at once
+		FT_Init_FreeType(&m_Library);
+	}
+
+	FontFamily::~FontFamily()
+	{
+		if (m_Face)
+			FT_Done_Face(m_Face);
+		if (m_Library)
+			FT_Done_FreeType(m_Library);
+	}
+
+	bool FontFamily::Initialize(const void *data, size_t dataSize)
+	{
+		if (!data || dataSize == 0)
+			return false;
+
+		m_FileData.resize(dataSize);
+		memcpy(m_FileData.data(), data, dataSize);
+		return initializeFace();
+	}
+
+	bool FontFamily::Initialize(const std::wstring &filename)
+	{
+		if (!readFileContents(filename, m_FileData))
+			return false;
+
+		return initializeFace();
+	}
+
+	bool FontFamily::initializeFace()
+	{
+		if (!m_Library || m_Face)
+			return false;
+
+		if (FT_New_Memory_Face(m_Library, m_FileData.data(), static_cast<FT_Long>(m_FileData.size()), 0, &m_Face))
+		{
+			m_Face = nullptr;
+			return false;
+		}
+
+		// Check that the default unicode character map is available
+		if (!m_Face->charmap)
+			return false;
+
+		// One glyph for every codepoint of the character map. Only the glyph index is read here,
+		// the fonts load the metrics when a glyph is used for the first time.
+		FT_UInt glyphIndex;
+		FT_ULong codepoint = FT_Get_First_Char(m_Face, &glyphIndex);
+		while (glyphIndex)
+		{
+			if (m_MaxCodepoint < codepoint)
+				m_MaxCodepoint = static_cast<std::uint32_t>(codepoint);
+
+			addGlyph(static_cast<std::uint32_t>(codepoint), glyphIndex);
+			codepoint = FT_Get_Next_Char(m_Face, codepoint, &glyphIndex);
+		}
+
+		return true;
+	}
+
+	std::uint64_t FontFamily::GetContentHash() const
+	{
+		if (!m_ContentHash)
+			m_ContentHash = Hash(m_FileData.data(), m_FileData.size());
+		return m_ContentHash;
+	}
+
+	void FontFamily::addGlyph(std::uint32_t codepoint, std::uint32_t glyphIndex)
+	{
+		// Get the block of the page, create it if this is the first glyph of the page
+		const std::uint32_t page = codepoint / GlyphsPerPage;
+		if (page >= m_PageDirectory.size())
+			m_PageDirectory.resize(page + 1, 0);
+
+		std::uint32_t &block = m_PageDirectory[page];
+		if (!block)
+		{
+			m_PageBlocks.resize(m_PageBlocks.size() + GlyphsPerPage, InvalidGlyph);
+			block = static_cast<std::uint32_t>(m_PageBlocks.size() / GlyphsPerPage);
+		}
+
+		m_PageBlocks[(block - 1) * GlyphsPerPage + (codepoint & (GlyphsPerPage - 1))] = static_cast<std::uint32_t>(m_Codepoints.size());
+
+		m_Codepoints.push_back(codepoint);
+		m_Indices.push_back(glyphIndex);
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "File.h"
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+namespace Kyo2D
+{
+	/// The contents of a font file shared by fonts of several sizes and outline widths. Holds the
+	/// file data, the FreeType face and the table from codepoints to glyphs once, each font adds
+	/// a size of the face (FT_New_Size) and the images and metrics of its glyphs. The fonts of
+	/// a family must be used by the thread of one engine context.
+	class FontFamily
+	{
+	public:
+
+		/// Glyph number returned for codepoints the font has no glyph for.
+		static const std::uint32_t InvalidGlyph = 0xFFFFFFFF;
+		/// Number of codepoints per page of the glyph table. Must be a power of two.
+		static const std::uint32_t GlyphsPerPage = 256;
+
+	public:
+
+		/// Default constructor.
+		FontFamily();
+		/// Destructor. Fonts keep their family alive, so the sizes of the face are gone by now.
+		~FontFamily();
+
+		FontFamily(const FontFamily&) = delete;
+		FontFamily& operator=(const FontFamily&) = delete;
+
+		/// Loads the family from a copy of the file contents of a ttf file.
+		bool Initialize(const void *data, size_t dataSize);
+		/// Loads the family from a ttf file.
+		bool Initialize(const std::wstring &filename);
+
+		/// Finds the glyph of a codepoint.
+		/// @return The glyph number, or InvalidGlyph.
+		inline std::uint32_t FindGlyph(std::uint32_t codepoint) const
+		{
+			const std::uint32_t page = codepoint / GlyphsPerPage;
+			if (page >= m_PageDirectory.size())
+				return InvalidGlyph;
+
+			const std::uint32_t block = m_PageDirectory[page];
+			if (!block)
+				return InvalidGlyph;
+
+			return m_PageBlocks[(block - 1) * GlyphsPerPage + (codepoint & (GlyphsPerPage - 1))];
+		}
+
+		/// Gets the number of glyphs. Glyphs are numbered in ascending codepoint order.
+		inline std::uint32_t GetGlyphCount() const { return static_cast<std::uint32_t>(m_Indices.size()); }
+		/// Gets the index of a glyph in the font face.
+		inline std::uint32_t GetGlyphIndex(std::uint32_t glyph) const { return m_Indices[glyph]; }
+		/// Gets the codepoint of a glyph.
+		inline std::uint32_t GetCodepoint(std::uint32_t glyph) const { return m_Codepoints[glyph]; }
+		/// Gets the largest codepoint with a glyph.
+		inline std::uint32_t GetMaxCodepoint() const { return m_MaxCodepoint; }
+		/// Gets the FreeType library of the face.
+		inline FT_Library GetLibrary() const { return m_Library; }
+		/// Gets the face. Its active size belongs to the font which used it last, see FT_Activate_Size.
+		inline FT_Face GetFace() const { return m_Face; }
+		/// Gets the file contents, which workers load faces of their own from.
+		inline const FileData &GetFileData() const { return m_FileData; }
+		/// Gets a hash of the file contents, computed on first use.
+		std::uint64_t GetContentHash() const;
+
+	private:
+
+		/// Creates the face and reads the character map.
+		bool initializeFace();
+		/// Adds the glyph of a codepoint to the glyph table.
+		void addGlyph(std::uint32_t codepoint, std::uint32_t glyphIndex);
+
+	private:
+
+		/// FreeType library handle. Every family owns one, so fonts of different engine
+		/// contexts can be used from different threads.
+		FT_Library m_Library;
+		/// The file contents, FreeType reads from them as long as the face lives.
+		FileData m_FileData;
+		FT_Face m_Face;
+		/// First level of the glyph table. Holds one entry per page of codepoints: the number
+		/// of the page's block in m_PageBlocks, or 0 if the page has no glyphs.
+		std::vector<std::uint32_t> m_PageDirectory;
+		/// Second level of the glyph table. Blocks of glyph numbers, one per codepoint of a
+		/// page (InvalidGlyph for codepoints without glyph).
+		std::vector<std::uint32_t> m_PageBlocks;
+		/// Codepoint of each glyph.
+		std::vector<std::uint32_t> m_Codepoints;
+		/// Index of each glyph in the font face.
+		std::vector<std::uint32_t> m_Indices;
+		std::uint32_t m_MaxCodepoint;
+		/// Hash of m_FileData, 0 until GetContentHash is called.
+		mutable std::uint64_t m_ContentHash;
+	};
+}
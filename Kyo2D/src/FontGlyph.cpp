@@ -1,12 +0,0 @@
-#include "FontGlyph.h"
-
-
-namespace Kyo2D
-{
-	//=============================================================================
-	FontGlyph::FontGlyph(float advance, FontImage* image)
-		: m_advance(advance)
-		, m_image(image)
-	{
-	}
-}
@@ -0,0 +1,497 @@
+#include "GlyphAtlas.h"
+#include "Texture.h"
+#include "EngineContext.h"
+#include <algorithm>
+
+namespace
+{
+	/// Fraction of the budget the glyphs kept by a compaction may fill, so the atlas has room
+	/// to grow before the next compaction.
+	const double COMPACTION_TARGET = 0.5;
+}
+
+namespace Kyo2D
+{
+	const std::int32_t GlyphAtlas::PageSize;
+	const std::int32_t GlyphAtlas::Padding;
+	const std::uint64_t GlyphAtlas::DefaultBudget;
+
+	GlyphAtlas::GlyphAtlas()
+		: m_Stats()
+		, m_Generation(0)
+		, m_NextSerial(0)
+		, m_Frame(1)
+		, m_Budget(DefaultBudget)
+		, m_CompactionLimit(0)
+		, m_BlockedFrameBytes(0)
+	{
+	}
+
+	GlyphAtlas::~GlyphAtlas()
+	{
+	}
+
+	bool GlyphAtlas::Insert(std::int32_t width, std::int32_t height, const std::uint32_t *pixels, Region &out_region)
+	{
+		std::int32_t x = 0, y = 0;
+		Page *page = Allocate(page_kind::Color, width, height, x, y);
+
+		// Upload only the area of the glyph
+		if (!page || !page->Image->UpdateRegion(x, y, width, height, pixels))
+			return false;
+
+		AddGlyph(page_kind::Color, *page, x, y, width, height, pixels,
+			static_cast<std::uint64_t>(width) * static_cast<std::uint64_t>(height) * 4, out_region);
+		return true;
+	}
+
+	bool GlyphAtlas::Insert(std::int32_t width, std::int32_t height, const std::uint8_t *alpha, Region &out_region)
+	{
+		std::int32_t x = 0, y = 0;
+		Page *page = Allocate(page_kind::Alpha, width, height, x, y);
+		if (!page)
+			return false;
+
+		const std::uint32_t bytes = UploadAlpha(*page, x, y, width, height, alpha);
+		if (!bytes)
+			return false;
+
+		AddGlyph(page_kind::Alpha, *page, x, y, width, height, alpha, bytes, out_region);
+		return true;
+	}
+
+	bool GlyphAtlas::InsertDistanceField(std::int32_t width, std::int32_t height, const std::uint8_t *distances, Region &out_region)
+	{
+		std::int32_t x = 0, y = 0;
+		Page *page = Allocate(page_kind::DistanceField, width, height, x, y);
+		if (!page)
+			return false;
+
+		const std::uint32_t bytes = UploadAlpha(*page, x, y, width, height, distances);
+		if (!bytes)
+			return false;
+
+		AddGlyph(page_kind::DistanceField, *page, x, y, width, height, distances, bytes, out_region);
+		return true;
+	}
+
+	void GlyphAtlas::Clear()
+	{
+		for (auto &page : m_Pages)
+		{
+			g_Context->Residency.Remove(page.TextureId);
+			g_Context->Textures.erase(page.TextureId);
+		}
+
+		m_Pages.clear();
+		m_Entries.clear();
+		m_FreeEntries.clear();
+		m_Stats = Stats();
+		m_CompactionLimit = 0;
+		m_BlockedFrameBytes = 0;
+		++m_Generation;
+	}
+
+	bool GlyphAtlas::Find(const Handle &glyph, Region &out_region) const
+	{
+		if (glyph.Serial == 0 || glyph.Entry >= m_Entries.size() || m_Entries[glyph.Entry].Serial != glyph.Serial)
+			return false;
+
+		const Entry &entry = m_Entries[glyph.Entry];
+		out_region.TextureId = entry.TextureId;
+		out_region.X = entry.X;
+		out_region.Y = entry.Y;
+		out_region.Glyph = glyph;
+		return true;
+	}
+
+	void GlyphAtlas::EndFrame()
+	{
+		if (m_Budget != 0 && m_Stats.Memory > m_Budget)
+		{
+			std::uint64_t pixelBytes[3];
+			GetPixelBytes(pixelBytes);
+
+			// Compaction only helps if some glyphs haven't been drawn in this frame
+			bool stale = false;
+			std::uint64_t frameBytes = 0;
+			for (const Entry &entry : m_Entries)
+			{
+				if (entry.Serial == 0)
+					continue;
+
+				if (entry.LastUsed == m_Frame)
+				{
+					frameBytes += static_cast<std::uint64_t>(entry.Width + Padding) * static_cast<std::uint64_t>(entry.Height + Padding) *
+						pixelBytes[static_cast<int>(entry.Kind)];
+				}
+				else
+				{
+					stale = true;
+				}
+			}
+
+			// After a compaction which couldn't get under the budget, wait until the atlas has grown by
+			// the headroom a compaction normally leaves, or until fewer glyphs are drawn per frame
+			const std::uint64_t target = static_cast<std::uint64_t>(m_Budget * COMPACTION_TARGET);
+			bool shrunk = frameBytes <= target && frameBytes < m_BlockedFrameBytes;
+			if (stale && (m_Stats.Memory > m_CompactionLimit || shrunk))
+				Compact();
+		}
+
+		++m_Frame;
+	}
+
+	void GlyphAtlas::Compact()
+	{
+		K2D_PROFILE_SCOPE(g_Context->Profiler, "GlyphAtlas::Compact");
+
+		// Most recently drawn glyphs first
+		std::vector<std::uint32_t> live;
+		for (std::uint32_t i = 0; i < m_Entries.size(); ++i)
+		{
+			if (m_Entries[i].Serial != 0)
+				live.push_back(i);
+		}
+		std::stable_sort(live.begin(), live.end(), [this](std::uint32_t a, std::uint32_t b)
+		{
+			return m_Entries[a].LastUsed > m_Entries[b].LastUsed;
+		});
+
+		std::uint64_t pixelBytes[3];
+		GetPixelBytes(pixelBytes);
+
+		// Glyphs of the current frame stay, older ones as long as they fit into the target
+		const std::uint64_t target = static_cast<std::uint64_t>(m_Budget * COMPACTION_TARGET);
+		std::uint64_t kept = 0;
+		size_t keep = 0;
+		for (; keep < live.size(); ++keep)
+		{
+			const Entry &entry = m_Entries[live[keep]];
+			const std::uint64_t bytes = static_cast<std::uint64_t>(entry.Width + Padding) * static_cast<std::uint64_t>(entry.Height + Padding) *
+				pixelBytes[static_cast<int>(entry.Kind)];
+			if (entry.LastUsed != m_Frame && kept + bytes > target)
+				break;
+			kept += bytes;
+		}
+
+		for (size_t i = keep; i < live.size(); ++i)
+		{
+			Entry &entry = m_Entries[live[i]];
+			entry.Serial = 0;
+			std::vector<std::uint8_t>().swap(entry.Image);
+			m_FreeEntries.push_back(live[i]);
+			m_Stats.GlyphsEvicted++;
+		}
+		live.resize(keep);
+
+		// Pack the kept glyphs again from the tallest down, which leaves the least space under the skylines
+		std::stable_sort(live.begin(), live.end(), [this](std::uint32_t a, std::uint32_t b)
+		{
+			return m_Entries[a].Height > m_Entries[b].Height;
+		});
+
+		for (Page &page : m_Pages)
+		{
+			SkylineNode ground = { 0, 0, PageSize };
+			page.Skyline.assign(1, ground);
+		}
+
+		std::vector<std::vector<std::uint32_t>> pageEntries(m_Pages.size());
+		m_Stats.Glyphs = 0;
+		m_Stats.UsedPixels = 0;
+		for (std::uint32_t index : live)
+		{
+			Entry &entry = m_Entries[index];
+			const Page *page = Allocate(entry.Kind, entry.Width, entry.Height, entry.X, entry.Y);
+			if (!page)
+			{
+				entry.Serial = 0;
+				std::vector<std::uint8_t>().swap(entry.Image);
+				m_FreeEntries.push_back(index);
+				m_Stats.GlyphsEvicted++;
+				continue;
+			}
+
+			const size_t pageIndex = page - m_Pages.data();
+			pageEntries.resize(m_Pages.size());
+			pageEntries[pageIndex].push_back(index);
+			entry.TextureId = page->TextureId;
+			m_Stats.Glyphs++;
+			m_Stats.UsedPixels += static_cast<std::uint64_t>(entry.Width + Padding) * static_cast<std::uint64_t>(entry.Height + Padding);
+		}
+
+		// Pages left empty are destroyed, the others get their glyphs at the new positions
+		size_t count = 0;
+		std::uint64_t uploaded = 0;
+		m_Stats.Memory = 0;
+		for (size_t i = 0; i < m_Pages.size(); ++i)
+		{
+			Page &page = m_Pages[i];
+			if (pageEntries[i].empty())
+			{
+				g_Context->Residency.Remove(page.TextureId);
+				g_Context->Textures.erase(page.TextureId);
+				continue;
+			}
+
+			uploaded += UploadPage(page, pageEntries[i]);
+			page.Image->IncrementVersion();
+			m_Stats.Memory += page.Image->GetMemoryUsage();
+			if (count != i)
+				m_Pages[count] = std::move(page);
+			++count;
+		}
+		m_Pages.resize(count);
+
+		m_Stats.Pages = static_cast<std::uint32_t>(count);
+		m_Stats.TotalPixels = static_cast<std::uint64_t>(count) * static_cast<std::uint64_t>(PageSize) * static_cast<std::uint64_t>(PageSize);
+		m_Stats.BytesUploaded += uploaded;
+		m_Stats.Compactions++;
+		g_Context->Stats.BytesUploaded += uploaded;
+		++m_Generation;
+
+		// The glyphs of this frame alone exceed the budget
+		if (m_Stats.Memory > m_Budget)
+		{
+			m_CompactionLimit = m_Stats.Memory + (m_Budget - target);
+			m_BlockedFrameBytes = kept;
+		}
+		else
+		{
+			m_CompactionLimit = 0;
+			m_BlockedFrameBytes = 0;
+		}
+	}
+
+	void GlyphAtlas::GetPixelBytes(std::uint64_t (&out_bytes)[3]) const
+	{
+		out_bytes[0] = out_bytes[1] = out_bytes[2] = 4;
+		for (const Page &page : m_Pages)
+		{
+			if (page.Image->IsAlphaOnly())
+				out_bytes[static_cast<int>(page.Kind)] = 1;
+		}
+	}
+
+	std::uint64_t GlyphAtlas::UploadPage(Page &page, const std::vector<std::uint32_t> &entries)
+	{
+		const size_t pixels = static_cast<size_t>(PageSize) * static_cast<size_t>(PageSize);
+
+		if (page.Image->IsAlphaOnly())
+		{
+			std::vector<std::uint8_t> staging(pixels, 0);
+			for (std::uint32_t index : entries)
+			{
+				const Entry &entry = m_Entries[index];
+				for (std::int32_t row = 0; row < entry.Height; ++row)
+				{
+					std::copy_n(entry.Image.data() + static_cast<size_t>(row) * entry.Width, entry.Width,
+						staging.data() + static_cast<size_t>(entry.Y + row) * PageSize + entry.X);
+				}
+			}
+			return page.Image->UpdateAlphaRegion(0, 0, PageSize, PageSize, staging.data()) ? pixels : 0;
+		}
+
+		// Alpha glyphs in a page which fell back to 32 bit pixels become white with the values as alpha
+		std::vector<std::uint32_t> staging(pixels, 0);
+		std::vector<std::uint32_t> converted;
+		for (std::uint32_t index : entries)
+		{
+			const Entry &entry = m_Entries[index];
+			const std::uint32_t *source = reinterpret_cast<const std::uint32_t*>(entry.Image.data());
+			if (entry.Kind != page_kind::Color)
+			{
+				converted.resize(static_cast<size_t>(entry.Width) * entry.Height);
+				Texture::ConvertPixels(K2D_PIXEL_A8, entry.Image.data(), entry.Width, entry.Height, entry.Width, converted.data());
+				source = converted.data();
+			}
+
+			for (std::int32_t row = 0; row < entry.Height; ++row)
+			{
+				std::copy_n(source + static_cast<size_t>(row) * entry.Width, entry.Width,
+					staging.data() + static_cast<size_t>(entry.Y + row) * PageSize + entry.X);
+			}
+		}
+		return page.Image->UpdateRegion(0, 0, PageSize, PageSize, staging.data()) ? pixels * 4 : 0;
+	}
+
+	GlyphAtlas::Page *GlyphAtlas::Allocate(page_kind kind, std::int32_t width, std::int32_t height, std::int32_t &out_x, std::int32_t &out_y)
+	{
+		const std::int32_t paddedWidth = width + Padding;
+		const std::int32_t paddedHeight = height + Padding;
+		if (width <= 0 || height <= 0 || paddedWidth > PageSize || paddedHeight > PageSize)
+			return nullptr;
+
+		// Look for space in the existing pages first, older pages are usually the fuller ones
+		size_t node = 0;
+		size_t pageIndex = 0;
+		for (; pageIndex < m_Pages.size(); ++pageIndex)
+		{
+			if (m_Pages[pageIndex].Kind == kind &&
+				FindPosition(m_Pages[pageIndex], paddedWidth, paddedHeight, node, out_x, out_y))
+				break;
+		}
+
+		if (pageIndex == m_Pages.size())
+		{
+			if (!AddPage(kind) || !FindPosition(m_Pages.back(), paddedWidth, paddedHeight, node, out_x, out_y))
+				return nullptr;
+		}
+
+		Page &page = m_Pages[pageIndex];
+		AddLevel(page, node, out_x, out_y, paddedWidth, paddedHeight);
+		return &page;
+	}
+
+	std::uint32_t GlyphAtlas::UploadAlpha(Page &page, std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const std::uint8_t *alpha)
+	{
+		const std::uint32_t count = static_cast<std::uint32_t>(width) * static_cast<std::uint32_t>(height);
+		if (page.Image->IsAlphaOnly())
+			return page.Image->UpdateAlphaRegion(x, y, width, height, alpha) ? count : 0;
+
+		// The page fell back to 32 bit pixels, the glyph becomes white with the values as alpha
+		std::vector<std::uint32_t> pixels(count);
+		Texture::ConvertPixels(K2D_PIXEL_A8, alpha, width, height, width, pixels.data());
+		return page.Image->UpdateRegion(x, y, width, height, pixels.data()) ? count * 4 : 0;
+	}
+
+	void GlyphAtlas::AddGlyph(page_kind kind, const Page &page, std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height,
+		const void *image, std::uint64_t bytes, Region &out_region)
+	{
+		std::uint32_t index;
+		if (m_FreeEntries.empty())
+		{
+			index = static_cast<std::uint32_t>(m_Entries.size());
+			m_Entries.emplace_back();
+		}
+		else
+		{
+			index = m_FreeEntries.back();
+			m_FreeEntries.pop_back();
+		}
+
+		// Serials start at 1 and are never reused, so handles of evicted glyphs stay invalid
+		Entry &entry = m_Entries[index];
+		entry.Serial = ++m_NextSerial;
+		entry.TextureId = page.TextureId;
+		entry.X = x;
+		entry.Y = y;
+		entry.Width = width;
+		entry.Height = height;
+		entry.Kind = kind;
+		entry.LastUsed = m_Frame;
+		const std::uint8_t *bytesIn = static_cast<const std::uint8_t*>(image);
+		entry.Image.assign(bytesIn, bytesIn + static_cast<size_t>(width) * height * (kind == page_kind::Color ? 4 : 1));
+
+		out_region.TextureId = page.TextureId;
+		out_region.X = x;
+		out_region.Y = y;
+		out_region.Glyph.Entry = index;
+		out_region.Glyph.Serial = entry.Serial;
+
+		m_Stats.Glyphs++;
+		m_Stats.UsedPixels += static_cast<std::uint64_t>(width + Padding) * static_cast<std::uint64_t>(height + Padding);
+		m_Stats.BytesUploaded += bytes;
+		g_Context->Stats.BytesUploaded += bytes;
+	}
+
+	bool GlyphAtlas::FindPosition(const Page &page, std::int32_t width, std::int32_t height, size_t &out_node, std::int32_t &out_x, std::int32_t &out_y)
+	{
+		std::int32_t bestBottom = PageSize + 1;
+
+		for (size_t i = 0; i < page.Skyline.size(); ++i)
+		{
+			const std::int32_t x = page.Skyline[i].X;
+			if (x + width > PageSize)
+				break;
+
+			// The rectangle rests on the highest segment below it
+			std::int32_t y = 0;
+			std::int32_t remaining = width;
+			for (size_t j = i; remaining > 0; ++j)
+			{
+				y = std::max<std::int32_t>(y, page.Skyline[j].Y);
+				remaining -= page.Skyline[j].Width;
+			}
+
+			if (y + height <= PageSize && y + height < bestBottom)
+			{
+				bestBottom = y + height;
+				out_node = i;
+				out_x = x;
+				out_y = y;
+			}
+		}
+
+		return bestBottom <= PageSize;
+	}
+
+	void GlyphAtlas::AddLevel(Page &page, size_t node, std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height)
+	{
+		SkylineNode level = { x, y + height, width };
+		page.Skyline.insert(page.Skyline.begin() + node, level);
+
+		// Cut the segments covered by the new one
+		for (size_t i = node + 1; i < page.Skyline.size(); )
+		{
+			const SkylineNode &previous = page.Skyline[i - 1];
+			SkylineNode &current = page.Skyline[i];
+			const std::int32_t overlap = previous.X + previous.Width - current.X;
+			if (overlap <= 0)
+				break;
+
+			current.X += overlap;
+			current.Width -= overlap;
+			if (current.Width > 0)
+				break;
+
+			page.Skyline.erase(page.Skyline.begin() + i);
+		}
+
+		// Merge neighbours at the same height
+		for (size_t i = 1; i < page.Skyline.size(); )
+		{
+			if (page.Skyline[i - 1].Y == page.Skyline[i].Y)
+			{
+				page.Skyline[i - 1].Width += page.Skyline[i].Width;
+				page.Skyline.erase(page.Skyline.begin() + i);
+			}
+			else
+			{
+				++i;
+			}
+		}
+	}
+
+	bool GlyphAtlas::AddPage(page_kind kind)
+	{
+		std::shared_ptr<Texture> texture = CreateTextureInstance(0, 0);
+		if (!texture)
+			return false;
+
+		// Backends without alpha-only textures get 32 bit pages for every kind
+		bool initialized = kind != page_kind::Color && texture->InitializeAlpha(PageSize, PageSize, nullptr);
+		if (!initialized)
+			initialized = texture->InitializePixels(PageSize, PageSize, nullptr);
+		if (!initialized)
+			return false;
+
+		texture->SetDistanceField(kind == page_kind::DistanceField);
+
+		g_Context->Stats.TexturesCreated++;
+
+		Page page;
+		page.TextureId = RegisterTexture(texture);
+		page.Image = std::move(texture);
+		SkylineNode ground = { 0, 0, PageSize };
+		page.Skyline.push_back(ground);
+		page.Kind = kind;
+		m_Stats.Memory += page.Image->GetMemoryUsage();
+		m_Pages.push_back(std::move(page));
+
+		m_Stats.Pages++;
+		m_Stats.TotalPixels += static_cast<std::uint64_t>(PageSize) * static_cast<std::uint64_t>(PageSize);
+		return true;
+	}
+}
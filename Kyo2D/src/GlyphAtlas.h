@@ -0,0 +1,210 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace Kyo2D
+{
+	class Texture;
+
+	/// Texture atlas shared by the glyphs of all fonts of a context, so text in different fonts
+	/// and sizes is drawn from the same textures. Glyphs are inserted one at a time when they
+	/// are first drawn and packed into large pages with a skyline packer. Only the area of a new
+	/// glyph is uploaded. Color glyphs, alpha-only glyphs and distance fields are kept in separate
+	/// pages. The latter two use one byte per pixel, unless the backend has no alpha-only textures
+	/// and their pages fall back to white pixels.
+	///
+	/// The memory of the pages is bounded by a budget. Each glyph remembers the frame it was last
+	/// drawn in. Inserting never evicts, so a frame can always draw its glyphs. When a frame ends with
+	/// the pages over budget, the glyphs which haven't been drawn for the longest time are evicted
+	/// and the remaining ones are packed into as few pages as possible. If the glyphs of a frame alone
+	/// exceed the budget, compacting every frame would upload all pages again for a few evicted
+	/// glyphs. The atlas then grows by the usual headroom before it is compacted again.
+	class GlyphAtlas
+	{
+	public:
+
+		/// Edge length of a page in pixels.
+		static const std::int32_t PageSize = 1024;
+		/// Empty pixels kept to the right and below each glyph, so filtering doesn't pick up neighbours.
+		static const std::int32_t Padding = 1;
+
+		/// Default budget for the memory of the pages in bytes.
+		static const std::uint64_t DefaultBudget = 64ull * 1024 * 1024;
+
+		/// Identifies a stored glyph. Stays valid while the glyph moves during compaction and
+		/// becomes invalid when the glyph is evicted.
+		struct Handle
+		{
+			/// Index of the glyph in the atlas.
+			std::uint32_t Entry;
+			/// Number the glyph was stored with, 0 for no glyph.
+			std::uint32_t Serial;
+		};
+
+		/// Location of a glyph in the atlas.
+		struct Region
+		{
+			/// Id of the page texture.
+			std::uint32_t TextureId;
+			/// Position of the glyph in the page.
+			std::int32_t X, Y;
+			/// Handle of the glyph, see Find.
+			Handle Glyph;
+		};
+
+		/// Usage statistics of the atlas.
+		struct Stats
+		{
+			/// Number of pages.
+			std::uint32_t Pages;
+			/// Number of glyphs stored.
+			std::uint32_t Glyphs;
+			/// Pixels allocated to glyphs, including padding.
+			std::uint64_t UsedPixels;
+			/// Pixels of all pages.
+			std::uint64_t TotalPixels;
+			/// Bytes uploaded for new glyphs.
+			std::uint64_t BytesUploaded;
+			/// Texture memory of all pages in bytes.
+			std::uint64_t Memory;
+			/// Glyphs evicted to stay within the budget.
+			std::uint64_t GlyphsEvicted;
+			/// Number of times the pages have been compacted.
+			std::uint32_t Compactions;
+		};
+
+	public:
+
+		/// Default constructor. Pages are created when the first glyph is inserted.
+		GlyphAtlas();
+		/// Destructor.
+		~GlyphAtlas();
+
+		GlyphAtlas(const GlyphAtlas&) = delete;
+		GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+		/// Stores a glyph image in the atlas, adding a page if the glyph doesn't fit into the existing ones.
+		/// @param width Width of the image in pixels.
+		/// @param height Height of the image in pixels.
+		/// @param pixels width * height pixels in 0xAABBGGRR format.
+		/// @param out_region Receives the location of the glyph.
+		/// @return false if the glyph is larger than a page or the page couldn't be created.
+		bool Insert(std::int32_t width, std::int32_t height, const std::uint32_t *pixels, Region &out_region);
+		/// Stores an alpha-only glyph image in the atlas. The glyph is drawn in the sprite color.
+		/// @param alpha width * height coverage values.
+		/// @return false if the glyph is larger than a page or the page couldn't be created.
+		bool Insert(std::int32_t width, std::int32_t height, const std::uint8_t *alpha, Region &out_region);
+		/// Stores the distance field of a glyph in the atlas (see DistanceField). Its pages are
+		/// marked with Texture::SetDistanceField.
+		/// @param distances width * height distance values.
+		/// @return false if the glyph is larger than a page or the page couldn't be created.
+		bool InsertDistanceField(std::int32_t width, std::int32_t height, const std::uint8_t *distances, Region &out_region);
+		/// Destroys all pages. Glyph regions handed out before are invalid afterwards.
+		void Clear();
+		/// Gets the current location of a glyph.
+		/// @return false if the glyph has been evicted or the atlas has been cleared.
+		bool Find(const Handle &glyph, Region &out_region) const;
+		/// Marks a glyph as drawn in the current frame, which protects it from eviction at the end of the frame.
+		/// @param entry Handle::Entry of the glyph.
+		inline void Touch(std::uint32_t entry) { if (entry < m_Entries.size()) m_Entries[entry].LastUsed = m_Frame; }
+		/// Ends a frame. Evicts glyphs and compacts the pages if they exceed the budget. Call once
+		/// per presented frame, after the frame has been drawn.
+		void EndFrame();
+		/// Sets the budget for the memory of the pages in bytes, 0 disables the budget. Takes effect at the end of the frame.
+		inline void SetBudget(std::uint64_t budget) { m_Budget = budget; m_CompactionLimit = 0; m_BlockedFrameBytes = 0; }
+		/// Gets the budget for the memory of the pages in bytes.
+		inline std::uint64_t GetBudget() const { return m_Budget; }
+		/// Gets the usage statistics.
+		inline const Stats &GetStats() const { return m_Stats; }
+		/// Gets a number which changes whenever the atlas is cleared or compacted. Owners of glyph
+		/// regions compare it to the value they saw when inserting to detect that their regions
+		/// moved, and look them up again with Find.
+		inline std::uint32_t GetGeneration() const { return m_Generation; }
+
+	private:
+
+		/// Kinds of glyph images, each kind has its own pages.
+		enum class page_kind
+		{
+			Color,
+			Alpha,
+			DistanceField
+		};
+
+		/// A segment of the skyline: the lowest free row over a range of columns.
+		struct SkylineNode
+		{
+			std::int32_t X, Y, Width;
+		};
+
+		/// A page texture and the skyline of its allocated area.
+		struct Page
+		{
+			std::uint32_t TextureId;
+			std::shared_ptr<Texture> Image;
+			std::vector<SkylineNode> Skyline;
+			page_kind Kind;
+		};
+
+		/// A stored glyph. A copy of the image is kept, so the glyph can be moved to another page.
+		struct Entry
+		{
+			/// 0 if the entry is unused.
+			std::uint32_t Serial;
+			std::uint32_t TextureId;
+			std::int32_t X, Y, Width, Height;
+			page_kind Kind;
+			/// Frame the glyph was last drawn in.
+			std::uint64_t LastUsed;
+			/// 4 bytes per pixel for color glyphs, one byte otherwise.
+			std::vector<std::uint8_t> Image;
+		};
+
+	private:
+
+		/// Allocates the area of a glyph in a page of the given kind, adding a page if necessary.
+		/// @return The page, or nullptr if the glyph is too large or the page couldn't be created.
+		Page *Allocate(page_kind kind, std::int32_t width, std::int32_t height, std::int32_t &out_x, std::int32_t &out_y);
+		/// Stores one byte per pixel glyph image at the given position of an alpha or distance field page.
+		/// @return The number of bytes uploaded, 0 if the upload failed.
+		static std::uint32_t UploadAlpha(Page &page, std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const std::uint8_t *alpha);
+		/// Remembers a newly stored glyph and updates the statistics.
+		/// @param image The glyph image in the format of the page kind.
+		void AddGlyph(page_kind kind, const Page &page, std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height,
+			const void *image, std::uint64_t bytes, Region &out_region);
+		/// Evicts the least recently drawn glyphs until the rest fit into half the budget, keeping
+		/// the glyphs of the current frame, and packs the remaining glyphs into new positions.
+		void Compact();
+		/// Gets the bytes per pixel of the pages of each kind.
+		void GetPixelBytes(std::uint64_t (&out_bytes)[3]) const;
+		/// Uploads the images of the glyphs of a page after compaction.
+		/// @return The number of bytes uploaded, 0 if the upload failed.
+		std::uint64_t UploadPage(Page &page, const std::vector<std::uint32_t> &entries);
+		/// Finds the position with the lowest bottom edge for a rectangle (bottom-left heuristic).
+		/// @return false if the rectangle doesn't fit into the page.
+		static bool FindPosition(const Page &page, std::int32_t width, std::int32_t height, size_t &out_node, std::int32_t &out_x, std::int32_t &out_y);
+		/// Raises the skyline over a newly allocated rectangle.
+		static void AddLevel(Page &page, size_t node, std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height);
+		/// Creates a new empty page. Alpha and distance field pages store one byte per pixel
+		/// if the backend supports it.
+		bool AddPage(page_kind kind);
+
+	private:
+
+		std::vector<Page> m_Pages;
+		std::vector<Entry> m_Entries;
+		/// Indices of unused entries.
+		std::vector<std::uint32_t> m_FreeEntries;
+		Stats m_Stats;
+		std::uint32_t m_Generation;
+		std::uint32_t m_NextSerial;
+		std::uint64_t m_Frame;
+		std::uint64_t m_Budget;
+		/// Memory above which the atlas is compacted while the glyphs of a frame exceed the budget, 0 otherwise.
+		std::uint64_t m_CompactionLimit;
+		/// Bytes of the glyphs kept by the last compaction that couldn't get under the budget.
+		std::uint64_t m_BlockedFrameBytes;
+	};
+}
@@ -0,0 +1,301 @@
+#include "GlyphCache.h"
+#include "GlyphAtlas.h"
+#include "Hash.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	const char CACHE_MAGIC[4] = { 'K', '2', 'G', 'C' };
+	/// Images start at multiples of this in the data, so pixels can be read in place.
+	const size_t IMAGE_ALIGNMENT = 8;
+}
+
+namespace Kyo2D
+{
+	const std::uint32_t GlyphCache::FormatVersion;
+	const size_t GlyphCache::MaxAddedBytes;
+
+	GlyphCache::GlyphCache()
+		: m_Key()
+		, m_Records(nullptr)
+		, m_RecordCount(0)
+		, m_Metrics(nullptr)
+		, m_MetricCount(0)
+		, m_Data(nullptr)
+		, m_AddedBytes(0)
+		, m_MetricsChanged(false)
+	{
+	}
+
+	GlyphCache::~GlyphCache()
+	{
+	}
+
+	bool GlyphCache::Open(const std::wstring &directory, const Key &key)
+	{
+		m_Key = key;
+		m_Records = nullptr;
+		m_RecordCount = 0;
+		m_Metrics = nullptr;
+		m_MetricCount = 0;
+		m_Data = nullptr;
+		m_Added.clear();
+		m_AddedBytes = 0;
+		m_NewMetrics.clear();
+		m_MetricsChanged = false;
+
+		// One file per key, named after the hash of the key
+		static const wchar_t digits[] = L"0123456789abcdef";
+		std::uint64_t hash = Hash(&key, sizeof(key));
+		std::wstring name(16, L'0');
+		for (int i = 15; i >= 0; --i, hash >>= 4)
+			name[i] = digits[hash & 0xF];
+
+		m_Filename = directory;
+		if (!m_Filename.empty() && m_Filename.back() != L'/' && m_Filename.back() != L'\\')
+			m_Filename += L'/';
+		m_Filename += name + L".k2dglyphs";
+		return MapFile();
+	}
+
+	bool GlyphCache::MapFile()
+	{
+		if (!m_File.Open(m_Filename))
+			return false;
+
+		if (!Validate())
+		{
+			m_File.Close();
+			return false;
+		}
+
+		const FileHeader *header = reinterpret_cast<const FileHeader*>(m_File.GetData());
+		m_Records = reinterpret_cast<const Record*>(header + 1);
+		m_RecordCount = header->GlyphCount;
+		m_Metrics = reinterpret_cast<const float*>(m_Records + m_RecordCount);
+		m_MetricCount = header->MetricCount;
+		m_Data = reinterpret_cast<const std::uint8_t*>(m_Metrics) + GetMetricsSize(m_MetricCount);
+		return true;
+	}
+
+	bool GlyphCache::Validate() const
+	{
+		const size_t size = m_File.GetSize();
+		if (size < sizeof(FileHeader))
+			return false;
+
+		// A file of another key would only collide in its name
+		const FileHeader *header = reinterpret_cast<const FileHeader*>(m_File.GetData());
+		if (memcmp(header->Magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+			header->Version != FormatVersion ||
+			memcmp(&header->Font, &m_Key, sizeof(Key)) != 0)
+			return false;
+
+		const size_t indexSize = static_cast<size_t>(header->GlyphCount) * sizeof(Record);
+		const size_t metricsSize = GetMetricsSize(header->MetricCount);
+		if (header->GlyphCount > (size - sizeof(FileHeader)) / sizeof(Record) ||
+			header->MetricCount > (size - sizeof(FileHeader)) / sizeof(float) ||
+			metricsSize > size - sizeof(FileHeader) - indexSize ||
+			header->DataSize != size - sizeof(FileHeader) - indexSize - metricsSize)
+			return false;
+
+		const Record *records = reinterpret_cast<const Record*>(header + 1);
+		const std::uint64_t checksum = Hash(records + header->GlyphCount, header->MetricCount * sizeof(float),
+			Hash(records, indexSize));
+		if (checksum != header->IndexChecksum)
+			return false;
+
+		// The checksum covers the index, but not that it was written by a correct writer
+		for (std::uint32_t i = 0; i < header->GlyphCount; ++i)
+		{
+			const Record &record = records[i];
+			if ((i > 0 && records[i - 1].Glyph >= record.Glyph) ||
+				record.Width < 0 || record.Width > GlyphAtlas::PageSize ||
+				record.Height < 0 || record.Height > GlyphAtlas::PageSize ||
+				record.Format > image_format::Pixels ||
+				record.Offset > header->DataSize ||
+				GetImageSize(record) > header->DataSize - record.Offset)
+				return false;
+		}
+
+		return true;
+	}
+
+	bool GlyphCache::Find(std::uint32_t glyph, Glyph &out_glyph) const
+	{
+		// Glyphs evicted from the glyph atlas come back from the added ones without rasterizing
+		const Record *record;
+		const std::uint8_t *data;
+		auto added = m_Added.find(glyph);
+		if (added != m_Added.end())
+		{
+			record = &added->second.Info;
+			data = added->second.Data.data();
+		}
+		else
+		{
+			if (!m_Records)
+				return false;
+
+			const Record *end = m_Records + m_RecordCount;
+			record = std::lower_bound(m_Records, end, glyph, [](const Record &r, std::uint32_t g) { return r.Glyph < g; });
+			if (record == end || record->Glyph != glyph)
+				return false;
+
+			data = m_Data + record->Offset;
+			if (Hash(data, GetImageSize(*record)) != record->Checksum)
+				return false;
+		}
+
+		out_glyph.Width = record->Width;
+		out_glyph.Height = record->Height;
+		out_glyph.BearingX = record->BearingX;
+		out_glyph.BearingY = record->BearingY;
+		out_glyph.Format = record->Format;
+		out_glyph.Data = data;
+		return true;
+	}
+
+	bool GlyphCache::Add(std::uint32_t glyph, const Glyph &image)
+	{
+		Record info;
+		info.Glyph = glyph;
+		info.Width = image.Width;
+		info.Height = image.Height;
+		info.BearingX = image.BearingX;
+		info.BearingY = image.BearingY;
+		info.Format = image.Data ? image.Format : image_format::None;
+		info.Offset = 0;
+
+		// A glyph added again replaces its image
+		auto it = m_Added.find(glyph);
+		const size_t previous = it != m_Added.end() ? it->second.Data.size() : 0;
+		const size_t size = GetImageSize(info);
+		if (m_AddedBytes - previous + size > MaxAddedBytes)
+			return false;
+
+		Added &added = m_Added[glyph];
+		const std::uint8_t *bytes = static_cast<const std::uint8_t*>(image.Data);
+		added.Info = info;
+		added.Data.assign(bytes, bytes + size);
+		added.Info.Checksum = Hash(added.Data.data(), added.Data.size());
+		m_AddedBytes = m_AddedBytes - previous + size;
+		return true;
+	}
+
+	std::uint32_t GlyphCache::GetMetrics(const float *&out_metrics) const
+	{
+		out_metrics = m_Metrics;
+		return m_MetricCount;
+	}
+
+	void GlyphCache::SetMetrics(std::vector<float> metrics)
+	{
+		m_MetricsChanged = metrics.size() != m_MetricCount ||
+			(m_MetricCount && memcmp(metrics.data(), m_Metrics, m_MetricCount * sizeof(float)) != 0);
+		m_NewMetrics = std::move(metrics);
+	}
+
+	bool GlyphCache::Save()
+	{
+		if ((m_Added.empty() && !m_MetricsChanged) || m_Filename.empty())
+			return false;
+
+		// Merge the cached glyphs with the added ones, which replace cached glyphs of the same
+		// number. Damaged images are dropped.
+		std::vector<Record> records;
+		std::vector<const std::uint8_t*> images;
+		auto added = m_Added.begin();
+		for (std::uint32_t i = 0; i <= m_RecordCount; ++i)
+		{
+			const std::uint32_t next = i < m_RecordCount ? m_Records[i].Glyph : 0xFFFFFFFF;
+			for (; added != m_Added.end() && added->first <= next; ++added)
+			{
+				records.push_back(added->second.Info);
+				images.push_back(added->second.Data.data());
+			}
+
+			if (i < m_RecordCount && (records.empty() || records.back().Glyph != next))
+			{
+				const std::uint8_t *data = m_Data + m_Records[i].Offset;
+				if (Hash(data, GetImageSize(m_Records[i])) == m_Records[i].Checksum)
+				{
+					records.push_back(m_Records[i]);
+					images.push_back(data);
+				}
+			}
+		}
+
+		size_t dataSize = 0;
+		for (Record &record : records)
+		{
+			record.Offset = dataSize;
+			dataSize += (GetImageSize(record) + IMAGE_ALIGNMENT - 1) & ~(IMAGE_ALIGNMENT - 1);
+		}
+
+		const float *metrics = m_MetricsChanged ? m_NewMetrics.data() : m_Metrics;
+		const std::uint32_t metricCount = m_MetricsChanged ? static_cast<std::uint32_t>(m_NewMetrics.size()) : m_MetricCount;
+		const size_t indexSize = records.size() * sizeof(Record);
+		const size_t metricsSize = GetMetricsSize(metricCount);
+		std::vector<std::uint8_t> file(sizeof(FileHeader) + indexSize + metricsSize + dataSize, 0);
+		if (metricCount)
+			memcpy(file.data() + sizeof(FileHeader) + indexSize, metrics, metricCount * sizeof(float));
+
+		FileHeader header = {};
+		memcpy(header.Magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+		header.Version = FormatVersion;
+		header.Font = m_Key;
+		header.GlyphCount = static_cast<std::uint32_t>(records.size());
+		header.MetricCount = metricCount;
+		header.IndexChecksum = Hash(file.data() + sizeof(FileHeader) + indexSize, metricCount * sizeof(float),
+			Hash(records.data(), indexSize));
+		header.DataSize = dataSize;
+		memcpy(file.data(), &header, sizeof(header));
+		if (indexSize)
+			memcpy(file.data() + sizeof(FileHeader), records.data(), indexSize);
+
+		std::uint8_t *data = file.data() + sizeof(FileHeader) + indexSize + metricsSize;
+		for (size_t i = 0; i < records.size(); ++i)
+		{
+			const size_t size = GetImageSize(records[i]);
+			if (size)
+				memcpy(data + records[i].Offset, images[i], size);
+		}
+
+		// The file can't be replaced while it is mapped
+		m_Records = nullptr;
+		m_RecordCount = 0;
+		m_Metrics = nullptr;
+		m_MetricCount = 0;
+		m_Data = nullptr;
+		m_File.Close();
+		m_Added.clear();
+		m_AddedBytes = 0;
+		m_NewMetrics.clear();
+		m_MetricsChanged = false;
+
+		const bool written = writeFileAtomic(m_Filename, file.data(), file.size());
+		MapFile();
+		return written;
+	}
+
+	size_t GlyphCache::GetMetricsSize(std::uint32_t count)
+	{
+		return (static_cast<size_t>(count) * sizeof(float) + IMAGE_ALIGNMENT - 1) & ~(IMAGE_ALIGNMENT - 1);
+	}
+
+	size_t GlyphCache::GetImageSize(const Record &record)
+	{
+		const size_t pixels = static_cast<size_t>(record.Width) * static_cast<size_t>(record.Height);
+		switch (record.Format)
+		{
+		case image_format::Alpha:
+			return pixels;
+		case image_format::Pixels:
+			return pixels * 4;
+		default:
+			return 0;
+		}
+	}
+}
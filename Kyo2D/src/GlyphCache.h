@@ -0,0 +1,171 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "File.h"
+
+namespace Kyo2D
+{
+	/// Rasterized glyph images and metrics of one font kept on disk between runs. The file of a font is found by
+	/// a key of the font contents, the size, the outline and the version of the rasterizer, so a
+	/// change to any of them starts a new file. The file is memory mapped when the font is created
+	/// and glyph images are read from it on first use instead of being rasterized. Images rasterized
+	/// while running are kept in memory and only written to the file by Save, which the application
+	/// triggers with K2D_SaveGlyphCaches.
+	///
+	/// The file starts with a header, followed by an index of the glyphs sorted by glyph number, the
+	/// metrics and the image data. The header and index are validated with a checksum when the file is opened,
+	/// each image when it is read, so a damaged file only costs the glyphs it damaged.
+	class GlyphCache
+	{
+	public:
+
+		/// Version of the file format.
+		static const std::uint32_t FormatVersion = 2;
+		/// Most bytes of images held for the next Save. Glyphs rasterized past it aren't kept, so a
+		/// long session without Save doesn't grow past the glyph atlas budget.
+		static const size_t MaxAddedBytes = 4 << 20;
+
+		/// Identifies the glyph images of a font.
+		struct Key
+		{
+			/// Hash of the font file contents.
+			std::uint64_t FontHash;
+			float PointSize;
+			float Outline;
+			/// 1 for distance field fonts.
+			std::uint32_t Flags;
+			/// Changes whenever the rasterizer renders different images.
+			std::uint32_t RasterizerVersion;
+		};
+
+		/// Pixel format of a glyph image.
+		enum class image_format : std::uint32_t
+		{
+			/// The glyph has no image (e.g. a space).
+			None,
+			/// One byte per pixel.
+			Alpha,
+			/// 4 bytes per pixel in 0xAABBGGRR format.
+			Pixels
+		};
+
+		/// A cached glyph image.
+		struct Glyph
+		{
+			std::int32_t Width, Height;
+			/// Horizontal and vertical bearing of the glyph in pixels.
+			float BearingX, BearingY;
+			image_format Format;
+			/// Width * Height pixels in Format, valid until the next Add or Save.
+			const void *Data;
+		};
+
+	public:
+
+		/// Default constructor.
+		GlyphCache();
+		/// Destructor. Doesn't save the glyphs added since opening, see Save.
+		~GlyphCache();
+
+		GlyphCache(const GlyphCache&) = delete;
+		GlyphCache& operator=(const GlyphCache&) = delete;
+
+		/// Opens the file of a font in a directory. Without a valid file the cache starts empty.
+		/// @param directory An existing directory.
+		/// @return false if the file doesn't exist or is invalid.
+		bool Open(const std::wstring &directory, const Key &key);
+		/// Looks up the image of a glyph in the file or the glyphs added since opening.
+		/// @param glyph The glyph number in the font family.
+		/// @return false if the glyph isn't cached or its image is damaged.
+		bool Find(std::uint32_t glyph, Glyph &out_glyph) const;
+		/// Adds the image of a glyph rasterized while running, which is written by the next Save.
+		/// @param image The image, which is copied. Data is ignored for image_format::None.
+		/// @return false if the image would exceed MaxAddedBytes and wasn't added.
+		bool Add(std::uint32_t glyph, const Glyph &image);
+		/// Gets the metrics stored in the file, see SetMetrics.
+		/// @return The number of values, 0 without valid file.
+		std::uint32_t GetMetrics(const float *&out_metrics) const;
+		/// Sets the metrics written by the next Save. The values aren't interpreted by the cache,
+		/// the font stores whatever it measured of its glyphs.
+		void SetMetrics(std::vector<float> metrics);
+		/// Writes the cached glyphs, the added ones and the metrics to the file and maps it again.
+		/// Does nothing if neither glyphs nor other metrics have been added.
+		/// @return false if the file couldn't be written.
+		bool Save();
+
+		/// Gets the name of the file of the cache.
+		inline const std::wstring &GetFilename() const { return m_Filename; }
+		/// Gets the bytes of the images added since opening or the last Save.
+		inline size_t GetAddedBytes() const { return m_AddedBytes; }
+
+	private:
+
+		/// Header at the start of the file.
+		struct FileHeader
+		{
+			char Magic[4];
+			std::uint32_t Version;
+			Key Font;
+			std::uint32_t GlyphCount;
+			/// Number of metric values following the index.
+			std::uint32_t MetricCount;
+			/// Checksum of the index and the metrics.
+			std::uint64_t IndexChecksum;
+			/// Size of the image data following the index.
+			std::uint64_t DataSize;
+		};
+
+		/// Index entry of a glyph.
+		struct Record
+		{
+			std::uint32_t Glyph;
+			std::int32_t Width, Height;
+			float BearingX, BearingY;
+			image_format Format;
+			/// Position of the image in the data.
+			std::uint64_t Offset;
+			/// Checksum of the image.
+			std::uint64_t Checksum;
+		};
+
+		/// A glyph added since opening.
+		struct Added
+		{
+			Record Info;
+			std::vector<std::uint8_t> Data;
+		};
+
+	private:
+
+		/// Gets the size of the image of a record in bytes.
+		static size_t GetImageSize(const Record &record);
+		/// Gets the size of the metrics in the file in bytes, including the padding of the data.
+		static size_t GetMetricsSize(std::uint32_t count);
+		/// Maps the file and points the index and data into it.
+		/// @return false if the file doesn't exist or is invalid.
+		bool MapFile();
+		/// Validates the mapped file.
+		bool Validate() const;
+
+	private:
+
+		std::wstring m_Filename;
+		Key m_Key;
+		MappedFile m_File;
+		/// Index and image data in the mapped file, nullptr without a valid file.
+		const Record *m_Records;
+		std::uint32_t m_RecordCount;
+		const float *m_Metrics;
+		std::uint32_t m_MetricCount;
+		const std::uint8_t *m_Data;
+		/// Glyphs added since opening, by glyph number.
+		std::map<std::uint32_t, Added> m_Added;
+		size_t m_AddedBytes;
+		/// Metrics set since opening, written instead of the ones in the file if m_MetricsChanged.
+		std::vector<float> m_NewMetrics;
+		bool m_MetricsChanged;
+	};
+}
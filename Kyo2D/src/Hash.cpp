@@ -0,0 +1,45 @@
+#include "Hash.h"
+#include <cstring>
+
+namespace Kyo2D
+{
+	std::uint64_t Hash(const void *data, size_t size, std::uint64_t seed)
+	{
+		const std::uint64_t m = 0xC6A4A7935BD1E995ULL;
+		const int r = 47;
+
+		const std::uint8_t *bytes = static_cast<const std::uint8_t*>(data);
+		std::uint64_t hash = seed ^ (static_cast<std::uint64_t>(size) * m);
+
+		// Whole words, memcpy compiles to a single unaligned load
+		const std::uint8_t *end = bytes + (size & ~static_cast<size_t>(7));
+		for (; bytes != end; bytes += 8)
+		{
+			std::uint64_t k;
+			std::memcpy(&k, bytes, sizeof(k));
+			k *= m;
+			k ^= k >> r;
+			k *= m;
+
+			hash ^= k;
+			hash *= m;
+		}
+
+		// Remaining bytes, the first one in the lowest bits
+		const size_t rest = size & 7;
+		if (rest)
+		{
+			std::uint64_t k = 0;
+			for (size_t i = rest; i-- > 0;)
+				k = (k << 8) | bytes[i];
+
+			hash ^= k;
+			hash *= m;
+		}
+
+		hash ^= hash >> r;
+		hash *= m;
+		hash ^= hash >> r;
+		return hash;
+	}
+}
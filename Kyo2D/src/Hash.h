@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Kyo2D
+{
+	/// Seed of a hash which doesn't continue another one.
+	const std::uint64_t HashSeed = 0x9E3779B97F4A7C15ULL;
+
+	/// Hashes a block of memory (MurmurHash64A), 8 bytes per step. Pass the hash of the previous
+	/// block as seed to hash several blocks as one key. The result depends on the byte order of
+	/// the machine, so it must not be stored in files which are shared between machines.
+	/// @param data The memory, doesn't have to be aligned.
+	/// @param size The size of the memory in bytes.
+	/// @param seed HashSeed or the hash of the previous block.
+	std::uint64_t Hash(const void *data, size_t size, std::uint64_t seed = HashSeed);
+}
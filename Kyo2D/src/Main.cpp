@@ -1,4 +1,5 @@
 #include "Kyo2D.h"
+#ifdef _WIN32
 #include "D3D11/RenderTargetD3D11.h"
 #include "D3D11/TextureD3D11.h"
 #include "D3D11/DrawHelperD3D11.h"
@@ -9,12 +10,42 @@
 #include "D3D9/DrawHelperD3D9.h"
 #include "D3D9/SpriteDrawerD3D9.h"
 #include "D3D9/TextDrawerD3D9.h"
+#endif
+#include "Software/RenderTargetSoftware.h"
+#include "Software/TextureSoftware.h"
+#include "Software/DrawHelperSoftware.h"
+#include "Software/SpriteDrawerSoftware.h"
+#include "Software/TextDrawerSoftware.h"
+#include "Null/RenderTargetNull.h"
+#include "Null/TextureNull.h"
+#include "Null/DrawHelperNull.h"
+#include "Null/SpriteDrawerNull.h"
+#include "Null/TextDrawerNull.h"
 #include "Font.h"
+#include "FontFamily.h"
+#include "TextLayout.h"
+#include "TextDocument.h"
+#include "TextureResidency.h"
+#include "DamageTracker.h"
+#include "Hash.h"
+#include "EngineContext.h"
+#include "Profiler.h"
+#include "Capture.h"
+#include "File.h"
 #include <vector>
 #include <string>
+#include <map>
+#include <mutex>
+#include <cmath>
+#include <fstream>
+#include <cstring>
+#ifndef K2D_NO_IMAGE_LOADER
 #include "IL/il.h"
+#endif
+#ifdef _WIN32
 using namespace Microsoft::WRL;
 using namespace DirectX;
+#endif
 
 
 
@@ -22,27 +53,10 @@ using namespace DirectX;
 // Link libraries
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+#ifdef _WIN32
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "d3d9.lib")
-
-
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-// D3D11 GLOBALS
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-ComPtr<ID3D11Device> g_D3DDevice11;
-ComPtr<ID3D11DeviceContext> g_D3DDeviceContext11;
-
-
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-// D3D9 GLOBALS
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-ComPtr<IDirect3D9> g_D3D9;
-ComPtr<IDirect3DDevice9> g_D3DDevice9;
-HWND g_D3D9Wnd = nullptr;
+#endif
 
 
 
@@ -50,99 +64,122 @@ HWND g_D3D9Wnd = nullptr;
 // SWITCH
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Direct3D only exists on Windows, other platforms have the software and null backends
+#ifdef _WIN32
 bool g_HasD3D11 = true;
-bool g_UseD3D11 = true;
-
-
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-// RENDER TARGET MANAGEMENT
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-std::uint32_t g_NextRenderTarget = 1;
-std::map<std::uint32_t, std::shared_ptr<Kyo2D::RenderTarget>> g_RenderTargets;
-std::weak_ptr<Kyo2D::RenderTarget> g_ActiveRenderTarget;
+#else
+bool g_HasD3D11 = false;
+#endif
 
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-// TEXTURE MANAGEMENT
+// CONTEXT MANAGEMENT
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-std::uint32_t g_NextTexture = 1;
-std::map<std::uint32_t, std::shared_ptr<Kyo2D::Texture>> g_Textures;
-
+// The default context is used by every thread that didn't select another one
+Kyo2D::EngineContext g_DefaultContext;
+thread_local Kyo2D::EngineContext *g_Context = &g_DefaultContext;
 
+std::mutex g_ContextMutex;
+std::uint32_t g_NextContext = 1;
+std::map<std::uint32_t, std::unique_ptr<Kyo2D::EngineContext>> g_Contexts;
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-// FONT MANAGEMENT
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-std::uint32_t g_NextFont = 1;
-std::map<std::uint32_t, std::shared_ptr<Kyo2D::Font>> g_Fonts;
+// Number of contexts using the image loader library
+std::uint32_t g_ImageLoaderUsers = 0;
 
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-// RENDER STAGE
+/// INTERNAL HELPER METHODS
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-// Draw helper
-std::shared_ptr<Kyo2D::DrawHelper> g_DrawHelper;
-std::shared_ptr<Kyo2D::SpriteDrawer> g_SpriteDrawer;
-
-// Render stage enumeration: Used to reduce d3d11 state changes to a minimum.
-namespace render_stage
+namespace Kyo2D
 {
-	enum Type
+	std::shared_ptr<Texture> CreateTextureInstance(std::uint32_t flags, std::uint32_t colorkey)
 	{
-		None			= 0,
-		Drawer2D		= 1,
-		Sprite			= 2,
-		SpriteScale2X	= 3
-	};
-}
-
-// Shortcut typedef
-typedef render_stage::Type RenderStage;
-
-// Caches the current render stage
-RenderStage g_RenderStage = render_stage::None;
+		std::shared_ptr<Texture> texture;
+		if (g_Context->UseNull)
+			texture = std::make_shared<TextureNull>();
+		else if (g_Context->UseSoftware)
+			texture = std::make_shared<TextureSoftware>();
+#ifdef _WIN32
+		else if (g_Context->UseD3D11)
+			texture = std::make_shared<TextureD3D11>();
+		else
+			texture = std::make_shared<TextureD3D9>();
+#endif
 
+		if (texture && (flags & (K2D_TEXTURE_PREMULTIPLIED | K2D_TEXTURE_BAKE_COLORKEY)))
+		{
+			texture->SetPremultiplied((flags & K2D_TEXTURE_BAKE_COLORKEY) != 0, colorkey);
+		}
 
+		return texture;
+	}
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-/// INTERNAL HELPER METHODS
-////////////////////////////////////////////////////////////////////////////////////////////////////
+	std::uint32_t RegisterTexture(std::shared_ptr<Texture> texture)
+	{
+		std::uint32_t textureId = g_Context->NextTexture++;
+		g_Context->Residency.Add(textureId, texture);
+		g_Context->Textures[textureId] = std::move(texture);
+		return textureId;
+	}
+}
 
 namespace
 {
 	/// Prepares the render state according to the required stage.
 	/// This method tries to change the render state as less as possible.
 	/// @param stage The render stage to prepare. This decides, what shaders and resource will be bound.
-	static void PrepareStage(RenderStage stage)
+	static void PrepareStage(Kyo2D::RenderStage stage)
 	{
-		if (g_RenderStage == stage)
+		if (g_Context->Stage == stage)
 			return;
 
+		g_Context->Stats.StageChanges++;
+
 		switch (stage)
 		{
-			case render_stage::Drawer2D:
+			case Kyo2D::render_stage::Drawer2D:
 			{
 				// Prepare the helper
-				g_DrawHelper->Prepare();
+				g_Context->DrawHelper->Prepare();
+				break;
+			}
+			case Kyo2D::render_stage::Sprite:
+			case Kyo2D::render_stage::SpriteScale2X:
+			case Kyo2D::render_stage::SpritePremultiplied:
+			case Kyo2D::render_stage::SpriteScale2XPremultiplied:
+			case Kyo2D::render_stage::SpriteAlpha:
+			case Kyo2D::render_stage::SpriteDistanceField:
+			{
+				g_Context->SpriteDrawer->SetPremultipliedAlpha(
+					stage == Kyo2D::render_stage::SpritePremultiplied ||
+					stage == Kyo2D::render_stage::SpriteScale2XPremultiplied);
+				g_Context->SpriteDrawer->SetAlphaTexture(stage == Kyo2D::render_stage::SpriteAlpha);
+				g_Context->SpriteDrawer->SetDistanceField(stage == Kyo2D::render_stage::SpriteDistanceField);
+				g_Context->SpriteDrawer->Prepare();
 				break;
 			}
-			case render_stage::Sprite:
-			case render_stage::SpriteScale2X:
+			case Kyo2D::render_stage::Text:
+			case Kyo2D::render_stage::TextAlpha:
+			case Kyo2D::render_stage::TextDistanceField:
 			{
-				g_SpriteDrawer->Prepare();
+				g_Context->TextDrawer->SetAlphaTexture(stage == Kyo2D::render_stage::TextAlpha);
+				g_Context->TextDrawer->SetDistanceField(stage == Kyo2D::render_stage::TextDistanceField);
+				g_Context->TextDrawer->Prepare();
+				break;
+			}
+			case Kyo2D::render_stage::None:
+			{
+				// Nothing to bind, the next draw call prepares its stage
 				break;
 			}
 		}
 
 		// Apply new stage
-		g_RenderStage = stage;
+		g_Context->Stage = stage;
 	}
 
 	/// Binds the requested texture (by id) to the shader stage for rendering. Also calls PrepareStage
@@ -153,12 +190,56 @@ namespace
 	/// @returns true on success, false otherwise.
 	static bool BindTextureStage(std::uint32_t texture, std::int32_t &outW, std::int32_t &outH)
 	{
-		if (!g_SpriteDrawer)
+		K2D_PROFILE_SCOPE(g_Context->Profiler, "BindTextureStage");
+
+		if (!g_Context->SpriteDrawer)
 			return false;
 
 		// Try to find the given texture
-		auto it = g_Textures.find(texture);
-		if (it == g_Textures.end())
+		auto it = g_Context->Textures.find(texture);
+		if (it == g_Context->Textures.end())
+		{
+			return false;
+		}
+
+		// Mark as used in this frame, restores evicted textures
+		if (!g_Context->Residency.Touch(*it->second))
+		{
+			return false;
+		}
+
+		outW = it->second->GetWidth();
+		outH = it->second->GetHeight();
+
+		// Change stage: Distance fields and alpha-only textures take their color from the vertices,
+		// premultiplied textures don't need the colorkey test
+		if (it->second->IsDistanceField())
+			PrepareStage(Kyo2D::render_stage::SpriteDistanceField);
+		else if (it->second->IsAlphaOnly())
+			PrepareStage(Kyo2D::render_stage::SpriteAlpha);
+		else if (it->second->IsPremultiplied())
+			PrepareStage(g_Context->SpriteDrawer->IsScale2XEnabled() ? Kyo2D::render_stage::SpriteScale2XPremultiplied : Kyo2D::render_stage::SpritePremultiplied);
+		else
+			PrepareStage(g_Context->SpriteDrawer->IsScale2XEnabled() ? Kyo2D::render_stage::SpriteScale2X : Kyo2D::render_stage::Sprite);
+
+		g_Context->Stats.TextureBinds++;
+		return it->second->Set();
+	}
+
+	/// Binds a glyph atlas page and prepares the text stage for its kind.
+	/// @returns true on success, false otherwise.
+	static bool BindGlyphPage(std::uint32_t texture, std::int32_t &outW, std::int32_t &outH)
+	{
+		if (!g_Context->TextDrawer)
+			return false;
+
+		auto it = g_Context->Textures.find(texture);
+		if (it == g_Context->Textures.end())
+		{
+			return false;
+		}
+
+		if (!g_Context->Residency.Touch(*it->second))
 		{
 			return false;
 		}
@@ -166,17 +247,297 @@ namespace
 		outW = it->second->GetWidth();
 		outH = it->second->GetHeight();
 
-		// Change stage
-		PrepareStage(g_SpriteDrawer->IsScale2XEnabled() ? render_stage::SpriteScale2X : render_stage::Sprite);
+		if (it->second->IsDistanceField())
+			PrepareStage(Kyo2D::render_stage::TextDistanceField);
+		else if (it->second->IsAlphaOnly())
+			PrepareStage(Kyo2D::render_stage::TextAlpha);
+		else
+			PrepareStage(Kyo2D::render_stage::Text);
 
+		g_Context->Stats.TextureBinds++;
 		return it->second->Set();
 	}
 
+	/// Draws a run of glyph quads of one atlas page immediately.
+	/// @returns false if the page is invalid.
+	static bool ExecuteGlyphs(std::uint32_t page, const Kyo2D::GlyphQuad *quads, size_t count, std::uint32_t color, std::uint32_t colorkey)
+	{
+		std::int32_t w = 0, h = 0;
+		if (!BindGlyphPage(page, w, h))
+			return false;
+
+		K2D_PROFILE_SCOPE(g_Context->Profiler, "DrawGlyphs");
+		g_Context->TextDrawer->DrawGlyphs(w, h, quads, count, color, colorkey);
+		g_Context->Stats.GlyphsDrawn += static_cast<std::uint32_t>(count);
+		return true;
+	}
+
+	/// Performs a draw call immediately.
+	/// @returns false if the call references an invalid texture.
+	static bool ExecuteDrawCall(const Kyo2D::DrawCall &call)
+	{
+		std::int32_t w = 0, h = 0;
+		switch (call.Type)
+		{
+			case Kyo2D::draw_call::SpriteAt:
+			{
+				if (!BindTextureStage(call.TextureId, w, h))
+					return false;
+				g_Context->SpriteDrawer->DrawSpriteAt(w, h, call.X, call.Y, call.Z, call.Rotation, call.Color, call.Colorkey);
+				break;
+			}
+			case Kyo2D::draw_call::SubspriteAt:
+			{
+				if (!BindTextureStage(call.TextureId, w, h))
+					return false;
+				g_Context->SpriteDrawer->DrawSubspriteAt(w, h, call.X, call.Y, call.Z, call.SrcX, call.SrcY, call.SrcW, call.SrcH, call.Rotation, call.Color, call.Colorkey);
+				break;
+			}
+			case Kyo2D::draw_call::SpriteScaled:
+			{
+				if (!BindTextureStage(call.TextureId, w, h))
+					return false;
+				g_Context->SpriteDrawer->DrawSpriteScaled(w, h, call.X, call.Y, call.Z, call.W, call.H, call.Rotation, call.Color, call.Colorkey);
+				break;
+			}
+			case Kyo2D::draw_call::SubspriteScaled:
+			{
+				if (!BindTextureStage(call.TextureId, w, h))
+					return false;
+				g_Context->SpriteDrawer->DrawSubspriteScaled(w, h, call.X, call.Y, call.Z, call.W, call.H, call.SrcX, call.SrcY, call.SrcW, call.SrcH, call.Rotation, call.Color, call.Colorkey);
+				break;
+			}
+			case Kyo2D::draw_call::SpriteTiled:
+			{
+				if (!BindTextureStage(call.TextureId, w, h))
+					return false;
+				g_Context->SpriteDrawer->DrawSpriteTiled(w, h, call.X, call.Y, call.Z, call.W, call.H, call.SrcX, call.SrcY, call.Rotation, call.Color, call.Colorkey);
+				break;
+			}
+			case Kyo2D::draw_call::Point:
+			{
+				PrepareStage(Kyo2D::render_stage::Drawer2D);
+				g_Context->DrawHelper->DrawPoint(call.X, call.Y, call.Color);
+				break;
+			}
+			case Kyo2D::draw_call::Line:
+			{
+				PrepareStage(Kyo2D::render_stage::Drawer2D);
+				g_Context->DrawHelper->DrawLine(call.X, call.Y, call.W, call.H, call.Color);
+				break;
+			}
+			case Kyo2D::draw_call::Rect:
+			{
+				PrepareStage(Kyo2D::render_stage::Drawer2D);
+				g_Context->DrawHelper->DrawRect(call.X, call.Y, call.W, call.H, call.Color);
+				break;
+			}
+			case Kyo2D::draw_call::FillRect:
+			{
+				PrepareStage(Kyo2D::render_stage::Drawer2D);
+				g_Context->DrawHelper->FillRect(call.X, call.Y, call.W, call.H, call.Color);
+				break;
+			}
+			case Kyo2D::draw_call::Glyphs:
+			{
+				return ExecuteGlyphs(call.TextureId, &g_Context->DeferredGlyphs[call.FirstGlyph], call.GlyphCount, call.Color, call.Colorkey);
+			}
+		}
+
+		return true;
+	}
+
+	/// Computes the screen area a draw call may touch.
+	/// @param texW Width of the texture used by the call.
+	/// @param texH Height of the texture used by the call.
+	static Kyo2D::DamageRect GetDrawCallBounds(const Kyo2D::DrawCall &call, std::int32_t texW, std::int32_t texH)
+	{
+		switch (call.Type)
+		{
+			case Kyo2D::draw_call::SpriteAt:
+				return Kyo2D::DamageTracker::BoundsOf(call.X + texW * 0.5f, call.Y + texH * 0.5f, texW * 0.5f, texH * 0.5f, call.Rotation);
+			case Kyo2D::draw_call::SubspriteAt:
+				return Kyo2D::DamageTracker::BoundsOf(call.X + call.SrcW * 0.5f, call.Y + call.SrcH * 0.5f, call.SrcW * 0.5f, call.SrcH * 0.5f, call.Rotation);
+			case Kyo2D::draw_call::SpriteScaled:
+			case Kyo2D::draw_call::SubspriteScaled:
+				return Kyo2D::DamageTracker::BoundsOf(call.X + std::abs(call.W) * 0.5f, call.Y + std::abs(call.H) * 0.5f, call.W * 0.5f, call.H * 0.5f, call.Rotation);
+			case Kyo2D::draw_call::SpriteTiled:
+				return Kyo2D::DamageTracker::BoundsOf(call.X + call.W * 0.5f, call.Y + call.H * 0.5f, call.W * 0.5f, call.H * 0.5f, call.Rotation);
+			case Kyo2D::draw_call::Point:
+				return Kyo2D::DamageTracker::BoundsOf(call.X, call.Y, 0.0f, 0.0f, 0.0f);
+			case Kyo2D::draw_call::Line:
+				return Kyo2D::DamageTracker::BoundsOf((call.X + call.W) * 0.5f, (call.Y + call.H) * 0.5f, (call.W - call.X) * 0.5f, (call.H - call.Y) * 0.5f, 0.0f);
+			default:
+				return Kyo2D::DamageTracker::BoundsOf(call.X + call.W * 0.5f, call.Y + call.H * 0.5f, call.W * 0.5f, call.H * 0.5f, 0.0f);
+		}
+	}
+
+	/// Draws a draw call right away, or defers it to the present call while damage tracking
+	/// is enabled for the active render target.
+	/// @returns false if the call references an invalid texture.
+	static bool SubmitDrawCall(const Kyo2D::DrawCall &call)
+	{
+		auto rt = g_Context->ActiveRenderTarget.lock();
+		if (!g_Context->DamageTracking || !rt || rt->IsOffscreen())
+			return ExecuteDrawCall(call);
+
+		// Hash everything that affects the output of this call
+		std::uint64_t hash = Kyo2D::Hash(&call.Type, sizeof(call.Type));
+		hash = Kyo2D::Hash(&call.X, sizeof(float) * 10, hash);
+		hash = Kyo2D::Hash(&call.Color, sizeof(call.Color), hash);
+		hash = Kyo2D::Hash(&call.Colorkey, sizeof(call.Colorkey), hash);
+
+		std::int32_t texW = 0, texH = 0;
+		if (call.Type <= Kyo2D::draw_call::SpriteTiled)
+		{
+			auto it = g_Context->Textures.find(call.TextureId);
+			if (!g_Context->SpriteDrawer || it == g_Context->Textures.end())
+				return false;
+
+			// Include the texture contents, not just the id. Ids are never reused while the damage
+			// tracker lives, unlike addresses of destroyed textures
+			const Kyo2D::Texture *texture = it->second.get();
+			std::uint32_t version = texture->GetVersion();
+			hash = Kyo2D::Hash(&call.TextureId, sizeof(call.TextureId), hash);
+			hash = Kyo2D::Hash(&version, sizeof(version), hash);
+			hash = Kyo2D::Hash(&call.Scale2X, sizeof(call.Scale2X), hash);
+			texW = texture->GetWidth();
+			texH = texture->GetHeight();
+		}
+
+		g_Context->Damage.Record(GetDrawCallBounds(call, texW, texH), hash);
+		g_Context->DeferredDraws.push_back(call);
+		return true;
+	}
+
+	/// Replays the deferred draw calls touching the given rectangle (all of them if rect is nullptr).
+	static void ReplayDrawCalls(const Kyo2D::DamageRect *rect)
+	{
+		for (auto &call : g_Context->DeferredDraws)
+		{
+			if (rect)
+			{
+				std::int32_t texW = 0, texH = 0;
+				if (call.Type <= Kyo2D::draw_call::SpriteTiled)
+				{
+					auto it = g_Context->Textures.find(call.TextureId);
+					if (it == g_Context->Textures.end())
+						continue;
+					texW = it->second->GetWidth();
+					texH = it->second->GetHeight();
+				}
+
+				if (!GetDrawCallBounds(call, texW, texH).Intersects(*rect))
+					continue;
+			}
+
+			if (g_Context->SpriteDrawer && call.Type <= Kyo2D::draw_call::SpriteTiled)
+				g_Context->SpriteDrawer->SetScale2XEnabled(call.Scale2X);
+
+			ExecuteDrawCall(call);
+		}
+	}
+
+	/// Presents a window render target in damage tracking mode: Only the dirty rectangles are
+	/// cleared and redrawn with the deferred draw calls, and only these rectangles are presented
+	/// if the backend supports it.
+	static void PresentDamaged(const std::shared_ptr<Kyo2D::RenderTarget> &rt)
+	{
+		// The back buffer of another render target can't be reused
+		if (g_Context->DamageTarget.lock() != rt)
+		{
+			g_Context->DamageTarget = rt;
+			g_Context->Damage.Invalidate();
+		}
+
+		bool scale2X = g_Context->SpriteDrawer && g_Context->SpriteDrawer->IsScale2XEnabled();
+		const auto &rects = g_Context->Damage.EndFrame(rt->GetWidth(), rt->GetHeight());
+
+		bool partial = true;
+		for (auto &rect : rects)
+		{
+			if (!rt->ClearRect(rect, g_Context->DamageClearColor[0], g_Context->DamageClearColor[1], g_Context->DamageClearColor[2]))
+			{
+				partial = false;
+				break;
+			}
+
+			rt->SetScissorRect(&rect);
+			ReplayDrawCalls(&rect);
+		}
+		rt->SetScissorRect(nullptr);
+
+		// The backend couldn't update single rectangles: Redraw everything
+		if (!partial)
+		{
+			rt->Clear(g_Context->DamageClearColor[0], g_Context->DamageClearColor[1], g_Context->DamageClearColor[2]);
+			ReplayDrawCalls(nullptr);
+		}
+
+		if (g_Context->SpriteDrawer)
+			g_Context->SpriteDrawer->SetScale2XEnabled(scale2X);
+
+		g_Context->DeferredDraws.clear();
+		g_Context->DeferredGlyphs.clear();
+		g_Context->Damage.BeginFrame();
+
+		if (partial)
+			rt->PresentRects(rects.data(), rects.size());
+		else
+			rt->Present();
+	}
+
+	/// Draws a text from its cached layout.
+	static bool DrawCachedText(std::uint32_t fontId, const Kyo2D::TextView &text, float x, float y, std::uint32_t color)
+	{
+		auto it = g_Context->Fonts.find(fontId);
+		if (it == g_Context->Fonts.end())
+		{
+			return false;
+		}
+
+		g_Context->LayoutCache.Get(fontId, it->second, text).Draw(x, y, color);
+		return true;
+	}
+
+	/// Records a glyph run for the present call of a damage tracked render target.
+	static void DeferGlyphs(std::uint32_t page, const Kyo2D::GlyphQuad *quads, size_t count, std::uint32_t color, std::uint32_t colorkey)
+	{
+		auto it = g_Context->Textures.find(page);
+		if (it == g_Context->Textures.end())
+			return;
+
+		// Hash everything that affects the output of the run
+		std::uint32_t version = it->second->GetVersion();
+		std::uint64_t hash = Kyo2D::Hash(quads, sizeof(Kyo2D::GlyphQuad) * count);
+		hash = Kyo2D::Hash(&color, sizeof(color), hash);
+		hash = Kyo2D::Hash(&colorkey, sizeof(colorkey), hash);
+		hash = Kyo2D::Hash(&page, sizeof(page), hash);
+		hash = Kyo2D::Hash(&version, sizeof(version), hash);
+
+		float left = quads[0].X, top = quads[0].Y, right = left, bottom = top;
+		for (size_t i = 0; i < count; ++i)
+		{
+			left = std::min<float>(left, quads[i].X);
+			top = std::min<float>(top, quads[i].Y);
+			right = std::max<float>(right, quads[i].X + quads[i].W);
+			bottom = std::max<float>(bottom, quads[i].Y + quads[i].H);
+		}
+
+		Kyo2D::DrawCall call = { Kyo2D::draw_call::Glyphs, page, left, top, right - left, bottom - top, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, color, colorkey, false,
+			static_cast<std::uint32_t>(g_Context->DeferredGlyphs.size()), static_cast<std::uint32_t>(count) };
+		g_Context->DeferredGlyphs.insert(g_Context->DeferredGlyphs.end(), quads, quads + count);
+
+		g_Context->Damage.Record(GetDrawCallBounds(call, 0, 0), hash);
+		g_Context->DeferredDraws.push_back(call);
+	}
+
+#ifdef _WIN32
 	/// 
 	static bool CreateD3D11Device()
 	{
 		// Already initialized?
-		if (g_D3DDevice11.Get() || g_D3DDeviceContext11.Get())
+		if (g_Context->D3DDevice11.Get() || g_Context->D3DDeviceContext11.Get())
 		{
 			return true;
 		}
@@ -196,9 +557,9 @@ namespace
 			nullptr,
 			0,
 			D3D11_SDK_VERSION,
-			g_D3DDevice11.GetAddressOf(),
+			g_Context->D3DDevice11.GetAddressOf(),
 			nullptr,
-			g_D3DDeviceContext11.GetAddressOf()
+			g_Context->D3DDeviceContext11.GetAddressOf()
 		);
 		if (FAILED(hr))
 		{
@@ -212,12 +573,12 @@ namespace
 	/// 
 	static bool CreateD3D9Device()
 	{
-		if (g_D3D9)
+		if (g_Context->D3D9)
 			return true;
 
 		// Setup D3D9
-		g_D3D9 = Direct3DCreate9(D3D_SDK_VERSION);
-		if (!g_D3D9)
+		g_Context->D3D9 = Direct3DCreate9(D3D_SDK_VERSION);
+		if (!g_Context->D3D9)
 		{
 			return false;
 		}
@@ -226,12 +587,12 @@ namespace
 		WNDCLASS wc = { 0 };
 		wc.lpfnWndProc = &DefWindowProc;
 		wc.lpszClassName = L"d3d9_test_wc";
-		if (!RegisterClass(&wc))
+		if (!RegisterClass(&wc) && GetLastError() != ERROR_CLASS_ALREADY_EXISTS)
 			return false;
 
 		// Create an empty test window
-		g_D3D9Wnd = CreateWindow(L"d3d9_test_wc", L"", 0, 0, 0, 0, 0, 0, 0, 0, 0);
-		if (!g_D3D9Wnd)
+		g_Context->D3D9Wnd = CreateWindow(L"d3d9_test_wc", L"", 0, 0, 0, 0, 0, 0, 0, 0, 0);
+		if (!g_Context->D3D9Wnd)
 			return false;
 
 		// Create device
@@ -239,36 +600,126 @@ namespace
 		ZeroMemory(&d3dpp, sizeof(d3dpp));
 		d3dpp.Windowed = TRUE;
 		d3dpp.SwapEffect = D3DSWAPEFFECT_COPY;
-		d3dpp.hDeviceWindow = g_D3D9Wnd;
+		d3dpp.hDeviceWindow = g_Context->D3D9Wnd;
 		d3dpp.Flags = 0;
-		HRESULT hr = g_D3D9->CreateDevice(D3DADAPTER_DEFAULT, D3DDEVTYPE_HAL, g_D3D9Wnd, D3DCREATE_HARDWARE_VERTEXPROCESSING, &d3dpp, g_D3DDevice9.GetAddressOf());
+		HRESULT hr = g_Context->D3D9->CreateDevice(D3DADAPTER_DEFAULT, D3DDEVTYPE_HAL, g_Context->D3D9Wnd, D3DCREATE_HARDWARE_VERTEXPROCESSING, &d3dpp, g_Context->D3DDevice9.GetAddressOf());
 		if (FAILED(hr))
 		{
-			MessageBox(g_D3D9Wnd, L"Could not create Direct3D9 device!", L"Error", MB_ICONERROR | MB_OK);
+			MessageBox(g_Context->D3D9Wnd, L"Could not create Direct3D9 device!", L"Error", MB_ICONERROR | MB_OK);
 			return false;
 		}
 
 		// Turn off culling, lighting and zbuffer
-		g_D3DDevice9->SetRenderState(D3DRS_LIGHTING, 0);
-		g_D3DDevice9->SetRenderState(D3DRS_ZENABLE, 0);
-		g_D3DDevice9->SetRenderState(D3DRS_ZWRITEENABLE, 0);
-		g_D3DDevice9->SetRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
+		g_Context->D3DDevice9->SetRenderState(D3DRS_LIGHTING, 0);
+		g_Context->D3DDevice9->SetRenderState(D3DRS_ZENABLE, 0);
+		g_Context->D3DDevice9->SetRenderState(D3DRS_ZWRITEENABLE, 0);
+		g_Context->D3DDevice9->SetRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
 
 		// Enable alpha blending
-		g_D3DDevice9->SetRenderState(D3DRS_ALPHABLENDENABLE, 1);
-		g_D3DDevice9->SetRenderState(D3DRS_BLENDOP, D3DBLENDOP_ADD);
-		g_D3DDevice9->SetRenderState(D3DRS_SRCBLEND, D3DBLEND_SRCALPHA);
-		g_D3DDevice9->SetRenderState(D3DRS_DESTBLEND, D3DBLEND_INVSRCALPHA);
-		g_D3DDevice9->SetRenderState(D3DRS_BLENDOPALPHA, D3DBLENDOP_ADD);
-		g_D3DDevice9->SetRenderState(D3DRS_SRCBLENDALPHA, D3DBLEND_ONE);
-		g_D3DDevice9->SetRenderState(D3DRS_DESTBLENDALPHA, D3DBLEND_ZERO);
-
-		g_D3DDevice9->SetSamplerState(0, D3DSAMP_MINFILTER, D3DTEXF_POINT);
-		g_D3DDevice9->SetSamplerState(0, D3DSAMP_MAGFILTER, D3DTEXF_POINT);
-		g_D3DDevice9->SetSamplerState(0, D3DSAMP_MIPFILTER, D3DTEXF_POINT);
+		g_Context->D3DDevice9->SetRenderState(D3DRS_ALPHABLENDENABLE, 1);
+		g_Context->D3DDevice9->SetRenderState(D3DRS_BLENDOP, D3DBLENDOP_ADD);
+		g_Context->D3DDevice9->SetRenderState(D3DRS_SRCBLEND, D3DBLEND_SRCALPHA);
+		g_Context->D3DDevice9->SetRenderState(D3DRS_DESTBLEND, D3DBLEND_INVSRCALPHA);
+		g_Context->D3DDevice9->SetRenderState(D3DRS_BLENDOPALPHA, D3DBLENDOP_ADD);
+		g_Context->D3DDevice9->SetRenderState(D3DRS_SRCBLENDALPHA, D3DBLEND_ONE);
+		g_Context->D3DDevice9->SetRenderState(D3DRS_DESTBLENDALPHA, D3DBLEND_ZERO);
+
+		g_Context->D3DDevice9->SetSamplerState(0, D3DSAMP_MINFILTER, D3DTEXF_POINT);
+		g_Context->D3DDevice9->SetSamplerState(0, D3DSAMP_MAGFILTER, D3DTEXF_POINT);
+		g_Context->D3DDevice9->SetSamplerState(0, D3DSAMP_MIPFILTER, D3DTEXF_POINT);
 
 		return true;
 	}
+#endif
+
+	/// Initializes the image loader library for the current context. DevIL is shared by all
+	/// contexts, so it is only initialized by the first one.
+	static void AcquireImageLoader()
+	{
+		if (g_Context->ImageLoader)
+			return;
+
+		std::lock_guard<std::mutex> lock(Kyo2D::Texture::GetLoaderMutex());
+#ifndef K2D_NO_IMAGE_LOADER
+		if (!g_ImageLoaderUsers++)
+			ilInit();
+#else
+		++g_ImageLoaderUsers;
+#endif
+
+		g_Context->ImageLoader = true;
+	}
+
+	/// Releases the image loader library reference of the current context.
+	static void ReleaseImageLoader()
+	{
+		if (!g_Context->ImageLoader)
+			return;
+
+		std::lock_guard<std::mutex> lock(Kyo2D::Texture::GetLoaderMutex());
+#ifndef K2D_NO_IMAGE_LOADER
+		if (!--g_ImageLoaderUsers)
+			ilShutDown();
+#else
+		--g_ImageLoaderUsers;
+#endif
+
+		g_Context->ImageLoader = false;
+	}
+}
+
+
+
+namespace Kyo2D
+{
+	void SubmitGlyphs(const GlyphQuad *quads, size_t count, float x, float y, std::uint32_t color, std::uint32_t colorkey)
+	{
+		auto rt = g_Context->ActiveRenderTarget.lock();
+		const bool deferred = g_Context->DamageTracking && rt && !rt->IsOffscreen();
+
+		// One run per atlas page. Texts rarely use more than a few pages, each pass picks the
+		// glyphs of the page of the first glyph left.
+		std::vector<GlyphQuad> &run = g_Context->GlyphRun;
+		std::vector<bool> &done = g_Context->GlyphRunDone;
+		done.assign(count, false);
+
+		for (size_t first = 0; first < count; ++first)
+		{
+			if (done[first])
+				continue;
+
+			const std::uint32_t page = quads[first].TextureId;
+			auto it = g_Context->Textures.find(page);
+			const bool snap = it == g_Context->Textures.end() || !it->second->IsDistanceField();
+
+			// Move the quads to the screen, bitmap glyphs are snapped to whole pixels so they stay sharp
+			run.clear();
+			for (size_t i = first; i < count; ++i)
+			{
+				if (done[i] || quads[i].TextureId != page)
+					continue;
+
+				// Glyphs drawn in this frame stay in the atlas
+				g_Context->Glyphs.Touch(quads[i].AtlasEntry);
+
+				GlyphQuad quad = quads[i];
+				quad.X += x;
+				quad.Y += y;
+				if (snap)
+				{
+					quad.X = std::floor(quad.X + 0.5f);
+					quad.Y = std::floor(quad.Y + 0.5f);
+				}
+				run.push_back(quad);
+				done[i] = true;
+			}
+
+			if (deferred)
+				DeferGlyphs(page, run.data(), run.size(), color, colorkey);
+			else
+				ExecuteGlyphs(page, run.data(), run.size(), color, colorkey);
+		}
+	}
 }
 
 
@@ -279,25 +730,33 @@ namespace
 
 K2D_API void K2D_Init(bool useD3D11)
 {
-	g_UseD3D11 = (useD3D11 && g_HasD3D11);
+	g_Context->UseD3D11 = (useD3D11 && g_HasD3D11);
+	g_Context->UseSoftware = false;
+	g_Context->UseNull = false;
 
 	// Initialize DevIL
-	ilInit();
+	AcquireImageLoader();
 
+#ifdef _WIN32
 	// Create D3D11 pipeline
-	if (g_UseD3D11)
+	if (g_Context->UseD3D11)
 	{
 		if (!CreateD3D11Device())
 			return;
 		
 		// Setup the draw helper
-		g_DrawHelper = std::make_shared<Kyo2D::DrawHelperD3D11>();
-		if (!g_DrawHelper || !g_DrawHelper->Initialize())
+		g_Context->DrawHelper = std::make_shared<Kyo2D::DrawHelperD3D11>();
+		if (!g_Context->DrawHelper || !g_Context->DrawHelper->Initialize())
 			return;
 
 		// Setup the sprite drawer
-		g_SpriteDrawer = std::make_shared<Kyo2D::SpriteDrawerD3D11>();
-		if (!g_SpriteDrawer || !g_SpriteDrawer->Initialize())
+		g_Context->SpriteDrawer = std::make_shared<Kyo2D::SpriteDrawerD3D11>();
+		if (!g_Context->SpriteDrawer || !g_Context->SpriteDrawer->Initialize())
+			return;
+
+		// Setup the text drawer
+		g_Context->TextDrawer = std::make_shared<Kyo2D::TextDrawerD3D11>();
+		if (!g_Context->TextDrawer || !g_Context->TextDrawer->Initialize())
 			return;
 	}
 	else
@@ -307,58 +766,153 @@ K2D_API void K2D_Init(bool useD3D11)
 			return;
 
 		// Setup the draw helper
-		g_DrawHelper = std::make_shared<Kyo2D::DrawHelperD3D9>();
-		if (!g_DrawHelper || !g_DrawHelper->Initialize())
+		g_Context->DrawHelper = std::make_shared<Kyo2D::DrawHelperD3D9>();
+		if (!g_Context->DrawHelper || !g_Context->DrawHelper->Initialize())
 			return;
 
 		// Setup the sprite drawer
-		g_SpriteDrawer = std::make_shared<Kyo2D::SpriteDrawerD3D9>();
-		if (!g_SpriteDrawer || !g_SpriteDrawer->Initialize())
+		g_Context->SpriteDrawer = std::make_shared<Kyo2D::SpriteDrawerD3D9>();
+		if (!g_Context->SpriteDrawer || !g_Context->SpriteDrawer->Initialize())
+			return;
+
+		// Setup the text drawer
+		g_Context->TextDrawer = std::make_shared<Kyo2D::TextDrawerD3D9>();
+		if (!g_Context->TextDrawer || !g_Context->TextDrawer->Initialize())
 			return;
 	}
+#endif
+}
+
+K2D_API void K2D_InitSoftware(std::uint32_t WorkerThreads)
+{
+	g_Context->UseD3D11 = false;
+	g_Context->UseSoftware = true;
+	g_Context->UseNull = false;
+
+	// Initialize DevIL
+	AcquireImageLoader();
+
+	// Start the rasterizer threads
+	g_Context->Software.Workers.Initialize(WorkerThreads);
+
+	// Setup the draw helper
+	g_Context->DrawHelper = std::make_shared<Kyo2D::DrawHelperSoftware>();
+	if (!g_Context->DrawHelper || !g_Context->DrawHelper->Initialize())
+		return;
+
+	// Setup the sprite drawer
+	g_Context->SpriteDrawer = std::make_shared<Kyo2D::SpriteDrawerSoftware>();
+	if (!g_Context->SpriteDrawer || !g_Context->SpriteDrawer->Initialize())
+		return;
+
+	// Setup the text drawer
+	g_Context->TextDrawer = std::make_shared<Kyo2D::TextDrawerSoftware>();
+	if (!g_Context->TextDrawer || !g_Context->TextDrawer->Initialize())
+		return;
+}
+
+K2D_API void K2D_InitNull()
+{
+	g_Context->UseD3D11 = false;
+	g_Context->UseSoftware = false;
+	g_Context->UseNull = true;
+
+	// Initialize DevIL, textures are still decoded to know their size
+	AcquireImageLoader();
+
+	// Setup the draw helper
+	g_Context->DrawHelper = std::make_shared<Kyo2D::DrawHelperNull>();
+	if (!g_Context->DrawHelper || !g_Context->DrawHelper->Initialize())
+		return;
+
+	// Setup the sprite drawer
+	g_Context->SpriteDrawer = std::make_shared<Kyo2D::SpriteDrawerNull>();
+	if (!g_Context->SpriteDrawer || !g_Context->SpriteDrawer->Initialize())
+		return;
+
+	// Setup the text drawer
+	g_Context->TextDrawer = std::make_shared<Kyo2D::TextDrawerNull>();
+	if (!g_Context->TextDrawer || !g_Context->TextDrawer->Initialize())
+		return;
 }
 
 K2D_API void K2D_Terminate()
 {
+	// Finish a running capture
+	g_Context->Capture.reset();
+
+	// Drop deferred draw calls
+	g_Context->DeferredDraws.clear();
+	g_Context->DeferredGlyphs.clear();
+	g_Context->Damage.Reset();
+	g_Context->DamageTarget.reset();
+
+	// Kill glyph atlas, fonts rasterize their glyphs again when used
+	g_Context->LayoutCache.Clear();
+	g_Context->Glyphs.Clear();
+	g_Context->GlyphWorkers.Shutdown();
+	g_Context->GlyphWorkersStarted = false;
+
 	// Kill sprites
-	g_Textures.clear();
-	g_NextTexture = 1;
+	g_Context->Residency.Clear();
+	g_Context->Textures.clear();
+	g_Context->NextTexture = 1;
 
 	// Kill render targets
-	g_RenderTargets.clear();
-	g_NextRenderTarget = 1;
+	g_Context->OffscreenTextures.clear();
+	g_Context->RenderTargets.clear();
+	g_Context->NextRenderTarget = 1;
 
-	// Kill sprite drawer
-	g_SpriteDrawer.reset();
+	// Kill sprite and text drawer
+	g_Context->SpriteDrawer.reset();
+	g_Context->TextDrawer.reset();
 
 	// Kill draw helper
-	g_DrawHelper.reset();
+	g_Context->DrawHelper.reset();
 
+	// The null backend has no device
+	if (g_Context->UseNull)
+	{
+		g_Context->UseNull = false;
+	}
+	// Kill software rasterizer
+	else if (g_Context->UseSoftware)
+	{
+		g_Context->Software.Texture.reset();
+		g_Context->Software.Workers.Shutdown();
+	}
+#ifdef _WIN32
 	// Kill D3D11 API
-	if (g_UseD3D11)
+	else if (g_Context->UseD3D11)
 	{
-		g_D3DDeviceContext11.Reset();
-		g_D3DDevice11.Reset();
+		g_Context->D3DDeviceContext11.Reset();
+		g_Context->D3DDevice11.Reset();
 	}
 	else
 	{
 		// TODO: Kill D3D9 API
-		g_D3DDevice9.Reset();
-		g_D3D9.Reset();
+		g_Context->D3DDevice9.Reset();
+		g_Context->D3D9.Reset();
+		g_Context->D3D9SceneActive = false;
 
-		if (g_D3D9Wnd)
+		if (g_Context->D3D9Wnd)
 		{
-			DestroyWindow(g_D3D9Wnd);
-			g_D3D9Wnd = nullptr;
+			DestroyWindow(g_Context->D3D9Wnd);
+			g_Context->D3D9Wnd = nullptr;
 		}
 	}
+#endif
+
+	// Forget the cached render state
+	g_Context->Stage = Kyo2D::render_stage::None;
 
 	// Shutdown image loader library
-	ilShutDown();
+	ReleaseImageLoader();
 }
 
 K2D_API bool K2D_Direct3D11Supported()
 {
+#ifdef _WIN32
 	OSVERSIONINFO version;
 	ZeroMemory(&version, sizeof(OSVERSIONINFO));
 	version.dwOSVersionInfoSize = sizeof(OSVERSIONINFO);
@@ -368,407 +922,1421 @@ K2D_API bool K2D_Direct3D11Supported()
 	bool isWinXPOrEarlier = (version.dwMajorVersion < 6);
 	if (isWinXPOrEarlier)
 		return false;
+#endif
 
 	return g_HasD3D11;
 }
 
-
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-// RENDER TARGET MANAGEMENT
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-K2D_API std::uint32_t K2D_CreateRenderTarget(HWND Handle, std::uint16_t Width, std::uint16_t Height, bool Fullscreen)
+K2D_API std::uint32_t K2D_CreateContext()
 {
-	// Create render target instance and try to initialize it
-	std::shared_ptr<Kyo2D::RenderTarget> renderTarget;
-	if (g_UseD3D11)
-		renderTarget = std::make_shared<Kyo2D::RenderTargetD3D11>();
-	else
-		renderTarget = std::make_shared<Kyo2D::RenderTargetD3D9>();
-
-	// Check if render target was created
-	if (!renderTarget.get())
-		return 0;
+	auto context = std::make_unique<Kyo2D::EngineContext>();
 
-	// Initialize the render target
-	if (!renderTarget->Initialize(Handle, Width, Height, Fullscreen))
-		return 0;
-
-	// Store render target for later use
-	std::uint32_t renderTargetIndex = g_NextRenderTarget++;
-	g_RenderTargets[renderTargetIndex] = std::move(renderTarget);
+	std::lock_guard<std::mutex> lock(g_ContextMutex);
+	context->Id = g_NextContext++;
+	std::uint32_t contextId = context->Id;
+	g_Contexts[contextId] = std::move(context);
 
-	return renderTargetIndex;
+	return contextId;
 }
 
-K2D_API bool K2D_DestroyRenderTarget(std::uint32_t RenderTarget)
+K2D_API bool K2D_DestroyContext(std::uint32_t Context)
 {
-	auto it = g_RenderTargets.find(RenderTarget);
-	if (it != g_RenderTargets.end())
+	std::unique_ptr<Kyo2D::EngineContext> context;
 	{
-		// This will destroy the render target
-		it = g_RenderTargets.erase(it);
-		return true;
+		std::lock_guard<std::mutex> lock(g_ContextMutex);
+		auto it = g_Contexts.find(Context);
+		if (it == g_Contexts.end())
+		{
+			return false;
+		}
+
+		context = std::move(it->second);
+		g_Contexts.erase(it);
+	}
+
+	// Objects of the context have to be released while it is current
+	Kyo2D::EngineContext *previous = (g_Context == context.get()) ? &g_DefaultContext : g_Context;
+	g_Context = context.get();
+	K2D_Terminate();
+	g_Context->TextLayouts.clear();
+	g_Context->TextDocuments.clear();
+	g_Context->Fonts.clear();
+	g_Context->FontFamilies.clear();
+	context.reset();
+
+	g_Context = previous;
+	return true;
+}
+
+K2D_API bool K2D_MakeContextCurrent(std::uint32_t Context)
+{
+	if (Context == 0)
+	{
+		g_Context = &g_DefaultContext;
+		return true;
+	}
+
+	std::lock_guard<std::mutex> lock(g_ContextMutex);
+	auto it = g_Contexts.find(Context);
+	if (it == g_Contexts.end())
+	{
+		return false;
+	}
+
+	g_Context = it->second.get();
+	return true;
+}
+
+K2D_API std::uint32_t K2D_GetCurrentContext()
+{
+	return g_Context->Id;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// RENDER TARGET MANAGEMENT
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+K2D_API std::uint32_t K2D_CreateRenderTarget(HWND Handle, std::uint16_t Width, std::uint16_t Height, bool Fullscreen)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::CreateRenderTarget);
+	capture << Width << Height << Fullscreen;
+
+	// Create render target instance and try to initialize it
+	std::shared_ptr<Kyo2D::RenderTarget> renderTarget;
+	if (g_Context->UseNull)
+		renderTarget = std::make_shared<Kyo2D::RenderTargetNull>();
+	else if (g_Context->UseSoftware)
+		renderTarget = std::make_shared<Kyo2D::RenderTargetSoftware>();
+#ifdef _WIN32
+	else if (g_Context->UseD3D11)
+		renderTarget = std::make_shared<Kyo2D::RenderTargetD3D11>();
+	else
+		renderTarget = std::make_shared<Kyo2D::RenderTargetD3D9>();
+#endif
+
+	// Check if render target was created
+	if (!renderTarget.get())
+		return 0;
+
+	// Initialize the render target
+	if (!renderTarget->Initialize(Handle, Width, Height, Fullscreen))
+		return 0;
+
+	// Store render target for later use
+	std::uint32_t renderTargetIndex = g_Context->NextRenderTarget++;
+	g_Context->RenderTargets[renderTargetIndex] = std::move(renderTarget);
+
+	return capture.Result(renderTargetIndex);
+}
+
+K2D_API std::uint32_t K2D_CreateOffscreenTarget(std::uint16_t Width, std::uint16_t Height)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::CreateOffscreenTarget);
+	capture << Width << Height;
+
+	// Create render target instance and try to initialize it
+	std::shared_ptr<Kyo2D::RenderTarget> renderTarget;
+	if (g_Context->UseNull)
+		renderTarget = std::make_shared<Kyo2D::RenderTargetNull>();
+	else if (g_Context->UseSoftware)
+		renderTarget = std::make_shared<Kyo2D::RenderTargetSoftware>();
+#ifdef _WIN32
+	else if (g_Context->UseD3D11)
+		renderTarget = std::make_shared<Kyo2D::RenderTargetD3D11>();
+	else
+		renderTarget = std::make_shared<Kyo2D::RenderTargetD3D9>();
+#endif
+
+	// Check if render target was created
+	if (!renderTarget.get())
+		return 0;
+
+	// Initialize the render target
+	if (!renderTarget->InitializeOffscreen(Width, Height))
+		return 0;
+
+	g_Context->Stats.TexturesCreated++;
+
+	// Register the texture so it can be used by the sprite methods
+	std::uint32_t textureId = g_Context->NextTexture++;
+	g_Context->Residency.Add(textureId, renderTarget->GetTexture());
+	g_Context->Textures[textureId] = renderTarget->GetTexture();
+
+	// Store render target for later use
+	std::uint32_t renderTargetIndex = g_Context->NextRenderTarget++;
+	g_Context->RenderTargets[renderTargetIndex] = std::move(renderTarget);
+	g_Context->OffscreenTextures[renderTargetIndex] = textureId;
+
+	return capture.Result(renderTargetIndex);
+}
+
+K2D_API std::uint32_t K2D_GetRenderTargetTexture(std::uint32_t RenderTarget)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::GetRenderTargetTexture);
+	capture << RenderTarget;
+
+	auto it = g_Context->OffscreenTextures.find(RenderTarget);
+	if (it == g_Context->OffscreenTextures.end())
+	{
+		return 0;
+	}
+
+	return capture.Result(it->second);
+}
+
+K2D_API bool K2D_InvalidateRenderTarget(std::uint32_t RenderTarget)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::InvalidateRenderTarget);
+	capture << RenderTarget;
+
+	auto it = g_Context->RenderTargets.find(RenderTarget);
+	if (it == g_Context->RenderTargets.end())
+	{
+		return false;
+	}
+
+	it->second->SetDirty(true);
+	return true;
+}
+
+K2D_API bool K2D_IsRenderTargetDirty(std::uint32_t RenderTarget)
+{
+	auto it = g_Context->RenderTargets.find(RenderTarget);
+	if (it == g_Context->RenderTargets.end())
+	{
+		return false;
+	}
+
+	return it->second->IsDirty();
+}
+
+K2D_API bool K2D_ReadRenderTargetPixels(std::uint32_t RenderTarget, std::uint32_t *Buffer, std::uint32_t BufferSize)
+{
+	auto it = g_Context->RenderTargets.find(RenderTarget);
+	if (it == g_Context->RenderTargets.end())
+	{
+		return false;
+	}
+
+	return it->second->ReadPixels(Buffer, BufferSize);
+}
+
+K2D_API bool K2D_DestroyRenderTarget(std::uint32_t RenderTarget)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DestroyRenderTarget);
+	capture << RenderTarget;
+
+	auto it = g_Context->RenderTargets.find(RenderTarget);
+	if (it != g_Context->RenderTargets.end())
+	{
+		// Offscreen targets own their texture
+		auto texIt = g_Context->OffscreenTextures.find(RenderTarget);
+		if (texIt != g_Context->OffscreenTextures.end())
+		{
+			g_Context->Residency.Remove(texIt->second);
+			g_Context->Textures.erase(texIt->second);
+			g_Context->OffscreenTextures.erase(texIt);
+		}
+
+		// This will destroy the render target
+		it = g_Context->RenderTargets.erase(it);
+		return true;
+	}
+	
+	return false;
+}
+
+K2D_API bool K2D_SetRenderTarget(std::uint32_t RenderTarget)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::SetRenderTarget);
+	capture << RenderTarget;
+
+	auto it = g_Context->RenderTargets.find(RenderTarget);
+	if (it == g_Context->RenderTargets.end())
+	{
+		return false;
+	}
+
+	g_Context->ActiveRenderTarget = it->second;
+	it->second->Set();
+
+	// Update view matrix for draw helper
+	if (g_Context->DrawHelper)
+		g_Context->DrawHelper->UpdateViewMatrix(it->second->GetViewMatrix());
+
+	// Same for sprite drawer
+	if (g_Context->SpriteDrawer)
+		g_Context->SpriteDrawer->SetViewMatrix(it->second->GetViewMatrix());
+
+	// And the text drawer
+	if (g_Context->TextDrawer)
+		g_Context->TextDrawer->SetViewMatrix(it->second->GetViewMatrix());
+
+	return true;
+}
+
+K2D_API bool K2D_ClearRenderTarget(float r, float g, float b)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::ClearRenderTarget);
+	capture << r << g << b;
+
+	auto rt = g_Context->ActiveRenderTarget.lock();
+	if (!rt)
+	{
+		return false;
+	}
+
+	// In damage tracking mode, only the dirty rectangles are cleared when presenting
+	if (g_Context->DamageTracking && !rt->IsOffscreen())
+	{
+		if (g_Context->DamageClearColor[0] != r || g_Context->DamageClearColor[1] != g || g_Context->DamageClearColor[2] != b)
+			g_Context->Damage.Invalidate();
+
+		g_Context->DamageClearColor[0] = r;
+		g_Context->DamageClearColor[1] = g;
+		g_Context->DamageClearColor[2] = b;
+		return true;
+	}
+
+	rt->Clear(r, g, b);
+	return true;
+}
+
+K2D_API bool K2D_SetVSyncEnabled(bool Enable)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::SetVSyncEnabled);
+	capture << Enable;
+
+	auto rt = g_Context->ActiveRenderTarget.lock();
+	if (!rt)
+	{
+		return false;
+	}
+
+	rt->SetVSyncEnabled(Enable);
+	return true;
+}
+
+K2D_API bool K2D_PresentRenderTarget()
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::PresentRenderTarget);
+
+	auto rt = g_Context->ActiveRenderTarget.lock();
+	if (!rt)
+	{
+		return false;
+	}
+
+	{
+		K2D_PROFILE_SCOPE(g_Context->Profiler, "Present");
+		if (g_Context->DamageTracking && !rt->IsOffscreen())
+			PresentDamaged(rt);
+		else
+			rt->Present();
+	}
+
+	// Offscreen targets are up to date now, window targets finish a frame
+	if (rt->IsOffscreen())
+	{
+		rt->SetDirty(false);
+		rt->GetTexture()->IncrementVersion();
+	}
+	else
+	{
+		g_Context->Residency.NextFrame();
+		g_Context->LayoutCache.EndFrame();
+		g_Context->Glyphs.EndFrame();
+
+		g_Context->LastFrameStats = g_Context->Stats;
+		g_Context->Stats = Kyo2D::FrameStats();
+		g_Context->LastFrameTime = g_Context->Profiler.EndFrame();
+	}
+
+	return true;
+}
+
+K2D_API bool K2D_ResizeRenderTarget(std::uint16_t Width, std::uint16_t Height)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::ResizeRenderTarget);
+	capture << Width << Height;
+
+	auto rt = g_Context->ActiveRenderTarget.lock();
+	if (!rt)
+	{
+		return false;
+	}
+
+	if (!rt->Resize(Width, Height))
+	{
+		return false;
+	}
+
+	rt->Set();
+
+	// Update view matrix for draw helper
+	if (g_Context->DrawHelper)
+		g_Context->DrawHelper->UpdateViewMatrix(rt->GetViewMatrix());
+
+	// Same for sprite drawer
+	if (g_Context->SpriteDrawer)
+		g_Context->SpriteDrawer->SetViewMatrix(rt->GetViewMatrix());
+
+	// And the text drawer
+	if (g_Context->TextDrawer)
+		g_Context->TextDrawer->SetViewMatrix(rt->GetViewMatrix());
+	
+	return true;
+}
+
+
+
+K2D_API void K2D_SetDamageTrackingEnabled(bool Enable)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::SetDamageTracking);
+	capture << Enable;
+
+	if (g_Context->DamageTracking == Enable)
+		return;
+
+	// Draw calls deferred so far can't be presented anymore
+	g_Context->DamageTracking = Enable;
+	g_Context->DeferredDraws.clear();
+	g_Context->DeferredGlyphs.clear();
+	g_Context->Damage.Reset();
+	g_Context->DamageTarget.reset();
+}
+
+K2D_API void K2D_InvalidateDamage()
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::InvalidateDamage);
+	g_Context->Damage.Invalidate();
+}
+
+K2D_API K2D_DamageStats K2D_GetDamageStats()
+{
+	const Kyo2D::DamageTracker::Stats &stats = g_Context->Damage.GetStats();
+
+	K2D_DamageStats result;
+	result.DirtyRects = stats.DirtyRects;
+	result.PixelsRedrawn = stats.PixelsRedrawn;
+	result.PixelsFullFrame = stats.PixelsFullFrame;
+	result.TotalPixelsRedrawn = stats.TotalPixelsRedrawn;
+	result.TotalPixelsFullFrame = stats.TotalPixelsFullFrame;
+	return result;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// PROFILING
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+K2D_API K2D_FrameStats K2D_GetFrameStats()
+{
+	const Kyo2D::FrameStats &stats = g_Context->LastFrameStats;
+
+	K2D_FrameStats result;
+	result.DrawCalls = stats.DrawCalls;
+	result.Vertices = stats.Vertices;
+	result.BufferMaps = stats.BufferMaps;
+	result.TextureBinds = stats.TextureBinds;
+	result.StageChanges = stats.StageChanges;
+	result.GlyphsRasterized = stats.GlyphsRasterized;
+	result.GlyphsDrawn = stats.GlyphsDrawn;
+	result.TexturesCreated = stats.TexturesCreated;
+	result.BytesUploaded = stats.BytesUploaded;
+	result.FrameTime = g_Context->LastFrameTime;
+	result.SlowFrame = g_Context->Profiler.WasLastFrameSlow();
+	return result;
+}
+
+K2D_API void K2D_SetProfilerHistory(std::uint32_t Frames)
+{
+	g_Context->Profiler.SetHistory(Frames);
+}
+
+K2D_API void K2D_SetSlowFrameThreshold(float Milliseconds)
+{
+	g_Context->Profiler.SetSlowFrameThreshold(Milliseconds);
+}
+
+K2D_API bool K2D_WriteProfilerTrace(const wchar_t *Filename)
+{
+	if (!Filename)
+	{
+		return false;
+	}
+
+#ifdef _WIN32
+	std::ofstream stream(Filename, std::ios::out | std::ios::binary | std::ios::trunc);
+#else
+	std::ofstream stream(narrowFilename(Filename).c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+#endif
+	if (!stream.is_open())
+	{
+		return false;
+	}
+
+	std::string trace = g_Context->Profiler.GetTrace(g_Context->Id);
+	stream.write(trace.data(), static_cast<std::streamsize>(trace.size()));
+	return stream.good();
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// CAPTURE
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+K2D_API bool K2D_BeginCapture(const wchar_t *Filename)
+{
+	g_Context->Capture.reset();
+
+	if (!Filename)
+		return false;
+
+	auto capture = std::make_unique<Kyo2D::CaptureWriter>();
+	if (!capture->Open(Filename))
+		return false;
+
+	g_Context->Capture = std::move(capture);
+	return true;
+}
+
+K2D_API void K2D_EndCapture()
+{
+	g_Context->Capture.reset();
+}
+
+K2D_API std::uint32_t K2D_ReplayCapture(const wchar_t *Filename, HWND Window, K2D_ReplayFrameCallback Callback, void *User)
+{
+	if (!Filename)
+		return 0;
+
+	return Kyo2D::ReplayCapture(Filename, Window, Callback, User);
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// TEXTURE MANAGEMENT
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+K2D_API std::uint32_t K2D_CreateTexture(const wchar_t *Filename)
+{
+	return K2D_CreateTextureEx(Filename, 0, 0);
+}
+
+K2D_API std::uint32_t K2D_CreateTextureFromMemory(const char *data, std::uint32_t size)
+{
+	return K2D_CreateTextureFromMemoryEx(data, size, 0, 0);
+}
+
+K2D_API std::uint32_t K2D_CreateTextureEx(const wchar_t *Filename, std::uint32_t Flags, std::uint32_t Colorkey)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::CreateTexture);
+	capture.File(Filename) << Flags << Colorkey;
+
+	// Filename valid?
+	if (!Filename)
+	{
+		return 0;
+	}
+
+	// Create texture
+	std::shared_ptr<Kyo2D::Texture> texture = Kyo2D::CreateTextureInstance(Flags, Colorkey);
+	if (!texture.get())
+	{
+		return 0;
+	}
+
+	// Initialize (load) texture
+	{
+		std::lock_guard<std::mutex> lock(Kyo2D::Texture::GetLoaderMutex());
+		K2D_PROFILE_SCOPE(g_Context->Profiler, "Texture::Initialize");
+		if (!texture->Initialize(Filename))
+		{
+			return 0;
+		}
+	}
+
+	// Remember the source, so the texture can be evicted and restored
+	texture->KeepSource(Filename);
+
+	g_Context->Stats.TexturesCreated++;
+	g_Context->Stats.BytesUploaded += texture->GetMemoryUsage();
+
+	// Save sprite
+	return capture.Result(Kyo2D::RegisterTexture(std::move(texture)));
+}
+
+K2D_API std::uint32_t K2D_CreateTextureFromMemoryEx(const char *data, std::uint32_t size, std::uint32_t Flags, std::uint32_t Colorkey)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::CreateTexture);
+	capture.Blob(data, size) << Flags << Colorkey;
+
+	// Validate data
+	if (!data || size == 0)
+	{
+		return 0;
+	}
+
+	// Create texture
+	std::shared_ptr<Kyo2D::Texture> texture = Kyo2D::CreateTextureInstance(Flags, Colorkey);
+	if (!texture.get())
+	{
+		return 0;
+	}
+
+	// Initialize (load) texture
+	{
+		std::lock_guard<std::mutex> lock(Kyo2D::Texture::GetLoaderMutex());
+		K2D_PROFILE_SCOPE(g_Context->Profiler, "Texture::Initialize");
+		if (!texture->Initialize(data, size))
+		{
+			return 0;
+		}
+	}
+
+	// Remember the source, so the texture can be evicted and restored
+	texture->KeepSource(data, size);
+
+	g_Context->Stats.TexturesCreated++;
+	g_Context->Stats.BytesUploaded += texture->GetMemoryUsage();
+
+	// Save sprite
+	return capture.Result(Kyo2D::RegisterTexture(std::move(texture)));
+}
+
+K2D_API std::uint32_t K2D_CreateTextureFromPixels(std::uint32_t Width, std::uint32_t Height, std::uint32_t Format, std::uint32_t Stride, const void *Data)
+{
+	// Alpha-only pixels are kept with one byte per pixel, everything else is stored as RGBA8
+	const bool alphaOnly = Format == K2D_PIXEL_A8;
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::CreateTextureFromPixels);
+	capture << Width << Height << static_cast<std::uint32_t>(alphaOnly ? K2D_PIXEL_A8 : K2D_PIXEL_RGBA8);
+
+	// Validate data
+	const std::uint32_t pixelSize = Kyo2D::Texture::GetPixelSize(Format);
+	if (!Data || Width == 0 || Height == 0 || pixelSize == 0)
+	{
+		capture.Blob(nullptr, 0);
+		return 0;
+	}
+
+	if (Stride == 0)
+		Stride = Width * pixelSize;
+	if (Stride < Width * pixelSize)
+	{
+		capture.Blob(nullptr, 0);
+		return 0;
+	}
+
+	// Tightly packed RGBA8 and A8 pixels can be uploaded as they are
+	const std::uint32_t *pixels = static_cast<const std::uint32_t*>(Data);
+	const std::uint8_t *alpha = static_cast<const std::uint8_t*>(Data);
+	std::vector<std::uint32_t> converted;
+	std::vector<std::uint8_t> packed;
+	if (alphaOnly)
+	{
+		if (Stride != Width)
+		{
+			packed.resize(static_cast<size_t>(Width) * Height);
+			for (std::uint32_t y = 0; y < Height; ++y)
+				std::memcpy(&packed[static_cast<size_t>(y) * Width], alpha + static_cast<size_t>(y) * Stride, Width);
+			alpha = packed.data();
+		}
+
+		capture.Blob(alpha, static_cast<size_t>(Width) * Height);
+	}
+	else
+	{
+		if (Format != K2D_PIXEL_RGBA8 || Stride != Width * 4)
+		{
+			converted.resize(static_cast<size_t>(Width) * Height);
+			Kyo2D::Texture::ConvertPixels(Format, Data, Width, Height, Stride, converted.data());
+			pixels = converted.data();
+		}
+
+		capture.Blob(pixels, static_cast<size_t>(Width) * Height * 4);
+	}
+
+	// Create texture
+	std::shared_ptr<Kyo2D::Texture> texture = Kyo2D::CreateTextureInstance(0, 0);
+	if (!texture.get())
+	{
+		return 0;
+	}
+
+	{
+		K2D_PROFILE_SCOPE(g_Context->Profiler, "Texture::InitializePixels");
+		bool initialized = alphaOnly && texture->InitializeAlpha(Width, Height, alpha);
+		if (!initialized)
+		{
+			// Backends without single-channel textures get white RGBA8 pixels instead
+			if (alphaOnly)
+			{
+				converted.resize(static_cast<size_t>(Width) * Height);
+				Kyo2D::Texture::ConvertPixels(K2D_PIXEL_A8, alpha, Width, Height, Width, converted.data());
+				pixels = converted.data();
+			}
+
+			initialized = texture->InitializePixels(Width, Height, pixels);
+		}
+
+		if (!initialized)
+		{
+			return 0;
+		}
+	}
+
+	texture->SetPixelFormat(Format);
+
+	g_Context->Stats.TexturesCreated++;
+	g_Context->Stats.BytesUploaded += texture->GetMemoryUsage();
+
+	// Save sprite
+	return capture.Result(Kyo2D::RegisterTexture(std::move(texture)));
+}
+
+K2D_API bool K2D_UpdateTextureRegion(std::uint32_t TextureId, std::uint32_t X, std::uint32_t Y, std::uint32_t Width, std::uint32_t Height, const void *Data)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::UpdateTextureRegion);
+	capture << TextureId << X << Y << Width << Height;
+
+	auto it = g_Context->Textures.find(TextureId);
+	if (it == g_Context->Textures.end() || !Data || Width == 0 || Height == 0)
+	{
+		capture << static_cast<std::uint32_t>(K2D_PIXEL_RGBA8);
+		capture.Blob(nullptr, 0);
+		return false;
+	}
+
+	// Evicted textures are restored first, the update would be lost otherwise
+	Kyo2D::Texture &texture = *it->second;
+	const std::uint32_t format = texture.GetPixelFormat();
+	capture << static_cast<std::uint32_t>(format == K2D_PIXEL_A8 ? K2D_PIXEL_A8 : K2D_PIXEL_RGBA8);
+	if (!g_Context->Residency.Touch(texture))
+	{
+		capture.Blob(nullptr, 0);
+		return false;
+	}
+
+	if (format == K2D_PIXEL_A8)
+		capture.Blob(Data, static_cast<size_t>(Width) * Height);
+
+	std::uint64_t uploaded = static_cast<std::uint64_t>(Width) * Height;
+	if (texture.IsAlphaOnly())
+	{
+		if (!texture.UpdateAlphaRegion(X, Y, Width, Height, static_cast<const std::uint8_t*>(Data)))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		const std::uint32_t *pixels = static_cast<const std::uint32_t*>(Data);
+		std::vector<std::uint32_t> converted;
+		if (format != K2D_PIXEL_RGBA8)
+		{
+			converted.resize(static_cast<size_t>(Width) * Height);
+			Kyo2D::Texture::ConvertPixels(format, Data, Width, Height, static_cast<size_t>(Width) * Kyo2D::Texture::GetPixelSize(format), converted.data());
+			pixels = converted.data();
+		}
+
+		if (format != K2D_PIXEL_A8)
+			capture.Blob(pixels, static_cast<size_t>(Width) * Height * 4);
+
+		if (!texture.UpdateRegion(X, Y, Width, Height, pixels))
+		{
+			return false;
+		}
+
+		uploaded *= 4;
+	}
+
+	// Restoring from the source would lose the update. Draw calls using the texture have to
+	// be redrawn by damage tracking.
+	texture.DiscardSource();
+	texture.IncrementVersion();
+	g_Context->Stats.BytesUploaded += uploaded;
+	return true;
+}
+
+K2D_API bool K2D_DestroyTexture(std::uint32_t TextureId)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DestroyTexture);
+	capture << TextureId;
+
+	auto it = g_Context->Textures.find(TextureId);
+	if (it == g_Context->Textures.end())
+	{
+		return false;
+	}
+
+	g_Context->Residency.Remove(TextureId);
+	it = g_Context->Textures.erase(it);
+	return true;
+}
+
+K2D_API K2D_Point K2D_GetTextureSize(std::uint32_t TextureId)
+{
+	K2D_Point point;
+	
+	auto it = g_Context->Textures.find(TextureId);
+	if (it != g_Context->Textures.end())
+	{
+		point.X = static_cast<float>(it->second->GetWidth());
+		point.Y = static_cast<float>(it->second->GetHeight());
+	}
+	else
+	{
+		point.X = 0.0f;
+		point.Y = 0.0f;
+	}
+
+	return point;
+}
+
+K2D_API void K2D_SetTextureBudget(std::uint64_t Bytes)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::SetTextureBudget);
+	capture << Bytes;
+
+	g_Context->Residency.SetBudget(Bytes);
+}
+
+K2D_API K2D_TextureMemoryStats K2D_GetTextureMemoryStats()
+{
+	Kyo2D::TextureResidency::Stats stats = g_Context->Residency.GetStats();
+
+	K2D_TextureMemoryStats result;
+	result.Budget = stats.Budget;
+	result.Usage = stats.Usage;
+	result.ResidentTextures = stats.ResidentTextures;
+	result.EvictedTextures = stats.EvictedTextures;
+	result.Evictions = stats.Evictions;
+	result.Restores = stats.Restores;
+	return result;
+}
+
+K2D_API std::uint32_t K2D_RegisterTextureDecoder(const wchar_t * /*extension*/, DecodeTexPtr /*decoder*/)
+{
+	// TODO
+
+	return 0;
+}
+
+K2D_API bool K2D_UnregisterTextureDecoder(std::uint32_t /*decoderId*/)
+{
+	// TODO
+
+	return false;
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// SPRITE RENDERING
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+K2D_API void K2D_SetScale2XEnabled(bool enable)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::SetScale2XEnabled);
+	capture << enable;
+
+	if (g_Context->SpriteDrawer)
+		g_Context->SpriteDrawer->SetScale2XEnabled(enable);
+}
+
+K2D_API bool K2D_DrawSpriteAt(std::uint32_t TextureId, float X, float Y, float Z, float Rotation, std::uint32_t color, std::uint32_t colorkey)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DrawSpriteAt);
+	capture << TextureId << X << Y << Z << Rotation << color << colorkey;
+
+	Kyo2D::DrawCall call = { Kyo2D::draw_call::SpriteAt, TextureId, X, Y, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, Z, Rotation, color, colorkey, g_Context->SpriteDrawer && g_Context->SpriteDrawer->IsScale2XEnabled(), 0, 0 };
+	return SubmitDrawCall(call);
+}
+
+K2D_API bool K2D_DrawSubspriteAt(std::uint32_t TextureId, float X, float Y, float srcX, float srcY, float srcW, float srcH, float Z, float Rotation, std::uint32_t color, std::uint32_t colorkey)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DrawSubspriteAt);
+	capture << TextureId << X << Y << srcX << srcY << srcW << srcH << Z << Rotation << color << colorkey;
+
+	Kyo2D::DrawCall call = { Kyo2D::draw_call::SubspriteAt, TextureId, X, Y, 0.0f, 0.0f, srcX, srcY, srcW, srcH, Z, Rotation, color, colorkey, g_Context->SpriteDrawer && g_Context->SpriteDrawer->IsScale2XEnabled(), 0, 0 };
+	return SubmitDrawCall(call);
+}
+
+K2D_API bool K2D_DrawSpriteScaled(std::uint32_t TextureId, float X, float Y, float W, float H, float Z, float Rotation, std::uint32_t color, std::uint32_t colorkey)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DrawSpriteScaled);
+	capture << TextureId << X << Y << W << H << Z << Rotation << color << colorkey;
+
+	Kyo2D::DrawCall call = { Kyo2D::draw_call::SpriteScaled, TextureId, X, Y, W, H, 0.0f, 0.0f, 0.0f, 0.0f, Z, Rotation, color, colorkey, g_Context->SpriteDrawer && g_Context->SpriteDrawer->IsScale2XEnabled(), 0, 0 };
+	return SubmitDrawCall(call);
+}
+
+K2D_API bool K2D_DrawSubspriteScaled(std::uint32_t TextureId, float X, float Y, float W, float H, float srcX, float srcY, float srcW, float srcH, float Z, float Rotation, std::uint32_t color, std::uint32_t colorkey)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DrawSubspriteScaled);
+	capture << TextureId << X << Y << W << H << srcX << srcY << srcW << srcH << Z << Rotation << color << colorkey;
+
+	Kyo2D::DrawCall call = { Kyo2D::draw_call::SubspriteScaled, TextureId, X, Y, W, H, srcX, srcY, srcW, srcH, Z, Rotation, color, colorkey, g_Context->SpriteDrawer && g_Context->SpriteDrawer->IsScale2XEnabled(), 0, 0 };
+	return SubmitDrawCall(call);
+}
+
+K2D_API bool K2D_DrawSpriteTiled(std::uint32_t TextureId, float X, float Y, float W, float H, float tX, float tY, float Z, float Rotation, std::uint32_t color, std::uint32_t colorkey)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DrawSpriteTiled);
+	capture << TextureId << X << Y << W << H << tX << tY << Z << Rotation << color << colorkey;
+
+	Kyo2D::DrawCall call = { Kyo2D::draw_call::SpriteTiled, TextureId, X, Y, W, H, tX, tY, 0.0f, 0.0f, Z, Rotation, color, colorkey, g_Context->SpriteDrawer && g_Context->SpriteDrawer->IsScale2XEnabled(), 0, 0 };
+	return SubmitDrawCall(call);
+}
+
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// FONT METHODS
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Starts the threads which rasterize glyphs, unless this already happened.
+static void StartGlyphWorkers()
+{
+	if (!g_Context->GlyphWorkersStarted)
+	{
+		g_Context->GlyphWorkers.Initialize(g_Context->GlyphWorkerThreads);
+		g_Context->GlyphWorkersStarted = true;
+	}
+}
+
+K2D_API std::uint32_t K2D_CreateFont(const wchar_t * Filename, float PointSize, float Outline)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::CreateFont);
+	capture.File(Filename) << PointSize << Outline;
+
+	// Filename valid?
+	if (!Filename)
+		return 0;
+
+	// Create texture
+	auto font = std::make_shared<Kyo2D::Font>();
+	if (!font)
+	{
+		return 0;
+	}
+
+	// Initialize the font
+	StartGlyphWorkers();
+	if (!font->Initialize(std::wstring(Filename), PointSize, Outline))
+	{
+		return 0;
+	}
+
+	// Save sprite
+	std::uint32_t fontId = g_Context->NextFont++;
+	g_Context->Fonts[fontId] = std::move(font);
+
+	return capture.Result(fontId);
+}
+
+K2D_API std::uint32_t K2D_CreateFontFromMemory(const std::uint8_t* Buffer, std::uint32_t BufferSize, float PointSize, float Outline)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::CreateFont);
+	capture.Blob(Buffer, BufferSize) << PointSize << Outline;
+
+	if (!Buffer)
+		return 0;
+
+	if (BufferSize == 0)
+		return 0;
+
+	// Create texture
+	auto font = std::make_shared<Kyo2D::Font>();
+	if (!font)
+	{
+		return 0;
+	}
+
+	// Initialize the font
+	StartGlyphWorkers();
+	if (!font->Initialize(Buffer, BufferSize, PointSize, Outline))
+	{
+		return 0;
+	}
+
+	// Save sprite
+	std::uint32_t fontId = g_Context->NextFont++;
+	g_Context->Fonts[fontId] = std::move(font);
+
+	return capture.Result(fontId);
+}
+
+/// Creates a distance field font from a file or from memory.
+static std::uint32_t CreateFontSDF(const std::uint8_t* Buffer, std::uint32_t BufferSize, const wchar_t* Filename, float ReferenceSize)
+{
+	auto font = std::make_shared<Kyo2D::Font>();
+	if (!font)
+	{
+		return 0;
 	}
-	
-	return false;
-}
 
-K2D_API bool K2D_SetRenderTarget(std::uint32_t RenderTarget)
-{
-	auto it = g_RenderTargets.find(RenderTarget);
-	if (it == g_RenderTargets.end())
+	// Initialize the font
+	StartGlyphWorkers();
+	const bool initialized = Filename ?
+		font->Initialize(std::wstring(Filename), ReferenceSize, 0.0f, true) :
+		font->Initialize(Buffer, BufferSize, ReferenceSize, 0.0f, true);
+	if (!initialized)
 	{
-		return false;
+		return 0;
 	}
 
-	g_ActiveRenderTarget = it->second;
-	it->second->Set();
+	std::uint32_t fontId = g_Context->NextFont++;
+	g_Context->Fonts[fontId] = std::move(font);
+	return fontId;
+}
 
-	// Update view matrix for draw helper
-	if (g_DrawHelper)
-		g_DrawHelper->UpdateViewMatrix(it->second->GetViewMatrix());
+K2D_API std::uint32_t K2D_CreateFontSDF(const wchar_t * Filename, float ReferenceSize)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::CreateFontSDF);
+	capture.File(Filename) << ReferenceSize;
 
-	// Same for sprite drawer
-	if (g_SpriteDrawer)
-		g_SpriteDrawer->SetViewMatrix(it->second->GetViewMatrix());
+	if (!Filename)
+		return 0;
 
-	return true;
+	return capture.Result(CreateFontSDF(nullptr, 0, Filename, ReferenceSize));
 }
 
-K2D_API bool K2D_ClearRenderTarget(float r, float g, float b)
+K2D_API std::uint32_t K2D_CreateFontSDFFromMemory(const std::uint8_t* Buffer, std::uint32_t BufferSize, float ReferenceSize)
 {
-	auto rt = g_ActiveRenderTarget.lock();
-	if (!rt)
-	{
-		return false;
-	}
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::CreateFontSDF);
+	capture.Blob(Buffer, BufferSize) << ReferenceSize;
 
-	rt->Clear(r, g, b);
-	return true;
+	if (!Buffer || BufferSize == 0)
+		return 0;
+
+	return capture.Result(CreateFontSDF(Buffer, BufferSize, nullptr, ReferenceSize));
 }
 
-K2D_API bool K2D_SetVSyncEnabled(bool Enable)
+/// Loads a font family from a file or from memory.
+static std::uint32_t CreateFontFamily(const std::uint8_t* Buffer, std::uint32_t BufferSize, const wchar_t* Filename)
 {
-	auto rt = g_ActiveRenderTarget.lock();
-	if (!rt)
+	auto family = std::make_shared<Kyo2D::FontFamily>();
+	const bool initialized = Filename ?
+		family->Initialize(std::wstring(Filename)) :
+		family->Initialize(Buffer, BufferSize);
+	if (!initialized)
+		return 0;
+
+	std::uint32_t familyId = g_Context->NextFontFamily++;
+	g_Context->FontFamilies[familyId] = std::move(family);
+	return familyId;
+}
+
+K2D_API std::uint32_t K2D_CreateFontFamily(const wchar_t* Filename)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::CreateFontFamily);
+	capture.File(Filename);
+
+	if (!Filename)
+		return 0;
+
+	return capture.Result(CreateFontFamily(nullptr, 0, Filename));
+}
+
+K2D_API std::uint32_t K2D_CreateFontFamilyFromMemory(const std::uint8_t* Buffer, std::uint32_t BufferSize)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::CreateFontFamily);
+	capture.Blob(Buffer, BufferSize);
+
+	if (!Buffer || BufferSize == 0)
+		return 0;
+
+	return capture.Result(CreateFontFamily(Buffer, BufferSize, nullptr));
+}
+
+/// Creates a font as a size of a loaded font family.
+static std::uint32_t CreateFamilyFont(std::uint32_t FamilyId, float PointSize, float Outline, bool DistanceField)
+{
+	auto it = g_Context->FontFamilies.find(FamilyId);
+	if (it == g_Context->FontFamilies.end())
+		return 0;
+
+	StartGlyphWorkers();
+	auto font = std::make_shared<Kyo2D::Font>();
+	if (!font->Initialize(it->second, PointSize, Outline, DistanceField))
+		return 0;
+
+	std::uint32_t fontId = g_Context->NextFont++;
+	g_Context->Fonts[fontId] = std::move(font);
+	return fontId;
+}
+
+K2D_API std::uint32_t K2D_CreateFontFromFamily(std::uint32_t FamilyId, float PointSize, float Outline)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::CreateFontFromFamily);
+	capture << FamilyId << PointSize << Outline;
+
+	return capture.Result(CreateFamilyFont(FamilyId, PointSize, Outline, false));
+}
+
+K2D_API std::uint32_t K2D_CreateFontSDFFromFamily(std::uint32_t FamilyId, float ReferenceSize)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::CreateFontSDFFromFamily);
+	capture << FamilyId << ReferenceSize;
+
+	return capture.Result(CreateFamilyFont(FamilyId, ReferenceSize, 0.0f, true));
+}
+
+K2D_API bool K2D_DestroyFontFamily(std::uint32_t FamilyId)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DestroyFontFamily);
+	capture << FamilyId;
+
+	// The fonts of the family keep it alive
+	return g_Context->FontFamilies.erase(FamilyId) != 0;
+}
+
+K2D_API void K2D_SetGlyphCacheDirectory(const wchar_t* Directory)
+{
+	g_Context->GlyphCacheDirectory = Directory ? Directory : L"";
+}
+
+K2D_API void K2D_SetGlyphWorkerThreads(std::uint32_t Threads)
+{
+	// Glyphs are packed in the same order for any number of threads, so replays aren't affected
+	g_Context->GlyphWorkerThreads = Threads;
+	if (g_Context->GlyphWorkersStarted)
+		g_Context->GlyphWorkers.Initialize(Threads);
+}
+
+K2D_API bool K2D_SaveGlyphCaches()
+{
+	bool saved = true;
+	for (auto &font : g_Context->Fonts)
 	{
-		return false;
+		if (!font.second->saveGlyphCache())
+			saved = false;
 	}
-
-	rt->SetVSyncEnabled(Enable);
-	return true;
+	return saved;
 }
 
-K2D_API bool K2D_PresentRenderTarget()
+K2D_API bool K2D_DestroyFont(std::uint32_t FontId)
 {
-	auto rt = g_ActiveRenderTarget.lock();
-	if (!rt)
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DestroyFont);
+	capture << FontId;
+
+	auto it = g_Context->Fonts.find(FontId);
+	if (it == g_Context->Fonts.end())
 	{
 		return false;
 	}
 
-	rt->Present();
+	g_Context->LayoutCache.RemoveFont(FontId);
+	it = g_Context->Fonts.erase(it);
 	return true;
 }
 
-K2D_API bool K2D_ResizeRenderTarget(std::uint16_t Width, std::uint16_t Height)
+K2D_API bool K2D_DrawText(std::uint32_t FontId, const wchar_t * Text, float X, float Y, std::uint32_t RGBA)
 {
-	auto rt = g_ActiveRenderTarget.lock();
-	if (!rt)
-	{
-		return false;
-	}
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DrawText);
+	capture << FontId;
+	capture.String(Text) << X << Y << RGBA;
 
-	if (!rt->Resize(Width, Height))
-	{
+	if (!Text)
 		return false;
-	}
 
-	rt->Set();
+	return DrawCachedText(FontId, Kyo2D::TextView(Text), X, Y, RGBA);
+}
 
-	// Update view matrix for draw helper
-	if (g_DrawHelper)
-		g_DrawHelper->UpdateViewMatrix(rt->GetViewMatrix());
+K2D_API bool K2D_DrawTextUtf8(std::uint32_t FontId, const char * Text, std::uint32_t Length, float X, float Y, std::uint32_t RGBA)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DrawTextUtf8);
+	capture << FontId;
+	capture.Bytes(Text, Length) << X << Y << RGBA;
 
-	// Same for sprite drawer
-	if (g_SpriteDrawer)
-		g_SpriteDrawer->SetViewMatrix(rt->GetViewMatrix());
-	
-	return true;
+	if (!Text)
+		return false;
+
+	return DrawCachedText(FontId, Kyo2D::TextView(Text, Length), X, Y, RGBA);
 }
 
+K2D_API bool K2D_DrawTextUtf16(std::uint32_t FontId, const char16_t * Text, std::uint32_t Length, float X, float Y, std::uint32_t RGBA)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DrawTextUtf16);
+	capture << FontId;
+	capture.Bytes(Text, Length * sizeof(char16_t)) << X << Y << RGBA;
 
+	if (!Text)
+		return false;
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-// TEXTURE MANAGEMENT
-////////////////////////////////////////////////////////////////////////////////////////////////////
+	return DrawCachedText(FontId, Kyo2D::TextView(Text, Length), X, Y, RGBA);
+}
 
-K2D_API std::uint32_t K2D_CreateTexture(const wchar_t *Filename)
+K2D_API bool K2D_DrawTextEx(std::uint32_t FontId, const wchar_t * Text, float X, float Y, const K2D_TextStyle * Style)
 {
-	// Filename valid?
-	if (!Filename)
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DrawTextEx);
+	capture << FontId;
+	capture.String(Text) << X << Y << (Style != nullptr);
+	if (Style)
+		capture << Style->RGBA << Style->Scale << Style->OutlineWidth << Style->OutlineRGBA
+			<< Style->ShadowOffsetX << Style->ShadowOffsetY << Style->ShadowSoftness << Style->ShadowRGBA;
+
+	if (!Text || !Style)
+		return false;
+
+	auto it = g_Context->Fonts.find(FontId);
+	if (it == g_Context->Fonts.end())
 	{
-		return 0;
+		return false;
 	}
 
-	// Create texture
-	std::shared_ptr<Kyo2D::Texture> texture;
-	if (g_UseD3D11)
-		texture = std::make_shared<Kyo2D::TextureD3D11>();
-	else
-		texture = std::make_shared<Kyo2D::TextureD3D9>();
+	it->second->drawText(Text, Kyo2D::Vector2(X, Y), *Style);
+	return true;
+}
 
-	// Check if creation was successful
-	if (!texture.get())
-	{
+K2D_API std::uint32_t K2D_CreateTextLayout(std::uint32_t FontId, const wchar_t * Text, const K2D_TextLayoutOptions * Options)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::CreateTextLayout);
+	capture << FontId;
+	capture.String(Text) << (Options ? Options->Scale : 1.0f);
+
+	if (!Text)
 		return 0;
-	}
 
-	// Initialize (load) texture
-	if (!texture->Initialize(Filename))
+	auto it = g_Context->Fonts.find(FontId);
+	if (it == g_Context->Fonts.end())
 	{
 		return 0;
 	}
 
-	// Save sprite
-	std::uint32_t textureId = g_NextTexture++;
-	g_Textures[textureId] = std::move(texture);
+	auto layout = std::make_shared<Kyo2D::TextLayout>();
+	layout->Initialize(it->second, Text, Options ? Options->Scale : 1.0f);
 
-	return textureId;
+	std::uint32_t layoutId = g_Context->NextTextLayout++;
+	g_Context->TextLayouts[layoutId] = std::move(layout);
+
+	return capture.Result(layoutId);
 }
 
-K2D_API std::uint32_t K2D_CreateTextureFromMemory(const char *data, std::uint32_t size)
+K2D_API bool K2D_DestroyTextLayout(std::uint32_t LayoutId)
 {
-	// Validate data
-	if (!data || size == 0)
-	{
-		return 0;
-	}
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DestroyTextLayout);
+	capture << LayoutId;
 
-	// Create texture
-	std::shared_ptr<Kyo2D::Texture> texture;
-	if (g_UseD3D11)
-		texture = std::make_shared<Kyo2D::TextureD3D11>();
-	else
-		texture = std::make_shared<Kyo2D::TextureD3D9>();
+	return g_Context->TextLayouts.erase(LayoutId) != 0;
+}
 
-	// Check if creation was successful
-	if (!texture.get())
-	{
-		return 0;
-	}
+K2D_API bool K2D_DrawTextLayout(std::uint32_t LayoutId, float X, float Y, std::uint32_t RGBA)
+{
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DrawTextLayout);
+	capture << LayoutId << X << Y << RGBA;
 
-	// Initialize (load) texture
-	if (!texture->Initialize(data, size))
+	auto it = g_Context->TextLayouts.find(LayoutId);
+	if (it == g_Context->TextLayouts.end())
 	{
-		return 0;
+		return false;
 	}
 
-	// Save sprite
-	std::uint32_t textureId = g_NextTexture++;
-	g_Textures[textureId] = std::move(texture);
-
-	return textureId;
+	it->second->Draw(X, Y, RGBA);
+	return true;
 }
 
-K2D_API bool K2D_DestroyTexture(std::uint32_t TextureId)
+K2D_API bool K2D_GetTextLayoutSize(std::uint32_t LayoutId, float * Width, float * Height)
 {
-	auto it = g_Textures.find(TextureId);
-	if (it == g_Textures.end())
+	auto it = g_Context->TextLayouts.find(LayoutId);
+	if (it == g_Context->TextLayouts.end())
 	{
 		return false;
 	}
 
-	it = g_Textures.erase(it);
+	if (Width)
+		*Width = it->second->GetWidth();
+	if (Height)
+		*Height = it->second->GetHeight();
 	return true;
 }
 
-K2D_API K2D_Point K2D_GetTextureSize(std::uint32_t TextureId)
+K2D_API std::uint32_t K2D_CreateTextDocument(std::uint32_t FontId, const K2D_TextDocumentOptions * Options)
 {
-	K2D_Point point;
-	
-	auto it = g_Textures.find(TextureId);
-	if (it != g_Textures.end())
-	{
-		point.X = static_cast<float>(it->second->GetWidth());
-		point.Y = static_cast<float>(it->second->GetHeight());
-	}
-	else
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::CreateTextDocument);
+	capture << FontId << (Options != nullptr);
+	if (Options)
+		capture << Options->Scale << Options->WrapWidth << Options->ParagraphSpacing;
+
+	auto it = g_Context->Fonts.find(FontId);
+	if (it == g_Context->Fonts.end())
 	{
-		point.X = 0.0f;
-		point.Y = 0.0f;
+		return 0;
 	}
 
-	return point;
-}
+	auto document = std::make_shared<Kyo2D::TextDocument>();
+	if (Options)
+		document->Initialize(it->second, Options->Scale, Options->WrapWidth, Options->ParagraphSpacing);
+	else
+		document->Initialize(it->second, 1.0f, 0.0f, 0.0f);
 
-K2D_API std::uint32_t K2D_RegisterTextureDecoder(const wchar_t *extension, DecodeTexPtr decoder)
-{
-	// TODO
+	std::uint32_t documentId = g_Context->NextTextDocument++;
+	g_Context->TextDocuments[documentId] = std::move(document);
 
-	return 0;
+	return capture.Result(documentId);
 }
 
-K2D_API bool K2D_UnregisterTextureDecoder(std::uint32_t decoderId)
+K2D_API bool K2D_DestroyTextDocument(std::uint32_t DocumentId)
 {
-	// TODO
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DestroyTextDocument);
+	capture << DocumentId;
 
-	return false;
+	return g_Context->TextDocuments.erase(DocumentId) != 0;
 }
 
-
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-// SPRITE RENDERING
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-K2D_API void K2D_SetScale2XEnabled(bool enable)
+K2D_API bool K2D_AppendTextDocumentUtf8(std::uint32_t DocumentId, const char * Text, std::uint32_t Length)
 {
-	if (g_SpriteDrawer)
-		g_SpriteDrawer->SetScale2XEnabled(enable);
-}
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::AppendTextDocumentUtf8);
+	capture << DocumentId;
+	capture.Bytes(Text, Length);
 
-K2D_API bool K2D_DrawSpriteAt(std::uint32_t TextureId, float X, float Y, float Z, float Rotation, std::uint32_t color, std::uint32_t colorkey)
-{
-	// Try to find the given texture
-	std::int32_t w = 0, h = 0;
-	if (!BindTextureStage(TextureId, w, h))
+	if (!Text && Length)
 		return false;
 
-	g_SpriteDrawer->DrawSpriteAt(w, h, X, Y, Z, Rotation, color, colorkey);
+	auto it = g_Context->TextDocuments.find(DocumentId);
+	if (it == g_Context->TextDocuments.end())
+	{
+		return false;
+	}
+
+	it->second->Append(Kyo2D::TextView(Text, Length));
 	return true;
 }
 
-K2D_API bool K2D_DrawSubspriteAt(std::uint32_t TextureId, float X, float Y, float srcX, float srcY, float srcW, float srcH, float Z, float Rotation, std::uint32_t color, std::uint32_t colorkey)
+K2D_API bool K2D_AppendTextDocumentUtf16(std::uint32_t DocumentId, const char16_t * Text, std::uint32_t Length)
 {
-	// Try to find the given texture
-	std::int32_t w = 0, h = 0;
-	if (!BindTextureStage(TextureId, w, h))
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::AppendTextDocumentUtf16);
+	capture << DocumentId;
+	capture.Bytes(Text, Length * sizeof(char16_t));
+
+	if (!Text && Length)
+		return false;
+
+	auto it = g_Context->TextDocuments.find(DocumentId);
+	if (it == g_Context->TextDocuments.end())
+	{
 		return false;
+	}
 
-	g_SpriteDrawer->DrawSubspriteAt(w, h, X, Y, Z, srcX, srcY, srcW, srcH, Rotation, color, colorkey);
+	it->second->Append(Kyo2D::TextView(Text, Length));
 	return true;
 }
 
-K2D_API bool K2D_DrawSpriteScaled(std::uint32_t TextureId, float X, float Y, float W, float H, float Z, float Rotation, std::uint32_t color, std::uint32_t colorkey)
+K2D_API bool K2D_ClearTextDocument(std::uint32_t DocumentId)
 {
-	// Try to find the given texture
-	std::int32_t w = 0, h = 0;
-	if (!BindTextureStage(TextureId, w, h))
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::ClearTextDocument);
+	capture << DocumentId;
+
+	auto it = g_Context->TextDocuments.find(DocumentId);
+	if (it == g_Context->TextDocuments.end())
+	{
 		return false;
+	}
 
-	g_SpriteDrawer->DrawSpriteScaled(w, h, X, Y, Z, W, H, Rotation, color, colorkey);
+	it->second->Clear();
 	return true;
 }
 
-K2D_API bool K2D_DrawSubspriteScaled(std::uint32_t TextureId, float X, float Y, float W, float H, float srcX, float srcY, float srcW, float srcH, float Z, float Rotation, std::uint32_t color, std::uint32_t colorkey)
+K2D_API bool K2D_DrawTextDocument(std::uint32_t DocumentId, float X, float Y, double ScrollY, float ViewHeight, std::uint32_t RGBA)
 {
-	// Try to find the given texture
-	std::int32_t w = 0, h = 0;
-	if (!BindTextureStage(TextureId, w, h))
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DrawTextDocument);
+	capture << DocumentId << X << Y << ScrollY << ViewHeight << RGBA;
+
+	auto it = g_Context->TextDocuments.find(DocumentId);
+	if (it == g_Context->TextDocuments.end())
+	{
 		return false;
+	}
 
-	g_SpriteDrawer->DrawSubspriteScaled(w, h, X, Y, Z, W, H, srcX, srcY, srcW, srcH, Rotation, color, colorkey);
+	it->second->Draw(X, Y, ScrollY, ViewHeight, RGBA);
 	return true;
 }
 
-K2D_API bool K2D_DrawSpriteTiled(std::uint32_t TextureId, float X, float Y, float W, float H, float tX, float tY, float Z, float Rotation, std::uint32_t color, std::uint32_t colorkey)
+K2D_API bool K2D_GetTextDocumentSize(std::uint32_t DocumentId, double * Height, std::uint32_t * Lines)
 {
-	// Try to find the given texture
-	std::int32_t w = 0, h = 0;
-	if (!BindTextureStage(TextureId, w, h))
+	auto it = g_Context->TextDocuments.find(DocumentId);
+	if (it == g_Context->TextDocuments.end())
+	{
 		return false;
+	}
 
-	g_SpriteDrawer->DrawSpriteTiled(w, h, X, Y, Z, W, H, tX, tY, Rotation, color, colorkey);
+	if (Height)
+		*Height = it->second->GetHeight();
+	if (Lines)
+		*Lines = static_cast<std::uint32_t>(it->second->GetLineCount());
 	return true;
 }
 
-
-
-////////////////////////////////////////////////////////////////////////////////////////////////////
-// FONT METHODS
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-K2D_API std::uint32_t K2D_CreateFont(const wchar_t * Filename, float PointSize, float Outline)
+K2D_API bool K2D_MeasureTexts(std::uint32_t FontId, const char16_t * Texts, const std::uint32_t * Lengths, std::uint32_t Count, float Scale, K2D_TextMetrics * Metrics)
 {
-	// Filename valid?
-	if (!Filename)
-		return 0;
+	if (Count && (!Texts || !Lengths || !Metrics))
+		return false;
 
-	// Create texture
-	auto font = std::make_shared<Kyo2D::Font>();
-	if (!font)
+	auto it = g_Context->Fonts.find(FontId);
+	if (it == g_Context->Fonts.end())
 	{
-		return 0;
+		return false;
 	}
 
-	// Initialize the font
-	if (!font->Initialize(std::wstring(Filename), PointSize, Outline))
+	Kyo2D::Font &font = *it->second;
+	const float scale = Scale > 0.0f ? Scale : 1.0f;
+	const float height = font.getHeight(scale);
+
+	for (std::uint32_t i = 0; i < Count; ++i)
 	{
-		return 0;
+		Metrics[i].Width = font.getTextWidth(Kyo2D::TextView(Texts, Lengths[i]), scale, &Metrics[i].Advance);
+		Metrics[i].Height = height;
+		Texts += Lengths[i];
 	}
 
-	// Save sprite
-	std::uint32_t fontId = g_NextFont++;
-	g_Fonts[fontId] = std::move(font);
-
-	return fontId;
+	return true;
 }
 
-K2D_API std::uint32_t K2D_CreateFontFromMemory(const std::uint8_t* Buffer, std::uint32_t BufferSize, float PointSize, float Outline)
+K2D_API std::uint32_t K2D_WrapText(std::uint32_t FontId, const char16_t * Text, std::uint32_t Length, float MaxWidth, float Scale, std::uint32_t * LineEnds, std::uint32_t MaxLines)
 {
-	if (!Buffer)
-		return 0;
-
-	if (BufferSize == 0)
-		return 0;
-
-	// Create texture
-	auto font = std::make_shared<Kyo2D::Font>();
-	if (!font)
-	{
+	if ((Length && !Text) || (MaxLines && !LineEnds))
 		return 0;
-	}
 
-	// Initialize the font
-	if (!font->Initialize(Buffer, BufferSize, PointSize, Outline))
+	auto it = g_Context->Fonts.find(FontId);
+	if (it == g_Context->Fonts.end())
 	{
 		return 0;
 	}
 
-	// Save sprite
-	std::uint32_t fontId = g_NextFont++;
-	g_Fonts[fontId] = std::move(font);
-
-	return fontId;
+	const float scale = Scale > 0.0f ? Scale : 1.0f;
+	return static_cast<std::uint32_t>(it->second->wrapText(Kyo2D::TextView(Text, Length), MaxWidth, scale, LineEnds, MaxLines));
 }
 
-K2D_API bool K2D_DestroyFont(std::uint32_t FontId)
+K2D_API K2D_GlyphAtlasStats K2D_GetGlyphAtlasStats()
 {
-	auto it = g_Fonts.find(FontId);
-	if (it == g_Fonts.end())
-	{
-		return false;
-	}
-
-	it = g_Fonts.erase(it);
-	return true;
+	const Kyo2D::GlyphAtlas::Stats &stats = g_Context->Glyphs.GetStats();
+
+	K2D_GlyphAtlasStats result;
+	result.Pages = stats.Pages;
+	result.PageSize = Kyo2D::GlyphAtlas::PageSize;
+	result.Glyphs = stats.Glyphs;
+	result.Occupancy = stats.TotalPixels ? static_cast<float>(static_cast<double>(stats.UsedPixels) / static_cast<double>(stats.TotalPixels)) : 0.0f;
+	result.BytesUploaded = stats.BytesUploaded;
+	result.Memory = stats.Memory;
+	result.Budget = g_Context->Glyphs.GetBudget();
+	result.GlyphsEvicted = stats.GlyphsEvicted;
+	result.Compactions = stats.Compactions;
+	return result;
 }
 
-K2D_API bool K2D_DrawText(std::uint32_t FontId, const wchar_t * Text, float X, float Y, std::uint32_t RGBA)
+K2D_API void K2D_SetGlyphAtlasBudget(std::uint64_t Bytes)
 {
-	auto it = g_Fonts.find(FontId);
-	if (it == g_Fonts.end())
-	{
-		return false;
-	}
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::SetGlyphAtlasBudget);
+	capture << Bytes;
 
-	// Draw text
-	it->second->drawText(Text, Kyo2D::Vector2(X, Y), 1.0f);
-
-	return false;
+	g_Context->Glyphs.SetBudget(Bytes);
 }
 
 
@@ -779,38 +2347,43 @@ K2D_API bool K2D_DrawText(std::uint32_t FontId, const wchar_t * Text, float X, f
 
 K2D_API bool K2D_DrawPoint(float X, float Y, std::uint32_t RGBA)
 {
-	PrepareStage(render_stage::Drawer2D);
-	g_DrawHelper->DrawPoint(X, Y, RGBA);
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DrawPoint);
+	capture << X << Y << RGBA;
 
-	return true;
+	Kyo2D::DrawCall call = { Kyo2D::draw_call::Point, 0, X, Y, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, RGBA, 0, false, 0, 0 };
+	return SubmitDrawCall(call);
 }
 
 K2D_API bool K2D_DrawRect(float X, float Y, float Width, float Height, std::uint32_t RGBA)
 {
-	PrepareStage(render_stage::Drawer2D);
-	g_DrawHelper->DrawRect(X, Y, Width, Height, RGBA);
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DrawRect);
+	capture << X << Y << Width << Height << RGBA;
 
-	return true;
+	Kyo2D::DrawCall call = { Kyo2D::draw_call::Rect, 0, X, Y, Width, Height, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, RGBA, 0, false, 0, 0 };
+	return SubmitDrawCall(call);
 }
 
 K2D_API bool K2D_FillRect(float X, float Y, float Width, float Height, std::uint32_t RGBA)
 {
-	PrepareStage(render_stage::Drawer2D);
-	g_DrawHelper->FillRect(X, Y, Width, Height, RGBA);
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::FillRect);
+	capture << X << Y << Width << Height << RGBA;
 
-	return true;
+	Kyo2D::DrawCall call = { Kyo2D::draw_call::FillRect, 0, X, Y, Width, Height, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, RGBA, 0, false, 0, 0 };
+	return SubmitDrawCall(call);
 }
 
 K2D_API bool K2D_DrawLine(float X1, float Y1, float X2, float Y2, std::uint32_t RGBA)
 {
-	PrepareStage(render_stage::Drawer2D);
-	g_DrawHelper->DrawLine(X1, Y1, X2, Y2, RGBA);
+	Kyo2D::CaptureCall capture(Kyo2D::capture_op::DrawLine);
+	capture << X1 << Y1 << X2 << Y2 << RGBA;
 
-	return true;
+	Kyo2D::DrawCall call = { Kyo2D::draw_call::Line, 0, X1, Y1, X2, Y2, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, RGBA, 0, false, 0, 0 };
+	return SubmitDrawCall(call);
 }
 
 
 
+#ifdef _WIN32
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // DLL ENTRY POINT
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -830,9 +2403,7 @@ BOOL WINAPI DllMain(
 			if(!LoadLibrary(L"d3d11.dll"))
 			{
 				g_HasD3D11 = false;
-				g_UseD3D11 = false;
 			}
-			//g_UseD3D11 = false;
 			break;
 		case DLL_PROCESS_DETACH:
 			break;
@@ -844,4 +2415,4 @@ BOOL WINAPI DllMain(
 
 	return TRUE;
 }
-
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+
+namespace Kyo2D
+{
+	/// A row-major 4x4 floating point matrix. It has the same memory layout as DirectX::XMFLOAT4X4,
+	/// so the D3D backends can load it directly, but it doesn't depend on DirectXMath and is used
+	/// to pass view matrices between render targets and drawers on every platform.
+	struct Matrix4
+	{
+		/// Matrix elements, indexed by row and column.
+		float m[4][4];
+
+		/// Returns the identity matrix.
+		static Matrix4 Identity()
+		{
+			Matrix4 result = {};
+			result.m[0][0] = result.m[1][1] = result.m[2][2] = result.m[3][3] = 1.0f;
+			return result;
+		}
+
+		/// Builds a left-handed orthographic projection matrix, equal to XMMatrixOrthographicOffCenterLH.
+		static Matrix4 OrthographicOffCenterLH(float Left, float Right, float Bottom, float Top, float Near, float Far)
+		{
+			float range = 1.0f / (Far - Near);
+			return OrthographicOffCenter(Left, Right, Bottom, Top, range, -range * Near);
+		}
+
+		/// Builds a right-handed orthographic projection matrix, equal to XMMatrixOrthographicOffCenterRH.
+		static Matrix4 OrthographicOffCenterRH(float Left, float Right, float Bottom, float Top, float Near, float Far)
+		{
+			float range = 1.0f / (Near - Far);
+			return OrthographicOffCenter(Left, Right, Bottom, Top, range, range * Near);
+		}
+
+	private:
+
+		static Matrix4 OrthographicOffCenter(float Left, float Right, float Bottom, float Top, float DepthScale, float DepthOffset)
+		{
+			float reciprocalWidth = 1.0f / (Right - Left);
+			float reciprocalHeight = 1.0f / (Top - Bottom);
+
+			Matrix4 result = {};
+			result.m[0][0] = reciprocalWidth + reciprocalWidth;
+			result.m[1][1] = reciprocalHeight + reciprocalHeight;
+			result.m[2][2] = DepthScale;
+			result.m[3][0] = -(Left + Right) * reciprocalWidth;
+			result.m[3][1] = -(Top + Bottom) * reciprocalHeight;
+			result.m[3][2] = DepthOffset;
+			result.m[3][3] = 1.0f;
+			return result;
+		}
+	};
+}
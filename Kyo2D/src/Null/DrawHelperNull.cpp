@@ -0,0 +1,21 @@
+
+#include "DrawHelperNull.h"
+#include "../EngineContext.h"
+
+namespace Kyo2D
+{
+	DrawHelperNull::DrawHelperNull()
+		: DrawHelper()
+	{
+	}
+
+	DrawHelperNull::~DrawHelperNull()
+	{
+	}
+
+	void DrawHelperNull::Dispatch(std::uint32_t vertices)
+	{
+		g_Context->Stats.DrawCalls++;
+		g_Context->Stats.Vertices += vertices;
+	}
+}
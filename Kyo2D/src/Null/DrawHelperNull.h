@@ -0,0 +1,37 @@
+#pragma once
+
+#include "../DrawHelper.h"
+
+namespace Kyo2D
+{
+	/// Draw helper of the null backend. Primitives are only counted.
+	class DrawHelperNull : public DrawHelper
+	{
+	public:
+
+		/// Default constructor.
+		DrawHelperNull();
+		/// Destructor.
+		virtual ~DrawHelperNull();
+
+		/// @copydoc DrawHelper::Initialize()
+		virtual bool Initialize() override { return true; }
+		/// @copydoc DrawHelper::Prepare()
+		virtual void Prepare() override { }
+		/// @copydoc DrawHelper::DrawPoint()
+		virtual void DrawPoint(float /*X*/, float /*Y*/, std::int32_t /*Color*/ = -1) override { Dispatch(1); }
+		/// @copydoc DrawHelper::DrawLine()
+		virtual void DrawLine(float /*X1*/, float /*Y1*/, float /*X2*/, float /*Y2*/, std::int32_t /*Color*/ = -1) override { Dispatch(2); }
+		/// @copydoc DrawHelper::DrawRect()
+		virtual void DrawRect(float /*X*/, float /*Y*/, float /*W*/, float /*H*/, std::int32_t /*Color*/ = -1) override { Dispatch(5); }
+		/// @copydoc DrawHelper::FillRect()
+		virtual void FillRect(float /*X*/, float /*Y*/, float /*W*/, float /*H*/, std::int32_t /*Color*/ = -1) override { Dispatch(4); }
+		/// @copydoc DrawHelper::UpdateViewMatrix()
+		virtual void UpdateViewMatrix(const Matrix4 &/*ViewMatrix*/) override { }
+
+	private:
+
+		/// Counts a primitive like the other backends do.
+		void Dispatch(std::uint32_t vertices);
+	};
+}
@@ -0,0 +1,47 @@
+
+#include "RenderTargetNull.h"
+
+namespace Kyo2D
+{
+	RenderTargetNull::RenderTargetNull()
+		: m_Handle(nullptr)
+		, m_Width(0)
+		, m_Height(0)
+		, m_Fullscreen(false)
+		, m_VSync(false)
+		, m_ViewMatrix(Matrix4::Identity())
+	{
+	}
+
+	RenderTargetNull::~RenderTargetNull()
+	{
+	}
+
+	bool RenderTargetNull::Initialize(HWND hwnd, std::uint16_t width, std::uint16_t height, bool fullscreen)
+	{
+		m_Handle = hwnd;
+		m_Fullscreen = fullscreen;
+		return Resize(width, height);
+	}
+
+	bool RenderTargetNull::InitializeOffscreen(std::uint16_t width, std::uint16_t height)
+	{
+		m_Handle = nullptr;
+		m_Texture = std::make_shared<TextureNull>();
+		return Resize(width, height);
+	}
+
+	bool RenderTargetNull::Resize(std::uint16_t Width, std::uint16_t Height)
+	{
+		if (!Width || !Height)
+		{
+			return false;
+		}
+
+		m_Width = Width;
+		m_Height = Height;
+		m_ViewMatrix = Matrix4::OrthographicOffCenterRH(0.0f, m_Width, m_Height, 0.0f, 0.0f, 1000.0f);
+
+		return !m_Texture || m_Texture->InitializeRenderTarget(m_Width, m_Height);
+	}
+}
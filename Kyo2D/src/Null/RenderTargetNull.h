@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../RenderTarget.h"
+#include "TextureNull.h"
+#include <memory>
+
+namespace Kyo2D
+{
+	/// Render target of the null backend. Nothing is rendered or presented, which allows measuring
+	/// the cost of the engine itself, e.g. when replaying captures.
+	class RenderTargetNull : public RenderTarget
+	{
+	public:
+
+		/// Default constructor.
+		RenderTargetNull();
+		/// Destructor.
+		virtual ~RenderTargetNull();
+
+		/// @copydoc RenderTarget::Initialize(HWND, std::uint16_t, std::uint16_t, bool)
+		virtual bool Initialize(HWND hwnd, std::uint16_t width, std::uint16_t height, bool fullscreen) override;
+		/// @copydoc RenderTarget::InitializeOffscreen(std::uint16_t, std::uint16_t)
+		virtual bool InitializeOffscreen(std::uint16_t width, std::uint16_t height) override;
+		/// @copydoc RenderTarget::Set()
+		virtual void Set() override { }
+		/// @copydoc RenderTarget::Clear(float, float, float)
+		virtual void Clear(float /*R*/, float /*G*/, float /*B*/) override { }
+		/// @copydoc RenderTarget::Present()
+		virtual void Present() override { }
+		/// @copydoc RenderTarget::SetFullscreenState(bool)
+		virtual void SetFullscreenState(bool Fullscreen) override { m_Fullscreen = Fullscreen; }
+		/// @copydoc RenderTarget::SetVSyncEnabled(bool)
+		virtual void SetVSyncEnabled(bool Enable) override { m_VSync = Enable; }
+		/// @copydoc RenderTarget::Resize(std::uint16_t, std::uint16_t)
+		virtual bool Resize(std::uint16_t Width, std::uint16_t Height) override;
+		/// @copydoc RenderTarget::SetScissorRect(const DamageRect *)
+		virtual void SetScissorRect(const DamageRect * /*rect*/) override { }
+		/// @copydoc RenderTarget::ClearRect(const DamageRect &, float, float, float)
+		virtual bool ClearRect(const DamageRect &/*rect*/, float /*R*/, float /*G*/, float /*B*/) override { return true; }
+		/// @copydoc RenderTarget::PresentRects(const DamageRect *, size_t)
+		virtual void PresentRects(const DamageRect * /*rects*/, size_t /*count*/) override { }
+
+		/// Determines if the render target has successfully been initialized.
+		virtual bool IsInitialized() const override { return m_Width != 0 && m_Height != 0; }
+		/// Gets the render targets window handle.
+		virtual HWND GetHandle() const override { return m_Handle; }
+		/// Gets the render targets width in pixels.
+		virtual std::uint16_t GetWidth() const override { return m_Width; }
+		/// Gets the render targets height in pixels.
+		virtual std::uint16_t GetHeight() const override { return m_Height; }
+		/// Determines if the render target is a full screen render target.
+		virtual bool IsFullscreen() const override { return m_Fullscreen; }
+		/// Determines if the vertical sync option is enabled.
+		virtual bool IsVSyncEnabled() const override { return m_VSync; }
+		/// Gets this render targets view matrix.
+		virtual const Matrix4 &GetViewMatrix() const override { return m_ViewMatrix; }
+		/// @copydoc RenderTarget::GetTexture()
+		virtual std::shared_ptr<Texture> GetTexture() const override { return m_Texture; }
+
+	private:
+
+		HWND m_Handle;
+		std::uint16_t m_Width, m_Height;
+		bool m_Fullscreen;
+		bool m_VSync;
+		Matrix4 m_ViewMatrix;
+		std::shared_ptr<TextureNull> m_Texture;
+	};
+}
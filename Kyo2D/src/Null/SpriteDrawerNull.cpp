@@ -0,0 +1,50 @@
+
+#include "SpriteDrawerNull.h"
+#include "../EngineContext.h"
+
+namespace Kyo2D
+{
+	SpriteDrawerNull::SpriteDrawerNull()
+		: SpriteDrawer()
+		, m_Scale2XEnabled(false)
+		, m_PremultipliedAlpha(false)
+		, m_AlphaTexture(false)
+		, m_DistanceField(false)
+	{
+	}
+
+	SpriteDrawerNull::~SpriteDrawerNull()
+	{
+	}
+
+	void SpriteDrawerNull::DrawSpriteAt(std::int32_t /*texW*/, std::int32_t /*texH*/, float /*X*/, float /*Y*/, float /*Z*/, float /*Rotation*/, std::uint32_t /*color*/, std::uint32_t /*colorkey*/)
+	{
+		Dispatch();
+	}
+
+	void SpriteDrawerNull::DrawSubspriteAt(std::int32_t /*texW*/, std::int32_t /*texH*/, float /*X*/, float /*Y*/, float /*Z*/, float /*srcX*/, float /*srcY*/, float /*srcW*/, float /*srcH*/, float /*Rotation*/, std::uint32_t /*color*/, std::uint32_t /*colorkey*/)
+	{
+		Dispatch();
+	}
+
+	void SpriteDrawerNull::DrawSpriteScaled(std::int32_t /*texW*/, std::int32_t /*texH*/, float /*X*/, float /*Y*/, float /*Z*/, float /*W*/, float /*H*/, float /*Rotation*/, std::uint32_t /*color*/, std::uint32_t /*colorkey*/)
+	{
+		Dispatch();
+	}
+
+	void SpriteDrawerNull::DrawSubspriteScaled(std::int32_t /*texW*/, std::int32_t /*texH*/, float /*X*/, float /*Y*/, float /*Z*/, float /*W*/, float /*H*/, float /*srcX*/, float /*srcY*/, float /*srcW*/, float /*srcH*/, float /*Rotation*/, std::uint32_t /*color*/, std::uint32_t /*colorkey*/)
+	{
+		Dispatch();
+	}
+
+	void SpriteDrawerNull::DrawSpriteTiled(std::int32_t /*texW*/, std::int32_t /*texH*/, float /*X*/, float /*Y*/, float /*Z*/, float /*W*/, float /*H*/, float /*tX*/, float /*tY*/, float /*Rotation*/, std::uint32_t /*color*/, std::uint32_t /*colorkey*/)
+	{
+		Dispatch();
+	}
+
+	void SpriteDrawerNull::Dispatch()
+	{
+		g_Context->Stats.DrawCalls++;
+		g_Context->Stats.Vertices += 4;
+	}
+}
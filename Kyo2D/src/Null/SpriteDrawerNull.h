@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../SpriteDrawer.h"
+
+namespace Kyo2D
+{
+	/// Sprite drawer of the null backend. Sprites are only counted.
+	class SpriteDrawerNull : public SpriteDrawer
+	{
+	public:
+
+		/// Default constructor.
+		SpriteDrawerNull();
+		/// Destructor.
+		virtual ~SpriteDrawerNull();
+
+		/// @copydoc SpriteDrawer::Initialize()
+		virtual bool Initialize() override { return true; }
+		/// @copydoc SpriteDrawer::Prepare()
+		virtual bool Prepare() override { return true; }
+		/// @copydoc SpriteDrawer::SetViewMatrix(const Matrix4 &)
+		virtual void SetViewMatrix(const Matrix4 &/*ViewMatrix*/) override { }
+		/// @copydoc SpriteDrawer::SetScale2XEnabled(bool)
+		virtual void SetScale2XEnabled(bool Enable) override { m_Scale2XEnabled = Enable; }
+		/// @copydoc SpriteDrawer::SetPremultipliedAlpha(bool)
+		virtual void SetPremultipliedAlpha(bool Enable) override { m_PremultipliedAlpha = Enable; }
+		/// @copydoc SpriteDrawer::SetAlphaTexture(bool)
+		virtual void SetAlphaTexture(bool Enable) override { m_AlphaTexture = Enable; }
+		/// @copydoc SpriteDrawer::SetDistanceField(bool)
+		virtual void SetDistanceField(bool Enable) override { m_DistanceField = Enable; }
+
+	public:
+
+		/// @copydoc SpriteDrawer::IsScale2XEnabled()
+		virtual bool IsScale2XEnabled() const override { return m_Scale2XEnabled; }
+		/// @copydoc SpriteDrawer::IsPremultipliedAlpha()
+		virtual bool IsPremultipliedAlpha() const override { return m_PremultipliedAlpha; }
+		/// @copydoc SpriteDrawer::IsAlphaTexture()
+		virtual bool IsAlphaTexture() const override { return m_AlphaTexture; }
+		/// @copydoc SpriteDrawer::IsDistanceField()
+		virtual bool IsDistanceField() const override { return m_DistanceField; }
+
+	public:
+
+		/// Draws a simple sprite at a given location.
+		virtual void DrawSpriteAt(std::int32_t texW, std::int32_t texH, float X, float Y, float Z, float Rotation, std::uint32_t color, std::uint32_t colorkey) override;
+		/// Draws a subarea of a sprite at a given location.
+		virtual void DrawSubspriteAt(std::int32_t texW, std::int32_t texH, float X, float Y, float Z, float srcX, float srcY, float srcW, float srcH, float Rotation, std::uint32_t color, std::uint32_t colorkey) override;
+		/// Draws a sprite and stretches it to the given area.
+		virtual void DrawSpriteScaled(std::int32_t texW, std::int32_t texH, float X, float Y, float Z, float W, float H, float Rotation, std::uint32_t color, std::uint32_t colorkey) override;
+		/// Draws a subarea of a sprite and stretches it to the given area.
+		virtual void DrawSubspriteScaled(std::int32_t texW, std::int32_t texH, float X, float Y, float Z, float W, float H, float srcX, float srcY, float srcW, float srcH, float Rotation, std::uint32_t color, std::uint32_t colorkey) override;
+		/// Draws a sprite and tiles it in the given area.
+		virtual void DrawSpriteTiled(std::int32_t texW, std::int32_t texH, float X, float Y, float Z, float W, float H, float tX, float tY, float Rotation, std::uint32_t color, std::uint32_t colorkey) override;
+
+	private:
+
+		/// Counts a sprite like the other backends do.
+		void Dispatch();
+
+	private:
+
+		bool m_Scale2XEnabled;
+		bool m_PremultipliedAlpha;
+		bool m_AlphaTexture;
+		bool m_DistanceField;
+	};
+}
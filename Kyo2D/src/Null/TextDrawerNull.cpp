@@ -0,0 +1,22 @@
+#include "TextDrawerNull.h"
+#include "../EngineContext.h"
+
+namespace Kyo2D
+{
+	TextDrawerNull::TextDrawerNull()
+		: TextDrawer()
+		, m_AlphaTexture(false)
+		, m_DistanceField(false)
+	{
+	}
+
+	TextDrawerNull::~TextDrawerNull()
+	{
+	}
+
+	void TextDrawerNull::DrawGlyphs(std::int32_t /*texW*/, std::int32_t /*texH*/, const GlyphQuad * /*quads*/, size_t count, std::uint32_t /*color*/, std::uint32_t /*colorkey*/)
+	{
+		g_Context->Stats.DrawCalls++;
+		g_Context->Stats.Vertices += static_cast<std::uint32_t>(count * 4);
+	}
+}
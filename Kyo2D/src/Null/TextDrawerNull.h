@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../TextDrawer.h"
+
+namespace Kyo2D
+{
+	/// Text drawer of the null backend. Glyph runs are only counted.
+	class TextDrawerNull : public TextDrawer
+	{
+	public:
+
+		/// Default constructor.
+		TextDrawerNull();
+		/// Destructor.
+		virtual ~TextDrawerNull();
+
+		/// @copydoc TextDrawer::Initialize()
+		virtual bool Initialize() override { return true; }
+		/// @copydoc TextDrawer::Prepare()
+		virtual bool Prepare() override { return true; }
+		/// @copydoc TextDrawer::SetViewMatrix(const Matrix4 &)
+		virtual void SetViewMatrix(const Matrix4 &/*ViewMatrix*/) override { }
+		/// @copydoc TextDrawer::SetAlphaTexture(bool)
+		virtual void SetAlphaTexture(bool Enable) override { m_AlphaTexture = Enable; }
+		/// @copydoc TextDrawer::SetDistanceField(bool)
+		virtual void SetDistanceField(bool Enable) override { m_DistanceField = Enable; }
+
+	public:
+
+		/// @copydoc TextDrawer::DrawGlyphs()
+		virtual void DrawGlyphs(std::int32_t texW, std::int32_t texH, const GlyphQuad *quads, size_t count, std::uint32_t color, std::uint32_t colorkey) override;
+
+	public:
+
+		/// @copydoc TextDrawer::IsAlphaTexture()
+		virtual bool IsAlphaTexture() const override { return m_AlphaTexture; }
+		/// @copydoc TextDrawer::IsDistanceField()
+		virtual bool IsDistanceField() const override { return m_DistanceField; }
+
+	private:
+
+		bool m_AlphaTexture;
+		bool m_DistanceField;
+	};
+}
@@ -0,0 +1,120 @@
+
+#include "TextureNull.h"
+#include "../File.h"
+
+namespace Kyo2D
+{
+	TextureNull::TextureNull()
+		: m_Width(0)
+		, m_Height(0)
+		, m_Resident(false)
+	{
+	}
+
+	TextureNull::~TextureNull()
+	{
+	}
+
+#ifndef K2D_NO_IMAGE_LOADER
+	bool TextureNull::Initialize(const void * data, size_t dataSize)
+	{
+		// Load image from memory
+		ILuint idImage;
+		ilGenImages(1, &idImage);
+		ilBindImage(idImage);
+		ilLoadL(IL_TYPE_UNKNOWN, data, static_cast<ILuint>(dataSize));
+		if (ilGetError() != IL_NO_ERROR)
+		{
+			return false;
+		}
+
+		return InitializeImpl(idImage);
+	}
+
+	bool TextureNull::Initialize(const std::wstring &filename)
+	{
+		// Load image from file
+		ILuint idImage;
+		ilGenImages(1, &idImage);
+		ilBindImage(idImage);
+#ifdef _WIN32
+		ilLoadImage(filename.c_str());
+#else
+		ilLoadImage(narrowFilename(filename).c_str());
+#endif
+		if (ilGetError() != IL_NO_ERROR)
+		{
+			return false;
+		}
+
+		return InitializeImpl(idImage);
+	}
+#else
+	bool TextureNull::Initialize(const void *, size_t)
+	{
+		// Built without DevIL, textures can only be created from pixels
+		return false;
+	}
+
+	bool TextureNull::Initialize(const std::wstring &)
+	{
+		return false;
+	}
+#endif
+
+	bool TextureNull::InitializeRenderTarget(std::int32_t width, std::int32_t height)
+	{
+		m_Width = width;
+		m_Height = height;
+		m_Resident = true;
+		return true;
+	}
+
+	bool TextureNull::InitializePixels(std::int32_t width, std::int32_t height, const std::uint32_t * /*pixels*/)
+	{
+		SetAlphaOnly(false);
+		return InitializeRenderTarget(width, height);
+	}
+
+	bool TextureNull::UpdateRegion(std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const std::uint32_t *pixels)
+	{
+		return m_Resident && pixels && !IsAlphaOnly() && IsValidRegion(x, y, width, height);
+	}
+
+	bool TextureNull::InitializeAlpha(std::int32_t width, std::int32_t height, const std::uint8_t * /*alpha*/)
+	{
+		SetAlphaOnly(true);
+		return InitializeRenderTarget(width, height);
+	}
+
+	bool TextureNull::UpdateAlphaRegion(std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const std::uint8_t *alpha)
+	{
+		return m_Resident && alpha && IsAlphaOnly() && IsValidRegion(x, y, width, height);
+	}
+
+	bool TextureNull::Set()
+	{
+		return m_Resident;
+	}
+
+	void TextureNull::ReleaseResources()
+	{
+		m_Resident = false;
+	}
+
+#ifndef K2D_NO_IMAGE_LOADER
+	bool TextureNull::InitializeImpl(ILuint &idImage)
+	{
+		// Save image informations
+		m_Width = ilGetInteger(IL_IMAGE_WIDTH);
+		m_Height = ilGetInteger(IL_IMAGE_HEIGHT);
+		m_Resident = true;
+
+		// Memory cleanup
+		ilDeleteImages(1, &idImage);
+		idImage = 0;
+
+		return true;
+	}
+#endif
+}
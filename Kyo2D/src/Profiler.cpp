@@ -0,0 +1,183 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <map>
+#include <cstdio>
+
+namespace
+{
+	/// Number of zones listed for a slow frame.
+	const size_t SlowFrameZones = 3;
+
+	/// Gets a small id for the calling thread.
+	std::uint32_t GetThreadId()
+	{
+		return static_cast<std::uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+	}
+
+	/// Appends a string with json escaping.
+	void AppendJsonString(std::string &out, const char *text)
+	{
+		out += '"';
+		for (; *text; ++text)
+		{
+			if (*text == '"' || *text == '\\')
+				out += '\\';
+			out += *text;
+		}
+		out += '"';
+	}
+}
+
+namespace Kyo2D
+{
+	Profiler::Profiler()
+		: m_Origin(std::chrono::steady_clock::now())
+		, m_History(0)
+		, m_SlowThreshold(0)
+		, m_LastFrameSlow(false)
+	{
+		m_Current.Start = 0;
+		m_Current.End = 0;
+		m_Current.Slow = false;
+	}
+
+	Profiler::~Profiler()
+	{
+	}
+
+	void Profiler::SetHistory(std::uint32_t frames)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_History = frames;
+		while (m_Frames.size() > frames)
+			m_Frames.pop_front();
+
+		if (!frames)
+			m_Current.Zones.clear();
+	}
+
+	void Profiler::SetSlowFrameThreshold(float milliseconds)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_SlowThreshold = static_cast<std::uint64_t>(std::max<float>(0.0f, milliseconds) * 1000.0f);
+	}
+
+	std::uint64_t Profiler::Now() const
+	{
+		return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_Origin).count());
+	}
+
+	void Profiler::Record(const char *name, std::uint64_t start, std::uint64_t end)
+	{
+		Zone zone;
+		zone.Name = name;
+		zone.Start = start;
+		zone.Duration = end - start;
+		zone.Thread = GetThreadId();
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (m_History)
+			m_Current.Zones.push_back(zone);
+	}
+
+	float Profiler::EndFrame()
+	{
+		std::uint64_t now = Now();
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Current.End = now;
+		std::uint64_t duration = m_Current.End - m_Current.Start;
+		m_Current.Slow = m_SlowThreshold && duration > m_SlowThreshold;
+		m_LastFrameSlow = m_Current.Slow;
+
+		if (m_History)
+		{
+			m_Frames.push_back(std::move(m_Current));
+			while (m_Frames.size() > m_History)
+				m_Frames.pop_front();
+		}
+
+		m_Current = Frame();
+		m_Current.Start = now;
+		m_Current.End = now;
+		m_Current.Slow = false;
+
+		return duration / 1000.0f;
+	}
+
+	std::string Profiler::GetTrace(std::uint32_t processId) const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		std::string out = "{\"traceEvents\":[";
+		bool first = true;
+		char buffer[160];
+
+		for (auto &frame : m_Frames)
+		{
+			// The frame itself is shown as zone on a separate track
+			std::snprintf(buffer, sizeof(buffer), "%s{\"name\":\"Frame\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":%u,\"tid\":0}",
+				first ? "" : ",",
+				static_cast<unsigned long long>(frame.Start),
+				static_cast<unsigned long long>(frame.End - frame.Start),
+				processId);
+			out += buffer;
+			first = false;
+
+			for (auto &zone : frame.Zones)
+			{
+				out += ",{\"name\":";
+				AppendJsonString(out, zone.Name);
+				std::snprintf(buffer, sizeof(buffer), ",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":%u,\"tid\":%u}",
+					static_cast<unsigned long long>(zone.Start),
+					static_cast<unsigned long long>(zone.Duration),
+					processId,
+					zone.Thread);
+				out += buffer;
+			}
+
+			// Mark slow frames with the zones responsible
+			if (frame.Slow)
+			{
+				std::snprintf(buffer, sizeof(buffer), ",{\"name\":\"Slow frame\",\"ph\":\"i\",\"s\":\"p\",\"ts\":%llu,\"pid\":%u,\"tid\":0,\"args\":{\"ms\":%.3f,\"zones\":",
+					static_cast<unsigned long long>(frame.End),
+					processId,
+					(frame.End - frame.Start) / 1000.0);
+				out += buffer;
+				AppendJsonString(out, DescribeSlowFrame(frame).c_str());
+				out += "}}";
+			}
+		}
+
+		out += "],\"displayTimeUnit\":\"ms\"}";
+		return out;
+	}
+
+	std::string Profiler::DescribeSlowFrame(const Frame &frame)
+	{
+		// Sum the time of each zone over the frame
+		std::map<std::string, std::uint64_t> totals;
+		for (auto &zone : frame.Zones)
+			totals[zone.Name] += zone.Duration;
+
+		std::vector<std::pair<std::string, std::uint64_t>> sorted(totals.begin(), totals.end());
+		std::sort(sorted.begin(), sorted.end(), [](const std::pair<std::string, std::uint64_t> &a, const std::pair<std::string, std::uint64_t> &b)
+		{
+			return a.second > b.second;
+		});
+
+		std::string description;
+		char buffer[32];
+		for (size_t i = 0; i < sorted.size() && i < SlowFrameZones; ++i)
+		{
+			if (i)
+				description += ", ";
+			std::snprintf(buffer, sizeof(buffer), " %.3f ms", sorted[i].second / 1000.0);
+			description += sorted[i].first + buffer;
+		}
+
+		return description;
+	}
+}
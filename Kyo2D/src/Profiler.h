@@ -0,0 +1,149 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <mutex>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+
+namespace Kyo2D
+{
+	/// Work counters of a single frame. The counters are increased by the api layer and the
+	/// backends while a frame is built and reset when a window render target is presented.
+	struct FrameStats
+	{
+		/// Number of draw calls issued to the backend.
+		std::uint32_t DrawCalls;
+		/// Number of vertices submitted with the draw calls.
+		std::uint32_t Vertices;
+		/// Number of vertex buffer maps (locks with D3D9).
+		std::uint32_t BufferMaps;
+		/// Number of texture binds.
+		std::uint32_t TextureBinds;
+		/// Number of render stage switches done by PrepareStage.
+		std::uint32_t StageChanges;
+		/// Number of glyphs rasterized by fonts.
+		std::uint32_t GlyphsRasterized;
+		/// Number of glyph quads drawn by the text drawer.
+		std::uint32_t GlyphsDrawn;
+		/// Number of textures created.
+		std::uint32_t TexturesCreated;
+		/// Number of pixel bytes uploaded to textures.
+		std::uint64_t BytesUploaded;
+	};
+
+	/// Records timed zones of the last frames and exports them in the Chrome trace event format
+	/// (chrome://tracing). Recording is disabled until a frame history is set, so the zones only
+	/// cost a branch by default. Frames taking longer than a threshold are marked in the trace
+	/// together with the zones which took the most time.
+	/// The zones are placed with K2D_PROFILE_SCOPE, which is removed completely if
+	/// KYO2D_DISABLE_PROFILER is defined.
+	class Profiler
+	{
+	public:
+
+		/// A timed zone. Times are in microseconds since the profiler has been created.
+		struct Zone
+		{
+			const char *Name;
+			std::uint64_t Start;
+			std::uint64_t Duration;
+			std::uint32_t Thread;
+		};
+
+	public:
+
+		/// Default constructor. Recording is disabled.
+		Profiler();
+		/// Destructor.
+		~Profiler();
+
+		/// Sets the number of frames to keep. 0 disables recording and drops the recorded frames.
+		void SetHistory(std::uint32_t frames);
+		/// Sets the frame time in milliseconds above which a frame is marked as slow. 0 disables the check.
+		void SetSlowFrameThreshold(float milliseconds);
+		/// Determines if zones are recorded.
+		inline bool IsEnabled() const { return m_History != 0; }
+		/// Gets the current time in microseconds since the profiler has been created.
+		std::uint64_t Now() const;
+		/// Records a zone of the current frame. Can be called from any thread.
+		/// @param name Name of the zone. Has to be a string literal.
+		/// @param start Start time as returned by Now().
+		/// @param end End time as returned by Now().
+		void Record(const char *name, std::uint64_t start, std::uint64_t end);
+		/// Finishes the current frame and starts the next one. The frame time is measured even
+		/// if recording is disabled.
+		/// @returns The duration of the finished frame in milliseconds.
+		float EndFrame();
+		/// Determines if the last finished frame exceeded the slow frame threshold.
+		inline bool WasLastFrameSlow() const { return m_LastFrameSlow; }
+		/// Writes the recorded frames as Chrome trace json.
+		/// @param processId Process id used for the events, allows merging traces of several contexts.
+		std::string GetTrace(std::uint32_t processId) const;
+
+	private:
+
+		/// The recorded zones of a frame.
+		struct Frame
+		{
+			std::uint64_t Start;
+			std::uint64_t End;
+			std::vector<Zone> Zones;
+			bool Slow;
+		};
+
+		/// Builds a description of the zones that took the most time in a frame.
+		static std::string DescribeSlowFrame(const Frame &frame);
+
+	private:
+
+		std::chrono::steady_clock::time_point m_Origin;
+		mutable std::mutex m_Mutex;
+		std::atomic<std::uint32_t> m_History;
+		std::uint64_t m_SlowThreshold;
+		Frame m_Current;
+		std::deque<Frame> m_Frames;
+		bool m_LastFrameSlow;
+	};
+
+	/// Records the lifetime of a scope as a zone. Use K2D_PROFILE_SCOPE instead of using this directly.
+	class ProfileScope
+	{
+	public:
+
+		ProfileScope(Profiler &profiler, const char *name)
+			: m_Profiler(profiler.IsEnabled() ? &profiler : nullptr)
+			, m_Name(name)
+			, m_Start(m_Profiler ? m_Profiler->Now() : 0)
+		{
+		}
+
+		~ProfileScope()
+		{
+			if (m_Profiler)
+				m_Profiler->Record(m_Name, m_Start, m_Profiler->Now());
+		}
+
+		ProfileScope(const ProfileScope&) = delete;
+		ProfileScope& operator=(const ProfileScope&) = delete;
+
+	private:
+
+		Profiler *m_Profiler;
+		const char *m_Name;
+		std::uint64_t m_Start;
+	};
+}
+
+#define K2D_PROFILE_CONCAT_INNER(a, b) a##b
+#define K2D_PROFILE_CONCAT(a, b) K2D_PROFILE_CONCAT_INNER(a, b)
+
+/// Records the enclosing scope as zone of the given profiler.
+#ifndef KYO2D_DISABLE_PROFILER
+#	define K2D_PROFILE_SCOPE(profiler, name) Kyo2D::ProfileScope K2D_PROFILE_CONCAT(profileScope, __LINE__)(profiler, name)
+#else
+	// The profiler isn't evaluated, naming it keeps variables only holding it from being unused
+#	define K2D_PROFILE_SCOPE(profiler, name) static_cast<void>(sizeof(profiler))
+#endif
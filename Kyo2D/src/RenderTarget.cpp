@@ -4,10 +4,16 @@
 namespace Kyo2D
 {
 	RenderTarget::RenderTarget()
+		: m_Dirty(true)
 	{
 	}
 
 	RenderTarget::~RenderTarget()
 	{
 	}
+
+	bool RenderTarget::ReadPixels(std::uint32_t * /*buffer*/, size_t /*count*/)
+	{
+		return false;
+	}
 }
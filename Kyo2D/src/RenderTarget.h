@@ -1,10 +1,11 @@
 
 #pragma once
 
-#include <Windows.h>
-#include <DirectXMath.h>
 #include <memory>
-using namespace DirectX;
+#include "Kyo2D.h"
+#include "Texture.h"
+#include "DamageTracker.h"
+#include "Matrix.h"
 
 namespace Kyo2D
 {
@@ -20,6 +21,8 @@ namespace Kyo2D
 
 		/// Initializes the render target if it hasn't been initialized already.
 		virtual bool Initialize(HWND hwnd, std::uint16_t width, std::uint16_t height, bool fullscreen) = 0;
+		/// Initializes the render target as an offscreen target which renders into a texture.
+		virtual bool InitializeOffscreen(std::uint16_t width, std::uint16_t height) = 0;
 		/// Sets this render target as the active render target.
 		virtual void Set() = 0;
 		/// Clears the render target using the given rgb color.
@@ -32,6 +35,18 @@ namespace Kyo2D
 		virtual void SetVSyncEnabled(bool Enable) = 0;
 		/// Resizes the render target to match the given size.
 		virtual bool Resize(std::uint16_t Width, std::uint16_t Height) = 0;
+		/// Restricts rendering to the given rectangle, or to the whole target if rect is nullptr.
+		virtual void SetScissorRect(const DamageRect *rect) = 0;
+		/// Clears a part of the render target using the given rgb color.
+		/// @returns false if the backend can't clear single rectangles.
+		virtual bool ClearRect(const DamageRect &rect, float R, float G, float B) = 0;
+		/// Presents only the given rectangles of the back buffer, if the backend supports it.
+		/// Otherwise the whole back buffer is presented.
+		virtual void PresentRects(const DamageRect *rects, size_t count) = 0;
+		/// Copies the contents of the render target into buffer as 0xAABBGGRR pixels, row by row.
+		/// @param count Size of buffer in pixels.
+		/// @returns false if the buffer is too small or the backend can't read back render targets.
+		virtual bool ReadPixels(std::uint32_t *buffer, size_t count);
 
 		/// Determines if the render target has successfully been initialized.
 		virtual bool IsInitialized() const = 0;
@@ -46,6 +61,20 @@ namespace Kyo2D
 		/// Determines if the vertical sync option is enabled.
 		virtual bool IsVSyncEnabled() const = 0;
 		/// Gets this render targets view matrix.
-		virtual const XMMATRIX &GetViewMatrix() const = 0;
+		virtual const Matrix4 &GetViewMatrix() const = 0;
+		/// Gets the texture an offscreen render target renders into, or nullptr for window targets.
+		virtual std::shared_ptr<Texture> GetTexture() const = 0;
+
+		/// Determines if this is an offscreen render target.
+		inline bool IsOffscreen() const { return GetTexture() != nullptr; }
+		/// Determines if the contents of this render target need to be redrawn.
+		/// Offscreen targets start dirty and are marked clean when presented.
+		inline bool IsDirty() const { return m_Dirty; }
+		/// Marks the contents of this render target as outdated or up to date.
+		inline void SetDirty(bool dirty) { m_Dirty = dirty; }
+
+	private:
+
+		bool m_Dirty;
 	};
 }
@@ -0,0 +1,76 @@
+
+#include "DrawHelperSoftware.h"
+#include "../EngineContext.h"
+#include "RenderTargetSoftware.h"
+
+namespace Kyo2D
+{
+	DrawHelperSoftware::DrawHelperSoftware()
+		: DrawHelper()
+	{
+	}
+
+	DrawHelperSoftware::~DrawHelperSoftware()
+	{
+	}
+
+	bool DrawHelperSoftware::Initialize()
+	{
+		return true;
+	}
+
+	void DrawHelperSoftware::Prepare()
+	{
+	}
+
+	void DrawHelperSoftware::DrawPoint(float X, float Y, std::int32_t Color)
+	{
+		if (!g_Context->Software.ActiveTarget)
+			return;
+
+		g_Context->Software.ActiveTarget->GetRasterizer().DrawPoint(X, Y, static_cast<std::uint32_t>(Color));
+		g_Context->Stats.DrawCalls++;
+		g_Context->Stats.Vertices += 1;
+	}
+
+	void DrawHelperSoftware::DrawLine(float X1, float Y1, float X2, float Y2, std::int32_t Color)
+	{
+		if (!g_Context->Software.ActiveTarget)
+			return;
+
+		g_Context->Software.ActiveTarget->GetRasterizer().DrawLine(X1, Y1, X2, Y2, static_cast<std::uint32_t>(Color));
+		g_Context->Stats.DrawCalls++;
+		g_Context->Stats.Vertices += 2;
+	}
+
+	void DrawHelperSoftware::DrawRect(float X, float Y, float W, float H, std::int32_t Color)
+	{
+		if (!g_Context->Software.ActiveTarget)
+			return;
+
+		// Same line strip as the other backends
+		SoftwareRasterizer &rasterizer = g_Context->Software.ActiveTarget->GetRasterizer();
+		std::uint32_t color = static_cast<std::uint32_t>(Color);
+		rasterizer.DrawLine(X + 1, Y + H, X + 1, Y + 1, color);
+		rasterizer.DrawLine(X + 1, Y + 1, X + W, Y + 1, color);
+		rasterizer.DrawLine(X + W, Y + 1, X + W, Y + H, color);
+		rasterizer.DrawLine(X + W, Y + H, X + 1, Y + H, color);
+		g_Context->Stats.DrawCalls++;
+		g_Context->Stats.Vertices += 5;
+	}
+
+	void DrawHelperSoftware::FillRect(float X, float Y, float W, float H, std::int32_t Color)
+	{
+		if (!g_Context->Software.ActiveTarget)
+			return;
+
+		g_Context->Software.ActiveTarget->GetRasterizer().FillRect(X, Y, W, H, static_cast<std::uint32_t>(Color));
+		g_Context->Stats.DrawCalls++;
+		g_Context->Stats.Vertices += 4;
+	}
+
+	void DrawHelperSoftware::UpdateViewMatrix(const Matrix4 &/*ViewMatrix*/)
+	{
+		// The software rasterizer works in pixel coordinates directly
+	}
+}
@@ -0,0 +1,34 @@
+
+#pragma once
+
+#include "../DrawHelper.h"
+#include "SoftwareDevice.h"
+
+namespace Kyo2D
+{
+	/// Software implementation of the draw helper.
+	class DrawHelperSoftware : public DrawHelper
+	{
+	public:
+
+		/// Default constructor.
+		DrawHelperSoftware();
+		/// Destructor.
+		virtual ~DrawHelperSoftware();
+
+		/// @copydoc DrawHelper::Initialize()
+		virtual bool Initialize() override;
+		/// @copydoc DrawHelper::Prepare()
+		virtual void Prepare() override;
+		/// @copydoc DrawHelper::DrawPoint()
+		virtual void DrawPoint(float X, float Y, std::int32_t Color = -1) override;
+		/// @copydoc DrawHelper::DrawLine()
+		virtual void DrawLine(float X1, float Y1, float X2, float Y2, std::int32_t Color = -1) override;
+		/// @copydoc DrawHelper::DrawRect()
+		virtual void DrawRect(float X, float Y, float W, float H, std::int32_t Color = -1) override;
+		/// @copydoc DrawHelper::FillRect()
+		virtual void FillRect(float X, float Y, float W, float H, std::int32_t Color = -1) override;
+		/// @copydoc DrawHelper::UpdateViewMatrix()
+		virtual void UpdateViewMatrix(const Matrix4 &ViewMatrix) override;
+	};
+}
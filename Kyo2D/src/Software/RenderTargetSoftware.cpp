@@ -0,0 +1,263 @@
+
+#include "RenderTargetSoftware.h"
+#include "../EngineContext.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	/// Converts a clear color to a software pixel.
+	std::uint32_t ToPixel(float R, float G, float B)
+	{
+		auto channel = [](float value) -> std::uint32_t
+		{
+			return static_cast<std::uint32_t>(std::max<float>(0.0f, std::min<float>(1.0f, value)) * 255.0f + 0.5f);
+		};
+
+		return channel(R) | (channel(G) << 8) | (channel(B) << 16) | 0xFF000000;
+	}
+}
+
+namespace Kyo2D
+{
+	RenderTargetSoftware::RenderTargetSoftware()
+		: m_Handle(nullptr)
+		, m_Width(0)
+		, m_Height(0)
+		, m_Fullscreen(false)
+		, m_VSync(false)
+	{
+	}
+
+	RenderTargetSoftware::~RenderTargetSoftware()
+	{
+		if (g_Context->Software.ActiveTarget == this)
+		{
+			g_Context->Software.ActiveTarget = nullptr;
+		}
+	}
+
+	bool RenderTargetSoftware::Initialize(HWND hwnd, std::uint16_t width, std::uint16_t height, bool fullscreen)
+	{
+		m_Handle = hwnd;
+		m_Width = width;
+		m_Height = height;
+		m_Fullscreen = fullscreen;
+
+		// Without a window handle, the target is rendered headless and can only be read back
+#ifdef _WIN32
+		if (hwnd && !IsWindow(hwnd))
+		{
+			MessageBox(hwnd, L"Invalid window handle provided for render target creation!", L"Error", MB_ICONERROR | MB_OK);
+			return false;
+		}
+#else
+		// Presenting is only implemented using GDI, other platforms can only render headless
+		if (hwnd)
+		{
+			return false;
+		}
+#endif
+
+		return CreateImage();
+	}
+
+	bool RenderTargetSoftware::InitializeOffscreen(std::uint16_t width, std::uint16_t height)
+	{
+		m_Handle = nullptr;
+		m_Width = width;
+		m_Height = height;
+		m_Fullscreen = false;
+
+		m_Texture = std::make_shared<TextureSoftware>();
+		return CreateImage();
+	}
+
+	void RenderTargetSoftware::Set()
+	{
+		if (!m_Image)
+		{
+			return;
+		}
+
+		// Commands of the previous target have to be executed before anything drawn here
+		// can use them as texture
+		if (g_Context->Software.ActiveTarget && g_Context->Software.ActiveTarget != this)
+		{
+			g_Context->Software.ActiveTarget->Flush();
+		}
+
+		g_Context->Software.ActiveTarget = this;
+
+		// Our own image might still be bound from drawing it
+		if (g_Context->Software.Texture == m_Image)
+		{
+			g_Context->Software.Texture.reset();
+		}
+
+		m_Rasterizer.ResetScissor();
+	}
+
+	void RenderTargetSoftware::Clear(float R, float G, float B)
+	{
+		m_Rasterizer.Clear(ToPixel(R, G, B));
+	}
+
+	void RenderTargetSoftware::Present()
+	{
+		Flush();
+
+		if (m_Image && m_Handle)
+		{
+			Blit(0, 0, m_Width, m_Height);
+		}
+	}
+
+	void RenderTargetSoftware::SetFullscreenState(bool Fullscreen)
+	{
+		// GDI has no exclusive mode, the window itself has to cover the screen
+		m_Fullscreen = Fullscreen;
+	}
+
+	void RenderTargetSoftware::SetVSyncEnabled(bool Enable)
+	{
+		// GDI presents are not synchronized, the option is only stored
+		m_VSync = Enable;
+	}
+
+	bool RenderTargetSoftware::Resize(std::uint16_t Width, std::uint16_t Height)
+	{
+		if (!m_Image)
+		{
+			return false;
+		}
+
+		if (m_Width == Width && m_Height == Height)
+		{
+			return true;
+		}
+
+		// Like a swap chain resize, the contents are lost
+		m_Width = Width;
+		m_Height = Height;
+		return CreateImage();
+	}
+
+	void RenderTargetSoftware::SetScissorRect(const DamageRect *rect)
+	{
+		if (rect)
+			m_Rasterizer.SetScissor(rect->Left, rect->Top, rect->Right, rect->Bottom);
+		else
+			m_Rasterizer.ResetScissor();
+	}
+
+	bool RenderTargetSoftware::ClearRect(const DamageRect &rect, float R, float G, float B)
+	{
+		m_Rasterizer.ClearRect(rect.Left, rect.Top, rect.Right, rect.Bottom, ToPixel(R, G, B));
+		return true;
+	}
+
+	void RenderTargetSoftware::PresentRects(const DamageRect *rects, size_t count)
+	{
+		Flush();
+
+		if (!m_Image || !m_Handle)
+		{
+			return;
+		}
+
+		// Only the damaged parts have to be copied to the window
+		for (size_t i = 0; i < count; ++i)
+		{
+			Blit(
+				std::max<std::int32_t>(rects[i].Left, 0),
+				std::max<std::int32_t>(rects[i].Top, 0),
+				std::min<std::int32_t>(rects[i].Right, m_Width),
+				std::min<std::int32_t>(rects[i].Bottom, m_Height));
+		}
+	}
+
+	bool RenderTargetSoftware::ReadPixels(std::uint32_t *buffer, size_t count)
+	{
+		if (!m_Image || !buffer || count < m_Image->Pixels.size())
+		{
+			return false;
+		}
+
+		Flush();
+		std::memcpy(buffer, m_Image->Pixels.data(), m_Image->Pixels.size() * sizeof(std::uint32_t));
+		return true;
+	}
+
+	void RenderTargetSoftware::Flush()
+	{
+		m_Rasterizer.Flush(g_Context->Software.Workers);
+	}
+
+	bool RenderTargetSoftware::CreateImage()
+	{
+		if (m_Texture)
+		{
+			// Offscreen targets render directly into the pixels of their texture
+			if (!m_Texture->InitializeRenderTarget(m_Width, m_Height))
+				return false;
+
+			m_Image = m_Texture->GetImage();
+		}
+		else
+		{
+			m_Image = std::make_shared<SoftwareImage>();
+			m_Image->Width = m_Width;
+			m_Image->Height = m_Height;
+			m_Image->Pixels.assign(static_cast<size_t>(m_Width) * static_cast<size_t>(m_Height), 0xFF000000);
+		}
+
+		m_Rasterizer.SetTarget(m_Image);
+
+		// The software rasterizer works in pixels, the matrix is only kept for the interface
+		m_ViewMatrix = Matrix4::OrthographicOffCenterRH(0.0f, m_Width, m_Height, 0.0f, 0.0f, 1000.0f);
+
+		return true;
+	}
+
+	void RenderTargetSoftware::Blit(std::int32_t /*left*/, std::int32_t /*top*/, std::int32_t /*right*/, std::int32_t /*bottom*/)
+	{
+#ifdef _WIN32
+		std::int32_t width = right - left;
+		std::int32_t height = bottom - top;
+		if (width <= 0 || height <= 0)
+		{
+			return;
+		}
+
+		// GDI expects BGRA pixels
+		m_BlitBuffer.resize(static_cast<size_t>(width) * static_cast<size_t>(height));
+		for (std::int32_t y = 0; y < height; ++y)
+		{
+			const std::uint32_t *src = &m_Image->Pixels[(top + y) * m_Image->Width + left];
+			std::uint32_t *dst = &m_BlitBuffer[y * width];
+			for (std::int32_t x = 0; x < width; ++x)
+			{
+				std::uint32_t pixel = src[x];
+				dst[x] = (pixel & 0xFF00FF00) | ((pixel & 0x000000FF) << 16) | ((pixel & 0x00FF0000) >> 16);
+			}
+		}
+
+		BITMAPINFO bmi;
+		ZeroMemory(&bmi, sizeof(bmi));
+		bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+		bmi.bmiHeader.biWidth = width;
+		bmi.bmiHeader.biHeight = -height;	// top-down
+		bmi.bmiHeader.biPlanes = 1;
+		bmi.bmiHeader.biBitCount = 32;
+		bmi.bmiHeader.biCompression = BI_RGB;
+
+		HDC hdc = GetDC(m_Handle);
+		if (hdc)
+		{
+			SetDIBitsToDevice(hdc, left, top, width, height, 0, 0, 0, height, m_BlitBuffer.data(), &bmi, DIB_RGB_COLORS);
+			ReleaseDC(m_Handle, hdc);
+		}
+#endif
+	}
+}
@@ -0,0 +1,91 @@
+
+#pragma once
+
+#include "../RenderTarget.h"
+#include "TextureSoftware.h"
+#include "SoftwareDevice.h"
+#include <memory>
+#include <vector>
+
+namespace Kyo2D
+{
+	/// Software implementation of a render target. Window targets are presented using GDI,
+	/// a render target without a window can be used for headless rendering.
+	class RenderTargetSoftware : public RenderTarget
+	{
+	public:
+
+		/// Default constructor.
+		RenderTargetSoftware();
+		/// Destructor.
+		virtual ~RenderTargetSoftware();
+
+		/// @copydoc RenderTarget::Initialize(HWND, std::uint16_t, std::uint16_t, bool)
+		virtual bool Initialize(HWND hwnd, std::uint16_t width, std::uint16_t height, bool fullscreen) override;
+		/// @copydoc RenderTarget::InitializeOffscreen(std::uint16_t, std::uint16_t)
+		virtual bool InitializeOffscreen(std::uint16_t width, std::uint16_t height) override;
+		/// @copydoc RenderTarget::Set()
+		virtual void Set() override;
+		/// @copydoc RenderTarget::Clear(float, float, float)
+		virtual void Clear(float R, float G, float B) override;
+		/// @copydoc RenderTarget::Present()
+		virtual void Present() override;
+		/// @copydoc RenderTarget::SetFullscreenState(bool)
+		virtual void SetFullscreenState(bool Fullscreen) override;
+		/// @copydoc RenderTarget::SetVSyncEnabled(bool)
+		virtual void SetVSyncEnabled(bool Enable) override;
+		/// @copydoc RenderTarget::Resize(std::uint16_t, std::uint16_t)
+		virtual bool Resize(std::uint16_t Width, std::uint16_t Height) override;
+		/// @copydoc RenderTarget::SetScissorRect(const DamageRect *)
+		virtual void SetScissorRect(const DamageRect *rect) override;
+		/// @copydoc RenderTarget::ClearRect(const DamageRect &, float, float, float)
+		virtual bool ClearRect(const DamageRect &rect, float R, float G, float B) override;
+		/// @copydoc RenderTarget::PresentRects(const DamageRect *, size_t)
+		virtual void PresentRects(const DamageRect *rects, size_t count) override;
+		/// @copydoc RenderTarget::ReadPixels(std::uint32_t *, size_t)
+		virtual bool ReadPixels(std::uint32_t *buffer, size_t count) override;
+
+		/// Determines if the render target has successfully been initialized.
+		virtual bool IsInitialized() const override { return m_Image != nullptr; }
+		/// Gets the render targets window handle.
+		virtual HWND GetHandle() const override { return m_Handle; }
+		/// Gets the render targets width in pixels.
+		virtual std::uint16_t GetWidth() const override { return m_Width; }
+		/// Gets the render targets height in pixels.
+		virtual std::uint16_t GetHeight() const override { return m_Height; }
+		/// Determines if the render target is a full screen render target.
+		virtual bool IsFullscreen() const override { return m_Fullscreen; }
+		/// Determines if the vertical sync option is enabled.
+		virtual bool IsVSyncEnabled() const override { return m_VSync; }
+		/// Gets this render targets view matrix.
+		virtual const Matrix4 &GetViewMatrix() const override { return m_ViewMatrix; }
+		/// @copydoc RenderTarget::GetTexture()
+		virtual std::shared_ptr<Texture> GetTexture() const override { return m_Texture; }
+
+		/// Gets the rasterizer recording the draw commands of this render target.
+		inline SoftwareRasterizer &GetRasterizer() { return m_Rasterizer; }
+		/// Gets the image this render target renders into.
+		inline const std::shared_ptr<SoftwareImage> &GetImage() const { return m_Image; }
+		/// Executes all pending draw commands.
+		void Flush();
+
+	private:
+
+		/// Creates the image for the current size and attaches the rasterizer to it.
+		bool CreateImage();
+		/// Copies a part of the image to the window.
+		void Blit(std::int32_t left, std::int32_t top, std::int32_t right, std::int32_t bottom);
+
+	private:
+
+		HWND m_Handle;
+		std::uint16_t m_Width, m_Height;
+		bool m_Fullscreen;
+		bool m_VSync;
+		Matrix4 m_ViewMatrix;
+		std::shared_ptr<SoftwareImage> m_Image;
+		std::shared_ptr<TextureSoftware> m_Texture;
+		SoftwareRasterizer m_Rasterizer;
+		std::vector<std::uint32_t> m_BlitBuffer;
+	};
+}
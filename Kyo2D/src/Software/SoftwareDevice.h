@@ -0,0 +1,27 @@
+
+#pragma once
+
+#include <memory>
+#include "WorkerPool.h"
+#include "SoftwareRasterizer.h"
+
+namespace Kyo2D
+{
+	class RenderTargetSoftware;
+
+	/// Shared state of the software backend, the counterpart of the Direct3D device objects.
+	struct SoftwareDevice
+	{
+		SoftwareDevice()
+			: ActiveTarget(nullptr)
+		{
+		}
+
+		/// Threads rasterizing the tiles of a render target.
+		WorkerPool Workers;
+		/// The render target all drawing goes to.
+		RenderTargetSoftware *ActiveTarget;
+		/// Image of the currently bound texture.
+		std::shared_ptr<const SoftwareImage> Texture;
+	};
+}
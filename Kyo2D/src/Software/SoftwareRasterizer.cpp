@@ -0,0 +1,589 @@
+#include "SoftwareRasterizer.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#	define K2D_SOFTWARE_SSE2 1
+#	include <emmintrin.h>
+#else
+#	define K2D_SOFTWARE_SSE2 0
+#endif
+
+namespace
+{
+	/// Width and height of a tile in pixels.
+	const std::int32_t TileSize = 64;
+
+	/// Computes a * b / 255, rounded to nearest.
+	inline std::uint32_t MulDiv255(std::uint32_t a, std::uint32_t b)
+	{
+		std::uint32_t t = a * b + 128;
+		return (t + (t >> 8)) >> 8;
+	}
+
+	/// Multiplies two colors channel by channel.
+	inline std::uint32_t Modulate(std::uint32_t a, std::uint32_t b)
+	{
+		return MulDiv255(a & 0xFF, b & 0xFF) |
+			(MulDiv255((a >> 8) & 0xFF, (b >> 8) & 0xFF) << 8) |
+			(MulDiv255((a >> 16) & 0xFF, (b >> 16) & 0xFF) << 16) |
+			(MulDiv255(a >> 24, b >> 24) << 24);
+	}
+
+	/// Blends src over dst. Like the blend states of the other backends, the resulting alpha
+	/// is the source alpha.
+	inline std::uint32_t Blend(std::uint32_t dst, std::uint32_t src, bool premultiplied)
+	{
+		std::uint32_t a = src >> 24;
+		std::uint32_t result = src & 0xFF000000;
+		for (std::uint32_t shift = 0; shift < 24; shift += 8)
+		{
+			std::uint32_t s = (src >> shift) & 0xFF;
+			std::uint32_t d = (dst >> shift) & 0xFF;
+			std::uint32_t c;
+			if (premultiplied)
+			{
+				c = std::min<std::uint32_t>(255, s + MulDiv255(d, 255 - a));
+			}
+			else
+			{
+				std::uint32_t t = s * a + d * (255 - a) + 128;
+				c = (t + (t >> 8)) >> 8;
+			}
+			result |= c << shift;
+		}
+		return result;
+	}
+
+#if K2D_SOFTWARE_SSE2
+	/// Computes a * b / 255 for 8 16-bit values, rounded to nearest.
+	inline __m128i MulDiv255(__m128i a, __m128i b)
+	{
+		__m128i t = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+		return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+	}
+
+	/// Broadcasts the alpha value of two unpacked pixels to all their channels.
+	inline __m128i BroadcastAlpha(__m128i pixels)
+	{
+		return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	}
+
+	/// Multiplies four pixels with a color channel by channel.
+	inline __m128i Modulate(__m128i pixels, __m128i color16)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		__m128i lo = MulDiv255(_mm_unpacklo_epi8(pixels, zero), color16);
+		__m128i hi = MulDiv255(_mm_unpackhi_epi8(pixels, zero), color16);
+		return _mm_packus_epi16(lo, hi);
+	}
+
+	/// Blends four source pixels over four destination pixels, see Blend.
+	inline __m128i Blend(__m128i dst, __m128i src, bool premultiplied)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i max = _mm_set1_epi16(255);
+
+		__m128i result[2];
+		for (int half = 0; half < 2; ++half)
+		{
+			__m128i s = half ? _mm_unpackhi_epi8(src, zero) : _mm_unpacklo_epi8(src, zero);
+			__m128i d = half ? _mm_unpackhi_epi8(dst, zero) : _mm_unpacklo_epi8(dst, zero);
+			__m128i a = BroadcastAlpha(s);
+			__m128i inv = _mm_sub_epi16(max, a);
+			if (premultiplied)
+			{
+				result[half] = _mm_add_epi16(s, MulDiv255(d, inv));
+			}
+			else
+			{
+				__m128i t = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, inv)), _mm_set1_epi16(128));
+				result[half] = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+			}
+		}
+
+		// Saturate and take the source alpha
+		const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+		__m128i packed = _mm_packus_epi16(result[0], result[1]);
+		return _mm_or_si128(_mm_andnot_si128(alphaMask, packed), _mm_and_si128(alphaMask, src));
+	}
+#endif
+
+	/// Wraps a texel coordinate into [0, size).
+	inline std::int32_t Wrap(std::int32_t value, std::int32_t size)
+	{
+		if (static_cast<std::uint32_t>(value) < static_cast<std::uint32_t>(size))
+			return value;
+
+		value %= size;
+		return value < 0 ? value + size : value;
+	}
+
+	/// Fetches a single texel using wrap addressing.
+	inline std::uint32_t Fetch(const Kyo2D::SoftwareImage &texture, std::int32_t x, std::int32_t y)
+	{
+		const std::int32_t index = Wrap(y, texture.Height) * texture.Width + Wrap(x, texture.Width);
+		if (!texture.Alpha.empty())
+			return 0x00FFFFFF | (static_cast<std::uint32_t>(texture.Alpha[index]) << 24);
+
+		return texture.Pixels[index];
+	}
+
+	/// Point samples a texture at the given texel coordinates, applying Scale2X if requested.
+	inline std::uint32_t Sample(const Kyo2D::SoftwareImage &texture, float tu, float tv, bool scale2X)
+	{
+		float fu = std::floor(tu);
+		float fv = std::floor(tv);
+		std::int32_t x = static_cast<std::int32_t>(fu);
+		std::int32_t y = static_cast<std::int32_t>(fv);
+
+		std::uint32_t center = Fetch(texture, x, y);
+		if (!scale2X)
+			return center;
+
+		std::uint32_t left = Fetch(texture, x - 1, y);
+		std::uint32_t right = Fetch(texture, x + 1, y);
+		std::uint32_t up = Fetch(texture, x, y - 1);
+		std::uint32_t bottom = Fetch(texture, x, y + 1);
+
+		// Select the quadrant of the texel
+		if (tv - fv >= 0.5f)
+			std::swap(up, bottom);
+		if (tu - fu >= 0.5f)
+			std::swap(left, right);
+
+		if (up == left && up != right && left != bottom)
+			center = left;
+
+		return center;
+	}
+
+	/// Samples a distance field bilinearly and turns it into a white texel with the coverage as alpha.
+	/// @param params The colorkey of the sprite: threshold in red, smoothing in green.
+	inline std::uint32_t SampleDistanceField(const Kyo2D::SoftwareImage &texture, float tu, float tv, std::uint32_t params)
+	{
+		// Texel centers are at .5
+		const float u = tu - 0.5f;
+		const float v = tv - 0.5f;
+		const float fu = std::floor(u);
+		const float fv = std::floor(v);
+		const std::int32_t x = static_cast<std::int32_t>(fu);
+		const std::int32_t y = static_cast<std::int32_t>(fv);
+		const float wx = u - fu;
+		const float wy = v - fv;
+
+		const float top = (Fetch(texture, x, y) >> 24) * (1.0f - wx) + (Fetch(texture, x + 1, y) >> 24) * wx;
+		const float bottom = (Fetch(texture, x, y + 1) >> 24) * (1.0f - wx) + (Fetch(texture, x + 1, y + 1) >> 24) * wx;
+		const float distance = (top * (1.0f - wy) + bottom * wy) / 255.0f;
+
+		// smoothstep(threshold - smoothing, threshold + smoothing, distance)
+		const float threshold = (params & 0xFF) / 255.0f;
+		const float smoothing = std::max(((params >> 8) & 0xFF) / 255.0f, 1.0f / 512.0f);
+		float t = (distance - threshold + smoothing) / (2.0f * smoothing);
+		t = std::min(1.0f, std::max(0.0f, t));
+		const float coverage = t * t * (3.0f - 2.0f * t);
+
+		return 0x00FFFFFF | (static_cast<std::uint32_t>(coverage * 255.0f + 0.5f) << 24);
+	}
+
+	/// Samples the texture of a sprite command.
+	inline std::uint32_t SampleSprite(const Kyo2D::RasterCommand &cmd, float tu, float tv)
+	{
+		if (cmd.DistanceField)
+			return SampleDistanceField(*cmd.Texture, tu, tv, cmd.Colorkey);
+
+		return Sample(*cmd.Texture, tu, tv, cmd.Scale2X);
+	}
+
+	/// Converts a float to a pixel coordinate, clamping values far outside of any target.
+	inline std::int32_t ToPixel(float value)
+	{
+		return static_cast<std::int32_t>(std::max(-1.0e9f, std::min(1.0e9f, value)));
+	}
+
+	/// Rasterizes a sprite command within the given rectangle.
+	/// @tparam Vectorized If true, pixels are processed four at a time using SSE2 where available.
+	template <bool Vectorized>
+	void RasterizeSprite(const Kyo2D::RasterCommand &cmd, Kyo2D::SoftwareImage &target, std::int32_t left, std::int32_t top, std::int32_t right, std::int32_t bottom)
+	{
+		const Kyo2D::SoftwareImage &texture = *cmd.Texture;
+		const bool colorkeyTest = !cmd.Premultiplied && !cmd.DistanceField && texture.Alpha.empty();
+
+#if K2D_SOFTWARE_SSE2
+		const __m128 laneOffsets = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+		const __m128 negHalfW = _mm_set1_ps(-cmd.HalfW), halfW = _mm_set1_ps(cmd.HalfW);
+		const __m128 negHalfH = _mm_set1_ps(-cmd.HalfH), halfH = _mm_set1_ps(cmd.HalfH);
+		const __m128i color16 = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(cmd.Color)), _mm_setzero_si128());
+		const __m128i colorkey = _mm_set1_epi32(static_cast<int>(cmd.Colorkey));
+#endif
+
+		for (std::int32_t y = top; y < bottom; ++y)
+		{
+			const float py = y + 0.5f;
+			const float lxRow = cmd.LxY * py + cmd.Lx0;
+			const float lyRow = cmd.LyY * py + cmd.Ly0;
+			const float tuRow = cmd.TuY * py + cmd.Tu0;
+			const float tvRow = cmd.TvY * py + cmd.Tv0;
+			std::uint32_t *row = &target.Pixels[y * target.Width];
+
+			std::int32_t x = left;
+#if K2D_SOFTWARE_SSE2
+			for (; Vectorized && x + 4 <= right; x += 4)
+			{
+				__m128 px = _mm_add_ps(_mm_set1_ps(x + 0.5f), laneOffsets);
+				__m128 lx = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(cmd.LxX)), _mm_set1_ps(lxRow));
+				__m128 ly = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(cmd.LyX)), _mm_set1_ps(lyRow));
+				__m128 inside = _mm_and_ps(
+					_mm_and_ps(_mm_cmpge_ps(lx, negHalfW), _mm_cmplt_ps(lx, halfW)),
+					_mm_and_ps(_mm_cmpge_ps(ly, negHalfH), _mm_cmplt_ps(ly, halfH)));
+
+				int mask = _mm_movemask_ps(inside);
+				if (mask == 0)
+					continue;
+
+				// Texture fetches are scalar, everything else works on four pixels
+				alignas(16) float tu[4], tv[4];
+				alignas(16) std::uint32_t texels[4] = { 0, 0, 0, 0 };
+				_mm_store_ps(tu, _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(cmd.TuX)), _mm_set1_ps(tuRow)));
+				_mm_store_ps(tv, _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(cmd.TvX)), _mm_set1_ps(tvRow)));
+				for (int lane = 0; lane < 4; ++lane)
+				{
+					if (mask & (1 << lane))
+						texels[lane] = SampleSprite(cmd, tu[lane], tv[lane]);
+				}
+
+				__m128i texel = _mm_load_si128(reinterpret_cast<const __m128i*>(texels));
+				__m128i keep = _mm_castps_si128(inside);
+				if (colorkeyTest)
+					keep = _mm_andnot_si128(_mm_cmpeq_epi32(texel, colorkey), keep);
+
+				__m128i dst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+				__m128i out = Blend(dst, Modulate(texel, color16), cmd.Premultiplied);
+				out = _mm_or_si128(_mm_and_si128(keep, out), _mm_andnot_si128(keep, dst));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(row + x), out);
+			}
+#endif
+			for (; x < right; ++x)
+			{
+				const float px = x + 0.5f;
+				const float lx = px * cmd.LxX + lxRow;
+				const float ly = px * cmd.LyX + lyRow;
+				if (!(lx >= -cmd.HalfW && lx < cmd.HalfW && ly >= -cmd.HalfH && ly < cmd.HalfH))
+					continue;
+
+				std::uint32_t texel = SampleSprite(cmd, px * cmd.TuX + tuRow, px * cmd.TvX + tvRow);
+				if (colorkeyTest && texel == cmd.Colorkey)
+					continue;
+
+				row[x] = Blend(row[x], Modulate(texel, cmd.Color), cmd.Premultiplied);
+			}
+		}
+	}
+
+	/// Blends a color over a horizontal span of pixels.
+	/// @tparam Vectorized If true, pixels are processed four at a time using SSE2 where available.
+	template <bool Vectorized>
+	void BlendSpan(std::uint32_t *pixels, std::int32_t count, std::uint32_t color)
+	{
+		std::int32_t i = 0;
+#if K2D_SOFTWARE_SSE2
+		const __m128i src = _mm_set1_epi32(static_cast<int>(color));
+		for (; Vectorized && i + 4 <= count; i += 4)
+		{
+			__m128i dst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i), Blend(dst, src, false));
+		}
+#endif
+		for (; i < count; ++i)
+			pixels[i] = Blend(pixels[i], color, false);
+	}
+}
+
+namespace Kyo2D
+{
+	SoftwareRasterizer::SoftwareRasterizer()
+		: m_TilesX(0)
+		, m_TilesY(0)
+		, m_Vectorized(K2D_SOFTWARE_SSE2 != 0)
+	{
+		ResetScissor();
+	}
+
+	SoftwareRasterizer::~SoftwareRasterizer()
+	{
+	}
+
+	void SoftwareRasterizer::SetTarget(const std::shared_ptr<SoftwareImage> &target)
+	{
+		m_Commands.clear();
+		m_Target = target;
+		m_TilesX = target ? (target->Width + TileSize - 1) / TileSize : 0;
+		m_TilesY = target ? (target->Height + TileSize - 1) / TileSize : 0;
+		m_Bins.resize(static_cast<size_t>(m_TilesX) * static_cast<size_t>(m_TilesY));
+		ResetScissor();
+	}
+
+	void SoftwareRasterizer::SetVectorized(bool enable)
+	{
+		m_Vectorized = enable && K2D_SOFTWARE_SSE2;
+	}
+
+	void SoftwareRasterizer::SetScissor(std::int32_t left, std::int32_t top, std::int32_t right, std::int32_t bottom)
+	{
+		m_ScissorLeft = left;
+		m_ScissorTop = top;
+		m_ScissorRight = right;
+		m_ScissorBottom = bottom;
+	}
+
+	void SoftwareRasterizer::ResetScissor()
+	{
+		m_ScissorLeft = 0;
+		m_ScissorTop = 0;
+		m_ScissorRight = m_Target ? m_Target->Width : 0;
+		m_ScissorBottom = m_Target ? m_Target->Height : 0;
+	}
+
+	void SoftwareRasterizer::Clear(std::uint32_t color)
+	{
+		if (!m_Target)
+			return;
+
+		// Clearing the whole target makes everything recorded before pointless
+		m_Commands.clear();
+		ClearRect(0, 0, m_Target->Width, m_Target->Height, color);
+	}
+
+	void SoftwareRasterizer::ClearRect(std::int32_t left, std::int32_t top, std::int32_t right, std::int32_t bottom, std::uint32_t color)
+	{
+		if (!m_Target)
+			return;
+
+		// Clears ignore the scissor rect
+		RasterCommand command;
+		command.Type = raster_command::Clear;
+		command.Color = color;
+		command.Left = std::max(left, 0);
+		command.Top = std::max(top, 0);
+		command.Right = std::min(right, m_Target->Width);
+		command.Bottom = std::min(bottom, m_Target->Height);
+		if (command.Left < command.Right && command.Top < command.Bottom)
+			m_Commands.push_back(std::move(command));
+	}
+
+	void SoftwareRasterizer::DrawSprite(const std::shared_ptr<const SoftwareImage> &texture, float centerX, float centerY, float width, float height, float rotation,
+		float u0, float v0, float u1, float v1, std::uint32_t color, std::uint32_t colorkey, bool scale2X, bool premultiplied, bool distanceField)
+	{
+		if (!texture || texture->Width <= 0 || texture->Height <= 0 || width == 0.0f || height == 0.0f)
+			return;
+
+		RasterCommand command;
+		command.Type = raster_command::Sprite;
+		command.Color = color;
+		command.Colorkey = colorkey;
+		// Alpha-only images hold coverage, which Scale2X isn't meant for
+		command.Scale2X = scale2X && texture->Alpha.empty() && !distanceField;
+		command.Premultiplied = premultiplied;
+		command.DistanceField = distanceField;
+		command.Texture = texture;
+		command.HalfW = std::fabs(width) * 0.5f;
+		command.HalfH = std::fabs(height) * 0.5f;
+
+		// Quad local coordinates of a pixel center (px, py):
+		//   lx =  (px - cx) * cos + (py - cy) * sin
+		//   ly = -(px - cx) * sin + (py - cy) * cos
+		const float c = std::cos(rotation);
+		const float s = std::sin(rotation);
+		command.LxX = c;
+		command.LxY = s;
+		command.Lx0 = -(centerX * c + centerY * s);
+		command.LyX = -s;
+		command.LyY = c;
+		command.Ly0 = centerX * s - centerY * c;
+
+		// Texel coordinates: u = u0 + (lx / width + 0.5) * (u1 - u0), scaled by the texture size.
+		// Signed sizes mirror the texture, just like the vertices of the other backends.
+		const float du = (u1 - u0) * texture->Width / width;
+		const float dv = (v1 - v0) * texture->Height / height;
+		const float baseU = (u0 + (u1 - u0) * 0.5f) * texture->Width;
+		const float baseV = (v0 + (v1 - v0) * 0.5f) * texture->Height;
+		command.TuX = du * command.LxX;
+		command.TuY = du * command.LxY;
+		command.Tu0 = du * command.Lx0 + baseU;
+		command.TvX = dv * command.LyX;
+		command.TvY = dv * command.LyY;
+		command.Tv0 = dv * command.Ly0 + baseV;
+
+		// Bounds of the rotated quad
+		const float extX = command.HalfW * std::fabs(c) + command.HalfH * std::fabs(s);
+		const float extY = command.HalfW * std::fabs(s) + command.HalfH * std::fabs(c);
+		command.Left = ToPixel(std::floor(centerX - extX));
+		command.Top = ToPixel(std::floor(centerY - extY));
+		command.Right = ToPixel(std::ceil(centerX + extX));
+		command.Bottom = ToPixel(std::ceil(centerY + extY));
+
+		Submit(command);
+	}
+
+	void SoftwareRasterizer::DrawPoint(float x, float y, std::uint32_t color)
+	{
+		RasterCommand command;
+		command.Type = raster_command::Point;
+		command.Color = color;
+		command.Left = ToPixel(std::floor(x));
+		command.Top = ToPixel(std::floor(y));
+		command.Right = command.Left + 1;
+		command.Bottom = command.Top + 1;
+
+		Submit(command);
+	}
+
+	void SoftwareRasterizer::DrawLine(float x0, float y0, float x1, float y1, std::uint32_t color)
+	{
+		RasterCommand command;
+		command.Type = raster_command::Line;
+		command.Color = color;
+		command.X0 = x0;
+		command.Y0 = y0;
+		command.X1 = x1;
+		command.Y1 = y1;
+		command.Left = ToPixel(std::floor(std::min(x0, x1)));
+		command.Top = ToPixel(std::floor(std::min(y0, y1)));
+		command.Right = ToPixel(std::floor(std::max(x0, x1))) + 1;
+		command.Bottom = ToPixel(std::floor(std::max(y0, y1))) + 1;
+
+		Submit(command);
+	}
+
+	void SoftwareRasterizer::FillRect(float x, float y, float w, float h, std::uint32_t color)
+	{
+		// Pixels whose centers are inside the rectangle are covered
+		RasterCommand command;
+		command.Type = raster_command::Fill;
+		command.Color = color;
+		command.Left = ToPixel(std::ceil(std::min(x, x + w) - 0.5f));
+		command.Top = ToPixel(std::ceil(std::min(y, y + h) - 0.5f));
+		command.Right = ToPixel(std::ceil(std::max(x, x + w) - 0.5f));
+		command.Bottom = ToPixel(std::ceil(std::max(y, y + h) - 0.5f));
+
+		Submit(command);
+	}
+
+	void SoftwareRasterizer::Flush(WorkerPool &workers)
+	{
+		if (!m_Target || m_Commands.empty())
+			return;
+
+		// Bin the commands into the tiles they touch
+		for (auto &bin : m_Bins)
+			bin.clear();
+
+		for (std::uint32_t i = 0; i < static_cast<std::uint32_t>(m_Commands.size()); ++i)
+		{
+			const RasterCommand &command = m_Commands[i];
+			std::int32_t tileLeft = command.Left / TileSize;
+			std::int32_t tileTop = command.Top / TileSize;
+			std::int32_t tileRight = (command.Right - 1) / TileSize;
+			std::int32_t tileBottom = (command.Bottom - 1) / TileSize;
+			for (std::int32_t ty = tileTop; ty <= tileBottom; ++ty)
+			{
+				for (std::int32_t tx = tileLeft; tx <= tileRight; ++tx)
+					m_Bins[ty * m_TilesX + tx].push_back(i);
+			}
+		}
+
+		workers.Run(static_cast<std::uint32_t>(m_Bins.size()), [this](std::uint32_t tile)
+		{
+			RasterizeTile(tile);
+		});
+
+		m_Commands.clear();
+	}
+
+	void SoftwareRasterizer::Submit(RasterCommand &command)
+	{
+		if (!m_Target)
+			return;
+
+		command.Left = std::max(command.Left, m_ScissorLeft);
+		command.Top = std::max(command.Top, m_ScissorTop);
+		command.Right = std::min(command.Right, m_ScissorRight);
+		command.Bottom = std::min(command.Bottom, m_ScissorBottom);
+		command.Left = std::max(command.Left, 0);
+		command.Top = std::max(command.Top, 0);
+		command.Right = std::min(command.Right, m_Target->Width);
+		command.Bottom = std::min(command.Bottom, m_Target->Height);
+
+		if (command.Left < command.Right && command.Top < command.Bottom)
+			m_Commands.push_back(std::move(command));
+	}
+
+	void SoftwareRasterizer::RasterizeTile(std::uint32_t tile)
+	{
+		const std::vector<std::uint32_t> &bin = m_Bins[tile];
+		if (bin.empty())
+			return;
+
+		SoftwareImage &target = *m_Target;
+		const std::int32_t tileLeft = static_cast<std::int32_t>(tile % m_TilesX) * TileSize;
+		const std::int32_t tileTop = static_cast<std::int32_t>(tile / m_TilesX) * TileSize;
+
+		for (std::uint32_t index : bin)
+		{
+			const RasterCommand &command = m_Commands[index];
+			std::int32_t left = std::max(command.Left, tileLeft);
+			std::int32_t top = std::max(command.Top, tileTop);
+			std::int32_t right = std::min(command.Right, tileLeft + TileSize);
+			std::int32_t bottom = std::min(command.Bottom, tileTop + TileSize);
+
+			switch (command.Type)
+			{
+				case raster_command::Clear:
+				{
+					for (std::int32_t y = top; y < bottom; ++y)
+						std::fill(&target.Pixels[y * target.Width + left], &target.Pixels[y * target.Width + right], command.Color);
+					break;
+				}
+				case raster_command::Sprite:
+				{
+					if (m_Vectorized)
+						RasterizeSprite<true>(command, target, left, top, right, bottom);
+					else
+						RasterizeSprite<false>(command, target, left, top, right, bottom);
+					break;
+				}
+				case raster_command::Point:
+				case raster_command::Fill:
+				{
+					for (std::int32_t y = top; y < bottom; ++y)
+					{
+						if (m_Vectorized)
+							BlendSpan<true>(&target.Pixels[y * target.Width + left], right - left, command.Color);
+						else
+							BlendSpan<false>(&target.Pixels[y * target.Width + left], right - left, command.Color);
+					}
+					break;
+				}
+				case raster_command::Line:
+				{
+					// Step along the major axis, the last pixel is left out
+					float dx = command.X1 - command.X0;
+					float dy = command.Y1 - command.Y0;
+					std::int32_t steps = static_cast<std::int32_t>(std::ceil(std::max(std::fabs(dx), std::fabs(dy))));
+					for (std::int32_t i = 0; i < steps; ++i)
+					{
+						float t = static_cast<float>(i) / static_cast<float>(steps);
+						std::int32_t x = static_cast<std::int32_t>(std::floor(command.X0 + dx * t));
+						std::int32_t y = static_cast<std::int32_t>(std::floor(command.Y0 + dy * t));
+						if (x >= left && x < right && y >= top && y < bottom)
+						{
+							std::uint32_t &pixel = target.Pixels[y * target.Width + x];
+							pixel = Blend(pixel, command.Color, false);
+						}
+					}
+					break;
+				}
+			}
+		}
+	}
+}
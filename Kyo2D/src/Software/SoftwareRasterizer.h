@@ -0,0 +1,136 @@
+#pragma once
+
+#include "WorkerPool.h"
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace Kyo2D
+{
+	/// RGBA8 image used for textures and render targets of the software backend.
+	/// Pixels are stored as 0xAABBGGRR, just like the texture data uploaded by the other backends.
+	struct SoftwareImage
+	{
+		std::int32_t Width;
+		std::int32_t Height;
+		std::vector<std::uint32_t> Pixels;
+		/// Alpha values of alpha-only images, which leave Pixels empty. Their color is white.
+		std::vector<std::uint8_t> Alpha;
+	};
+
+	/// Rasterizer command enumeration.
+	namespace raster_command
+	{
+		enum Type
+		{
+			Clear		= 0,
+			Sprite		= 1,
+			Point		= 2,
+			Line		= 3,
+			Fill		= 4
+		};
+	}
+
+	/// A single command recorded by the software rasterizer.
+	struct RasterCommand
+	{
+		raster_command::Type Type;
+		/// Color in 0xAABBGGRR format. Already premultiplied for premultiplied sprites.
+		std::uint32_t Color;
+		/// Colorkey of sprites in 0xAABBGGRR format. Threshold and smoothing of distance field sprites.
+		std::uint32_t Colorkey;
+		bool Scale2X;
+		bool Premultiplied;
+		bool DistanceField;
+		/// Line end points.
+		float X0, Y0, X1, Y1;
+		/// Sprites: texel coordinates as affine function of the pixel position.
+		float TuX, TuY, Tu0, TvX, TvY, Tv0;
+		/// Sprites: quad local coordinates as affine function of the pixel position.
+		float LxX, LxY, Lx0, LyX, LyY, Ly0;
+		/// Sprites: half size of the quad.
+		float HalfW, HalfH;
+		/// Sprites: the texture to sample.
+		std::shared_ptr<const SoftwareImage> Texture;
+		/// Pixel bounds, clipped to the target. Right and Bottom are exclusive.
+		std::int32_t Left, Top, Right, Bottom;
+	};
+
+	/// Tile based rasterizer of the software backend. Commands are recorded and executed when
+	/// flushing: every command is binned into the screen tiles it touches, and the tiles are
+	/// rasterized in parallel. Within a tile, commands are executed in submission order, so the
+	/// result is the same as drawing everything sequentially.
+	/// The pixel pipeline matches the sprite shaders: point sampling with wrapping, colorkey test,
+	/// vertex color modulation, Scale2X, distance fields and straight or premultiplied alpha blending.
+	class SoftwareRasterizer
+	{
+	public:
+
+		/// Default constructor.
+		SoftwareRasterizer();
+		/// Destructor.
+		~SoftwareRasterizer();
+
+		/// Sets the image to render into. Pending commands are dropped.
+		void SetTarget(const std::shared_ptr<SoftwareImage> &target);
+		/// Gets the image this rasterizer renders into.
+		inline const std::shared_ptr<SoftwareImage> &GetTarget() const { return m_Target; }
+		/// Determines if there are commands waiting to be flushed.
+		inline bool HasPendingCommands() const { return !m_Commands.empty(); }
+
+		/// Enables or disables processing four pixels at a time using SSE2, which is the default where
+		/// available. The scalar code gives the same result, disabling SSE2 is meant for testing that.
+		void SetVectorized(bool enable);
+		/// Determines if pixels are processed four at a time using SSE2.
+		inline bool IsVectorized() const { return m_Vectorized; }
+
+		/// Restricts all following draw commands to the given rectangle. Clears ignore it.
+		void SetScissor(std::int32_t left, std::int32_t top, std::int32_t right, std::int32_t bottom);
+		/// Resets the scissor rectangle to the whole target.
+		void ResetScissor();
+
+		/// Fills the whole target with the given color.
+		void Clear(std::uint32_t color);
+		/// Fills a part of the target with the given color, without blending.
+		void ClearRect(std::int32_t left, std::int32_t top, std::int32_t right, std::int32_t bottom, std::uint32_t color);
+		/// Draws a textured quad.
+		/// @param centerX Center of the quad in pixels.
+		/// @param centerY Center of the quad in pixels.
+		/// @param width Width of the quad, negative values mirror the texture.
+		/// @param height Height of the quad, negative values mirror the texture.
+		/// @param rotation Rotation around the center in radians.
+		/// @param u0 Texture coordinate at the left edge.
+		/// @param v0 Texture coordinate at the top edge.
+		/// @param u1 Texture coordinate at the right edge. Values above 1 repeat the texture.
+		/// @param v1 Texture coordinate at the bottom edge.
+		/// @param distanceField If true, the alpha of the texture is a distance field which is sampled
+		///		bilinearly and thresholded as described by SpriteDrawer::SetDistanceField.
+		void DrawSprite(const std::shared_ptr<const SoftwareImage> &texture, float centerX, float centerY, float width, float height, float rotation,
+			float u0, float v0, float u1, float v1, std::uint32_t color, std::uint32_t colorkey, bool scale2X, bool premultiplied, bool distanceField);
+		/// Draws a single pixel.
+		void DrawPoint(float x, float y, std::uint32_t color);
+		/// Draws a line. The last pixel isn't drawn, so line strips don't blend corners twice.
+		void DrawLine(float x0, float y0, float x1, float y1, std::uint32_t color);
+		/// Fills a rectangle.
+		void FillRect(float x, float y, float w, float h, std::uint32_t color);
+
+		/// Executes all pending commands.
+		void Flush(WorkerPool &workers);
+
+	private:
+
+		/// Clips the command bounds to the target and records it.
+		void Submit(RasterCommand &command);
+		/// Executes all commands binned into the given tile.
+		void RasterizeTile(std::uint32_t tile);
+
+	private:
+
+		std::shared_ptr<SoftwareImage> m_Target;
+		std::vector<RasterCommand> m_Commands;
+		std::vector<std::vector<std::uint32_t>> m_Bins;
+		std::int32_t m_TilesX, m_TilesY;
+		std::int32_t m_ScissorLeft, m_ScissorTop, m_ScissorRight, m_ScissorBottom;
+		bool m_Vectorized;
+	};
+}
@@ -0,0 +1,117 @@
+
+#include "SpriteDrawerSoftware.h"
+#include "../EngineContext.h"
+#include "RenderTargetSoftware.h"
+#include <algorithm>
+
+namespace Kyo2D
+{
+	SpriteDrawerSoftware::SpriteDrawerSoftware()
+		: SpriteDrawer()
+		, m_Scale2XEnabled(false)
+		, m_PremultipliedAlpha(false)
+		, m_AlphaTexture(false)
+		, m_DistanceField(false)
+	{
+	}
+
+	SpriteDrawerSoftware::~SpriteDrawerSoftware()
+	{
+	}
+
+	bool SpriteDrawerSoftware::Initialize()
+	{
+		return true;
+	}
+
+	bool SpriteDrawerSoftware::Prepare()
+	{
+		return true;
+	}
+
+	void SpriteDrawerSoftware::SetViewMatrix(const Matrix4 &/*ViewMatrix*/)
+	{
+		// The software rasterizer works in pixel coordinates directly
+	}
+
+	void SpriteDrawerSoftware::SetScale2XEnabled(bool Enable)
+	{
+		m_Scale2XEnabled = Enable;
+	}
+
+	void SpriteDrawerSoftware::SetPremultipliedAlpha(bool Enable)
+	{
+		m_PremultipliedAlpha = Enable;
+	}
+
+	void SpriteDrawerSoftware::SetAlphaTexture(bool Enable)
+	{
+		// The rasterizer recognizes alpha-only images by their data, nothing to switch here
+		m_AlphaTexture = Enable;
+	}
+
+	void SpriteDrawerSoftware::SetDistanceField(bool Enable)
+	{
+		m_DistanceField = Enable;
+	}
+
+	void SpriteDrawerSoftware::DrawSpriteAt(std::int32_t texW, std::int32_t texH, float X, float Y, float /*Z*/, float Rotation, std::uint32_t color, std::uint32_t colorkey)
+	{
+		float W = static_cast<float>(texW);
+		float H = static_cast<float>(texH);
+		Dispatch(X + W * 0.5f, Y + H * 0.5f, W, H, Rotation, 0.0f, 0.0f, 1.0f, 1.0f, color, colorkey);
+	}
+
+	void SpriteDrawerSoftware::DrawSubspriteAt(std::int32_t texW, std::int32_t texH, float X, float Y, float /*Z*/, float srcX, float srcY, float srcW, float srcH, float Rotation, std::uint32_t color, std::uint32_t colorkey)
+	{
+		float srcU = srcX / (float)texW;
+		float srcV = srcY / (float)texH;
+		float dstU = srcU + (srcW / (float)texW);
+		float dstV = srcV + (srcH / (float)texH);
+
+		Dispatch(X + srcW * 0.5f, Y + srcH * 0.5f, srcW, srcH, Rotation, srcU, srcV, dstU, dstV, color, colorkey);
+	}
+
+	void SpriteDrawerSoftware::DrawSpriteScaled(std::int32_t /*texW*/, std::int32_t /*texH*/, float X, float Y, float /*Z*/, float W, float H, float Rotation, std::uint32_t color, std::uint32_t colorkey)
+	{
+		Dispatch(X + std::max<float>(W * 0.5f, W * -0.5f), Y + std::max<float>(H * 0.5f, H * -0.5f), W, H, Rotation, 0.0f, 0.0f, 1.0f, 1.0f, color, colorkey);
+	}
+
+	void SpriteDrawerSoftware::DrawSubspriteScaled(std::int32_t texW, std::int32_t texH, float X, float Y, float /*Z*/, float W, float H, float srcX, float srcY, float srcW, float srcH, float Rotation, std::uint32_t color, std::uint32_t colorkey)
+	{
+		float srcU = srcX / (float)texW;
+		float srcV = srcY / (float)texH;
+		float dstU = srcU + (srcW / (float)texW);
+		float dstV = srcV + (srcH / (float)texH);
+
+		Dispatch(X + std::max<float>(W * 0.5f, W * -0.5f), Y + std::max<float>(H * 0.5f, H * -0.5f), W, H, Rotation, srcU, srcV, dstU, dstV, color, colorkey);
+	}
+
+	void SpriteDrawerSoftware::DrawSpriteTiled(std::int32_t /*texW*/, std::int32_t /*texH*/, float X, float Y, float /*Z*/, float W, float H, float tX, float tY, float Rotation, std::uint32_t color, std::uint32_t colorkey)
+	{
+		Dispatch(X + W * 0.5f, Y + H * 0.5f, W, H, Rotation, 0.0f, 0.0f, tX, tY, color, colorkey);
+	}
+
+	void SpriteDrawerSoftware::Dispatch(float x, float y, float W, float H, float Rotation, float u0, float v0, float u1, float v1, std::uint32_t color, std::uint32_t colorkey)
+	{
+		RenderTargetSoftware *target = g_Context->Software.ActiveTarget;
+		if (!target || !g_Context->Software.Texture)
+			return;
+
+		// Like the premultiplied pixel shaders, premultiply the vertex color as well
+		if (m_PremultipliedAlpha)
+		{
+			std::uint32_t a = color >> 24;
+			std::uint32_t r = ((color & 0xFF) * a + 127) / 255;
+			std::uint32_t g = (((color >> 8) & 0xFF) * a + 127) / 255;
+			std::uint32_t b = (((color >> 16) & 0xFF) * a + 127) / 255;
+			color = r | (g << 8) | (b << 16) | (a << 24);
+		}
+
+		target->GetRasterizer().DrawSprite(g_Context->Software.Texture, x, y, W, H, Rotation,
+			u0, v0, u1, v1, color, colorkey, m_Scale2XEnabled, m_PremultipliedAlpha, m_DistanceField);
+
+		g_Context->Stats.DrawCalls++;
+		g_Context->Stats.Vertices += 4;
+	}
+}
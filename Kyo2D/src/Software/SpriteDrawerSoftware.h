@@ -0,0 +1,73 @@
+
+#pragma once
+
+#include "../SpriteDrawer.h"
+#include "SoftwareDevice.h"
+
+namespace Kyo2D
+{
+	/// Software implementation of the sprite drawer. Sprites are recorded by the rasterizer of
+	/// the active render target.
+	class SpriteDrawerSoftware : public SpriteDrawer
+	{
+	public:
+
+		/// Default constructor.
+		SpriteDrawerSoftware();
+		/// Destructor.
+		virtual ~SpriteDrawerSoftware();
+
+		/// @copydoc SpriteDrawer::Initialize()
+		virtual bool Initialize() override;
+		/// @copydoc SpriteDrawer::Prepare()
+		virtual bool Prepare() override;
+		/// @copydoc SpriteDrawer::SetViewMatrix(const Matrix4 &)
+		virtual void SetViewMatrix(const Matrix4 &ViewMatrix) override;
+		/// @copydoc SpriteDrawer::SetScale2XEnabled(bool)
+		virtual void SetScale2XEnabled(bool Enable) override;
+		/// @copydoc SpriteDrawer::SetPremultipliedAlpha(bool)
+		virtual void SetPremultipliedAlpha(bool Enable) override;
+		/// @copydoc SpriteDrawer::SetAlphaTexture(bool)
+		virtual void SetAlphaTexture(bool Enable) override;
+		/// @copydoc SpriteDrawer::SetDistanceField(bool)
+		virtual void SetDistanceField(bool Enable) override;
+
+	public:
+
+		/// @copydoc SpriteDrawer::IsScale2XEnabled()
+		virtual bool IsScale2XEnabled() const override { return m_Scale2XEnabled; }
+		/// @copydoc SpriteDrawer::IsPremultipliedAlpha()
+		virtual bool IsPremultipliedAlpha() const override { return m_PremultipliedAlpha; }
+		/// @copydoc SpriteDrawer::IsAlphaTexture()
+		virtual bool IsAlphaTexture() const override { return m_AlphaTexture; }
+		/// @copydoc SpriteDrawer::IsDistanceField()
+		virtual bool IsDistanceField() const override { return m_DistanceField; }
+
+	public:
+
+		/// Draws a simple sprite at a given location.
+		virtual void DrawSpriteAt(std::int32_t texW, std::int32_t texH, float X, float Y, float Z, float Rotation, std::uint32_t color, std::uint32_t colorkey) override;
+		/// Draws a subarea of a sprite at a given location.
+		virtual void DrawSubspriteAt(std::int32_t texW, std::int32_t texH, float X, float Y, float Z, float srcX, float srcY, float srcW, float srcH, float Rotation, std::uint32_t color, std::uint32_t colorkey) override;
+		/// Draws a sprite and stretches it to the given area.
+		virtual void DrawSpriteScaled(std::int32_t texW, std::int32_t texH, float X, float Y, float Z, float W, float H, float Rotation, std::uint32_t color, std::uint32_t colorkey) override;
+		/// Draws a subarea of a sprite and stretches it to the given area.
+		virtual void DrawSubspriteScaled(std::int32_t texW, std::int32_t texH, float X, float Y, float Z, float W, float H, float srcX, float srcY, float srcW, float srcH, float Rotation, std::uint32_t color, std::uint32_t colorkey) override;
+		/// Draws a sprite and tiles it in the given area.
+		virtual void DrawSpriteTiled(std::int32_t texW, std::int32_t texH, float X, float Y, float Z, float W, float H, float tX, float tY, float Rotation, std::uint32_t color, std::uint32_t colorkey) override;
+
+	private:
+
+		/// Records a sprite with the bound texture on the active render target.
+		/// @param x X coordinate of the sprites center in pixels.
+		/// @param y Y coordinate of the sprites center in pixels.
+		void Dispatch(float x, float y, float W, float H, float Rotation, float u0, float v0, float u1, float v1, std::uint32_t color, std::uint32_t colorkey);
+
+	private:
+
+		bool m_Scale2XEnabled;
+		bool m_PremultipliedAlpha;
+		bool m_AlphaTexture;
+		bool m_DistanceField;
+	};
+}
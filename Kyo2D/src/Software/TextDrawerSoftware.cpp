@@ -0,0 +1,42 @@
+#include "TextDrawerSoftware.h"
+#include "../EngineContext.h"
+#include "RenderTargetSoftware.h"
+
+namespace Kyo2D
+{
+	TextDrawerSoftware::TextDrawerSoftware()
+		: TextDrawer()
+		, m_AlphaTexture(false)
+		, m_DistanceField(false)
+	{
+	}
+
+	TextDrawerSoftware::~TextDrawerSoftware()
+	{
+	}
+
+	void TextDrawerSoftware::DrawGlyphs(std::int32_t texW, std::int32_t texH, const GlyphQuad *quads, size_t count, std::uint32_t color, std::uint32_t colorkey)
+	{
+		RenderTargetSoftware *target = g_Context->Software.ActiveTarget;
+		if (!target || !g_Context->Software.Texture)
+			return;
+
+		const float invW = 1.0f / static_cast<float>(texW);
+		const float invH = 1.0f / static_cast<float>(texH);
+
+		SoftwareRasterizer &rasterizer = target->GetRasterizer();
+		for (size_t i = 0; i < count; ++i)
+		{
+			const GlyphQuad &quad = quads[i];
+			const float u0 = quad.SrcX * invW, v0 = quad.SrcY * invH;
+			const float u1 = u0 + quad.SrcW * invW, v1 = v0 + quad.SrcH * invH;
+
+			rasterizer.DrawSprite(g_Context->Software.Texture, quad.X + quad.W * 0.5f, quad.Y + quad.H * 0.5f, quad.W, quad.H, 0.0f,
+				u0, v0, u1, v1, color, colorkey, false, false, m_DistanceField);
+		}
+
+		// The rasterizer has no draw calls, the run counts as one like on the gpu backends
+		g_Context->Stats.DrawCalls++;
+		g_Context->Stats.Vertices += static_cast<std::uint32_t>(count * 4);
+	}
+}
@@ -0,0 +1,221 @@
+
+#include "TextureSoftware.h"
+#include "RenderTargetSoftware.h"
+#include "../EngineContext.h"
+#include "../File.h"
+#include <cstring>
+
+namespace Kyo2D
+{
+	TextureSoftware::TextureSoftware()
+		: m_Width(0)
+		, m_Height(0)
+	{
+	}
+
+	TextureSoftware::~TextureSoftware()
+	{
+	}
+
+#ifndef K2D_NO_IMAGE_LOADER
+	bool TextureSoftware::Initialize(const void * data, size_t dataSize)
+	{
+		// Load image from memory
+		ILuint idImage;
+		ilGenImages(1, &idImage);
+		ilBindImage(idImage);
+		ilLoadL(IL_TYPE_UNKNOWN, data, static_cast<ILuint>(dataSize));
+		if (ilGetError() != IL_NO_ERROR)
+		{
+			return false;
+		}
+
+		return InitializeImpl(idImage);
+	}
+
+	bool TextureSoftware::Initialize(const std::wstring &filename)
+	{
+		// Load image from file
+		ILuint idImage;
+		ilGenImages(1, &idImage);
+		ilBindImage(idImage);
+#ifdef _WIN32
+		ilLoadImage(filename.c_str());
+#else
+		ilLoadImage(narrowFilename(filename).c_str());
+#endif
+		if (ilGetError() != IL_NO_ERROR)
+		{
+			return false;
+		}
+
+		return InitializeImpl(idImage);
+	}
+#else
+	bool TextureSoftware::Initialize(const void *, size_t)
+	{
+		// Built without DevIL, textures can only be created from pixels
+		return false;
+	}
+
+	bool TextureSoftware::Initialize(const std::wstring &)
+	{
+		return false;
+	}
+#endif
+
+	bool TextureSoftware::InitializeRenderTarget(std::int32_t width, std::int32_t height)
+	{
+		ReleaseResources();
+
+		m_Width = width;
+		m_Height = height;
+
+		m_Image = std::make_shared<SoftwareImage>();
+		m_Image->Width = m_Width;
+		m_Image->Height = m_Height;
+		m_Image->Pixels.assign(static_cast<size_t>(m_Width) * static_cast<size_t>(m_Height), 0);
+
+		return true;
+	}
+
+	bool TextureSoftware::InitializePixels(std::int32_t width, std::int32_t height, const std::uint32_t *pixels)
+	{
+		SetAlphaOnly(false);
+
+		// Software render targets are plain images as well
+		if (!InitializeRenderTarget(width, height))
+		{
+			return false;
+		}
+
+		// A new image isn't used by pending draw commands, so it can be filled directly
+		if (pixels)
+		{
+			m_Image->Pixels.assign(pixels, pixels + static_cast<size_t>(m_Width) * static_cast<size_t>(m_Height));
+		}
+
+		return true;
+	}
+
+	bool TextureSoftware::UpdateRegion(std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const std::uint32_t *pixels)
+	{
+		if (!m_Image || !pixels || IsAlphaOnly() || !IsValidRegion(x, y, width, height))
+		{
+			return false;
+		}
+
+		FlushPendingReads();
+
+		for (std::int32_t row = 0; row < height; ++row)
+		{
+			std::memcpy(
+				m_Image->Pixels.data() + static_cast<size_t>(y + row) * m_Width + x,
+				pixels + static_cast<size_t>(row) * width,
+				width * sizeof(std::uint32_t));
+		}
+
+		return true;
+	}
+
+	bool TextureSoftware::InitializeAlpha(std::int32_t width, std::int32_t height, const std::uint8_t *alpha)
+	{
+		ReleaseResources();
+		SetAlphaOnly(true);
+
+		m_Width = width;
+		m_Height = height;
+
+		m_Image = std::make_shared<SoftwareImage>();
+		m_Image->Width = m_Width;
+		m_Image->Height = m_Height;
+
+		const size_t count = static_cast<size_t>(m_Width) * static_cast<size_t>(m_Height);
+		if (alpha)
+		{
+			m_Image->Alpha.assign(alpha, alpha + count);
+		}
+		else
+		{
+			m_Image->Alpha.assign(count, 0);
+		}
+
+		return true;
+	}
+
+	bool TextureSoftware::UpdateAlphaRegion(std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const std::uint8_t *alpha)
+	{
+		if (!m_Image || !alpha || !IsAlphaOnly() || !IsValidRegion(x, y, width, height))
+		{
+			return false;
+		}
+
+		FlushPendingReads();
+
+		for (std::int32_t row = 0; row < height; ++row)
+		{
+			std::memcpy(
+				m_Image->Alpha.data() + static_cast<size_t>(y + row) * m_Width + x,
+				alpha + static_cast<size_t>(row) * width,
+				width);
+		}
+
+		return true;
+	}
+
+	bool TextureSoftware::Set()
+	{
+		if (!m_Image)
+		{
+			return false;
+		}
+
+		g_Context->Software.Texture = m_Image;
+		return true;
+	}
+
+	void TextureSoftware::ReleaseResources()
+	{
+		// Draw commands which are still pending keep their own reference
+		m_Image.reset();
+	}
+
+	void TextureSoftware::FlushPendingReads()
+	{
+		// Pending draw commands read the pixels when they are executed, so they have to see the old contents
+		RenderTargetSoftware *target = g_Context->Software.ActiveTarget;
+		if (target && target->GetRasterizer().HasPendingCommands())
+		{
+			target->Flush();
+		}
+	}
+
+#ifndef K2D_NO_IMAGE_LOADER
+	bool TextureSoftware::InitializeImpl(ILuint &idImage)
+	{
+		// Save image informations
+		m_Width = ilGetInteger(IL_IMAGE_WIDTH);
+		m_Height = ilGetInteger(IL_IMAGE_HEIGHT);
+
+		// Convert to RGBA byte data
+		ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE);
+		unsigned char * pData = ilGetData();
+
+		// Premultiply alpha and bake the colorkey if requested
+		ApplyLoadOptions(pData, m_Width, m_Height);
+
+		// RGBA bytes are exactly the 0xAABBGGRR layout of software images
+		m_Image = std::make_shared<SoftwareImage>();
+		m_Image->Width = m_Width;
+		m_Image->Height = m_Height;
+		m_Image->Pixels.resize(static_cast<size_t>(m_Width) * static_cast<size_t>(m_Height));
+		std::memcpy(m_Image->Pixels.data(), pData, m_Image->Pixels.size() * sizeof(std::uint32_t));
+
+		// Memory cleanup
+		ilDeleteImages(1, &idImage);
+		idImage = 0;
+
+		return true;
+	}
+#endif
+}
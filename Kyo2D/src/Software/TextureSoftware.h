@@ -0,0 +1,65 @@
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "../Texture.h"
+#include "SoftwareDevice.h"
+#include "IL/il.h"
+
+namespace Kyo2D
+{
+	/// Software implementation of a texture, the pixels are kept in system memory.
+	class TextureSoftware : public Texture
+	{
+	public:
+
+		/// Default constructor.
+		TextureSoftware();
+		/// Destructor
+		virtual ~TextureSoftware();
+
+		/// @copydoc Texture::Initialize(const void *, size_t)
+		virtual bool Initialize(const void *data, size_t dataSize) override;
+		/// @copydoc Texture::Initialize(const std::wstring &)
+		virtual bool Initialize(const std::wstring &filename) override;
+		/// @copydoc Texture::InitializeRenderTarget(std::int32_t, std::int32_t)
+		virtual bool InitializeRenderTarget(std::int32_t width, std::int32_t height) override;
+		/// @copydoc Texture::InitializePixels(std::int32_t, std::int32_t, const std::uint32_t *)
+		virtual bool InitializePixels(std::int32_t width, std::int32_t height, const std::uint32_t *pixels) override;
+		/// @copydoc Texture::UpdateRegion(std::int32_t, std::int32_t, std::int32_t, std::int32_t, const std::uint32_t *)
+		virtual bool UpdateRegion(std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const std::uint32_t *pixels) override;
+		/// @copydoc Texture::InitializeAlpha(std::int32_t, std::int32_t, const std::uint8_t *)
+		virtual bool InitializeAlpha(std::int32_t width, std::int32_t height, const std::uint8_t *alpha) override;
+		/// @copydoc Texture::UpdateAlphaRegion(std::int32_t, std::int32_t, std::int32_t, std::int32_t, const std::uint8_t *)
+		virtual bool UpdateAlphaRegion(std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const std::uint8_t *alpha) override;
+		/// @copydoc Texture::Set()
+		virtual bool Set() override;
+
+		/// @copydoc Texture::GetWidth()
+		virtual std::int32_t GetWidth() const override { return m_Width; }
+		/// @copydoc Texture::GetHeight()
+		virtual std::int32_t GetHeight() const override { return m_Height; }
+		/// @copydoc Texture::IsResident()
+		virtual bool IsResident() const override { return m_Image != nullptr; }
+
+		/// Gets the pixels of this texture.
+		inline const std::shared_ptr<SoftwareImage> &GetImage() const { return m_Image; }
+
+	protected:
+
+		/// @copydoc Texture::ReleaseResources()
+		virtual void ReleaseResources() override;
+
+	private:
+
+		bool InitializeImpl(ILuint &idImage);
+		/// Executes the pending draw commands of the active target, which may still read the old contents.
+		void FlushPendingReads();
+
+	private:
+
+		std::shared_ptr<SoftwareImage> m_Image;
+		std::int32_t m_Width, m_Height;
+	};
+}
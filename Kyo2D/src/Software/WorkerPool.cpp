@@ -0,0 +1,111 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+namespace Kyo2D
+{
+	WorkerPool::WorkerPool()
+		: m_Job(nullptr)
+		, m_JobCount(0)
+		, m_NextIndex(0)
+		, m_Generation(0)
+		, m_Busy(0)
+		, m_Quit(false)
+	{
+	}
+
+	WorkerPool::~WorkerPool()
+	{
+		Shutdown();
+	}
+
+	void WorkerPool::Initialize(std::uint32_t threadCount)
+	{
+		Shutdown();
+
+		if (threadCount == 0)
+			threadCount = std::max<std::uint32_t>(1, std::thread::hardware_concurrency());
+
+		m_Quit = false;
+		for (std::uint32_t i = 1; i < threadCount; ++i)
+			m_Threads.emplace_back(&WorkerPool::WorkerMain, this);
+	}
+
+	void WorkerPool::Shutdown()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Quit = true;
+		}
+		m_WakeCondition.notify_all();
+
+		for (auto &thread : m_Threads)
+			thread.join();
+		m_Threads.clear();
+	}
+
+	void WorkerPool::Run(std::uint32_t count, const std::function<void(std::uint32_t)> &job)
+	{
+		if (count == 0)
+			return;
+
+		// Not worth waking anybody up
+		if (m_Threads.empty() || count == 1)
+		{
+			for (std::uint32_t i = 0; i < count; ++i)
+				job(i);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Job = &job;
+			m_JobCount = count;
+			m_NextIndex = 0;
+			m_Busy = static_cast<std::uint32_t>(m_Threads.size());
+			++m_Generation;
+		}
+		m_WakeCondition.notify_all();
+
+		// Help out, then wait for the workers to finish their last index
+		Work();
+
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_DoneCondition.wait(lock, [this] { return m_Busy == 0; });
+		m_Job = nullptr;
+	}
+
+	void WorkerPool::WorkerMain()
+	{
+		std::uint32_t generation = 0;
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_WakeCondition.wait(lock, [this, generation] { return m_Quit || m_Generation != generation; });
+				if (m_Quit)
+					return;
+				generation = m_Generation;
+			}
+
+			Work();
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				--m_Busy;
+			}
+			m_DoneCondition.notify_one();
+		}
+	}
+
+	void WorkerPool::Work()
+	{
+		for (;;)
+		{
+			std::uint32_t index = m_NextIndex.fetch_add(1);
+			if (index >= m_JobCount)
+				break;
+
+			(*m_Job)(index);
+		}
+	}
+}
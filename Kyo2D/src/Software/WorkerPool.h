@@ -0,0 +1,60 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+namespace Kyo2D
+{
+	/// A fixed set of worker threads executing parallel for loops.
+	class WorkerPool
+	{
+	public:
+
+		/// Default constructor. Call Initialize to start the threads.
+		WorkerPool();
+		/// Destructor, stops all worker threads.
+		~WorkerPool();
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		/// Starts the worker threads.
+		/// @param threadCount Total number of threads working on a job, including the calling thread.
+		///		0 uses one thread per hardware thread.
+		void Initialize(std::uint32_t threadCount);
+		/// Stops all worker threads.
+		void Shutdown();
+
+		/// Calls job(index) for every index in [0, count) and waits until all calls returned.
+		/// The calls are distributed over the worker threads and the calling thread.
+		void Run(std::uint32_t count, const std::function<void(std::uint32_t)> &job);
+
+		/// Gets the total number of threads working on a job, including the calling thread.
+		inline std::uint32_t GetThreadCount() const { return static_cast<std::uint32_t>(m_Threads.size()) + 1; }
+
+	private:
+
+		/// Worker thread main loop.
+		void WorkerMain();
+		/// Processes indices of the current job until none are left.
+		void Work();
+
+	private:
+
+		std::vector<std::thread> m_Threads;
+		std::mutex m_Mutex;
+		std::condition_variable m_WakeCondition;
+		std::condition_variable m_DoneCondition;
+		const std::function<void(std::uint32_t)> *m_Job;
+		std::uint32_t m_JobCount;
+		std::atomic<std::uint32_t> m_NextIndex;
+		std::uint32_t m_Generation;
+		std::uint32_t m_Busy;
+		bool m_Quit;
+	};
+}
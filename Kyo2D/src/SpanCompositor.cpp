@@ -0,0 +1,71 @@
+#include "SpanCompositor.h"
+#include <algorithm>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#	define K2D_SPANS_SSE2 1
+#	include <emmintrin.h>
+#else
+#	define K2D_SPANS_SSE2 0
+#endif
+
+namespace Kyo2D
+{
+	void SpanCompositor::FillCoverage(const Target &target, const Spans &spans, std::uint8_t *image)
+	{
+		for (const Span &span : spans)
+		{
+			std::uint8_t *row = image + static_cast<size_t>(target.Top - span.y) * target.Width + (span.x - target.Left);
+			std::fill_n(row, span.width, static_cast<std::uint8_t>(span.coverage));
+		}
+	}
+
+	void SpanCompositor::FillColor(const Target &target, const Spans &spans, std::uint32_t color, std::uint32_t *image)
+	{
+		color &= 0x00FFFFFF;
+		for (const Span &span : spans)
+		{
+			std::uint32_t *row = image + static_cast<size_t>(target.Top - span.y) * target.Width + (span.x - target.Left);
+			std::fill_n(row, span.width, color | (static_cast<std::uint32_t>(span.coverage) << 24));
+		}
+	}
+
+	void SpanCompositor::BlendWhite(const Target &target, const Spans &spans, std::uint32_t *image)
+	{
+#if K2D_SPANS_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i full = _mm_set1_epi16(255);
+		const __m128i reciprocal = _mm_set1_epi16(static_cast<short>(0x8081));
+		const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+#endif
+
+		for (const Span &span : spans)
+		{
+			std::uint32_t *row = image + static_cast<size_t>(target.Top - span.y) * target.Width + (span.x - target.Left);
+			const std::uint32_t coverage = static_cast<std::uint32_t>(span.coverage);
+			int x = 0;
+
+#if K2D_SPANS_SSE2
+			// 4 pixels at a time with the channels widened to 16 bits, (255 - c) * a fits
+			const __m128i alpha16 = _mm_set1_epi16(static_cast<short>(coverage));
+			const __m128i alpha8 = _mm_set1_epi8(static_cast<char>(coverage));
+			for (; x + 4 <= span.width; x += 4)
+			{
+				const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+				__m128i low = _mm_unpacklo_epi8(pixels, zero);
+				__m128i high = _mm_unpackhi_epi8(pixels, zero);
+				low = _mm_add_epi16(low, _mm_srli_epi16(_mm_mulhi_epu16(_mm_mullo_epi16(_mm_sub_epi16(full, low), alpha16), reciprocal), 7));
+				high = _mm_add_epi16(high, _mm_srli_epi16(_mm_mulhi_epu16(_mm_mullo_epi16(_mm_sub_epi16(full, high), alpha16), reciprocal), 7));
+				const __m128i colors = _mm_packus_epi16(low, high);
+
+				// Alpha adds up with saturation
+				const __m128i alphas = _mm_adds_epu8(pixels, alpha8);
+				const __m128i result = _mm_or_si128(_mm_andnot_si128(alphaMask, colors), _mm_and_si128(alphaMask, alphas));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(row + x), result);
+			}
+#endif
+
+			for (; x < span.width; ++x)
+				row[x] = BlendWhitePixel(row[x], coverage);
+		}
+	}
+}
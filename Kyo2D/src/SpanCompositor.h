@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Kyo2D
+{
+	/// Draws the coverage spans of rasterized glyphs into glyph images. Spans are horizontal runs
+	/// of pixels with the same coverage, so each span is filled or blended as a whole, 4 pixels at
+	/// a time with SSE2. Blending uses integer arithmetic which gives the same results as blending
+	/// with floats and truncating.
+	class SpanCompositor
+	{
+	public:
+
+		/// A horizontal pixel span generated by the FreeType renderer.
+		struct Span
+		{
+			Span() { }
+			Span(int _x, int _y, int _width, int _coverage)
+				: x(_x), y(_y), width(_width), coverage(_coverage) { }
+
+			int x, y, width, coverage;
+		};
+
+		typedef std::vector<Span> Spans;
+
+		/// Position of a glyph image relative to its spans. Span rows run bottom to top, images top to bottom.
+		struct Target
+		{
+			/// Width of the image in pixels.
+			std::int32_t Width;
+			/// Span column of the left edge of the image.
+			std::int32_t Left;
+			/// Span row of the top edge of the image.
+			std::int32_t Top;
+		};
+
+	public:
+
+		/// Writes the coverage of spans into a one byte per pixel image.
+		static void FillCoverage(const Target &target, const Spans &spans, std::uint8_t *image);
+		/// Writes spans of one color with the coverage as alpha into a 32 bit image.
+		/// @param color Color of the pixels, the alpha is ignored.
+		static void FillColor(const Target &target, const Spans &spans, std::uint32_t color, std::uint32_t *image);
+		/// Blends white spans over a 32 bit image. Each color channel moves towards 255 by the
+		/// coverage, alpha adds up to 255 at most.
+		static void BlendWhite(const Target &target, const Spans &spans, std::uint32_t *image);
+
+		/// Blends white over one pixel, BlendWhite uses it for the pixels it doesn't process with SSE2.
+		/// (x * 0x8081) >> 23 is x / 255 for x up to 65535, and c + (255 - c) * a / 255 truncated is
+		/// what blending in floats gives.
+		/// @param coverage Coverage of the white, 0 to 255.
+		static inline std::uint32_t BlendWhitePixel(std::uint32_t pixel, std::uint32_t coverage)
+		{
+			std::uint32_t result = 0;
+			for (std::uint32_t shift = 0; shift < 24; shift += 8)
+			{
+				const std::uint32_t channel = (pixel >> shift) & 0xFF;
+				result |= (channel + (((255 - channel) * coverage * 0x8081) >> 23)) << shift;
+			}
+
+			const std::uint32_t alpha = (pixel >> 24) + coverage;
+			return result | ((alpha < 255 ? alpha : 255) << 24);
+		}
+	};
+}
@@ -1,9 +1,8 @@
 
 #pragma once
 
-#include "DirectXMath.h"
 #include <cstdint>
-using namespace DirectX;
+#include "Matrix.h"
 
 namespace Kyo2D
 {
@@ -22,9 +21,19 @@ namespace Kyo2D
 		/// 
 		virtual bool Prepare() = 0;
 		///
-		virtual void SetViewMatrix(const XMMATRIX &ViewMatrix) = 0;
+		virtual void SetViewMatrix(const Matrix4 &ViewMatrix) = 0;
 		/// Enables or disables the Scale2X algorithm.
 		virtual void SetScale2XEnabled(bool Enable) = 0;
+		/// Switches between the colorkey pipeline (straight alpha) and the premultiplied alpha
+		/// pipeline, which skips the colorkey test. Takes effect on the next Prepare call.
+		virtual void SetPremultipliedAlpha(bool Enable) = 0;
+		/// Switches to the pipeline for alpha-only textures, which draws the vertex color with the
+		/// texture as alpha. Overrides Scale2X and the premultiplied pipeline. Takes effect on the next Prepare call.
+		virtual void SetAlphaTexture(bool Enable) = 0;
+		/// Switches to the pipeline for distance field textures: the vertex color is drawn where the
+		/// filtered distance passes the threshold in the red channel of the colorkey, with a smooth
+		/// edge of the width in its green channel. Takes effect on the next Prepare call.
+		virtual void SetDistanceField(bool Enable) = 0;
 
 	public:
 
@@ -43,5 +52,11 @@ namespace Kyo2D
 
 		/// Determins whether Scale2X is enabled.
 		virtual bool IsScale2XEnabled() const = 0;
+		/// Determines whether the premultiplied alpha pipeline is active.
+		virtual bool IsPremultipliedAlpha() const = 0;
+		/// Determines whether the alpha-only texture pipeline is active.
+		virtual bool IsAlphaTexture() const = 0;
+		/// Determines whether the distance field pipeline is active.
+		virtual bool IsDistanceField() const = 0;
 	};
 }
@@ -0,0 +1,240 @@
+#include "TextDocument.h"
+#include "EngineContext.h"
+#include <algorithm>
+
+namespace
+{
+	/// Appends a codepoint to a UTF-8 string.
+	void AppendUtf8(std::string &text, std::uint32_t codepoint)
+	{
+		if (codepoint < 0x80)
+		{
+			text += static_cast<char>(codepoint);
+		}
+		else if (codepoint < 0x800)
+		{
+			text += static_cast<char>(0xC0 | (codepoint >> 6));
+			text += static_cast<char>(0x80 | (codepoint & 0x3F));
+		}
+		else if (codepoint < 0x10000)
+		{
+			text += static_cast<char>(0xE0 | (codepoint >> 12));
+			text += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+			text += static_cast<char>(0x80 | (codepoint & 0x3F));
+		}
+		else
+		{
+			text += static_cast<char>(0xF0 | (codepoint >> 18));
+			text += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+			text += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+			text += static_cast<char>(0x80 | (codepoint & 0x3F));
+		}
+	}
+}
+
+namespace Kyo2D
+{
+	TextDocument::TextDocument()
+		: m_Scale(1.0f)
+		, m_WrapWidth(0.0f)
+		, m_ParagraphSpacing(0.0f)
+		, m_Colorkey(0)
+		, m_LastOpen(false)
+		, m_Tops(1, 0.0)
+		, m_DrawCount(0)
+		, m_AtlasGeneration(0)
+	{
+	}
+
+	TextDocument::~TextDocument()
+	{
+	}
+
+	void TextDocument::Initialize(std::shared_ptr<Font> font, float scale, float wrapWidth, float paragraphSpacing)
+	{
+		m_Font = std::move(font);
+		m_Scale = scale > 0.0f ? scale : 1.0f;
+		m_WrapWidth = std::max<float>(wrapWidth, 0.0f);
+		m_ParagraphSpacing = std::max<float>(paragraphSpacing, 0.0f);
+		m_Colorkey = m_Font->getFillColorkey(m_Scale);
+		Clear();
+	}
+
+	void TextDocument::Append(const TextView &text)
+	{
+		if (!m_Font)
+			return;
+
+		// The last paragraph is broken into lines whenever it ends or the text runs out
+		bool changed = false;
+		TextReader reader(text);
+		std::uint32_t codepoint;
+		while (reader.Next(codepoint))
+		{
+			if (!m_LastOpen)
+			{
+				Paragraph paragraph = { m_Text.size(), static_cast<std::uint32_t>(m_LineEnds.size()), 0 };
+				m_Paragraphs.push_back(paragraph);
+				m_LastOpen = true;
+				changed = true;
+			}
+
+			if (codepoint == '\n')
+			{
+				if (changed)
+					layoutLastParagraph();
+				m_LastOpen = false;
+				changed = false;
+				continue;
+			}
+
+			AppendUtf8(m_Text, codepoint);
+			changed = true;
+		}
+
+		if (changed)
+			layoutLastParagraph();
+	}
+
+	void TextDocument::Clear()
+	{
+		m_Text.clear();
+		m_Paragraphs.clear();
+		m_LastOpen = false;
+		m_LineEnds.clear();
+		m_Tops.assign(1, 0.0);
+		m_LineQuads.clear();
+	}
+
+	void TextDocument::Draw(float x, float y, double top, float height, std::uint32_t color)
+	{
+		if (!m_Font || m_Paragraphs.empty())
+			return;
+
+		if (m_AtlasGeneration != g_Context->Glyphs.GetGeneration())
+		{
+			m_LineQuads.clear();
+			m_AtlasGeneration = g_Context->Glyphs.GetGeneration();
+		}
+
+		++m_DrawCount;
+		const double lineSpacing = m_Font->getLineSpacing(m_Scale);
+
+		size_t first, end;
+		GetVisibleLines(top, height, first, end);
+
+		// The paragraph of the first line is the last one starting at or before it
+		size_t i = 0;
+		if (first < end)
+		{
+			i = std::upper_bound(m_Paragraphs.begin(), m_Paragraphs.end(), first, [](size_t line, const Paragraph &paragraph)
+			{
+				return line < paragraph.FirstLine;
+			}) - m_Paragraphs.begin() - 1;
+		}
+
+		for (size_t line = first; line < end; ++line)
+		{
+			while (line >= m_Paragraphs[i].FirstLine + m_Paragraphs[i].LineCount)
+				++i;
+
+			const Paragraph &paragraph = m_Paragraphs[i];
+			const size_t index = line - paragraph.FirstLine;
+			const double lineTop = m_Tops[i] + index * lineSpacing;
+			const size_t lineStart = index > 0 ? m_LineEnds[line - 1] : 0;
+			const size_t lineEnd = m_LineEnds[line];
+			const std::vector<GlyphQuad> &quads = getLineQuads(line, paragraph.TextStart + lineStart, paragraph.TextStart + lineEnd);
+			Font::drawGlyphs(quads, Vector2(x, static_cast<float>(y + (lineTop - top))), color, m_Colorkey);
+		}
+
+		// Lines which scrolled out of the range are laid out again when they come back
+		for (auto it = m_LineQuads.begin(); it != m_LineQuads.end(); )
+		{
+			if (it->second.LastDrawn != m_DrawCount)
+				it = m_LineQuads.erase(it);
+			else
+				++it;
+		}
+	}
+
+	void TextDocument::GetVisibleLines(double top, float height, size_t &first, size_t &end) const
+	{
+		first = 0;
+		end = 0;
+		if (!m_Font || m_Paragraphs.empty())
+			return;
+
+		const double lineSpacing = m_Font->getLineSpacing(m_Scale);
+		const double bottom = top + height;
+
+		// The last paragraph starting at or above the range is the first one reaching into it
+		const size_t count = m_Paragraphs.size();
+		size_t i = std::upper_bound(m_Tops.begin(), m_Tops.begin() + count, top) - m_Tops.begin();
+		if (i > 0)
+			--i;
+
+		// Lines have the same height, so the first visible one is found by division
+		size_t line = 0;
+		if (top > m_Tops[i])
+			line = std::min<size_t>(static_cast<size_t>((top - m_Tops[i]) / lineSpacing), m_Paragraphs[i].LineCount);
+		first = m_Paragraphs[i].FirstLine + line;
+		end = first;
+
+		for (; i < count && m_Tops[i] < bottom; ++i)
+		{
+			const Paragraph &paragraph = m_Paragraphs[i];
+			for (; line < paragraph.LineCount && m_Tops[i] + line * lineSpacing < bottom; ++line)
+				end = paragraph.FirstLine + line + 1;
+			line = 0;
+		}
+	}
+
+	void TextDocument::layoutLastParagraph()
+	{
+		Paragraph &paragraph = m_Paragraphs.back();
+
+		// Lines of the paragraph may have been drawn with other breaks
+		for (auto it = m_LineQuads.begin(); it != m_LineQuads.end(); )
+		{
+			if (it->first >= paragraph.FirstLine)
+				it = m_LineQuads.erase(it);
+			else
+				++it;
+		}
+
+		// A paragraph can't have more lines than code units
+		const size_t length = m_Text.size() - paragraph.TextStart;
+		m_LineEnds.resize(paragraph.FirstLine);
+		if (m_WrapWidth > 0.0f && length > 0)
+		{
+			m_LineEnds.resize(paragraph.FirstLine + length + 1);
+			const size_t lines = m_Font->wrapText(TextView(m_Text.data() + paragraph.TextStart, length), m_WrapWidth, m_Scale,
+				m_LineEnds.data() + paragraph.FirstLine, length + 1);
+			m_LineEnds.resize(paragraph.FirstLine + lines);
+		}
+		else
+		{
+			m_LineEnds.push_back(static_cast<std::uint32_t>(length));
+		}
+		paragraph.LineCount = static_cast<std::uint32_t>(m_LineEnds.size() - paragraph.FirstLine);
+
+		// The top of the paragraph stays, the height of the document follows it
+		const double top = m_Tops[m_Paragraphs.size() - 1];
+		m_Tops.resize(m_Paragraphs.size());
+		m_Tops.push_back(top + paragraph.LineCount * static_cast<double>(m_Font->getLineSpacing(m_Scale)) + m_ParagraphSpacing);
+	}
+
+	const std::vector<GlyphQuad> &TextDocument::getLineQuads(size_t line, size_t textStart, size_t textEnd)
+	{
+		LineQuads &entry = m_LineQuads[line];
+		if (entry.LastDrawn == 0)
+		{
+			const TextView text(m_Text.data() + textStart, textEnd - textStart);
+			m_Font->prepareGlyphs(text);
+			m_Font->layoutGlyphs(text, m_Scale, entry.Quads);
+		}
+
+		entry.LastDrawn = m_DrawCount;
+		return entry.Quads;
+	}
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Font.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace Kyo2D
+{
+	/// A long text made of paragraphs, e.g. the contents of a log or chat window. The text is
+	/// broken into lines once when it is appended, and the tops of the paragraphs are kept as
+	/// prefix sums, so drawing finds the visible paragraphs by binary search and only lays out
+	/// the glyphs of the lines which scroll into view.
+	class TextDocument
+	{
+	public:
+
+		/// Default constructor.
+		TextDocument();
+		/// Destructor.
+		~TextDocument();
+
+		TextDocument(const TextDocument&) = delete;
+		TextDocument& operator=(const TextDocument&) = delete;
+
+		/// Initializes an empty document.
+		/// @param font The font of the text. The document keeps it alive.
+		/// @param scale Scaling parameter which is multiplied with the size of the font.
+		/// @param wrapWidth Lines are wrapped at this width in pixels, 0 disables wrapping.
+		/// @param paragraphSpacing Additional space in pixels below each paragraph.
+		void Initialize(std::shared_ptr<Font> font, float scale, float wrapWidth, float paragraphSpacing);
+		/// Appends text. Newlines end paragraphs, text after the last newline continues the last
+		/// paragraph with the next append. Only the last paragraph and the new ones are broken into lines.
+		void Append(const TextView &text);
+		/// Removes all text.
+		void Clear();
+		/// Draws the lines of the document inside a vertical range.
+		/// @param x Position of the left edge of the document on screen.
+		/// @param y Position on screen the top of the range is drawn at.
+		/// @param top Top of the range in the document.
+		/// @param height Height of the range.
+		void Draw(float x, float y, double top, float height, std::uint32_t color);
+
+		/// Gets the lines Draw draws for a vertical range: the lines whose tops are inside it, and the
+		/// line reaching into it from above.
+		/// @param top Top of the range in the document.
+		/// @param height Height of the range.
+		/// @param first Receives the index of the first line.
+		/// @param end Receives the index after the last line, equal to first if no line is in the range.
+		void GetVisibleLines(double top, float height, size_t &first, size_t &end) const;
+
+		/// Gets the height of the document in pixels.
+		inline double GetHeight() const { return m_Tops.back(); }
+		/// Gets the number of lines after wrapping.
+		inline size_t GetLineCount() const { return m_LineEnds.size(); }
+		/// Gets the number of paragraphs.
+		inline size_t GetParagraphCount() const { return m_Paragraphs.size(); }
+
+	private:
+
+		/// A paragraph, the text between two newlines.
+		struct Paragraph
+		{
+			/// Position of the text in m_Text.
+			size_t TextStart;
+			/// Index of the first line in m_LineEnds.
+			std::uint32_t FirstLine;
+			std::uint32_t LineCount;
+		};
+
+		/// Glyph quads of a line which has been drawn.
+		struct LineQuads
+		{
+			LineQuads() : LastDrawn(0) { }
+
+			std::vector<GlyphQuad> Quads;
+			/// Draw call the line was drawn by last.
+			std::uint64_t LastDrawn;
+		};
+
+	private:
+
+		/// Breaks the last paragraph into lines again after text has been added to it.
+		void layoutLastParagraph();
+		/// Gets the glyph quads of a line, laying them out if the line hasn't been visible before.
+		const std::vector<GlyphQuad> &getLineQuads(size_t line, size_t textStart, size_t textEnd);
+
+	private:
+
+		std::shared_ptr<Font> m_Font;
+		float m_Scale;
+		float m_WrapWidth;
+		float m_ParagraphSpacing;
+		/// Colorkey of the fill color, see Font::getFillColorkey.
+		std::uint32_t m_Colorkey;
+		/// The text as UTF-8 without the newlines.
+		std::string m_Text;
+		std::vector<Paragraph> m_Paragraphs;
+		/// Determines whether the last paragraph continues with the next append.
+		bool m_LastOpen;
+		/// End of each line relative to the start of its paragraph text.
+		std::vector<std::uint32_t> m_LineEnds;
+		/// Top of each paragraph, followed by the height of the document. Kept as double, since
+		/// a float can't address single pixels below 16 million.
+		std::vector<double> m_Tops;
+		/// Quads of the lines drawn by the last draw call, by line index.
+		std::unordered_map<size_t, LineQuads> m_LineQuads;
+		/// Number of draw calls.
+		std::uint64_t m_DrawCount;
+		/// Generation of the glyph atlas the quads point into.
+		std::uint32_t m_AtlasGeneration;
+	};
+}
@@ -3,6 +3,8 @@
 
 namespace Kyo2D
 {
+	const std::uint32_t TextDrawer::MaxGlyphsPerBatch;
+
 	TextDrawer::TextDrawer()
 	{
 	}
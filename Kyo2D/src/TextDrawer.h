@@ -1,11 +1,34 @@
-
 #pragma once
 
+#include <cstdint>
+#include <cstddef>
+#include "Matrix.h"
+
 namespace Kyo2D
 {
-	/// Base class for text rendering.
+	/// A glyph image placed in a line of text.
+	struct GlyphQuad
+	{
+		/// Id of the atlas texture holding the glyph image.
+		std::uint32_t TextureId;
+		/// Area on screen, relative to the position of the text until the text is submitted.
+		float X, Y, W, H;
+		/// Area of the glyph image in the atlas texture.
+		float SrcX, SrcY, SrcW, SrcH;
+		/// Entry of the glyph in the atlas, marked as used when the quad is submitted.
+		std::uint32_t AtlasEntry;
+	};
+
+	/// Base class for text rendering. Glyphs are unrotated quads in screen space, so the text drawer
+	/// writes them straight into a vertex stream without a matrix per glyph and draws all glyphs of
+	/// an atlas page with one draw call.
 	class TextDrawer
 	{
+	public:
+
+		/// Number of glyphs drawn with one draw call at most, longer runs are split.
+		static const std::uint32_t MaxGlyphsPerBatch = 2048;
+
 	public:
 
 		/// Default constructor.
@@ -13,6 +36,34 @@ namespace Kyo2D
 		/// Destructor.
 		virtual ~TextDrawer();
 
+		/// Creates the resources of the text pipeline.
+		virtual bool Initialize() = 0;
+		/// Binds the text pipeline for the page kind selected with SetAlphaTexture and SetDistanceField.
+		virtual bool Prepare() = 0;
+		/// Sets the view matrix of the active render target.
+		virtual void SetViewMatrix(const Matrix4 &ViewMatrix) = 0;
+		/// Switches to the pipeline for alpha-only pages, which draws the vertex color with the
+		/// texture as alpha. Takes effect on the next Prepare call.
+		virtual void SetAlphaTexture(bool Enable) = 0;
+		/// Switches to the pipeline for distance field pages (see SpriteDrawer::SetDistanceField).
+		/// Takes effect on the next Prepare call.
+		virtual void SetDistanceField(bool Enable) = 0;
+
+	public:
+
+		/// Draws glyphs of the bound atlas page.
+		/// @param texW Width of the page in pixels.
+		/// @param texH Height of the page in pixels.
+		/// @param quads The glyphs in screen coordinates.
+		/// @param count Number of glyphs.
+		/// @param colorkey Holds threshold and smoothing on distance field pages.
+		virtual void DrawGlyphs(std::int32_t texW, std::int32_t texH, const GlyphQuad *quads, size_t count, std::uint32_t color, std::uint32_t colorkey) = 0;
+
+	public:
 
+		/// Determines whether the alpha-only page pipeline is active.
+		virtual bool IsAlphaTexture() const = 0;
+		/// Determines whether the distance field pipeline is active.
+		virtual bool IsDistanceField() const = 0;
 	};
 }
@@ -0,0 +1,139 @@
+#include "TextLayout.h"
+#include "EngineContext.h"
+#include "Hash.h"
+
+namespace Kyo2D
+{
+	const std::uint32_t TextLayoutCache::MaxAge;
+
+	//=============================================================================
+	// TextLayout
+	//=============================================================================
+
+	TextLayout::TextLayout()
+		: m_Scale(1.0f)
+		, m_Width(0.0f)
+		, m_Colorkey(0)
+		, m_AtlasGeneration(0)
+	{
+	}
+
+	TextLayout::~TextLayout()
+	{
+	}
+
+	void TextLayout::Initialize(std::shared_ptr<Font> font, const TextView &text, float scale)
+	{
+		m_Font = std::move(font);
+
+		m_Text.clear();
+		m_Text.reserve(text.Length);
+		TextReader reader(text);
+		std::uint32_t codepoint;
+		while (reader.Next(codepoint))
+			m_Text += static_cast<char32_t>(codepoint);
+
+		m_Scale = scale > 0.0f ? scale : 1.0f;
+		m_Colorkey = m_Font->getFillColorkey(m_Scale);
+		Update();
+	}
+
+	void TextLayout::Draw(float x, float y, std::uint32_t color)
+	{
+		if (!m_Font)
+			return;
+
+		if (m_AtlasGeneration != g_Context->Glyphs.GetGeneration())
+			Update();
+
+		Font::drawGlyphs(m_Quads, Vector2(x, y), color, m_Colorkey);
+	}
+
+	void TextLayout::Update()
+	{
+		m_Font->prepareGlyphs(m_Text);
+		m_Width = m_Font->layoutGlyphs(m_Text, m_Scale, m_Quads);
+		m_AtlasGeneration = g_Context->Glyphs.GetGeneration();
+	}
+
+	//=============================================================================
+	// TextLayoutCache
+	//=============================================================================
+
+	TextLayoutCache::TextLayoutCache()
+		: m_Frame(0)
+	{
+	}
+
+	TextLayoutCache::~TextLayoutCache()
+	{
+	}
+
+	TextLayout &TextLayoutCache::Get(std::uint32_t fontId, const std::shared_ptr<Font> &font, const TextView &text)
+	{
+		const std::uint64_t key = Hash(text.Data, text.GetSize(), Hash(&fontId, sizeof(fontId)));
+
+		auto range = m_Entries.equal_range(key);
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			Entry &entry = it->second;
+			if (entry.FontId == fontId && Equals(entry.Layout->GetText(), text))
+			{
+				entry.LastUsed = m_Frame;
+				return *entry.Layout;
+			}
+		}
+
+		Entry entry;
+		entry.FontId = fontId;
+		entry.Layout.reset(new TextLayout());
+		entry.Layout->Initialize(font, text, 1.0f);
+		entry.LastUsed = m_Frame;
+		return *m_Entries.emplace(key, std::move(entry))->second.Layout;
+	}
+
+	void TextLayoutCache::EndFrame()
+	{
+		for (auto it = m_Entries.begin(); it != m_Entries.end(); )
+		{
+			if (m_Frame - it->second.LastUsed >= MaxAge)
+				it = m_Entries.erase(it);
+			else
+				++it;
+		}
+
+		++m_Frame;
+	}
+
+	void TextLayoutCache::RemoveFont(std::uint32_t fontId)
+	{
+		for (auto it = m_Entries.begin(); it != m_Entries.end(); )
+		{
+			if (it->second.FontId == fontId)
+				it = m_Entries.erase(it);
+			else
+				++it;
+		}
+	}
+
+	void TextLayoutCache::Clear()
+	{
+		m_Entries.clear();
+		m_Frame = 0;
+	}
+
+	bool TextLayoutCache::Equals(const std::u32string &codepoints, const TextView &text)
+	{
+		TextReader reader(text);
+		std::uint32_t codepoint;
+		size_t count = 0;
+		while (reader.Next(codepoint))
+		{
+			if (count >= codepoints.size() || codepoints[count] != codepoint)
+				return false;
+			++count;
+		}
+
+		return count == codepoints.size();
+	}
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "Font.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace Kyo2D
+{
+	/// A line of text laid out once with a font. Looks up the glyphs of the text when it is created
+	/// and keeps the resulting glyph quads, so drawing it only submits the quads. The quads are
+	/// laid out again if the glyph atlas has been cleared since.
+	class TextLayout
+	{
+	public:
+
+		/// Default constructor.
+		TextLayout();
+		/// Destructor.
+		~TextLayout();
+
+		TextLayout(const TextLayout&) = delete;
+		TextLayout& operator=(const TextLayout&) = delete;
+
+		/// Lays out a text, rasterizing the glyphs which have no image yet.
+		/// @param font The font of the text. The layout keeps it alive.
+		/// @param text The text, which is copied as codepoints.
+		/// @param scale Scaling parameter which is multiplied with the size of the font.
+		void Initialize(std::shared_ptr<Font> font, const TextView &text, float scale);
+		/// Draws the text at the given position.
+		void Draw(float x, float y, std::uint32_t color);
+
+		/// Gets the advance of the text in pixels.
+		inline float GetWidth() const { return m_Width; }
+		/// Gets the height of the text line in pixels.
+		inline float GetHeight() const { return m_Font ? m_Font->getHeight(m_Scale) : 0.0f; }
+		/// Gets the codepoints of the text of the layout.
+		inline const std::u32string &GetText() const { return m_Text; }
+
+	private:
+
+		/// Lays out the text again after the glyph atlas has been cleared.
+		void Update();
+
+	private:
+
+		std::shared_ptr<Font> m_Font;
+		std::u32string m_Text;
+		float m_Scale;
+		float m_Width;
+		/// Colorkey of the fill color, see Font::getFillColorkey.
+		std::uint32_t m_Colorkey;
+		std::vector<GlyphQuad> m_Quads;
+		/// Generation of the glyph atlas the quads point into.
+		std::uint32_t m_AtlasGeneration;
+	};
+
+	/// Layouts of the texts drawn with the immediate api (K2D_DrawText). A text drawn every frame
+	/// is laid out once and drawn from its layout afterwards. Layouts which haven't been drawn
+	/// for a number of frames are dropped.
+	class TextLayoutCache
+	{
+	public:
+
+		/// Number of presented frames a layout is kept without being drawn.
+		static const std::uint32_t MaxAge = 60;
+
+	public:
+
+		/// Default constructor.
+		TextLayoutCache();
+		/// Destructor.
+		~TextLayoutCache();
+
+		TextLayoutCache(const TextLayoutCache&) = delete;
+		TextLayoutCache& operator=(const TextLayoutCache&) = delete;
+
+		/// Gets the layout of a text, creating it if the text isn't cached yet.
+		/// Looking up a cached text doesn't allocate memory.
+		/// @param fontId Id of the font, used as part of the key.
+		TextLayout &Get(std::uint32_t fontId, const std::shared_ptr<Font> &font, const TextView &text);
+		/// Drops the layouts which haven't been used for MaxAge frames. Call once per presented frame.
+		void EndFrame();
+		/// Drops the layouts of a font.
+		void RemoveFont(std::uint32_t fontId);
+		/// Drops all layouts.
+		void Clear();
+
+		/// Gets the number of cached layouts.
+		inline size_t GetSize() const { return m_Entries.size(); }
+
+	private:
+
+		/// Determines whether a text consists of the given codepoints.
+		static bool Equals(const std::u32string &codepoints, const TextView &text);
+
+	private:
+
+		/// A cached layout and the frame it was last used in.
+		struct Entry
+		{
+			std::uint32_t FontId;
+			std::unique_ptr<TextLayout> Layout;
+			std::uint64_t LastUsed;
+		};
+
+	private:
+
+		/// Layouts by hash of font id and text. Texts with the same hash share a bucket. The hash is
+		/// taken over the code units, so a text drawn in two encodings is cached twice.
+		std::unordered_multimap<std::uint64_t, Entry> m_Entries;
+		std::uint64_t m_Frame;
+	};
+}
@@ -0,0 +1,124 @@
+#include "TextView.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#	define K2D_TEXT_SSE2 1
+#	include <emmintrin.h>
+#	ifdef _MSC_VER
+#		include <intrin.h>
+#	endif
+#else
+#	define K2D_TEXT_SSE2 0
+#endif
+
+namespace Kyo2D
+{
+	const std::uint32_t TextReader::ReplacementCharacter;
+
+	size_t TextReader::CountAscii(const std::uint8_t *text, size_t length)
+	{
+		size_t count = 0;
+
+#if K2D_TEXT_SSE2
+		// The sign bits of 16 bytes at once, all clear while the bytes are ASCII. The lowest set
+		// bit is the first non-ASCII byte, so short runs cost a single load as well.
+		while (count + 16 <= length)
+		{
+			const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + count));
+			const unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(bytes));
+			if (mask != 0)
+			{
+#ifdef _MSC_VER
+				unsigned long first;
+				_BitScanForward(&first, mask);
+				return count + first;
+#else
+				return count + static_cast<size_t>(__builtin_ctz(mask));
+#endif
+			}
+			count += 16;
+		}
+#endif
+
+		while (count < length && text[count] < 0x80)
+			++count;
+
+		return count;
+	}
+
+	std::uint32_t TextReader::decodeUtf8(const std::uint8_t *bytes, size_t available, size_t &out_length)
+	{
+		const std::uint32_t lead = bytes[0];
+
+		// Length and smallest codepoint of the sequence. Continuation bytes can't start one, C0 and
+		// C1 could only start overlong forms.
+		size_t length;
+		std::uint32_t codepoint, minimum;
+		if (lead < 0xC2)
+		{
+			out_length = 1;
+			return ReplacementCharacter;
+		}
+		else if (lead < 0xE0)
+		{
+			length = 2;
+			codepoint = lead & 0x1F;
+			minimum = 0x80;
+		}
+		else if (lead < 0xF0)
+		{
+			length = 3;
+			codepoint = lead & 0x0F;
+			minimum = 0x800;
+		}
+		else if (lead < 0xF5)
+		{
+			length = 4;
+			codepoint = lead & 0x07;
+			minimum = 0x10000;
+		}
+		else
+		{
+			out_length = 1;
+			return ReplacementCharacter;
+		}
+
+		// A truncated sequence is skipped up to the first byte which doesn't continue it
+		for (size_t i = 1; i < length; ++i)
+		{
+			if (i >= available || (bytes[i] & 0xC0) != 0x80)
+			{
+				out_length = i;
+				return ReplacementCharacter;
+			}
+			codepoint = (codepoint << 6) | (bytes[i] & 0x3F);
+		}
+
+		out_length = length;
+		if (codepoint < minimum || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+			return ReplacementCharacter;
+
+		return codepoint;
+	}
+
+	std::uint32_t TextReader::decodeUtf16(const char16_t *units, size_t available, size_t &out_length)
+	{
+		const std::uint32_t unit = units[0];
+		out_length = 1;
+
+		if (unit < 0xD800 || unit > 0xDFFF)
+			return unit;
+
+		// A high surrogate followed by a low one, anything else is unpaired
+		if (unit <= 0xDBFF && available > 1)
+		{
+			const std::uint32_t low = units[1];
+			if (low >= 0xDC00 && low <= 0xDFFF)
+			{
+				out_length = 2;
+				return 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+			}
+		}
+
+		return ReplacementCharacter;
+	}
+}
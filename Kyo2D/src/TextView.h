@@ -0,0 +1,188 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace Kyo2D
+{
+	/// A text passed to the engine in one of the encodings of the api. The text isn't copied, its
+	/// codepoints are decoded while iterating over it with a TextReader.
+	struct TextView
+	{
+		/// Encoding of the code units.
+		enum Encoding : std::uint8_t
+		{
+			Utf8,
+			Utf16,
+			Utf32
+		};
+
+		/// Creates an empty text.
+		TextView()
+			: Data(nullptr), Length(0), Format(Utf32) { }
+		/// Creates a view of UTF-8 text.
+		TextView(const char *text, size_t length)
+			: Data(text), Length(text ? length : 0), Format(Utf8) { }
+		/// Creates a view of UTF-16 text.
+		TextView(const char16_t *text, size_t length)
+			: Data(text), Length(text ? length : 0), Format(Utf16) { }
+		/// Creates a view of UTF-32 text.
+		TextView(const char32_t *text, size_t length)
+			: Data(text), Length(text ? length : 0), Format(Utf32) { }
+		/// Creates a view of wide text, which is UTF-16 on Windows and UTF-32 elsewhere.
+		TextView(const wchar_t *text, size_t length)
+			: Data(text), Length(text ? length : 0), Format(sizeof(wchar_t) == 2 ? Utf16 : Utf32) { }
+		/// Creates a view of null-terminated wide text.
+		TextView(const wchar_t *text)
+			: TextView(text, text ? std::char_traits<wchar_t>::length(text) : 0) { }
+		/// Creates a view of a wide string. The string must outlive the view.
+		TextView(const std::wstring &text)
+			: TextView(text.data(), text.length()) { }
+		/// Creates a view of a UTF-32 string. The string must outlive the view.
+		TextView(const std::u32string &text)
+			: TextView(text.data(), text.length()) { }
+
+		/// Gets the size of the text in bytes.
+		inline size_t GetSize() const { return Length * (Format == Utf8 ? 1 : Format == Utf16 ? 2 : 4); }
+
+		/// The code units.
+		const void *Data;
+		/// Number of code units.
+		size_t Length;
+		/// Encoding of the code units.
+		Encoding Format;
+	};
+
+	/// Decodes the codepoints of a text one after another without allocating memory. Malformed
+	/// sequences (stray continuation bytes, overlong forms, unpaired surrogates) are decoded as
+	/// ReplacementCharacter. Runs of ASCII in UTF-8 text are found a word at a time, long ones 16
+	/// bytes at a time, and common 2 and 3 byte sequences are decoded inline.
+	class TextReader
+	{
+	public:
+
+		/// Codepoint returned for malformed sequences.
+		static const std::uint32_t ReplacementCharacter = 0xFFFD;
+
+	public:
+
+		/// Starts reading at the beginning of a text.
+		explicit TextReader(const TextView &text)
+			: m_Data(text.Data), m_Length(text.Length), m_Position(0), m_AsciiEnd(0), m_Format(text.Format) { }
+
+		/// Decodes the next codepoint.
+		/// @return false at the end of the text.
+		inline bool Next(std::uint32_t &codepoint)
+		{
+			// Bytes of a known ASCII run are codepoints already, checked first as most text is ASCII
+			if (m_Position < m_AsciiEnd)
+			{
+				codepoint = static_cast<const std::uint8_t*>(m_Data)[m_Position++];
+				return true;
+			}
+
+			if (m_Position >= m_Length)
+				return false;
+
+			if (m_Format == TextView::Utf8)
+			{
+				const std::uint8_t *bytes = static_cast<const std::uint8_t*>(m_Data) + m_Position;
+				const size_t available = m_Length - m_Position;
+				const std::uint32_t lead = bytes[0];
+				if (lead < 0x80)
+				{
+					findAsciiRun(bytes, available);
+					codepoint = lead;
+					++m_Position;
+				}
+				else if (lead >= 0xC2 && lead < 0xE0 && available >= 2 && (bytes[1] & 0xC0) == 0x80)
+				{
+					// Well-formed 2 and 3 byte sequences are decoded here, the rest by decodeUtf8. Accented
+					// letters are mostly followed by ASCII, which is looked for right away.
+					codepoint = ((lead & 0x1F) << 6) | (bytes[1] & 0x3Fu);
+					m_Position += 2;
+					findAsciiRun(bytes + 2, available - 2);
+				}
+				else if (lead > 0xE0 && lead < 0xF0 && lead != 0xED && available >= 3 && (bytes[1] & 0xC0) == 0x80 && (bytes[2] & 0xC0) == 0x80)
+				{
+					// E0 may start overlong forms and ED surrogates, both are left to decodeUtf8
+					codepoint = ((lead & 0x0F) << 12) | ((bytes[1] & 0x3Fu) << 6) | (bytes[2] & 0x3Fu);
+					m_Position += 3;
+				}
+				else
+				{
+					size_t length;
+					codepoint = decodeUtf8(bytes, available, length);
+					m_Position += length;
+				}
+			}
+			else if (m_Format == TextView::Utf16)
+			{
+				size_t length;
+				codepoint = decodeUtf16(static_cast<const char16_t*>(m_Data) + m_Position, m_Length - m_Position, length);
+				m_Position += length;
+			}
+			else
+			{
+				codepoint = static_cast<const char32_t*>(m_Data)[m_Position++];
+				if (codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+					codepoint = ReplacementCharacter;
+			}
+			return true;
+		}
+
+		/// Gets the index of the code unit the next codepoint starts at.
+		inline size_t GetPosition() const { return m_Position; }
+
+		/// Counts the ASCII bytes at the start of a UTF-8 text.
+		static size_t CountAscii(const std::uint8_t *text, size_t length);
+
+	private:
+
+		/// Sets m_AsciiEnd to the end of the ASCII bytes at the start of a UTF-8 text. Short runs
+		/// are found in one 8 byte word, only longer ones go on with CountAscii. The bytes are
+		/// read in little-endian order, like on every platform of the engine.
+		inline void findAsciiRun(const std::uint8_t *bytes, size_t available)
+		{
+			if (available < 8)
+				return;
+
+			std::uint64_t word;
+			std::memcpy(&word, bytes, sizeof(word));
+			const std::uint64_t high = word & 0x8080808080808080ull;
+			const size_t start = static_cast<size_t>(bytes - static_cast<const std::uint8_t*>(m_Data));
+			if (high == 0)
+			{
+				m_AsciiEnd = start + CountAscii(bytes, available);
+			}
+			else
+			{
+				// The bits up to the first high bit keep bit 0 of each byte before it and of its own
+				// byte, the multiplication sums those bits into the top byte
+				const std::uint64_t below = ((high ^ (high - 1)) >> 7) & 0x0101010101010101ull;
+				m_AsciiEnd = start + static_cast<size_t>((below * 0x0101010101010101ull) >> 56) - 1;
+			}
+		}
+
+		// The decoders don't take the reader, so that its members can stay in registers
+
+		/// Decodes the UTF-8 sequence starting with a non-ASCII byte, including malformed ones.
+		/// @param out_length Receives the number of bytes consumed.
+		static std::uint32_t decodeUtf8(const std::uint8_t *bytes, size_t available, size_t &out_length);
+		/// Decodes a UTF-16 code unit or surrogate pair.
+		/// @param out_length Receives the number of code units consumed.
+		static std::uint32_t decodeUtf16(const char16_t *units, size_t available, size_t &out_length);
+
+	private:
+
+		const void *m_Data;
+		size_t m_Length;
+		/// Index of the next code unit.
+		size_t m_Position;
+		/// End of the UTF-8 bytes from m_Position on which are known to be ASCII.
+		size_t m_AsciiEnd;
+		TextView::Encoding m_Format;
+	};
+}
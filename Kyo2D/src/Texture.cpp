@@ -1,14 +1,171 @@
-
 #include "Texture.h"
+#include "Kyo2D.h"
 #include "IL/il.h"
+#include <cstring>
 
 namespace Kyo2D
 {
 	Texture::Texture()
+		: m_Premultiplied(false)
+		, m_AlphaOnly(false)
+		, m_DistanceField(false)
+		, m_BakeColorKey(false)
+		, m_ColorKey(0)
+		, m_LastUsedFrame(0)
+		, m_Version(0)
+		, m_PixelFormat(K2D_PIXEL_RGBA8)
 	{
 	}
 
 	Texture::~Texture()
 	{
 	}
+
+	std::uint64_t Texture::GetMemoryUsage() const
+	{
+		return static_cast<std::uint64_t>(GetWidth()) * static_cast<std::uint64_t>(GetHeight()) * (m_AlphaOnly ? 1 : 4);
+	}
+
+	bool Texture::IsValidRegion(std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height) const
+	{
+		return x >= 0 && y >= 0 && width > 0 && height > 0 &&
+			x + width <= GetWidth() && y + height <= GetHeight();
+	}
+
+	void Texture::KeepSource(const std::wstring &filename)
+	{
+		m_SourceFile = filename;
+		m_SourceData.clear();
+	}
+
+	void Texture::KeepSource(const void *data, size_t dataSize)
+	{
+		m_SourceFile.clear();
+		m_SourceData.assign(static_cast<const std::uint8_t*>(data), static_cast<const std::uint8_t*>(data) + dataSize);
+	}
+
+	void Texture::DiscardSource()
+	{
+		m_SourceFile.clear();
+		m_SourceData.clear();
+	}
+
+	bool Texture::Evict()
+	{
+		if (!IsEvictable())
+			return false;
+
+		ReleaseResources();
+		return true;
+	}
+
+	bool Texture::Restore()
+	{
+		if (IsResident())
+			return true;
+
+		// Reload from the remembered source. Load options are still set, so the
+		// restored texture matches the original one.
+		std::lock_guard<std::mutex> lock(GetLoaderMutex());
+		if (!m_SourceFile.empty())
+			return Initialize(m_SourceFile);
+		if (!m_SourceData.empty())
+			return Initialize(m_SourceData.data(), m_SourceData.size());
+
+		return false;
+	}
+
+	std::mutex &Texture::GetLoaderMutex()
+	{
+		static std::mutex loaderMutex;
+		return loaderMutex;
+	}
+
+	std::uint32_t Texture::GetPixelSize(std::uint32_t format)
+	{
+		switch (format)
+		{
+			case K2D_PIXEL_R8:
+			case K2D_PIXEL_A8:
+				return 1;
+			case K2D_PIXEL_RGBA8:
+			case K2D_PIXEL_BGRA8:
+				return 4;
+		}
+
+		return 0;
+	}
+
+	bool Texture::ConvertPixels(std::uint32_t format, const void *data, std::int32_t width, std::int32_t height, size_t stride, std::uint32_t *out)
+	{
+		if (!GetPixelSize(format))
+			return false;
+
+		const std::uint8_t *row = static_cast<const std::uint8_t*>(data);
+		for (std::int32_t y = 0; y < height; ++y, row += stride, out += width)
+		{
+			switch (format)
+			{
+				case K2D_PIXEL_R8:
+				{
+					for (std::int32_t x = 0; x < width; ++x)
+						out[x] = 0xFF000000 | row[x];
+					break;
+				}
+				case K2D_PIXEL_A8:
+				{
+					for (std::int32_t x = 0; x < width; ++x)
+						out[x] = 0x00FFFFFF | (static_cast<std::uint32_t>(row[x]) << 24);
+					break;
+				}
+				case K2D_PIXEL_RGBA8:
+				{
+					// Already the target layout
+					std::memcpy(out, row, static_cast<size_t>(width) * 4);
+					break;
+				}
+				case K2D_PIXEL_BGRA8:
+				{
+					const std::uint8_t *src = row;
+					for (std::int32_t x = 0; x < width; ++x, src += 4)
+						out[x] = src[2] | (src[1] << 8) | (src[0] << 16) | (static_cast<std::uint32_t>(src[3]) << 24);
+					break;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	void Texture::SetPremultiplied(bool bakeColorKey, std::uint32_t colorKey)
+	{
+		m_Premultiplied = true;
+		m_BakeColorKey = bakeColorKey;
+		m_ColorKey = colorKey;
+	}
+
+	void Texture::ApplyLoadOptions(std::uint8_t *pixels, std::int32_t width, std::int32_t height) const
+	{
+		if (!m_Premultiplied || !pixels)
+			return;
+
+		const std::int32_t count = width * height;
+		for (std::int32_t i = 0; i < count; ++i, pixels += 4)
+		{
+			// Pixels are R, G, B, A bytes, which matches the 0xAABBGGRR colorkey layout
+			const std::uint32_t pixel =
+				pixels[0] | (pixels[1] << 8) | (pixels[2] << 16) | (static_cast<std::uint32_t>(pixels[3]) << 24);
+			if (m_BakeColorKey && pixel == m_ColorKey)
+			{
+				pixels[0] = pixels[1] = pixels[2] = pixels[3] = 0;
+				continue;
+			}
+
+			const std::uint32_t a = pixels[3];
+			pixels[0] = static_cast<std::uint8_t>((pixels[0] * a + 127) / 255);
+			pixels[1] = static_cast<std::uint8_t>((pixels[1] * a + 127) / 255);
+			pixels[2] = static_cast<std::uint8_t>((pixels[2] * a + 127) / 255);
+		}
+	}
 }
+
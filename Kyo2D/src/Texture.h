@@ -1,8 +1,10 @@
-
 #pragma once
 
 #include <memory>
 #include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
 
 namespace Kyo2D
 {
@@ -20,6 +22,22 @@ namespace Kyo2D
 		virtual bool Initialize(const void *data, size_t dataSize) = 0;
 		/// Initializes this texture by loading it from a file.
 		virtual bool Initialize(const std::wstring &filename) = 0;
+		/// Initializes this texture as an empty texture which can be used as render target.
+		virtual bool InitializeRenderTarget(std::int32_t width, std::int32_t height) = 0;
+		/// Initializes this texture from pixels in memory.
+		/// @param pixels width * height pixels in 0xAABBGGRR format (RGBA bytes), or nullptr for transparent pixels.
+		virtual bool InitializePixels(std::int32_t width, std::int32_t height, const std::uint32_t *pixels) = 0;
+		/// Replaces the pixels of a region of this texture.
+		/// @param pixels width * height pixels in 0xAABBGGRR format (RGBA bytes), without row padding.
+		virtual bool UpdateRegion(std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const std::uint32_t *pixels) = 0;
+		/// Initializes this texture as an alpha-only texture with one byte per pixel. Alpha-only
+		/// textures are drawn in the vertex color, with the alpha multiplied by the texture.
+		/// @param alpha width * height alpha values, or nullptr for transparent pixels.
+		/// @return false if the backend doesn't support single-channel textures.
+		virtual bool InitializeAlpha(std::int32_t width, std::int32_t height, const std::uint8_t *alpha) = 0;
+		/// Replaces the alpha values of a region of an alpha-only texture.
+		/// @param alpha width * height alpha values, without row padding.
+		virtual bool UpdateAlphaRegion(std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height, const std::uint8_t *alpha) = 0;
 		/// Activates this texture as the current one.
 		virtual bool Set() = 0;
 
@@ -27,5 +45,96 @@ namespace Kyo2D
 		virtual std::int32_t GetWidth() const = 0;
 		/// Gets the height of this texture in pixels.
 		virtual std::int32_t GetHeight() const = 0;
+		/// Determines whether the gpu resources of this texture are currently allocated.
+		virtual bool IsResident() const = 0;
+		/// Gets the amount of video memory used by this texture while resident, in bytes.
+		virtual std::uint64_t GetMemoryUsage() const;
+
+	public:
+
+		/// Makes the next Initialize call convert the loaded pixels to premultiplied alpha.
+		/// @param bakeColorKey If true, all pixels matching colorKey are made fully transparent.
+		/// @param colorKey The colorkey in 0xAABBGGRR format (same as the sprite drawing methods).
+		void SetPremultiplied(bool bakeColorKey, std::uint32_t colorKey);
+		/// Determines if this texture stores premultiplied alpha. Premultiplied textures are
+		/// rendered without a colorkey test.
+		inline bool IsPremultiplied() const { return m_Premultiplied; }
+		/// Determines if this texture was initialized with InitializeAlpha.
+		inline bool IsAlphaOnly() const { return m_AlphaOnly; }
+		/// Marks this texture as holding distance fields in its alpha (see DistanceField). Such
+		/// textures are drawn with filtering, the colorkey carries the edge threshold and smoothing.
+		inline void SetDistanceField(bool distanceField) { m_DistanceField = distanceField; }
+		/// Determines if this texture holds distance fields.
+		inline bool IsDistanceField() const { return m_DistanceField; }
+
+	public:
+
+		/// Remembers the file this texture was loaded from, so it can be restored after eviction.
+		void KeepSource(const std::wstring &filename);
+		/// Keeps a copy of the encoded image data, so the texture can be restored after eviction.
+		void KeepSource(const void *data, size_t dataSize);
+		/// Forgets the source, so the texture isn't evicted anymore. Used when the contents no longer match it.
+		void DiscardSource();
+		/// Determines whether this texture can be evicted and restored later on.
+		inline bool IsEvictable() const { return !m_SourceFile.empty() || !m_SourceData.empty(); }
+		/// Releases the gpu resources of this texture. The texture size is still available.
+		/// @return false if the texture can't be restored afterwards and thus wasn't evicted.
+		bool Evict();
+		/// Recreates the gpu resources of an evicted texture from its source.
+		bool Restore();
+
+		/// Gets the frame number in which this texture was last bound.
+		inline std::uint64_t GetLastUsedFrame() const { return m_LastUsedFrame; }
+		/// Sets the frame number in which this texture was last bound.
+		inline void SetLastUsedFrame(std::uint64_t frame) { m_LastUsedFrame = frame; }
+
+		/// Gets the K2D_PixelFormat of the pixels passed to K2D_UpdateTextureRegion.
+		inline std::uint32_t GetPixelFormat() const { return m_PixelFormat; }
+		/// Sets the K2D_PixelFormat of the pixels passed to K2D_UpdateTextureRegion.
+		inline void SetPixelFormat(std::uint32_t format) { m_PixelFormat = format; }
+
+		/// Gets a counter which changes whenever the contents of this texture change after creation.
+		inline std::uint32_t GetVersion() const { return m_Version; }
+		/// Marks the contents of this texture as changed.
+		inline void IncrementVersion() { ++m_Version; }
+
+		/// Gets the mutex serializing image decoding. DevIL keeps the bound image in global state,
+		/// so textures can't be loaded concurrently, not even by different engine contexts.
+		static std::mutex &GetLoaderMutex();
+
+		/// Gets the size of a pixel of a K2D_PixelFormat in bytes.
+		/// @return 0 if the format is unknown.
+		static std::uint32_t GetPixelSize(std::uint32_t format);
+		/// Converts pixels of a K2D_PixelFormat to the 0xAABBGGRR format of UpdateRegion.
+		/// @param stride Bytes between the starts of two rows of data.
+		/// @param out Receives width * height pixels.
+		/// @return false if the format is unknown.
+		static bool ConvertPixels(std::uint32_t format, const void *data, std::int32_t width, std::int32_t height, size_t stride, std::uint32_t *out);
+
+	protected:
+
+		/// Releases all gpu resources of this texture, but keeps the texture size.
+		virtual void ReleaseResources() = 0;
+		/// Determines if a region lies within this texture and isn't empty.
+		bool IsValidRegion(std::int32_t x, std::int32_t y, std::int32_t width, std::int32_t height) const;
+		/// Applies the load options to RGBA8 pixel data (as returned by DevIL) in place.
+		/// @param pixels Pointer to width * height RGBA8 pixels.
+		void ApplyLoadOptions(std::uint8_t *pixels, std::int32_t width, std::int32_t height) const;
+		/// Sets whether this texture stores one alpha byte per pixel. Called by the initialize methods.
+		inline void SetAlphaOnly(bool alphaOnly) { m_AlphaOnly = alphaOnly; }
+
+	private:
+
+		bool m_Premultiplied;
+		bool m_AlphaOnly;
+		bool m_DistanceField;
+		bool m_BakeColorKey;
+		std::uint32_t m_ColorKey;
+		std::wstring m_SourceFile;
+		std::vector<std::uint8_t> m_SourceData;
+		std::uint64_t m_LastUsedFrame;
+		std::uint32_t m_Version;
+		std::uint32_t m_PixelFormat;
 	};
 }
+
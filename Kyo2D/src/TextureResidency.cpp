@@ -0,0 +1,143 @@
+#include "TextureResidency.h"
+#include <vector>
+#include <algorithm>
+
+namespace Kyo2D
+{
+	TextureResidency::TextureResidency()
+		: m_Frame(0)
+		, m_Budget(0)
+		, m_Usage(0)
+		, m_Evictions(0)
+		, m_Restores(0)
+	{
+	}
+
+	TextureResidency::~TextureResidency()
+	{
+	}
+
+	void TextureResidency::SetBudget(std::uint64_t budget)
+	{
+		m_Budget = budget;
+		Enforce();
+	}
+
+	void TextureResidency::Add(std::uint32_t id, const std::shared_ptr<Texture> &texture)
+	{
+		if (!texture)
+			return;
+
+		Remove(id);
+
+		// Treat new textures as used: they are most likely drawn soon.
+		texture->SetLastUsedFrame(m_Frame);
+		m_Textures[id] = texture;
+		if (texture->IsResident())
+			m_Usage += texture->GetMemoryUsage();
+
+		Enforce();
+	}
+
+	void TextureResidency::Remove(std::uint32_t id)
+	{
+		auto it = m_Textures.find(id);
+		if (it == m_Textures.end())
+			return;
+
+		auto texture = it->second.lock();
+		if (texture && texture->IsResident())
+			m_Usage -= std::min(m_Usage, texture->GetMemoryUsage());
+
+		m_Textures.erase(it);
+	}
+
+	void TextureResidency::Clear()
+	{
+		m_Textures.clear();
+		m_Frame = 0;
+		m_Usage = 0;
+	}
+
+	bool TextureResidency::Touch(Texture &texture)
+	{
+		texture.SetLastUsedFrame(m_Frame);
+		if (texture.IsResident())
+			return true;
+
+		// Rehydrate from the remembered source. This happens synchronously: the image loader
+		// isn't thread-safe and the texture is needed for the current draw call anyway.
+		if (!texture.Restore())
+			return false;
+
+		++m_Restores;
+		m_Usage += texture.GetMemoryUsage();
+		Enforce();
+		return true;
+	}
+
+	void TextureResidency::NextFrame()
+	{
+		++m_Frame;
+		Enforce();
+	}
+
+	TextureResidency::Stats TextureResidency::GetStats() const
+	{
+		Stats stats;
+		stats.Budget = m_Budget;
+		stats.Usage = m_Usage;
+		stats.ResidentTextures = 0;
+		stats.EvictedTextures = 0;
+		stats.Evictions = m_Evictions;
+		stats.Restores = m_Restores;
+
+		for (auto &entry : m_Textures)
+		{
+			auto texture = entry.second.lock();
+			if (!texture)
+				continue;
+
+			if (texture->IsResident())
+				++stats.ResidentTextures;
+			else
+				++stats.EvictedTextures;
+		}
+
+		return stats;
+	}
+
+	void TextureResidency::Enforce()
+	{
+		if (m_Budget == 0 || m_Usage <= m_Budget)
+			return;
+
+		// Collect eviction candidates. This only runs while over budget, so sorting here keeps
+		// Touch (called for every draw) down to a single store.
+		std::vector<std::shared_ptr<Texture>> candidates;
+		for (auto &entry : m_Textures)
+		{
+			auto texture = entry.second.lock();
+			if (texture && texture->IsResident() && texture->IsEvictable() && texture->GetLastUsedFrame() < m_Frame)
+				candidates.push_back(std::move(texture));
+		}
+
+		std::sort(candidates.begin(), candidates.end(), [](const std::shared_ptr<Texture> &a, const std::shared_ptr<Texture> &b)
+		{
+			return a->GetLastUsedFrame() < b->GetLastUsedFrame();
+		});
+
+		for (auto &texture : candidates)
+		{
+			if (m_Usage <= m_Budget)
+				break;
+
+			std::uint64_t size = texture->GetMemoryUsage();
+			if (!texture->Evict())
+				continue;
+
+			m_Usage -= std::min(m_Usage, size);
+			++m_Evictions;
+		}
+	}
+}
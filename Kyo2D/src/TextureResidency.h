@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Texture.h"
+#include <map>
+#include <memory>
+#include <cstdint>
+
+namespace Kyo2D
+{
+	/// Keeps the video memory used by textures below a configurable budget. Every texture that is
+	/// bound for rendering is touched with the current frame number. If the budget is exceeded, the
+	/// least recently used textures are evicted (their gpu resources are released) and restored from
+	/// their source as soon as they are used again. Textures used in the current frame are never evicted.
+	/// The policy only depends on the Texture interface, so it works the same for every backend.
+	class TextureResidency
+	{
+	public:
+
+		/// Budget and usage statistics.
+		struct Stats
+		{
+			/// The configured budget in bytes. 0 means unlimited.
+			std::uint64_t Budget;
+			/// Video memory currently used by resident textures in bytes.
+			std::uint64_t Usage;
+			/// Number of textures currently resident.
+			std::uint32_t ResidentTextures;
+			/// Number of textures currently evicted.
+			std::uint32_t EvictedTextures;
+			/// Total number of evictions so far.
+			std::uint64_t Evictions;
+			/// Total number of restores so far.
+			std::uint64_t Restores;
+		};
+
+	public:
+
+		/// Default constructor. The budget is unlimited.
+		TextureResidency();
+		/// Destructor.
+		~TextureResidency();
+
+		/// Sets the budget in bytes and evicts textures until it fits. 0 disables the budget.
+		void SetBudget(std::uint64_t budget);
+		/// Starts tracking a texture which has just been created (and is resident).
+		void Add(std::uint32_t id, const std::shared_ptr<Texture> &texture);
+		/// Stops tracking the texture with the given id.
+		void Remove(std::uint32_t id);
+		/// Stops tracking all textures and resets the frame counter. Keeps the budget.
+		void Clear();
+
+		/// Marks the texture as used in the current frame and restores it if it was evicted.
+		/// @returns false if the texture couldn't be restored.
+		bool Touch(Texture &texture);
+		/// Advances the frame counter and evicts the textures which kept the usage above the budget
+		/// because they were used in the finished frame. Call once per presented frame.
+		void NextFrame();
+
+		/// Gets the current frame number.
+		inline std::uint64_t GetFrame() const { return m_Frame; }
+		/// Gets the current budget and usage statistics.
+		Stats GetStats() const;
+
+	private:
+
+		/// Evicts least recently used textures until the usage fits the budget.
+		/// Textures used in the current frame are skipped.
+		void Enforce();
+
+	private:
+
+		std::map<std::uint32_t, std::weak_ptr<Texture>> m_Textures;
+		std::uint64_t m_Frame;
+		std::uint64_t m_Budget;
+		std::uint64_t m_Usage;
+		std::uint64_t m_Evictions;
+		std::uint64_t m_Restores;
+	};
+}
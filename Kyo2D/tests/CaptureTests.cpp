@@ -0,0 +1,142 @@
+#include "Capture.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace
+{
+	/// Writes capture streams to a temporary file and reads them back.
+	class CaptureTest : public ::testing::Test
+	{
+	protected:
+
+		virtual void SetUp() override
+		{
+			char path[] = "/tmp/kyo2d-capture-XXXXXX";
+			int file = mkstemp(path);
+			ASSERT_NE(file, -1);
+			close(file);
+			m_Path = path;
+			m_Filename.assign(m_Path.begin(), m_Path.end());
+		}
+
+		virtual void TearDown() override
+		{
+			unlink(m_Path.c_str());
+		}
+
+		/// Writes a capture with one record.
+		void WriteRecord(Kyo2D::CaptureOp op, const std::vector<std::uint8_t> &payload)
+		{
+			Kyo2D::CaptureWriter writer;
+			ASSERT_TRUE(writer.Open(m_Filename));
+			writer.Write(op, payload);
+		}
+
+		/// Appends raw bytes to the capture file.
+		void Append(const std::vector<std::uint8_t> &bytes)
+		{
+			FILE *file = std::fopen(m_Path.c_str(), "ab");
+			ASSERT_NE(file, nullptr);
+			std::fwrite(bytes.data(), 1, bytes.size(), file);
+			std::fclose(file);
+		}
+
+		/// Builds a string payload from UTF-16 units, the length may differ from the unit count.
+		static std::vector<std::uint8_t> StringPayload(std::uint32_t length, const std::vector<std::uint16_t> &units)
+		{
+			std::vector<std::uint8_t> payload(sizeof(length) + units.size() * sizeof(std::uint16_t));
+			std::memcpy(payload.data(), &length, sizeof(length));
+			if (!units.empty())
+				std::memcpy(payload.data() + sizeof(length), units.data(), units.size() * sizeof(std::uint16_t));
+			return payload;
+		}
+
+		/// Reads the string of the single record of the capture.
+		std::wstring ReadString()
+		{
+			Kyo2D::CaptureReader reader;
+			Kyo2D::CaptureOp op;
+			EXPECT_TRUE(reader.Open(m_Filename));
+			EXPECT_TRUE(reader.Next(op));
+			EXPECT_EQ(op, Kyo2D::capture_op::DrawText);
+			return reader.ReadString();
+		}
+
+		std::string m_Path;
+		std::wstring m_Filename;
+	};
+}
+
+TEST_F(CaptureTest, ReadsWrittenRecords)
+{
+	WriteRecord(Kyo2D::capture_op::FillRect, { 1, 2, 3 });
+
+	Kyo2D::CaptureReader reader;
+	Kyo2D::CaptureOp op;
+	ASSERT_TRUE(reader.Open(m_Filename));
+	ASSERT_TRUE(reader.Next(op));
+	EXPECT_EQ(op, Kyo2D::capture_op::FillRect);
+	EXPECT_EQ(reader.Read<std::uint8_t>(), 1);
+	EXPECT_EQ(reader.Read<std::uint8_t>(), 2);
+	EXPECT_EQ(reader.Read<std::uint8_t>(), 3);
+	EXPECT_FALSE(reader.Next(op));
+}
+
+TEST_F(CaptureTest, RejectsRecordsLargerThanTheStream)
+{
+	// A record header claiming almost 4 GB, followed by a few bytes
+	WriteRecord(Kyo2D::capture_op::FillRect, {});
+	Append({ Kyo2D::capture_op::DrawText, 0xF0, 0xFF, 0xFF, 0xFF, 1, 2, 3, 4 });
+
+	Kyo2D::CaptureReader reader;
+	Kyo2D::CaptureOp op;
+	ASSERT_TRUE(reader.Open(m_Filename));
+	ASSERT_TRUE(reader.Next(op));
+	EXPECT_EQ(op, Kyo2D::capture_op::FillRect);
+	EXPECT_FALSE(reader.Next(op));
+}
+
+TEST_F(CaptureTest, RejectsTruncatedRecordHeaders)
+{
+	WriteRecord(Kyo2D::capture_op::FillRect, {});
+	Append({ Kyo2D::capture_op::DrawText, 4, 0 });
+
+	Kyo2D::CaptureReader reader;
+	Kyo2D::CaptureOp op;
+	ASSERT_TRUE(reader.Open(m_Filename));
+	ASSERT_TRUE(reader.Next(op));
+	EXPECT_FALSE(reader.Next(op));
+}
+
+TEST_F(CaptureTest, CombinesSurrogatePairs)
+{
+	WriteRecord(Kyo2D::capture_op::DrawText, StringPayload(3, { 'a', 0xD83D, 0xDE00 }));
+
+	const std::wstring text = ReadString();
+	if (sizeof(wchar_t) > 2)
+		EXPECT_EQ(text, std::wstring(L"a") + static_cast<wchar_t>(0x1F600));
+	else
+		EXPECT_EQ(text.size(), 3u);
+}
+
+TEST_F(CaptureTest, ReplacesUnpairedSurrogates)
+{
+	if (sizeof(wchar_t) == 2)
+		GTEST_SKIP() << "UTF-16 strings are passed through unchanged";
+
+	// High surrogate before a regular unit, lone low surrogate and a trailing high surrogate
+	WriteRecord(Kyo2D::capture_op::DrawText, StringPayload(4, { 0xD800, 'b', 0xDC00, 0xDBFF }));
+
+	EXPECT_EQ(ReadString(), std::wstring(L"\xFFFD" L"b" L"\xFFFD" L"\xFFFD"));
+}
+
+TEST_F(CaptureTest, ClampsStringLengthToTheRecord)
+{
+	WriteRecord(Kyo2D::capture_op::DrawText, StringPayload(0xFFFFFFFF, { 'x', 'y' }));
+
+	EXPECT_EQ(ReadString(), L"xy");
+}
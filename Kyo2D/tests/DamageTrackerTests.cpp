@@ -0,0 +1,255 @@
+#include "Kyo2D.h"
+#include "DamageTracker.h"
+#include "Hash.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using Kyo2D::DamageRect;
+using Kyo2D::DamageTracker;
+
+namespace
+{
+	const std::int32_t Width = 640;
+	const std::int32_t Height = 480;
+
+	/// Gets the bounds of the call with the given id, calls are laid out on a grid.
+	DamageRect BoundsOf(std::uint32_t id)
+	{
+		std::int32_t x = static_cast<std::int32_t>(id % 10) * 60;
+		std::int32_t y = static_cast<std::int32_t>(id / 10) * 60;
+		return DamageRect{ x, y, x + 20, y + 20 };
+	}
+
+	/// Records a frame of small, separate calls, one per id.
+	void RecordFrame(DamageTracker &tracker, const std::vector<std::uint32_t> &ids)
+	{
+		tracker.BeginFrame();
+		for (std::uint32_t id : ids)
+			tracker.Record(BoundsOf(id), Kyo2D::Hash(&id, sizeof(id)));
+	}
+
+	bool Contains(const std::vector<DamageRect> &rects, const DamageRect &rect)
+	{
+		for (auto &r : rects)
+		{
+			if (r.Left <= rect.Left && r.Top <= rect.Top && r.Right >= rect.Right && r.Bottom >= rect.Bottom)
+				return true;
+		}
+		return false;
+	}
+
+	std::uint64_t AreaOf(const std::vector<DamageRect> &rects)
+	{
+		std::uint64_t area = 0;
+		for (auto &r : rects)
+			area += r.GetArea();
+		return area;
+	}
+
+	/// Creates a tracker which has already presented the given frame.
+	void Prime(DamageTracker &tracker, const std::vector<std::uint32_t> &ids)
+	{
+		RecordFrame(tracker, ids);
+		tracker.EndFrame(Width, Height);
+	}
+}
+
+TEST(DamageTracker, FirstFrameIsFullyDamaged)
+{
+	DamageTracker tracker;
+	RecordFrame(tracker, { 1, 2, 3 });
+	const auto &dirty = tracker.EndFrame(Width, Height);
+
+	ASSERT_EQ(dirty.size(), 1u);
+	EXPECT_EQ(dirty[0].GetArea(), static_cast<std::uint64_t>(Width * Height));
+}
+
+TEST(DamageTracker, UnchangedFrameHasNoDamage)
+{
+	DamageTracker tracker;
+	Prime(tracker, { 1, 2, 3, 4, 5 });
+
+	RecordFrame(tracker, { 1, 2, 3, 4, 5 });
+	EXPECT_TRUE(tracker.EndFrame(Width, Height).empty());
+	EXPECT_EQ(tracker.GetStats().PixelsRedrawn, 0u);
+	EXPECT_EQ(tracker.GetStats().PixelsFullFrame, static_cast<std::uint64_t>(Width * Height));
+}
+
+TEST(DamageTracker, ChangedCallDamagesItsBounds)
+{
+	DamageTracker tracker;
+	Prime(tracker, { 1, 2, 3, 4, 5 });
+
+	// Call 3 is replaced by call 33 which has other bounds
+	RecordFrame(tracker, { 1, 2, 33, 4, 5 });
+	const auto &dirty = tracker.EndFrame(Width, Height);
+
+	ASSERT_FALSE(dirty.empty());
+	EXPECT_TRUE(Contains(dirty, BoundsOf(3)));
+	EXPECT_TRUE(Contains(dirty, BoundsOf(33)));
+	EXPECT_FALSE(Contains(dirty, BoundsOf(1)));
+	EXPECT_FALSE(Contains(dirty, BoundsOf(5)));
+	EXPECT_EQ(AreaOf(dirty), BoundsOf(3).GetArea() + BoundsOf(33).GetArea());
+}
+
+TEST(DamageTracker, ChangedHashWithSameBoundsIsDamaged)
+{
+	DamageTracker tracker;
+	tracker.BeginFrame();
+	tracker.Record(DamageRect{ 10, 10, 50, 50 }, 1);
+	tracker.EndFrame(Width, Height);
+
+	tracker.BeginFrame();
+	tracker.Record(DamageRect{ 10, 10, 50, 50 }, 2);
+	const auto &dirty = tracker.EndFrame(Width, Height);
+
+	ASSERT_EQ(dirty.size(), 1u);
+	EXPECT_EQ(dirty[0].Left, 10);
+	EXPECT_EQ(dirty[0].Top, 10);
+	EXPECT_EQ(dirty[0].Right, 50);
+	EXPECT_EQ(dirty[0].Bottom, 50);
+}
+
+TEST(DamageTracker, InsertInTheMiddle)
+{
+	DamageTracker tracker;
+	Prime(tracker, { 1, 2, 3, 4, 5 });
+
+	// The prefix and suffix match, only the inserted call is damaged
+	RecordFrame(tracker, { 1, 2, 42, 3, 4, 5 });
+	const auto &dirty = tracker.EndFrame(Width, Height);
+
+	ASSERT_EQ(dirty.size(), 1u);
+	EXPECT_TRUE(Contains(dirty, BoundsOf(42)));
+	EXPECT_EQ(AreaOf(dirty), BoundsOf(42).GetArea());
+}
+
+TEST(DamageTracker, DeleteInTheMiddle)
+{
+	DamageTracker tracker;
+	Prime(tracker, { 1, 2, 3, 4, 5 });
+
+	// The area the removed call covered has to be redrawn
+	RecordFrame(tracker, { 1, 2, 4, 5 });
+	const auto &dirty = tracker.EndFrame(Width, Height);
+
+	ASSERT_EQ(dirty.size(), 1u);
+	EXPECT_TRUE(Contains(dirty, BoundsOf(3)));
+	EXPECT_EQ(AreaOf(dirty), BoundsOf(3).GetArea());
+}
+
+TEST(DamageTracker, TouchingRectsAreMerged)
+{
+	DamageTracker tracker;
+	Prime(tracker, {});
+
+	tracker.BeginFrame();
+	tracker.Record(DamageRect{ 0, 0, 20, 20 }, 1);
+	tracker.Record(DamageRect{ 20, 0, 40, 20 }, 2);
+	tracker.Record(DamageRect{ 100, 100, 120, 120 }, 3);
+	const auto &dirty = tracker.EndFrame(Width, Height);
+
+	ASSERT_EQ(dirty.size(), 2u);
+	EXPECT_TRUE(Contains(dirty, DamageRect{ 0, 0, 40, 20 }));
+	EXPECT_TRUE(Contains(dirty, DamageRect{ 100, 100, 120, 120 }));
+}
+
+TEST(DamageTracker, RectCountIsBounded)
+{
+	DamageTracker tracker;
+	tracker.SetMaxRects(4);
+	Prime(tracker, {});
+
+	std::vector<std::uint32_t> ids;
+	for (std::uint32_t id = 0; id < 20; ++id)
+		ids.push_back(id);
+	RecordFrame(tracker, ids);
+	const auto &dirty = tracker.EndFrame(Width, Height);
+
+	EXPECT_LE(dirty.size(), 4u);
+	for (std::uint32_t id : ids)
+		EXPECT_TRUE(Contains(dirty, BoundsOf(id)));
+	for (size_t a = 0; a < dirty.size(); ++a)
+	{
+		for (size_t b = a + 1; b < dirty.size(); ++b)
+			EXPECT_FALSE(dirty[a].Intersects(dirty[b]));
+	}
+}
+
+TEST(DamageTracker, LargeDamageFallsBackToFullFrame)
+{
+	DamageTracker tracker;
+	tracker.SetFullFrameThreshold(0.5f);
+	Prime(tracker, {});
+
+	// Two calls covering 60% of the frame
+	tracker.BeginFrame();
+	tracker.Record(DamageRect{ 0, 0, Width, Height * 3 / 10 }, 1);
+	tracker.Record(DamageRect{ 0, Height * 7 / 10, Width, Height }, 2);
+	const auto &dirty = tracker.EndFrame(Width, Height);
+
+	ASSERT_EQ(dirty.size(), 1u);
+	EXPECT_EQ(dirty[0].Left, 0);
+	EXPECT_EQ(dirty[0].Top, 0);
+	EXPECT_EQ(dirty[0].Right, Width);
+	EXPECT_EQ(dirty[0].Bottom, Height);
+}
+
+TEST(DamageTracker, SmallDamageStaysBelowThreshold)
+{
+	DamageTracker tracker;
+	tracker.SetFullFrameThreshold(0.5f);
+	Prime(tracker, {});
+
+	tracker.BeginFrame();
+	tracker.Record(DamageRect{ 0, 0, Width, Height * 2 / 10 }, 1);
+	tracker.Record(DamageRect{ 0, Height * 8 / 10, Width, Height }, 2);
+	const auto &dirty = tracker.EndFrame(Width, Height);
+
+	EXPECT_EQ(dirty.size(), 2u);
+	EXPECT_LT(AreaOf(dirty), static_cast<std::uint64_t>(Width * Height / 2));
+}
+
+TEST(DamageTracker, ResizeDamagesFullFrame)
+{
+	DamageTracker tracker;
+	Prime(tracker, { 1, 2, 3 });
+
+	RecordFrame(tracker, { 1, 2, 3 });
+	const auto &dirty = tracker.EndFrame(Width * 2, Height);
+
+	ASSERT_EQ(dirty.size(), 1u);
+	EXPECT_EQ(dirty[0].Right, Width * 2);
+}
+
+TEST(DamageTracker, ReplacedTextureIsRedrawn)
+{
+	K2D_InitSoftware(1);
+	std::uint32_t target = K2D_CreateRenderTarget(nullptr, 64, 64, false);
+	K2D_SetRenderTarget(target);
+	K2D_SetDamageTrackingEnabled(true);
+
+	// Draw a red sprite until the frame is unchanged
+	std::vector<std::uint32_t> red(16 * 16, 0xFF0000FF), blue(16 * 16, 0xFFFF0000);
+	std::uint32_t texture = K2D_CreateTextureFromPixels(16, 16, K2D_PIXEL_RGBA8, 0, red.data());
+	for (int frame = 0; frame < 2; ++frame)
+	{
+		K2D_DrawSpriteAt(texture, 8.0f, 8.0f, 0.0f, 0.0f, 0xFFFFFFFF, 0);
+		K2D_PresentRenderTarget();
+	}
+	EXPECT_EQ(K2D_GetDamageStats().PixelsRedrawn, 0u);
+
+	// A new texture of the same size may get the address of the destroyed one, and starts at
+	// the same version
+	K2D_DestroyTexture(texture);
+	texture = K2D_CreateTextureFromPixels(16, 16, K2D_PIXEL_RGBA8, 0, blue.data());
+	K2D_DrawSpriteAt(texture, 8.0f, 8.0f, 0.0f, 0.0f, 0xFFFFFFFF, 0);
+	K2D_PresentRenderTarget();
+	EXPECT_GT(K2D_GetDamageStats().PixelsRedrawn, 0u);
+
+	std::vector<std::uint32_t> pixels(64 * 64);
+	ASSERT_TRUE(K2D_ReadRenderTargetPixels(target, pixels.data(), static_cast<std::uint32_t>(pixels.size())));
+	EXPECT_EQ(pixels[16 * 64 + 16], 0xFFFF0000u);
+
+	K2D_Terminate();
+}
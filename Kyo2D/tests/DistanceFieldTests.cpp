@@ -0,0 +1,89 @@
+#include "DistanceField.h"
+#include "Software/WorkerPool.h"
+#include <gtest/gtest.h>
+#include <cmath>
+
+using Kyo2D::DistanceField;
+using Kyo2D::WorkerPool;
+
+namespace
+{
+	/// Coverage of an antialiased ring with a notch, padded by the spread on each side.
+	std::vector<std::uint8_t> MakeRing(std::int32_t width, std::int32_t height)
+	{
+		std::vector<std::uint8_t> coverage(static_cast<size_t>(width) * height);
+		const float cx = width * 0.5f, cy = height * 0.5f;
+		const float outer = std::min(width, height) * 0.35f, inner = outer * 0.5f;
+		for (std::int32_t y = 0; y < height; ++y)
+		{
+			for (std::int32_t x = 0; x < width; ++x)
+			{
+				const float d = std::sqrt((x + 0.5f - cx) * (x + 0.5f - cx) + (y + 0.5f - cy) * (y + 0.5f - cy));
+				float c = std::min(outer - d, d - inner) + 0.5f;
+				if (x > cx && std::fabs(y + 0.5f - cy) < 2.0f)
+					c = 0.0f;
+				coverage[y * width + x] = static_cast<std::uint8_t>(std::max(0.0f, std::min(1.0f, c)) * 255.0f);
+			}
+		}
+		return coverage;
+	}
+
+	/// Pseudo random blobs, covered, empty and partial pixels mixed.
+	std::vector<std::uint8_t> MakeNoise(std::int32_t width, std::int32_t height)
+	{
+		std::vector<std::uint8_t> coverage(static_cast<size_t>(width) * height);
+		std::uint32_t state = 12345;
+		for (auto &value : coverage)
+		{
+			state = state * 1664525u + 1013904223u;
+			const std::uint32_t r = state >> 24;
+			value = r < 96 ? 0 : (r < 192 ? 255 : static_cast<std::uint8_t>(r));
+		}
+		return coverage;
+	}
+
+	void ExpectSameField(const std::vector<std::uint8_t> &coverage, std::int32_t width, std::int32_t height, std::uint32_t threads)
+	{
+		WorkerPool workers;
+		workers.Initialize(threads);
+
+		std::vector<std::uint8_t> single(coverage.size()), multi(coverage.size());
+		DistanceField::Generate(coverage.data(), width, height, 4.0f, nullptr, single.data());
+		DistanceField::Generate(coverage.data(), width, height, 4.0f, &workers, multi.data());
+		EXPECT_EQ(single, multi) << width << "x" << height << " with " << threads << " threads";
+	}
+}
+
+TEST(DistanceField, MultiThreadedMatchesSingleThreaded)
+{
+	const std::int32_t sizes[][2] = { { 64, 64 }, { 37, 91 }, { 200, 17 }, { 1, 33 }, { 129, 1 } };
+	for (auto &size : sizes)
+	{
+		for (std::uint32_t threads : { 2u, 3u, 8u })
+		{
+			ExpectSameField(MakeRing(size[0], size[1]), size[0], size[1], threads);
+			ExpectSameField(MakeNoise(size[0], size[1]), size[0], size[1], threads);
+		}
+	}
+}
+
+TEST(DistanceField, InsideIsAboveEdgeValue)
+{
+	const std::int32_t size = 48;
+	std::vector<std::uint8_t> coverage(size * size, 0);
+	for (std::int32_t y = 16; y < 32; ++y)
+	{
+		for (std::int32_t x = 16; x < 32; ++x)
+			coverage[y * size + x] = 255;
+	}
+
+	std::vector<std::uint8_t> field(coverage.size());
+	DistanceField::Generate(coverage.data(), size, size, 4.0f, nullptr, field.data());
+
+	EXPECT_GT(field[24 * size + 24], 128);
+	EXPECT_EQ(field[24 * size + 24], 255);
+	EXPECT_LT(field[24 * size + 12], 128);
+	EXPECT_EQ(field[2 * size + 2], 0);
+	EXPECT_NEAR(field[24 * size + 16], 128, 40);
+	EXPECT_NEAR(field[24 * size + 15], 128, 40);
+}
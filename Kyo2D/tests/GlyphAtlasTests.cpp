@@ -0,0 +1,232 @@
+#include "Kyo2D.h"
+#include "GlyphAtlas.h"
+#include "EngineContext.h"
+#include <gtest/gtest.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using Kyo2D::GlyphAtlas;
+
+namespace
+{
+	// Glyphs of 31x31 pixels take 32x32 with padding, 1024 fit into a page
+	const std::int32_t GlyphSize = 31;
+	const std::uint64_t PageBytes = static_cast<std::uint64_t>(GlyphAtlas::PageSize) * GlyphAtlas::PageSize;
+
+	/// Gets the codepoints of the basic multilingual plane which a font has glyphs for. Prefers the
+	/// CJK ideographs, a font without enough of them gives all its codepoints past ASCII.
+	std::vector<char16_t> GetCodepoints(const char *filename)
+	{
+		std::vector<char16_t> cjk, other;
+		FT_Library library;
+		if (FT_Init_FreeType(&library) != 0)
+			return other;
+
+		FT_Face face;
+		if (FT_New_Face(library, filename, 0, &face) == 0)
+		{
+			FT_UInt index;
+			for (FT_ULong codepoint = FT_Get_First_Char(face, &index); index != 0; codepoint = FT_Get_Next_Char(face, codepoint, &index))
+			{
+				if (codepoint >= 0x4E00 && codepoint < 0xA000)
+					cjk.push_back(static_cast<char16_t>(codepoint));
+				else if (codepoint > 0x7F && codepoint < 0xD800)
+					other.push_back(static_cast<char16_t>(codepoint));
+			}
+			FT_Done_Face(face);
+		}
+		FT_Done_FreeType(library);
+		return cjk.size() >= 2000 ? cjk : other;
+	}
+
+	/// Runs the atlas of a context with the null backend, whose alpha pages use one byte per pixel.
+	class GlyphAtlasTest : public ::testing::Test
+	{
+	protected:
+
+		virtual void SetUp() override
+		{
+			K2D_InitNull();
+			m_Image.assign(GlyphSize * GlyphSize, 0x80);
+		}
+
+		virtual void TearDown() override
+		{
+			K2D_Terminate();
+		}
+
+		GlyphAtlas &Atlas()
+		{
+			return g_Context->Glyphs;
+		}
+
+		/// Inserts a glyph and marks it as drawn.
+		GlyphAtlas::Handle Insert()
+		{
+			GlyphAtlas::Region region;
+			EXPECT_TRUE(Atlas().Insert(GlyphSize, GlyphSize, m_Image.data(), region));
+			Atlas().Touch(region.Glyph.Entry);
+			return region.Glyph;
+		}
+
+		/// Marks glyphs as drawn.
+		/// @return false if one of them has been evicted.
+		bool Draw(const std::vector<GlyphAtlas::Handle> &glyphs, size_t count)
+		{
+			GlyphAtlas::Region region;
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (!Atlas().Find(glyphs[i], region))
+					return false;
+				Atlas().Touch(glyphs[i].Entry);
+			}
+			return true;
+		}
+
+	private:
+
+		std::vector<std::uint8_t> m_Image;
+	};
+}
+
+TEST_F(GlyphAtlasTest, CompactsOldGlyphsToStayInBudget)
+{
+	Atlas().SetBudget(4 * PageBytes);
+
+	// Every frame draws new glyphs, the atlas keeps the recent ones within the budget
+	for (int frame = 0; frame < 100; ++frame)
+	{
+		for (int i = 0; i < 200; ++i)
+			Insert();
+		Atlas().EndFrame();
+		ASSERT_LE(Atlas().GetStats().Memory, 4 * PageBytes);
+	}
+
+	EXPECT_GT(Atlas().GetStats().Compactions, 0u);
+	EXPECT_GT(Atlas().GetStats().GlyphsEvicted, 0u);
+}
+
+TEST_F(GlyphAtlasTest, OversizedFrameDoesNotThrash)
+{
+	Atlas().SetBudget(2 * PageBytes);
+
+	// The glyphs drawn in each frame need three pages, more than the budget
+	const size_t workingSet = 2500;
+	std::vector<GlyphAtlas::Handle> glyphs;
+	for (size_t i = 0; i < workingSet; ++i)
+		glyphs.push_back(Insert());
+	Atlas().EndFrame();
+
+	const std::uint64_t workingSetBytes = (workingSet + 1023) / 1024 * PageBytes;
+	const std::uint64_t ceiling = workingSetBytes + Atlas().GetBudget() / 2 + PageBytes;
+
+	// A few new glyphs per frame, like a changing counter
+	const int frames = 300;
+	std::uint64_t peak = 0;
+	for (int frame = 0; frame < frames; ++frame)
+	{
+		ASSERT_TRUE(Draw(glyphs, glyphs.size()));
+		for (int i = 0; i < 10; ++i)
+			Insert();
+		Atlas().EndFrame();
+		peak = std::max(peak, Atlas().GetStats().Memory);
+	}
+
+	// Compacting is only worth it once the atlas has grown by the usual headroom
+	EXPECT_LE(Atlas().GetStats().Compactions, static_cast<std::uint32_t>(frames / 50));
+	EXPECT_LE(peak, ceiling);
+}
+
+TEST_F(GlyphAtlasTest, RecoversWhenFramesShrink)
+{
+	Atlas().SetBudget(2 * PageBytes);
+
+	std::vector<GlyphAtlas::Handle> glyphs;
+	for (size_t i = 0; i < 2500; ++i)
+		glyphs.push_back(Insert());
+	Atlas().EndFrame();
+	for (int frame = 0; frame < 5; ++frame)
+	{
+		ASSERT_TRUE(Draw(glyphs, glyphs.size()));
+		Insert();
+		Atlas().EndFrame();
+	}
+	ASSERT_GT(Atlas().GetStats().Memory, Atlas().GetBudget());
+
+	// Once the frames fit into the budget again, the atlas gets back under it
+	for (int frame = 0; frame < 5; ++frame)
+	{
+		ASSERT_TRUE(Draw(glyphs, 100));
+		Atlas().EndFrame();
+	}
+	EXPECT_LE(Atlas().GetStats().Memory, Atlas().GetBudget());
+}
+
+TEST(GlyphAtlas, RandomTextStaysWithinBudget)
+{
+#ifndef KYO2D_TEST_FONT
+	GTEST_SKIP() << "no test font";
+#else
+	const std::vector<char16_t> codepoints = GetCodepoints(KYO2D_TEST_FONT);
+	ASSERT_GE(codepoints.size(), 2000u);
+
+	const std::int32_t width = 512, height = 512;
+	K2D_InitSoftware(1);
+	std::uint32_t target = K2D_CreateRenderTarget(nullptr, width, height, false);
+	K2D_SetRenderTarget(target);
+	const std::string filename = KYO2D_TEST_FONT;
+	const std::wstring font(filename.begin(), filename.end());
+	std::uint32_t fontId = K2D_CreateFont(font.c_str(), 24.0f, 0.0f);
+	ASSERT_NE(fontId, 0u);
+
+	// Every frame draws a line of random glyphs, far more than a page holds over all frames.
+	// Of two fixed lines, one is drawn every frame and gets moved by the compactions, the other
+	// one rarely and gets evicted and rasterized again.
+	K2D_SetGlyphAtlasBudget(PageBytes);
+	const std::u16string moved(codepoints.begin(), codepoints.begin() + 12);
+	const std::u16string evicted(codepoints.end() - 12, codepoints.end());
+	std::vector<std::uint32_t> pixels(width * height), expected;
+	std::mt19937 random(3);
+	const int frames = 300;
+	std::uint64_t peak = 0;
+	for (int frame = 0; frame < frames; ++frame)
+	{
+		const bool drawEvicted = frame % 50 == 0;
+		K2D_ClearRenderTarget(0.0f, 0.0f, 0.0f);
+		K2D_DrawTextUtf16(fontId, moved.data(), static_cast<std::uint32_t>(moved.size()), 0.0f, 0.0f, 0xFFFFFFFF);
+		if (drawEvicted)
+			K2D_DrawTextUtf16(fontId, evicted.data(), static_cast<std::uint32_t>(evicted.size()), 0.0f, 60.0f, 0xFFFFFFFF);
+
+		for (int line = 0; line < 10; ++line)
+		{
+			std::u16string text;
+			for (int i = 0; i < 20; ++i)
+				text.push_back(codepoints[random() % codepoints.size()]);
+			K2D_DrawTextUtf16(fontId, text.data(), static_cast<std::uint32_t>(text.size()), 0.0f, 130.0f + line * 35.0f, 0xFFFFFFFF);
+		}
+		K2D_PresentRenderTarget();
+		peak = std::max(peak, K2D_GetGlyphAtlasStats().Memory);
+
+		// The fixed lines look the same in every frame they are drawn in
+		ASSERT_TRUE(K2D_ReadRenderTargetPixels(target, pixels.data(), static_cast<std::uint32_t>(pixels.size())));
+		pixels.resize(width * 100);
+		if (expected.empty())
+			expected = pixels;
+		const size_t rows = drawEvicted ? 100 : 50;
+		ASSERT_TRUE(std::equal(pixels.begin(), pixels.begin() + rows * width, expected.begin())) << "frame " << frame;
+		pixels.resize(width * height);
+	}
+
+	// The glyphs of a frame fit into the budget, so every present ends within it
+	const K2D_GlyphAtlasStats stats = K2D_GetGlyphAtlasStats();
+	EXPECT_GT(stats.Compactions, 0u);
+	EXPECT_GT(stats.GlyphsEvicted, 0u);
+	EXPECT_LE(peak, PageBytes);
+
+	K2D_Terminate();
+#endif
+}
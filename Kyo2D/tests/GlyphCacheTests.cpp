@@ -0,0 +1,156 @@
+#include "Kyo2D.h"
+#include "GlyphCache.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <unistd.h>
+
+namespace
+{
+	/// Runs the null backend with the glyph cache in an empty temporary directory.
+	class GlyphCacheTest : public ::testing::Test
+	{
+	protected:
+
+		virtual void SetUp() override
+		{
+#ifdef KYO2D_TEST_FONT
+			const std::string font = KYO2D_TEST_FONT;
+			m_Font.assign(font.begin(), font.end());
+#endif
+			char path[] = "/tmp/kyo2d-test-XXXXXX";
+			ASSERT_NE(mkdtemp(path), nullptr);
+			m_Directory = path;
+
+			K2D_InitNull();
+			K2D_SetRenderTarget(K2D_CreateRenderTarget(nullptr, 256, 256, false));
+			const std::wstring directory(m_Directory.begin(), m_Directory.end());
+			K2D_SetGlyphCacheDirectory(directory.c_str());
+		}
+
+		virtual void TearDown() override
+		{
+			K2D_SetGlyphCacheDirectory(nullptr);
+			K2D_Terminate();
+			for (const std::string &file : Files())
+				unlink((m_Directory + "/" + file).c_str());
+			rmdir(m_Directory.c_str());
+		}
+
+		/// Gets the names of the files in the cache directory.
+		std::vector<std::string> Files() const
+		{
+			std::vector<std::string> files;
+			if (DIR *dir = opendir(m_Directory.c_str()))
+			{
+				while (dirent *entry = readdir(dir))
+				{
+					std::string name = entry->d_name;
+					if (name != "." && name != "..")
+						files.push_back(name);
+				}
+				closedir(dir);
+			}
+			return files;
+		}
+
+		/// Creates a font and draws a text with it.
+		/// @return The number of glyphs rasterized for the text.
+		std::uint32_t DrawWithFont(std::uint32_t &out_font)
+		{
+			out_font = K2D_CreateFont(m_Font.c_str(), 14.0f, 0.0f);
+			EXPECT_NE(out_font, 0u);
+			const char text[] = "The quick brown fox jumps over the lazy dog";
+			K2D_DrawTextUtf8(out_font, text, sizeof(text) - 1, 0.0f, 0.0f, 0xFFFFFFFF);
+			K2D_PresentRenderTarget();
+			return K2D_GetFrameStats().GlyphsRasterized;
+		}
+
+		std::wstring m_Font;
+		std::string m_Directory;
+	};
+}
+
+TEST_F(GlyphCacheTest, DestroyingFontsDoesNotWrite)
+{
+	if (m_Font.empty())
+		GTEST_SKIP() << "no test font";
+
+	std::uint32_t font = 0;
+	EXPECT_GT(DrawWithFont(font), 0u);
+	K2D_DestroyFont(font);
+
+	EXPECT_TRUE(Files().empty());
+}
+
+TEST_F(GlyphCacheTest, SavedGlyphsAreNotRasterizedAgain)
+{
+	if (m_Font.empty())
+		GTEST_SKIP() << "no test font";
+
+	std::uint32_t font = 0;
+	EXPECT_GT(DrawWithFont(font), 0u);
+	EXPECT_TRUE(K2D_SaveGlyphCaches());
+	K2D_DestroyFont(font);
+	ASSERT_EQ(Files().size(), 1u);
+
+	EXPECT_EQ(DrawWithFont(font), 0u);
+	K2D_DestroyFont(font);
+}
+
+TEST_F(GlyphCacheTest, DamagedFileIsIgnored)
+{
+	if (m_Font.empty())
+		GTEST_SKIP() << "no test font";
+
+	std::uint32_t font = 0;
+	DrawWithFont(font);
+	EXPECT_TRUE(K2D_SaveGlyphCaches());
+	K2D_DestroyFont(font);
+	ASSERT_EQ(Files().size(), 1u);
+
+	// Cut the file in half
+	const std::string file = m_Directory + "/" + Files()[0];
+	FILE *stream = std::fopen(file.c_str(), "rb");
+	ASSERT_NE(stream, nullptr);
+	std::fseek(stream, 0, SEEK_END);
+	const long size = std::ftell(stream);
+	std::fclose(stream);
+	ASSERT_EQ(truncate(file.c_str(), size / 2), 0);
+
+	EXPECT_GT(DrawWithFont(font), 0u);
+	K2D_DestroyFont(font);
+}
+
+TEST_F(GlyphCacheTest, AddedImagesAreBounded)
+{
+	Kyo2D::GlyphCache cache;
+	const std::wstring directory(m_Directory.begin(), m_Directory.end());
+	EXPECT_FALSE(cache.Open(directory, Kyo2D::GlyphCache::Key{ 1, 14.0f, 0.0f, 0, 1 }));
+
+	// Streams more glyphs of 64x64 than fit into the limit
+	const std::vector<std::uint8_t> image(64 * 64, 0x80);
+	const Kyo2D::GlyphCache::Glyph glyph = { 64, 64, 0.0f, 0.0f, Kyo2D::GlyphCache::image_format::Alpha, image.data() };
+	const std::uint32_t count = static_cast<std::uint32_t>(Kyo2D::GlyphCache::MaxAddedBytes / image.size()) * 2;
+	std::uint32_t added = 0;
+	for (std::uint32_t i = 0; i < count; ++i)
+		added += cache.Add(i, glyph) ? 1 : 0;
+
+	EXPECT_EQ(added, count / 2);
+	EXPECT_LE(cache.GetAddedBytes(), Kyo2D::GlyphCache::MaxAddedBytes);
+
+	// Replacing a kept glyph still works at the limit
+	Kyo2D::GlyphCache::Glyph found;
+	EXPECT_TRUE(cache.Add(0, glyph));
+	EXPECT_TRUE(cache.Find(0, found));
+	EXPECT_FALSE(cache.Find(count - 1, found));
+
+	// Saving writes the kept glyphs and makes room for new ones
+	EXPECT_TRUE(cache.Save());
+	EXPECT_EQ(cache.GetAddedBytes(), 0u);
+	EXPECT_TRUE(cache.Find(added - 1, found));
+	EXPECT_TRUE(cache.Add(count - 1, glyph));
+}
@@ -0,0 +1,86 @@
+#include "Hash.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <set>
+#include <vector>
+
+namespace
+{
+	/// MurmurHash64A as published, for little endian machines.
+	std::uint64_t ReferenceMurmur64A(const void *key, size_t len, std::uint64_t seed)
+	{
+		const std::uint64_t m = 0xC6A4A7935BD1E995ULL;
+		const int r = 47;
+		std::uint64_t h = seed ^ (len * m);
+
+		const std::uint8_t *data = static_cast<const std::uint8_t*>(key);
+		const std::uint8_t *end = data + (len / 8) * 8;
+		while (data != end)
+		{
+			std::uint64_t k;
+			std::memcpy(&k, data, 8);
+			data += 8;
+			k *= m; k ^= k >> r; k *= m;
+			h ^= k; h *= m;
+		}
+
+		switch (len & 7)
+		{
+		case 7: h ^= std::uint64_t(data[6]) << 48; // fall through
+		case 6: h ^= std::uint64_t(data[5]) << 40; // fall through
+		case 5: h ^= std::uint64_t(data[4]) << 32; // fall through
+		case 4: h ^= std::uint64_t(data[3]) << 24; // fall through
+		case 3: h ^= std::uint64_t(data[2]) << 16; // fall through
+		case 2: h ^= std::uint64_t(data[1]) << 8; // fall through
+		case 1: h ^= std::uint64_t(data[0]); h *= m;
+		}
+
+		h ^= h >> r; h *= m; h ^= h >> r;
+		return h;
+	}
+
+	std::vector<std::uint8_t> MakeData(size_t size)
+	{
+		std::vector<std::uint8_t> data(size);
+		for (size_t i = 0; i < size; ++i)
+			data[i] = static_cast<std::uint8_t>(i * 131 + 7);
+		return data;
+	}
+}
+
+TEST(Hash, MatchesMurmurHash64A)
+{
+	const std::vector<std::uint8_t> data = MakeData(100);
+	for (size_t size = 0; size <= data.size(); ++size)
+	{
+		EXPECT_EQ(Kyo2D::Hash(data.data(), size), ReferenceMurmur64A(data.data(), size, Kyo2D::HashSeed)) << size;
+		EXPECT_EQ(Kyo2D::Hash(data.data(), size, 42), ReferenceMurmur64A(data.data(), size, 42)) << size;
+	}
+}
+
+TEST(Hash, DoesNotDependOnAlignment)
+{
+	const std::vector<std::uint8_t> data = MakeData(64);
+	std::vector<std::uint8_t> shifted(data.size() + 8);
+	for (size_t offset = 1; offset < 8; ++offset)
+	{
+		std::memcpy(shifted.data() + offset, data.data(), data.size());
+		EXPECT_EQ(Kyo2D::Hash(shifted.data() + offset, data.size()), Kyo2D::Hash(data.data(), data.size()));
+	}
+}
+
+TEST(Hash, PrefixesAndSeedsDiffer)
+{
+	const std::vector<std::uint8_t> data = MakeData(64);
+	std::set<std::uint64_t> hashes;
+	for (size_t size = 0; size <= data.size(); ++size)
+	{
+		hashes.insert(Kyo2D::Hash(data.data(), size));
+		hashes.insert(Kyo2D::Hash(data.data(), size, Kyo2D::Hash(data.data(), 4)));
+	}
+	EXPECT_EQ(hashes.size(), 2 * (data.size() + 1));
+
+	// A trailing zero byte changes the hash
+	const std::uint8_t zeros[2] = { 0, 0 };
+	EXPECT_NE(Kyo2D::Hash(zeros, 1), Kyo2D::Hash(zeros, 2));
+}
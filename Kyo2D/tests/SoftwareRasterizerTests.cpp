@@ -0,0 +1,303 @@
+#include "Kyo2D.h"
+#include "Software/SoftwareRasterizer.h"
+#include "Software/WorkerPool.h"
+#include <gtest/gtest.h>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+using Kyo2D::SoftwareImage;
+using Kyo2D::SoftwareRasterizer;
+
+namespace
+{
+	const std::uint32_t Black = 0xFF000000;
+	const std::uint32_t White = 0xFFFFFFFF;
+	const std::uint32_t Red = 0xFF0000FF;
+	const std::uint32_t Blue = 0xFFFF0000;
+	const std::uint32_t Magenta = 0xFFFF00FF;
+
+	std::shared_ptr<SoftwareImage> CreateImage(std::int32_t width, std::int32_t height, std::uint32_t color)
+	{
+		std::shared_ptr<SoftwareImage> image = std::make_shared<SoftwareImage>();
+		image->Width = width;
+		image->Height = height;
+		image->Pixels.assign(static_cast<size_t>(width) * static_cast<size_t>(height), color);
+		return image;
+	}
+
+	/// Renders into a new target using a single thread and returns its pixels.
+	std::vector<std::uint32_t> Render(std::int32_t width, std::int32_t height, bool vectorized, const std::function<void(SoftwareRasterizer&)> &draw)
+	{
+		Kyo2D::WorkerPool workers;
+		workers.Initialize(1);
+
+		SoftwareRasterizer rasterizer;
+		rasterizer.SetVectorized(vectorized);
+		rasterizer.SetTarget(CreateImage(width, height, Black));
+		draw(rasterizer);
+		rasterizer.Flush(workers);
+		return rasterizer.GetTarget()->Pixels;
+	}
+
+	/// Draws an unrotated, unscaled sprite with its top left corner at the given pixel.
+	void DrawAt(SoftwareRasterizer &rasterizer, const std::shared_ptr<const SoftwareImage> &texture, float x, float y, std::uint32_t color, bool premultiplied)
+	{
+		rasterizer.DrawSprite(texture, x + texture->Width * 0.5f, y + texture->Height * 0.5f, static_cast<float>(texture->Width), static_cast<float>(texture->Height), 0.0f,
+			0.0f, 0.0f, 1.0f, 1.0f, color, 0, false, premultiplied, false);
+	}
+
+	/// Renders through the engine into a headless target of the software backend.
+	class SoftwareRendererTest : public ::testing::Test
+	{
+	protected:
+
+		static const std::uint32_t Width = 200;
+		static const std::uint32_t Height = 150;
+
+		virtual void SetUp() override
+		{
+			// Several threads, so tiles are rasterized in parallel
+			K2D_InitSoftware(4);
+			m_Target = K2D_CreateRenderTarget(nullptr, Width, Height, false);
+			ASSERT_NE(m_Target, 0u);
+			K2D_SetRenderTarget(m_Target);
+			K2D_ClearRenderTarget(0.0f, 0.0f, 1.0f);
+		}
+
+		virtual void TearDown() override
+		{
+			K2D_Terminate();
+		}
+
+		/// Presents the frame and reads back the target.
+		std::vector<std::uint32_t> Present()
+		{
+			std::vector<std::uint32_t> pixels(Width * Height);
+			K2D_PresentRenderTarget();
+			EXPECT_TRUE(K2D_ReadRenderTargetPixels(m_Target, pixels.data(), static_cast<std::uint32_t>(pixels.size())));
+			return pixels;
+		}
+
+		std::uint32_t m_Target;
+	};
+}
+
+TEST(SoftwareRasterizer, VectorizedMatchesScalar)
+{
+	SoftwareRasterizer probe;
+	probe.SetVectorized(true);
+	if (!probe.IsVectorized())
+		GTEST_SKIP() << "no SSE2";
+
+	// Textures with random colors and alpha, where some texels match the colorkey
+	const std::uint32_t colorkey = 0xFF00FF00;
+	std::mt19937 random(11);
+	std::vector<std::shared_ptr<const SoftwareImage>> textures;
+	for (std::int32_t size : { 1, 3, 8, 17 })
+	{
+		std::shared_ptr<SoftwareImage> texture = CreateImage(size, size + 2, 0);
+		for (std::uint32_t &pixel : texture->Pixels)
+			pixel = random() % 4 ? static_cast<std::uint32_t>(random()) : colorkey;
+		textures.push_back(texture);
+	}
+	std::shared_ptr<SoftwareImage> alpha = CreateImage(16, 16, 0);
+	alpha->Pixels.clear();
+	for (int i = 0; i < 16 * 16; ++i)
+		alpha->Alpha.push_back(static_cast<std::uint8_t>(random()));
+	textures.push_back(alpha);
+
+	// The target size isn't a multiple of the tile size or of four pixels
+	auto draw = [&](SoftwareRasterizer &rasterizer)
+	{
+		std::mt19937 random(5);
+		std::uniform_real_distribution<float> position(-20.0f, 170.0f), size(-60.0f, 60.0f), angle(-3.2f, 3.2f), uv(-1.0f, 2.0f);
+		for (int i = 0; i < 300; ++i)
+		{
+			const std::shared_ptr<const SoftwareImage> &texture = textures[random() % textures.size()];
+			const bool distanceField = !texture->Alpha.empty() && random() % 2;
+			const std::uint32_t flags = random();
+			rasterizer.DrawSprite(texture, position(random), position(random), size(random), size(random), i % 3 ? angle(random) : 0.0f,
+				uv(random), uv(random), uv(random), uv(random), static_cast<std::uint32_t>(random()), distanceField ? 0x2080 : colorkey,
+				(flags & 1) != 0, (flags & 2) != 0, distanceField);
+
+			if (i % 10 == 0)
+			{
+				rasterizer.FillRect(position(random), position(random), size(random), size(random), static_cast<std::uint32_t>(random()));
+				rasterizer.DrawLine(position(random), position(random), position(random), position(random), static_cast<std::uint32_t>(random()));
+				rasterizer.DrawPoint(position(random), position(random), static_cast<std::uint32_t>(random()));
+			}
+		}
+	};
+
+	const std::vector<std::uint32_t> scalar = Render(151, 133, false, draw);
+	const std::vector<std::uint32_t> vectorized = Render(151, 133, true, draw);
+	ASSERT_EQ(scalar.size(), vectorized.size());
+	size_t mismatches = 0;
+	for (size_t i = 0; i < scalar.size(); ++i)
+		mismatches += scalar[i] != vectorized[i];
+	EXPECT_EQ(mismatches, 0u);
+
+	// Make sure the scene actually covers the target
+	size_t untouched = 0;
+	for (std::uint32_t pixel : scalar)
+		untouched += pixel == Black;
+	EXPECT_LT(untouched, scalar.size() / 4);
+}
+
+TEST(SoftwareRasterizer, ScissorClipsDrawsButNotClears)
+{
+	for (bool vectorized : { false, true })
+	{
+		std::vector<std::uint32_t> pixels = Render(100, 100, vectorized, [](SoftwareRasterizer &rasterizer)
+		{
+			rasterizer.SetScissor(30, 40, 70, 65);
+			rasterizer.FillRect(0.0f, 0.0f, 100.0f, 100.0f, Red);
+			DrawAt(rasterizer, CreateImage(100, 100, Blue), 0.0f, 0.0f, White, false);
+			rasterizer.ClearRect(0, 0, 10, 10, White);
+		});
+
+		for (std::int32_t y = 0; y < 100; ++y)
+		{
+			for (std::int32_t x = 0; x < 100; ++x)
+			{
+				std::uint32_t expected = Black;
+				if (x < 10 && y < 10)
+					expected = White;
+				else if (x >= 30 && x < 70 && y >= 40 && y < 65)
+					expected = Blue;
+				ASSERT_EQ(pixels[y * 100 + x], expected) << "at " << x << ", " << y << (vectorized ? ", vectorized" : "");
+			}
+		}
+	}
+}
+
+TEST(SoftwareRasterizer, StraightAlphaBlending)
+{
+	for (bool vectorized : { false, true })
+	{
+		std::vector<std::uint32_t> pixels = Render(8, 1, vectorized, [](SoftwareRasterizer &rasterizer)
+		{
+			rasterizer.FillRect(0.0f, 0.0f, 8.0f, 1.0f, Red);
+			std::shared_ptr<SoftwareImage> texture = CreateImage(7, 1, 0x8000FF00);
+			// Transparent texels leave the color of the target
+			texture->Pixels[5] = 0x00404040;
+			// The vertex color is multiplied with the texel
+			DrawAt(rasterizer, texture, 0.0f, 0.0f, 0xFFFFFFFF, false);
+			DrawAt(rasterizer, CreateImage(1, 1, White), 7.0f, 0.0f, 0x80FFFFFF, false);
+		});
+
+		// Red: 255 * 127 / 255, green: 255 * 128 / 255, the alpha is the one of the source
+		EXPECT_EQ(pixels[0], 0x8000807Fu);
+		EXPECT_EQ(pixels[5], 0x000000FFu);
+		EXPECT_EQ(pixels[7], 0x808080FFu);
+	}
+}
+
+TEST(SoftwareRasterizer, PremultipliedAlphaBlending)
+{
+	for (bool vectorized : { false, true })
+	{
+		std::vector<std::uint32_t> pixels = Render(8, 1, vectorized, [](SoftwareRasterizer &rasterizer)
+		{
+			rasterizer.FillRect(0.0f, 0.0f, 8.0f, 1.0f, 0xFF202020);
+			std::shared_ptr<SoftwareImage> texture = CreateImage(8, 1, 0x80008000);
+			// Texels without alpha are added to the target, and saturate
+			texture->Pixels[5] = 0x00404040;
+			texture->Pixels[6] = 0x00F0F0F0;
+			DrawAt(rasterizer, texture, 0.0f, 0.0f, 0xFFFFFFFF, true);
+		});
+
+		// The same result as straight alpha for premultiplied colors
+		EXPECT_EQ(pixels[0], 0x80109010u);
+		EXPECT_EQ(pixels[5], 0x00606060u);
+		EXPECT_EQ(pixels[6], 0x00FFFFFFu);
+	}
+}
+
+TEST_F(SoftwareRendererTest, ColorkeyedTexelsAreSkipped)
+{
+	// A checkerboard of white and magenta texels
+	std::vector<std::uint32_t> texels(8 * 8);
+	for (std::uint32_t y = 0; y < 8; ++y)
+	{
+		for (std::uint32_t x = 0; x < 8; ++x)
+			texels[y * 8 + x] = (x + y) % 2 ? Magenta : White;
+	}
+	std::uint32_t texture = K2D_CreateTextureFromPixels(8, 8, K2D_PIXEL_RGBA8, 0, texels.data());
+	ASSERT_NE(texture, 0u);
+	K2D_SetScale2XEnabled(false);
+	K2D_DrawSpriteAt(texture, 10.0f, 20.0f, 0.0f, 0.0f, 0xFFFFFFFF, Magenta);
+	// Without a matching colorkey, every texel is drawn
+	K2D_DrawSpriteAt(texture, 30.0f, 20.0f, 0.0f, 0.0f, 0xFFFFFFFF, 0);
+
+	std::vector<std::uint32_t> pixels = Present();
+	for (std::uint32_t y = 0; y < 8; ++y)
+	{
+		for (std::uint32_t x = 0; x < 8; ++x)
+		{
+			EXPECT_EQ(pixels[(20 + y) * Width + 10 + x], (x + y) % 2 ? Blue : White) << "at " << x << ", " << y;
+			EXPECT_EQ(pixels[(20 + y) * Width + 30 + x], texels[y * 8 + x]) << "at " << x << ", " << y;
+		}
+	}
+}
+
+TEST_F(SoftwareRendererTest, Scale2XSmoothsDiagonals)
+{
+	// Black with two white texels touching diagonally, between texels (0, 0) and (1, 1)
+	std::vector<std::uint32_t> texels(4 * 4, Black);
+	texels[0 * 4 + 1] = White;
+	texels[1 * 4 + 0] = White;
+	std::uint32_t texture = K2D_CreateTextureFromPixels(4, 4, K2D_PIXEL_RGBA8, 0, texels.data());
+	ASSERT_NE(texture, 0u);
+
+	K2D_SetScale2XEnabled(false);
+	K2D_DrawSpriteScaled(texture, 0.0f, 0.0f, 8.0f, 8.0f, 0.0f, 0.0f, 0xFFFFFFFF, 0);
+	K2D_SetScale2XEnabled(true);
+	K2D_DrawSpriteScaled(texture, 20.0f, 0.0f, 8.0f, 8.0f, 0.0f, 0.0f, 0xFFFFFFFF, 0);
+
+	std::vector<std::uint32_t> pixels = Present();
+	for (std::uint32_t y = 0; y < 8; ++y)
+	{
+		for (std::uint32_t x = 0; x < 8; ++x)
+		{
+			// The quadrants of the black texels facing the diagonal take the color of their neighbors
+			const std::uint32_t texel = texels[(y / 2) * 4 + x / 2];
+			EXPECT_EQ(pixels[y * Width + x], texel) << "at " << x << ", " << y;
+			EXPECT_EQ(pixels[y * Width + 20 + x], (x == 1 && y == 1) || (x == 2 && y == 2) ? White : texel) << "at " << x << ", " << y;
+		}
+	}
+}
+
+TEST_F(SoftwareRendererTest, SpritesAcrossTileEdges)
+{
+	// Texels with unique colors, drawn over the corner shared by four 64x64 tiles and over
+	// the right and bottom edge of the target
+	std::vector<std::uint32_t> texels(40 * 40);
+	for (std::uint32_t i = 0; i < texels.size(); ++i)
+		texels[i] = 0xFF000000 | (i * 2654435761u >> 8);
+	std::uint32_t texture = K2D_CreateTextureFromPixels(40, 40, K2D_PIXEL_RGBA8, 0, texels.data());
+	ASSERT_NE(texture, 0u);
+	K2D_SetScale2XEnabled(false);
+
+	const std::int32_t positions[][2] = { { 44, 44 }, { 107, 3 }, { 180, 130 } };
+	for (const auto &position : positions)
+		K2D_DrawSpriteAt(texture, static_cast<float>(position[0]), static_cast<float>(position[1]), 0.0f, 0.0f, 0xFFFFFFFF, 0);
+
+	std::vector<std::uint32_t> pixels = Present();
+	for (std::int32_t y = 0; y < static_cast<std::int32_t>(Height); ++y)
+	{
+		for (std::int32_t x = 0; x < static_cast<std::int32_t>(Width); ++x)
+		{
+			std::uint32_t expected = Blue;
+			for (const auto &position : positions)
+			{
+				const std::int32_t u = x - position[0], v = y - position[1];
+				if (u >= 0 && u < 40 && v >= 0 && v < 40)
+					expected = texels[v * 40 + u];
+			}
+			ASSERT_EQ(pixels[y * Width + x], expected) << "at " << x << ", " << y;
+		}
+	}
+}
@@ -0,0 +1,109 @@
+#include "SpanCompositor.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+
+using Kyo2D::SpanCompositor;
+
+namespace
+{
+	/// Blends one pixel the way glyph images were composited before SpanCompositor, in floats.
+	std::uint32_t BlendWhiteFloat(std::uint32_t pixel, int coverage)
+	{
+		std::uint32_t result = 0;
+		for (std::uint32_t shift = 0; shift < 24; shift += 8)
+		{
+			const int channel = static_cast<int>((pixel >> shift) & 0xFF);
+			const int blended = (int)(channel + ((255 - channel) * coverage) / 255.0f);
+			result |= static_cast<std::uint32_t>(blended) << shift;
+		}
+
+		const int alpha = std::min(255, static_cast<int>(pixel >> 24) + coverage);
+		return result | (static_cast<std::uint32_t>(alpha) << 24);
+	}
+
+	/// Pixel with each channel derived from v, so every channel takes all values over v = 0..255.
+	std::uint32_t MakePixel(std::uint32_t v)
+	{
+		return v | (((255 - v) & 0xFF) << 8) | (((v * 7) & 0xFF) << 16) | (((v * 13 + 5) & 0xFF) << 24);
+	}
+}
+
+TEST(SpanCompositor, BlendWhiteMatchesScalarAndFloat)
+{
+	// One row per coverage, one column per channel value
+	const std::int32_t size = 256;
+	SpanCompositor::Target target = { size, 0, size - 1 };
+	std::vector<std::uint32_t> image(size * size);
+	for (std::int32_t row = 0; row < size; ++row)
+	{
+		for (std::int32_t x = 0; x < size; ++x)
+			image[row * size + x] = MakePixel(static_cast<std::uint32_t>(x));
+	}
+	const std::vector<std::uint32_t> original = image;
+
+	// Ragged span widths, so the SSE2 loop and the scalar tail both see every column
+	SpanCompositor::Spans spans;
+	for (int coverage = 0; coverage < size; ++coverage)
+	{
+		int width = 1 + coverage % 7;
+		for (int x = 0; x < size; x += width, width = width % 13 + 1)
+			spans.push_back(SpanCompositor::Span(x, target.Top - coverage, std::min(width, size - x), coverage));
+	}
+
+	SpanCompositor::BlendWhite(target, spans, image.data());
+
+	for (int coverage = 0; coverage < size; ++coverage)
+	{
+		for (int x = 0; x < size; ++x)
+		{
+			const std::uint32_t source = original[coverage * size + x];
+			const std::uint32_t scalar = SpanCompositor::BlendWhitePixel(source, static_cast<std::uint32_t>(coverage));
+			const std::uint32_t reference = BlendWhiteFloat(source, coverage);
+			ASSERT_EQ(scalar, reference) << "pixel " << std::hex << source << " coverage " << std::dec << coverage;
+			ASSERT_EQ(image[coverage * size + x], reference) << "pixel " << std::hex << source << " coverage " << std::dec << coverage;
+		}
+	}
+}
+
+TEST(SpanCompositor, BlendWhiteOnlyTouchesSpans)
+{
+	SpanCompositor::Target target = { 16, 10, 20 };
+	std::vector<std::uint32_t> image(16 * 4, 0x11223344);
+
+	// Spans of 5 and 3 pixels in the second row, starting at column 2 and 9 of the image
+	SpanCompositor::Spans spans;
+	spans.push_back(SpanCompositor::Span(12, 19, 5, 200));
+	spans.push_back(SpanCompositor::Span(19, 19, 3, 40));
+	SpanCompositor::BlendWhite(target, spans, image.data());
+
+	for (int i = 0; i < 16 * 4; ++i)
+	{
+		const int row = i / 16, column = i % 16;
+		std::uint32_t expected = 0x11223344;
+		if (row == 1 && column >= 2 && column < 7)
+			expected = BlendWhiteFloat(0x11223344, 200);
+		else if (row == 1 && column >= 9 && column < 12)
+			expected = BlendWhiteFloat(0x11223344, 40);
+		EXPECT_EQ(image[i], expected) << "row " << row << " column " << column;
+	}
+}
+
+TEST(SpanCompositor, FillCoverageAndColor)
+{
+	SpanCompositor::Target target = { 8, 0, 1 };
+	SpanCompositor::Spans spans;
+	spans.push_back(SpanCompositor::Span(1, 1, 3, 128));
+	spans.push_back(SpanCompositor::Span(4, 0, 4, 255));
+
+	std::vector<std::uint8_t> coverage(16, 0);
+	SpanCompositor::FillCoverage(target, spans, coverage.data());
+	std::vector<std::uint32_t> color(16, 0);
+	SpanCompositor::FillColor(target, spans, 0xFF102030, color.data());
+
+	const std::uint8_t expected[16] = { 0, 128, 128, 128, 0, 0, 0, 0, 0, 0, 0, 0, 255, 255, 255, 255 };
+	for (int i = 0; i < 16; ++i)
+	{
+		EXPECT_EQ(coverage[i], expected[i]);
+		EXPECT_EQ(color[i], expected[i] ? (0x00102030u | (static_cast<std::uint32_t>(expected[i]) << 24)) : 0u);
+	}
+}
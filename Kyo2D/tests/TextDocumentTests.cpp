@@ -0,0 +1,232 @@
+#include "Kyo2D.h"
+#include "TextDocument.h"
+#include "EngineContext.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using Kyo2D::TextDocument;
+using Kyo2D::TextView;
+
+namespace
+{
+	const char *Paragraphs =
+		"The quick brown fox jumps over the lazy dog.\n"
+		"Pack my box with five dozen liquor jugs, then sphinx of black quartz, judge my vow. "
+		"How vexingly quick daft zebras jump, and the five boxing wizards jump quickly.\n"
+		"\n"
+		"Short\n"
+		"Jackdaws love my big sphinx of quartz, and a wizard's job is to vex chumps quickly in fog.";
+
+	/// Runs the null backend with the test font.
+	class TextDocumentTest : public ::testing::Test
+	{
+	protected:
+
+		virtual void SetUp() override
+		{
+#ifndef KYO2D_TEST_FONT
+			GTEST_SKIP() << "no test font";
+#else
+			K2D_InitNull();
+			const std::string filename = KYO2D_TEST_FONT;
+			const std::wstring font(filename.begin(), filename.end());
+			std::uint32_t fontId = K2D_CreateFont(font.c_str(), 16.0f, 0.0f);
+			ASSERT_NE(fontId, 0u);
+			m_Font = g_Context->Fonts[fontId];
+			m_LineSpacing = m_Font->getLineSpacing(1.0f);
+#endif
+		}
+
+		virtual void TearDown() override
+		{
+#ifdef KYO2D_TEST_FONT
+			m_Font.reset();
+			K2D_Terminate();
+#endif
+		}
+
+		static void Append(TextDocument &document, const std::string &text)
+		{
+			document.Append(TextView(text.data(), text.size()));
+		}
+
+		/// Gets the lines visible in a range as [first, end).
+		static std::pair<size_t, size_t> Visible(const TextDocument &document, double top, float height)
+		{
+			size_t first, end;
+			document.GetVisibleLines(top, height, first, end);
+			return std::make_pair(first, end);
+		}
+
+		std::shared_ptr<Kyo2D::Font> m_Font;
+		float m_LineSpacing;
+	};
+}
+
+TEST_F(TextDocumentTest, AppendContinuesOpenParagraph)
+{
+	TextDocument document;
+	document.Initialize(m_Font, 1.0f, 0.0f, 0.0f);
+	Append(document, "Hello ");
+	Append(document, "world");
+	EXPECT_EQ(document.GetParagraphCount(), 1u);
+	EXPECT_EQ(document.GetLineCount(), 1u);
+
+	// The continued paragraph wraps like the whole text appended at once
+	TextDocument wrapped, whole;
+	wrapped.Initialize(m_Font, 1.0f, 120.0f, 0.0f);
+	whole.Initialize(m_Font, 1.0f, 120.0f, 0.0f);
+	Append(wrapped, "The quick brown ");
+	const size_t lines = wrapped.GetLineCount();
+	Append(wrapped, "fox jumps over the lazy dog");
+	Append(whole, "The quick brown fox jumps over the lazy dog");
+	EXPECT_GT(wrapped.GetLineCount(), lines);
+	EXPECT_EQ(wrapped.GetParagraphCount(), 1u);
+	EXPECT_EQ(wrapped.GetLineCount(), whole.GetLineCount());
+	EXPECT_EQ(wrapped.GetHeight(), whole.GetHeight());
+}
+
+TEST_F(TextDocumentTest, TrailingNewlineEndsParagraph)
+{
+	TextDocument document;
+	document.Initialize(m_Font, 1.0f, 0.0f, 10.0f);
+	Append(document, "a\n");
+	EXPECT_EQ(document.GetParagraphCount(), 1u);
+	EXPECT_DOUBLE_EQ(document.GetHeight(), m_LineSpacing + 10.0);
+
+	// The next append starts a new paragraph instead of continuing the closed one
+	Append(document, "b");
+	EXPECT_EQ(document.GetParagraphCount(), 2u);
+
+	// An empty paragraph between two newlines still takes a line
+	Append(document, "\n\n");
+	EXPECT_EQ(document.GetParagraphCount(), 3u);
+	EXPECT_EQ(document.GetLineCount(), 3u);
+	EXPECT_DOUBLE_EQ(document.GetHeight(), 3.0 * (m_LineSpacing + 10.0));
+
+	// An empty append changes nothing
+	Append(document, "");
+	EXPECT_EQ(document.GetParagraphCount(), 3u);
+}
+
+TEST_F(TextDocumentTest, PiecewiseAppendMatchesWholeText)
+{
+	// Only the last paragraph is broken into lines again, pieces cut anywhere give the same lines
+	const std::string text = Paragraphs;
+	TextDocument whole;
+	whole.Initialize(m_Font, 1.0f, 150.0f, 4.0f);
+	Append(whole, text);
+	ASSERT_EQ(whole.GetParagraphCount(), 5u);
+	ASSERT_GT(whole.GetLineCount(), 8u);
+
+	std::mt19937 random(9);
+	for (int test = 0; test < 20; ++test)
+	{
+		TextDocument pieces;
+		pieces.Initialize(m_Font, 1.0f, 150.0f, 4.0f);
+		for (size_t start = 0; start < text.size(); )
+		{
+			const size_t length = std::min<size_t>(random() % 12, text.size() - start);
+			Append(pieces, text.substr(start, length));
+			start += length;
+		}
+
+		ASSERT_EQ(pieces.GetParagraphCount(), whole.GetParagraphCount());
+		ASSERT_EQ(pieces.GetLineCount(), whole.GetLineCount());
+		ASSERT_EQ(pieces.GetHeight(), whole.GetHeight());
+		for (double top = -10.0; top < whole.GetHeight() + 10.0; top += 3.0)
+			ASSERT_EQ(Visible(pieces, top, 40.0f), Visible(whole, top, 40.0f)) << "test " << test << ", top " << top;
+	}
+}
+
+TEST_F(TextDocumentTest, ContinuingLastParagraphKeepsEarlierOnes)
+{
+	TextDocument document;
+	document.Initialize(m_Font, 1.0f, 150.0f, 4.0f);
+	Append(document, Paragraphs);
+	const size_t lines = document.GetLineCount();
+	const double height = document.GetHeight();
+	std::vector<std::pair<size_t, size_t>> before;
+	for (double top = 0.0; top < height; top += 1.0)
+		before.push_back(Visible(document, top, 0.5f));
+
+	// The last paragraph gets more lines, the earlier lines stay where they were
+	Append(document, " More words to wrap onto further lines of the last paragraph.");
+	EXPECT_EQ(document.GetParagraphCount(), 5u);
+	EXPECT_GT(document.GetLineCount(), lines);
+	EXPECT_DOUBLE_EQ(document.GetHeight(), height + (document.GetLineCount() - lines) * static_cast<double>(m_LineSpacing));
+	for (size_t i = 0; i < before.size(); ++i)
+	{
+		// Only the old last line may break differently
+		if (before[i].second < lines)
+		{
+			EXPECT_EQ(Visible(document, static_cast<double>(i), 0.5f), before[i]) << "top " << i;
+		}
+	}
+}
+
+TEST_F(TextDocumentTest, VisibleLinesAtParagraphEdges)
+{
+	// Three paragraphs of one line each, with a gap of 10 pixels below each
+	TextDocument document;
+	document.Initialize(m_Font, 1.0f, 0.0f, 10.0f);
+	Append(document, "one\ntwo\nthree");
+	const double pitch = m_LineSpacing + 10.0;
+	ASSERT_DOUBLE_EQ(document.GetHeight(), 3.0 * pitch);
+	typedef std::pair<size_t, size_t> Lines;
+
+	// Ranges ending at the top of a line don't include it
+	EXPECT_EQ(Visible(document, 0.0, m_LineSpacing), Lines(0, 1));
+	EXPECT_EQ(Visible(document, 0.0, static_cast<float>(pitch)), Lines(0, 1));
+	EXPECT_EQ(Visible(document, 0.0, static_cast<float>(pitch + 0.5)), Lines(0, 2));
+
+	// Starting exactly at the top of a paragraph, and just above it inside the previous line
+	EXPECT_EQ(Visible(document, pitch, m_LineSpacing), Lines(1, 2));
+	EXPECT_EQ(Visible(document, m_LineSpacing - 0.5, 1.0f), Lines(0, 1));
+
+	// Inside the gap below a paragraph, nothing or the next paragraph
+	EXPECT_EQ(Visible(document, m_LineSpacing + 2.0, 5.0f), Lines(1, 1));
+	EXPECT_EQ(Visible(document, m_LineSpacing + 2.0, 10.0f), Lines(1, 2));
+
+	// Above the document, the whole document and below it
+	EXPECT_EQ(Visible(document, -100.0, 50.0f), Lines(0, 0));
+	EXPECT_EQ(Visible(document, -10.0, 20.0f), Lines(0, 1));
+	EXPECT_EQ(Visible(document, 0.0, static_cast<float>(document.GetHeight())), Lines(0, 3));
+	EXPECT_EQ(Visible(document, 2.0 * pitch + m_LineSpacing - 1.0, 100.0f), Lines(2, 3));
+	EXPECT_EQ(Visible(document, document.GetHeight(), 100.0f), Lines(3, 3));
+	EXPECT_EQ(Visible(document, document.GetHeight() + 1000.0, 100.0f), Lines(3, 3));
+
+	// An empty document has no lines
+	TextDocument empty;
+	empty.Initialize(m_Font, 1.0f, 0.0f, 10.0f);
+	EXPECT_EQ(Visible(empty, 0.0, 100.0f), Lines(0, 0));
+}
+
+TEST_F(TextDocumentTest, VisibleLinesInsideWrappedParagraph)
+{
+	TextDocument document;
+	document.Initialize(m_Font, 1.0f, 150.0f, 4.0f);
+	Append(document, Paragraphs);
+
+	size_t first, end;
+	document.GetVisibleLines(0.0, 0.5f, first, end);
+	ASSERT_EQ(first, 0u);
+	ASSERT_EQ(end, 1u);
+	const size_t count = document.GetLineCount();
+	for (size_t line = 0; line < count; ++line)
+	{
+		// Every line is visible on its own somewhere, and lines follow each other
+		bool found = false;
+		for (double top = 0.0; top < document.GetHeight() && !found; top += 1.0)
+		{
+			document.GetVisibleLines(top, 0.5f, first, end);
+			found = first == line && end == line + 1;
+		}
+		EXPECT_TRUE(found) << "line " << line;
+	}
+}
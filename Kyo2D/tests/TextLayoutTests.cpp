@@ -0,0 +1,201 @@
+#include "Kyo2D.h"
+#include "TextLayout.h"
+#include "EngineContext.h"
+#include "Hash.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstring>
+
+using Kyo2D::TextLayout;
+using Kyo2D::TextLayoutCache;
+using Kyo2D::TextView;
+
+namespace
+{
+	const std::uint64_t M = 0xC6A4A7935BD1E995ULL;
+	const int R = 47;
+
+	/// The mixing step Hash applies to each word.
+	std::uint64_t Mix(std::uint64_t k)
+	{
+		k *= M;
+		k ^= k >> R;
+		k *= M;
+		return k;
+	}
+
+	/// Inverts Mix.
+	std::uint64_t Unmix(std::uint64_t k)
+	{
+		// Inverse of M modulo 2^64 by Newton's iteration, each step doubles the correct bits
+		std::uint64_t inverse = M;
+		for (int i = 0; i < 5; ++i)
+			inverse *= 2 - M * inverse;
+
+		k *= inverse;
+		k ^= k >> R;
+		k *= inverse;
+		return k;
+	}
+
+	/// Creates a text of four codepoints whose hash equals the one of the given text for any seed.
+	/// Hash multiplies the state with an odd number after each word, which keeps a difference in
+	/// the top bit in the top bit. The words of the text are mixed with the top bit flipped after
+	/// the first word and flipped back after the second.
+	std::u32string Collide(const std::u32string &text)
+	{
+		std::uint64_t words[2];
+		std::memcpy(words, text.data(), sizeof(words));
+		words[0] = Unmix(Mix(words[0]) ^ 0x8000000000000000ULL);
+		words[1] = Unmix(Mix(words[1]) ^ 0x8000000000000000ULL);
+
+		std::u32string collision(4, U' ');
+		std::memcpy(&collision[0], words, sizeof(words));
+		return collision;
+	}
+
+	TextView View(const std::u32string &text)
+	{
+		return TextView(text.data(), text.size());
+	}
+
+	/// Runs the software backend with the test font.
+	class TextLayoutTest : public ::testing::Test
+	{
+	protected:
+
+		static const std::uint32_t Width = 256;
+		static const std::uint32_t Height = 64;
+
+		virtual void SetUp() override
+		{
+#ifndef KYO2D_TEST_FONT
+			GTEST_SKIP() << "no test font";
+#else
+			K2D_InitSoftware(1);
+			m_Target = K2D_CreateRenderTarget(nullptr, Width, Height, false);
+			K2D_SetRenderTarget(m_Target);
+			const std::string filename = KYO2D_TEST_FONT;
+			m_Filename.assign(filename.begin(), filename.end());
+			m_FontId = K2D_CreateFont(m_Filename.c_str(), 16.0f, 0.0f);
+			ASSERT_NE(m_FontId, 0u);
+#endif
+		}
+
+		virtual void TearDown() override
+		{
+#ifdef KYO2D_TEST_FONT
+			K2D_Terminate();
+#endif
+		}
+
+		std::shared_ptr<Kyo2D::Font> GetFont(std::uint32_t fontId)
+		{
+			return g_Context->Fonts[fontId];
+		}
+
+		/// Draws a text through the layout cache and reads back the frame.
+		std::vector<std::uint32_t> DrawText(const std::u16string &text)
+		{
+			K2D_ClearRenderTarget(0.0f, 0.0f, 0.0f);
+			EXPECT_TRUE(K2D_DrawTextUtf16(m_FontId, text.data(), static_cast<std::uint32_t>(text.size()), 4.0f, 4.0f, 0xFFFFFFFF));
+			K2D_PresentRenderTarget();
+
+			std::vector<std::uint32_t> pixels(Width * Height);
+			EXPECT_TRUE(K2D_ReadRenderTargetPixels(m_Target, pixels.data(), static_cast<std::uint32_t>(pixels.size())));
+			return pixels;
+		}
+
+		std::uint32_t m_Target;
+		std::wstring m_Filename;
+		std::uint32_t m_FontId;
+	};
+}
+
+TEST_F(TextLayoutTest, CollidingTextsGetTheirOwnLayouts)
+{
+	const std::u32string text = U"Kyo!";
+	const std::u32string collision = Collide(text);
+	ASSERT_NE(collision, text);
+	ASSERT_EQ(Kyo2D::Hash(collision.data(), 16, 1234), Kyo2D::Hash(text.data(), 16, 1234));
+
+	TextLayoutCache cache;
+	std::shared_ptr<Kyo2D::Font> font = GetFont(m_FontId);
+	TextLayout &layout = cache.Get(m_FontId, font, View(text));
+	TextLayout &other = cache.Get(m_FontId, font, View(collision));
+	EXPECT_NE(&layout, &other);
+	EXPECT_EQ(layout.GetText(), text);
+	EXPECT_EQ(cache.GetSize(), 2u);
+
+	// Both are found again in the shared bucket
+	EXPECT_EQ(&cache.Get(m_FontId, font, View(text)), &layout);
+	EXPECT_EQ(&cache.Get(m_FontId, font, View(collision)), &other);
+	EXPECT_EQ(cache.GetSize(), 2u);
+}
+
+TEST_F(TextLayoutTest, UnusedLayoutsAreDroppedAfterMaxAge)
+{
+	TextLayoutCache cache;
+	std::shared_ptr<Kyo2D::Font> font = GetFont(m_FontId);
+	const std::u32string unused = U"unused", used = U"used";
+	cache.Get(m_FontId, font, View(unused));
+	TextLayout &layout = cache.Get(m_FontId, font, View(used));
+
+	// The layout drawn every frame stays, the other one is kept for MaxAge frames
+	for (std::uint32_t frame = 0; frame < TextLayoutCache::MaxAge; ++frame)
+	{
+		ASSERT_EQ(&cache.Get(m_FontId, font, View(used)), &layout);
+		cache.EndFrame();
+	}
+	EXPECT_EQ(cache.GetSize(), 2u);
+
+	cache.Get(m_FontId, font, View(used));
+	cache.EndFrame();
+	EXPECT_EQ(cache.GetSize(), 1u);
+	EXPECT_EQ(&cache.Get(m_FontId, font, View(used)), &layout);
+}
+
+TEST_F(TextLayoutTest, RemoveFontDropsOnlyItsLayouts)
+{
+	const std::uint32_t otherId = K2D_CreateFont(m_Filename.c_str(), 20.0f, 0.0f);
+	ASSERT_NE(otherId, 0u);
+
+	TextLayoutCache cache;
+	const std::u32string text = U"Same text";
+	cache.Get(m_FontId, GetFont(m_FontId), View(text));
+	TextLayout &layout = cache.Get(otherId, GetFont(otherId), View(text));
+	EXPECT_EQ(cache.GetSize(), 2u);
+
+	cache.RemoveFont(m_FontId);
+	EXPECT_EQ(cache.GetSize(), 1u);
+	EXPECT_EQ(&cache.Get(otherId, GetFont(otherId), View(text)), &layout);
+
+	// Destroying a font drops its layouts from the cache of the engine
+	const std::u16string drawn = u"Drawn";
+	DrawText(drawn);
+	EXPECT_EQ(g_Context->LayoutCache.GetSize(), 1u);
+	K2D_DestroyFont(m_FontId);
+	EXPECT_EQ(g_Context->LayoutCache.GetSize(), 0u);
+}
+
+TEST_F(TextLayoutTest, LayoutFollowsAtlasGeneration)
+{
+	const std::u16string text = u"Layout again";
+	const std::vector<std::uint32_t> expected = DrawText(text);
+	size_t lit = 0;
+	for (std::uint32_t pixel : expected)
+		lit += pixel != 0xFF000000;
+	ASSERT_GT(lit, 0u);
+
+	// Clearing the atlas invalidates the quads of the cached layout, it looks up its glyphs again
+	const std::uint32_t generation = g_Context->Glyphs.GetGeneration();
+	g_Context->Glyphs.Clear();
+	ASSERT_NE(g_Context->Glyphs.GetGeneration(), generation);
+	EXPECT_EQ(g_Context->Glyphs.GetStats().Glyphs, 0u);
+
+	EXPECT_EQ(DrawText(text), expected);
+	EXPECT_EQ(g_Context->LayoutCache.GetSize(), 1u);
+	EXPECT_GT(g_Context->Glyphs.GetStats().Glyphs, 0u);
+}
@@ -0,0 +1,213 @@
+#include "TextView.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+using Kyo2D::TextReader;
+using Kyo2D::TextView;
+
+namespace
+{
+	const std::uint32_t Bad = TextReader::ReplacementCharacter;
+
+	/// Decodes a whole text.
+	std::vector<std::uint32_t> Decode(const TextView &text)
+	{
+		std::vector<std::uint32_t> codepoints;
+		TextReader reader(text);
+		std::uint32_t codepoint;
+		while (reader.Next(codepoint))
+			codepoints.push_back(codepoint);
+		return codepoints;
+	}
+
+	std::vector<std::uint32_t> DecodeUtf8(const std::string &text)
+	{
+		return Decode(TextView(text.data(), text.size()));
+	}
+
+	std::vector<std::uint32_t> DecodeUtf16(const std::u16string &text)
+	{
+		return Decode(TextView(text.data(), text.size()));
+	}
+
+	/// Decodes UTF-8 a byte at a time, following the same rules as the reader.
+	std::vector<std::uint32_t> DecodeReference(const std::string &text)
+	{
+		std::vector<std::uint32_t> codepoints;
+		const std::uint8_t *bytes = reinterpret_cast<const std::uint8_t*>(text.data());
+		size_t i = 0;
+		while (i < text.size())
+		{
+			const std::uint32_t lead = bytes[i];
+			size_t length;
+			std::uint32_t codepoint, minimum;
+			if (lead < 0x80)
+				length = 1, codepoint = lead, minimum = 0;
+			else if (lead >= 0xC2 && lead < 0xE0)
+				length = 2, codepoint = lead & 0x1F, minimum = 0x80;
+			else if (lead >= 0xE0 && lead < 0xF0)
+				length = 3, codepoint = lead & 0x0F, minimum = 0x800;
+			else if (lead >= 0xF0 && lead < 0xF5)
+				length = 4, codepoint = lead & 0x07, minimum = 0x10000;
+			else
+			{
+				codepoints.push_back(Bad);
+				++i;
+				continue;
+			}
+
+			size_t n = 1;
+			for (; n < length && i + n < text.size() && (bytes[i + n] & 0xC0) == 0x80; ++n)
+				codepoint = (codepoint << 6) | (bytes[i + n] & 0x3F);
+
+			if (n < length || codepoint < minimum || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+				codepoint = Bad;
+			codepoints.push_back(codepoint);
+			i += n;
+		}
+		return codepoints;
+	}
+}
+
+TEST(TextReader, DecodesWellFormedUtf8)
+{
+	// $, cent sign, euro sign, the largest 3 byte codepoint, a CJK ideograph and an emoji
+	EXPECT_EQ(DecodeUtf8("$\xC2\xA2\xE2\x82\xAC\xEF\xBF\xBF\xE4\xB8\x80\xF0\x9F\x98\x80"),
+		(std::vector<std::uint32_t>{ 0x24, 0xA2, 0x20AC, 0xFFFF, 0x4E00, 0x1F600 }));
+	// Both ends of the ranges which start with E0 and ED
+	EXPECT_EQ(DecodeUtf8("\xE0\xA0\x80\xED\x9F\xBF"), (std::vector<std::uint32_t>{ 0x800, 0xD7FF }));
+}
+
+TEST(TextReader, StrayContinuationBytesAreReplaced)
+{
+	EXPECT_EQ(DecodeUtf8("a\x80\xBF" "b"), (std::vector<std::uint32_t>{ 'a', Bad, Bad, 'b' }));
+	// A continuation byte after a complete sequence
+	EXPECT_EQ(DecodeUtf8("\xC2\xA2\xA2"), (std::vector<std::uint32_t>{ 0xA2, Bad }));
+}
+
+TEST(TextReader, OverlongFormsAreReplaced)
+{
+	// "/" in 2, 3 and 4 bytes, the 2 byte form starts with a byte which can't start a sequence
+	EXPECT_EQ(DecodeUtf8("\xC0\xAF"), (std::vector<std::uint32_t>{ Bad, Bad }));
+	EXPECT_EQ(DecodeUtf8("\xE0\x80\xAF"), (std::vector<std::uint32_t>{ Bad }));
+	EXPECT_EQ(DecodeUtf8("\xF0\x80\x80\xAF"), (std::vector<std::uint32_t>{ Bad }));
+	// U+07FF in 3 bytes
+	EXPECT_EQ(DecodeUtf8("\xE0\x9F\xBF" "a"), (std::vector<std::uint32_t>{ Bad, 'a' }));
+}
+
+TEST(TextReader, EncodedSurrogatesAreReplaced)
+{
+	EXPECT_EQ(DecodeUtf8("\xED\xA0\x80" "a\xED\xBF\xBF"), (std::vector<std::uint32_t>{ Bad, 'a', Bad }));
+}
+
+TEST(TextReader, CodepointsPastUnicodeAreReplaced)
+{
+	EXPECT_EQ(DecodeUtf8("\xF4\x90\x80\x80\xF5\x80"), (std::vector<std::uint32_t>{ Bad, Bad, Bad }));
+}
+
+TEST(TextReader, TruncatedSequencesAreReplaced)
+{
+	// Cut by the end of the buffer
+	EXPECT_EQ(DecodeUtf8("a\xC2"), (std::vector<std::uint32_t>{ 'a', Bad }));
+	EXPECT_EQ(DecodeUtf8("a\xE4\xB8"), (std::vector<std::uint32_t>{ 'a', Bad }));
+	EXPECT_EQ(DecodeUtf8("a\xF0\x9F\x98"), (std::vector<std::uint32_t>{ 'a', Bad }));
+
+	// Cut by a byte which doesn't continue it, the byte is decoded on its own
+	EXPECT_EQ(DecodeUtf8("\xE4\xB8" "a\xF0\x9F\xC2\xA2"), (std::vector<std::uint32_t>{ Bad, 'a', Bad, 0xA2 }));
+
+	// The view ends inside a sequence of the string
+	const std::string text = "abc\xE4\xB8\x80";
+	EXPECT_EQ(Decode(TextView(text.data(), 5)), (std::vector<std::uint32_t>{ 'a', 'b', 'c', Bad }));
+}
+
+TEST(TextReader, AsciiRunsAcrossWordAndVectorBoundaries)
+{
+	// Non-ASCII bytes at every offset from 0 to 40 of runs, so runs end in and past each word of
+	// 8 bytes and each vector of 16 bytes
+	for (size_t run = 0; run < 40; ++run)
+	{
+		for (size_t gap = 1; gap < 3; ++gap)
+		{
+			std::string text;
+			std::vector<std::uint32_t> expected;
+			for (int repeat = 0; repeat < 3; ++repeat)
+			{
+				for (size_t i = 0; i < run; ++i)
+				{
+					text.push_back(static_cast<char>('a' + i % 26));
+					expected.push_back('a' + i % 26);
+				}
+				for (size_t i = 0; i < gap; ++i)
+				{
+					text += "\xC3\xA9";
+					expected.push_back(0xE9);
+				}
+			}
+			EXPECT_EQ(DecodeUtf8(text), expected) << "run " << run << ", gap " << gap;
+		}
+	}
+}
+
+TEST(TextReader, PositionFollowsCodepoints)
+{
+	const std::string text = "ab\xC3\xA9\xE4\xB8\x80" "cdefghijklmnopqrstuvwxyz";
+	TextReader reader(TextView(text.data(), text.size()));
+	std::uint32_t codepoint;
+	std::vector<size_t> positions;
+	while (reader.Next(codepoint))
+		positions.push_back(reader.GetPosition());
+
+	ASSERT_EQ(positions.size(), 28u);
+	EXPECT_EQ(positions[0], 1u);
+	EXPECT_EQ(positions[2], 4u);
+	EXPECT_EQ(positions[3], 7u);
+	EXPECT_EQ(positions.back(), text.size());
+}
+
+TEST(TextReader, MatchesByteDecoderOnRandomBytes)
+{
+	// Mostly ASCII with valid and broken sequences mixed in
+	const char *pieces[] = { "a", "bc", "defghijk", "lmnopqrstuvwxyz01234", " ", "\xC3\xA9", "\xE4\xB8\x80",
+		"\xF0\x9F\x98\x80", "\x80", "\xC2", "\xE0\x80\x80", "\xED\xA0\x80", "\xE0\xA0\x80", "\xED\x9F\xBF", "\xF4\x90\x80\x80", "\xFF" };
+	std::mt19937 random(7);
+	for (int test = 0; test < 200; ++test)
+	{
+		std::string text;
+		const size_t count = random() % 64;
+		for (size_t i = 0; i < count; ++i)
+			text += pieces[random() % (sizeof(pieces) / sizeof(pieces[0]))];
+		ASSERT_EQ(DecodeUtf8(text), DecodeReference(text)) << "test " << test;
+	}
+}
+
+TEST(TextReader, CombinesUtf16SurrogatePairs)
+{
+	EXPECT_EQ(DecodeUtf16(u"a\U0001F600\U0010FFFFz"), (std::vector<std::uint32_t>{ 'a', 0x1F600, 0x10FFFF, 'z' }));
+}
+
+TEST(TextReader, UnpairedUtf16SurrogatesAreReplaced)
+{
+	// A lone high surrogate, a lone low one, two high ones and a high one at the end
+	const char16_t text[] = { 0xD83D, 'a', 0xDE00, 'b', 0xD83D, 0xD83D, 0xDE00, 0xD83D };
+	EXPECT_EQ(DecodeUtf16(std::u16string(text, 8)), (std::vector<std::uint32_t>{ Bad, 'a', Bad, 'b', Bad, 0x1F600, Bad }));
+}
+
+TEST(TextReader, Utf32OutsideUnicodeIsReplaced)
+{
+	const char32_t text[] = { 'a', 0xD800, 0x110000, 0x10FFFF };
+	EXPECT_EQ(Decode(TextView(text, 4)), (std::vector<std::uint32_t>{ 'a', Bad, Bad, 0x10FFFF }));
+}
+
+TEST(TextReader, CountAsciiStopsAtFirstHighByte)
+{
+	std::string text(100, 'x');
+	for (size_t i = 0; i < text.size(); ++i)
+	{
+		std::string broken = text;
+		broken[i] = static_cast<char>(0x80);
+		EXPECT_EQ(TextReader::CountAscii(reinterpret_cast<const std::uint8_t*>(broken.data()), broken.size()), i);
+	}
+	EXPECT_EQ(TextReader::CountAscii(reinterpret_cast<const std::uint8_t*>(text.data()), text.size()), text.size());
+}
@@ -0,0 +1,217 @@
+#include "TextureResidency.h"
+#include <gtest/gtest.h>
+
+using Kyo2D::Texture;
+using Kyo2D::TextureResidency;
+
+namespace
+{
+	/// Counts the bytes held by fake textures like a video memory allocator.
+	struct FakeAllocator
+	{
+		std::uint64_t Allocated = 0;
+		std::uint64_t Allocations = 0;
+	};
+
+	/// Texture which only tracks its allocation. The source data holds the size in pixels.
+	class FakeTexture : public Texture
+	{
+	public:
+
+		FakeTexture(FakeAllocator &allocator, std::int32_t size)
+			: m_Allocator(allocator), m_Size(size), m_Resident(false)
+		{
+		}
+
+		~FakeTexture()
+		{
+			ReleaseResources();
+		}
+
+		/// Creates a resident, evictable texture.
+		static std::shared_ptr<FakeTexture> Create(FakeAllocator &allocator, std::int32_t size)
+		{
+			auto texture = std::make_shared<FakeTexture>(allocator, size);
+			texture->Initialize(&size, sizeof(size));
+			texture->KeepSource(&size, sizeof(size));
+			return texture;
+		}
+
+		virtual bool Initialize(const void *, size_t) override
+		{
+			if (!m_Resident)
+			{
+				m_Allocator.Allocated += GetMemoryUsage();
+				++m_Allocator.Allocations;
+				m_Resident = true;
+			}
+			return true;
+		}
+		virtual bool Initialize(const std::wstring &) override { return false; }
+		virtual bool InitializeRenderTarget(std::int32_t, std::int32_t) override { return false; }
+		virtual bool InitializePixels(std::int32_t, std::int32_t, const std::uint32_t *) override { return false; }
+		virtual bool UpdateRegion(std::int32_t, std::int32_t, std::int32_t, std::int32_t, const std::uint32_t *) override { return false; }
+		virtual bool InitializeAlpha(std::int32_t, std::int32_t, const std::uint8_t *) override { return false; }
+		virtual bool UpdateAlphaRegion(std::int32_t, std::int32_t, std::int32_t, std::int32_t, const std::uint8_t *) override { return false; }
+		virtual bool Set() override { return m_Resident; }
+		virtual std::int32_t GetWidth() const override { return m_Size; }
+		virtual std::int32_t GetHeight() const override { return m_Size; }
+		virtual bool IsResident() const override { return m_Resident; }
+
+	protected:
+
+		virtual void ReleaseResources() override
+		{
+			if (m_Resident)
+			{
+				m_Allocator.Allocated -= GetMemoryUsage();
+				m_Resident = false;
+			}
+		}
+
+	private:
+
+		FakeAllocator &m_Allocator;
+		std::int32_t m_Size;
+		bool m_Resident;
+	};
+
+	// 64x64 RGBA textures use 16 KiB each
+	const std::uint64_t TextureBytes = 64 * 64 * 4;
+}
+
+TEST(TextureResidency, UnlimitedBudgetKeepsEverything)
+{
+	FakeAllocator allocator;
+	TextureResidency residency;
+	std::vector<std::shared_ptr<FakeTexture>> textures;
+	for (std::uint32_t i = 0; i < 8; ++i)
+	{
+		textures.push_back(FakeTexture::Create(allocator, 64));
+		residency.Add(i + 1, textures.back());
+		residency.NextFrame();
+	}
+
+	EXPECT_EQ(residency.GetStats().Usage, 8 * TextureBytes);
+	EXPECT_EQ(residency.GetStats().Evictions, 0u);
+	EXPECT_EQ(allocator.Allocated, 8 * TextureBytes);
+}
+
+TEST(TextureResidency, EvictsLeastRecentlyUsed)
+{
+	FakeAllocator allocator;
+	TextureResidency residency;
+	residency.SetBudget(3 * TextureBytes);
+
+	std::vector<std::shared_ptr<FakeTexture>> textures;
+	for (std::uint32_t i = 0; i < 3; ++i)
+	{
+		textures.push_back(FakeTexture::Create(allocator, 64));
+		residency.Add(i + 1, textures.back());
+		residency.NextFrame();
+	}
+
+	// Texture 0 was used most recently, so texture 1 is the oldest one
+	residency.Touch(*textures[0]);
+	residency.NextFrame();
+
+	textures.push_back(FakeTexture::Create(allocator, 64));
+	residency.Add(4, textures.back());
+
+	EXPECT_TRUE(textures[0]->IsResident());
+	EXPECT_FALSE(textures[1]->IsResident());
+	EXPECT_TRUE(textures[2]->IsResident());
+	EXPECT_TRUE(textures[3]->IsResident());
+	EXPECT_EQ(residency.GetStats().Evictions, 1u);
+	EXPECT_EQ(residency.GetStats().Usage, 3 * TextureBytes);
+	EXPECT_EQ(allocator.Allocated, residency.GetStats().Usage);
+}
+
+TEST(TextureResidency, CurrentFrameIsNeverEvicted)
+{
+	FakeAllocator allocator;
+	TextureResidency residency;
+	residency.SetBudget(2 * TextureBytes);
+
+	// A frame using more textures than the budget allows goes over budget
+	std::vector<std::shared_ptr<FakeTexture>> textures;
+	for (std::uint32_t i = 0; i < 4; ++i)
+	{
+		textures.push_back(FakeTexture::Create(allocator, 64));
+		residency.Add(i + 1, textures.back());
+	}
+	for (auto &texture : textures)
+		EXPECT_TRUE(residency.Touch(*texture));
+
+	EXPECT_EQ(residency.GetStats().ResidentTextures, 4u);
+	EXPECT_EQ(allocator.Allocated, 4 * TextureBytes);
+
+	// Finishing the frame brings the usage back within the budget
+	residency.NextFrame();
+	EXPECT_LE(residency.GetStats().Usage, 2 * TextureBytes);
+	EXPECT_EQ(allocator.Allocated, residency.GetStats().Usage);
+}
+
+TEST(TextureResidency, TouchRestoresEvictedTexture)
+{
+	FakeAllocator allocator;
+	TextureResidency residency;
+	residency.SetBudget(TextureBytes);
+
+	auto first = FakeTexture::Create(allocator, 64);
+	residency.Add(1, first);
+	residency.NextFrame();
+	auto second = FakeTexture::Create(allocator, 64);
+	residency.Add(2, second);
+	ASSERT_FALSE(first->IsResident());
+
+	residency.NextFrame();
+	EXPECT_TRUE(residency.Touch(*first));
+	EXPECT_TRUE(first->IsResident());
+	EXPECT_FALSE(second->IsResident());
+	EXPECT_EQ(residency.GetStats().Restores, 1u);
+	EXPECT_EQ(allocator.Allocations, 3u);
+	EXPECT_EQ(allocator.Allocated, TextureBytes);
+}
+
+TEST(TextureResidency, NonEvictableTexturesStay)
+{
+	FakeAllocator allocator;
+	TextureResidency residency;
+	residency.SetBudget(TextureBytes);
+
+	// Render targets have no source to be restored from
+	auto target = std::make_shared<FakeTexture>(allocator, 64);
+	target->Initialize(nullptr, 0);
+	residency.Add(1, target);
+	residency.NextFrame();
+	residency.Add(2, FakeTexture::Create(allocator, 64));
+	residency.NextFrame();
+
+	EXPECT_TRUE(target->IsResident());
+}
+
+TEST(TextureResidency, SteadyStateStaysWithinBudget)
+{
+	FakeAllocator allocator;
+	TextureResidency residency;
+	residency.SetBudget(16 * TextureBytes);
+
+	std::vector<std::shared_ptr<FakeTexture>> textures;
+	for (std::uint32_t i = 0; i < 64; ++i)
+	{
+		textures.push_back(FakeTexture::Create(allocator, 64));
+		residency.Add(i + 1, textures.back());
+	}
+
+	// Frames draw a sliding window of 8 textures, the usage settles at the budget
+	for (std::uint32_t frame = 0; frame < 200; ++frame)
+	{
+		for (std::uint32_t i = 0; i < 8; ++i)
+			ASSERT_TRUE(residency.Touch(*textures[(frame * 3 + i) % textures.size()]));
+		residency.NextFrame();
+
+		ASSERT_LE(residency.GetStats().Usage, 16 * TextureBytes);
+		ASSERT_EQ(allocator.Allocated, residency.GetStats().Usage);
+	}
+}